@@ -1,5 +1,5 @@
 /* Copyright 2014-2017 Felix Schmitt, Conrad Schumann,
- *                     Alexander Grund, Axel Huebl
+ *                     Alexander Grund, Axel Huebl, agent
  *
  * This file is part of libPMacc.
  *
@@ -37,6 +37,8 @@
 #include "eventSystem/events/EventPool.hpp"
 #include "Environment.def"
 #include "communication/manager_common.hpp"
+#include "communication/MessageAggregator.hpp"
+#include "simulationControl/StartupTimer.hpp"
 #include "assert.hpp"
 
 #include <cuda_runtime.h>
@@ -197,6 +199,15 @@ namespace detail
             return EnvironmentController::getInstance();
         }
 
+        /** get the singleton MessageAggregator
+         *
+         * @return instance of MessageAggregator
+         */
+        PMacc::MessageAggregator& MessageAggregator()
+        {
+            return MessageAggregator::getInstance();
+        }
+
         /** get the singleton Factory
          *
          * @return instance of Factory
@@ -335,22 +346,29 @@ public:
      * @param devices number of devices per simulation dimension
      * @param periodic periodicity each simulation dimension
      *                 (0 == not periodic, 1 == periodic)
+     * @param topologyAwarePlacement place the ranks of a node into a compact
+     *                 block of the device grid (\see RankPlacement)
      */
     void initDevices(
         DataSpace< T_dim > devices,
-        DataSpace< T_dim > periodic
+        DataSpace< T_dim > periodic,
+        bool topologyAwarePlacement = false
     )
     {
+        StartupTimer::getInstance().beginPhase( "MPI init" );
+
         // initialize the MPI context
         detail::EnvironmentContext::getInstance().init();
 
         // create singleton instances
-        GridController().init( devices, periodic );
+        GridController().init( devices, periodic, topologyAwarePlacement );
 
         EnvironmentController();
 
         Filesystem();
 
+        StartupTimer::getInstance().beginPhase( "device selection" );
+
         detail::EnvironmentContext::getInstance().setDevice(
             static_cast<int>( GridController().getHostRank() )
         );
@@ -363,6 +381,7 @@ public:
 
         SimulationDescription();
 
+        StartupTimer::getInstance().endPhase();
     }
 
     /** initialize the computing domain information of PMacc
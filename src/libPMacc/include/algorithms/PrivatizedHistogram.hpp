@@ -0,0 +1,146 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace algorithms
+{
+namespace histogram
+{
+
+/** histogram which is accumulated privately per block
+ *
+ * Host implementation of the accumulation in KernelParticleCalorimeter and
+ * KernelBinEnergyParticles (PIConGPU, dense only): the values of a block
+ * are added to a private copy of all bins
+ * (dense) or to a table of hot bins with linear probing. Values of bins
+ * which find no free slot go to the global histogram directly. The private
+ * bins are added to the global histogram at the end of the block.
+ *
+ * Each addition to the global histogram is counted, on the device it is a
+ * global atomic operation.
+ */
+template<typename T_Type>
+class PrivatizedHistogram
+{
+public:
+
+    /**
+     * @param numBins number of bins of the global histogram
+     * @param numHotBins 0: private copy of all bins, else number of slots of the hot bin table
+     * @param maxProbes maximum number of slots which are tested for a bin
+     */
+    PrivatizedHistogram(const size_t numBins, const uint32_t numHotBins, const uint32_t maxProbes) :
+        bins(numBins, T_Type(0)),
+        privateBins(numHotBins == 0 ? numBins : numHotBins, T_Type(0)),
+        hotBinIdx(numHotBins, -1),
+        maxProbes(maxProbes),
+        numGlobalUpdates(0)
+    {
+    }
+
+    /** start the accumulation of a block */
+    void beginBlock()
+    {
+        privateBins.assign(privateBins.size(), T_Type(0));
+        hotBinIdx.assign(hotBinIdx.size(), -1);
+    }
+
+    /** add a value to a bin
+     *
+     * @param binIdx bin index, ignored if negative
+     * @param value value to add
+     */
+    void add(const int binIdx, const T_Type value)
+    {
+        if (binIdx < 0)
+            return;
+
+        if (hotBinIdx.empty())
+        {
+            privateBins[binIdx] += value;
+            return;
+        }
+
+        const int numHotBins = int(hotBinIdx.size());
+        for (uint32_t probe = 0; probe < maxProbes; ++probe)
+        {
+            const int slot = (binIdx + int(probe)) % numHotBins;
+            if (hotBinIdx[slot] == -1)
+                hotBinIdx[slot] = binIdx;
+            if (hotBinIdx[slot] == binIdx)
+            {
+                privateBins[slot] += value;
+                return;
+            }
+        }
+        addToGlobal(binIdx, value);
+    }
+
+    /** add the private bins of the block to the global histogram */
+    void endBlock()
+    {
+        for (size_t i = 0; i < privateBins.size(); ++i)
+        {
+            /* empty bins need no global update */
+            if (privateBins[i] != T_Type(0))
+                addToGlobal(hotBinIdx.empty() ? int(i) : hotBinIdx[i], privateBins[i]);
+        }
+    }
+
+    /** global histogram */
+    const std::vector<T_Type>& getBins() const
+    {
+        return bins;
+    }
+
+    /** number of additions to the global histogram */
+    uint64_t getNumGlobalUpdates() const
+    {
+        return numGlobalUpdates;
+    }
+
+private:
+
+    void addToGlobal(const int binIdx, const T_Type value)
+    {
+        bins[binIdx] += value;
+        ++numGlobalUpdates;
+    }
+
+    std::vector<T_Type> bins;
+    std::vector<T_Type> privateBins;
+    std::vector<int> hotBinIdx;
+    uint32_t maxProbes;
+    uint64_t numGlobalUpdates;
+};
+
+} //namespace histogram
+} //namespace algorithms
+} //namespace PMacc
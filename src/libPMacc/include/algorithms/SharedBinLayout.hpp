@@ -0,0 +1,73 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace algorithms
+{
+namespace histogram
+{
+
+/** place the block private copies of several histograms into one shared buffer
+ *
+ * The smallest histograms are placed first (ties in the given order), so
+ * that as many histograms as possible are privatized. A histogram which does
+ * not fit into the rest of the buffer is not privatized, its values go to
+ * global memory directly.
+ *
+ * @param numBins number of bins of the private copy of each histogram
+ * @param capacity number of bins of the shared buffer
+ * @param[out] offset first bin in the shared buffer of each histogram, -1 if not privatized
+ * @return number of used bins of the shared buffer
+ */
+inline size_t placeSharedBins(const std::vector<size_t>& numBins,
+                              const size_t capacity,
+                              std::vector<int>& offset)
+{
+    std::vector<size_t> order(numBins.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&numBins](const size_t a, const size_t b) { return numBins[a] < numBins[b]; });
+
+    offset.assign(numBins.size(), -1);
+    size_t numUsed = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        if (numBins[order[i]] > capacity - numUsed)
+            break;
+        offset[order[i]] = static_cast<int>(numUsed);
+        numUsed += numBins[order[i]];
+    }
+    return numUsed;
+}
+
+} // namespace histogram
+} // namespace algorithms
+} // namespace PMacc
@@ -0,0 +1,134 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace aggregation
+{
+
+/** one element of the descriptor table of an aggregated message
+ *
+ * message layout: descriptor[0].tag is the number of buffers N, followed by
+ * the descriptors of the N buffers (communication tag and size) and the
+ * buffers, each padded to 8 byte
+ */
+struct Descriptor
+{
+    uint32_t tag;
+    uint32_t reserved;
+    uint64_t bytes;
+};
+
+inline size_t alignBytes(size_t bytes)
+{
+    return (bytes + 7u) & ~size_t(7u);
+}
+
+/** size of a message
+ *
+ * @param entries buffers with the members `bytes` (size, for receives the
+ *                maximum size)
+ */
+template<typename T_Entry>
+inline size_t getMessageBytes(const std::vector<T_Entry>& entries)
+{
+    size_t bytes = sizeof(Descriptor) * (entries.size() + 1u);
+    for (size_t i = 0; i < entries.size(); ++i)
+        bytes += alignBytes(entries[i].bytes);
+    return bytes;
+}
+
+/** write the descriptor table and the buffers into a message
+ *
+ * @param entries buffers with the members `tag`, `data` and `bytes`
+ * @param message destination, at least getMessageBytes(entries) byte
+ * @return number of written bytes
+ */
+template<typename T_Entry>
+inline size_t pack(const std::vector<T_Entry>& entries, char* message)
+{
+    Descriptor* descriptors = reinterpret_cast<Descriptor*> (message);
+    descriptors[0].tag = static_cast<uint32_t> (entries.size());
+    descriptors[0].reserved = 0u;
+    descriptors[0].bytes = 0u;
+
+    size_t offset = sizeof(Descriptor) * (entries.size() + 1u);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        descriptors[i + 1].tag = entries[i].tag;
+        descriptors[i + 1].reserved = 0u;
+        descriptors[i + 1].bytes = entries[i].bytes;
+        if (entries[i].bytes != 0)
+            std::memcpy(message + offset, entries[i].data, entries[i].bytes);
+        offset += alignBytes(entries[i].bytes);
+    }
+    return offset;
+}
+
+/** copy the buffers of a message to the receive buffers with the same tag
+ *
+ * `bytes` of each entry is the maximum size before and the received size
+ * after the call
+ *
+ * @param entries receive buffers with the members `tag`, `data` and `bytes`
+ * @param message received message
+ * @param messageBytes size of the received message
+ */
+template<typename T_Entry>
+inline void unpack(std::vector<T_Entry>& entries, const char* message, size_t messageBytes)
+{
+    const Descriptor* descriptors = reinterpret_cast<const Descriptor*> (message);
+    const size_t numEntries = descriptors[0].tag;
+
+    if (numEntries != entries.size())
+        throw std::runtime_error("[MessageAggregator] number of received buffers does not match the registered receives");
+
+    size_t offset = sizeof(Descriptor) * (numEntries + 1u);
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        const Descriptor& desc = descriptors[i + 1];
+        T_Entry* entry = nullptr;
+        for (size_t e = 0; e < entries.size(); ++e)
+            if (entries[e].tag == desc.tag)
+                entry = &entries[e];
+
+        if (entry == nullptr || desc.bytes > entry->bytes || offset + desc.bytes > messageBytes)
+            throw std::runtime_error("[MessageAggregator] received buffer does not match the registered receives");
+
+        if (desc.bytes != 0)
+            std::memcpy(entry->data, message + offset, desc.bytes);
+        entry->bytes = desc.bytes;
+        offset += alignBytes(desc.bytes);
+    }
+}
+
+} //namespace aggregation
+} //namespace PMacc
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
- *                     Wolfgang Hoenig, Benjamin Worpitz, Alexander Grund
+ *                     Wolfgang Hoenig, Benjamin Worpitz, Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -24,6 +24,8 @@
 
 #include "communication/ICommunicator.hpp"
 #include "communication/manager_common.hpp"
+#include "communication/SharedMemoryTransport.hpp"
+#include "communication/RankPlacement.hpp"
 #include "dimensions/DataSpace.hpp"
 #include "memory/dataTypes/Mask.hpp"
 #include "pmacc_types.hpp"
@@ -78,7 +80,7 @@ public:
 
     /*! ctor
      */
-    CommunicatorMPI() : hostRank(0)
+    CommunicatorMPI() : hostRank(0), onHostNeighborFraction(0.0), nextPersistentId(0)
     {
         //MPI_Init(nullptr, nullptr);
     }
@@ -90,6 +92,10 @@ public:
     virtual ~CommunicatorMPI()
     {}
 
+    /*! rank in the communicator of getMPIComm()
+     *
+     * with topology aware placement this is not the rank in MPI_COMM_WORLD
+     */
     virtual int getRank()
     {
         return mpiRank;
@@ -119,10 +125,12 @@ public:
      *
      * @param nodes number of GPU nodes in each dimension
      * @param periodic specifying whether the grid is periodic (1) or not (0) in each dimension
+     * @param topologyAwarePlacement place the ranks of a host into a compact block
+     *        of the grid (\see RankPlacement), if false the grid follows the rank order
      *
      * \warning throws invalid argument if cx*cy*cz != totalnodes
      */
-    void init(DataSpace<DIM3> numberProcesses, DataSpace<DIM3> periodic)
+    void init(DataSpace<DIM3> numberProcesses, DataSpace<DIM3> periodic, bool topologyAwarePlacement = false)
     {
         this->periodic = periodic;
 
@@ -134,31 +142,54 @@ public:
             throw std::invalid_argument("wrong parameters or wrong mpirun-call!");
         }
 
-        //1. create Communicator (computing_comm) of computing nodes (ranks 0...n)
-        MPI_Comm computing_comm = MPI_COMM_WORLD;
-
         yoffset = 0;
 
-        // 2. create topology
-
         dims[0] = numberProcesses.x();
         dims[1] = numberProcesses.y();
         dims[2] = numberProcesses.z();
 
-        topology = MPI_COMM_NULL;
-
         int periods[] = {periodic.x(), periodic.y(), periodic.z()};
 
+        // 1. update Host rank
+        int hostSize = 1;
+        int hostIndex = 0;
+        updateHostRank(hostSize, hostIndex);
+
+        // 2. create Communicator (computing_comm) of computing nodes (ranks 0...n)
+        MPI_Comm computing_comm = MPI_COMM_WORLD;
+        if (topologyAwarePlacement)
+            computing_comm = createPlacedComm(periods, hostSize, hostIndex);
+
+        // 3. create topology
+        topology = MPI_COMM_NULL;
+
         /*create new communicator based on cartesian coordinates*/
         MPI_CHECK(MPI_Cart_create(computing_comm, DIM, dims, periods, 0, &topology));
 
-        // 3. update Host rank
-        updateHostRank();
+        if (computing_comm != MPI_COMM_WORLD)
+            MPI_CHECK(MPI_Comm_free(&computing_comm));
+
+        /* the global rank is the rank in the topology (\see getMPIComm),
+         * with topology aware placement it differs from the rank in MPI_COMM_WORLD
+         */
+        MPI_CHECK(MPI_Comm_rank(topology, &mpiRank));
 
-        //4. update Coordinates
+        // 4. fraction of the neighbor exchanges within a host
+        std::vector<int> hostOfCartRank(mpiSize);
+        MPI_CHECK(MPI_Allgather(&hostIndex, 1, MPI_INT, &(hostOfCartRank[0]), 1, MPI_INT, topology));
+        onHostNeighborFraction = RankPlacement::getOnNodeFraction(dims, periods, DIM, hostOfCartRank);
+
+        //5. update Coordinates
         updateCoordinates();
     }
 
+    /*! fraction of the neighbor exchanges (all 26 directions) between ranks on the same host
+     */
+    double getOnHostNeighborFraction() const
+    {
+        return onHostNeighborFraction;
+    }
+
     /*! returns a rank number (0-n) for each host
      *
      * E.g. if 8 GPUs are on 2 Hosts (4 GPUs each), the GPUs on each host will get hostrank 0 to 3
@@ -190,6 +221,9 @@ public:
 
     MPI_Request* startSend(uint32_t ex, const char *send_data, size_t send_data_count, uint32_t tag)
     {
+        if (sharedMemory.canUse(ExchangeTypeToRank(ex), tag))
+            return sharedMemory.startSend(ExchangeTypeToRank(ex), send_data, send_data_count, tag);
+
         MPI_Request *request = new MPI_Request;
 
         MPI_CHECK(MPI_Isend(
@@ -208,6 +242,8 @@ public:
 
     MPI_Request* startReceive(uint32_t ex, char *recv_data, size_t recv_data_max, uint32_t tag)
     {
+        if (sharedMemory.canUse(ExchangeTypeToRank(ex), tag))
+            return sharedMemory.startReceive(ExchangeTypeToRank(ex), recv_data, recv_data_max, tag);
 
         MPI_Request *request = new MPI_Request;
 
@@ -225,6 +261,96 @@ public:
 
     // description in ICommunicator
 
+    uint32_t createPersistentSend(uint32_t ex, const char *send_data, size_t send_data_count, uint32_t tag)
+    {
+        return createPersistent(true, ex, const_cast<char*>(send_data), send_data_count, tag);
+    }
+
+    // description in ICommunicator
+
+    uint32_t createPersistentReceive(uint32_t ex, char *recv_data, size_t recv_data_max, uint32_t tag)
+    {
+        /* fixed size receives get a mailbox for neighbors on the same node */
+        if (sharedMemory.isEnabled())
+            sharedMemory.addMailbox(tag, recv_data_max);
+        return createPersistent(false, ex, recv_data, recv_data_max, tag);
+    }
+
+    // description in ICommunicator
+
+    MPI_Request* startPersistent(uint32_t id, size_t data_count)
+    {
+        PersistentRequest& persistent = persistentRequests.at(id);
+        if (persistent.bytes != data_count)
+            return nullptr;
+
+        /* neighbors on the same node are served by startSend/startReceive */
+        const int peer = ExchangeTypeToRank(persistent.ex);
+        if (sharedMemory.canUse(peer, persistent.tag))
+            return nullptr;
+
+        /* the neighbor ranks are only changed by slide(), rebuild the
+         * request the first time it is used with new neighbors */
+        if (persistent.request == MPI_REQUEST_NULL || persistent.peer != peer)
+        {
+            if (persistent.request != MPI_REQUEST_NULL)
+                MPI_CHECK(MPI_Request_free(&persistent.request));
+            persistent.peer = peer;
+            initPersistent(persistent);
+        }
+
+        MPI_CHECK(MPI_Start(&persistent.request));
+        return &persistent.request;
+    }
+
+    // description in ICommunicator
+
+    void freePersistent(uint32_t id)
+    {
+        typename std::map<uint32_t, PersistentRequest>::iterator it = persistentRequests.find(id);
+        if (it == persistentRequests.end())
+            return;
+
+        /* exchanges can be destroyed after MPI_Finalize */
+        int isFinalized = 0;
+        MPI_CHECK(MPI_Finalized(&isFinalized));
+        if (!isFinalized)
+        {
+            if (it->second.request != MPI_REQUEST_NULL)
+                MPI_CHECK(MPI_Request_free(&(it->second.request)));
+            if (!it->second.isSend)
+                sharedMemory.removeMailbox(it->second.tag);
+        }
+        persistentRequests.erase(it);
+    }
+
+    // description in ICommunicator
+
+    void progress()
+    {
+        sharedMemory.progress();
+    }
+
+    /*! exchange data with neighbors on the same node via shared memory
+     *
+     * Must be called collectively before the first exchange is added.
+     * Only fixed size exchanges (\see createPersistentReceive) use the
+     * shared memory, all other exchanges are sent via MPI.
+     */
+    void enableSharedMemoryTransport()
+    {
+        sharedMemory.init(topology);
+    }
+
+    /*! number of ranks on the same node, 1 if the shared memory transport is disabled
+     */
+    int getNumSharedMemoryRanks() const
+    {
+        return sharedMemory.getNumNodeRanks();
+    }
+
+    // description in ICommunicator
+
     bool slide()
     {
         // we can only slide in y direction right now
@@ -262,74 +388,63 @@ public:
 
 
 protected:
-    /* Set the first found non charactor or number to 0 (nullptr)
-     * name like p1223(Pid=1233) is than p1223
-     * in some MPI implementation /mpich) the hostname is unique
-     */
-    void cleanHostname(char* name)
-    {
-        for (int i = 0; i < MPI_MAX_PROCESSOR_NAME; ++i)
-        {
-            if (!(name[i] >= 'A' && name[i] <= 'Z') &&
-                !(name[i] >= 'a' && name[i] <= 'z') &&
-                !(name[i] >= '0' && name[i] <= '9') &&
-                !(name[i] == '_') &&
-                !(name[i] == '-') )
-            {
-                name[i] = 0;
-                return;
-            }
-        }
-    }
-
     /*! gets hostRank
      *
-     * process with MPI-rank 0 is the master and builds a map with hostname
-     * and number of already known processes on this host.
-     * Each rank will provide its hostname via MPISend and gets its HostRank
-     * from the master.
+     * All ranks which can share memory are on the same host
+     * (MPI_COMM_TYPE_SHARED), the rank within this group
+     * (ordered by the global rank) is the host rank.
      *
+     * @param[out] hostSize number of ranks on this host
+     * @param[out] hostIndex index of this host (0 ... number of hosts - 1)
      */
-    void updateHostRank()
+    void updateHostRank(int& hostSize, int& hostIndex)
     {
-        char hostname[MPI_MAX_PROCESSOR_NAME];
-        int length;
-
-        MPI_CHECK(MPI_Get_processor_name(hostname, &length));
-        cleanHostname(hostname);
-        hostname[length++] = '\0';
-
         MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &mpiSize));
         MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank));
 
-        if (mpiRank == 0)
-        {
-            std::map<std::string, int> hosts;
-            hosts[hostname] = 0;
-            hostRank = 0;
-            for (int rank = 1; rank < mpiSize; ++rank)
-            {
-                MPI_CHECK(MPI_Recv(hostname, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, rank, gridHostnameTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE));
+        MPI_Comm hostComm;
+        MPI_CHECK(MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, mpiRank, MPI_INFO_NULL, &hostComm));
+        MPI_CHECK(MPI_Comm_rank(hostComm, &hostRank));
+        MPI_CHECK(MPI_Comm_size(hostComm, &hostSize));
 
-                //printf("Hostname: %s\n", hostname);
-                int hostrank = 0;
-                if (hosts.count(hostname) > 0) hostrank = hosts[hostname] + 1;
+        /* hosts are numbered in order of their first rank */
+        int isFirstOnHost = hostRank == 0 ? 1 : 0;
+        hostIndex = 0;
+        MPI_CHECK(MPI_Exscan(&isFirstOnHost, &hostIndex, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD));
+        if (mpiRank == 0)
+            hostIndex = 0;
+        MPI_CHECK(MPI_Bcast(&hostIndex, 1, MPI_INT, 0, hostComm));
 
-                MPI_CHECK(MPI_Send(&hostrank, 1, MPI_INT, rank, gridHostRankTag, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Comm_free(&hostComm));
+    }
 
-                hosts[hostname] = hostrank;
-            }
+    /*! communicator where the rank is the cartesian rank of the topology aware placement
+     *
+     * falls back to MPI_COMM_WORLD if the hosts have a different number of
+     * ranks or no block of the grid fits to the number of ranks per host
+     */
+    MPI_Comm createPlacedComm(const int (&periods)[3], int hostSize, int hostIndex)
+    {
+        int minHostSize;
+        int maxHostSize;
+        MPI_CHECK(MPI_Allreduce(&hostSize, &minHostSize, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD));
+        MPI_CHECK(MPI_Allreduce(&hostSize, &maxHostSize, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD));
 
-        }
-        else
+        RankPlacement placement(dims, periods, DIM, hostSize);
+        if (minHostSize != maxHostSize || !placement.isValid())
         {
-            MPI_CHECK(MPI_Send(hostname, length, MPI_CHAR, GridManagerRank, gridHostnameTag, MPI_COMM_WORLD));
-
-            MPI_CHECK(MPI_Recv(&hostRank, 1, MPI_INT, GridManagerRank, gridHostRankTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE));
-
-            // if(hostRank!=0) hostRank--; //!\todo fix mpi hostrank start with 1
+            if (mpiRank == 0)
+                std::cerr << "PMacc warning: topology aware placement is not possible for "
+                    << minHostSize << " to " << maxHostSize << " ranks per host, rank order is used" << std::endl;
+            return MPI_COMM_WORLD;
         }
 
+        log<ggLog::MPI>("topology aware placement: block of one host %1% %2% %3%") %
+            placement.getBlock(0) % placement.getBlock(1) % placement.getBlock(2);
+
+        MPI_Comm placedComm;
+        MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD, 0, placement.getCartRank(hostIndex, hostRank), &placedComm));
+        return placedComm;
     }
 
     /*! update coordinates \see getCoordinates
@@ -419,12 +534,72 @@ protected:
         return ranks[type];
     }
 
+    /*! description of a persistent request
+     */
+    struct PersistentRequest
+    {
+        bool isSend;
+        uint32_t ex;
+        char *data;
+        size_t bytes;
+        uint32_t tag;
+        //! rank the request is created for
+        int peer;
+        //! MPI_REQUEST_NULL if the request is not created yet
+        MPI_Request request;
+    };
+
+    uint32_t createPersistent(bool isSend, uint32_t ex, char *data, size_t bytes, uint32_t tag)
+    {
+        PersistentRequest persistent;
+        persistent.isSend = isSend;
+        persistent.ex = ex;
+        persistent.data = data;
+        persistent.bytes = bytes;
+        persistent.tag = tag;
+        persistent.peer = ExchangeTypeToRank(ex);
+        persistent.request = MPI_REQUEST_NULL;
+        initPersistent(persistent);
+
+        const uint32_t id = nextPersistentId++;
+        persistentRequests[id] = persistent;
+        return id;
+    }
+
+    void initPersistent(PersistentRequest& persistent)
+    {
+        /* directions without a neighbor have the rank -1 */
+        const int peer = persistent.peer < 0 ? MPI_PROC_NULL : persistent.peer;
+        if (persistent.isSend)
+        {
+            MPI_CHECK(MPI_Send_init(
+                                    persistent.data,
+                                    static_cast<int>(persistent.bytes),
+                                    MPI_CHAR,
+                                    peer,
+                                    gridExchangeTag + persistent.tag,
+                                    topology,
+                                    &persistent.request));
+        }
+        else
+        {
+            MPI_CHECK(MPI_Recv_init(
+                                    persistent.data,
+                                    static_cast<int>(persistent.bytes),
+                                    MPI_CHAR,
+                                    peer,
+                                    gridExchangeTag + persistent.tag,
+                                    topology,
+                                    &persistent.request));
+        }
+    }
+
 private:
     //! coordinates in GPU-Grid [0:cx-1,0:cy-1,0:cz-1]
     DataSpace<DIM> coordinates;
 
     DataSpace<DIM3> periodic;
-    //! MPI communicator (currently MPI_COMM_WORLD)
+    //! cartesian MPI communicator, ranks are ordered by the (placed) grid position
     MPI_Comm topology;
     //! array for exchangetype-to-rank conversion \see ExchangeTypeToRank
     int ranks[27];
@@ -437,8 +612,17 @@ private:
     //! offset for sliding window
     int yoffset;
 
+    //! rank in topology (rank in MPI_COMM_WORLD until the topology is created)
     int mpiRank;
     int mpiSize;
+    //! \see getOnHostNeighborFraction
+    double onHostNeighborFraction;
+
+    //! persistent requests, a map keeps the address of the requests valid
+    std::map<uint32_t, PersistentRequest> persistentRequests;
+    uint32_t nextPersistentId;
+    //! transport for neighbors on the same node (disabled by default)
+    SharedMemoryTransport sharedMemory;
 };
 
 } //namespace PMacc
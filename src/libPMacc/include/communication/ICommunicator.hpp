@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Wolfgang Hoenig, Benjamin Worpitz
+/* Copyright 2013-2017 Rene Widera, Wolfgang Hoenig, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -23,6 +23,7 @@
 
 #include "pmacc_types.hpp"
 #include "dimensions/DataSpace.hpp"
+#include "memory/dataTypes/Mask.hpp"
 
 #include <mpi.h>
 
@@ -78,6 +79,53 @@ public:
      */
     virtual MPI_Request* startReceive(uint32_t ex, char *recv_data, size_t recv_data_max, uint32_t tag) = 0;
 
+    /*! create a persistent send request (MPI_Send_init)
+     *
+     * For exchanges which send the same buffer with the same size in each step.
+     * The request is started with startPersistent() and is valid until
+     * freePersistent() is called.
+     *
+     * \param[in] ex                direction to send (enum ExchangeType)
+     * \param[in] send_data         pointer to data; must be valid until freePersistent()
+     * \param[in] send_data_count   message size in bytes to sent
+     * \param[in] tag               user-defined tag (\see startSend)
+     * \returns id of the persistent request
+     */
+    virtual uint32_t createPersistentSend(uint32_t ex, const char *send_data, size_t send_data_count, uint32_t tag) = 0;
+
+    /*! create a persistent receive request (MPI_Recv_init)
+     *
+     * \param[in] ex                direction to send (enum ExchangeType)
+     * \param[in] recv_data         pointer to data; must be valid until freePersistent()
+     * \param[in] recv_data_max     maximum message size in bytes to receive
+     * \param[in] tag               user-defined tag (\see startReceive)
+     * \returns id of the persistent request
+     */
+    virtual uint32_t createPersistentReceive(uint32_t ex, char *recv_data, size_t recv_data_max, uint32_t tag) = 0;
+
+    /*! start a persistent request (non-blocking)
+     *
+     * \param[in] id                result of createPersistentSend or createPersistentReceive
+     * \param[in] data_count        message size in bytes (send) or maximum message size (receive)
+     * \returns request for testing if this operation has already finished,
+     *          the request is owned by the communicator and must not be deleted;
+     *          nullptr if data_count is not the size the request is created for
+     *          (the caller must use startSend or startReceive)
+     */
+    virtual MPI_Request* startPersistent(uint32_t id, size_t data_count) = 0;
+
+    /*! free a persistent request
+     *
+     * the request must not be active
+     */
+    virtual void freePersistent(uint32_t id) = 0;
+
+    /*! progress transports which are not driven by MPI_Test
+     *
+     * must be called by tasks which wait for a request
+     */
+    virtual void progress() = 0;
+
     virtual int getRank()=0;
 
     /*! Return which of the three directions are periodic
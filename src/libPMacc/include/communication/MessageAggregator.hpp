@@ -0,0 +1,573 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "communication/ICommunicator.hpp"
+#include "communication/AggregatedMessage.hpp"
+#include "communication/manager_common.hpp"
+#include "eventSystem/tasks/ITask.hpp"
+#include "eventSystem/events/EventDataReceive.hpp"
+#include "memory/dataTypes/Mask.hpp"
+#include "pmacc_types.hpp"
+
+#include <mpi.h>
+
+#include <list>
+#include <vector>
+#include <stdexcept>
+#include <sstream>
+
+namespace PMacc
+{
+
+/** pack all exchange buffers to the same neighbor into one MPI message
+ *
+ * Exchanges which are started while an aggregation phase is open
+ * (see MessageAggregator::Scope) are not sent with an own MPI message.
+ * All sends of a phase into the same direction are packed into one message
+ * (a descriptor table with the communication tag and size of each buffer,
+ * followed by the data, see aggregation::pack) as soon as all host buffers
+ * of the phase are filled. The receiver posts one receive per direction and
+ * phase and unpacks the message into the host buffers of the registered
+ * receives.
+ *
+ * Requirements:
+ *  - all ranks must open the phases with the same key in the same order
+ *    and start the same exchanges in it (as for the not aggregated exchange)
+ *  - the key must be smaller than maxKey, phases with the same key and
+ *    direction are matched in the order they are created
+ *
+ * A task which starts its send later (e.g. after the particles are moved to
+ * the exchange buffers) reserves the send with reserveSend() while the phase
+ * is open and resumes the phase with Scope(aggregator, reservation) when the
+ * send is started. The message is not sent before all reservations are
+ * resumed.
+ *
+ * The aggregation is disabled by default, see enable().
+ */
+class MessageAggregator
+{
+public:
+
+    /** all keys must be smaller than this value (limited by the MPI tag range) */
+    static constexpr uint32_t maxKey = 256u;
+
+    /** open an aggregation phase for the lifetime of the object
+     *
+     * nested scopes belong to the phase of the outermost scope
+     */
+    class Scope
+    {
+    public:
+
+        Scope(MessageAggregator& aggregator, uint32_t key) :
+        aggregator(aggregator), isOpen(true)
+        {
+            aggregator.beginPhase(key);
+        }
+
+        /** resume the phase of a reserved send
+         *
+         * @param reservation result of reserveSend, if nullptr no phase is
+         *                    opened
+         */
+        Scope(MessageAggregator& aggregator, void* reservation) :
+        aggregator(aggregator), isOpen(reservation != nullptr)
+        {
+            if (isOpen)
+                aggregator.resumePhase(reservation);
+        }
+
+        ~Scope()
+        {
+            if (isOpen)
+                aggregator.endPhase();
+        }
+
+    private:
+        MessageAggregator& aggregator;
+        bool isOpen;
+    };
+
+    /** hide the open phase for the lifetime of the object
+     *
+     * used by code which executes other tasks while a phase is open (e.g.
+     * waiting for an event), exchanges started by these tasks must not join
+     * the phase because the other ranks may not execute them at this time
+     */
+    class Suspend
+    {
+    public:
+
+        Suspend(MessageAggregator& aggregator) :
+        aggregator(aggregator)
+        {
+            aggregator.suspendPhase();
+        }
+
+        ~Suspend()
+        {
+            aggregator.restorePhase();
+        }
+
+    private:
+        MessageAggregator& aggregator;
+    };
+
+    static MessageAggregator& getInstance()
+    {
+        static MessageAggregator instance;
+        return instance;
+    }
+
+    /** enable aggregation
+     *
+     * must be called collectively by all ranks before the first phase
+     *
+     * @param communicator communicator used to send the aggregated messages
+     */
+    void enable(ICommunicator& communicator)
+    {
+        comm = &communicator;
+    }
+
+    bool isEnabled() const
+    {
+        return comm != nullptr;
+    }
+
+    /** open an aggregation phase
+     *
+     * @param key id of the phase, must be the same on all ranks
+     */
+    void beginPhase(uint32_t key)
+    {
+        if (!isEnabled())
+            return;
+        if (phaseDepth++ != 0)
+            return;
+        if (key >= maxKey)
+        {
+            std::stringstream msg;
+            msg << "[MessageAggregator] phase key " << key << " must be smaller than " << uint32_t(maxKey);
+            throw std::runtime_error(msg.str());
+        }
+        phaseKey = key;
+    }
+
+    /** open the phase of a reserved send again
+     *
+     * a currently open phase is suspended until endPhase,
+     * only sends into the direction of the reservation can be started,
+     * the reservation is released by endPhase
+     *
+     * @param reservation result of reserveSend
+     */
+    void resumePhase(void* reservation)
+    {
+        Message& msg = *static_cast<Message*> (reservation);
+        suspendPhase();
+        phaseDepth = 1;
+        phaseKey = msg.key;
+        resumedMessage = &msg;
+    }
+
+    /** hide the open phase until restorePhase, see Suspend */
+    void suspendPhase()
+    {
+        suspendedPhases.push_back(PhaseState());
+        PhaseState& state = suspendedPhases.back();
+        state.depth = phaseDepth;
+        state.key = phaseKey;
+        state.resumedMessage = resumedMessage;
+        state.messages.swap(phaseMessages);
+
+        phaseDepth = 0;
+        resumedMessage = nullptr;
+    }
+
+    /** open the phase which was hidden by the last suspendPhase */
+    void restorePhase()
+    {
+        PhaseState& state = suspendedPhases.back();
+        phaseDepth = state.depth;
+        phaseKey = state.key;
+        resumedMessage = state.resumedMessage;
+        phaseMessages.swap(state.messages);
+        suspendedPhases.pop_back();
+    }
+
+    /** close the aggregation phase
+     *
+     * receives of the phase are posted, sends are posted as soon as all
+     * buffers are filled
+     */
+    void endPhase()
+    {
+        if (!isEnabled())
+            return;
+        if (--phaseDepth != 0)
+            return;
+
+        if (resumedMessage != nullptr)
+        {
+            --resumedMessage->numReserved;
+            restorePhase();
+            postReadySends();
+            return;
+        }
+
+        for (size_t i = 0; i < phaseMessages.size(); ++i)
+        {
+            Message& msg = *phaseMessages[i];
+            msg.isClosed = true;
+            if (!msg.isSend)
+                postReceive(msg);
+        }
+        phaseMessages.clear();
+        postReadySends();
+    }
+
+    /** announce a send in the current phase
+     *
+     * @param exchangeType direction of the send
+     * @return handle to pass to addSend, nullptr if no phase is open
+     *         (the caller must send without aggregation)
+     */
+    void* announceSend(uint32_t exchangeType)
+    {
+        if (phaseDepth == 0)
+            return nullptr;
+
+        Message& msg = getPhaseMessage(true, exchangeType);
+        ++msg.numAnnounced;
+        return &msg;
+    }
+
+    /** reserve a send in the current phase which is started later
+     *
+     * @param exchangeType direction of the send
+     * @return handle to pass to Scope(aggregator, reservation),
+     *         nullptr if no phase is open
+     */
+    void* reserveSend(uint32_t exchangeType)
+    {
+        if (phaseDepth == 0)
+            return nullptr;
+
+        Message& msg = getPhaseMessage(true, exchangeType);
+        ++msg.numReserved;
+        return &msg;
+    }
+
+    /** provide the data of an announced send
+     *
+     * the task gets a SENDFINISHED event after the aggregated message is sent,
+     * until then send_data must not be changed
+     *
+     * @param handle result of announceSend
+     * @param send_data host memory
+     * @param send_data_count number of bytes
+     * @param tag communication tag of the exchange
+     * @param task task which is notified
+     */
+    void addSend(void* handle, const char* send_data, size_t send_data_count, uint32_t tag, ITask* task)
+    {
+        Message& msg = *static_cast<Message*> (handle);
+        msg.entries.push_back(Entry(tag, const_cast<char*> (send_data), send_data_count, task));
+        postReadySends();
+    }
+
+    /** register a receive in the current phase
+     *
+     * the task gets a RECVFINISHED event with EventDataReceive after the
+     * data is copied to recv_data
+     *
+     * @param exchangeType direction of the receive
+     * @param recv_data host memory
+     * @param recv_data_max maximum number of bytes
+     * @param tag communication tag of the exchange
+     * @param task task which is notified
+     * @return true if the receive is aggregated, false if no phase is open
+     *         (the caller must receive without aggregation)
+     */
+    bool addReceive(uint32_t exchangeType, char* recv_data, size_t recv_data_max, uint32_t tag, ITask* task)
+    {
+        if (phaseDepth == 0)
+            return false;
+        if (resumedMessage != nullptr)
+            throw std::runtime_error("[MessageAggregator] a resumed phase can not receive");
+
+        Message& msg = getPhaseMessage(false, exchangeType);
+        msg.entries.push_back(Entry(tag, recv_data, recv_data_max, task));
+        return true;
+    }
+
+    /** test all posted messages and notify the tasks of finished messages
+     *
+     * called by waiting tasks
+     */
+    void progress()
+    {
+        postReadySends();
+
+        std::vector<Entry> finishedSends;
+        std::vector<Entry> finishedReceives;
+
+        for (MessageList::iterator it = messages.begin(); it != messages.end();)
+        {
+            Message& msg = *it;
+            if (msg.request == nullptr)
+            {
+                ++it;
+                continue;
+            }
+
+            int flag = 0;
+            MPI_Status status;
+            MPI_CHECK(MPI_Test(msg.request, &flag, &status));
+            if (!flag)
+            {
+                ++it;
+                continue;
+            }
+            delete msg.request;
+            msg.request = nullptr;
+
+            if (msg.isSend)
+                finishedSends.insert(finishedSends.end(), msg.entries.begin(), msg.entries.end());
+            else
+            {
+                int recvBytes = 0;
+                MPI_CHECK(MPI_Get_count(&status, MPI_CHAR, &recvBytes));
+                unpack(msg, static_cast<size_t> (recvBytes));
+                finishedReceives.insert(finishedReceives.end(), msg.entries.begin(), msg.entries.end());
+            }
+            freeBuffers.push_back(std::vector<char>());
+            freeBuffers.back().swap(msg.buffer);
+            it = messages.erase(it);
+        }
+
+        /* notify after the list is updated, the tasks can start new exchanges */
+        for (size_t i = 0; i < finishedSends.size(); ++i)
+            finishedSends[i].task->event(finishedSends[i].task->getId(), SENDFINISHED, nullptr);
+        for (size_t i = 0; i < finishedReceives.size(); ++i)
+        {
+            EventDataReceive edata(nullptr, finishedReceives[i].bytes);
+            finishedReceives[i].task->event(finishedReceives[i].task->getId(), RECVFINISHED, &edata);
+        }
+    }
+
+    /** number of sent aggregated messages */
+    uint64_t getNumMessages() const
+    {
+        return numMessages;
+    }
+
+    /** number of exchange buffers sent within aggregated messages */
+    uint64_t getNumBuffers() const
+    {
+        return numBuffers;
+    }
+
+    /** number of bytes sent within aggregated messages (including descriptors) */
+    uint64_t getNumBytes() const
+    {
+        return numBytes;
+    }
+
+private:
+
+    /** offset of the MPI tags for aggregated messages
+     *
+     * tag = offset + key * 32 + direction, disjoint to the tags of the
+     * exchanges ((communicationTag << 5) | direction) for
+     * communicationTag < 512
+     */
+    static constexpr uint32_t tagOffset = 1u << 14;
+
+    struct Entry
+    {
+        Entry(uint32_t tag, char* data, size_t bytes, ITask* task) :
+        tag(tag), data(data), bytes(bytes), task(task)
+        {
+        }
+
+        uint32_t tag;
+        char* data;
+        /* send: size of the data, receive: maximum and after unpack received size */
+        size_t bytes;
+        ITask* task;
+    };
+
+    struct Message
+    {
+        Message(bool isSend, uint32_t exchangeType, uint32_t key) :
+        isSend(isSend), isClosed(false), exchangeType(exchangeType), key(key),
+        numAnnounced(0), numReserved(0), request(nullptr)
+        {
+        }
+
+        bool isSend;
+        bool isClosed;
+        uint32_t exchangeType;
+        uint32_t key;
+        size_t numAnnounced;
+        /* reserved sends which are not resumed and finished */
+        size_t numReserved;
+        std::vector<Entry> entries;
+        std::vector<char> buffer;
+        MPI_Request* request;
+    };
+
+    typedef std::list<Message> MessageList;
+
+    struct PhaseState
+    {
+        uint32_t depth;
+        uint32_t key;
+        Message* resumedMessage;
+        std::vector<Message*> messages;
+    };
+
+    MessageAggregator() :
+    comm(nullptr), phaseDepth(0), phaseKey(0), resumedMessage(nullptr),
+    numMessages(0), numBuffers(0), numBytes(0)
+    {
+    }
+
+    MessageAggregator(const MessageAggregator&);
+
+    /** MPI tag of a message, direction is always the send direction */
+    static uint32_t getTag(uint32_t key, uint32_t sendDirection)
+    {
+        return tagOffset + (key << 5) + sendDirection;
+    }
+
+    Message& getPhaseMessage(bool isSend, uint32_t exchangeType)
+    {
+        if (resumedMessage != nullptr)
+        {
+            if (resumedMessage->exchangeType != exchangeType)
+                throw std::runtime_error("[MessageAggregator] direction does not match the reserved send");
+            return *resumedMessage;
+        }
+
+        for (size_t i = 0; i < phaseMessages.size(); ++i)
+            if (phaseMessages[i]->isSend == isSend && phaseMessages[i]->exchangeType == exchangeType)
+                return *phaseMessages[i];
+
+        messages.push_back(Message(isSend, exchangeType, phaseKey));
+        phaseMessages.push_back(&messages.back());
+        return messages.back();
+    }
+
+    std::vector<char>& acquireBuffer(Message& msg, size_t bytes)
+    {
+        if (!freeBuffers.empty())
+        {
+            msg.buffer.swap(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+        msg.buffer.resize(bytes);
+        return msg.buffer;
+    }
+
+    void postReceive(Message& msg)
+    {
+        const size_t maxBytes = aggregation::getMessageBytes(msg.entries);
+        std::vector<char>& buffer = acquireBuffer(msg, maxBytes);
+        const uint32_t sendDirection = Mask::getMirroredExchangeType(msg.exchangeType);
+        msg.request = comm->startReceive(msg.exchangeType,
+                                         &(*buffer.begin()),
+                                         maxBytes,
+                                         getTag(msg.key, sendDirection));
+    }
+
+    /** post all complete sends
+     *
+     * a send is only posted if all earlier sends with the same tag are
+     * posted, so that the order of the messages matches the receiver
+     */
+    void postReadySends()
+    {
+        std::vector<uint32_t> blockedTags;
+        for (MessageList::iterator it = messages.begin(); it != messages.end(); ++it)
+        {
+            Message& msg = *it;
+            if (!msg.isSend || msg.request != nullptr)
+                continue;
+
+            const uint32_t tag = getTag(msg.key, msg.exchangeType);
+            bool isBlocked = false;
+            for (size_t i = 0; i < blockedTags.size(); ++i)
+                isBlocked = isBlocked || (blockedTags[i] == tag);
+
+            if (isBlocked || !msg.isClosed || msg.numReserved != 0 ||
+                msg.entries.size() != msg.numAnnounced)
+            {
+                blockedTags.push_back(tag);
+                continue;
+            }
+            postSend(msg, tag);
+        }
+    }
+
+    void postSend(Message& msg, uint32_t tag)
+    {
+        const size_t bytes = aggregation::getMessageBytes(msg.entries);
+        std::vector<char>& buffer = acquireBuffer(msg, bytes);
+        char* ptr = &(*buffer.begin());
+        aggregation::pack(msg.entries, ptr);
+
+        msg.request = comm->startSend(msg.exchangeType, ptr, bytes, tag);
+
+        ++numMessages;
+        numBuffers += msg.entries.size();
+        numBytes += bytes;
+    }
+
+    void unpack(Message& msg, size_t recvBytes)
+    {
+        aggregation::unpack(msg.entries, &(*msg.buffer.begin()), recvBytes);
+    }
+
+    ICommunicator* comm;
+    uint32_t phaseDepth;
+    uint32_t phaseKey;
+    /* reserved send of a resumed phase, nullptr for a new phase */
+    Message* resumedMessage;
+    /* messages of the open phase */
+    std::vector<Message*> phaseMessages;
+    /* phases hidden by suspendPhase, the last one is restored first */
+    std::vector<PhaseState> suspendedPhases;
+    /* all messages which are not finished, in order of creation */
+    MessageList messages;
+    /* recycled message buffers */
+    std::vector<std::vector<char> > freeBuffers;
+
+    uint64_t numMessages;
+    uint64_t numBuffers;
+    uint64_t numBytes;
+};
+
+} //namespace PMacc
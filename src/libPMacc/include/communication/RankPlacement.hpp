@@ -0,0 +1,207 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+
+/** node aware placement of ranks in a cartesian process grid
+ *
+ * The ranks of one node are placed into a compact block of the process
+ * grid. The block is a factorization of the number of ranks per node which
+ * divides the process grid and keeps most neighbor exchanges on the node.
+ *
+ * Cartesian ranks are row-major (the last dimension is the fastest), as
+ * used by MPI_Cart_create.
+ */
+class RankPlacement
+{
+public:
+
+    /** search the best block
+     *
+     * @param dims number of ranks in each dimension (unused dimensions are 1)
+     * @param periodic periodic (1) or not (0) in each dimension
+     * @param numDims number of used dimensions
+     * @param ranksPerNode number of ranks on each node
+     */
+    RankPlacement(const int (&dims)[3], const int (&periodic)[3], int numDims, int ranksPerNode) :
+    numDims(numDims), valid(false), onNodeFraction(0.0)
+    {
+        for (int d = 0; d < 3; ++d)
+        {
+            this->dims[d] = dims[d];
+            this->periodic[d] = periodic[d];
+            block[d] = 1;
+        }
+
+        if (ranksPerNode < 1 || (getNumRanks() % ranksPerNode) != 0)
+            return;
+
+        int candidate[3] = {1, 1, 1};
+        for (candidate[0] = 1; candidate[0] <= dims[0]; ++candidate[0])
+            for (candidate[1] = 1; candidate[1] <= dims[1]; ++candidate[1])
+                for (candidate[2] = 1; candidate[2] <= dims[2]; ++candidate[2])
+                {
+                    if (candidate[0] * candidate[1] * candidate[2] != ranksPerNode ||
+                        dims[0] % candidate[0] != 0 ||
+                        dims[1] % candidate[1] != 0 ||
+                        dims[2] % candidate[2] != 0)
+                        continue;
+
+                    std::vector<int> nodes(getNumRanks());
+                    for (int node = 0; node < getNumRanks() / ranksPerNode; ++node)
+                        for (int local = 0; local < ranksPerNode; ++local)
+                            nodes[getCartRank(candidate, node, local)] = node;
+
+                    const double fraction = getOnNodeFraction(dims, periodic, numDims, nodes);
+                    if (!valid || fraction > onNodeFraction)
+                    {
+                        valid = true;
+                        onNodeFraction = fraction;
+                        for (int d = 0; d < 3; ++d)
+                            block[d] = candidate[d];
+                    }
+                }
+    }
+
+    /** a block is found (ranks per node is a product of divisors of the grid) */
+    bool isValid() const
+    {
+        return valid;
+    }
+
+    /** size of the block of one node in each dimension */
+    int getBlock(int d) const
+    {
+        return block[d];
+    }
+
+    /** fraction of neighbor exchanges within a node with this placement */
+    double getOnNodeFraction() const
+    {
+        return onNodeFraction;
+    }
+
+    /** cartesian rank of a rank
+     *
+     * @param node index of the node
+     * @param localRank rank within the node
+     */
+    int getCartRank(int node, int localRank) const
+    {
+        return getCartRank(block, node, localRank);
+    }
+
+    /** cartesian rank of a position in the process grid */
+    static int getCartRank(const int (&dims)[3], const int (&coords)[3])
+    {
+        return (coords[0] * dims[1] + coords[1]) * dims[2] + coords[2];
+    }
+
+    /** fraction of neighbor exchanges (all 26 directions) within a node
+     *
+     * @param nodes node index of each cartesian rank
+     * @return 1.0 if there are no neighbors
+     */
+    static double getOnNodeFraction(const int (&dims)[3], const int (&periodic)[3], int numDims, const std::vector<int>& nodes)
+    {
+        std::size_t numExchanges = 0;
+        std::size_t numOnNode = 0;
+
+        int coords[3];
+        for (coords[0] = 0; coords[0] < dims[0]; ++coords[0])
+            for (coords[1] = 0; coords[1] < dims[1]; ++coords[1])
+                for (coords[2] = 0; coords[2] < dims[2]; ++coords[2])
+                {
+                    const int node = nodes[getCartRank(dims, coords)];
+                    int offset[3];
+                    for (offset[0] = -1; offset[0] <= 1; ++offset[0])
+                        for (offset[1] = -1; offset[1] <= 1; ++offset[1])
+                            for (offset[2] = -1; offset[2] <= 1; ++offset[2])
+                            {
+                                int neighbor[3];
+                                bool isExchange = offset[0] != 0 || offset[1] != 0 || offset[2] != 0;
+                                for (int d = 0; d < 3 && isExchange; ++d)
+                                {
+                                    if (d >= numDims && offset[d] != 0)
+                                        isExchange = false;
+                                    neighbor[d] = coords[d] + offset[d];
+                                    if (neighbor[d] < 0 || neighbor[d] >= dims[d])
+                                    {
+                                        if (periodic[d] == 0)
+                                            isExchange = false;
+                                        neighbor[d] = (neighbor[d] + dims[d]) % dims[d];
+                                    }
+                                }
+                                if (!isExchange)
+                                    continue;
+
+                                ++numExchanges;
+                                if (nodes[getCartRank(dims, neighbor)] == node)
+                                    ++numOnNode;
+                            }
+                }
+
+        if (numExchanges == 0)
+            return 1.0;
+        return double(numOnNode) / double(numExchanges);
+    }
+
+private:
+
+    int getNumRanks() const
+    {
+        return dims[0] * dims[1] * dims[2];
+    }
+
+    int getCartRank(const int (&blockSize)[3], int node, int localRank) const
+    {
+        /* nodes are placed row-major in the grid of blocks, ranks row-major in the block */
+        int nodeGrid[3];
+        for (int d = 0; d < 3; ++d)
+            nodeGrid[d] = dims[d] / blockSize[d];
+
+        int coords[3];
+        for (int d = 2; d >= 0; --d)
+        {
+            coords[d] = (node % nodeGrid[d]) * blockSize[d] + localRank % blockSize[d];
+            node /= nodeGrid[d];
+            localRank /= blockSize[d];
+        }
+        return getCartRank(dims, coords);
+    }
+
+    int dims[3];
+    int periodic[3];
+    int numDims;
+    int block[3];
+    bool valid;
+    double onNodeFraction;
+};
+
+} //namespace PMacc
@@ -0,0 +1,351 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "communication/manager_common.hpp"
+#include "pmacc_types.hpp"
+
+#include <mpi.h>
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <vector>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace PMacc
+{
+
+/** exchange messages with ranks on the same node via MPI-3 shared memory
+ *
+ * Each registered receive (fixed size exchange, see addMailbox()) owns a
+ * mailbox in a shared memory window of all ranks on the node. A sender on
+ * the same node copies its data into the mailbox of the receiver, the
+ * receiver copies it out into its host buffer. As with MPI over shared
+ * memory the data is copied twice, the transport saves the MPI message
+ * protocol and the tag matching, not a copy.
+ *
+ * Sends and receives are represented by MPI generalized requests, they can
+ * be tested with MPI_Test as all other requests but only progress()
+ * completes them.
+ */
+class SharedMemoryTransport
+{
+public:
+
+    SharedMemoryTransport() :
+    nodeComm(MPI_COMM_NULL), nodeRank(0)
+    {
+    }
+
+    /** enable the transport
+     *
+     * collective over all ranks of comm
+     *
+     * @param comm communicator used for all exchanges
+     */
+    void init(MPI_Comm comm)
+    {
+        if (isEnabled())
+            return;
+
+        MPI_CHECK(MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodeComm));
+        MPI_CHECK(MPI_Comm_rank(nodeComm, &nodeRank));
+
+        int size;
+        MPI_CHECK(MPI_Comm_size(comm, &size));
+
+        MPI_Group group;
+        MPI_Group nodeGroup;
+        MPI_CHECK(MPI_Comm_group(comm, &group));
+        MPI_CHECK(MPI_Comm_group(nodeComm, &nodeGroup));
+
+        std::vector<int> ranks(size);
+        for (int i = 0; i < size; ++i)
+            ranks[i] = i;
+        /* ranks on other nodes are translated to MPI_UNDEFINED */
+        nodeRanks.resize(size);
+        MPI_CHECK(MPI_Group_translate_ranks(group, size, &(ranks[0]), nodeGroup, &(nodeRanks[0])));
+
+        MPI_CHECK(MPI_Group_free(&group));
+        MPI_CHECK(MPI_Group_free(&nodeGroup));
+    }
+
+    bool isEnabled() const
+    {
+        return nodeComm != MPI_COMM_NULL;
+    }
+
+    /** number of ranks on this node (including this rank) */
+    int getNumNodeRanks() const
+    {
+        int size = 1;
+        if (isEnabled())
+            MPI_CHECK(MPI_Comm_size(nodeComm, &size));
+        return size;
+    }
+
+    /** create the mailboxes for a tag
+     *
+     * collective over all ranks of the node, all ranks must add the same
+     * tags in the same order
+     *
+     * A sender only knows its own maximum size, therefore the mailboxes are
+     * only created if all ranks of the node use the same maximum size.
+     * Otherwise (e.g. an uneven grid distribution) the tag is exchanged via
+     * MPI.
+     *
+     * @param tag communication tag of the exchange
+     * @param maxBytes maximum message size in bytes
+     */
+    void addMailbox(uint32_t tag, size_t maxBytes)
+    {
+        if (mailboxes.count(tag) != 0)
+            throw std::runtime_error("[SharedMemoryTransport] mailbox for this tag already exists");
+
+        unsigned long long bytes = maxBytes;
+        unsigned long long minBytes;
+        unsigned long long nodeMaxBytes;
+        MPI_CHECK(MPI_Allreduce(&bytes, &minBytes, 1, MPI_UNSIGNED_LONG_LONG, MPI_MIN, nodeComm));
+        MPI_CHECK(MPI_Allreduce(&bytes, &nodeMaxBytes, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, nodeComm));
+        if (minBytes != nodeMaxBytes)
+            return;
+
+        Mailbox& box = mailboxes[tag];
+        box.maxBytes = maxBytes;
+
+        void* base = nullptr;
+        MPI_CHECK(MPI_Win_allocate_shared(static_cast<MPI_Aint>(sizeof (Header) + maxBytes), 1,
+                                          MPI_INFO_NULL, nodeComm, &base, &box.window));
+        MPI_CHECK(MPI_Win_lock_all(MPI_MODE_NOCHECK, box.window));
+        new (base) Header();
+        MPI_CHECK(MPI_Win_sync(box.window));
+        /* all headers must be initialized before a neighbor writes */
+        MPI_CHECK(MPI_Barrier(nodeComm));
+    }
+
+    /** free the mailboxes for a tag
+     *
+     * collective over all ranks of the node
+     */
+    void removeMailbox(uint32_t tag)
+    {
+        std::map<uint32_t, Mailbox>::iterator it = mailboxes.find(tag);
+        if (it == mailboxes.end())
+            return;
+        MPI_CHECK(MPI_Win_unlock_all(it->second.window));
+        MPI_CHECK(MPI_Win_free(&(it->second.window)));
+        mailboxes.erase(it);
+    }
+
+    /** check if the exchange with a rank can use the transport
+     *
+     * @param peer rank in the communicator passed to init(), -1 for no rank
+     * @param tag communication tag of the exchange
+     */
+    bool canUse(int peer, uint32_t tag) const
+    {
+        return isEnabled() && peer >= 0 &&
+            nodeRanks[peer] != MPI_UNDEFINED &&
+            mailboxes.count(tag) != 0;
+    }
+
+    /** start sending (non-blocking)
+     *
+     * @return request which is freed by MPI_Test (as for MPI_Isend)
+     */
+    MPI_Request* startSend(int peer, const char *send_data, size_t send_data_count, uint32_t tag)
+    {
+        Mailbox& box = mailboxes.at(tag);
+        if (send_data_count > box.maxBytes)
+            throw std::runtime_error("[SharedMemoryTransport] message is larger than the mailbox");
+        return start(new Operation(true, peer, const_cast<char*>(send_data), send_data_count, tag));
+    }
+
+    /** start receiving (non-blocking)
+     *
+     * @return request which is freed by MPI_Test (as for MPI_Irecv)
+     */
+    MPI_Request* startReceive(int peer, char *recv_data, size_t recv_data_max, uint32_t tag)
+    {
+        return start(new Operation(false, peer, recv_data, recv_data_max, tag));
+    }
+
+    /** complete all operations for which the mailbox is ready
+     *
+     * operations with the same mailbox are processed in order of creation
+     */
+    void progress()
+    {
+        for (std::list<Operation*>::iterator it = pending.begin(); it != pending.end();)
+        {
+            Operation* op = *it;
+            if (tryComplete(*op))
+            {
+                it = pending.erase(it);
+                MPI_CHECK(MPI_Grequest_complete(op->request));
+            }
+            else
+                ++it;
+        }
+    }
+
+private:
+
+    enum MailboxState
+    {
+        EMPTY = 0u,
+        FULL = 1u
+    };
+
+    /** header in front of the data of each mailbox */
+    struct Header
+    {
+        Header() : state(EMPTY), bytes(0u)
+        {
+        }
+
+        std::atomic<uint32_t> state;
+        uint64_t bytes;
+    };
+
+    struct Mailbox
+    {
+        MPI_Win window;
+        size_t maxBytes;
+    };
+
+    struct Operation
+    {
+        Operation(bool isSend, int peer, char* data, size_t bytes, uint32_t tag) :
+        isSend(isSend), peer(peer), data(data), bytes(bytes), tag(tag)
+        {
+        }
+
+        bool isSend;
+        int peer;
+        char* data;
+        /* send: size of the data, receive: maximum and after completion received size */
+        size_t bytes;
+        uint32_t tag;
+        MPI_Request request;
+    };
+
+    MPI_Request* start(Operation* op)
+    {
+        MPI_CHECK(MPI_Grequest_start(&queryOperation, &freeOperation, &cancelOperation, op, &(op->request)));
+
+        /* a request is only processed after all older requests of the same mailbox */
+        bool isBlocked = false;
+        for (std::list<Operation*>::iterator it = pending.begin(); it != pending.end(); ++it)
+            isBlocked = isBlocked || ((*it)->isSend == op->isSend && (*it)->peer == op->peer && (*it)->tag == op->tag);
+
+        MPI_Request* request = new MPI_Request(op->request);
+        if (!isBlocked && tryComplete(*op))
+        {
+            MPI_CHECK(MPI_Grequest_complete(op->request));
+        }
+        else
+            pending.push_back(op);
+        return request;
+    }
+
+    /** header and data of the mailbox of a rank
+     *
+     * @param nodeRank owner of the mailbox (rank in the node communicator)
+     */
+    Header* getMailbox(const Mailbox& box, int nodeRank) const
+    {
+        MPI_Aint size;
+        int dispUnit;
+        void* base = nullptr;
+        MPI_CHECK(MPI_Win_shared_query(box.window, nodeRank, &size, &dispUnit, &base));
+        return static_cast<Header*> (base);
+    }
+
+    bool tryComplete(Operation& op)
+    {
+        const Mailbox& box = mailboxes.at(op.tag);
+        /* sender writes into the mailbox of the receiver, the receiver reads its own */
+        Header* header = getMailbox(box, op.isSend ? nodeRanks[op.peer] : nodeRank);
+        char* payload = reinterpret_cast<char*> (header + 1);
+
+        MPI_CHECK(MPI_Win_sync(box.window));
+        const uint32_t state = header->state.load(std::memory_order_acquire);
+
+        if (op.isSend)
+        {
+            if (state != EMPTY)
+                return false;
+            if (op.bytes != 0)
+                memcpy(payload, op.data, op.bytes);
+            header->bytes = op.bytes;
+            header->state.store(FULL, std::memory_order_release);
+        }
+        else
+        {
+            if (state != FULL)
+                return false;
+            if (header->bytes > op.bytes)
+                throw std::runtime_error("[SharedMemoryTransport] received message is larger than the receive buffer");
+            op.bytes = header->bytes;
+            if (op.bytes != 0)
+                memcpy(op.data, payload, op.bytes);
+            header->state.store(EMPTY, std::memory_order_release);
+        }
+        MPI_CHECK(MPI_Win_sync(box.window));
+        return true;
+    }
+
+    static int queryOperation(void* extraState, MPI_Status* status)
+    {
+        Operation* op = static_cast<Operation*> (extraState);
+        MPI_Status_set_elements(status, MPI_CHAR, static_cast<int> (op->bytes));
+        MPI_Status_set_cancelled(status, 0);
+        status->MPI_SOURCE = op->peer;
+        status->MPI_TAG = static_cast<int> (op->tag);
+        return MPI_SUCCESS;
+    }
+
+    static int freeOperation(void* extraState)
+    {
+        delete static_cast<Operation*> (extraState);
+        return MPI_SUCCESS;
+    }
+
+    static int cancelOperation(void*, int)
+    {
+        return MPI_SUCCESS;
+    }
+
+    MPI_Comm nodeComm;
+    int nodeRank;
+    /* rank in nodeComm for each rank of the exchange communicator, MPI_UNDEFINED if not on this node */
+    std::vector<int> nodeRanks;
+    std::map<uint32_t, Mailbox> mailboxes;
+    /* started but not completed operations, in order of creation */
+    std::list<Operation*> pending;
+};
+
+} //namespace PMacc
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Felix Schmitt, Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Felix Schmitt, Rene Widera, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -24,6 +24,8 @@
 #include "eventSystem/streams/StreamController.hpp"
 #include "eventSystem/EventSystem.hpp"
 #include "eventSystem/Manager.hpp"
+#include "eventSystem/TaskGraph.hpp"
+#include "communication/MessageAggregator.hpp"
 #include "assert.hpp"
 
 #include <cstdlib>
@@ -58,6 +60,9 @@ inline bool Manager::execute( id_t taskToWait )
     }
 #endif
 
+    /* tasks executed while waiting must not join an open aggregation phase */
+    MessageAggregator::Suspend suspendAggregation( MessageAggregator::getInstance( ) );
+
     static TaskMap::iterator iter = tasks.begin( );
 
     if ( iter == tasks.end( ) )
@@ -79,6 +84,8 @@ inline bool Manager::execute( id_t taskToWait )
             /*test if task is deleted by other stackdeep*/
             if ( getActiveITaskIfNotFinished( id ) == taskPtr )
             {
+                if ( TaskGraph::getInstance( ).isRecording( ) )
+                    TaskGraph::getInstance( ).finishTask( id );
                 tasks.erase( id );
                 __delete(taskPtr);
             }
@@ -106,6 +113,8 @@ inline bool Manager::execute( id_t taskToWait )
 
 inline void Manager::event( id_t eventId, EventType, IEventData* )
 {
+    if ( TaskGraph::getInstance( ).isRecording( ) )
+        TaskGraph::getInstance( ).finishTask( eventId );
     passiveTasks.erase( eventId );
 }
 
@@ -178,6 +187,12 @@ inline void Manager::waitForAllTasks( )
 inline void Manager::addTask( ITask *task )
 {
     PMACC_ASSERT( task != nullptr );
+    /* the new task depends on the current transaction event */
+    if ( TaskGraph::getInstance( ).isRecording( ) )
+        TaskGraph::getInstance( ).addTask(
+            *task,
+            Environment<>::get( ).TransactionManager( ).getTransactionEvent( ).getTaskId( )
+        );
     tasks[task->getId( )] = task;
 }
 
@@ -0,0 +1,341 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "eventSystem/tasks/ITask.hpp"
+#include "simulationControl/TimeInterval.hpp"
+#include "pmacc_types.hpp"
+
+#include <vector>
+#include <string>
+#include <typeinfo>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+namespace PMacc
+{
+
+/** task graph (DAG) of one simulation step
+ *
+ * Between beginStep() and endStep() the Manager reports each task with its
+ * dependencies and the time it is finished. The structure of a step (type
+ * of each task and the dependencies) is compared with the recorded graph,
+ * the graph is only recorded again (including the task names) if the
+ * structure changed, e.g. after a slide of the moving window.
+ *
+ * The node storage of the last step is reused, a step with an unchanged
+ * structure does not allocate memory.
+ *
+ * The graph is used for diagnostics only (dot file, critical path), the
+ * tasks of each step are still created by the Factory and scheduled by the
+ * Manager.
+ *
+ * \todo replay the recorded graph with preallocated tasks and precomputed
+ *       dependencies if the structure is unchanged; a task binds to the
+ *       buffers and the kernel launch of the call which creates it and
+ *       kernels are started when they are called, therefore a replay needs
+ *       tasks which can be rebound to new arguments
+ */
+class TaskGraph
+{
+public:
+
+    static TaskGraph& getInstance()
+    {
+        static TaskGraph instance;
+        return instance;
+    }
+
+    /** enable the recording in beginStep() */
+    void enable()
+    {
+        enabled = true;
+    }
+
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    /** true between beginStep() and endStep() */
+    bool isRecording() const
+    {
+        return recording;
+    }
+
+    /** start the recording of a step */
+    void beginStep()
+    {
+        if (!enabled)
+            return;
+        current.clear();
+        std::fill(slots.begin(), slots.end(), -1);
+        firstId = 0;
+        stepBegin = TimeIntervall::getTime();
+        recording = true;
+    }
+
+    /** end the recording of a step
+     *
+     * Tasks which are not finished at the end of the step stay open.
+     */
+    void endStep()
+    {
+        if (!recording)
+            return;
+        recording = false;
+        ++numSteps;
+
+        if (!isSameStructure())
+        {
+            /* names are only collected if the structure differs from the recorded graph */
+            if (!recordNames)
+            {
+                recordNames = true;
+                return;
+            }
+            ++numRecordings;
+            recordNames = false;
+            recorded.swap(current);
+        }
+        else
+        {
+            recordNames = false;
+            for (size_t i = 0; i < current.size(); ++i)
+            {
+                recorded[i].begin = current[i].begin;
+                recorded[i].end = current[i].end;
+            }
+        }
+        recordedStepBegin = stepBegin;
+    }
+
+    /** add a task which depends on up to two other tasks
+     *
+     * @param task new task
+     * @param dependency1 id of a task which must be finished before, 0 for none
+     * @param dependency2 id of a task which must be finished before, 0 for none
+     */
+    void addTask(ITask& task, id_t dependency1, id_t dependency2 = 0)
+    {
+        const id_t id = task.getId();
+        if (firstId == 0)
+            firstId = id;
+        if (id < firstId)
+            return;
+
+        const size_t slot = id - firstId;
+        if (slot >= slots.size())
+            slots.resize(slot + 1, -1);
+        slots[slot] = current.size();
+
+        current.push_back(Node());
+        Node& node = current.back();
+        node.type = typeid(task).name();
+        node.dependency[0] = getNode(dependency1);
+        node.dependency[1] = getNode(dependency2);
+        node.begin = TimeIntervall::getTime();
+        node.end = -1.0;
+        if (recordNames)
+            node.name = task.toString();
+    }
+
+    /** a task is finished
+     *
+     * @param id id of the task
+     */
+    void finishTask(id_t id)
+    {
+        const int index = getNode(id);
+        if (index >= 0)
+            current[index].end = TimeIntervall::getTime();
+    }
+
+    /** number of recorded steps */
+    uint64_t getNumSteps() const
+    {
+        return numSteps;
+    }
+
+    /** number of times the graph was recorded (structure changes + 1) */
+    uint64_t getNumRecordings() const
+    {
+        return numRecordings;
+    }
+
+    /** write the recorded graph in the dot format (Graphviz)
+     *
+     * nodes are labeled with the name of the task and the time from the
+     * begin of the step until the task was finished, the critical path
+     * is colored red
+     */
+    void writeDot(std::ostream& out) const
+    {
+        std::vector<bool> isCritical(recorded.size(), false);
+        std::vector<int> path = getCriticalPath();
+        for (size_t i = 0; i < path.size(); ++i)
+            isCritical[path[i]] = true;
+
+        out << "digraph TaskGraph {" << std::endl;
+        out << "    node [shape=box];" << std::endl;
+        for (size_t i = 0; i < recorded.size(); ++i)
+        {
+            const Node& node = recorded[i];
+            out << "    n" << i << " [label=\"" << escape(node.name) << "\\n";
+            if (node.end >= 0.0)
+                out << std::fixed << std::setprecision(3) << node.end - recordedStepBegin << " ms\"";
+            else
+                out << "open\"";
+            if (isCritical[i])
+                out << ", color=red";
+            out << "];" << std::endl;
+
+            for (int d = 0; d < 2; ++d)
+                if (node.dependency[d] >= 0)
+                {
+                    out << "    n" << node.dependency[d] << " -> n" << i;
+                    if (isCritical[i] && isCritical[node.dependency[d]])
+                        out << " [color=red]";
+                    out << ";" << std::endl;
+                }
+        }
+        out << "}" << std::endl;
+    }
+
+    /** print the critical path of the recorded graph
+     *
+     * The critical path ends with the task finished last, the predecessor
+     * of a task is its dependency which finished last.
+     */
+    void printCriticalPath(std::ostream& out) const
+    {
+        std::vector<int> path = getCriticalPath();
+        out << "task graph: " << recorded.size() << " tasks per step, recorded "
+            << numRecordings << " times in " << numSteps << " steps" << std::endl;
+        out << "critical path (" << path.size() << " tasks):" << std::endl;
+
+        double last = recordedStepBegin;
+        for (std::vector<int>::const_reverse_iterator it = path.rbegin(); it != path.rend(); ++it)
+        {
+            const Node& node = recorded[*it];
+            out << "  " << std::fixed << std::setprecision(3) << std::setw(10) << node.end - last
+                << " ms  " << node.name << std::endl;
+            last = node.end;
+        }
+    }
+
+private:
+
+    struct Node
+    {
+        /* name of the type of the task, used to compare the structure */
+        const char* type;
+        std::string name;
+        /* index of the nodes this node depends on, -1 for none or a task of an older step */
+        int dependency[2];
+        double begin;
+        double end;
+    };
+
+    TaskGraph() :
+    enabled(false), recording(false), recordNames(true), firstId(0),
+    stepBegin(0.0), recordedStepBegin(0.0), numSteps(0), numRecordings(0)
+    {
+    }
+
+    TaskGraph(const TaskGraph&);
+
+    int getNode(id_t id) const
+    {
+        if (id == 0 || firstId == 0 || id < firstId || id - firstId >= slots.size())
+            return -1;
+        return slots[id - firstId];
+    }
+
+    bool isSameStructure() const
+    {
+        if (current.size() != recorded.size())
+            return false;
+        for (size_t i = 0; i < current.size(); ++i)
+        {
+            if (current[i].type != recorded[i].type ||
+                current[i].dependency[0] != recorded[i].dependency[0] ||
+                current[i].dependency[1] != recorded[i].dependency[1])
+                return false;
+        }
+        return true;
+    }
+
+    /** indices of the nodes of the critical path, the last node first */
+    std::vector<int> getCriticalPath() const
+    {
+        std::vector<int> path;
+        int last = -1;
+        for (size_t i = 0; i < recorded.size(); ++i)
+            if (recorded[i].end >= 0.0 && (last < 0 || recorded[i].end >= recorded[last].end))
+                last = i;
+
+        while (last >= 0)
+        {
+            path.push_back(last);
+            const Node& node = recorded[last];
+            last = -1;
+            for (int d = 0; d < 2; ++d)
+            {
+                const int dep = node.dependency[d];
+                if (dep >= 0 && recorded[dep].end >= 0.0 && (last < 0 || recorded[dep].end >= recorded[last].end))
+                    last = dep;
+            }
+        }
+        return path;
+    }
+
+    static std::string escape(const std::string& name)
+    {
+        std::string result;
+        for (size_t i = 0; i < name.size(); ++i)
+        {
+            if (name[i] == '"' || name[i] == '\\')
+                result += '\\';
+            result += name[i];
+        }
+        return result;
+    }
+
+    bool enabled;
+    bool recording;
+    /* collect the task names in the next step (structure changed) */
+    bool recordNames;
+    /* id of the first task of the current step */
+    id_t firstId;
+    /* node index for each task id of the current step (id - firstId) */
+    std::vector<int> slots;
+    std::vector<Node> current;
+    std::vector<Node> recorded;
+    double stepBegin;
+    double recordedStepBegin;
+    uint64_t numSteps;
+    uint64_t numRecordings;
+};
+
+} //namespace PMacc
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -24,6 +24,7 @@
 #include "eventSystem/EventSystem.hpp"
 #include "eventSystem/tasks/ITask.hpp"
 #include "eventSystem/tasks/TaskLogicalAnd.hpp"
+#include "eventSystem/TaskGraph.hpp"
 
 namespace PMacc
 {
@@ -90,6 +91,8 @@ namespace PMacc
 
         TaskLogicalAnd *taskAnd = new TaskLogicalAnd(myTask,
                                                      otherTask);
+        if(TaskGraph::getInstance().isRecording())
+            TaskGraph::getInstance().addTask(*taskAnd, this->taskId, other.taskId);
         this->taskId=taskAnd->getId();
         manager.addPassiveTask(taskAnd);
 
@@ -0,0 +1,75 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace exec
+{
+
+/** call site of a kernel
+ *
+ * Only pointers to strings with static storage duration (`__FILE__`,
+ * `typeid(...).name()`) are stored, copying the object and launching a
+ * kernel does not allocate memory. The description for error messages
+ * is built on demand.
+ */
+struct KernelMetaData
+{
+    /** file name from where the kernel is called */
+    char const * m_file;
+    /** line number in the file */
+    size_t m_line;
+
+    /**
+     * @param file file name, must outlive the object (e.g. `__FILE__`)
+     * @param line line number in the file
+     */
+    KernelMetaData(
+        char const * file = "",
+        size_t const line = 0
+    ) :
+        m_file( file ),
+        m_line( line )
+    {
+    }
+
+    /** description of a kernel call for error messages
+     *
+     * @param kernelName name of the kernel functor type
+     * @return `kernelName [file:line ]`
+     */
+    std::string getInfo( char const * kernelName ) const
+    {
+        return std::string( kernelName ) +
+            std::string( " [" ) + std::string( m_file ) + std::string( ":" ) +
+            std::to_string( m_line ) + std::string( " ]" );
+    }
+};
+
+} // namespace exec
+} // namespace PMacc
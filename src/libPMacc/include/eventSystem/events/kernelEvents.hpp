@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Felix Schmitt, Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Felix Schmitt, Rene Widera, Benjamin Worpitz,
+ *                     agent
  *
  * This file is part of libPMacc.
  *
@@ -28,8 +29,10 @@
 #include "eventSystem/EventSystem.hpp"
 #include "Environment.hpp"
 #include "nvidia/gpuEntryFunction.hpp"
+#include "eventSystem/events/KernelMetaData.hpp"
 
 #include <string>
+#include <typeinfo>
 
 
 
@@ -74,10 +77,8 @@ namespace exec
     {
         /** functor */
         T_KernelFunctor const m_kernelFunctor;
-        /** file name from where the kernel is called */
-        std::string const m_file;
-        /** line number in the file */
-        size_t const m_line;
+        /** file name and line of the kernel call */
+        KernelMetaData const m_metaData;
 
         /**
          *
@@ -88,12 +89,11 @@ namespace exec
          */
         HINLINE Kernel(
             T_KernelFunctor const & kernelFunctor,
-            std::string const & file = std::string(),
+            char const * file = "",
             size_t const line = 0
         ) :
             m_kernelFunctor( kernelFunctor ),
-            m_file( file ),
-            m_line( line )
+            m_metaData( file, line )
         {
 
         }
@@ -162,6 +162,18 @@ namespace exec
 
         }
 
+        /** description of the kernel call for error messages
+         *
+         * is only evaluated if an error is reported, launching a kernel
+         * does not allocate memory for the description
+         */
+        HINLINE
+        std::string
+        getKernelInfo( ) const
+        {
+            return m_kernel.m_metaData.getInfo( typeid( m_kernel.m_kernelFunctor ).name() );
+        }
+
         /** execute the kernel functor
          *
          * @tparam T_Args types of the arguments
@@ -178,19 +190,13 @@ namespace exec
             T_Args const & ... args
         ) const
         {
-
-            std::string const kernelName = typeid( m_kernel.m_kernelFunctor ).name();
-            std::string const kernelInfo = kernelName +
-                std::string( " [" ) + m_kernel.m_file + std::string( ":" ) +
-                std::to_string( m_kernel.m_line ) + std::string( " ]" );
-
             CUDA_CHECK_KERNEL_MSG(
                 cudaDeviceSynchronize( ),
-                std::string( "Crash before kernel call " ) + kernelInfo
+                std::string( "Crash before kernel call " ) + getKernelInfo( )
             );
 
             PMacc::TaskKernel* taskKernel = PMacc::Environment<>::get().Factory().createTaskKernel(
-                typeid( kernelName ).name()
+                typeid( m_kernel.m_kernelFunctor ).name()
             );
 
             DataSpace<
@@ -205,27 +211,26 @@ namespace exec
                 >::value
             > blockExtent( m_blockExtent );
 
-            nvidia::gpuEntryFunction<<<
+            nvidia::launchGpuEntryFunction(
                 gridExtent,
                 blockExtent,
                 m_sharedMemByte,
-                taskKernel->getCudaStream()
-            >>>(
+                taskKernel->getCudaStream(),
                 m_kernel.m_kernelFunctor,
                 args ...
             );
             CUDA_CHECK_KERNEL_MSG(
                 cudaGetLastError( ),
-                std::string( "Last error after kernel launch " ) + kernelInfo
+                std::string( "Last error after kernel launch " ) + getKernelInfo( )
             );
             CUDA_CHECK_KERNEL_MSG(
                 cudaDeviceSynchronize( ),
-                std::string( "Crash after kernel launch " ) + kernelInfo
+                std::string( "Crash after kernel launch " ) + getKernelInfo( )
             );
             taskKernel->activateChecks( );
             CUDA_CHECK_KERNEL_MSG(
                 cudaDeviceSynchronize( ),
-                std::string(  "Crash after kernel activation" ) + kernelInfo
+                std::string(  "Crash after kernel activation" ) + getKernelInfo( )
             );
         }
 
@@ -250,13 +255,13 @@ namespace exec
      *
      * @tparam T_KernelFunctor type of the kernel functor
      * @param kernelFunctor instance of the functor
-     * @param file file name (for debug)
+     * @param file file name (for debug), must outlive the kernel object (e.g. `__FILE__`)
      * @param line line number in the file (for debug)
      */
     template< typename T_KernelFunctor >
     auto kernel(
         T_KernelFunctor const & kernelFunctor,
-        std::string const & file = std::string(),
+        char const * file = "",
         size_t const line = 0
     ) -> Kernel< T_KernelFunctor >
     {
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Wolfgang Hoenig,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -152,7 +152,7 @@ namespace PMacc
          * @param registeringTask optional pointer to an ITask which should be registered at the new task as an observer
          * @return the newly created TaskKernel
          */
-        TaskKernel* createTaskKernel(std::string kernelname, ITask *registeringTask = nullptr);
+        TaskKernel* createTaskKernel(const char* kernelname, ITask *registeringTask = nullptr);
 
         /**
          * Starts a task by initialising it and adding it to the Manager's queue.
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -206,7 +206,7 @@ namespace PMacc
      * @param registeringTask optional pointer to an ITask which should be registered at the new task as an observer
      * @return the newly created TaskKernel
      */
-    inline TaskKernel* Factory::createTaskKernel(std::string kernelname, ITask *registeringTask)
+    inline TaskKernel* Factory::createTaskKernel(const char* kernelname, ITask *registeringTask)
     {
         TaskKernel* task = new TaskKernel(kernelname);
 
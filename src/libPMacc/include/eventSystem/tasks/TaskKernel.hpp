@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Benjamin Worpitz,
- *                     Alexander Grund
+ *                     Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -33,7 +33,11 @@ namespace PMacc
     {
     public:
 
-        TaskKernel(std::string kernelName) :
+        /**
+         * @param kernelName name of the kernel, must have static storage duration
+         *                   (e.g. `typeid(...).name()`), it is not copied
+         */
+        TaskKernel(const char* kernelName) :
         StreamTask(),
         kernelName(kernelName),
         canBeChecked(false)
@@ -71,7 +75,7 @@ namespace PMacc
 
     private:
         bool canBeChecked;
-        std::string kernelName;
+        const char* kernelName;
     };
 
 } //namespace PMacc
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Wolfgang Hoenig,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -41,14 +41,24 @@ namespace PMacc
 
         TaskReceive(Exchange<TYPE, DIM> &ex) :
         exchange(&ex),
-        state(Constructor)
+        state(Constructor),
+        isAggregated(false)
         {
         }
 
         virtual void init()
         {
             state = WaitForReceived;
-            Environment<>::get().Factory().createTaskReceiveMPI(exchange, this);
+            /* inside of an aggregation phase the data is received together
+             * with all other buffers from the same neighbor */
+            isAggregated = Environment<>::get().MessageAggregator().addReceive(
+                exchange->getExchangeType(),
+                (char*) exchange->getHostBuffer().getBasePointer(),
+                exchange->getHostBuffer().getDataSpace().productOfComponents() * sizeof (TYPE),
+                exchange->getCommunicationTag(),
+                this);
+            if (!isAggregated)
+                Environment<>::get().Factory().createTaskReceiveMPI(exchange, this);
         }
 
         bool executeIntern()
@@ -56,6 +66,8 @@ namespace PMacc
             switch (state)
             {
                 case WaitForReceived:
+                    if (isAggregated)
+                        Environment<>::get().MessageAggregator().progress();
                     break;
                 case RunCopy:
                     state = WaitForFinish;
@@ -141,6 +153,7 @@ namespace PMacc
         Exchange<TYPE, DIM> *exchange;
         state_t state;
         size_t newBufferSize;
+        bool isAggregated;
     };
 
 } //namespace PMacc
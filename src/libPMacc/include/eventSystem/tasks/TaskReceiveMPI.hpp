@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Wolfgang Hoenig,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -39,19 +39,28 @@ public:
 
     TaskReceiveMPI(Exchange<TYPE, DIM> *exchange) :
     MPITask(),
-    exchange(exchange)
+    exchange(exchange),
+    isPersistent(false)
     {
 
     }
 
     virtual void init()
     {
-        this->request = Environment<DIM>::get().EnvironmentController()
-                .getCommunicator().startReceive(
-                                                exchange->getExchangeType(),
-                                                (char*) exchange->getHostBuffer().getBasePointer(),
-                                                exchange->getHostBuffer().getDataSpace().productOfComponents() * sizeof (TYPE),
-                                                exchange->getCommunicationTag());
+        ICommunicator& comm = Environment<DIM>::get().EnvironmentController().getCommunicator();
+        const size_t bytes = exchange->getHostBuffer().getDataSpace().productOfComponents() * sizeof (TYPE);
+
+        this->request = nullptr;
+        if (exchange->hasPersistentRequest())
+            this->request = comm.startPersistent(exchange->getPersistentRequest(), bytes);
+        isPersistent = this->request != nullptr;
+
+        if (!isPersistent)
+            this->request = comm.startReceive(
+                                              exchange->getExchangeType(),
+                                              (char*) exchange->getHostBuffer().getBasePointer(),
+                                              bytes,
+                                              exchange->getCommunicationTag());
     }
 
     bool executeIntern()
@@ -62,12 +71,16 @@ public:
         if (this->request == nullptr)
             throw std::runtime_error("request was nullptr (call executeIntern after freed");
 
+        Environment<DIM>::get().EnvironmentController().getCommunicator().progress();
+
         int flag=0;
         MPI_CHECK(MPI_Test(this->request, &flag, &(this->status)));
 
         if (flag) //finished
         {
-            delete this->request;
+            /* persistent requests are owned by the communicator */
+            if (!isPersistent)
+                delete this->request;
             this->request = nullptr;
             setFinished();
             return true;
@@ -104,6 +117,7 @@ private:
     Exchange<TYPE, DIM> *exchange;
     MPI_Request *request;
     MPI_Status status;
+    bool isPersistent;
 };
 
 } //namespace PMacc
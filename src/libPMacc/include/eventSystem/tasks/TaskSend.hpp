@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Wolfgang Hoenig,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -42,13 +42,17 @@ namespace PMacc
 
         TaskSend(Exchange<TYPE, DIM> &ex) :
         exchange(&ex),
-        state(Constructor)
+        state(Constructor),
+        aggregatedMessage(nullptr)
         {
         }
 
         virtual void init()
         {
             state = InitDone;
+            /* inside of an aggregation phase the data is sent together with
+             * all other buffers to the same neighbor */
+            aggregatedMessage = Environment<>::get().MessageAggregator().announceSend(exchange->getExchangeType());
             if (exchange->hasDeviceDoubleBuffer())
             {
                 Environment<>::get().Factory().createTaskCopyDeviceToDevice(exchange->getDeviceBuffer(),
@@ -75,11 +79,23 @@ namespace PMacc
                     break;
                 case DeviceToHostFinished:
                     state = SendDone;
+                    if (aggregatedMessage != nullptr)
+                    {
+                        Environment<>::get().MessageAggregator().addSend(
+                            aggregatedMessage,
+                            (char*) exchange->getHostBuffer().getPointer(),
+                            exchange->getHostBuffer().getCurrentSize() * sizeof (TYPE),
+                            exchange->getCommunicationTag(),
+                            this);
+                        break;
+                    }
                     __startTransaction();
                     Environment<>::get().Factory().createTaskSendMPI(exchange, this);
                     __endTransaction();
                     break;
                 case SendDone:
+                    if (aggregatedMessage != nullptr)
+                        Environment<>::get().MessageAggregator().progress();
                     break;
                 case Finish:
                     return true;
@@ -131,6 +147,8 @@ namespace PMacc
 
         Exchange<TYPE, DIM> *exchange;
         state_t state;
+        /* handle of the aggregated message, nullptr if sent without aggregation */
+        void* aggregatedMessage;
     };
 
 } //namespace PMacc
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Wolfgang Hoenig,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -39,19 +39,28 @@ public:
 
     TaskSendMPI(Exchange<TYPE, DIM> *exchange) :
     MPITask(),
-    exchange(exchange)
+    exchange(exchange),
+    isPersistent(false)
     {
 
     }
 
     virtual void init()
     {
-        this->request = Environment<DIM>::get().EnvironmentController()
-                .getCommunicator().startSend(
-                                             exchange->getExchangeType(),
-                                             (char*) exchange->getHostBuffer().getPointer(),
-                                             exchange->getHostBuffer().getCurrentSize() * sizeof (TYPE),
-                                             exchange->getCommunicationTag());
+        ICommunicator& comm = Environment<DIM>::get().EnvironmentController().getCommunicator();
+        const size_t bytes = exchange->getHostBuffer().getCurrentSize() * sizeof (TYPE);
+
+        this->request = nullptr;
+        if (exchange->hasPersistentRequest())
+            this->request = comm.startPersistent(exchange->getPersistentRequest(), bytes);
+        isPersistent = this->request != nullptr;
+
+        if (!isPersistent)
+            this->request = comm.startSend(
+                                           exchange->getExchangeType(),
+                                           (char*) exchange->getHostBuffer().getPointer(),
+                                           bytes,
+                                           exchange->getCommunicationTag());
     }
 
     bool executeIntern()
@@ -62,12 +71,16 @@ public:
         if (this->request == nullptr)
             throw std::runtime_error("request was nullptr (call executeIntern after freed");
 
+        Environment<DIM>::get().EnvironmentController().getCommunicator().progress();
+
         int flag=0;
         MPI_CHECK(MPI_Test(this->request, &flag, &(this->status)));
 
         if (flag) //finished
         {
-            delete this->request;
+            /* persistent requests are owned by the communicator */
+            if (!isPersistent)
+                delete this->request;
             this->request = nullptr;
             this->setFinished();
             return true;
@@ -94,6 +107,7 @@ private:
     Exchange<TYPE, DIM> *exchange;
     MPI_Request *request;
     MPI_Status status;
+    bool isPersistent;
 };
 
 } //namespace PMacc
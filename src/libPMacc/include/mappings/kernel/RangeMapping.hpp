@@ -0,0 +1,101 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "dimensions/DataSpace.hpp"
+
+namespace PMacc
+{
+
+template<class baseClass>
+class RangeMapping;
+
+/** mapping of a box of supercells inside of CORE+BORDER
+ *
+ * The offset of the box is relative to the first supercell of the
+ * CORE+BORDER area. A box with the size of CORE+BORDER and offset zero
+ * maps the same supercells as AreaMapping<CORE+BORDER>.
+ */
+template<
+template<unsigned, class> class baseClass,
+unsigned DIM,
+class SuperCellSize_
+>
+class RangeMapping<baseClass<DIM, SuperCellSize_> > : public baseClass<DIM, SuperCellSize_>
+{
+public:
+    typedef baseClass<DIM, SuperCellSize_> BaseClass;
+
+    enum
+    {
+        AreaType = CORE + BORDER, Dim = BaseClass::Dim
+    };
+
+
+    typedef typename BaseClass::SuperCellSize SuperCellSize;
+
+    /**
+     * @param base mapping description
+     * @param offset first supercell of the box relative to the CORE+BORDER origin
+     * @param size number of supercells of the box
+     */
+    HINLINE RangeMapping(BaseClass base, const DataSpace<DIM>& offset, const DataSpace<DIM>& size) :
+        BaseClass(base), offset(offset), size(size)
+    {
+    }
+
+    /**
+     * Generate grid dimension information for kernel calls
+     *
+     * @return size of the grid
+     */
+    HINLINE DataSpace<DIM> getGridDim() const
+    {
+        return size;
+    }
+
+    /**
+     * Returns index of current logical block
+     *
+     * @param realSuperCellIdx current SuperCell index (block index)
+     * @return mapped SuperCell index
+     */
+    HDINLINE DataSpace<DIM> getSuperCellIndex(const DataSpace<DIM>& realSuperCellIdx) const
+    {
+        return realSuperCellIdx + offset + this->getGuardingSuperCells();
+    }
+
+    /** true if the box contains no supercell */
+    HINLINE bool isEmpty() const
+    {
+        return size.productOfComponents() == 0;
+    }
+
+private:
+    PMACC_ALIGN(offset, DataSpace<DIM>);
+    PMACC_ALIGN(size, DataSpace<DIM>);
+
+};
+
+} // namespace PMacc
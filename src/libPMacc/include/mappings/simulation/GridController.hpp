@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Rene Widera,
- *                     Wolfgang Hoenig, Benjamin Worpitz
+ *                     Wolfgang Hoenig, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -53,8 +53,9 @@ namespace PMacc
              *
              * @param nodes number of GPU nodes in each dimension
              * @param periodic specifying whether the grid is periodic (1) or not (0) in each dimension
+             * @param topologyAwarePlacement place the ranks of a node into a compact block of the grid
              */
-            void init(DataSpace<DIM> nodes, DataSpace<DIM> periodic = DataSpace<DIM>())
+            void init(DataSpace<DIM> nodes, DataSpace<DIM> periodic = DataSpace<DIM>(), bool topologyAwarePlacement = false)
             {
                 static bool commIsInit = false;
                 if (!commIsInit)
@@ -87,7 +88,7 @@ namespace PMacc
                         periodicTmp[2] = periodic[2];
                     }
 
-                    comm.init(tmp, periodicTmp);
+                    comm.init(tmp, periodicTmp, topologyAwarePlacement);
                     commIsInit = true;
 
                     Environment<DIM>::get().EnvironmentController().setCommunicator(comm);
@@ -138,6 +139,10 @@ namespace PMacc
             /**
              * Returns the global MPI rank of the caller among all hosts.
              *
+             * The rank is the rank in getCommunicator().getMPIComm(), collective
+             * operations which are indexed with this rank must use this communicator
+             * (with topology aware placement it is not the rank in MPI_COMM_WORLD).
+             *
              * @return global MPI rank
              */
             uint32_t getGlobalRank()
@@ -223,13 +228,33 @@ namespace PMacc
                 return comm;
             }
 
+            /**
+             * Select the exchange of the guards of fields
+             *
+             * @param enable true: exchange dimension by dimension via the faces
+             *               (\see GridBuffer::setDimensionOrderedExchange),
+             *               false: exchange with all 26 neighbors
+             */
+            void setDimensionOrderedGuardExchange(bool enable)
+            {
+                dimensionOrderedGuardExchange = enable;
+            }
+
+            /**
+             * Returns if fields should exchange their guards dimension by dimension
+             */
+            bool isDimensionOrderedGuardExchange() const
+            {
+                return dimensionOrderedGuardExchange;
+            }
+
         private:
 
             friend class Environment<DIM>;
             /**
              * Constructor
              */
-            GridController() : gpuNodes(DataSpace<DIM>())
+            GridController() : gpuNodes(DataSpace<DIM>()), dimensionOrderedGuardExchange(false)
             {
 
             }
@@ -293,6 +318,11 @@ namespace PMacc
              * number of GPU nodes for each direction
              */
             DataSpace<DIM> gpuNodes;
+
+            /**
+             * \see setDimensionOrderedGuardExchange
+             */
+            bool dimensionOrderedGuardExchange;
         };
 
         template <unsigned DIM>
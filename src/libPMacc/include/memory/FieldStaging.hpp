@@ -0,0 +1,177 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace memory
+{
+namespace detail
+{
+
+/** de-interleave one row of cells
+ *
+ * the component loop is unrolled at compile time, the cell loop has
+ * unit stride in all destinations and can be vectorized
+ */
+template<uint32_t T_nComponents, typename T_Type>
+inline void deinterleaveRow(const T_Type* src, T_Type* const* dst, const size_t dstOffset, const size_t numCells)
+{
+    T_Type* dstRow[T_nComponents];
+    for (uint32_t c = 0; c < T_nComponents; ++c)
+        dstRow[c] = dst[c] + dstOffset;
+
+    for (size_t x = 0; x < numCells; ++x)
+        for (uint32_t c = 0; c < T_nComponents; ++c)
+            dstRow[c][x] = src[x * T_nComponents + c];
+}
+
+template<typename T_Type>
+inline void deinterleaveRow(const T_Type* src, T_Type* const* dst, const size_t dstOffset,
+                            const size_t numCells, const uint32_t nComponents)
+{
+    switch (nComponents)
+    {
+    case 1:
+        std::memcpy(dst[0] + dstOffset, src, numCells * sizeof(T_Type));
+        break;
+    case 2:
+        deinterleaveRow<2>(src, dst, dstOffset, numCells);
+        break;
+    case 3:
+        deinterleaveRow<3>(src, dst, dstOffset, numCells);
+        break;
+    case 4:
+        deinterleaveRow<4>(src, dst, dstOffset, numCells);
+        break;
+    default:
+        for (size_t x = 0; x < numCells; ++x)
+            for (uint32_t c = 0; c < nComponents; ++c)
+                dst[c][dstOffset + x] = src[x * nComponents + c];
+    }
+}
+
+} //namespace detail
+
+/** copy a box of cells of an interleaved field into one contiguous buffer per component
+ *
+ * The field is stored as [z][y][x][component] (2D: z size is one),
+ * each destination gets the box as [z][y][x] without guards.
+ * The rows (y,z) of the box are distributed over the OpenMP threads.
+ *
+ * @param src first component of the first cell of the field
+ * @param nComponents number of components per cell
+ * @param fieldSize number of cells of the field in x, y, z
+ * @param offset first cell of the box
+ * @param size number of cells of the box in x, y, z
+ * @param dst one pointer per component with space for the cells of the box
+ */
+template<typename T_Type>
+inline void deinterleave(const T_Type* src, const uint32_t nComponents,
+                         const size_t (&fieldSize)[3], const size_t (&offset)[3], const size_t (&size)[3],
+                         T_Type* const* dst)
+{
+    const int64_t numRows = int64_t(size[1] * size[2]);
+
+    #pragma omp parallel for
+    for (int64_t row = 0; row < numRows; ++row)
+    {
+        const size_t y = size_t(row) % size[1];
+        const size_t z = size_t(row) / size[1];
+        const size_t srcCell = ((z + offset[2]) * fieldSize[1] + y + offset[1]) * fieldSize[0] + offset[0];
+
+        detail::deinterleaveRow(src + srcCell * nComponents, dst, size_t(row) * size[0], size[0], nComponents);
+    }
+}
+
+/** staging buffer for writing the components of a field
+ *
+ * The memory is kept between two calls of stage() and only grows,
+ * repeated dumps of the same field sizes do not allocate host memory.
+ */
+template<typename T_Type>
+class FieldStaging
+{
+public:
+
+    FieldStaging() : numCells(0)
+    {
+    }
+
+    /** de-interleave a box of a field, see deinterleave()
+     *
+     * the result is valid until the next call of stage()
+     */
+    void stage(const T_Type* src, const uint32_t nComponents,
+               const size_t (&fieldSize)[3], const size_t (&offset)[3], const size_t (&size)[3])
+    {
+        numCells = size[0] * size[1] * size[2];
+        if (buffer.size() < numCells * nComponents)
+            buffer.resize(numCells * nComponents);
+
+        components.resize(nComponents);
+        for (uint32_t c = 0; c < nComponents; ++c)
+            components[c] = buffer.data() + c * numCells;
+
+        deinterleave(src, nComponents, fieldSize, offset, size, components.data());
+    }
+
+    /** contiguous cells of a component of the last stage() call */
+    T_Type* getComponent(const uint32_t component)
+    {
+        return components[component];
+    }
+
+    const T_Type* getComponent(const uint32_t component) const
+    {
+        return components[component];
+    }
+
+    /** number of cells of the last stage() call */
+    size_t getNumCells() const
+    {
+        return numCells;
+    }
+
+    /** release the memory */
+    void clear()
+    {
+        std::vector<T_Type>().swap(buffer);
+        components.clear();
+        numCells = 0;
+    }
+
+private:
+    std::vector<T_Type> buffer;
+    std::vector<T_Type*> components;
+    size_t numCells;
+};
+
+} //namespace memory
+} //namespace PMacc
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -77,6 +77,35 @@ namespace PMacc
             return communicationTag;
         }
 
+        /**
+         * Returns if the exchange owns a persistent MPI request
+         * (\see ICommunicator::createPersistentSend)
+         */
+        bool hasPersistentRequest() const
+        {
+            return persistentRequestValid;
+        }
+
+        /**
+         * Returns the id of the persistent MPI request
+         */
+        uint32_t getPersistentRequest() const
+        {
+            return persistentRequest;
+        }
+
+        /**
+         * Set the persistent MPI request, the exchange frees the request
+         * on destruction
+         *
+         * @param id id of the request
+         */
+        void setPersistentRequest(uint32_t id)
+        {
+            persistentRequest = id;
+            persistentRequestValid = true;
+        }
+
         virtual bool hasDeviceDoubleBuffer()=0;
 
         virtual DeviceBuffer<TYPE, DIM>& getDeviceDoubleBuffer()=0;
@@ -85,13 +114,17 @@ namespace PMacc
 
         Exchange(uint32_t extype, uint32_t tag) :
         exchange(extype),
-        communicationTag(tag)
+        communicationTag(tag),
+        persistentRequest(0),
+        persistentRequestValid(false)
         {
 
         }
 
         uint32_t exchange;
         uint32_t communicationTag;
+        uint32_t persistentRequest;
+        bool persistentRequestValid;
     };
 
 }
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, agent
  *
  * This file is part of libPMacc.
  *
@@ -24,6 +24,7 @@
 #include "dimensions/GridLayout.hpp"
 #include "mappings/simulation/GridController.hpp"
 #include "memory/buffers/Exchange.hpp"
+#include "memory/buffers/ExchangeRegion.hpp"
 #include "memory/dataTypes/Mask.hpp"
 #include "memory/buffers/DeviceBufferIntern.hpp"
 #include "memory/buffers/HostBufferIntern.hpp"
@@ -45,30 +46,26 @@ namespace PMacc
     {
     public:
 
+        /**
+         * @param extendOverLowerDims (only for faces) the exchange covers the full
+         *        buffer (including the guards) in all dimensions lower than the
+         *        dimension of the face, used for the dimension ordered exchange
+         */
         ExchangeIntern(DeviceBuffer<TYPE, DIM>& source, GridLayout<DIM> memoryLayout, DataSpace<DIM> guardingCells, uint32_t exchange,
-                       uint32_t communicationTag, uint32_t area = BORDER, bool sizeOnDevice = false) :
+                       uint32_t communicationTag, uint32_t area = BORDER, bool sizeOnDevice = false, bool extendOverLowerDims = false) :
         Exchange<TYPE, DIM>(exchange, communicationTag), deviceDoubleBuffer(nullptr)
         {
 
             PMACC_ASSERT(!guardingCells.isOneDimensionGreaterThan(memoryLayout.getGuard()));
 
-            DataSpace<DIM> tmp_size = memoryLayout.getDataSpaceWithoutGuarding();
-            /*
-              DataSpace<DIM> tmp_size = memoryLayout.getDataSpace() - memoryLayout.getGuard() -
-                      memoryLayout.getGuard(); delete on each side 2xguard*/
-
-            DataSpace<DIM> exchangeDimensions = exchangeTypeToDim(exchange);
-
-            for (uint32_t dim = 0; dim < DIM; dim++)
-            {
-                if (DIM > dim && exchangeDimensions[dim] == 1)
-                    tmp_size[dim] = guardingCells[dim];
-            }
+            const ExchangeRegion<DIM> region(memoryLayout, guardingCells, exchange, area, extendOverLowerDims);
+            const DataSpace<DIM> tmp_size = region.size;
+            const DataSpace<DIM> tmp_offset = region.offset;
 
             /*This is only a pointer to other device data
              */
             this->deviceBuffer = new DeviceBufferIntern<TYPE, DIM > (source, tmp_size,
-                                                                     exchangeTypeToOffset(exchange, memoryLayout, guardingCells, area),
+                                                                     tmp_offset,
                                                                      sizeOnDevice);
             if (DIM > DIM1)
             {
@@ -101,24 +98,13 @@ namespace PMacc
          */
         DataSpace<DIM> exchangeTypeToDim(uint32_t exchange) const
         {
-            DataSpace<DIM> result;
-
-            Mask exchangeMask(exchange);
-
-            if (exchangeMask.containsExchangeType(LEFT) || exchangeMask.containsExchangeType(RIGHT))
-                result[0] = 1;
-
-            if (DIM > DIM1 && (exchangeMask.containsExchangeType(TOP) || exchangeMask.containsExchangeType(BOTTOM)))
-                result[1] = 1;
-
-            if (DIM > DIM2 && (exchangeMask.containsExchangeType(FRONT) || exchangeMask.containsExchangeType(BACK)))
-                result[2] = 1;
-
-            return result;
+            return ExchangeRegion<DIM>::exchangeTypeToDim(exchange);
         }
 
         virtual ~ExchangeIntern()
         {
+            if (this->hasPersistentRequest())
+                Environment<>::get().EnvironmentController().getCommunicator().freePersistent(this->getPersistentRequest());
             __delete(hostBuffer);
             __delete(deviceBuffer);
             __delete(deviceDoubleBuffer);
@@ -127,71 +113,7 @@ namespace PMacc
         DataSpace<DIM> exchangeTypeToOffset(uint32_t exchange, GridLayout<DIM> &memoryLayout,
                                             DataSpace<DIM> guardingCells, uint32_t area) const
         {
-            DataSpace<DIM> size = memoryLayout.getDataSpace();
-            DataSpace<DIM> border = memoryLayout.getGuard();
-            Mask mask(exchange);
-            DataSpace<DIM> tmp_offset;
-            if (DIM >= DIM1)
-            {
-                if (mask.containsExchangeType(RIGHT))
-                {
-                    tmp_offset[0] = size[0] - border[0] - guardingCells[0];
-                    if (area == GUARD)
-                    {
-                        tmp_offset[0] += guardingCells[0];
-                    }
-                    /* std::cout<<"offset="<<tmp_offset[0]<<"border"<<border[0]<<std::endl;*/
-                }
-                else
-                {
-                    tmp_offset[0] = border[0];
-                    if (area == GUARD && mask.containsExchangeType(LEFT))
-                    {
-                        tmp_offset[0] -= guardingCells[0];
-                    }
-                }
-            }
-            if (DIM >= DIM2)
-            {
-                if (mask.containsExchangeType(BOTTOM))
-                {
-                    tmp_offset[1] = size[1] - border[1] - guardingCells[1];
-                    if (area == GUARD)
-                    {
-                        tmp_offset[1] += guardingCells[1];
-                    }
-                }
-                else
-                {
-                    tmp_offset[1] = border[1];
-                    if (area == GUARD && mask.containsExchangeType(TOP))
-                    {
-                        tmp_offset[1] -= guardingCells[1];
-                    }
-                }
-            }
-            if (DIM == DIM3)
-            {
-                if (mask.containsExchangeType(BACK))
-                {
-                    tmp_offset[2] = size[2] - border[2] - guardingCells[2];
-                    if (area == GUARD)
-                    {
-                        tmp_offset[2] += guardingCells[2];
-                    }
-                }
-                else /*all other begin from front*/
-                {
-                    tmp_offset[2] = border[2];
-                    if (area == GUARD && mask.containsExchangeType(FRONT))
-                    {
-                        tmp_offset[2] -= guardingCells[2];
-                    }
-                }
-            }
-
-            return tmp_offset;
-
+            return ExchangeRegion<DIM>::exchangeTypeToOffset(exchange, memoryLayout, guardingCells, area);
         }
 
         virtual HostBuffer<TYPE, DIM>& getHostBuffer()
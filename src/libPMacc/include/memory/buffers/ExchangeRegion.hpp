@@ -0,0 +1,172 @@
+/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "dimensions/GridLayout.hpp"
+#include "dimensions/DataSpace.hpp"
+#include "memory/dataTypes/Mask.hpp"
+#include "pmacc_types.hpp"
+
+/* this file is used by host only tools, it must not depend on the device
+ * buffers or the event system */
+
+namespace PMacc
+{
+
+    /**
+     * Part of a buffer which is sent or received by an exchange (\see ExchangeIntern).
+     */
+    template <unsigned DIM>
+    struct ExchangeRegion
+    {
+        DataSpace<DIM> offset;
+        DataSpace<DIM> size;
+
+        /**
+         * @param memoryLayout layout of the buffer including the guards
+         * @param guardingCells size of the exchange in the exchanged dimensions
+         * @param exchange the exchange mask
+         * @param area BORDER (send) or GUARD (receive)
+         * @param extendOverLowerDims (only for faces) the exchange covers the full
+         *        buffer (including the guards) in all dimensions lower than the
+         *        dimension of the face, used for the dimension ordered exchange
+         */
+        HDINLINE ExchangeRegion(const GridLayout<DIM>& memoryLayout, DataSpace<DIM> guardingCells, uint32_t exchange,
+                                uint32_t area, bool extendOverLowerDims = false)
+        {
+            size = memoryLayout.getDataSpaceWithoutGuarding();
+
+            DataSpace<DIM> exchangeDimensions = exchangeTypeToDim(exchange);
+
+            for (uint32_t dim = 0; dim < DIM; dim++)
+            {
+                if (DIM > dim && exchangeDimensions[dim] == 1)
+                    size[dim] = guardingCells[dim];
+            }
+
+            offset = exchangeTypeToOffset(exchange, memoryLayout, guardingCells, area);
+
+            if (extendOverLowerDims)
+            {
+                /* guards of the lower dimensions are filled by the exchanges before */
+                for (uint32_t dim = 0; dim < DIM && exchangeDimensions[dim] == 0; dim++)
+                {
+                    size[dim] = memoryLayout.getDataSpace()[dim];
+                    offset[dim] = 0;
+                }
+            }
+        }
+
+        /**
+         * specifies in returned DataSpace which dimensions exchange data
+         * @param exchange the exchange mask
+         * @return DIM1 DataSpace of size 3 where 1 means exchange, 0 means no exchange
+         */
+        static HDINLINE DataSpace<DIM> exchangeTypeToDim(uint32_t exchange)
+        {
+            DataSpace<DIM> result;
+
+            Mask exchangeMask(exchange);
+
+            if (exchangeMask.containsExchangeType(LEFT) || exchangeMask.containsExchangeType(RIGHT))
+                result[0] = 1;
+
+            if (DIM > DIM1 && (exchangeMask.containsExchangeType(TOP) || exchangeMask.containsExchangeType(BOTTOM)))
+                result[1] = 1;
+
+            if (DIM > DIM2 && (exchangeMask.containsExchangeType(FRONT) || exchangeMask.containsExchangeType(BACK)))
+                result[2] = 1;
+
+            return result;
+        }
+
+        static HDINLINE DataSpace<DIM> exchangeTypeToOffset(uint32_t exchange, const GridLayout<DIM> &memoryLayout,
+                                                            DataSpace<DIM> guardingCells, uint32_t area)
+        {
+            DataSpace<DIM> size = memoryLayout.getDataSpace();
+            DataSpace<DIM> border = memoryLayout.getGuard();
+            Mask mask(exchange);
+            DataSpace<DIM> tmp_offset;
+            if (DIM >= DIM1)
+            {
+                if (mask.containsExchangeType(RIGHT))
+                {
+                    tmp_offset[0] = size[0] - border[0] - guardingCells[0];
+                    if (area == GUARD)
+                    {
+                        tmp_offset[0] += guardingCells[0];
+                    }
+                    /* std::cout<<"offset="<<tmp_offset[0]<<"border"<<border[0]<<std::endl;*/
+                }
+                else
+                {
+                    tmp_offset[0] = border[0];
+                    if (area == GUARD && mask.containsExchangeType(LEFT))
+                    {
+                        tmp_offset[0] -= guardingCells[0];
+                    }
+                }
+            }
+            if (DIM >= DIM2)
+            {
+                if (mask.containsExchangeType(BOTTOM))
+                {
+                    tmp_offset[1] = size[1] - border[1] - guardingCells[1];
+                    if (area == GUARD)
+                    {
+                        tmp_offset[1] += guardingCells[1];
+                    }
+                }
+                else
+                {
+                    tmp_offset[1] = border[1];
+                    if (area == GUARD && mask.containsExchangeType(TOP))
+                    {
+                        tmp_offset[1] -= guardingCells[1];
+                    }
+                }
+            }
+            if (DIM == DIM3)
+            {
+                if (mask.containsExchangeType(BACK))
+                {
+                    tmp_offset[2] = size[2] - border[2] - guardingCells[2];
+                    if (area == GUARD)
+                    {
+                        tmp_offset[2] += guardingCells[2];
+                    }
+                }
+                else /*all other begin from front*/
+                {
+                    tmp_offset[2] = border[2];
+                    if (area == GUARD && mask.containsExchangeType(FRONT))
+                    {
+                        tmp_offset[2] -= guardingCells[2];
+                    }
+                }
+            }
+
+            return tmp_offset;
+        }
+    };
+
+} //namespace PMacc
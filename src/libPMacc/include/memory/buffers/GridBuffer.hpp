@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, Alexander Grund
+/* Copyright 2013-2017 Rene Widera, Benjamin Worpitz, Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -174,6 +174,25 @@ public:
         };
     }
 
+    /**
+     * Exchange the guards dimension by dimension.
+     *
+     * Only the faces of the exchanges added with addExchange() are used.
+     * asyncCommunication() exchanges x first, then y including the x-guards,
+     * then z including the x- and y-guards. Edges and corners reach the
+     * diagonal neighbors via the face neighbors, at most 6 instead of
+     * 26 messages are sent.
+     *
+     * Must be called before the first exchange is added and is only valid
+     * for exchanges which copy the BORDER of the neighbor into the own GUARD.
+     */
+    void setDimensionOrderedExchange()
+    {
+        if (hasOneExchange)
+            throw std::runtime_error("dimension ordered exchange must be set before exchanges are added");
+        dimensionOrdered = true;
+    }
+
     /**
      * Add Exchange in GridBuffer memory space.
      *
@@ -202,6 +221,20 @@ public:
 
         lastUsedCommunicationTag = communicationTag;
 
+        if (dimensionOrdered)
+        {
+            if (dataPlace != GUARD)
+                throw std::runtime_error("dimension ordered exchange is only supported for dataPlace GUARD");
+
+            /* edges and corners are transferred via the faces */
+            Mask faces;
+            for (uint32_t ex = 1; ex < 27; ++ex)
+                if (receive.isSet(ex) && isFace(ex))
+                    faces = faces + Mask(ex);
+            addExchangeFaces(faces, guardingCells, communicationTag, sizeOnDeviceSend, sizeOnDeviceReceive);
+            return;
+        }
+
         receiveMask = receiveMask + receive;
         sendMask = this->receiveMask.getMirroredMask();
         Mask send = receive.getMirroredMask();
@@ -244,6 +277,8 @@ public:
                                                           uniqCommunicationTag,
                                                           dataPlace == GUARD ? GUARD : BORDER,
                                                           sizeOnDeviceReceive);
+                /* guard exchanges have the same size and neighbor in each step */
+                createPersistentRequests(*sendExchanges[ex], *receiveExchanges[recvex]);
             }
         }
     }
@@ -450,6 +485,9 @@ public:
      */
     EventTask asyncCommunication(EventTask serialEvent)
     {
+        if (dimensionOrdered)
+            return asyncCommunicationDimensionOrdered(serialEvent);
+
         EventTask evR;
         for (uint32_t i = 0; i < maxExchange; ++i)
         {
@@ -503,8 +541,107 @@ private:
 
     friend class Environment<DIM>;
 
+    /** create persistent MPI requests for a pair of fixed size exchanges
+     *
+     * the tasks fall back to not persistent requests if the size of a
+     * send differs from the size of the exchange
+     */
+    void createPersistentRequests(ExchangeIntern<BORDERTYPE, DIM>& sendExchange, ExchangeIntern<BORDERTYPE, DIM>& receiveExchange)
+    {
+        ICommunicator& comm = Environment<DIM>::get().EnvironmentController().getCommunicator();
+
+        HostBuffer<BORDERTYPE, DIM>& sendBuffer = sendExchange.getHostBuffer();
+        sendExchange.setPersistentRequest(
+            comm.createPersistentSend(sendExchange.getExchangeType(),
+                                      (char*) sendBuffer.getPointer(),
+                                      sendBuffer.getDataSpace().productOfComponents() * sizeof (BORDERTYPE),
+                                      sendExchange.getCommunicationTag()));
+
+        HostBuffer<BORDERTYPE, DIM>& receiveBuffer = receiveExchange.getHostBuffer();
+        receiveExchange.setPersistentRequest(
+            comm.createPersistentReceive(receiveExchange.getExchangeType(),
+                                         (char*) receiveBuffer.getBasePointer(),
+                                         receiveBuffer.getDataSpace().productOfComponents() * sizeof (BORDERTYPE),
+                                         receiveExchange.getCommunicationTag()));
+    }
+
+    /** exchange direction is a face (only one dimension is exchanged) */
+    static bool isFace(uint32_t ex)
+    {
+        return ex == LEFT || ex == RIGHT || ex == TOP || ex == BOTTOM || ex == FRONT || ex == BACK;
+    }
+
+    /** add face exchanges for the dimension ordered exchange
+     *
+     * each face covers the full buffer in all lower dimensions
+     */
+    void addExchangeFaces(const Mask &receive, DataSpace<DIM> guardingCells, uint32_t communicationTag,
+                          bool sizeOnDeviceSend, bool sizeOnDeviceReceive)
+    {
+        receiveMask = receiveMask + receive;
+        sendMask = this->receiveMask.getMirroredMask();
+        Mask send = receive.getMirroredMask();
+
+        for (uint32_t ex = 1; ex < 27; ++ex)
+        {
+            if (!send.isSet(ex))
+                continue;
+
+            uint32_t uniqCommunicationTag = (communicationTag << 5) | ex;
+            if (!hasOneExchange && !privateGridBuffer::UniquTag::getInstance().isTagUniqu(uniqCommunicationTag))
+            {
+                std::stringstream message;
+                message << "unique exchange communication tag ("
+                    << uniqCommunicationTag << ") witch is created from communicationTag ("
+                    << communicationTag << ") already used for other GridBuffer exchange";
+                throw std::runtime_error(message.str());
+            }
+            hasOneExchange = true;
+
+            if (sendExchanges[ex] != nullptr)
+            {
+                throw std::runtime_error("Exchange already added!");
+            }
+
+            maxExchange = std::max(maxExchange, ex + 1u);
+            sendExchanges[ex] = new ExchangeIntern<BORDERTYPE, DIM > (this->getDeviceBuffer(), gridLayout, guardingCells,
+                                                                      ex, uniqCommunicationTag,
+                                                                      BORDER, sizeOnDeviceSend, true);
+            ExchangeType recvex = Mask::getMirroredExchangeType(ex);
+            maxExchange = std::max(maxExchange, recvex + 1u);
+            receiveExchanges[recvex] = new ExchangeIntern<BORDERTYPE, DIM > (this->getDeviceBuffer(), gridLayout, guardingCells,
+                                                                             recvex, uniqCommunicationTag,
+                                                                             GUARD, sizeOnDeviceReceive, true);
+            createPersistentRequests(*sendExchanges[ex], *receiveExchanges[recvex]);
+        }
+    }
+
+    /** exchange x, then y, then z
+     *
+     * the sends of a dimension start after the guards of all lower
+     * dimensions are received
+     */
+    EventTask asyncCommunicationDimensionOrdered(EventTask serialEvent)
+    {
+        const uint32_t faces[3][2] = {{LEFT, RIGHT}, {TOP, BOTTOM}, {FRONT, BACK}};
+
+        EventTask lastDim = serialEvent;
+        for (uint32_t d = 0; d < DIM; ++d)
+        {
+            EventTask evR;
+            for (uint32_t i = 0; i < 2; ++i)
+            {
+                evR += asyncReceive(lastDim, faces[d][i]);
+                evR += asyncSend(lastDim, Mask::getMirroredExchangeType(faces[d][i]));
+            }
+            lastDim = lastDim + evR;
+        }
+        return lastDim;
+    }
+
     void init()
     {
+        dimensionOrdered = false;
         for (uint32_t i = 0; i < 27; ++i)
         {
             sendExchanges[i] = nullptr;
@@ -531,6 +668,8 @@ protected:
     EventTask sendEvents[27];
 
     uint32_t maxExchange; //use max exchanges and run over the array is faster as use set from stl
+    //! \see setDimensionOrderedExchange
+    bool dimensionOrdered;
 };
 
 }
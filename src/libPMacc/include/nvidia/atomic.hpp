@@ -1,4 +1,4 @@
-/* Copyright 2015-2017 Rene Widera, Alexander Grund
+/* Copyright 2015-2017 Rene Widera, Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -214,5 +214,61 @@ atomicAdd(T_Type* ptr, const T_Type value)
     return detail::AtomicAdd<T_Type>()(ptr, value);
 }
 
+/** warp aggregated atomic add to an element of an array (e.g. a histogram)
+ *
+ * Threads of a warp which add to the same element are combined by a warp
+ * reduction, thus only one atomic operation per distinct element and warp is
+ * performed. This is fast for peaked distributions where most threads of a
+ * warp hit the same element. After `T_maxRounds` distinct elements the
+ * remaining threads fall back to a plain atomic operation, this bounds the
+ * overhead for uniform distributions.
+ *
+ * - must be called by all threads of a warp, threads without a value pass a
+ *   negative index
+ * - a plain atomic operation per thread is used if the warp is not complete
+ *   or the compute architecture does not support warp shuffles (PTX ISA < 3.0)
+ *
+ * @tparam T_maxRounds maximum number of aggregated elements per call
+ * @param bins pointer to the first element
+ * @param binIdx index of the element, ignored if negative
+ * @param value value to add
+ */
+template<uint32_t T_maxRounds = 4, typename T_Type>
+DINLINE void
+atomicAddToBin(T_Type* bins, const int binIdx, const T_Type value)
+{
+#if (__CUDA_ARCH__ >= 300)
+    const uint32_t activeMask = __ballot(1);
+    if (activeMask == 0xFFFFFFFFu)
+    {
+        bool isPending = binIdx >= 0;
+        for (uint32_t round = 0; round < T_maxRounds; ++round)
+        {
+            const uint32_t pendingMask = __ballot(isPending);
+            if (pendingMask == 0u)
+                return;
+            /* the lowest pending thread selects the element of this round */
+            const int leader = __ffs(pendingMask) - 1;
+            const int leaderBin = warpBroadcast(binIdx, leader);
+            const bool isMember = isPending && binIdx == leaderBin;
+
+            T_Type sum = isMember ? value : T_Type(0);
+            for (int laneMask = 16; laneMask >= 1; laneMask /= 2)
+                sum += warpShuffleXor(sum, laneMask);
+
+            if (getLaneId() == static_cast<uint32_t>(leader))
+                atomicAdd(bins + leaderBin, sum);
+            if (isMember)
+                isPending = false;
+        }
+        if (isPending)
+            atomicAdd(bins + binIdx, value);
+        return;
+    }
+#endif
+    if (binIdx >= 0)
+        atomicAdd(bins + binIdx, value);
+}
+
 } //namespace nvidia
 } //namespace PMacc
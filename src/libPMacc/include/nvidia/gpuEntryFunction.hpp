@@ -1,4 +1,4 @@
-/* Copyright 2016-2017 Felix Rene Widera
+/* Copyright 2016-2017 Felix Rene Widera, agent
  *
  * This file is part of libPMacc.
  *
@@ -47,5 +47,77 @@ namespace nvidia
     {
         kernel( args ... );
     }
+
+    /** start gpuEntryFunction on the device
+     *
+     * the only place where PMACC_KERNEL uses the CUDA launch syntax
+     *
+     * @param gridExtent grid extent of the launch (castable to CUDA dim3)
+     * @param blockExtent block extent of the launch (castable to CUDA dim3)
+     * @param sharedMemByte dynamic shared memory used by the kernel (in byte)
+     * @param stream cuda stream for the launch
+     * @param kernel functor for device execution
+     * @param args arguments for the functor
+     */
+    template<
+        typename T_VectorGrid,
+        typename T_VectorBlock,
+        typename T_KernelFunctor,
+        typename ... T_Args
+    >
+    HINLINE void launchGpuEntryFunction(
+        T_VectorGrid const & gridExtent,
+        T_VectorBlock const & blockExtent,
+        size_t const sharedMemByte,
+        cudaStream_t const stream,
+        T_KernelFunctor const & kernel,
+        T_Args const & ... args
+    )
+    {
+        gpuEntryFunction<<<
+            gridExtent,
+            blockExtent,
+            sharedMemByte,
+            stream
+        >>>(
+            kernel,
+            args ...
+        );
+    }
+
+    /** attributes of the entry function of a kernel
+     *
+     * e.g. `sharedSizeBytes` is the static shared memory (PMACC_SMEM) which
+     * a block needs in addition to the dynamic shared memory of a launch
+     *
+     * @tparam T_KernelFunctor type of the functor for device execution
+     * @tparam T_Args types of the arguments as passed to PMACC_KERNEL
+     */
+    template<
+        typename T_KernelFunctor,
+        typename ... T_Args
+    >
+    HINLINE cudaFuncAttributes getEntryFunctionAttributes( )
+    {
+        cudaFuncAttributes attributes;
+        CUDA_CHECK( cudaFuncGetAttributes(
+            &attributes,
+            gpuEntryFunction<
+                T_KernelFunctor,
+                T_Args ...
+            >
+        ) );
+        return attributes;
+    }
+
+    /** shared memory (static and dynamic) of a block on the current device in bytes */
+    HINLINE size_t getMaxSharedMemPerBlock( )
+    {
+        int device;
+        CUDA_CHECK( cudaGetDevice( &device ) );
+        int bytes;
+        CUDA_CHECK( cudaDeviceGetAttribute( &bytes, cudaDevAttrMaxSharedMemoryPerBlock, device ) );
+        return static_cast< size_t >( bytes );
+    }
 } //namespace nvidia
 } //namespace PMacc
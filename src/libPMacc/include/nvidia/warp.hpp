@@ -1,4 +1,4 @@
-/* Copyright 2015-2017 Rene Widera, Alexander Grund
+/* Copyright 2015-2017 Rene Widera, Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -102,6 +102,35 @@ DINLINE double warpBroadcast(double data, const int32_t srcLaneId)
     pData[1] = warpBroadcast(pData[1], srcLaneId);
     return data;
 }
+
+/** exchange data within a warp in a butterfly pattern
+ *
+ * each thread gets the value of the thread with the lane id `laneId ^ laneMask`
+ * (all threads of the warp must participate)
+ *
+ * required PTX ISA >=3.0
+ */
+DINLINE int32_t warpShuffleXor(const int32_t data, const int32_t laneMask)
+{
+    return  __shfl_xor(data, laneMask);
+}
+/**
+ * Shuffle a 32bit float
+ */
+DINLINE float warpShuffleXor(const float data, const int32_t laneMask)
+{
+    return  __shfl_xor(data, laneMask);
+}
+/**
+ * Shuffle a 64bit float by using 2 32bit shuffles
+ */
+DINLINE double warpShuffleXor(double data, const int32_t laneMask)
+{
+    float* const pData = reinterpret_cast<float*>(&data);
+    pData[0] = warpShuffleXor(pData[0], laneMask);
+    pData[1] = warpShuffleXor(pData[1], laneMask);
+    return data;
+}
 #endif
 
 } //namespace nvidia
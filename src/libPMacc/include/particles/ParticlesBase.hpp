@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Rene Widera, Benjamin Worpitz,
- *                     Alexander Grund
+ *                     Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -72,7 +72,11 @@ public:
     {
         Dim = MappingDesc::Dim,
         Exchanges = traits::NumberOfExchanges<Dim>::value,
-        TileSize = math::CT::volume<typename MappingDesc::SuperCellSize>::type::value
+        TileSize = math::CT::volume<typename MappingDesc::SuperCellSize>::type::value,
+        /* maximum number of frames of a supercell in sortParticles() */
+        maxSortFrames = 32,
+        /* maximum number of allocations per frame in relocateFrames() */
+        maxRelocateTries = 4
     };
 
     /* Mark this simulation data as a particle type */
@@ -136,7 +140,15 @@ protected:
     void fillGaps()
     {
         AreaMapping<AREA, MappingDesc> mapper(this->cellDescription);
+        fillGaps(mapper);
+    }
 
+    /* fill gaps in all supercells of a mapping
+     * @param mapper mapping of the supercells (e.g. AreaMapping or RangeMapping)
+     */
+    template<class T_Mapping>
+    void fillGaps(const T_Mapping& mapper)
+    {
         PMACC_KERNEL(KernelFillGaps{})
             (mapper.getGridDim(), (int)TileSize)
             (particlesBuffer->getDeviceParticleBox(), mapper);
@@ -147,8 +159,65 @@ protected:
     }
 
 
+    /* Sort the particles of each supercell in an AREA by their cell index
+     *
+     * Afterwards the particles of a cell are contiguous in the frame list
+     * and all gaps are filled.
+     * Supercells with more than maxSortFrames frames are not sorted.
+     *
+     * @tparam AREA area which is used (CORE,BORDER,GUARD or a combination)
+     */
+    template<uint32_t AREA>
+    void sortParticles()
+    {
+        AreaMapping<AREA, MappingDesc> mapper(this->cellDescription);
+
+        PMACC_KERNEL(KernelSortParticles<maxSortFrames>{})
+            (mapper.getGridDim(), (int)TileSize)
+            (particlesBuffer->getDeviceParticleBox(), mapper);
+    }
+
 public:
 
+    /* Count the frames in an AREA per page of the heap
+     *
+     * @tparam AREA area which is used (CORE,BORDER,GUARD or a combination)
+     * @param pageBytes device box, bytes of frames per page are added
+     * @param counters device box, number of frames [0] and particles [1] are added
+     * @param heapBase first byte of the heap
+     * @param pageSize size of a heap page in byte
+     */
+    template<uint32_t AREA, typename T_PageBox, typename T_CounterBox>
+    void countHeapPages(T_PageBox pageBytes, T_CounterBox counters, const char* heapBase, uint32_t pageSize)
+    {
+        AreaMapping<AREA, MappingDesc> mapper(this->cellDescription);
+
+        PMACC_KERNEL(KernelCountHeapPages{})
+            (mapper.getGridDim(), (int)TileSize)
+            (particlesBuffer->getDeviceParticleBox(), pageBytes, counters, heapBase, pageSize, mapper);
+    }
+
+    /* Move the frames in an AREA out of heap pages with less than minPageBytes of frames
+     *
+     * @tparam AREA area which is used (CORE,BORDER,GUARD or a combination)
+     * @param pageBytes device box, result of countHeapPages() for all species
+     * @param counters device box, number of relocated frames [0] is added
+     * @param heapBase first byte of the heap
+     * @param pageSize size of a heap page in byte
+     * @param minPageBytes pages with less bytes of frames are evacuated
+     */
+    template<uint32_t AREA, typename T_PageBox, typename T_CounterBox>
+    void relocateFrames(T_PageBox pageBytes, T_CounterBox counters, const char* heapBase,
+                        uint32_t pageSize, uint32_t minPageBytes)
+    {
+        AreaMapping<AREA, MappingDesc> mapper(this->cellDescription);
+
+        PMACC_KERNEL(KernelRelocateFrames<maxRelocateTries>{})
+            (mapper.getGridDim(), (int)TileSize)
+            (particlesBuffer->getDeviceParticleBox(), pageBytes, counters,
+             heapBase, pageSize, minPageBytes, mapper);
+    }
+
     /* fill gaps in a the complete simulation area (include GUARD)
      */
     void fillAllGaps()
@@ -171,6 +240,12 @@ public:
     template<uint32_t T_area>
     void deleteParticlesInArea();
 
+    /* Delete all particles in all supercells of a mapping
+     * @param mapper mapping of the supercells (e.g. AreaMapping or RangeMapping)
+     */
+    template<class T_Mapping>
+    void deleteParticles(const T_Mapping& mapper);
+
     /* Bash particles in a direction.
      * Copy all particles from the guard of a direction to the device exchange buffer
      */
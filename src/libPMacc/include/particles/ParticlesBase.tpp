@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Heiko Burau, Rene Widera
+/* Copyright 2013-2017 Heiko Burau, Rene Widera, agent
  *
  * This file is part of libPMacc.
  *
@@ -51,6 +51,13 @@ namespace PMacc
     {
 
         AreaMapping<T_area, MappingDesc> mapper(this->cellDescription);
+        deleteParticles(mapper);
+    }
+
+    template<typename T_ParticleDescription, class MappingDesc, typename T_DeviceHeap>
+    template<class T_Mapping>
+    void ParticlesBase<T_ParticleDescription, MappingDesc, T_DeviceHeap>::deleteParticles(const T_Mapping& mapper)
+    {
         auto grid = mapper.getGridDim();
 
         PMACC_KERNEL(KernelDeleteParticles{})
@@ -0,0 +1,193 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace particles
+{
+namespace creation
+{
+
+/** slot of a created particle */
+struct TargetSlot
+{
+    /* thread (slot of the source particle) which creates the particle */
+    uint32_t source;
+    /* target frame, counted from the first frame created for the supercell */
+    uint32_t frame;
+    /* slot in the target frame */
+    uint32_t slot;
+};
+
+/** target frames of a supercell during the creation */
+struct TargetFrames
+{
+    /* number of frames */
+    uint32_t numFrames;
+    /* used slots of the last frame, frameSize if there is no frame */
+    uint32_t fillLevel;
+};
+
+/** create the particles of one source frame with a prefix sum
+ *
+ * Host implementation of CreateParticlesKernel (PIConGPU): the offset of
+ * each thread is the exclusive prefix sum of the number of new particles,
+ * all frames of a pass are allocated at once and each thread writes its
+ * particles to consecutive slots behind the fill level of the last frame.
+ *
+ * @param numNewParticles number of new particles of each thread
+ * @param frameSize number of slots of a frame
+ * @param maxNewFrames maximum number of frames allocated in one pass
+ * @param[in,out] frames target frames of the supercell
+ * @param[out] targets slots of the new particles are appended
+ * @param maxFrames number of frames the heap can provide for the supercell,
+ *        if a pass needs more frames (getEmptyFrame fails) only the slots
+ *        of the available frames are used and the creation stops
+ * @return number of passes
+ */
+inline uint32_t createByPrefixSum(const std::vector<uint32_t>& numNewParticles,
+                                  const uint32_t frameSize,
+                                  const uint32_t maxNewFrames,
+                                  TargetFrames& frames,
+                                  std::vector<TargetSlot>& targets,
+                                  const uint32_t maxFrames = std::numeric_limits<uint32_t>::max())
+{
+    const uint32_t numThreads = numNewParticles.size();
+
+    /* exclusive prefix sum */
+    std::vector<uint32_t> offset(numThreads, 0);
+    uint32_t numCreate = 0;
+    for (uint32_t t = 0; t < numThreads; ++t)
+    {
+        offset[t] = numCreate;
+        numCreate += numNewParticles[t];
+    }
+
+    uint32_t numPasses = 0;
+    uint32_t created = 0;
+    while (created < numCreate)
+    {
+        const uint32_t freeSlots = frameSize - frames.fillLevel;
+        uint32_t passSize = std::min(numCreate - created, freeSlots + maxNewFrames * frameSize);
+        const uint32_t numNewFrames = passSize > freeSlots ? (passSize - freeSlots + frameSize - 1) / frameSize : 0;
+
+        /* frames which could be allocated */
+        const uint32_t numValidFrames = std::min(numNewFrames, maxFrames - std::min(maxFrames, frames.numFrames));
+        const bool isOutOfFrames = numValidFrames < numNewFrames;
+        if (isOutOfFrames)
+            passSize = freeSlots + numValidFrames * frameSize;
+
+        for (uint32_t t = 0; t < numThreads; ++t)
+        {
+            /* particles of the thread which belong to this pass */
+            const uint32_t begin = std::max(offset[t], created);
+            const uint32_t end = std::min(offset[t] + numNewParticles[t], created + passSize);
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                /* frame 0 of the pass is the last frame before the pass */
+                const uint32_t passSlot = frames.fillLevel + i - created;
+                TargetSlot target;
+                target.source = t;
+                target.frame = frames.numFrames - 1 + passSlot / frameSize;
+                target.slot = passSlot % frameSize;
+                targets.push_back(target);
+            }
+        }
+
+        frames.numFrames += numValidFrames;
+        frames.fillLevel += passSize - numValidFrames * frameSize;
+        created += passSize;
+        ++numPasses;
+        if (isOutOfFrames)
+            break;
+    }
+    return numPasses;
+}
+
+/** create the particles of one source frame in rounds
+ *
+ * Host implementation of the former CreateParticlesKernel: in each round
+ * every thread with pending particles creates one particle, the slot is
+ * taken with an atomic increment of the fill level (here in thread order).
+ *
+ * @param numNewParticles number of new particles of each thread
+ * @param frameSize number of slots of a frame
+ * @param[in,out] frames target frames of the supercell
+ * @param[out] targets slots of the new particles are appended
+ * @return number of rounds (including the last round which creates nothing)
+ */
+inline uint32_t createByRounds(const std::vector<uint32_t>& numNewParticles,
+                               const uint32_t frameSize,
+                               TargetFrames& frames,
+                               std::vector<TargetSlot>& targets)
+{
+    const uint32_t numThreads = numNewParticles.size();
+    std::vector<uint32_t> pending(numNewParticles);
+    /* the former kernel keeps the fill level below frameSize */
+    uint32_t fillLevel = frames.fillLevel == frameSize ? 0 : frames.fillLevel;
+
+    uint32_t numRounds = 0;
+    while (true)
+    {
+        ++numRounds;
+        const uint32_t oldFillLevel = fillLevel;
+        for (uint32_t t = 0; t < numThreads; ++t)
+        {
+            if (pending[t] == 0)
+                continue;
+
+            if (frames.numFrames == 0)
+                frames.numFrames = 1;
+
+            const uint32_t targetParId = fillLevel++;
+            TargetSlot target;
+            target.source = t;
+            target.frame = frames.numFrames - 1 + targetParId / frameSize;
+            target.slot = targetParId % frameSize;
+            targets.push_back(target);
+            --pending[t];
+        }
+        if (fillLevel == oldFillLevel)
+            break;
+
+        if (fillLevel >= frameSize)
+        {
+            ++frames.numFrames;
+            fillLevel -= frameSize;
+        }
+    }
+    frames.fillLevel = frames.numFrames == 0 ? frameSize : fillLevel;
+    return numRounds;
+}
+
+} // namespace creation
+} // namespace particles
+} // namespace PMacc
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Felix Schmitt, Heiko Burau, Rene Widera,
- *                     Alexander Grund
+ *                     Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -295,6 +295,40 @@ public:
         return false;
     }
 
+    /**
+     * Replaces a frame of a supercell by an other frame and removes the old frame from the heap.
+     * The particles are not copied, the position in the linked list is kept.
+     * This call is not threadsave, only one thread from a supercell may call this function.
+     * @param oldFrame frame which is part of the supercell
+     * @param newFrame frame which takes the position of oldFrame
+     * @param idx position of supercell
+     */
+    template<typename T_InitMethod>
+    DINLINE void replaceFrame(
+        FramePointer<FrameType, T_InitMethod>& oldFrame,
+        FramePointer<FrameType, T_InitMethod>& newFrame,
+        const DataSpace<DIM> &idx
+    )
+    {
+        FramePtr prev( oldFrame->previousFrame );
+        FramePtr next( oldFrame->nextFrame );
+
+        newFrame->previousFrame = prev;
+        newFrame->nextFrame = next;
+
+        if ( prev.isValid( ) )
+            prev->nextFrame = newFrame;
+        else
+            getSuperCell( idx ).firstFramePtr = newFrame.ptr;
+
+        if ( next.isValid( ) )
+            next->previousFrame = newFrame;
+        else
+            getSuperCell( idx ).lastFramePtr = newFrame.ptr;
+
+        removeFrame( oldFrame );
+    }
+
     HDINLINE SuperCellType& getSuperCell( DataSpace<DIM> idx )
     {
         return BaseType::operator()(idx);
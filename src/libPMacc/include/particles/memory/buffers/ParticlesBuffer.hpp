@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Rene Widera, Benjamin Worpitz,
+ *                     agent
  *
  * This file is part of libPMacc.
  *
@@ -28,6 +29,7 @@
 #include "memory/dataTypes/Mask.hpp"
 #include "particles/memory/buffers/StackExchangeBuffer.hpp"
 #include "eventSystem/EventSystem.hpp"
+#include "communication/MessageAggregator.hpp"
 #include "particles/memory/dataTypes/SuperCell.hpp"
 
 #include "math/Vector.hpp"
@@ -179,7 +181,7 @@ public:
      * @param gpuMemory how many memory on device is used for this instance (in byte)
      */
     ParticlesBuffer(const std::shared_ptr<DeviceHeap>& deviceHeap, DataSpace<DIM> layout, DataSpace<DIM> superCellSize) :
-        m_deviceHeap(deviceHeap), superCellSize(superCellSize), gridSize(layout), framesExchanges(nullptr)
+        m_deviceHeap(deviceHeap), superCellSize(superCellSize), gridSize(layout), framesExchanges(nullptr), communicationTag(0)
     {
 
         exchangeMemoryIndexer = new GridBuffer<BorderFrameIndex, DIM1 > (DataSpace<DIM1 > (0));
@@ -226,6 +228,7 @@ public:
     {
 
         size_t numFrameTypeBorders = usedMemory / SizeOfOneBorderElement;
+        this->communicationTag = communicationTag;
 
         framesExchanges->addExchangeBuffer(receive, DataSpace<DIM1 > (numFrameTypeBorders), communicationTag, true, false);
 
@@ -317,6 +320,8 @@ public:
         /* store each gpu-free event separately to avoid race conditions */
         EventTask framesExchangesGPUEvent;
         EventTask exchangeMemoryIndexerGPUEvent;
+        /* frames and their index are sent with one message (if enabled) */
+        MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), communicationTag);
         EventTask returnEvent = framesExchanges->asyncSend(serialEvent, ex) +
             exchangeMemoryIndexer->asyncSend(serialEvent, ex);
 
@@ -325,7 +330,7 @@ public:
 
     EventTask asyncReceiveParticles(EventTask serialEvent, uint32_t ex)
     {
-
+        MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), communicationTag);
         return framesExchanges->asyncReceive(serialEvent, ex) +
             exchangeMemoryIndexer->asyncReceive(serialEvent, ex);
     }
@@ -377,6 +382,8 @@ private:
     GridBuffer<SuperCellType, DIM> *superCells;
     /*GridBuffer for hold borderFrames, we need a own buffer to create first exchanges without core memory*/
     GridBuffer< FrameType, DIM1, FrameTypeBorder> *framesExchanges;
+    /* communication tag of the exchanges, key of the aggregation phase */
+    uint32_t communicationTag;
 
     DataSpace<DIM> superCellSize;
     DataSpace<DIM> gridSize;
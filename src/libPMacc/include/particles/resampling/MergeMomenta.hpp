@@ -0,0 +1,154 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cmath>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+#ifdef __CUDACC__
+#   define PMACC_MERGE_HDINLINE __host__ __device__ __forceinline__
+#else
+#   define PMACC_MERGE_HDINLINE inline
+#endif
+
+namespace PMacc
+{
+namespace particles
+{
+namespace resampling
+{
+
+/** energy measure of a single particle which is conserved by the merging
+ *
+ * - with mass: gamma - 1, calculated without cancellation for small momenta
+ * - massless: absolute value of the momentum (energy / c)
+ *
+ * @param singleMomentum momentum of a single (not macro) particle
+ * @param mass mass of a single particle
+ * @param speedOfLight speed of light in the unit of the momentum / mass
+ */
+template<typename T_Float>
+PMACC_MERGE_HDINLINE T_Float mergeEnergyMeasure(const T_Float (&singleMomentum)[3],
+                                                const T_Float mass,
+                                                const T_Float speedOfLight)
+{
+    const T_Float momentum2 = singleMomentum[0] * singleMomentum[0] +
+        singleMomentum[1] * singleMomentum[1] +
+        singleMomentum[2] * singleMomentum[2];
+    if (mass == T_Float(0.0))
+        return std::sqrt(momentum2);
+
+    const T_Float mc = mass * speedOfLight;
+    const T_Float u2 = momentum2 / (mc * mc);
+    return u2 / (std::sqrt(T_Float(1.0) + u2) + T_Float(1.0));
+}
+
+/** momenta of two macro particles which replace a group of macro particles
+ *
+ * Both new particles get half of the weighting of the group. Their momenta
+ * are mirrored around the mean momentum such that the sum of the momenta
+ * and the sum of the energies of the group are conserved
+ * (M. Vranic et al., Comput. Phys. Commun. 191, 2015).
+ *
+ * @param weighting sum of the weightings of the group
+ * @param momentum sum of the (macro) momenta of the group
+ * @param energyMeasure sum of weighting * mergeEnergyMeasure() of the group
+ * @param mass mass of a single particle
+ * @param speedOfLight speed of light in the unit of the momentum / mass
+ * @param[out] momentumA macro momentum of the first new particle
+ * @param[out] momentumB macro momentum of the second new particle
+ * @return cosine of the angle between the new momenta and the mean momentum
+ */
+template<typename T_Float>
+PMACC_MERGE_HDINLINE T_Float mergeMomenta(const T_Float weighting,
+                                          const T_Float (&momentum)[3],
+                                          const T_Float energyMeasure,
+                                          const T_Float mass,
+                                          const T_Float speedOfLight,
+                                          T_Float (&momentumA)[3],
+                                          T_Float (&momentumB)[3])
+{
+    T_Float meanMomentum[3];
+    for (int d = 0; d < 3; ++d)
+        meanMomentum[d] = momentum[d] / weighting;
+    const T_Float meanEnergy = energyMeasure / weighting;
+
+    T_Float targetMomentum2 = meanEnergy * meanEnergy;
+    if (mass != T_Float(0.0))
+    {
+        const T_Float mc = mass * speedOfLight;
+        targetMomentum2 = mc * mc * meanEnergy * (meanEnergy + T_Float(2.0));
+    }
+    const T_Float meanMomentum2 = meanMomentum[0] * meanMomentum[0] +
+        meanMomentum[1] * meanMomentum[1] +
+        meanMomentum[2] * meanMomentum[2];
+    /* the mean momentum is never larger than the target momentum, except for rounding */
+    const T_Float delta2 = targetMomentum2 - meanMomentum2;
+    const T_Float delta = delta2 > T_Float(0.0) ? std::sqrt(delta2) : T_Float(0.0);
+
+    /* direction perpendicular to the mean momentum: cross product with the
+     * axis of the smallest component */
+    int axis = 0;
+    if (std::abs(meanMomentum[0]) <= std::abs(meanMomentum[1]) && std::abs(meanMomentum[0]) <= std::abs(meanMomentum[2]))
+        axis = 0;
+    else if (std::abs(meanMomentum[1]) <= std::abs(meanMomentum[2]))
+        axis = 1;
+    else
+        axis = 2;
+
+    T_Float perpendicular[3];
+    for (int d = 0; d < 3; ++d)
+    {
+        const int d1 = (d + 1) % 3;
+        const int d2 = (d + 2) % 3;
+        perpendicular[d] = (d2 == axis ? meanMomentum[d1] : T_Float(0.0)) -
+            (d1 == axis ? meanMomentum[d2] : T_Float(0.0));
+    }
+    const T_Float perpendicularLength = std::sqrt(perpendicular[0] * perpendicular[0] +
+                                                  perpendicular[1] * perpendicular[1] +
+                                                  perpendicular[2] * perpendicular[2]);
+    for (int d = 0; d < 3; ++d)
+    {
+        if (perpendicularLength == T_Float(0.0))
+            perpendicular[d] = d == axis ? T_Float(1.0) : T_Float(0.0);
+        else
+            perpendicular[d] /= perpendicularLength;
+    }
+
+    const T_Float halfWeighting = T_Float(0.5) * weighting;
+    for (int d = 0; d < 3; ++d)
+    {
+        momentumA[d] = halfWeighting * (meanMomentum[d] + delta * perpendicular[d]);
+        momentumB[d] = halfWeighting * (meanMomentum[d] - delta * perpendicular[d]);
+    }
+
+    if (targetMomentum2 == T_Float(0.0))
+        return T_Float(1.0);
+    return std::sqrt(meanMomentum2 / targetMomentum2);
+}
+
+} // namespace resampling
+} // namespace particles
+} // namespace PMacc
+
+#undef PMACC_MERGE_HDINLINE
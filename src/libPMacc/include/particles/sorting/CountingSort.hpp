@@ -0,0 +1,89 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+namespace particles
+{
+namespace sorting
+{
+
+/** counting sort of the particle slots of a supercell by cell index
+ *
+ * Host implementation of KernelSortParticles: all frames of a supercell
+ * are seen as one list of slots, the particles of a cell become contiguous,
+ * cells are ascending and gaps are removed. The host version is stable.
+ *
+ * @param cellIdx local cell index of each slot, negative for a gap
+ * @param numCells number of cells in a supercell
+ * @param[out] srcSlot slot of each particle in sorted order
+ * @param[out] cellBegin first particle of each cell in sorted order,
+ *                       numCells + 1 entries (the last is the number of particles)
+ */
+inline void countingSort(const std::vector<int>& cellIdx,
+                         const int numCells,
+                         std::vector<uint32_t>& srcSlot,
+                         std::vector<uint32_t>& cellBegin)
+{
+    /* histogram of the cell indices */
+    cellBegin.assign(numCells + 1, 0);
+    for (size_t slot = 0; slot < cellIdx.size(); ++slot)
+        if (cellIdx[slot] >= 0)
+            ++cellBegin[cellIdx[slot] + 1];
+
+    /* exclusive prefix sum */
+    for (int cell = 0; cell < numCells; ++cell)
+        cellBegin[cell + 1] += cellBegin[cell];
+
+    std::vector<uint32_t> cursor(cellBegin.begin(), cellBegin.end() - 1);
+    srcSlot.resize(cellBegin[numCells]);
+    for (size_t slot = 0; slot < cellIdx.size(); ++slot)
+        if (cellIdx[slot] >= 0)
+            srcSlot[cursor[cellIdx[slot]]++] = slot;
+}
+
+/** apply the order of countingSort() to an attribute of the particles
+ *
+ * @param src attribute of each slot
+ * @param srcSlot result of countingSort()
+ * @param[out] dst attribute of each particle in sorted order
+ */
+template<typename T_Type>
+inline void gather(const std::vector<T_Type>& src,
+                   const std::vector<uint32_t>& srcSlot,
+                   std::vector<T_Type>& dst)
+{
+    dst.resize(srcSlot.size());
+    for (size_t i = 0; i < srcSlot.size(); ++i)
+        dst[i] = src[srcSlot[i]];
+}
+
+} // namespace sorting
+} // namespace particles
+} // namespace PMacc
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera
+/* Copyright 2013-2017 Rene Widera, agent
  *
  * This file is part of libPMacc.
  *
@@ -23,6 +23,8 @@
 #pragma once
 
 #include "eventSystem/EventSystem.hpp"
+#include "communication/MessageAggregator.hpp"
+#include "Environment.hpp"
 #include "assert.hpp"
 
 namespace PMacc
@@ -44,11 +46,15 @@ namespace PMacc
         state(Constructor),
         maxSize(parBase.getParticlesBuffer().getSendExchangeStack(exchange).getMaxParticlesCount()),
         initDependency(__getTransactionEvent()),
-        lastSize(0),lastSendEvent(EventTask()),retryCounter(0){ }
+        lastSize(0),lastSendEvent(EventTask()),retryCounter(0),reservation(nullptr){ }
 
         virtual void init()
         {
             state = Init;
+            /* the particles are sent after the bash, reserve the send in the
+             * aggregation phase of the caller (nullptr if no phase is open,
+             * always for a retry because it runs in Manager::execute) */
+            reservation = Environment<>::get().MessageAggregator().reserveSend(exchange);
             __startTransaction(initDependency);
             parBase.bashParticles(exchange);
             tmpEvent = __endTransaction();
@@ -70,7 +76,11 @@ namespace PMacc
                         //bash is finished
                         __startTransaction();
                         lastSize = parBase.getParticlesBuffer().getSendExchangeStack(exchange).getDeviceParticlesCurrentSize();
-                        lastSendEvent = parBase.getParticlesBuffer().asyncSendParticles(__getTransactionEvent(), exchange);
+                        {
+                            MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), reservation);
+                            reservation = nullptr;
+                            lastSendEvent = parBase.getParticlesBuffer().asyncSendParticles(__getTransactionEvent(), exchange);
+                        }
                         initDependency = lastSendEvent;
                         __endTransaction();
                         state = WaitForSend;
@@ -155,6 +165,8 @@ namespace PMacc
         size_t maxSize;
         size_t lastSize;
         size_t retryCounter;
+        /* reserved send in an aggregation phase, see MessageAggregator::reserveSend */
+        void* reservation;
     };
 
 } //namespace PMacc
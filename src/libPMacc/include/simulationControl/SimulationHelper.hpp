@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Rene Widera, Alexander Debus,
- *                     Benjamin Worpitz, Alexander Grund
+ *                     Benjamin Worpitz, Alexander Grund, agent
  *
  * This file is part of libPMacc.
  *
@@ -28,6 +28,8 @@
 #include "mappings/simulation/GridController.hpp"
 #include "dimensions/DataSpace.hpp"
 #include "TimeInterval.hpp"
+#include "simulationControl/StartupTimer.hpp"
+#include "eventSystem/TaskGraph.hpp"
 #include "dataManagement/DataConnector.hpp"
 #include "Environment.hpp"
 #include "pluginSystem/IPlugin.hpp"
@@ -217,7 +219,9 @@ public:
         for (uint32_t nthSoftRestart = 0; nthSoftRestart <= softRestarts; ++nthSoftRestart)
         {
             resetAll(0);
+            StartupTimer::getInstance().beginPhase("initial fill");
             uint32_t currentStep = fillSimulation();
+            StartupTimer::getInstance().endPhase();
             Environment<>::get().SimulationDescription().setCurrentStep( currentStep );
 
             tInit.toggleEnd();
@@ -226,6 +230,8 @@ public:
                 std::cout << "initialization time: " << tInit.printInterval() <<
                     " = " <<
                     (int) (tInit.getInterval() / 1000.) << " sec" << std::endl;
+                if (nthSoftRestart == 0)
+                    StartupTimer::getInstance().print(std::cout);
             }
 
             TimeIntervall tSimCalculation;
@@ -256,7 +262,9 @@ public:
             while (currentStep < Environment<>::get().SimulationDescription().getRunSteps())
             {
                 tRound.toggleStart();
+                TaskGraph::getInstance().beginStep();
                 runOneStep(currentStep);
+                TaskGraph::getInstance().endStep();
                 tRound.toggleEnd();
                 roundAvg += tRound.getInterval();
 
@@ -282,6 +290,9 @@ public:
                    (int) (tSimCalculation.getInterval() / 1000.) << " sec" << std::endl;
             }
 
+            if (output && TaskGraph::getInstance().isEnabled() && nthSoftRestart == 0)
+                dumpTaskGraph();
+
         } // softRestarts loop
     }
 
@@ -302,7 +313,10 @@ public:
             ("checkpoint-directory", po::value<std::string>(&checkpointDirectory)->default_value(checkpointDirectory),
              "Directory for checkpoints")
             ("author", po::value<std::string>(&author)->default_value(std::string("")),
-             "The author that runs the simulation and is responsible for created output files");
+             "The author that runs the simulation and is responsible for created output files")
+            ("taskGraph", po::value<std::string>(&taskGraphFile),
+             "Record the task graph of the simulation steps (diagnostics only, the steps are not "
+             "replayed), write it (dot format) to this file and print its critical path (rank 0)");
     }
 
     std::string pluginGetName() const
@@ -318,6 +332,9 @@ public:
         calcProgress();
 
         output = (getGridController().getGlobalRank() == 0);
+
+        if (!taskGraphFile.empty())
+            TaskGraph::getInstance().enable();
     }
 
     void pluginUnload()
@@ -364,6 +381,9 @@ protected:
     /* author that runs the simulation */
     std::string author;
 
+    /* file for the recorded task graph, empty for no recording */
+    std::string taskGraphFile;
+
 private:
 
     /**
@@ -384,6 +404,19 @@ private:
             showProgressAnyStep = 1;
     }
 
+    /**
+     * Write the recorded task graph and print its critical path
+     */
+    void dumpTaskGraph()
+    {
+        std::ofstream file(taskGraphFile.c_str());
+        if (!file)
+            throw std::runtime_error("Failed to write task graph file " + taskGraphFile);
+
+        TaskGraph::getInstance().writeDot(file);
+        TaskGraph::getInstance().printCriticalPath(std::cout);
+    }
+
     /**
      * Append \p checkpointStep to the master checkpoint file
      *
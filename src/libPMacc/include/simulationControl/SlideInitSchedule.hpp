@@ -0,0 +1,161 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+/* this file is used by host only tools, it must not depend on CUDA or MPI */
+
+namespace PMacc
+{
+
+    /** row by row initialization of a GPU which slid in with the moving window
+     *
+     * After a slide the bottom GPU is empty. Instead of initializing all its
+     * supercell rows (y direction) in the slide step, the rows are
+     * initialized in the steps before the moving window covers them, with
+     * `lead` rows ahead of the window.
+     *
+     * The functor which initializes the rows is called only on the ranks
+     * which slid in, it must not call collective operations.
+     * The functor is called as `initRows(beginRow, endRow)` for the rows
+     * [beginRow, endRow).
+     */
+    class SlideInitSchedule
+    {
+    public:
+
+        /**
+         * @param lead number of rows initialized ahead of the window
+         * @param rowCells cells of a supercell row in y direction
+         * @param numRows number of supercell rows (without guard) of a GPU
+         */
+        SlideInitSchedule(
+            const uint32_t lead = 2,
+            const uint32_t rowCells = 1,
+            const uint32_t numRows = 0
+        ) :
+            lead(lead),
+            rowCells(rowCells),
+            numRows(numRows),
+            initRows(numRows),
+            pending(false)
+        {
+        }
+
+        /** number of rows which must be initialized
+         *
+         * all rows covered by the moving window plus `lead` rows
+         *
+         * @param windowOffset offset of the moving window in the top GPU [in cells]
+         */
+        uint32_t getTarget(const uint32_t windowOffset) const
+        {
+            const uint32_t rows = (windowOffset + rowCells - 1) / rowCells + lead;
+            return std::min(rows, numRows);
+        }
+
+        /** the GPU slid in, initialize the rows for the current window
+         *
+         * @param windowOffset offset of the moving window in the top GPU [in cells]
+         * @param initRowsFunctor functor to initialize rows
+         */
+        template<typename T_InitRows>
+        void start(const uint32_t windowOffset, T_InitRows initRowsFunctor)
+        {
+            initRows = 0;
+            pending = true;
+            initUntil(getTarget(windowOffset), initRowsFunctor);
+        }
+
+        /** state after a restart from a checkpoint written in the step
+         *
+         * the checkpoint contains the rows which were initialized until then
+         *
+         * @param windowOffset offset of the moving window in the top GPU [in cells]
+         */
+        void restart(const uint32_t windowOffset)
+        {
+            initRows = getTarget(windowOffset);
+            pending = initRows < numRows;
+        }
+
+        /** initialize the rows for the current window (step without slide)
+         *
+         * @param windowOffset offset of the moving window in the top GPU [in cells]
+         * @param initRowsFunctor functor to initialize rows
+         */
+        template<typename T_InitRows>
+        void advance(const uint32_t windowOffset, T_InitRows initRowsFunctor)
+        {
+            if (pending)
+                initUntil(getTarget(windowOffset), initRowsFunctor);
+        }
+
+        /** initialize all remaining rows, called before the next slide
+         *
+         * the GPU which slid in last leaves the bottom of the domain,
+         * all its rows must be initialized before
+         *
+         * @param initRowsFunctor functor to initialize rows
+         */
+        template<typename T_InitRows>
+        void finish(T_InitRows initRowsFunctor)
+        {
+            if (pending)
+                initUntil(numRows, initRowsFunctor);
+        }
+
+        /** true if rows are not initialized yet */
+        bool isPending() const
+        {
+            return pending;
+        }
+
+        /** number of initialized rows */
+        uint32_t getInitRows() const
+        {
+            return initRows;
+        }
+
+    private:
+
+        template<typename T_InitRows>
+        void initUntil(const uint32_t targetRows, T_InitRows& initRowsFunctor)
+        {
+            if (targetRows > initRows)
+            {
+                initRowsFunctor(initRows, targetRows);
+                initRows = targetRows;
+            }
+            pending = initRows < numRows;
+        }
+
+        uint32_t lead;
+        uint32_t rowCells;
+        uint32_t numRows;
+        uint32_t initRows;
+        bool pending;
+    };
+
+} //namespace PMacc
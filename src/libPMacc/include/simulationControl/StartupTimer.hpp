@@ -0,0 +1,109 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulationControl/TimeInterval.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <iomanip>
+
+namespace PMacc
+{
+
+    /** time spent in the phases of the simulation startup
+     *
+     * A phase lasts until the next phase begins or endPhase() is called.
+     * Phases with the same name are accumulated.
+     */
+    class StartupTimer
+    {
+    public:
+
+        static StartupTimer& getInstance()
+        {
+            static StartupTimer instance;
+            return instance;
+        }
+
+        /** end the current phase and begin a new one
+         *
+         * @param name name of the phase
+         */
+        void beginPhase(const std::string& name)
+        {
+            endPhase();
+            for (currentPhase = 0; currentPhase < phases.size(); ++currentPhase)
+                if (phases[currentPhase].first == name)
+                    break;
+            if (currentPhase == phases.size())
+                phases.push_back(std::make_pair(name, 0.0));
+            phaseStart = TimeIntervall::getTime();
+            isRunning = true;
+        }
+
+        /** end the current phase */
+        void endPhase()
+        {
+            if (!isRunning)
+                return;
+            phases[currentPhase].second += TimeIntervall::getTime() - phaseStart;
+            isRunning = false;
+        }
+
+        /** print all phases in the order they began
+         *
+         * @param out output stream
+         */
+        void print(std::ostream& out) const
+        {
+            double total = 0.0;
+            for (size_t i = 0; i < phases.size(); ++i)
+                total += phases[i].second;
+
+            out << "startup time breakdown:" << std::endl;
+            for (size_t i = 0; i < phases.size(); ++i)
+            {
+                out << "  " << std::setw(20) << std::left << phases[i].first << std::right
+                    << TimeIntervall::printeTime(phases[i].second)
+                    << " (" << std::setw(3) << int(total > 0.0 ? 100.0 * phases[i].second / total : 0.0)
+                    << "%)" << std::endl;
+            }
+        }
+
+    private:
+
+        StartupTimer() : currentPhase(0), phaseStart(0.0), isRunning(false)
+        {
+        }
+
+        StartupTimer(const StartupTimer&);
+
+        std::vector<std::pair<std::string, double> > phases;
+        size_t currentPhase;
+        double phaseStart;
+        bool isRunning;
+    };
+
+} //namespace PMacc
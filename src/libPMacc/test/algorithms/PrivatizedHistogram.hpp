@@ -0,0 +1,120 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of libPMacc.
+ *
+ * libPMacc is free software: you can redistribute it and/or modify
+ * it under the terms of either the GNU General Public License or
+ * the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libPMacc is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License and the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * and the GNU Lesser General Public License along with libPMacc.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithms/PrivatizedHistogram.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <random>
+#include <stdint.h>
+
+BOOST_AUTO_TEST_SUITE( algorithms )
+
+namespace
+{
+    /* blocks of values with a peaked bin distribution, as a forward directed beam */
+    std::vector<std::vector<int> > createBlocks(const int numBins, const int numBlocks, const int valuesPerBlock)
+    {
+        std::mt19937 rng(42);
+        std::normal_distribution<double> peak(0.5 * numBins, 0.01 * numBins);
+        std::uniform_int_distribution<int> background(-1, numBins - 1);
+        std::uniform_real_distribution<double> isBackground(0.0, 1.0);
+
+        std::vector<std::vector<int> > blocks(numBlocks);
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int i = 0; i < valuesPerBlock; ++i)
+            {
+                int binIdx = isBackground(rng) < 0.1 ? background(rng) : int(peak(rng));
+                binIdx = binIdx >= numBins ? numBins - 1 : binIdx;
+                blocks[b].push_back(binIdx);
+            }
+        }
+        return blocks;
+    }
+
+    /* accumulate blocks of bin indices, each value is one */
+    template<typename T_Histogram>
+    void accumulate(T_Histogram& histogram, const std::vector<std::vector<int> >& blocks)
+    {
+        for (size_t b = 0; b < blocks.size(); ++b)
+        {
+            histogram.beginBlock();
+            for (size_t i = 0; i < blocks[b].size(); ++i)
+                histogram.add(blocks[b][i], 1.0);
+            histogram.endBlock();
+        }
+    }
+
+    std::vector<double> countBins(const int numBins, const std::vector<std::vector<int> >& blocks)
+    {
+        std::vector<double> bins(numBins, 0.0);
+        for (size_t b = 0; b < blocks.size(); ++b)
+            for (size_t i = 0; i < blocks[b].size(); ++i)
+                if (blocks[b][i] >= 0)
+                    bins[blocks[b][i]] += 1.0;
+        return bins;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( PrivatizedHistogramDense )
+{
+    using PMacc::algorithms::histogram::PrivatizedHistogram;
+
+    const int numBins = 4096;
+    const std::vector<std::vector<int> > blocks = createBlocks(numBins, 64, 256);
+
+    PrivatizedHistogram<double> histogram(numBins, 0, 8);
+    accumulate(histogram, blocks);
+
+    const std::vector<double> expected = countBins(numBins, blocks);
+    BOOST_CHECK_EQUAL_COLLECTIONS(histogram.getBins().begin(), histogram.getBins().end(),
+                                  expected.begin(), expected.end());
+    /* one update per hit bin and block */
+    BOOST_CHECK_LT(histogram.getNumGlobalUpdates(), uint64_t(64 * 256));
+}
+
+BOOST_AUTO_TEST_CASE( PrivatizedHistogramHotBins )
+{
+    using PMacc::algorithms::histogram::PrivatizedHistogram;
+
+    const int numBins = 1 << 20;
+    const std::vector<std::vector<int> > blocks = createBlocks(numBins, 64, 256);
+    const std::vector<double> expected = countBins(numBins, blocks);
+
+    /* the table holds all bins of a block */
+    PrivatizedHistogram<double> histogram(numBins, 1024, 8);
+    accumulate(histogram, blocks);
+    BOOST_CHECK_EQUAL_COLLECTIONS(histogram.getBins().begin(), histogram.getBins().end(),
+                                  expected.begin(), expected.end());
+
+    /* most bins find no slot and are added to the global histogram directly */
+    PrivatizedHistogram<double> smallHistogram(numBins, 4, 2);
+    accumulate(smallHistogram, blocks);
+    BOOST_CHECK_EQUAL_COLLECTIONS(smallHistogram.getBins().begin(), smallHistogram.getBins().end(),
+                                  expected.begin(), expected.end());
+    BOOST_CHECK_GT(smallHistogram.getNumGlobalUpdates(), histogram.getNumGlobalUpdates());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Felix Schmitt,
- *                     Richard Pausch, Benjamin Worpitz
+ *                     Richard Pausch, Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -65,6 +65,8 @@ SimulationFieldHelper<MappingDesc>( cellDescription )
 {
     /*#####create FieldB###############*/
     fieldB = new GridBuffer<ValueType, simDim > ( cellDescription.getGridLayout( ) );
+    if( Environment<simDim>::get().GridController().isDimensionOrderedGuardExchange() )
+        fieldB->setDimensionOrderedExchange( );
 
     typedef typename PMacc::particles::traits::FilterByFlag
     <
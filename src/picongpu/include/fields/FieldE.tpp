@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Felix Schmitt,
- *                     Richard Pausch, Benjamin Worpitz
+ *                     Richard Pausch, Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -60,6 +60,8 @@ FieldE::FieldE( MappingDesc cellDescription ) :
 SimulationFieldHelper<MappingDesc>( cellDescription )
 {
     fieldE = new GridBuffer<ValueType, simDim > ( cellDescription.getGridLayout( ) );
+    if( Environment<simDim>::get().GridController().isDimensionOrderedGuardExchange() )
+        fieldE->setDimensionOrderedExchange( );
     typedef typename PMacc::particles::traits::FilterByFlag
     <
         VectorAllSpecies,
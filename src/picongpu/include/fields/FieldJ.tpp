@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Felix Schmitt,
- *                     Richard Pausch, Benjamin Worpitz
+ *                     Richard Pausch, Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -170,16 +170,21 @@ GridBuffer<FieldJ::ValueType, simDim> &FieldJ::getGridBuffer( )
 EventTask FieldJ::asyncCommunication( EventTask serialEvent )
 {
     EventTask ret;
-    __startTransaction( serialEvent );
-    FieldFactory::getInstance( ).createTaskFieldReceiveAndInsert( *this );
-    ret = __endTransaction( );
-
-    __startTransaction( serialEvent );
-    FieldFactory::getInstance( ).createTaskFieldSend( *this );
-    ret += __endTransaction( );
+    {
+        MessageAggregator::Scope aggregate( Environment<>::get( ).MessageAggregator( ), FIELD_J );
+        __startTransaction( serialEvent );
+        FieldFactory::getInstance( ).createTaskFieldReceiveAndInsert( *this );
+        ret = __endTransaction( );
+
+        __startTransaction( serialEvent );
+        FieldFactory::getInstance( ).createTaskFieldSend( *this );
+        ret += __endTransaction( );
+    }
 
     if( fieldJrecv != nullptr )
     {
+        /* depends on the summed BORDER, can not join the phase above */
+        MessageAggregator::Scope aggregate( Environment<>::get( ).MessageAggregator( ), FIELD_JRECV );
         EventTask eJ = fieldJrecv->asyncCommunication( ret );
         return eJ;
     }
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Rene Widera, Richard Pausch,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 /*pic default*/
 #include "simulation_defines.hpp"
@@ -115,6 +116,33 @@ namespace picongpu
         template<uint32_t AREA, class FrameSolver, class ParticlesClass>
         void computeValue(ParticlesClass& parClass, uint32_t currentStep);
 
+        /** fill several FieldTmp slots with one pass over the particles
+         *
+         * Attribute i of the fused solver is added to fieldTmps[i], the slots
+         * are not reset. Each frame is read once for all attributes.
+         *
+         * \tparam FrameSolver fused solver, e.g. particleToGrid::ComputeGridValuesPerFrame
+         * \param fieldTmps FrameSolver::numAttributes slots
+         */
+        template<uint32_t AREA, class FrameSolver, class ParticlesClass>
+        static void computeValues(
+            ParticlesClass& parClass,
+            uint32_t currentStep,
+            const std::vector< std::shared_ptr< FieldTmp > >& fieldTmps
+        );
+
+        /** scatter data of several slots to neighboring GPUs
+         *
+         * The communication of all slots is started before any of them is
+         * waited for.
+         *
+         * \return event of the communication of all slots
+         */
+        static EventTask asyncCommunication(
+            const std::vector< std::shared_ptr< FieldTmp > >& fieldTmps,
+            EventTask serialEvent
+        );
+
         static SimulationDataId getUniqueId( uint32_t slotId );
 
         SimulationDataId getUniqueId();
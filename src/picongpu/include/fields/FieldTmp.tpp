@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Felix Schmitt,
- *                     Richard Pausch, Benjamin Worpitz
+ *                     Richard Pausch, Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -29,6 +29,7 @@
 
 #include "mappings/kernel/AreaMapping.hpp"
 #include "eventSystem/EventSystem.hpp"
+#include "Environment.hpp"
 #include "mappings/kernel/ExchangeMapping.hpp"
 #include "fields/tasks/FieldFactory.hpp"
 
@@ -217,6 +218,60 @@ namespace picongpu
     }
 
 
+    template<uint32_t AREA, class FrameSolver, class ParticlesClass>
+    void FieldTmp::computeValues(
+        ParticlesClass& parClass,
+        uint32_t,
+        const std::vector< std::shared_ptr< FieldTmp > >& fieldTmps
+    )
+    {
+        typedef SuperCellDescription<
+            typename MappingDesc::SuperCellSize,
+            typename FrameSolver::LowerMargin,
+            typename FrameSolver::UpperMargin
+            > BlockArea;
+
+        PMACC_VERIFY_MSG(
+            fieldTmps.size( ) == FrameSolver::numAttributes,
+            "computeValues needs one FieldTmp slot per attribute"
+        );
+
+        FieldTmpBoxes< FrameSolver::numAttributes > tmpBoxes;
+        for( uint32_t i = 0; i < FrameSolver::numAttributes; ++i )
+            tmpBoxes.box[ i ] = fieldTmps[ i ]->getDeviceDataBox( );
+
+        StrideMapping<AREA, 3, MappingDesc> mapper( fieldTmps[ 0 ]->getCellDescription( ) );
+        typename ParticlesClass::ParticlesBoxType pBox = parClass.getDeviceParticlesBox( );
+        FrameSolver solver;
+
+        do
+        {
+            PMACC_KERNEL( KernelComputeSupercellsFused<BlockArea, AREA>{} )
+                ( mapper.getGridDim( ), mapper.getSuperCellSize( ) )
+                ( tmpBoxes,
+                  pBox, solver, mapper );
+        } while( mapper.next( ) );
+    }
+
+    EventTask FieldTmp::asyncCommunication(
+        const std::vector< std::shared_ptr< FieldTmp > >& fieldTmps,
+        EventTask serialEvent
+    )
+    {
+        EventTask ret;
+        if( fieldTmps.empty( ) )
+            return ret;
+
+        /* the slots are independent, send all with one message per neighbor (if enabled) */
+        MessageAggregator::Scope aggregate(
+            Environment<>::get( ).MessageAggregator( ),
+            fieldTmps[ 0 ]->m_commTagScatter
+        );
+        for( uint32_t i = 0; i < fieldTmps.size( ); ++i )
+            ret += fieldTmps[ i ]->asyncCommunication( serialEvent );
+        return ret;
+    }
+
     SimulationDataId
     FieldTmp::getUniqueId( uint32_t slotId )
     {
@@ -242,6 +297,7 @@ namespace picongpu
     EventTask FieldTmp::asyncCommunication( EventTask serialEvent )
     {
         EventTask ret;
+        MessageAggregator::Scope aggregate( Environment<>::get( ).MessageAggregator( ), m_commTagScatter );
         __startTransaction( serialEvent + m_gatherEv + m_scatterEv );
         FieldFactory::getInstance( ).createTaskFieldReceiveAndInsert( *this );
         ret = __endTransaction( );
@@ -261,7 +317,10 @@ namespace picongpu
         );
 
         if( fieldTmpRecv != nullptr )
+        {
+            MessageAggregator::Scope aggregate( Environment<>::get( ).MessageAggregator( ), m_commTagGather );
             m_gatherEv = fieldTmpRecv->asyncCommunication( serialEvent + m_scatterEv + m_gatherEv );
+        }
         return m_gatherEv;
     }
 
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -100,6 +100,23 @@ private:
                 cursor::make_NestedCursor(twistVectorFieldAxes<OrientationTwist>(cursorB)),
                 DirSplittingKernel<BlockDim>((int)gridSizeTwisted.x()));
     }
+
+    /** exchange the guards of E and B
+     *
+     * E and B are independent, both are sent with one message per neighbor
+     * (if the aggregation is enabled), the transaction waits for both
+     */
+    void exchangeGuards(FieldE& fieldE, FieldB& fieldB) const
+    {
+        EventTask eRfieldE;
+        EventTask eRfieldB;
+        {
+            MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), FIELD_E);
+            eRfieldE = fieldE.asyncCommunication(__getTransactionEvent());
+            eRfieldB = fieldB.asyncCommunication(__getTransactionEvent());
+        }
+        __setTransactionEvent(eRfieldE + eRfieldB);
+    }
 public:
     DirSplitting(MappingDesc) {}
 
@@ -133,8 +150,7 @@ public:
                   fieldB_coreBorder.origin(),
                   gridSize);
 
-        __setTransactionEvent(fieldE->asyncCommunication(__getTransactionEvent()));
-        __setTransactionEvent(fieldB->asyncCommunication(__getTransactionEvent()));
+        exchangeGuards(*fieldE, *fieldB);
 
         typedef PMacc::math::CT::Int<1,2,0> Orientation_Y;
         propagate<Orientation_Y>(
@@ -142,8 +158,7 @@ public:
                   fieldB_coreBorder.origin(),
                   gridSize);
 
-        __setTransactionEvent(fieldE->asyncCommunication(__getTransactionEvent()));
-        __setTransactionEvent(fieldB->asyncCommunication(__getTransactionEvent()));
+        exchangeGuards(*fieldE, *fieldB);
 
         typedef PMacc::math::CT::Int<2,0,1> Orientation_Z;
         propagate<Orientation_Z>(
@@ -154,8 +169,7 @@ public:
         if (laserProfile::INIT_TIME > float_X(0.0))
             fieldE->laserManipulation(currentStep);
 
-        __setTransactionEvent(fieldE->asyncCommunication(__getTransactionEvent()));
-        __setTransactionEvent(fieldB->asyncCommunication(__getTransactionEvent()));
+        exchangeGuards(*fieldE, *fieldB);
 
         dc.releaseData( FieldE::getName() );
         dc.releaseData( FieldB::getName() );
@@ -168,10 +182,7 @@ public:
         auto fieldE = dc.get< FieldE >( FieldE::getName(), true );
         auto fieldB = dc.get< FieldB >( FieldB::getName(), true );
 
-        EventTask eRfieldE = fieldE->asyncCommunication(__getTransactionEvent());
-        EventTask eRfieldB = fieldB->asyncCommunication(__getTransactionEvent());
-        __setTransactionEvent(eRfieldE);
-        __setTransactionEvent(eRfieldB);
+        exchangeGuards(*fieldE, *fieldB);
 
         dc.releaseData( FieldE::getName() );
         dc.releaseData( FieldB::getName() );
@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Benjamin Worpitz,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -98,6 +99,19 @@ private:
             );
     }
 
+    /** exchange the guard of a field
+     *
+     * the buffers of all exchanges into one direction are sent with one
+     * message if the aggregation is enabled (--mpiAggregation), the
+     * phase key is the communication tag of the field
+     */
+    template<typename T_Field>
+    EventTask asyncCommunication(T_Field& field, uint32_t communicationTag)
+    {
+        MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), communicationTag);
+        return field.asyncCommunication(__getTransactionEvent());
+    }
+
 public:
 
     YeeSolver(MappingDesc cellDescription) : m_cellDescription(cellDescription)
@@ -111,7 +125,7 @@ public:
     void update_beforeCurrent(uint32_t)
     {
         updateBHalf < CORE+BORDER >();
-        EventTask eRfieldB = fieldB->asyncCommunication(__getTransactionEvent());
+        EventTask eRfieldB = asyncCommunication(*fieldB, FIELD_B);
 
         updateE<CORE>();
         __setTransactionEvent(eRfieldB);
@@ -124,7 +138,7 @@ public:
         if (laserProfile::INIT_TIME > float_X(0.0))
             fieldE->laserManipulation(currentStep);
 
-        EventTask eRfieldE = fieldE->asyncCommunication(__getTransactionEvent());
+        EventTask eRfieldE = asyncCommunication(*fieldE, FIELD_E);
 
         updateBHalf < CORE> ();
         __setTransactionEvent(eRfieldE);
@@ -132,7 +146,7 @@ public:
 
         FieldManipulator::absorbBorder(currentStep,this->m_cellDescription, fieldB->getDeviceDataBox());
 
-        EventTask eRfieldB = fieldB->asyncCommunication(__getTransactionEvent());
+        EventTask eRfieldB = asyncCommunication(*fieldB, FIELD_B);
         __setTransactionEvent(eRfieldB);
     }
 
@@ -0,0 +1,121 @@
+/* Copyright 2014-2017 Axel Huebl, Rene Widera, agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "simulation_defines.hpp"
+
+#include "dimensions/DataSpace.hpp"
+#include "mappings/simulation/SubGrid.hpp"
+#include "mappings/kernel/MappingDescription.hpp"
+#include "simulationControl/MovingWindow.hpp"
+
+
+namespace picongpu
+{
+namespace cellwiseOperation
+{
+    using namespace PMacc;
+
+    /** read-only box which adds a background field to the values of a field box
+     *
+     * The background is evaluated at each access, the field itself is not changed.
+     *
+     * \tparam T_Box field box
+     * \tparam T_Background background functor "f(totalCellIdx, currentStep)"
+     */
+    template<typename T_Box, typename T_Background>
+    class BackgroundFieldBox
+    {
+    public:
+        typedef typename T_Box::ValueType ValueType;
+
+        HDINLINE BackgroundFieldBox( const T_Box& box, const T_Background& background,
+                                     const DataSpace<simDim>& totalCellOffset, const uint32_t currentStep ) :
+            m_box( box ), m_background( background ), m_totalCellOffset( totalCellOffset ), m_currentStep( currentStep )
+        {
+        }
+
+        HDINLINE ValueType operator()( const DataSpace<simDim>& idx ) const
+        {
+            return m_box( idx ) + m_background( m_totalCellOffset + idx, m_currentStep );
+        }
+
+        HDINLINE BackgroundFieldBox shift( const DataSpace<simDim>& offset ) const
+        {
+            return BackgroundFieldBox( m_box.shift( offset ), m_background, m_totalCellOffset + offset, m_currentStep );
+        }
+
+    private:
+        PMACC_ALIGN( m_box, T_Box );
+        PMACC_ALIGN( m_background, T_Background );
+        PMACC_ALIGN( m_totalCellOffset, DataSpace<simDim> );
+        PMACC_ALIGN( m_currentStep, uint32_t );
+    };
+
+    /** field box used by the particle pusher
+     *
+     * If the background field influences the particle pusher and is evaluated
+     * in the pusher (`EvaluateInPusher`) the box adds the background to the
+     * field, else the field box is returned unchanged (the background is
+     * already added to the field, see MySimulation).
+     *
+     * \tparam T_Background background field, e.g. FieldBackgroundE
+     */
+    template<
+        typename T_Background,
+        bool T_evaluateInPusher = T_Background::InfluenceParticlePusher && T_Background::EvaluateInPusher
+    >
+    struct PusherFieldBox
+    {
+        template<typename T_Field>
+        HINLINE typename T_Field::DataBoxType
+        operator()( T_Field& field, const MappingDesc&, const uint32_t ) const
+        {
+            return field.getDeviceDataBox();
+        }
+    };
+
+    template<typename T_Background>
+    struct PusherFieldBox< T_Background, true >
+    {
+        template<typename T_Field>
+        HINLINE BackgroundFieldBox< typename T_Field::DataBoxType, T_Background >
+        operator()( T_Field& field, const MappingDesc& cellDescription, const uint32_t currentStep ) const
+        {
+            const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
+            /* total cell index of the first cell of the field (including GUARD),
+             * as for CellwiseOperation< CORE + BORDER + GUARD > */
+            DataSpace<simDim> totalCellOffset( subGrid.getLocalDomain().offset );
+            const uint32_t numSlides = MovingWindow::getInstance().getSlideCounter( currentStep );
+            totalCellOffset.y() += numSlides * subGrid.getLocalDomain().size.y();
+            totalCellOffset -= cellDescription.getSuperCellSize() * cellDescription.getGuardingSuperCells();
+
+            return BackgroundFieldBox< typename T_Field::DataBoxType, T_Background >(
+                field.getDeviceDataBox(),
+                T_Background( field.getUnit() ),
+                totalCellOffset,
+                currentStep
+            );
+        }
+    };
+
+} // namespace cellwiseOperation
+} // namespace picongpu
@@ -1,4 +1,4 @@
-/* Copyright 2014-2017 Alexander Debus, Axel Huebl
+/* Copyright 2014-2017 Alexander Debus, Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -32,6 +32,7 @@
 #include "fields/background/templates/TWTS/RotateField.tpp"
 #include "fields/background/templates/TWTS/GetInitialTimeDelay_SI.tpp"
 #include "fields/background/templates/TWTS/getFieldPositions_SI.tpp"
+#include "fields/background/templates/TWTS/SpatialTable.tpp"
 #include "fields/background/templates/TWTS/BField.hpp"
 
 namespace picongpu
@@ -53,12 +54,15 @@ namespace twts
                     const float_X beta_0,
                     const float_64 tdelay_user_SI,
                     const bool auto_tdelay,
-                    const PolarizationType pol ) :
+                    const PolarizationType pol,
+                    const EvaluationType evaluation ) :
         focus_y_SI(focus_y_SI), wavelength_SI(wavelength_SI),
         pulselength_SI(pulselength_SI), w_x_SI(w_x_SI),
         w_y_SI(w_y_SI), phi(phi), beta_0(beta_0),
         tdelay_user_SI(tdelay_user_SI), dt(SI::DELTA_T_SI),
-        unit_length(UNIT_LENGTH), auto_tdelay(auto_tdelay), pol(pol), phiPositive( float_X(1.0) )
+        unit_length(UNIT_LENGTH), auto_tdelay(auto_tdelay), pol(pol), phiPositive( float_X(1.0) ),
+        evaluation(evaluation), tableOffset(0, 0),
+        tableSize(0, 0), tableTime(0.0)
     {
         /* Note: Enviroment-objects cannot be instantiated on CUDA GPU device. Since this is done
          * on host (see fieldBackground.param), this is no problem.
@@ -69,13 +73,31 @@ namespace twts
                                                 halfSimSize, pulselength_SI,
                                                 focus_y_SI, phi, beta_0);
         if ( phi < float_X(0.0) ) phiPositive = float_X(-1.0);
+
+        /* The x-dependence of the field functions is only separable in 3D. */
+        if ( !detail::TablePlane<simDim>::available ) this->evaluation = CALCULATE;
+        if ( this->evaluation != CALCULATE )
+        {
+            typedef detail::SpatialTable<BField> Table;
+            Table& table = Table::getInstance();
+            const fieldSolver::numericalCellType::traits::FieldPosition<FieldB> fieldPosB;
+            table.update(*this, fieldPosB(),
+                         Environment<>::get().SimulationDescription().getCurrentStep(),
+                         this->evaluation == TABLE_FLOAT32);
+            table64 = table.getDeviceDataBox64();
+            table32 = table.getDeviceDataBox32();
+            tableOffset = table.getOffset();
+            tableSize = table.getSize();
+            tableTime = this->evaluation == TABLE_FLOAT32 ? table.getTime32() : table.getTime64();
+        }
     }
 
     template<>
     HDINLINE float3_X
     BField::getTWTSBfield_Normalized<DIM3>(
             const PMacc::math::Vector<floatD_64,detail::numComponents>& bFieldPositions_SI,
-            const float_64 time) const
+            const float_64 time,
+            const DataSpace<DIM2>& tableIdx) const
     {
         typedef PMacc::math::Vector<float3_64,detail::numComponents> PosVecVec;
         PosVecVec pos(PosVecVec::create(
@@ -91,13 +113,13 @@ namespace twts
          *
          * Calculate By-component with the intra-cell offset of a By-field
          */
-        const float_64 By_By = calcTWTSBy(pos[1], time);
+        const float_64 By_By = calcTWTSComponent(1u, pos[1], time, tableIdx);
         /* Calculate Bz-component the the intra-cell offset of a By-field */
-        const float_64 Bz_By = calcTWTSBz_Ex(pos[1], time);
+        const float_64 Bz_By = calcTWTSComponent(detail::numComponents + 1u, pos[1], time, tableIdx);
         /* Calculate By-component the the intra-cell offset of a Bz-field */
-        const float_64 By_Bz = calcTWTSBy(pos[2], time);
+        const float_64 By_Bz = calcTWTSComponent(2u, pos[2], time, tableIdx);
         /* Calculate Bz-component the the intra-cell offset of a Bz-field */
-        const float_64 Bz_Bz = calcTWTSBz_Ex(pos[2], time);
+        const float_64 Bz_Bz = calcTWTSComponent(detail::numComponents + 2u, pos[2], time, tableIdx);
         /* Since we rotated all position vectors before calling calcTWTSBy and calcTWTSBz_Ex,
          * we need to back-rotate the resulting B-field vector.
          *
@@ -116,7 +138,8 @@ namespace twts
     HDINLINE float3_X
     BField::getTWTSBfield_Normalized_Ey<DIM3>(
             const PMacc::math::Vector<floatD_64,detail::numComponents>& bFieldPositions_SI,
-            const float_64 time) const
+            const float_64 time,
+            const DataSpace<DIM2>& tableIdx) const
     {
         typedef PMacc::math::Vector<float3_64,detail::numComponents> PosVecVec;
         PosVecVec pos(PosVecVec::create(
@@ -128,9 +151,9 @@ namespace twts
         }
 
         /* Calculate Bz-component with the intra-cell offset of a By-field */
-        const float_64 Bz_By = calcTWTSBz_Ey(pos[1], time);
+        const float_64 Bz_By = calcTWTSComponent(detail::numComponents + 1u, pos[1], time, tableIdx);
         /* Calculate Bz-component with the intra-cell offset of a Bz-field */
-        const float_64 Bz_Bz = calcTWTSBz_Ey(pos[2], time);
+        const float_64 Bz_Bz = calcTWTSComponent(detail::numComponents + 2u, pos[2], time, tableIdx);
         /* Since we rotated all position vectors before calling calcTWTSBz_Ey,
          * we need to back-rotate the resulting B-field vector.
          *
@@ -140,7 +163,8 @@ namespace twts
         const float_64 Bz_rot = -math::sin(+phi)*Bz_Bz;
 
         /* Finally, the B-field normalized to the peak amplitude. */
-        return float3_X( float_X( calcTWTSBx(pos[0], time) ),
+        /* Bx = -By, see calcTWTSBx */
+        return float3_X( float_X( -calcTWTSComponent(0u, pos[0], time, tableIdx) ),
                          float_X( By_rot ),
                          float_X( Bz_rot ) );
     }
@@ -149,7 +173,8 @@ namespace twts
     HDINLINE float3_X
     BField::getTWTSBfield_Normalized<DIM2>(
             const PMacc::math::Vector<floatD_64,detail::numComponents>& bFieldPositions_SI,
-            const float_64 time) const
+            const float_64 time,
+            const DataSpace<DIM2>&) const
     {
         typedef PMacc::math::Vector<float3_64,detail::numComponents> PosVecVec;
         PosVecVec pos(PosVecVec::create(
@@ -212,7 +237,8 @@ namespace twts
     HDINLINE float3_X
     BField::getTWTSBfield_Normalized_Ey<DIM2>(
             const PMacc::math::Vector<floatD_64,detail::numComponents>& bFieldPositions_SI,
-            const float_64 time) const
+            const float_64 time,
+            const DataSpace<DIM2>&) const
     {
         typedef PMacc::math::Vector<float3_64,detail::numComponents> PosVecVec;
         PosVecVec pos(PosVecVec::create(
@@ -276,16 +302,25 @@ namespace twts
         const PMacc::math::Vector<floatD_64,detail::numComponents> bFieldPositions_SI =
               detail::getFieldPositions_SI(cellIdx, halfSimSize,
                 fieldPosB(), unit_length, focus_y_SI, phi);
+
+        DataSpace<DIM2> tableIdx(-1, -1);
+        if (evaluation != CALCULATE)
+        {
+            const DataSpace<DIM2> idx = detail::TablePlane<simDim>::getPlaneIdx(cellIdx) - tableOffset;
+            if (idx.x() >= 0 && idx.y() >= 0 && idx.x() < tableSize.x() && idx.y() < tableSize.y())
+                tableIdx = idx;
+        }
+
         /* Single TWTS-Pulse */
         switch (pol)
         {
             case LINEAR_X :
-            return getTWTSBfield_Normalized<simDim>(bFieldPositions_SI, time_SI);
+            return getTWTSBfield_Normalized<simDim>(bFieldPositions_SI, time_SI, tableIdx);
 
             case LINEAR_YZ :
-            return getTWTSBfield_Normalized_Ey<simDim>(bFieldPositions_SI, time_SI);
+            return getTWTSBfield_Normalized_Ey<simDim>(bFieldPositions_SI, time_SI, tableIdx);
         }
-        return getTWTSBfield_Normalized<simDim>(bFieldPositions_SI, time_SI); // defensive default
+        return getTWTSBfield_Normalized<simDim>(bFieldPositions_SI, time_SI, tableIdx); // defensive default
     }
 
     /** Calculate the By(r,t) field here
@@ -296,155 +331,21 @@ namespace twts
     HDINLINE BField::float_T
     BField::calcTWTSBy( const float3_64& pos, const float_64 time ) const
     {
-        typedef PMacc::math::Complex<float_T> complex_T;
-        typedef PMacc::math::Complex<float_64> complex_64;
-        /* Unit of speed */
-        const float_64 UNIT_SPEED = SI::SPEED_OF_LIGHT_SI;
-        /* Unit of time */
-        const float_64 UNIT_TIME = SI::DELTA_T_SI;
-        /* Unit of length */
-        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
-
-        /* Propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
-        const float_T beta0 = float_T(beta_0);
-        /* If phi < 0 the formulas below are not directly applicable.
-         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
-         * z-axis of the coordinate system in this function.
-         */
-        const float_T phiReal = float_T( math::abs(phi) );
-        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
-                                                beta0*math::sin(phiReal));
-        /* Definition of the laser pulse front tilt angle for the laser field below.
-         *
-         * For beta0=1.0, this is equivalent to our standard definition. Question: Why is the
-         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
-         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
-         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
-         * the dispersion will (although physically correct) be slightly off the ideal TWTS
-         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
-         * scenarios close to beta0 = 1.
-         */
-        const float_T phiT = float_T(2.0)*alphaTilt;
-
-        /* Angle between the laser pulse front and the y-axis. Not used, but remains in code for
-         * documentation purposes.
-         * const float_T eta = float_T(PI/2) - (phiReal - alphaTilt);
-         */
+        PMacc::math::Complex<float_T> prefactor;
+        PMacc::math::Complex<float_T> exponent;
+        detail::calcTWTSByTerms<float_T>(getFieldParameters(), pos, time, prefactor, exponent);
+        return (math::exp(exponent)*prefactor).get_real() / SI::SPEED_OF_LIGHT_SI;
+    }
 
-        const float_T cspeed = float_T( SI::SPEED_OF_LIGHT_SI / UNIT_SPEED );
-        const float_T lambda0 = float_T(wavelength_SI / UNIT_LENGTH);
-        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
-        /* factor 2  in tauG arises from definition convention in laser formula */
-        const float_T tauG = float_T(pulselength_SI*2.0 / UNIT_TIME);
-        /* w0 is wx here --> w0 could be replaced by wx */
-        const float_T w0 = float_T(w_x_SI / UNIT_LENGTH);
-        const float_T rho0 = float_T(PI*w0*w0 / lambda0);
-        /* wy is width of TWTS pulse */
-        const float_T wy = float_T(w_y_SI / UNIT_LENGTH);
-        const float_T k = float_T(2.0*PI / lambda0);
-        /* If phi < 0 the entire pulse is rotated by 180 deg around the
-         * z-axis of the coordinate system without also changing
-         * the orientation of the resulting field vectors.
-         */
-        const float_T x = float_T(phiPositive * pos.x() / UNIT_LENGTH);
-        const float_T y = float_T(phiPositive * pos.y() / UNIT_LENGTH);
-        const float_T z = float_T(pos.z() / UNIT_LENGTH);
-        const float_T t = float_T(time / UNIT_TIME);
-
-        /* Shortcuts for speeding up the field calculation. */
-        const float_T sinPhi = math::sin(phiT);
-        const float_T cosPhi = math::cos(phiT);
-        const float_T cosPhi2 = math::cos(phiT / 2.0);
-        const float_T tanPhi2 = math::tan(phiT / 2.0);
-
-        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
-         * thus help with formal code verification through manual code inspection.
-         */
-        const complex_T helpVar1 = rho0 + complex_T(0,1)*y*cosPhi + complex_T(0,1)*z*sinPhi;
-        const complex_T helpVar2 = cspeed*om0*tauG*tauG + complex_T(0,2)
-                                    *(-z - y*math::tan(float_T(PI / 2)-phiT))*tanPhi2*tanPhi2;
-        const complex_T helpVar3 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
-
-        const complex_T helpVar4 = float_T(-1.0)*(
-            cspeed*cspeed*k*om0*tauG*tauG*wy*wy*x*x
-            + float_T(2.0)*cspeed*cspeed*om0*t*t*wy*wy*rho0
-            - complex_T(0,2)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*rho0
-            + float_T(2.0)*cspeed*cspeed*om0*tauG*tauG*y*y*rho0
-            - float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0
-            + complex_T(0,2)*cspeed*om0*om0*tauG*tauG*wy*wy*z*rho0
-            + float_T(2.0)*om0*wy*wy*z*z*rho0
-            + float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*tanPhi2
-            - float_T(4.0)*om0*wy*wy*y*z*rho0*tanPhi2
-            - complex_T(0,2)*cspeed*k*wy*wy*x*x*z*tanPhi2*tanPhi2
-            + float_T(2.0)*om0*wy*wy*y*y*rho0*tanPhi2*tanPhi2
-            - float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0*tanPhi2*tanPhi2
-            - complex_T(0,4)*cspeed*y*y*z*rho0*tanPhi2*tanPhi2
-            + float_T(4.0)*om0*wy*wy*z*z*rho0*tanPhi2*tanPhi2
-            - complex_T(0,2)*cspeed*k*wy*wy*x*x*y*math::tan(float_T(PI / 2)-phiT)*tanPhi2*tanPhi2
-            - float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*math::tan(float_T(PI / 2)-phiT)
-                *tanPhi2*tanPhi2
-            - complex_T(0,4)*cspeed*y*y*y*rho0*math::tan(float_T(PI / 2)-phiT)*tanPhi2*tanPhi2
-            + float_T(4.0)*om0*wy*wy*y*z*rho0*math::tan(float_T(PI / 2)-phiT)*tanPhi2*tanPhi2
-            + float_T(2.0)*z*sinPhi*(
-                + om0*(
-                    + cspeed*cspeed*(
-                          complex_T(0,1)*t*t*wy*wy
-                        + om0*t*tauG*tauG*wy*wy
-                        + complex_T(0,1)*tauG*tauG*y*y
-                    )
-                    - cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*wy*wy*z
-                    + complex_T(0,1)*wy*wy*z*z
-                    )
-                + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
-                + complex_T(0,1)*tanPhi2*tanPhi2*(
-                      complex_T(0,-2)*cspeed*y*y*z
-                    + om0*wy*wy*( y*y - float_T(2.0)*(cspeed*t - z)*z )
-                )
-            )
-            + float_T(2.0)*y*cosPhi*(
-                + om0*(
-                    + cspeed*cspeed*(
-                          complex_T(0,1)*t*t*wy*wy
-                        + om0*t*tauG*tauG*wy*wy
-                        + complex_T(0,1)*tauG*tauG*y*y
-                    )
-                - cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*wy*wy*z
-                + complex_T(0,1)*wy*wy*z*z
-                )
-            + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
-            + complex_T(0,1)*(
-                  complex_T(0,-4)*cspeed*y*y*z
-                + om0*wy*wy*(y*y - float_T(4.0)*(cspeed*t - z)*z)
-                - float_T(2.0)*y*(
-                    + cspeed*om0*t*wy*wy
-                    + complex_T(0,1)*cspeed*y*y
-                    - om0*wy*wy*z
-                    )*math::tan(float_T(PI / 2)-phiT)
-                )*tanPhi2*tanPhi2
-            )
-        /* The "round-trip" conversion in the line below fixes a gross accuracy bug
-         * in floating-point arithmetics, when float_T is set to float_X.
-         */
-        ) * complex_T( float_64(1.0) / complex_64(float_T(2.0)*cspeed*wy*wy*helpVar1*helpVar2) );
-
-        const complex_T helpVar5 = complex_T(0,-1)*cspeed*om0*tauG*tauG
-                                + (-z - y*math::tan(float_T(PI / 2)-phiT))
-                                    *tanPhi2*tanPhi2*float_T(2.0);
-        const complex_T helpVar6 = (cspeed*(cspeed*om0*tauG*tauG + complex_T(0,2)
-                                *(-z - y*math::tan(float_T(PI / 2)-phiT))*tanPhi2*tanPhi2))
-                                    / (om0*rho0);
-        const complex_T result = (math::exp(helpVar4)*tauG / cosPhi2 / cosPhi2
-            *(rho0 + complex_T(0,1)*y*cosPhi + complex_T(0,1)*z*sinPhi)
-            *(
-                  complex_T(0,2)*cspeed*t + cspeed*om0*tauG*tauG - complex_T(0,4)*z
-                + cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*cosPhi
-                + complex_T(0,2)*y*tanPhi2
-            )*math::pow(helpVar3,float_T(-1.5))
-        ) / (float_T(2.0)*helpVar5*math::sqrt(helpVar6));
-
-        return result.get_real() / UNIT_SPEED;
+    HDINLINE detail::FieldParameters
+    BField::getFieldParameters( ) const
+    {
+        return detail::FieldParameters( wavelength_SI, pulselength_SI, w_x_SI, w_y_SI,
+                                        phi, phiPositive, beta_0,
+                                        SI::DELTA_T_SI, SI::SPEED_OF_LIGHT_SI );
     }
 
+
     /** Calculate the Bz(r,t) field
      *
      * \param pos Spatial position of the target field.
@@ -453,112 +354,13 @@ namespace twts
     HDINLINE BField::float_T
     BField::calcTWTSBz_Ex( const float3_64& pos, const float_64 time ) const
     {
-        typedef PMacc::math::Complex<float_T> complex_T;
-        /** Unit of Speed */
-        const float_64 UNIT_SPEED = SI::SPEED_OF_LIGHT_SI;
-        /** Unit of time */
-        const float_64 UNIT_TIME = SI::DELTA_T_SI;
-        /** Unit of length */
-        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
-
-        /* propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
-        const float_T beta0 = float_T(beta_0);
-        /* If phi < 0 the formulas below are not directly applicable.
-         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
-         * z-axis of the coordinate system in this function.
-         */
-        const float_T phiReal = float_T( math::abs(phi) );
-        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
-                                                beta0*math::sin(phiReal));
-
-        /* Definition of the laser pulse front tilt angle for the laser field below.
-         *
-         * For beta0=1.0, this is equivalent to our standard definition. Question: Why is the
-         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
-         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
-         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
-         * the dispersion will (although physically correct) be slightly off the ideal TWTS
-         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
-         * scenarios close to beta0 = 1.
-         */
-        const float_T phiT = float_T(2.0)*alphaTilt;
-
-        /* Angle between the laser pulse front and the y-axis.
-         * Not used, but remains in code for documentation purposes.
-         * const float_T eta = float_T(float_T(PI / 2)) - (phiReal - alphaTilt);
-         */
-
-        const float_T cspeed = float_T( SI::SPEED_OF_LIGHT_SI / UNIT_SPEED );
-        const float_T lambda0 = float_T(wavelength_SI / UNIT_LENGTH);
-        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
-        /* factor 2  in tauG arises from definition convention in laser formula */
-        const float_T tauG = float_T(pulselength_SI*2.0 / UNIT_TIME);
-        /* w0 is wx here --> w0 could be replaced by wx */
-        const float_T w0 = float_T(w_x_SI / UNIT_LENGTH);
-        const float_T rho0 = float_T(PI*w0*w0 / lambda0);
-        /* wy is width of TWTS pulse */
-        const float_T wy = float_T(w_y_SI / UNIT_LENGTH);
-        const float_T k = float_T(2.0*PI / lambda0);
-        /* If phi < 0 the entire pulse is rotated by 180 deg around the
-         * z-axis of the coordinate system without also changing
-         * the orientation of the resulting field vectors.
-         */
-        const float_T x = float_T(phiPositive * pos.x() / UNIT_LENGTH);
-        const float_T y = float_T(phiPositive * pos.y() / UNIT_LENGTH);
-        const float_T z = float_T(pos.z() / UNIT_LENGTH);
-        const float_T t = float_T(time / UNIT_TIME);
-
-        /* Shortcuts for speeding up the field calculation. */
-        const float_T sinPhi = math::sin(phiT);
-        const float_T cosPhi = math::cos(phiT);
-        const float_T sinPhi2 = math::sin(phiT / float_T(2.0));
-        const float_T cosPhi2 = math::cos(phiT / float_T(2.0));
-        const float_T tanPhi2 = math::tan(phiT / float_T(2.0));
-
-        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
-         * thus help with formal code verification through manual code inspection.
-         */
-        const complex_T helpVar1 = -(cspeed*z) - cspeed*y*math::tan(float_T(PI / 2)-phiT)
-                                    + complex_T(0,1)*cspeed*rho0 / sinPhi;
-        const complex_T helpVar2 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
-        const complex_T helpVar3 = helpVar2*cspeed;
-        const complex_T helpVar4 = cspeed*om0*tauG*tauG
-                                    - complex_T(0,1)*y*cosPhi / cosPhi2 / cosPhi2*tanPhi2
-                                    - complex_T(0,2)*z*tanPhi2*tanPhi2;
-        const complex_T helpVar5 = float_T(2.0)*cspeed*t - complex_T(0,1)*cspeed*om0*tauG*tauG
-                            - float_T(2.0)*z + float_T(8.0)*y / sinPhi / sinPhi / sinPhi
-                                *sinPhi2*sinPhi2*sinPhi2*sinPhi2
-                            - float_T(2.0)*z*tanPhi2*tanPhi2;
-
-        const complex_T helpVar6 = (
-        (om0*y*rho0 / cosPhi2 / cosPhi2 / cosPhi2 / cosPhi2) / helpVar1
-        - (complex_T(0,2)*k*x*x) / helpVar2
-        - (complex_T(0,1)*om0*om0*tauG*tauG*rho0) / helpVar2
-        - (complex_T(0,4)*y*y*rho0) / (wy*wy*helpVar2)
-        + (om0*om0*tauG*tauG*y*cosPhi) / helpVar2
-        + (float_T(4.0)*y*y*y*cosPhi) / (wy*wy*helpVar2)
-        + (om0*om0*tauG*tauG*z*sinPhi) / helpVar2
-        + (float_T(4.0)*y*y*z*sinPhi) / (wy*wy*helpVar2)
-        + (complex_T(0,2)*om0*y*y*cosPhi / cosPhi2 / cosPhi2*tanPhi2) / helpVar3
-        + (om0*y*rho0*cosPhi / cosPhi2 / cosPhi2*tanPhi2) / helpVar3
-        + (complex_T(0,1)*om0*y*y*cosPhi*cosPhi/cosPhi2/cosPhi2*tanPhi2)/helpVar3
-        + (complex_T(0,4)*om0*y*z*tanPhi2*tanPhi2) / helpVar3
-        - (float_T(2.0)*om0*z*rho0*tanPhi2*tanPhi2) / helpVar3
-        - (complex_T(0,2)*om0*z*z*sinPhi*tanPhi2*tanPhi2) / helpVar3
-        - (om0*helpVar5*helpVar5) / (cspeed*helpVar4)
-        ) / float_T(4.0);
-
-        const complex_T helpVar7 = cspeed*om0*tauG*tauG
-                                    - complex_T(0,1)*y*cosPhi / cosPhi2 / cosPhi2*tanPhi2
-                                    - complex_T(0,2)*z*tanPhi2*tanPhi2;
-        const complex_T result = ( complex_T(0,2)*math::exp(helpVar6)*tauG*tanPhi2
-                                    *(cspeed*t - z + y*tanPhi2)
-                                    *math::sqrt( (om0*rho0) / helpVar3 )
-                                  ) / math::pow(helpVar7,float_T(1.5));
-
-        return result.get_real() / UNIT_SPEED;
+        PMacc::math::Complex<float_T> prefactor;
+        PMacc::math::Complex<float_T> exponent;
+        detail::calcTWTSBz_ExTerms<float_T>(getFieldParameters(), pos, time, prefactor, exponent);
+        return (math::exp(exponent)*prefactor).get_real() / SI::SPEED_OF_LIGHT_SI;
     }
 
+
     /** Calculate the Bx(r,t) field
      *
      * \param pos Spatial position of the target field.
@@ -573,6 +375,53 @@ namespace twts
         return -calcTWTSBy( pos, time );
     }
 
+    template<typename T_Float>
+    HDINLINE void
+    BField::calcTableTerms( const uint32_t slot, const float3_64& pos, const float_64 time,
+                            PMacc::math::Complex<T_Float>& prefactor,
+                            PMacc::math::Complex<T_Float>& exponent ) const
+    {
+        if (slot < detail::numComponents)
+            detail::calcTWTSByTerms<T_Float>(getFieldParameters(), pos, time, prefactor, exponent);
+        else if (pol == LINEAR_YZ)
+            detail::calcTWTSBz_EyTerms<T_Float>(getFieldParameters(), pos, time, prefactor, exponent);
+        else
+            detail::calcTWTSBz_ExTerms<T_Float>(getFieldParameters(), pos, time, prefactor, exponent);
+    }
+
+    HINLINE bool
+    BField::isTableSlotUsed( const uint32_t slot ) const
+    {
+        /* LINEAR_X uses By and Bz_Ex at the By- and Bz-position,
+         * LINEAR_YZ Bx = -By at the Bx-position and Bz_Ey at the By- and Bz-position
+         */
+        const uint32_t component = slot % detail::numComponents;
+        if (pol == LINEAR_YZ && slot < detail::numComponents)
+            return component == 0u;
+        return component != 0u;
+    }
+
+    HDINLINE BField::float_T
+    BField::calcTWTSComponent( const uint32_t slot, const float3_64& pos, const float_64 time,
+                               const DataSpace<DIM2>& tableIdx ) const
+    {
+        if (tableIdx.x() < 0)
+        {
+            if (slot < detail::numComponents)
+                return calcTWTSBy(pos, time);
+            if (pol == LINEAR_YZ)
+                return calcTWTSBz_Ey(pos, time);
+            return calcTWTSBz_Ex(pos, time);
+        }
+
+        const DataSpace<DIM3> idx(tableIdx.x(), tableIdx.y(), slot);
+        const float_64 t = time / SI::DELTA_T_SI - tableTime;
+        const float_64 x = pos.x() / (SI::SPEED_OF_LIGHT_SI * SI::DELTA_T_SI);
+        if (evaluation == TABLE_FLOAT32)
+            return float_T(table32(idx)(float_32(t), float_32(x)) / SI::SPEED_OF_LIGHT_SI);
+        return float_T(table64(idx)(t, x) / SI::SPEED_OF_LIGHT_SI);
+    }
+
     /** Calculate the Bz(r,t) field
      *
      * \param pos Spatial position of the target field.
@@ -581,150 +430,13 @@ namespace twts
     HDINLINE BField::float_T
     BField::calcTWTSBz_Ey( const float3_64& pos, const float_64 time ) const
     {
-        typedef PMacc::math::Complex<float_T> complex_T;
-        typedef PMacc::math::Complex<float_64> complex_64;
-        /** Unit of speed */
-        const float_64 UNIT_SPEED = SI::SPEED_OF_LIGHT_SI;
-        /** Unit of time */
-        const float_64 UNIT_TIME = SI::DELTA_T_SI;
-        /** Unit of length */
-        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
-
-        /* Propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
-        const float_T beta0 = float_T(beta_0);
-        /* If phi < 0 the formulas below are not directly applicable.
-         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
-         * z-axis of the coordinate system in this function.
-         */
-        const float_T phiReal = float_T( math::abs(phi) );
-        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
-                                                beta0*math::sin(phiReal));
-        /* Definition of the laser pulse front tilt angle for the laser field below.
-         *
-         * For beta0=1.0, this is equivalent to our standard definition. Question: Why is the
-         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
-         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
-         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
-         * the dispersion will (although physically correct) be slightly off the ideal TWTS
-         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
-         * scenarios close to beta0 = 1.
-         */
-        const float_T phiT = float_T(2.0)*alphaTilt;
-
-        /* Angle between the laser pulse front and the y-axis.
-         * Not used, but remains in code for documentation purposes.
-         * const float_T eta = float_T(float_T(PI / 2)) - (phiReal - alphaTilt);
-         */
-
-        const float_T cspeed = float_T( SI::SPEED_OF_LIGHT_SI / UNIT_SPEED );
-        const float_T lambda0 = float_T(wavelength_SI / UNIT_LENGTH);
-        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
-        /* factor 2  in tauG arises from definition convention in laser formula */
-        const float_T tauG = float_T(pulselength_SI*2.0 / UNIT_TIME);
-        /* w0 is wx here --> w0 could be replaced by wx */
-        const float_T w0 = float_T(w_x_SI / UNIT_LENGTH);
-        const float_T rho0 = float_T(PI*w0*w0 / lambda0);
-        /* wy is width of TWTS pulse */
-        const float_T wy = float_T(w_y_SI / UNIT_LENGTH);
-        const float_T k = float_T(2.0*PI / lambda0);
-        /* If phi < 0 the entire pulse is rotated by 180 deg around the
-         * z-axis of the coordinate system without also changing
-         * the orientation of the resulting field vectors.
-         */
-        const float_T x = float_T(phiPositive * pos.x() / UNIT_LENGTH);
-        const float_T y = float_T(phiPositive * pos.y() / UNIT_LENGTH);
-        const float_T z = float_T(pos.z() / UNIT_LENGTH);
-        const float_T t = float_T(time / UNIT_TIME);
-
-        /* Shortcuts for speeding up the field calculation. */
-        const float_T sinPhi = math::sin(phiT);
-        const float_T cosPhi = math::cos(phiT);
-        const float_T sinPhi2 = math::sin(phiT / float_T(2.0));
-        const float_T cosPhi2 = math::cos(phiT / float_T(2.0));
-        const float_T tanPhi2 = math::tan(phiT / float_T(2.0));
-
-        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
-         * thus help with formal code verification through manual code inspection.
-         */
-        const complex_T helpVar1 =
-            complex_T(0,-1)*cspeed*om0*tauG*tauG
-            - y*cosPhi / cosPhi2 / cosPhi2 * tanPhi2
-            - float_T(2.0)*z*tanPhi2*tanPhi2;
-        const complex_T helpVar2 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
-
-        const complex_T helpVar3 = (
-            - cspeed*cspeed*k*om0*tauG*tauG*wy*wy*x*x
-            - float_T(2.0)*cspeed*cspeed*om0*t*t*wy*wy*rho0
-            + complex_T(0,2)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*rho0
-            - float_T(2.0)*cspeed*cspeed*om0*tauG*tauG*y*y*rho0
-            + float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0
-            - complex_T(0,2)*cspeed*om0*om0*tauG*tauG*wy*wy*z*rho0
-            - float_T(2.0)*om0*wy*wy*z*z*rho0
-            - complex_T(0,8)*om0*wy*wy*y*(cspeed*t - z)*z*sinPhi2*sinPhi2
-            + complex_T(0,8) / sinPhi *(
-                float_T(2.0)*z*z*(cspeed*om0*t*wy*wy + complex_T(0,1)*cspeed*y*y - om0*wy*wy*z)
-                + y*(
-                    cspeed*k*wy*wy*x*x
-                    - complex_T(0,2)*cspeed*om0*t*wy*wy*rho0
-                    + float_T(2.0)*cspeed*y*y*rho0
-                    + complex_T(0,2)*om0*wy*wy*z*rho0
-                )*math::tan(float_T(PI) / float_T(2.0)-phiT) / sinPhi
-            )*sinPhi2*sinPhi2*sinPhi2*sinPhi2
-            - complex_T(0,2)*cspeed*cspeed*om0*t*t*wy*wy*z*sinPhi
-            - float_T(2.0)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*z*sinPhi
-            - complex_T(0,2)*cspeed*cspeed*om0*tauG*tauG*y*y*z*sinPhi
-            + complex_T(0,4)*cspeed*om0*t*wy*wy*z*z*sinPhi
-            + float_T(2.0)*cspeed*om0*om0*tauG*tauG*wy*wy*z*z*sinPhi
-            - complex_T(0,2)*om0*wy*wy*z*z*z*sinPhi
-            - float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*tanPhi2
-            + float_T(4.0)*om0*wy*wy*y*z*rho0*tanPhi2
-            + complex_T(0,2)*y*y*(
-                cspeed*om0*t*wy*wy
-                + complex_T(0,1)*cspeed*y*y
-                - om0*wy*wy*z
-            )*cosPhi*cosPhi / cosPhi2 / cosPhi2 * tanPhi2
-            + complex_T(0,2)*cspeed*k*wy*wy*x*x*z*tanPhi2*tanPhi2
-            - float_T(2.0)*om0*wy*wy*y*y*rho0*tanPhi2*tanPhi2
-            + float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0*tanPhi2*tanPhi2
-            + complex_T(0,4)*cspeed*y*y*z*rho0*tanPhi2*tanPhi2
-            - float_T(4.0)*om0*wy*wy*z*z*rho0*tanPhi2*tanPhi2
-            - complex_T(0,2)*om0*wy*wy*y*y*z*sinPhi*tanPhi2*tanPhi2
-            - float_T(2.0)*y*cosPhi*(
-                om0*(
-                    cspeed*cspeed*(complex_T(0,1)*t*t*wy*wy
-                    + om0*t*tauG*tauG*wy*wy
-                    + complex_T(0,1)*tauG*tauG*y*y)
-                    - cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*wy*wy*z
-                    + complex_T(0,1)*wy*wy*z*z
-                )
-                + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
-                + complex_T(0,1)*(
-                    complex_T(0,-4)*cspeed*y*y*z
-                    + om0*wy*wy*(y*y - float_T(4.0)*(cspeed*t - z)*z)
-                )*tanPhi2*tanPhi2
-            )
-        /* The "round-trip" conversion in the line below fixes a gross accuracy bug
-         * in floating-point arithmetics, when float_T is set to float_X.
-         */
-        ) * complex_T( float_64(1.0) / complex_64(float_T(2.0)*cspeed*wy*wy*helpVar2*helpVar1) );
-
-        const complex_T helpVar4 = (
-            cspeed*om0*(
-                cspeed*om0*tauG*tauG
-                - complex_T(0,8)*y*math::tan( float_T(PI) / float_T(2.0) - phiT )
-                    / sinPhi / sinPhi * sinPhi2*sinPhi2*sinPhi2*sinPhi2
-                - complex_T(0,2)*z*tanPhi2*tanPhi2
-            )
-        ) / rho0;
-
-        const complex_T result = float_T(-1.0)*(
-            cspeed*math::exp(helpVar3)*k*tauG*x*math::pow( helpVar2, float_T(-1.5) )
-            / math::sqrt(helpVar4)
-        );
-
-        return result.get_real() / UNIT_SPEED;
+        PMacc::math::Complex<float_T> prefactor;
+        PMacc::math::Complex<float_T> exponent;
+        detail::calcTWTSBz_EyTerms<float_T>(getFieldParameters(), pos, time, prefactor, exponent);
+        return (math::exp(exponent)*prefactor).get_real() / SI::SPEED_OF_LIGHT_SI;
     }
 
+
 } /* namespace twts */
 } /* namespace templates */
 } /* namespace picongpu */
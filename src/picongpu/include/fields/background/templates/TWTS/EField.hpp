@@ -1,4 +1,4 @@
-/* Copyright 2014-2017 Alexander Debus, Axel Huebl
+/* Copyright 2014-2017 Alexander Debus, Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -23,8 +23,11 @@
 #include "pmacc_types.hpp"
 
 #include "math/Vector.hpp"
+#include "math/Complex.hpp"
 #include "dimensions/DataSpace.hpp"
 #include "fields/background/templates/TWTS/numComponents.hpp"
+#include "fields/background/templates/TWTS/FieldTerms.hpp"
+#include "fields/background/templates/TWTS/SpatialTable.hpp"
 
 namespace picongpu
 {
@@ -90,6 +93,19 @@ public:
     const PMACC_ALIGN(auto_tdelay,bool);
     /* Polarization of TWTS laser */
     const PMACC_ALIGN(pol,PolarizationType);
+    /* Evaluation of the field functions (CALCULATE in 2D) */
+    PMACC_ALIGN(evaluation,EvaluationType);
+    /* Tables of the field functions in the local (y,z)-plane, see detail::SpatialTable */
+    PMACC_ALIGN(table64,detail::TableBox64);
+    PMACC_ALIGN(table32,detail::TableBox32);
+    /* Total cell index (y,z) of the first table entry and number of entries */
+    PMACC_ALIGN(tableOffset,DataSpace<DIM2>);
+    PMACC_ALIGN(tableSize,DataSpace<DIM2>);
+    /* Reference time of the used tables [DELTA_T_SI] */
+    PMACC_ALIGN(tableTime,float_64);
+
+    /* Table slot of the Ex-function at the intra-cell position of each field component */
+    static constexpr uint32_t numTableSlots = detail::numComponents;
 
     /** Electric field of the TWTS laser
      *
@@ -109,6 +125,8 @@ public:
      *  inside the simulation volume at simulation start timestep = 0 [default = true]
      * \param pol dtermines the TWTS laser polarization, which is either normal or parallel
      *  to the laser pulse front tilt plane [ default= LINEAR_X , LINEAR_YZ ]
+     * \param evaluation evaluation of the field functions
+     *  [ default= CALCULATE , TABLE , TABLE_FLOAT32 ], tables are only used in 3D
      */
     HINLINE
     EField( const float_64 focus_y_SI,
@@ -120,7 +138,8 @@ public:
             const float_X beta_0            = 1.0,
             const float_64 tdelay_user_SI   = 0.0,
             const bool auto_tdelay          = true,
-            const PolarizationType pol      = LINEAR_X );
+            const PolarizationType pol      = LINEAR_X,
+            const EvaluationType evaluation = CALCULATE );
 
     /** Specify your background field E(r,t) here
      *
@@ -150,25 +169,58 @@ public:
     HDINLINE float_T
     calcTWTSEy( const float3_64& pos, const float_64 time ) const;
 
+    /** Parameters of the field functions, see detail::calcTWTSExTerms */
+    HDINLINE detail::FieldParameters
+    getFieldParameters( ) const;
+
+    /** Field function of a table slot, see detail::SpatialTable */
+    template<typename T_Float>
+    HDINLINE void
+    calcTableTerms( const uint32_t slot, const float3_64& pos, const float_64 time,
+                    PMacc::math::Complex<T_Float>& prefactor,
+                    PMacc::math::Complex<T_Float>& exponent ) const;
+
+    /** Is a table slot used with the polarization of the laser? */
+    HINLINE bool
+    isTableSlotUsed( const uint32_t slot ) const;
+
+    static HINLINE const char*
+    getTableName()
+    {
+        return "E";
+    }
+
+    /** Calculate the Ex(r,t) field of a table slot, from the table if tableIdx is valid
+     *
+     * \param slot table slot, intra-cell position of the field component
+     * \param tableIdx index in the tables, negative if the cell is not in the tables */
+    HDINLINE float_T
+    calcTWTSComponent( const uint32_t slot, const float3_64& pos, const float_64 time,
+                       const DataSpace<DIM2>& tableIdx ) const;
+
     /** Calculate the E-field vector of the TWTS laser in SI units.
      * \tparam T_dim Specializes for the simulation dimension
      * \param cellIdx The total cell id counted from the start at timestep 0
+     * \param tableIdx index in the tables (3D), negative if not in the tables
      * \return Efield vector of the rotated TWTS field in SI units */
     template <unsigned T_dim>
     HDINLINE float3_X
     getTWTSEfield_Normalized(
             const PMacc::math::Vector<floatD_64,detail::numComponents>& eFieldPositions_SI,
-            const float_64 time) const;
+            const float_64 time,
+            const DataSpace<DIM2>& tableIdx) const;
 
     /** Calculate the E-field vector of the "in-plane polarized" TWTS laser in SI units.
      * \tparam T_dim Specializes for the simulation dimension
      * \param cellIdx The total cell id counted from the start at timestep 0
+     * \param tableIdx index in the tables (3D), negative if not in the tables
      * \return Efield vector of the rotated TWTS field in SI units */
     template <unsigned T_dim>
     HDINLINE float3_X
     getTWTSEfield_Normalized_Ey(
             const PMacc::math::Vector<floatD_64,detail::numComponents>& eFieldPositions_SI,
-            const float_64 time) const;
+            const float_64 time,
+            const DataSpace<DIM2>& tableIdx) const;
 
 };
 
@@ -0,0 +1,679 @@
+/* Copyright 2014-2017 Alexander Debus, Axel Huebl, agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+
+#include "math/Vector.hpp"
+#include "math/Complex.hpp"
+#include "algorithms/math.hpp"
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+namespace templates
+{
+namespace twts
+{
+/** Auxiliary functions for calculating the TWTS field */
+namespace detail
+{
+    namespace math = PMacc::algorithms::math;
+
+    /* same types and value as picongpu::float_32, float_64, float3_64 and PI,
+     * defined here without the simulation */
+    typedef float float_32;
+    typedef double float_64;
+    typedef PMacc::math::Vector<float_64, 3> float3_64;
+    constexpr float_64 PI = 3.141592653589793238462643383279502884197169399;
+
+    /** Parameters of the TWTS field functions
+     *
+     * The field functions return the fields of EField and BField (B multiplied by
+     * speedOfLight_SI) as Re[prefactor * exp(exponent)]. The calculation is done in
+     * units of deltaT_SI and speedOfLight_SI * deltaT_SI.
+     */
+    struct FieldParameters
+    {
+        /* Laser wavelength [meter] */
+        float_64 wavelength_SI;
+        /* TWTS laser pulse duration [second] */
+        float_64 pulselength_SI;
+        /* line focus height of TWTS pulse [meter] */
+        float_64 w_x_SI;
+        /* line focus width of TWTS pulse [meter] */
+        float_64 w_y_SI;
+        /* interaction angle between TWTS laser propagation vector and the y-axis [rad] */
+        float_64 phi;
+        /* Takes value 1.0 for phi > 0 and -1.0 for phi < 0. */
+        float_64 phiPositive;
+        /* propagation speed of TWTS laser overlap normalized to the speed of light */
+        float_64 beta_0;
+        /* time step of the simulation [second] */
+        float_64 deltaT_SI;
+        /* speed of light [meter / second] */
+        float_64 speedOfLight_SI;
+
+        HDINLINE
+        FieldParameters( const float_64 wavelength_SI,
+                         const float_64 pulselength_SI,
+                         const float_64 w_x_SI,
+                         const float_64 w_y_SI,
+                         const float_64 phi,
+                         const float_64 phiPositive,
+                         const float_64 beta_0,
+                         const float_64 deltaT_SI,
+                         const float_64 speedOfLight_SI ) :
+            wavelength_SI(wavelength_SI), pulselength_SI(pulselength_SI),
+            w_x_SI(w_x_SI), w_y_SI(w_y_SI), phi(phi), phiPositive(phiPositive),
+            beta_0(beta_0), deltaT_SI(deltaT_SI), speedOfLight_SI(speedOfLight_SI)
+        {
+        }
+    };
+
+    /** Calculate the prefactor P and the exponent E of Ex(r,t) = Re[P * exp(E)]
+     *
+     * \param par parameters of the TWTS field
+     * \param pos Spatial position of the target field.
+     * \param time Absolute time (SI, including all offsets and transformations) for calculating
+     *             the field */
+    template<typename T_Float>
+    HDINLINE void
+    calcTWTSExTerms( const FieldParameters& par, const float3_64& pos, const float_64 time,
+                     PMacc::math::Complex<T_Float>& prefactor,
+                     PMacc::math::Complex<T_Float>& exponent )
+    {
+        typedef T_Float float_T;
+        typedef PMacc::math::Complex<float_T> complex_T;
+        typedef PMacc::math::Complex<float_64> complex_64;
+        /* Unit of speed */
+        const float_64 UNIT_SPEED = par.speedOfLight_SI;
+        /* Unit of time */
+        const float_64 UNIT_TIME = par.deltaT_SI;
+        /* Unit of length */
+        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
+
+        /* Propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
+        const float_T beta0 = float_T(par.beta_0);
+        /* If phi < 0 the formulas below are not directly applicable.
+         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
+         * z-axis of the coordinate system in this function.
+         */
+        const float_T phiReal = float_T( math::abs(par.phi) );
+        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
+                                                beta0*math::sin(phiReal));
+        /* Definition of the laser pulse front tilt angle for the laser field below.
+         *
+         * For beta0 = 1.0, this is equivalent to our standard definition. Question: Why is the
+         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
+         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
+         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
+         * the dispersion will (although physically correct) be slightly off the ideal TWTS
+         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
+         * scenarios close to beta0 = 1.
+         */
+        const float_T phiT = float_T(2.0)*alphaTilt;
+
+        /* Angle between the laser pulse front and the y-axis. Not used, but remains in code for
+         * documentation purposes.
+         * const float_T eta = (PI / 2) - (phiReal - alphaTilt);
+         */
+
+        const float_T cspeed = float_T( par.speedOfLight_SI / UNIT_SPEED );
+        const float_T lambda0 = float_T(par.wavelength_SI / UNIT_LENGTH);
+        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
+        /* factor 2  in tauG arises from definition convention in laser formula */
+        const float_T tauG = float_T(par.pulselength_SI*2.0 / UNIT_TIME);
+        /* w0 is wx here --> w0 could be replaced by wx */
+        const float_T w0 = float_T(par.w_x_SI / UNIT_LENGTH);
+        const float_T rho0 = float_T(PI*w0*w0/lambda0);
+        /* wy is width of TWTS pulse */
+        const float_T wy = float_T(par.w_y_SI / UNIT_LENGTH);
+        const float_T k = float_T(2.0*PI / lambda0);
+        const float_T x = float_T(par.phiPositive * pos.x() / UNIT_LENGTH);
+        const float_T y = float_T(par.phiPositive * pos.y() / UNIT_LENGTH);
+        const float_T z = float_T(pos.z() / UNIT_LENGTH);
+        const float_T t = float_T(time / UNIT_TIME);
+
+        /* Calculating shortcuts for speeding up field calculation */
+        const float_T sinPhi = math::sin(phiT);
+        const float_T cosPhi = math::cos(phiT);
+        const float_T sinPhi2 = math::sin(phiT / float_T(2.0));
+        const float_T cosPhi2 = math::cos(phiT / float_T(2.0));
+        const float_T tanPhi2 = math::tan(phiT / float_T(2.0));
+
+        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
+         * thus help with formal code verification through manual code inspection.
+         */
+        const complex_T helpVar1 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
+        const complex_T helpVar2 = complex_T(0,-1)*cspeed*om0*tauG*tauG
+                                    - y*cosPhi / cosPhi2 / cosPhi2*tanPhi2
+                                    - float_T(2.0)*z*tanPhi2*tanPhi2;
+        const complex_T helpVar3 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
+
+        const complex_T helpVar4 = (
+            -(cspeed*cspeed*k*om0*tauG*tauG*wy*wy*x*x)
+            - float_T(2.0)*cspeed*cspeed*om0*t*t*wy*wy*rho0
+            + complex_T(0,2)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*rho0
+            - float_T(2.0)*cspeed*cspeed*om0*tauG*tauG*y*y*rho0
+            + float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0
+            - complex_T(0,2)*cspeed*om0*om0*tauG*tauG*wy*wy*z*rho0
+            - float_T(2.0)*om0*wy*wy*z*z*rho0
+            - complex_T(0,8)*om0*wy*wy*y*(cspeed*t - z)*z*sinPhi2*sinPhi2
+            + complex_T(0,8) / sinPhi*(
+                    +float_T(2.0)*z*z*(cspeed*om0*t*wy*wy+complex_T(0,1)*cspeed*y*y-om0*wy*wy*z)
+                    + y*(
+                        + cspeed*k*wy*wy*x*x
+                        - complex_T(0,2)*cspeed*om0*t*wy*wy*rho0
+                        + float_T(2.0)*cspeed*y*y*rho0
+                        + complex_T(0,2)*om0*wy*wy*z*rho0
+                    )*math::tan(float_T(PI / 2.0)-phiT)/sinPhi
+                )*sinPhi2*sinPhi2*sinPhi2*sinPhi2
+            - complex_T(0,2)*cspeed*cspeed*om0*t*t*wy*wy*z*sinPhi
+            - float_T(2.0)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*z*sinPhi
+            - complex_T(0,2)*cspeed*cspeed*om0*tauG*tauG*y*y*z*sinPhi
+            + complex_T(0,4)*cspeed*om0*t*wy*wy*z*z*sinPhi
+            + float_T(2.0)*cspeed*om0*om0*tauG*tauG*wy*wy*z*z*sinPhi
+            - complex_T(0,2)*om0*wy*wy*z*z*z*sinPhi
+            - float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*tanPhi2
+            + float_T(4.0)*om0*wy*wy*y*z*rho0*tanPhi2
+            + complex_T(0,2)*y*y*(
+                 + cspeed*om0*t*wy*wy + complex_T(0,1)*cspeed*y*y - om0*wy*wy*z
+                 )*cosPhi*cosPhi / cosPhi2 / cosPhi2*tanPhi2
+            + complex_T(0,2)*cspeed*k*wy*wy*x*x*z*tanPhi2*tanPhi2
+            - float_T(2.0)*om0*wy*wy*y*y*rho0*tanPhi2*tanPhi2
+            + float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0*tanPhi2*tanPhi2
+            + complex_T(0,4)*cspeed*y*y*z*rho0*tanPhi2*tanPhi2
+            - float_T(4.0)*om0*wy*wy*z*z*rho0*tanPhi2*tanPhi2
+            - complex_T(0,2)*om0*wy*wy*y*y*z*sinPhi*tanPhi2*tanPhi2
+            - float_T(2.0)*y*cosPhi*(
+                + om0*(
+                    + cspeed*cspeed*(
+                          complex_T(0,1)*t*t*wy*wy
+                        + om0*t*tauG*tauG*wy*wy
+                        + complex_T(0,1)*tauG*tauG*y*y
+                        )
+                    - cspeed*(complex_T(0,2)*t
+                    + om0*tauG*tauG)*wy*wy*z
+                    + complex_T(0,1)*wy*wy*z*z
+                    )
+                + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
+                + complex_T(0,1)*tanPhi2*tanPhi2*(
+                      complex_T(0,-4)*cspeed*y*y*z
+                    + om0*wy*wy*(y*y - float_T(4.0)*(cspeed*t - z)*z)
+                )
+            )
+        /* The "round-trip" conversion in the line below fixes a gross accuracy bug
+         * in floating-point arithmetics, when float_T is set to float_X.
+         */
+        ) * complex_T( float_64(1.0) / complex_64(float_T(2.0)*cspeed*wy*wy*helpVar1*helpVar2) );
+
+        const complex_T helpVar5 = cspeed*om0*tauG*tauG
+            - complex_T(0,8)*y*math::tan( float_T(PI / 2)-phiT )
+                                / sinPhi / sinPhi*sinPhi2*sinPhi2*sinPhi2*sinPhi2
+            - complex_T(0,2)*z*tanPhi2*tanPhi2;
+        /* Ex = Re[ exp(helpVar4)*tauG*sqrt((cspeed*om0*rho0) / helpVar3) / sqrt(helpVar5) ] */
+        exponent = helpVar4;
+        prefactor = (tauG*math::sqrt((cspeed*om0*rho0) / helpVar3)) / math::sqrt(helpVar5);
+    }
+
+    /** Calculate the prefactor P and the exponent E of By(r,t) = Re[P * exp(E)] / c
+     *
+     * \param par parameters of the TWTS field
+     * \param pos Spatial position of the target field.
+     * \param time Absolute time (SI, including all offsets and transformations)
+     *             for calculating the field */
+    template<typename T_Float>
+    HDINLINE void
+    calcTWTSByTerms( const FieldParameters& par, const float3_64& pos, const float_64 time,
+                     PMacc::math::Complex<T_Float>& prefactor,
+                     PMacc::math::Complex<T_Float>& exponent )
+    {
+        typedef T_Float float_T;
+        typedef PMacc::math::Complex<float_T> complex_T;
+        typedef PMacc::math::Complex<float_64> complex_64;
+        /* Unit of speed */
+        const float_64 UNIT_SPEED = par.speedOfLight_SI;
+        /* Unit of time */
+        const float_64 UNIT_TIME = par.deltaT_SI;
+        /* Unit of length */
+        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
+
+        /* Propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
+        const float_T beta0 = float_T(par.beta_0);
+        /* If phi < 0 the formulas below are not directly applicable.
+         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
+         * z-axis of the coordinate system in this function.
+         */
+        const float_T phiReal = float_T( math::abs(par.phi) );
+        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
+                                                beta0*math::sin(phiReal));
+        /* Definition of the laser pulse front tilt angle for the laser field below.
+         *
+         * For beta0=1.0, this is equivalent to our standard definition. Question: Why is the
+         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
+         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
+         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
+         * the dispersion will (although physically correct) be slightly off the ideal TWTS
+         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
+         * scenarios close to beta0 = 1.
+         */
+        const float_T phiT = float_T(2.0)*alphaTilt;
+
+        /* Angle between the laser pulse front and the y-axis. Not used, but remains in code for
+         * documentation purposes.
+         * const float_T eta = float_T(PI/2) - (phiReal - alphaTilt);
+         */
+
+        const float_T cspeed = float_T( par.speedOfLight_SI / UNIT_SPEED );
+        const float_T lambda0 = float_T(par.wavelength_SI / UNIT_LENGTH);
+        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
+        /* factor 2  in tauG arises from definition convention in laser formula */
+        const float_T tauG = float_T(par.pulselength_SI*2.0 / UNIT_TIME);
+        /* w0 is wx here --> w0 could be replaced by wx */
+        const float_T w0 = float_T(par.w_x_SI / UNIT_LENGTH);
+        const float_T rho0 = float_T(PI*w0*w0 / lambda0);
+        /* wy is width of TWTS pulse */
+        const float_T wy = float_T(par.w_y_SI / UNIT_LENGTH);
+        const float_T k = float_T(2.0*PI / lambda0);
+        /* If phi < 0 the entire pulse is rotated by 180 deg around the
+         * z-axis of the coordinate system without also changing
+         * the orientation of the resulting field vectors.
+         */
+        const float_T x = float_T(par.phiPositive * pos.x() / UNIT_LENGTH);
+        const float_T y = float_T(par.phiPositive * pos.y() / UNIT_LENGTH);
+        const float_T z = float_T(pos.z() / UNIT_LENGTH);
+        const float_T t = float_T(time / UNIT_TIME);
+
+        /* Shortcuts for speeding up the field calculation. */
+        const float_T sinPhi = math::sin(phiT);
+        const float_T cosPhi = math::cos(phiT);
+        const float_T cosPhi2 = math::cos(phiT / 2.0);
+        const float_T tanPhi2 = math::tan(phiT / 2.0);
+
+        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
+         * thus help with formal code verification through manual code inspection.
+         */
+        const complex_T helpVar1 = rho0 + complex_T(0,1)*y*cosPhi + complex_T(0,1)*z*sinPhi;
+        const complex_T helpVar2 = cspeed*om0*tauG*tauG + complex_T(0,2)
+                                    *(-z - y*math::tan(float_T(PI / 2)-phiT))*tanPhi2*tanPhi2;
+        const complex_T helpVar3 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
+
+        const complex_T helpVar4 = float_T(-1.0)*(
+            cspeed*cspeed*k*om0*tauG*tauG*wy*wy*x*x
+            + float_T(2.0)*cspeed*cspeed*om0*t*t*wy*wy*rho0
+            - complex_T(0,2)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*rho0
+            + float_T(2.0)*cspeed*cspeed*om0*tauG*tauG*y*y*rho0
+            - float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0
+            + complex_T(0,2)*cspeed*om0*om0*tauG*tauG*wy*wy*z*rho0
+            + float_T(2.0)*om0*wy*wy*z*z*rho0
+            + float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*tanPhi2
+            - float_T(4.0)*om0*wy*wy*y*z*rho0*tanPhi2
+            - complex_T(0,2)*cspeed*k*wy*wy*x*x*z*tanPhi2*tanPhi2
+            + float_T(2.0)*om0*wy*wy*y*y*rho0*tanPhi2*tanPhi2
+            - float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0*tanPhi2*tanPhi2
+            - complex_T(0,4)*cspeed*y*y*z*rho0*tanPhi2*tanPhi2
+            + float_T(4.0)*om0*wy*wy*z*z*rho0*tanPhi2*tanPhi2
+            - complex_T(0,2)*cspeed*k*wy*wy*x*x*y*math::tan(float_T(PI / 2)-phiT)*tanPhi2*tanPhi2
+            - float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*math::tan(float_T(PI / 2)-phiT)
+                *tanPhi2*tanPhi2
+            - complex_T(0,4)*cspeed*y*y*y*rho0*math::tan(float_T(PI / 2)-phiT)*tanPhi2*tanPhi2
+            + float_T(4.0)*om0*wy*wy*y*z*rho0*math::tan(float_T(PI / 2)-phiT)*tanPhi2*tanPhi2
+            + float_T(2.0)*z*sinPhi*(
+                + om0*(
+                    + cspeed*cspeed*(
+                          complex_T(0,1)*t*t*wy*wy
+                        + om0*t*tauG*tauG*wy*wy
+                        + complex_T(0,1)*tauG*tauG*y*y
+                    )
+                    - cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*wy*wy*z
+                    + complex_T(0,1)*wy*wy*z*z
+                    )
+                + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
+                + complex_T(0,1)*tanPhi2*tanPhi2*(
+                      complex_T(0,-2)*cspeed*y*y*z
+                    + om0*wy*wy*( y*y - float_T(2.0)*(cspeed*t - z)*z )
+                )
+            )
+            + float_T(2.0)*y*cosPhi*(
+                + om0*(
+                    + cspeed*cspeed*(
+                          complex_T(0,1)*t*t*wy*wy
+                        + om0*t*tauG*tauG*wy*wy
+                        + complex_T(0,1)*tauG*tauG*y*y
+                    )
+                - cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*wy*wy*z
+                + complex_T(0,1)*wy*wy*z*z
+                )
+            + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
+            + complex_T(0,1)*(
+                  complex_T(0,-4)*cspeed*y*y*z
+                + om0*wy*wy*(y*y - float_T(4.0)*(cspeed*t - z)*z)
+                - float_T(2.0)*y*(
+                    + cspeed*om0*t*wy*wy
+                    + complex_T(0,1)*cspeed*y*y
+                    - om0*wy*wy*z
+                    )*math::tan(float_T(PI / 2)-phiT)
+                )*tanPhi2*tanPhi2
+            )
+        /* The "round-trip" conversion in the line below fixes a gross accuracy bug
+         * in floating-point arithmetics, when float_T is set to float_X.
+         */
+        ) * complex_T( float_64(1.0) / complex_64(float_T(2.0)*cspeed*wy*wy*helpVar1*helpVar2) );
+
+        const complex_T helpVar5 = complex_T(0,-1)*cspeed*om0*tauG*tauG
+                                + (-z - y*math::tan(float_T(PI / 2)-phiT))
+                                    *tanPhi2*tanPhi2*float_T(2.0);
+        const complex_T helpVar6 = (cspeed*(cspeed*om0*tauG*tauG + complex_T(0,2)
+                                *(-z - y*math::tan(float_T(PI / 2)-phiT))*tanPhi2*tanPhi2))
+                                    / (om0*rho0);
+        exponent = helpVar4;
+        prefactor = (tauG / cosPhi2 / cosPhi2
+            *(rho0 + complex_T(0,1)*y*cosPhi + complex_T(0,1)*z*sinPhi)
+            *(
+                  complex_T(0,2)*cspeed*t + cspeed*om0*tauG*tauG - complex_T(0,4)*z
+                + cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*cosPhi
+                + complex_T(0,2)*y*tanPhi2
+            )*math::pow(helpVar3,float_T(-1.5))
+        ) / (float_T(2.0)*helpVar5*math::sqrt(helpVar6));
+    }
+
+    /** Calculate the prefactor P and the exponent E of Bz(r,t) = Re[P * exp(E)] / c,
+     *  electric field vector (Ex,0,0)
+     *
+     * \param par parameters of the TWTS field
+     * \param pos Spatial position of the target field.
+     * \param time Absolute time (SI, including all offsets and transformations)
+     *             for calculating the field */
+    template<typename T_Float>
+    HDINLINE void
+    calcTWTSBz_ExTerms( const FieldParameters& par, const float3_64& pos, const float_64 time,
+                        PMacc::math::Complex<T_Float>& prefactor,
+                        PMacc::math::Complex<T_Float>& exponent )
+    {
+        typedef T_Float float_T;
+        typedef PMacc::math::Complex<float_T> complex_T;
+        /** Unit of Speed */
+        const float_64 UNIT_SPEED = par.speedOfLight_SI;
+        /** Unit of time */
+        const float_64 UNIT_TIME = par.deltaT_SI;
+        /** Unit of length */
+        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
+
+        /* propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
+        const float_T beta0 = float_T(par.beta_0);
+        /* If phi < 0 the formulas below are not directly applicable.
+         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
+         * z-axis of the coordinate system in this function.
+         */
+        const float_T phiReal = float_T( math::abs(par.phi) );
+        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
+                                                beta0*math::sin(phiReal));
+
+        /* Definition of the laser pulse front tilt angle for the laser field below.
+         *
+         * For beta0=1.0, this is equivalent to our standard definition. Question: Why is the
+         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
+         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
+         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
+         * the dispersion will (although physically correct) be slightly off the ideal TWTS
+         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
+         * scenarios close to beta0 = 1.
+         */
+        const float_T phiT = float_T(2.0)*alphaTilt;
+
+        /* Angle between the laser pulse front and the y-axis.
+         * Not used, but remains in code for documentation purposes.
+         * const float_T eta = float_T(float_T(PI / 2)) - (phiReal - alphaTilt);
+         */
+
+        const float_T cspeed = float_T( par.speedOfLight_SI / UNIT_SPEED );
+        const float_T lambda0 = float_T(par.wavelength_SI / UNIT_LENGTH);
+        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
+        /* factor 2  in tauG arises from definition convention in laser formula */
+        const float_T tauG = float_T(par.pulselength_SI*2.0 / UNIT_TIME);
+        /* w0 is wx here --> w0 could be replaced by wx */
+        const float_T w0 = float_T(par.w_x_SI / UNIT_LENGTH);
+        const float_T rho0 = float_T(PI*w0*w0 / lambda0);
+        /* wy is width of TWTS pulse */
+        const float_T wy = float_T(par.w_y_SI / UNIT_LENGTH);
+        const float_T k = float_T(2.0*PI / lambda0);
+        /* If phi < 0 the entire pulse is rotated by 180 deg around the
+         * z-axis of the coordinate system without also changing
+         * the orientation of the resulting field vectors.
+         */
+        const float_T x = float_T(par.phiPositive * pos.x() / UNIT_LENGTH);
+        const float_T y = float_T(par.phiPositive * pos.y() / UNIT_LENGTH);
+        const float_T z = float_T(pos.z() / UNIT_LENGTH);
+        const float_T t = float_T(time / UNIT_TIME);
+
+        /* Shortcuts for speeding up the field calculation. */
+        const float_T sinPhi = math::sin(phiT);
+        const float_T cosPhi = math::cos(phiT);
+        const float_T sinPhi2 = math::sin(phiT / float_T(2.0));
+        const float_T cosPhi2 = math::cos(phiT / float_T(2.0));
+        const float_T tanPhi2 = math::tan(phiT / float_T(2.0));
+
+        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
+         * thus help with formal code verification through manual code inspection.
+         */
+        const complex_T helpVar1 = -(cspeed*z) - cspeed*y*math::tan(float_T(PI / 2)-phiT)
+                                    + complex_T(0,1)*cspeed*rho0 / sinPhi;
+        const complex_T helpVar2 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
+        const complex_T helpVar3 = helpVar2*cspeed;
+        const complex_T helpVar4 = cspeed*om0*tauG*tauG
+                                    - complex_T(0,1)*y*cosPhi / cosPhi2 / cosPhi2*tanPhi2
+                                    - complex_T(0,2)*z*tanPhi2*tanPhi2;
+        const complex_T helpVar5 = float_T(2.0)*cspeed*t - complex_T(0,1)*cspeed*om0*tauG*tauG
+                            - float_T(2.0)*z + float_T(8.0)*y / sinPhi / sinPhi / sinPhi
+                                *sinPhi2*sinPhi2*sinPhi2*sinPhi2
+                            - float_T(2.0)*z*tanPhi2*tanPhi2;
+
+        const complex_T helpVar6 = (
+        (om0*y*rho0 / cosPhi2 / cosPhi2 / cosPhi2 / cosPhi2) / helpVar1
+        - (complex_T(0,2)*k*x*x) / helpVar2
+        - (complex_T(0,1)*om0*om0*tauG*tauG*rho0) / helpVar2
+        - (complex_T(0,4)*y*y*rho0) / (wy*wy*helpVar2)
+        + (om0*om0*tauG*tauG*y*cosPhi) / helpVar2
+        + (float_T(4.0)*y*y*y*cosPhi) / (wy*wy*helpVar2)
+        + (om0*om0*tauG*tauG*z*sinPhi) / helpVar2
+        + (float_T(4.0)*y*y*z*sinPhi) / (wy*wy*helpVar2)
+        + (complex_T(0,2)*om0*y*y*cosPhi / cosPhi2 / cosPhi2*tanPhi2) / helpVar3
+        + (om0*y*rho0*cosPhi / cosPhi2 / cosPhi2*tanPhi2) / helpVar3
+        + (complex_T(0,1)*om0*y*y*cosPhi*cosPhi/cosPhi2/cosPhi2*tanPhi2)/helpVar3
+        + (complex_T(0,4)*om0*y*z*tanPhi2*tanPhi2) / helpVar3
+        - (float_T(2.0)*om0*z*rho0*tanPhi2*tanPhi2) / helpVar3
+        - (complex_T(0,2)*om0*z*z*sinPhi*tanPhi2*tanPhi2) / helpVar3
+        - (om0*helpVar5*helpVar5) / (cspeed*helpVar4)
+        ) / float_T(4.0);
+
+        const complex_T helpVar7 = cspeed*om0*tauG*tauG
+                                    - complex_T(0,1)*y*cosPhi / cosPhi2 / cosPhi2*tanPhi2
+                                    - complex_T(0,2)*z*tanPhi2*tanPhi2;
+        exponent = helpVar6;
+        prefactor = ( complex_T(0,2)*tauG*tanPhi2
+                        *(cspeed*t - z + y*tanPhi2)
+                        *math::sqrt( (om0*rho0) / helpVar3 )
+                    ) / math::pow(helpVar7,float_T(1.5));
+    }
+
+    /** Calculate the prefactor P and the exponent E of Bz(r,t) = Re[P * exp(E)] / c,
+     *  electric field vector (0,Ey,0)
+     *
+     * \param par parameters of the TWTS field
+     * \param pos Spatial position of the target field.
+     * \param time Absolute time (SI, including all offsets and transformations)
+     *             for calculating the field */
+    template<typename T_Float>
+    HDINLINE void
+    calcTWTSBz_EyTerms( const FieldParameters& par, const float3_64& pos, const float_64 time,
+                        PMacc::math::Complex<T_Float>& prefactor,
+                        PMacc::math::Complex<T_Float>& exponent )
+    {
+        typedef T_Float float_T;
+        typedef PMacc::math::Complex<float_T> complex_T;
+        typedef PMacc::math::Complex<float_64> complex_64;
+        /** Unit of speed */
+        const float_64 UNIT_SPEED = par.speedOfLight_SI;
+        /** Unit of time */
+        const float_64 UNIT_TIME = par.deltaT_SI;
+        /** Unit of length */
+        const float_64 UNIT_LENGTH = UNIT_TIME*UNIT_SPEED;
+
+        /* Propagation speed of overlap normalized to the speed of light [Default: beta0=1.0] */
+        const float_T beta0 = float_T(par.beta_0);
+        /* If phi < 0 the formulas below are not directly applicable.
+         * Instead phi is taken positive, but the entire pulse rotated by 180 deg around the
+         * z-axis of the coordinate system in this function.
+         */
+        const float_T phiReal = float_T( math::abs(par.phi) );
+        const float_T alphaTilt = math::atan2(float_T(1.0)-beta0*math::cos(phiReal),
+                                                beta0*math::sin(phiReal));
+        /* Definition of the laser pulse front tilt angle for the laser field below.
+         *
+         * For beta0=1.0, this is equivalent to our standard definition. Question: Why is the
+         * local "phi_T" not equal in value to the object member "phiReal" or "phi"?
+         * Because the standard TWTS pulse is defined for beta0 = 1.0 and in the coordinate-system
+         * of the TWTS model phi is responsible for pulse front tilt and dispersion only. Hence
+         * the dispersion will (although physically correct) be slightly off the ideal TWTS
+         * pulse for beta0 != 1.0. This only shows that this TWTS pulse is primarily designed for
+         * scenarios close to beta0 = 1.
+         */
+        const float_T phiT = float_T(2.0)*alphaTilt;
+
+        /* Angle between the laser pulse front and the y-axis.
+         * Not used, but remains in code for documentation purposes.
+         * const float_T eta = float_T(float_T(PI / 2)) - (phiReal - alphaTilt);
+         */
+
+        const float_T cspeed = float_T( par.speedOfLight_SI / UNIT_SPEED );
+        const float_T lambda0 = float_T(par.wavelength_SI / UNIT_LENGTH);
+        const float_T om0 = float_T(2.0*PI*cspeed / lambda0);
+        /* factor 2  in tauG arises from definition convention in laser formula */
+        const float_T tauG = float_T(par.pulselength_SI*2.0 / UNIT_TIME);
+        /* w0 is wx here --> w0 could be replaced by wx */
+        const float_T w0 = float_T(par.w_x_SI / UNIT_LENGTH);
+        const float_T rho0 = float_T(PI*w0*w0 / lambda0);
+        /* wy is width of TWTS pulse */
+        const float_T wy = float_T(par.w_y_SI / UNIT_LENGTH);
+        const float_T k = float_T(2.0*PI / lambda0);
+        /* If phi < 0 the entire pulse is rotated by 180 deg around the
+         * z-axis of the coordinate system without also changing
+         * the orientation of the resulting field vectors.
+         */
+        const float_T x = float_T(par.phiPositive * pos.x() / UNIT_LENGTH);
+        const float_T y = float_T(par.phiPositive * pos.y() / UNIT_LENGTH);
+        const float_T z = float_T(pos.z() / UNIT_LENGTH);
+        const float_T t = float_T(time / UNIT_TIME);
+
+        /* Shortcuts for speeding up the field calculation. */
+        const float_T sinPhi = math::sin(phiT);
+        const float_T cosPhi = math::cos(phiT);
+        const float_T sinPhi2 = math::sin(phiT / float_T(2.0));
+        const float_T cosPhi2 = math::cos(phiT / float_T(2.0));
+        const float_T tanPhi2 = math::tan(phiT / float_T(2.0));
+
+        /* The "helpVar" variables decrease the nesting level of the evaluated expressions and
+         * thus help with formal code verification through manual code inspection.
+         */
+        const complex_T helpVar1 =
+            complex_T(0,-1)*cspeed*om0*tauG*tauG
+            - y*cosPhi / cosPhi2 / cosPhi2 * tanPhi2
+            - float_T(2.0)*z*tanPhi2*tanPhi2;
+        const complex_T helpVar2 = complex_T(0,1)*rho0 - y*cosPhi - z*sinPhi;
+
+        const complex_T helpVar3 = (
+            - cspeed*cspeed*k*om0*tauG*tauG*wy*wy*x*x
+            - float_T(2.0)*cspeed*cspeed*om0*t*t*wy*wy*rho0
+            + complex_T(0,2)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*rho0
+            - float_T(2.0)*cspeed*cspeed*om0*tauG*tauG*y*y*rho0
+            + float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0
+            - complex_T(0,2)*cspeed*om0*om0*tauG*tauG*wy*wy*z*rho0
+            - float_T(2.0)*om0*wy*wy*z*z*rho0
+            - complex_T(0,8)*om0*wy*wy*y*(cspeed*t - z)*z*sinPhi2*sinPhi2
+            + complex_T(0,8) / sinPhi *(
+                float_T(2.0)*z*z*(cspeed*om0*t*wy*wy + complex_T(0,1)*cspeed*y*y - om0*wy*wy*z)
+                + y*(
+                    cspeed*k*wy*wy*x*x
+                    - complex_T(0,2)*cspeed*om0*t*wy*wy*rho0
+                    + float_T(2.0)*cspeed*y*y*rho0
+                    + complex_T(0,2)*om0*wy*wy*z*rho0
+                )*math::tan(float_T(PI) / float_T(2.0)-phiT) / sinPhi
+            )*sinPhi2*sinPhi2*sinPhi2*sinPhi2
+            - complex_T(0,2)*cspeed*cspeed*om0*t*t*wy*wy*z*sinPhi
+            - float_T(2.0)*cspeed*cspeed*om0*om0*t*tauG*tauG*wy*wy*z*sinPhi
+            - complex_T(0,2)*cspeed*cspeed*om0*tauG*tauG*y*y*z*sinPhi
+            + complex_T(0,4)*cspeed*om0*t*wy*wy*z*z*sinPhi
+            + float_T(2.0)*cspeed*om0*om0*tauG*tauG*wy*wy*z*z*sinPhi
+            - complex_T(0,2)*om0*wy*wy*z*z*z*sinPhi
+            - float_T(4.0)*cspeed*om0*t*wy*wy*y*rho0*tanPhi2
+            + float_T(4.0)*om0*wy*wy*y*z*rho0*tanPhi2
+            + complex_T(0,2)*y*y*(
+                cspeed*om0*t*wy*wy
+                + complex_T(0,1)*cspeed*y*y
+                - om0*wy*wy*z
+            )*cosPhi*cosPhi / cosPhi2 / cosPhi2 * tanPhi2
+            + complex_T(0,2)*cspeed*k*wy*wy*x*x*z*tanPhi2*tanPhi2
+            - float_T(2.0)*om0*wy*wy*y*y*rho0*tanPhi2*tanPhi2
+            + float_T(4.0)*cspeed*om0*t*wy*wy*z*rho0*tanPhi2*tanPhi2
+            + complex_T(0,4)*cspeed*y*y*z*rho0*tanPhi2*tanPhi2
+            - float_T(4.0)*om0*wy*wy*z*z*rho0*tanPhi2*tanPhi2
+            - complex_T(0,2)*om0*wy*wy*y*y*z*sinPhi*tanPhi2*tanPhi2
+            - float_T(2.0)*y*cosPhi*(
+                om0*(
+                    cspeed*cspeed*(complex_T(0,1)*t*t*wy*wy
+                    + om0*t*tauG*tauG*wy*wy
+                    + complex_T(0,1)*tauG*tauG*y*y)
+                    - cspeed*(complex_T(0,2)*t + om0*tauG*tauG)*wy*wy*z
+                    + complex_T(0,1)*wy*wy*z*z
+                )
+                + complex_T(0,2)*om0*wy*wy*y*(cspeed*t - z)*tanPhi2
+                + complex_T(0,1)*(
+                    complex_T(0,-4)*cspeed*y*y*z
+                    + om0*wy*wy*(y*y - float_T(4.0)*(cspeed*t - z)*z)
+                )*tanPhi2*tanPhi2
+            )
+        /* The "round-trip" conversion in the line below fixes a gross accuracy bug
+         * in floating-point arithmetics, when float_T is set to float_X.
+         */
+        ) * complex_T( float_64(1.0) / complex_64(float_T(2.0)*cspeed*wy*wy*helpVar2*helpVar1) );
+
+        const complex_T helpVar4 = (
+            cspeed*om0*(
+                cspeed*om0*tauG*tauG
+                - complex_T(0,8)*y*math::tan( float_T(PI) / float_T(2.0) - phiT )
+                    / sinPhi / sinPhi * sinPhi2*sinPhi2*sinPhi2*sinPhi2
+                - complex_T(0,2)*z*tanPhi2*tanPhi2
+            )
+        ) / rho0;
+
+        exponent = helpVar3;
+        prefactor = float_T(-1.0)*(
+            cspeed*k*tauG*x*math::pow( helpVar2, float_T(-1.5) )
+            / math::sqrt(helpVar4)
+        );
+    }
+
+} /* namespace detail */
+} /* namespace twts */
+} /* namespace templates */
+} /* namespace picongpu */
@@ -0,0 +1,113 @@
+/* Copyright 2014-2017 Alexander Debus, Axel Huebl,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "simulation_defines.hpp"
+
+#include "math/Complex.hpp"
+#include "dimensions/DataSpace.hpp"
+#include "memory/boxes/DataBox.hpp"
+#include "memory/boxes/PitchedBox.hpp"
+
+#include "fields/background/templates/TWTS/TimeCoefficients.hpp"
+
+namespace picongpu
+{
+namespace templates
+{
+namespace twts
+{
+
+    /** Evaluation of the TWTS field functions
+     *
+     * CALCULATE:     evaluate the full field functions for each cell and time step
+     * TABLE:         3D only, the time independent factors of the field functions are
+     *                calculated once per rank for the local (y,z)-plane, each evaluation
+     *                needs one complex exponential in float_64
+     * TABLE_FLOAT32: as TABLE, but evaluated in float_32; the tables are moved to the
+     *                current time every detail::SpatialTable::recenterInterval steps
+     *                to keep the phase accurate (see detail::TimeCoefficients)
+     */
+    enum EvaluationType
+    {
+        CALCULATE = 0u,
+        TABLE = 1u,
+        TABLE_FLOAT32 = 2u
+    };
+
+/** Auxiliary functions for calculating the TWTS field */
+namespace detail
+{
+    typedef DataBox<PitchedBox<TimeCoefficients<float_64>, DIM3> > TableBox64;
+    typedef DataBox<PitchedBox<TimeCoefficients<float_32>, DIM3> > TableBox32;
+
+    /** Plane of the tables in the simulation volume
+     *
+     * The tables hold the (y,z)-plane of a 3D simulation, the x-dependence is separable.
+     * In 2D all simulation coordinates enter the field functions, no tables are used.
+     */
+    template<unsigned T_dim>
+    struct TablePlane;
+
+    template<>
+    struct TablePlane<DIM3>
+    {
+        static constexpr bool available = true;
+
+        /** index in the plane of a cell */
+        HDINLINE static DataSpace<DIM2>
+        getPlaneIdx( const DataSpace<DIM3>& cellIdx )
+        {
+            return DataSpace<DIM2>( cellIdx.y(), cellIdx.z() );
+        }
+
+        /** cell with x = 0 of an index in the plane */
+        HDINLINE static DataSpace<DIM3>
+        getCellIdx( const DataSpace<DIM2>& planeIdx )
+        {
+            return DataSpace<DIM3>( 0, planeIdx.x(), planeIdx.y() );
+        }
+    };
+
+    template<>
+    struct TablePlane<DIM2>
+    {
+        static constexpr bool available = false;
+
+        HDINLINE static DataSpace<DIM2>
+        getPlaneIdx( const DataSpace<DIM2>& cellIdx )
+        {
+            return cellIdx;
+        }
+
+        HDINLINE static DataSpace<DIM2>
+        getCellIdx( const DataSpace<DIM2>& planeIdx )
+        {
+            return planeIdx;
+        }
+    };
+
+} /* namespace detail */
+} /* namespace twts */
+} /* namespace templates */
+} /* namespace picongpu */
@@ -0,0 +1,290 @@
+/* Copyright 2014-2017 Alexander Debus, Axel Huebl,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "simulation_defines.hpp"
+
+#include "math/Vector.hpp"
+#include "math/Complex.hpp"
+#include "dimensions/DataSpace.hpp"
+#include "memory/buffers/GridBuffer.hpp"
+#include "mappings/simulation/SubGrid.hpp"
+#include "simulationControl/MovingWindow.hpp"
+#include "simulationControl/TimeInterval.hpp"
+#include "debug/PIConGPUVerbose.hpp"
+
+#include "fields/background/templates/TWTS/numComponents.hpp"
+#include "fields/background/templates/TWTS/getFieldPositions_SI.tpp"
+#include "fields/background/templates/TWTS/SpatialTable.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace picongpu
+{
+namespace templates
+{
+namespace twts
+{
+/** Auxiliary functions for calculating the TWTS field */
+namespace detail
+{
+    /** Tables of the TimeCoefficients of the TWTS field functions (3D only)
+     *
+     * The tables hold one entry per cell of the local (y,z)-plane (including the
+     * guard) and per slot (field function and intra-cell position of a field
+     * component). The coefficients are calculated once on host in float_64,
+     * again only if the parameters of the field or the local domain (moving
+     * window) change. The float_32 tables are derived from them by moving the
+     * reference time to the current time step.
+     *
+     * The accuracy and the host time per evaluation of the tables compared to
+     * the direct calculation are measured by src/tools/twtsTableBench.
+     *
+     * \tparam T_Field EField or BField, provides numTableSlots, getTableName(),
+     *         isTableSlotUsed(slot) and calcTableTerms<T_Float>(slot, pos, time,
+     *         prefactor, exponent)
+     */
+    template<typename T_Field>
+    class SpatialTable
+    {
+    public:
+        typedef TimeCoefficients<float_64> Coefficients64;
+        typedef TimeCoefficients<float_32> Coefficients32;
+        typedef PMacc::math::Complex<float_64> complex_64;
+        typedef PMacc::math::Complex<float_32> complex_32;
+        typedef GridBuffer<Coefficients64, DIM3> Buffer64;
+        typedef GridBuffer<Coefficients32, DIM3> Buffer32;
+        typedef PMacc::math::Vector<floatD_X, numComponents> FieldOnGridPositions;
+
+        /* steps after which the reference time of the float_32 tables is moved */
+        static constexpr uint32_t recenterInterval = 64u;
+
+        static SpatialTable& getInstance()
+        {
+            static SpatialTable instance;
+            return instance;
+        }
+
+        /** prepare the tables for a time step
+         *
+         * \param field TWTS field
+         * \param fieldOnGridPositions intra-cell positions of the field components
+         * \param currentStep current time step
+         * \param useFloat32 update the float_32 tables
+         */
+        HINLINE void
+        update( const T_Field& field,
+                const FieldOnGridPositions& fieldOnGridPositions,
+                const uint32_t currentStep,
+                const bool useFloat32 )
+        {
+            const float_64 time = float_64( currentStep ) - field.tdelay / SI::DELTA_T_SI;
+            const float_64 newKey[numKeys] = {
+                field.focus_y_SI, field.wavelength_SI, field.pulselength_SI,
+                field.w_x_SI, field.w_y_SI, field.phi, field.beta_0, field.tdelay,
+                float_64( field.pol )
+            };
+
+            const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
+            const DataSpace<simDim> guard = SuperCellSize::toRT() * int(GUARD_SIZE);
+            DataSpace<simDim> firstCell( subGrid.getLocalDomain().offset );
+            firstCell.y() += MovingWindow::getInstance().getSlideCounter( currentStep ) *
+                subGrid.getLocalDomain().size.y();
+            firstCell -= guard;
+            const DataSpace<DIM2> newOffset = TablePlane<simDim>::getPlaneIdx( firstCell );
+            const DataSpace<DIM2> newSize = TablePlane<simDim>::getPlaneIdx(
+                subGrid.getLocalDomain().size + guard * 2 );
+
+            const bool changed = buffer64 == nullptr || newOffset != offset || newSize != size ||
+                !std::equal( newKey, newKey + numKeys, key );
+            if( changed )
+            {
+                std::copy( newKey, newKey + numKeys, key );
+                offset = newOffset;
+                size = newSize;
+                build( field, fieldOnGridPositions, time );
+                valid32 = false;
+            }
+            if( useFloat32 && ( !valid32 || std::abs( time - time32 ) >= float_64( recenterInterval ) ) )
+                recenter( time );
+        }
+
+        TableBox64 getDeviceDataBox64()
+        {
+            return buffer64->getDeviceBuffer().getDataBox();
+        }
+
+        TableBox32 getDeviceDataBox32()
+        {
+            return buffer32->getDeviceBuffer().getDataBox();
+        }
+
+        /** total cell index (y,z) of the first table entry */
+        const DataSpace<DIM2>& getOffset() const
+        {
+            return offset;
+        }
+
+        /** number of table entries in y and z */
+        const DataSpace<DIM2>& getSize() const
+        {
+            return size;
+        }
+
+        /** reference time of the float_64 tables [DELTA_T_SI] */
+        float_64 getTime64() const
+        {
+            return time64;
+        }
+
+        /** reference time of the float_32 tables [DELTA_T_SI] */
+        float_64 getTime32() const
+        {
+            return time32;
+        }
+
+    private:
+
+        static constexpr uint32_t numKeys = 9u;
+
+        SpatialTable() :
+            buffer64( nullptr ), buffer32( nullptr ), time64( 0.0 ), time32( 0.0 ),
+            valid32( false )
+        {
+            std::fill( key, key + numKeys, 0.0 );
+        }
+
+        SpatialTable( const SpatialTable& );
+
+        /** x-coordinate used to fit the x-dependence [SI] */
+        static float_64 getFitX_SI( const T_Field& field )
+        {
+            return float_64( std::max( field.halfSimSize.x(), 1 ) ) * SI::CELL_WIDTH_SI;
+        }
+
+        /** position of a field component of a cell of the plane with the TWTS x-coordinate x_SI */
+        static float3_64 getPosition( const T_Field& field,
+                                      const FieldOnGridPositions& fieldOnGridPositions,
+                                      const DataSpace<DIM2>& planeCellIdx,
+                                      const uint32_t component,
+                                      const float_64 x_SI )
+        {
+            const PMacc::math::Vector<floatD_64, numComponents> positions_SI =
+                getFieldPositions_SI( TablePlane<simDim>::getCellIdx( planeCellIdx ), field.halfSimSize,
+                                      fieldOnGridPositions, field.unit_length, field.focus_y_SI, field.phi );
+            float3_64 pos( float3_64::create( 0.0 ) );
+            for( uint32_t i = 0; i < simDim; ++i )
+                pos[i] = positions_SI[component][i];
+            pos.x() = x_SI;
+            return pos;
+        }
+
+        /** field function of a table slot in float_64 */
+        struct SlotTerms
+        {
+            const T_Field& field;
+            const uint32_t slot;
+
+            void operator()( const float3_64& pos, const float_64 time,
+                             complex_64& prefactor, complex_64& exponent ) const
+            {
+                field.template calcTableTerms<float_64>( slot, pos, time, prefactor, exponent );
+            }
+        };
+
+        HINLINE void
+        build( const T_Field& field, const FieldOnGridPositions& fieldOnGridPositions, const float_64 time )
+        {
+            const double startTime = TimeIntervall::getTime();
+            const DataSpace<DIM3> bufferSize( size.x(), size.y(), T_Field::numTableSlots );
+            if( buffer64 == nullptr || bufferSize != allocatedSize )
+            {
+                __delete( buffer64 );
+                __delete( buffer32 );
+                buffer64 = new Buffer64( bufferSize );
+                buffer32 = new Buffer32( bufferSize );
+                allocatedSize = bufferSize;
+            }
+
+            typename Buffer64::DataBoxType box = buffer64->getHostBuffer().getDataBox();
+            DataSpace<DIM2> planeIdx;
+            for( uint32_t slot = 0; slot < T_Field::numTableSlots; ++slot )
+            {
+                const uint32_t component = slot % numComponents;
+                for( planeIdx.y() = 0; planeIdx.y() < size.y(); ++planeIdx.y() )
+                    for( planeIdx.x() = 0; planeIdx.x() < size.x(); ++planeIdx.x() )
+                    {
+                        Coefficients64& c = box( DataSpace<DIM3>( planeIdx.x(), planeIdx.y(), slot ) );
+                        if( !field.isTableSlotUsed( slot ) )
+                        {
+                            c.p0 = c.p1 = c.px = complex_64::zero();
+                            c.e0 = c.e1 = c.e2 = c.es = complex_64::zero();
+                            continue;
+                        }
+                        const float3_64 pos = getPosition( field, fieldOnGridPositions,
+                                                           offset + planeIdx, component, 0.0 );
+                        c = fitTimeCoefficients( SlotTerms{ field, slot }, field.getFieldParameters(),
+                                                 pos, time, getFitX_SI( field ) );
+                    }
+            }
+            buffer64->hostToDevice();
+            time64 = time;
+
+            log<picLog::PHYSICS >( "TWTS %1%-field tables: %2% x %3% cells, %4% slots, calculated in %5%" ) %
+                T_Field::getTableName() % size.x() % size.y() % uint32_t( T_Field::numTableSlots ) %
+                TimeIntervall::printeTime( TimeIntervall::getTime() - startTime );
+        }
+
+        HINLINE void
+        recenter( const float_64 time )
+        {
+            typename Buffer64::DataBoxType box64 = buffer64->getHostBuffer().getDataBox();
+            typename Buffer32::DataBoxType box32 = buffer32->getHostBuffer().getDataBox();
+            DataSpace<DIM3> idx;
+            for( idx.z() = 0; idx.z() < allocatedSize.z(); ++idx.z() )
+                for( idx.y() = 0; idx.y() < allocatedSize.y(); ++idx.y() )
+                    for( idx.x() = 0; idx.x() < allocatedSize.x(); ++idx.x() )
+                        box32( idx ) = toFloat32( box64( idx ), time - time64 );
+            buffer32->hostToDevice();
+            time32 = time;
+            valid32 = true;
+        }
+
+        /* not freed, the tables are used until the end of the simulation */
+        Buffer64* buffer64;
+        Buffer32* buffer32;
+        DataSpace<DIM3> allocatedSize;
+        /* parameters of the field the tables are calculated for */
+        float_64 key[numKeys];
+        DataSpace<DIM2> offset;
+        DataSpace<DIM2> size;
+        float_64 time64;
+        float_64 time32;
+        bool valid32;
+    };
+
+} /* namespace detail */
+} /* namespace twts */
+} /* namespace templates */
+} /* namespace picongpu */
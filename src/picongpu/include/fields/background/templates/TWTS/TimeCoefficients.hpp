@@ -0,0 +1,151 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+
+#include "math/Complex.hpp"
+#include "fields/background/templates/TWTS/FieldTerms.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+namespace templates
+{
+namespace twts
+{
+/** Auxiliary functions for calculating the TWTS field */
+namespace detail
+{
+    /** Time and x-dependence of a TWTS field function at a fixed (y,z)-position
+     *
+     * All TWTS field functions (Ex, By, Bz_Ex, Bz_Ey) have the form Re[P * exp(E)]
+     * with a prefactor P linear in t and x and an exponent E quadratic in t which
+     * depends on x only by x^2 (x is the direction of the line focus):
+     *
+     *   P = p0 + p1 * t + px * x
+     *   E = e0 + e1 * t + e2 * t^2 + es * x^2
+     *
+     * t is the time relative to the reference time of the table [DELTA_T_SI],
+     * x the TWTS x-coordinate [SPEED_OF_LIGHT_SI * DELTA_T_SI].
+     *
+     * Error bound of the evaluation in float_32 (eps = 2^-24, Im(e0) is kept in [-PI, PI]):
+     *   absolute phase error  <= eps * ( PI + |e1| |t| + |e2| t^2 + |es| x^2 ) + O(eps^2)
+     *   relative error of the envelope and prefactor <= eps * ( 4 + |Re(E)| )
+     * With |t| <= SpatialTable::recenterInterval the time dependent part of the phase
+     * error stays below 1e-5 rad for laser periods of more than 10 time steps.
+     */
+    template<typename T_Float>
+    struct TimeCoefficients
+    {
+        typedef T_Float float_T;
+        typedef PMacc::math::Complex<float_T> complex_T;
+
+        complex_T p0;
+        complex_T p1;
+        complex_T px;
+        complex_T e0;
+        complex_T e1;
+        complex_T e2;
+        complex_T es;
+
+        /** evaluate the field function
+         *
+         * \param t time relative to the reference time of the table [DELTA_T_SI]
+         * \param x TWTS x-coordinate [SPEED_OF_LIGHT_SI * DELTA_T_SI]
+         */
+        HDINLINE float_T
+        operator()( const float_T t, const float_T x ) const
+        {
+            const complex_T exponent = e0 + ( e1 + e2 * t ) * t + es * ( x * x );
+            const complex_T prefactor = p0 + p1 * t + px * x;
+            return ( math::exp( exponent ) * prefactor ).get_real();
+        }
+    };
+
+    /** fit the coefficients of a field function
+     *
+     * P is linear and E quadratic in t, the differences are exact up to rounding.
+     *
+     * \tparam T_Terms functor terms( pos, time, prefactor, exponent ) calculating
+     *         the field function in float_64, e.g. calcTWTSExTerms
+     * \param par parameters of the TWTS field
+     * \param pos position of the field component with the TWTS x-coordinate 0 [m]
+     * \param time reference time of the coefficients [DELTA_T_SI]
+     * \param fitX_SI x-coordinate used to fit the x-dependence [m]
+     */
+    template<typename T_Terms>
+    HINLINE TimeCoefficients<float_64>
+    fitTimeCoefficients( const T_Terms& terms, const FieldParameters& par,
+                         const float3_64& pos, const float_64 time, const float_64 fitX_SI )
+    {
+        typedef PMacc::math::Complex<float_64> complex_64;
+
+        /* time difference of the fit [DELTA_T_SI]: the pulse length */
+        const float_64 dt = std::max( par.pulselength_SI * 2.0 / par.deltaT_SI, 1.0 );
+        float3_64 posX( pos );
+        posX.x() = fitX_SI;
+        const float_64 x = fitX_SI / ( par.speedOfLight_SI * par.deltaT_SI );
+
+        complex_64 p[3], e[3], pX, eX;
+        for( int i = 0; i < 3; ++i )
+            terms( pos, ( time + float_64( i - 1 ) * dt ) * par.deltaT_SI, p[i], e[i] );
+        terms( posX, time * par.deltaT_SI, pX, eX );
+
+        TimeCoefficients<float_64> c;
+        c.p0 = p[1];
+        c.p1 = ( p[2] - p[1] ) / dt;
+        c.px = ( pX - p[1] ) / x;
+        /* only the phase modulo 2 PI matters */
+        c.e0 = complex_64( e[1].get_real(), std::remainder( e[1].get_imag(), 2.0 * PI ) );
+        c.e1 = ( e[2] - e[0] ) / ( float_64( 2.0 ) * dt );
+        c.e2 = ( e[2] + e[0] - float_64( 2.0 ) * e[1] ) / ( float_64( 2.0 ) * dt * dt );
+        c.es = ( eX - e[1] ) / ( x * x );
+        return c;
+    }
+
+    /** coefficients with the reference time moved by dt [DELTA_T_SI] and converted to float_32 */
+    HINLINE TimeCoefficients<float_32>
+    toFloat32( const TimeCoefficients<float_64>& c, const float_64 dt )
+    {
+        typedef PMacc::math::Complex<float_64> complex_64;
+        typedef PMacc::math::Complex<float_32> complex_32;
+
+        const complex_64 e0 = c.e0 + ( c.e1 + c.e2 * dt ) * dt;
+        TimeCoefficients<float_32> r;
+        r.p0 = complex_32( c.p0 + c.p1 * dt );
+        r.p1 = complex_32( c.p1 );
+        r.px = complex_32( c.px );
+        r.e0 = complex_32( complex_64( e0.get_real(), std::remainder( e0.get_imag(), 2.0 * PI ) ) );
+        r.e1 = complex_32( c.e1 + float_64( 2.0 ) * dt * c.e2 );
+        r.e2 = complex_32( c.e2 );
+        r.es = complex_32( c.es );
+        return r;
+    }
+
+} /* namespace detail */
+} /* namespace twts */
+} /* namespace templates */
+} /* namespace picongpu */
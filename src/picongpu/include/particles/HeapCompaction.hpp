@@ -0,0 +1,169 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulation_defines.hpp"
+#include "particles/ParticlesFunctors.hpp"
+
+#include "memory/buffers/GridBuffer.hpp"
+#include "algorithms/ForEach.hpp"
+#include "pmacc_types.hpp"
+
+#include <memory>
+#include <string>
+
+namespace picongpu
+{
+namespace particles
+{
+using namespace PMacc;
+
+/** compaction of the particle frame heap
+ *
+ * The frames of all species are counted per page of the mallocMC heap.
+ * Frames located in pages which are filled less than a threshold are moved
+ * to pages which are used densely, so that frames which are freed after
+ * outflow, ionization or a slide of the moving window do not keep many
+ * pages partly used.
+ *
+ * The usage of the heap is logged before and after the compaction
+ * (picLog::MEMORY), the number of pages in use is the amount of device
+ * memory the particles need on this device.
+ *
+ * mallocMC decides where a frame is placed, the compaction can only reject
+ * frames in sparse pages (see KernelRelocateFrames).
+ */
+class HeapCompaction
+{
+public:
+
+    typedef GridBuffer<uint32_t, DIM1> PageBuffer;
+    typedef GridBuffer<uint64_cu, DIM1> CounterBuffer;
+
+    enum
+    {
+        /* size of a heap page in byte, see mallocMC.param */
+        pageSize = DeviceHeapConfig::pagesize::value
+    };
+
+    /** constructor
+     *
+     * @param deviceHeap heap of all species
+     * @param minOccupancy pages filled less than minOccupancy percent are
+     *                     evacuated, 0 logs the statistics only
+     */
+    HeapCompaction(const std::shared_ptr<DeviceHeap>& deviceHeap, const uint32_t minOccupancy) :
+        deviceHeap(deviceHeap),
+        pageBytes(nullptr),
+        counters(nullptr),
+        minPageBytes(static_cast<uint32_t>(uint64_t(pageSize) * minOccupancy / 100u))
+    {
+        /* currently mallocMC has only one heap */
+        mallocMC::HeapInfo heapInfo = deviceHeap->getHeapLocations()[0];
+        heapBase = static_cast<const char*>(heapInfo.p);
+        numPages = (heapInfo.size + pageSize - 1) / pageSize;
+
+        pageBytes = new PageBuffer(DataSpace<DIM1>(numPages));
+        counters = new CounterBuffer(DataSpace<DIM1>(2));
+    }
+
+    virtual ~HeapCompaction()
+    {
+        __delete(pageBytes);
+        __delete(counters);
+    }
+
+    /** log the usage of the heap and compact it
+     *
+     * must be called between two time steps, all particles must be in
+     * the CORE and BORDER
+     */
+    void operator()(const uint32_t currentStep)
+    {
+        countPages(currentStep, "before compaction");
+
+        if (minPageBytes == 0)
+            return;
+
+        counters->getDeviceBuffer().setValue(0);
+        ForEach< VectorAllSpecies, CallRelocateFrames<bmpl::_1> > relocateFrames;
+        relocateFrames(
+            pageBytes->getDeviceBuffer().getDataBox(),
+            counters->getDeviceBuffer().getDataBox(),
+            heapBase,
+            uint32_t(pageSize),
+            minPageBytes
+        );
+        counters->deviceToHost();
+        log<picLog::MEMORY >("heap step %1%: %2% frames relocated") %
+            currentStep % counters->getHostBuffer().getDataBox()[0];
+
+        countPages(currentStep, "after compaction");
+    }
+
+private:
+
+    void countPages(const uint32_t currentStep, const std::string& state)
+    {
+        pageBytes->getDeviceBuffer().setValue(0);
+        ForEach< VectorAllSpecies, CallCountHeapPages<bmpl::_1> > countHeapPages;
+        countHeapPages(
+            deviceHeap,
+            pageBytes->getDeviceBuffer().getDataBox(),
+            counters,
+            heapBase,
+            uint32_t(pageSize)
+        );
+        pageBytes->deviceToHost();
+
+        const uint32_t* hostPageBytes = pageBytes->getHostBuffer().getBasePointer();
+        uint64_t usedPages = 0;
+        uint64_t sparsePages = 0;
+        uint64_t frameBytes = 0;
+        for (uint32_t page = 0; page < numPages; ++page)
+        {
+            if (hostPageBytes[page] == 0)
+                continue;
+            ++usedPages;
+            frameBytes += hostPageBytes[page];
+            if (hostPageBytes[page] < minPageBytes)
+                ++sparsePages;
+        }
+
+        log<picLog::MEMORY >("heap step %1% %2%: %3% of %4% pages used (%5% MiB), "
+                             "%6% MiB frames, %7%%% page occupancy, %8% sparse pages") %
+            currentStep % state %
+            usedPages % numPages %
+            (usedPages * uint64_t(pageSize) / 1024 / 1024) %
+            (frameBytes / 1024 / 1024) %
+            (usedPages == 0 ? 0. : 100. * frameBytes / (usedPages * uint64_t(pageSize))) %
+            sparsePages;
+    }
+
+    std::shared_ptr<DeviceHeap> deviceHeap;
+    PageBuffer* pageBytes;
+    CounterBuffer* counters;
+    const char* heapBase;
+    uint32_t numPages;
+    uint32_t minPageBytes;
+};
+
+} //namespace particles
+} //namespace picongpu
@@ -1,4 +1,4 @@
-/* Copyright 2014-2017 Rene Widera
+/* Copyright 2014-2017 Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -71,5 +71,47 @@ namespace particles
         }
     };
 
+    /** run a user defined functor for every supercell
+     *
+     * - constructor with current time step is called for the functor on the host side
+     * - the functor is called by all threads of a block with
+     *   `(particlesBox, superCellIdx, linearThreadIdx)` and may add or remove
+     *   particles of the supercell
+     * - `fillAllGaps()` is called afterwards
+     *
+     * @tparam T_Functor unary lambda functor
+     * @tparam T_SpeciesType type of the used species
+     */
+    template<
+        typename T_Functor,
+        typename T_SpeciesType = bmpl::_1
+    >
+    struct ManipulateSuperCells
+    {
+        using SpeciesType = T_SpeciesType;
+        using FrameType = typename SpeciesType::FrameType;
+
+        using Functor = typename bmpl::apply1<
+            T_Functor,
+            SpeciesType
+        >::type;
+
+        HINLINE void
+        operator()( const uint32_t currentStep )
+        {
+            DataConnector &dc = Environment<>::get().DataConnector();
+            auto speciesPtr = dc.get< SpeciesType >( FrameType::getName(), true );
+
+            Functor functor( currentStep );
+            speciesPtr->manipulateAllSuperCells(
+                currentStep,
+                functor
+            );
+            speciesPtr->fillAllGaps();
+
+            dc.releaseData( FrameType::getName() );
+        }
+    };
+
 } //namespace particles
 } //namespace picongpu
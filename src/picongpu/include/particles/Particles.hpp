@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Felix Schmitt,
- *                     Marco Garten, Alexander Grund
+ *                     Marco Garten, Alexander Grund, agent
  *
  * This file is part of PIConGPU.
  *
@@ -32,6 +32,7 @@
 
 #include "memory/dataTypes/Mask.hpp"
 #include "mappings/simulation/GridController.hpp"
+#include "mappings/kernel/RangeMapping.hpp"
 #include "dataManagement/ISimulationData.hpp"
 
 #include <string>
@@ -86,6 +87,47 @@ public:
 
     void update(uint32_t currentStep);
 
+    /** sort the particles by cell index every period-th step in update()
+     *
+     * @param period 0 disables the sorting
+     */
+    void setSortPeriod(uint32_t period)
+    {
+        sortPeriod = period;
+    }
+
+    /** restrict the particle creation and manipulation to a box of supercells
+     *
+     * initDensityProfile(), deviceDeriveFrom(), manipulateAllParticles(),
+     * manipulateAllSuperCells() and fillAllGaps() only visit the supercells
+     * of the box.
+     *
+     * @param offset first supercell of the box relative to the CORE+BORDER origin
+     * @param size number of supercells of the box
+     */
+    void setActiveSuperCells(const DataSpace<simDim>& offset, const DataSpace<simDim>& size)
+    {
+        activeOffset = offset;
+        activeSize = size;
+    }
+
+    /** reset the active box to all supercells in CORE+BORDER */
+    void resetActiveSuperCells()
+    {
+        activeOffset = DataSpace<simDim>::create(0);
+        activeSize = this->cellDescription.getGridSuperCells() -
+            2 * this->cellDescription.getGuardingSuperCells();
+    }
+
+    /** fill the gaps of the active supercells (see setActiveSuperCells())
+     *
+     * if all supercells are active the GUARD is included
+     */
+    void fillAllGaps();
+
+    /** delete all particles of the active supercells (see setActiveSuperCells()) */
+    void deleteActiveParticles();
+
     template<typename T_DensityFunctor, typename T_PositionFunctor>
     void initDensityProfile(T_DensityFunctor& densityFunctor, T_PositionFunctor& positionFunctor, const uint32_t currentStep);
 
@@ -107,6 +149,14 @@ public:
     template<typename T_Functor>
     void manipulateAllParticles(uint32_t currentStep, T_Functor& functor);
 
+    /** call a functor once for each active supercell (see setActiveSuperCells())
+     *
+     * the functor is called by all threads of a block with
+     * `(particlesBox, superCellIdx, linearThreadIdx)`
+     */
+    template<typename T_Functor>
+    void manipulateAllSuperCells(uint32_t currentStep, T_Functor& functor);
+
     SimulationDataId getUniqueId();
 
     /* sync device data to host
@@ -156,7 +206,27 @@ public:
     }
 
 private:
+
+    typedef RangeMapping<MappingDesc> ActiveMapping;
+
+    ActiveMapping getActiveMapping() const
+    {
+        return ActiveMapping(this->cellDescription, activeOffset, activeSize);
+    }
+
+    bool isFullyActive() const
+    {
+        return activeOffset == DataSpace<simDim>::create(0) &&
+            activeSize == this->cellDescription.getGridSuperCells() -
+                2 * this->cellDescription.getGuardingSuperCells();
+    }
+
     SimulationDataId m_datasetID;
+    uint32_t sortPeriod;
+
+    /* box of supercells visited by the creation and manipulation methods */
+    DataSpace<simDim> activeOffset;
+    DataSpace<simDim> activeSize;
 
     FieldE *fieldE;
     FieldB *fieldB;
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Richard Pausch, Felix Schmitt,
- *                     Alexander Grund
+ *                     Alexander Grund, agent
  *
  * This file is part of PIConGPU.
  *
@@ -27,9 +27,11 @@
 
 #include "dataManagement/DataConnector.hpp"
 #include "mappings/kernel/AreaMapping.hpp"
+#include "mappings/kernel/RangeMapping.hpp"
 
 #include "fields/FieldB.hpp"
 #include "fields/FieldE.hpp"
+#include "fields/background/PusherFieldBox.hpp"
 
 #include "particles/memory/buffers/ParticlesBuffer.hpp"
 #include "ParticlesInit.kernel"
@@ -76,8 +78,11 @@ Particles<
         heap,
         cellDescription
     ),
-    m_datasetID( datasetID )
+    m_datasetID( datasetID ),
+    sortPeriod( 0 )
 {
+    resetActiveSuperCells( );
+
     size_t sizeOfExchanges = 2 * 2 * ( BYTES_EXCHANGE_X + BYTES_EXCHANGE_Y + BYTES_EXCHANGE_Z ) + BYTES_EXCHANGE_X * 2 * 8;
 
     log<picLog::MEMORY > ( "size for all exchange = %1% MiB" ) % ( (float_64) sizeOfExchanges / 1024. / 1024. );
@@ -204,7 +209,7 @@ Particles<
     T_Name,
     T_Flags,
     T_Attributes
->::update(uint32_t )
+>::update(uint32_t currentStep)
 {
     typedef typename GetFlagType<FrameType,particlePusher<> >::type PusherAlias;
     typedef typename PMacc::traits::Resolve<PusherAlias>::type ParticlePush;
@@ -233,11 +238,16 @@ Particles<
     auto block = MappingDesc::SuperCellSize::toRT();
 
     AreaMapping<CORE+BORDER,MappingDesc> mapper(this->cellDescription);
+    /* background fields which are evaluated in the pusher are added while
+     * loading the field cache */
+    cellwiseOperation::PusherFieldBox< FieldBackgroundE > pusherFieldE;
+    cellwiseOperation::PusherFieldBox< FieldBackgroundB > pusherFieldB;
+
     PMACC_KERNEL( KernelMoveAndMarkParticles<BlockArea>{} )
         (mapper.getGridDim(), block)
         ( this->getDeviceParticlesBox( ),
-          fieldE->getDeviceDataBox( ),
-          fieldB->getDeviceDataBox( ),
+          pusherFieldE( *fieldE, this->cellDescription, currentStep ),
+          pusherFieldB( *fieldB, this->cellDescription, currentStep ),
           FrameSolver( ),
           mapper
           );
@@ -246,6 +256,50 @@ Particles<
     dc.releaseData( FieldB::getName() );
 
     ParticlesBaseType::template shiftParticles < CORE + BORDER > ( );
+
+    /* keep the particles of a cell contiguous for the following gathers
+     * and depositions */
+    if( sortPeriod != 0 && currentStep % sortPeriod == 0 )
+        ParticlesBaseType::template sortParticles < CORE + BORDER > ( );
+}
+
+template<
+    typename T_Name,
+    typename T_Flags,
+    typename T_Attributes
+>
+void
+Particles<
+    T_Name,
+    T_Flags,
+    T_Attributes
+>::fillAllGaps( )
+{
+    if( isFullyActive( ) )
+        ParticlesBaseType::fillAllGaps( );
+    else
+    {
+        ActiveMapping mapper( getActiveMapping( ) );
+        if( !mapper.isEmpty( ) )
+            this->fillGaps( mapper );
+    }
+}
+
+template<
+    typename T_Name,
+    typename T_Flags,
+    typename T_Attributes
+>
+void
+Particles<
+    T_Name,
+    T_Flags,
+    T_Attributes
+>::deleteActiveParticles( )
+{
+    ActiveMapping mapper( getActiveMapping( ) );
+    if( !mapper.isEmpty( ) )
+        this->deleteParticles( mapper );
 }
 
 template<
@@ -273,8 +327,11 @@ Particles<
     DataSpace<simDim> totalGpuCellOffset = subGrid.getLocalDomain( ).offset;
     totalGpuCellOffset.y( ) += numSlides * localCells.y( );
 
+    ActiveMapping mapper( getActiveMapping( ) );
+    if( mapper.isEmpty( ) )
+        return;
+
     auto block = MappingDesc::SuperCellSize::toRT( );
-    AreaMapping<CORE+BORDER,MappingDesc> mapper(this->cellDescription);
     PMACC_KERNEL( KernelFillGridWithParticles< Particles >{} )
         (mapper.getGridDim(), block)
         ( densityFunctor, positionFunctor, totalGpuCellOffset, this->particlesBuffer->getDeviceParticleBox( ), mapper );
@@ -311,7 +368,10 @@ Particles<
     auto block = PMacc::math::CT::volume<SuperCellSize>::type::value;
 
     log<picLog::SIMULATION_STATE > ( "clone species %1%" ) % FrameType::getName( );
-    AreaMapping<CORE + BORDER, MappingDesc> mapper(this->cellDescription);
+    ActiveMapping mapper( getActiveMapping( ) );
+    if( mapper.isEmpty( ) )
+        return;
+
     PMACC_KERNEL( KernelDeriveParticles{} )
         (mapper.getGridDim(), block) ( this->getDeviceParticlesBox( ), src.getDeviceParticlesBox( ), functor, mapper );
     this->fillAllGaps( );
@@ -330,10 +390,11 @@ Particles<
     T_Attributes
 >::manipulateAllParticles( uint32_t currentStep, T_Functor& functor )
 {
+    ActiveMapping mapper( getActiveMapping( ) );
+    if( mapper.isEmpty( ) )
+        return;
 
     auto block = MappingDesc::SuperCellSize::toRT( );
-
-    AreaMapping<CORE + BORDER, MappingDesc> mapper(this->cellDescription);
     PMACC_KERNEL( KernelManipulateAllParticles{} )
         (mapper.getGridDim(), block)
         ( this->particlesBuffer->getDeviceParticleBox( ),
@@ -342,4 +403,29 @@ Particles<
         );
 }
 
+template<
+    typename T_Name,
+    typename T_Flags,
+    typename T_Attributes
+>
+template< typename T_Functor>
+void
+Particles<
+    T_Name,
+    T_Flags,
+    T_Attributes
+>::manipulateAllSuperCells( uint32_t, T_Functor& functor )
+{
+    ActiveMapping mapper( getActiveMapping( ) );
+    if( mapper.isEmpty( ) )
+        return;
+
+    PMACC_KERNEL( KernelManipulateAllSuperCells{} )
+        (mapper.getGridDim(), (int)ParticlesBaseType::TileSize)
+        ( this->particlesBuffer->getDeviceParticleBox( ),
+          functor,
+          mapper
+        );
+}
+
 } // end namespace
@@ -1,5 +1,5 @@
 /* Copyright 2014-2017 Rene Widera, Marco Garten, Alexander Grund,
- *                     Heiko Burau, Axel Huebl
+ *                     Heiko Burau, Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -143,6 +143,144 @@ struct CallReset
     }
 };
 
+template<typename T_SpeciesType>
+struct CallSetSortPeriod
+{
+    using SpeciesType = T_SpeciesType;
+    using FrameType = typename SpeciesType::FrameType;
+
+    HINLINE void operator()( const uint32_t period ) const
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto species = dc.get< SpeciesType >( FrameType::getName(), true );
+        species->setSortPeriod( period );
+        dc.releaseData( FrameType::getName() );
+    }
+};
+
+/** restrict the creation and manipulation of a species to a box of supercells
+ *
+ * see Particles::setActiveSuperCells(), without arguments all supercells of
+ * CORE+BORDER become active again
+ */
+template<typename T_SpeciesType>
+struct CallSetActiveSuperCells
+{
+    using SpeciesType = T_SpeciesType;
+    using FrameType = typename SpeciesType::FrameType;
+
+    HINLINE void operator()(
+        const DataSpace<simDim>& offset,
+        const DataSpace<simDim>& size
+    ) const
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto species = dc.get< SpeciesType >( FrameType::getName(), true );
+        species->setActiveSuperCells( offset, size );
+        dc.releaseData( FrameType::getName() );
+    }
+
+    HINLINE void operator()() const
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto species = dc.get< SpeciesType >( FrameType::getName(), true );
+        species->resetActiveSuperCells( );
+        dc.releaseData( FrameType::getName() );
+    }
+};
+
+/** delete the particles of a species in its active supercells
+ *
+ * see Particles::deleteActiveParticles()
+ */
+template<typename T_SpeciesType>
+struct CallDeleteActiveParticles
+{
+    using SpeciesType = T_SpeciesType;
+    using FrameType = typename SpeciesType::FrameType;
+
+    HINLINE void operator()() const
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto species = dc.get< SpeciesType >( FrameType::getName(), true );
+        species->deleteActiveParticles( );
+        dc.releaseData( FrameType::getName() );
+    }
+};
+
+/** count the frames of a species per heap page
+ *
+ * logs the number of frames, the fraction of used particle slots and the
+ * free slots of the heap for the frame size of the species
+ */
+template<typename T_SpeciesType>
+struct CallCountHeapPages
+{
+    using SpeciesType = T_SpeciesType;
+    using FrameType = typename SpeciesType::FrameType;
+
+    template<typename T_DeviceHeap, typename T_PageBox, typename T_CounterBuffer>
+    HINLINE void operator()(
+        const std::shared_ptr<T_DeviceHeap>& deviceHeap,
+        const T_PageBox pageBytes,
+        T_CounterBuffer* counters,
+        const char* heapBase,
+        const uint32_t pageSize
+    ) const
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto species = dc.get< SpeciesType >( FrameType::getName(), true );
+        counters->getDeviceBuffer().setValue( 0 );
+        species->template countHeapPages< CORE + BORDER >(
+            pageBytes,
+            counters->getDeviceBuffer().getDataBox(),
+            heapBase,
+            pageSize
+        );
+        dc.releaseData( FrameType::getName() );
+        counters->deviceToHost();
+
+        const uint64_t numFrames = counters->getHostBuffer().getDataBox()[0];
+        const uint64_t numParticles = counters->getHostBuffer().getDataBox()[1];
+        const uint64_t numSlots = numFrames * SpeciesType::TileSize;
+        log<picLog::MEMORY >("heap: species %1%: %2% frames (%3% MiB), %4%%% of the particle slots used, %5% free slots") %
+            FrameType::getName() %
+            numFrames %
+            (numFrames * sizeof (FrameType) / 1024 / 1024) %
+            (numSlots == 0 ? 0. : 100. * numParticles / numSlots) %
+            deviceHeap->getAvailableSlots(sizeof (FrameType));
+    }
+};
+
+/** move the frames of a species out of sparsely used heap pages */
+template<typename T_SpeciesType>
+struct CallRelocateFrames
+{
+    using SpeciesType = T_SpeciesType;
+    using FrameType = typename SpeciesType::FrameType;
+
+    template<typename T_PageBox, typename T_CounterBox>
+    HINLINE void operator()(
+        const T_PageBox pageBytes,
+        const T_CounterBox counters,
+        const char* heapBase,
+        const uint32_t pageSize,
+        const uint32_t minPageBytes
+    ) const
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto species = dc.get< SpeciesType >( FrameType::getName(), true );
+        species->template relocateFrames< CORE + BORDER >(
+            pageBytes,
+            counters,
+            heapBase,
+            pageSize,
+            minPageBytes
+        );
+        dc.releaseData( FrameType::getName() );
+    }
+};
+
 /** push a species
  *
  * push is only triggered for species with a pusher
@@ -240,9 +378,13 @@ struct PushAllSpecies
             pushEvent += *iter;
         }
 
-        /* call communication for all species */
-        ForEach< VectorSpeciesWithPusher, particles::CommunicateSpecies< bmpl::_1> > communicateSpecies;
-        communicateSpecies( forward(updateEventList), forward(commEventList) );
+        /* call communication for all species, the exchanges of all species
+         * into one direction are sent with one message (if enabled) */
+        {
+            MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), SPECIES_ALL);
+            ForEach< VectorSpeciesWithPusher, particles::CommunicateSpecies< bmpl::_1> > communicateSpecies;
+            communicateSpecies( forward(updateEventList), forward(commEventList) );
+        }
 
         /* join all communication events */
         for (typename EventList::iterator iter = commEventList.begin();
@@ -0,0 +1,96 @@
+/* Copyright 2013-2017 Felix Schmitt, Rene Widera, agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulation_defines.hpp"
+
+#include <string>
+#include <vector>
+
+
+namespace picongpu
+{
+namespace densityProfiles
+{
+
+/** bookkeeping for density profiles loaded from a file
+ *
+ * FromHDF5Impl loads the density into the first FieldTmp slot.
+ * All species which use the same file (and the same step) can use the
+ * data already stored on the device instead of reading the file again.
+ *
+ * The content of FieldTmp is only valid during one pass of the
+ * particle init pipeline, therefore the simulation must call
+ * invalidate() before the pipeline is executed.
+ */
+class FromHDF5Cache
+{
+public:
+
+    static FromHDF5Cache& getInstance()
+    {
+        static FromHDF5Cache instance;
+        return instance;
+    }
+
+    /** check if the density described by key is stored in FieldTmp
+     *
+     * @param key unique description of file, dataset and step
+     */
+    bool isLoaded(const std::string& key) const
+    {
+        return valid && key == loadedKey;
+    }
+
+    /** mark the density described by key as stored in FieldTmp */
+    void setLoaded(const std::string& key)
+    {
+        loadedKey = key;
+        valid = true;
+    }
+
+    /** forget the loaded density (FieldTmp is used by someone else) */
+    void invalidate()
+    {
+        loadedKey.clear();
+        valid = false;
+    }
+
+    /** host buffer for reading the file, reused by all loads */
+    std::vector<float_X>& getReadBuffer()
+    {
+        return readBuffer;
+    }
+
+private:
+
+    FromHDF5Cache() : valid(false)
+    {
+    }
+
+    FromHDF5Cache(const FromHDF5Cache&);
+
+    std::string loadedKey;
+    bool valid;
+    std::vector<float_X> readBuffer;
+};
+
+} //namespace densityProfiles
+} //namespace picongpu
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Felix Schmitt, Rene Widera
+/* Copyright 2013-2017 Felix Schmitt, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -27,9 +27,15 @@
 #include "memory/buffers/GridBuffer.hpp"
 #include "memory/boxes/DataBoxDim1Access.hpp"
 #include "dataManagement/DataConnector.hpp"
+#include "particles/densityProfiles/FromHDF5Cache.hpp"
 
 #include <splash/splash.h>
 
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
 
 namespace picongpu
 {
@@ -51,7 +57,7 @@ struct FromHDF5Impl : public T_ParamClass
     {
         const uint32_t numSlides = MovingWindow::getInstance( ).getSlideCounter( currentStep );
         auto window = MovingWindow::getInstance().getWindow(currentStep);
-        loadHDF5(window);
+        loadHDF5(window, currentStep);
         const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
         DataSpace<simDim> localCells = subGrid.getLocalDomain( ).size;
         totalGpuOffset = subGrid.getLocalDomain( ).offset;
@@ -70,7 +76,17 @@ struct FromHDF5Impl : public T_ParamClass
 
 private:
 
-    void loadHDF5(Window &window)
+    typedef typename FieldTmp::ValueType::type ValueType;
+
+    /** load the density into the first slot of FieldTmp
+     *
+     * Each rank reads the hyperslab which overlaps with its local domain on
+     * its own (MPI_COMM_SELF), the load is also called from MySimulation::slide()
+     * where only the ranks of the new row take part.
+     * If another species already loaded the same density in this pass of the
+     * init pipeline the data in FieldTmp is reused and nothing is read.
+     */
+    void loadHDF5(Window &window, uint32_t currentStep)
     {
         using namespace splash;
         DataConnector &dc = Environment<>::get().DataConnector();
@@ -84,9 +100,24 @@ private:
 
         deviceDataBox = fieldBuffer.getDeviceBuffer().getDataBox();
 
+        std::stringstream cacheKey;
+        cacheKey << ParamClass::filename << ":" << ParamClass::datasetName << ":"
+            << ParamClass::iteration << ":" << ParamClass::defaultDensity << ":"
+            << ParamClass::resample << ":" << currentStep;
+
+        FromHDF5Cache& cache = FromHDF5Cache::getInstance();
+        if (cache.isLoaded(cacheKey.str()))
+        {
+            log<picLog::INPUT_OUTPUT > ("reuse density '%1%' from file '%2%'") %
+                ParamClass::datasetName % ParamClass::filename;
+            return;
+        }
+        /* FieldTmp is overwritten now */
+        cache.invalidate();
+
         GridController<simDim> &gc = Environment<simDim>::get().GridController();
         const PMacc::Selection<simDim>& localDomain = Environment<simDim>::get().SubGrid().getLocalDomain();
-        const uint32_t numSlides = MovingWindow::getInstance().getSlideCounter(0);
+        const uint32_t numSlides = MovingWindow::getInstance().getSlideCounter(currentStep);
         const uint32_t maxOpenFilesPerNode = 1;
 
         /* get a new ParallelDomainCollector for our MPI rank only*/
@@ -109,131 +140,278 @@ private:
             DataSpace<simDim> globalSlideOffset;
             globalSlideOffset.y() = numSlides * localDomain.size.y();
 
-            Dimensions domainOffset(0, 0, 0);
-            for (uint32_t d = 0; d < simDim; ++d)
-                domainOffset[d] = localDomain.offset[d] + globalSlideOffset[d];
-
-            if (gc.getPosition().y() == 0)
-                domainOffset[1] += window.globalDimensions.offset.y();
-
-            DataSpace<simDim> localDomainSize = localDomain.size;
-            Dimensions domainSize(1, 1, 1);
-            for (uint32_t d = 0; d < simDim; ++d)
-                domainSize[d] = localDomainSize[d];
-
             /* clear host buffer with default value */
             fieldBuffer.getHostBuffer().setValue(float1_X(ParamClass::defaultDensity));
 
-            /* get dimensions and offsets (collective call) */
+            /* get dimensions and offsets */
             Domain fileDomain = pdc.getGlobalDomain(ParamClass::iteration, ParamClass::datasetName);
-            Dimensions fileDomainEnd = fileDomain.getOffset() + fileDomain.getSize();
-            DataSpace<simDim> accessSpace;
-            DataSpace<simDim> accessOffset;
 
-            Dimensions fileAccessSpace(1, 1, 1);
-            Dimensions fileAccessOffset(0, 0, 0);
+            if (ParamClass::resample)
+                loadResampled(pdc, fileDomain, fieldBuffer, localDomain.offset + globalSlideOffset);
+            else
+                loadDomain(pdc, fileDomain, fieldBuffer, window, localDomain.offset + globalSlideOffset);
 
-            /* For each dimension, compute how file domain and local simulation domain overlap
-             * and which sizes and offsets are required for loading data from the file.
-             **/
-            for (uint32_t d = 0; d < simDim; ++d)
+            pdc.close();
+
+            /* copy host data to the device */
+            fieldBuffer.hostToDevice();
+            __getTransactionEvent().waitForFinished();
+
+            cache.setLoaded(cacheKey.str());
+        }
+        catch (const DCException& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return;
+        }
+    }
+
+    /** read the part of the file which overlaps with the local domain
+     *
+     * file and simulation cells have the same size, the file domain is
+     * placed at its stored offset
+     *
+     * @param pdc opened data collector
+     * @param fileDomain domain of the dataset in the file
+     * @param fieldBuffer destination buffer (host side is filled)
+     * @param window current moving window
+     * @param totalDomainOffset local domain offset including all slides [in cells]
+     */
+    template<typename T_Buffer>
+    void loadDomain(splash::ParallelDomainCollector& pdc,
+                    const splash::Domain& fileDomain,
+                    T_Buffer& fieldBuffer,
+                    const Window& window,
+                    const DataSpace<simDim>& totalDomainOffset)
+    {
+        using namespace splash;
+        GridController<simDim> &gc = Environment<simDim>::get().GridController();
+        const PMacc::Selection<simDim>& localDomain = Environment<simDim>::get().SubGrid().getLocalDomain();
+
+        Dimensions domainOffset(0, 0, 0);
+        for (uint32_t d = 0; d < simDim; ++d)
+            domainOffset[d] = totalDomainOffset[d];
+
+        if (gc.getPosition().y() == 0)
+            domainOffset[1] += window.globalDimensions.offset.y();
+
+        DataSpace<simDim> localDomainSize = localDomain.size;
+        Dimensions domainSize(1, 1, 1);
+        for (uint32_t d = 0; d < simDim; ++d)
+            domainSize[d] = localDomainSize[d];
+
+        Dimensions fileDomainEnd = fileDomain.getOffset() + fileDomain.getSize();
+        DataSpace<simDim> accessSpace;
+        DataSpace<simDim> accessOffset;
+
+        Dimensions fileAccessSpace(1, 1, 1);
+        Dimensions fileAccessOffset(0, 0, 0);
+
+        /* For each dimension, compute how file domain and local simulation domain overlap
+         * and which sizes and offsets are required for loading data from the file.
+         **/
+        for (uint32_t d = 0; d < simDim; ++d)
+        {
+            /* file domain in/in-after sim domain */
+            if (fileDomain.getOffset()[d] >= domainOffset[d] &&
+                fileDomain.getOffset()[d] <= domainOffset[d] + domainSize[d])
             {
-                /* file domain in/in-after sim domain */
-                if (fileDomain.getOffset()[d] >= domainOffset[d] &&
-                    fileDomain.getOffset()[d] <= domainOffset[d] + domainSize[d])
-                {
-                    accessSpace[d] = std::min(domainOffset[d] + domainSize[d] - fileDomain.getOffset()[d],
-                                              fileDomain.getSize()[d]);
-                    fileAccessSpace[d] = accessSpace[d];
-
-                    accessOffset[d] = fileDomain.getOffset()[d] - domainOffset[d];
-                    fileAccessOffset[d] = 0;
-                    continue;
-                }
-
-                /* file domain before-in sim domain */
-                if (fileDomainEnd[d] >= domainOffset[d] &&
-                    fileDomainEnd[d] <= domainOffset[d] + domainSize[d])
-                {
-                    accessSpace[d] = fileDomainEnd[d] - domainOffset[d];
-                    fileAccessSpace[d] = accessSpace[d];
-
-                    accessOffset[d] = 0;
-                    fileAccessOffset[d] = domainOffset[d] - fileDomain.getOffset()[d];
-                    continue;
-                }
-
-                /* sim domain in file domain */
-                if (domainOffset[d] >= fileDomain.getOffset()[d] &&
-                    domainOffset[d] + domainSize[d] <= fileDomainEnd[d])
-                {
-                    accessSpace[d] = domainSize[d];
-                    fileAccessSpace[d] = accessSpace[d];
-
-                    accessOffset[d] = 0;
-                    fileAccessOffset[d] = domainOffset[d] - fileDomain.getOffset()[d];
-                    continue;
-                }
-
-                /* file domain and sim domain do not intersect, do not load anything */
-                accessSpace[d] = 0;
-                break;
+                accessSpace[d] = std::min(domainOffset[d] + domainSize[d] - fileDomain.getOffset()[d],
+                                          fileDomain.getSize()[d]);
+                fileAccessSpace[d] = accessSpace[d];
+
+                accessOffset[d] = fileDomain.getOffset()[d] - domainOffset[d];
+                fileAccessOffset[d] = 0;
+                continue;
             }
 
-            /* allocate temporary buffer for hdf5 data */
-            typedef typename FieldTmp::ValueType::type ValueType;
-            ValueType *tmpBfr = nullptr;
+            /* file domain before-in sim domain */
+            if (fileDomainEnd[d] >= domainOffset[d] &&
+                fileDomainEnd[d] <= domainOffset[d] + domainSize[d])
+            {
+                accessSpace[d] = fileDomainEnd[d] - domainOffset[d];
+                fileAccessSpace[d] = accessSpace[d];
+
+                accessOffset[d] = 0;
+                fileAccessOffset[d] = domainOffset[d] - fileDomain.getOffset()[d];
+                continue;
+            }
 
-            size_t accessSize = accessSpace.productOfComponents();
-            if (accessSize > 0)
+            /* sim domain in file domain */
+            if (domainOffset[d] >= fileDomain.getOffset()[d] &&
+                domainOffset[d] + domainSize[d] <= fileDomainEnd[d])
             {
-                tmpBfr = new ValueType[accessSize];
-
-                Dimensions sizeRead(0, 0, 0);
-                pdc.read(
-                         ParamClass::iteration,
-                         fileAccessSpace,
-                         fileAccessOffset,
-                         ParamClass::datasetName,
-                         sizeRead,
-                         tmpBfr);
-
-                if (sizeRead.getScalarSize() != accessSize)
-                {
-                    __delete(tmpBfr);
-                    return;
-                }
-
-                /* get the databox of the host buffer */
-                auto dataBox = fieldBuffer.getHostBuffer().getDataBox();
-                /* get a 1D access object to the databox */
-                typedef DataBoxDim1Access< typename FieldTmp::DataBoxType > D1Box;
-                DataSpace<simDim> guards = fieldBuffer.getGridLayout().getGuard();
-                D1Box d1RAccess(dataBox.shift(guards + accessOffset), accessSpace);
-
-                /* copy from temporary buffer to fieldTmp host buffer */
-                for (int i = 0; i < accessSpace.productOfComponents(); ++i)
-                {
-                    d1RAccess[i].x() = tmpBfr[i];
-                }
-
-                __delete(tmpBfr);
+                accessSpace[d] = domainSize[d];
+                fileAccessSpace[d] = accessSpace[d];
+
+                accessOffset[d] = 0;
+                fileAccessOffset[d] = domainOffset[d] - fileDomain.getOffset()[d];
+                continue;
             }
 
-            pdc.close();
+            /* file domain and sim domain do not intersect, do not load anything */
+            accessSpace = DataSpace<simDim>::create(0);
+            break;
+        }
 
-            /* copy host data to the device */
-            fieldBuffer.hostToDevice();
-            __getTransactionEvent().waitForFinished();
+        const size_t accessSize = accessSpace.productOfComponents();
+        if (accessSize == 0)
+            return;
+
+        std::vector<ValueType>& readBuffer = FromHDF5Cache::getInstance().getReadBuffer();
+        readBuffer.resize(accessSize);
 
+        Dimensions sizeRead(0, 0, 0);
+        pdc.read(
+                 ParamClass::iteration,
+                 fileAccessSpace,
+                 fileAccessOffset,
+                 ParamClass::datasetName,
+                 sizeRead,
+                 &(*readBuffer.begin()));
+
+        if (sizeRead.getScalarSize() != accessSize)
+            return;
+
+        /* get the databox of the host buffer */
+        auto dataBox = fieldBuffer.getHostBuffer().getDataBox();
+        /* get a 1D access object to the databox */
+        typedef DataBoxDim1Access< typename FieldTmp::DataBoxType > D1Box;
+        DataSpace<simDim> guards = fieldBuffer.getGridLayout().getGuard();
+        D1Box d1RAccess(dataBox.shift(guards + accessOffset), accessSpace);
+
+        /* copy from read buffer to fieldTmp host buffer */
+        for (size_t i = 0; i < accessSize; ++i)
+        {
+            d1RAccess[i].x() = readBuffer[i];
         }
-        catch (const DCException& e)
+    }
+
+    /** first and behind last file cell which belong to a simulation cell
+     *
+     * finer file grid (ratio > 1): all file cells inside the simulation cell
+     * coarser file grid (ratio <= 1): the file cell containing the cell center
+     *
+     * @param cell simulation cell index
+     * @param ratio file cells per simulation cell
+     * @param[out] first first file cell
+     * @param[out] end behind last file cell
+     */
+    static void fileCellRange(int cell, float_64 ratio, int& first, int& end)
+    {
+        if (ratio <= 1.0)
         {
-            std::cerr << e.what() << std::endl;
+            first = int(std::floor((float_64(cell) + 0.5) * ratio));
+            end = first + 1;
+            return;
+        }
+        first = int(std::floor(float_64(cell) * ratio));
+        end = std::max(first + 1, int(std::ceil(float_64(cell + 1) * ratio)));
+    }
+
+    /** read the density from a file with a different resolution
+     *
+     * The dataset covers the full global domain (at step 0),
+     * its resolution may differ in each direction.
+     * Each rank reads only the file cells which cover its local domain.
+     * Simulation cells are the average over the covered file cells (file
+     * is finer) or the value of the file cell at their center (file is
+     * coarser). Cells outside of the file keep the default density.
+     *
+     * @param pdc opened data collector
+     * @param fileDomain domain of the dataset in the file
+     * @param fieldBuffer destination buffer (host side is filled)
+     * @param totalDomainOffset local domain offset including all slides [in cells]
+     */
+    template<typename T_Buffer>
+    void loadResampled(splash::ParallelDomainCollector& pdc,
+                       const splash::Domain& fileDomain,
+                       T_Buffer& fieldBuffer,
+                       const DataSpace<simDim>& totalDomainOffset)
+    {
+        using namespace splash;
+        const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
+        const DataSpace<simDim> localSize = subGrid.getLocalDomain().size;
+        const DataSpace<simDim> globalSize = subGrid.getGlobalDomain().size;
+
+        float_64 ratio[simDim];
+        DataSpace<simDim> fileFirst;
+        DataSpace<simDim> fileSize;
+        bool hasOverlap = true;
+        for (uint32_t d = 0; d < simDim; ++d)
+        {
+            ratio[d] = float_64(fileDomain.getSize()[d]) / float_64(globalSize[d]);
+
+            int first, end, lastFirst, lastEnd;
+            fileCellRange(totalDomainOffset[d], ratio[d], first, end);
+            fileCellRange(totalDomainOffset[d] + localSize[d] - 1, ratio[d], lastFirst, lastEnd);
+            lastEnd = std::min(lastEnd, int(fileDomain.getSize()[d]));
+
+            fileFirst[d] = first;
+            fileSize[d] = std::max(lastEnd - first, 0);
+            if (fileSize[d] == 0)
+                hasOverlap = false;
+        }
+        if (!hasOverlap)
             return;
+
+        Dimensions fileAccessSpace(1, 1, 1);
+        Dimensions fileAccessOffset(0, 0, 0);
+        for (uint32_t d = 0; d < simDim; ++d)
+        {
+            fileAccessSpace[d] = fileSize[d];
+            fileAccessOffset[d] = fileFirst[d];
         }
 
-        return;
+        const size_t accessSize = fileSize.productOfComponents();
+        std::vector<ValueType>& readBuffer = FromHDF5Cache::getInstance().getReadBuffer();
+        readBuffer.resize(accessSize);
+
+        Dimensions sizeRead(0, 0, 0);
+        pdc.read(
+                 ParamClass::iteration,
+                 fileAccessSpace,
+                 fileAccessOffset,
+                 ParamClass::datasetName,
+                 sizeRead,
+                 &(*readBuffer.begin()));
+
+        if (sizeRead.getScalarSize() != accessSize)
+            return;
+
+        auto dataBox = fieldBuffer.getHostBuffer().getDataBox().shift(fieldBuffer.getGridLayout().getGuard());
+        const int numCells = localSize.productOfComponents();
+        for (int linearId = 0; linearId < numCells; ++linearId)
+        {
+            const DataSpace<simDim> cellIdx = DataSpaceOperations<simDim>::map(localSize, linearId);
+
+            /* file cells covered by this cell, relative to the read hyperslab */
+            DataSpace<simDim> first;
+            DataSpace<simDim> boxSize;
+            bool inFile = true;
+            for (uint32_t d = 0; d < simDim; ++d)
+            {
+                int begin, end;
+                fileCellRange(totalDomainOffset[d] + cellIdx[d], ratio[d], begin, end);
+                end = std::min(end - fileFirst[d], fileSize[d]);
+                begin -= fileFirst[d];
+                first[d] = begin;
+                boxSize[d] = end - begin;
+                if (boxSize[d] <= 0)
+                    inFile = false;
+            }
+            if (!inFile)
+                continue;
+
+            const int numFileCells = boxSize.productOfComponents();
+            float_64 sum = 0.0;
+            for (int i = 0; i < numFileCells; ++i)
+            {
+                const DataSpace<simDim> fileIdx = first + DataSpaceOperations<simDim>::map(boxSize, i);
+                sum += readBuffer[DataSpaceOperations<simDim>::map(fileSize, fileIdx)];
+            }
+            dataBox(cellIdx).x() = ValueType(sum / float_64(numFileCells));
+        }
     }
 
     PMACC_ALIGN(deviceDataBox,FieldTmp::DataBoxType);
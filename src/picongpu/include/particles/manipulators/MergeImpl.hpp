@@ -0,0 +1,368 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulation_defines.hpp"
+#include "traits/frame/GetMass.hpp"
+#include "traits/HasIdentifier.hpp"
+#include "memory/Array.hpp"
+#include "memory/shared/Allocate.hpp"
+#include "particles/resampling/MergeMomenta.hpp"
+
+namespace picongpu
+{
+namespace particles
+{
+namespace manipulators
+{
+namespace detail
+{
+
+/** energy measure of a single particle which is conserved by the merging
+ *
+ * \see PMacc::particles::resampling::mergeEnergyMeasure
+ *
+ * @param singleMomentum momentum of a single (not macro) particle
+ * @param mass mass of a single particle
+ */
+HDINLINE float_X mergeEnergyMeasure(const float3_X& singleMomentum, const float_X mass)
+{
+    const float_X mom[3] = {singleMomentum.x(), singleMomentum.y(), singleMomentum.z()};
+    return PMacc::particles::resampling::mergeEnergyMeasure(mom, mass, float_X(SPEED_OF_LIGHT));
+}
+
+/** momenta of two macro particles which replace a group of macro particles
+ *
+ * \see PMacc::particles::resampling::mergeMomenta
+ *
+ * @param weighting sum of the weightings of the group
+ * @param momentum sum of the (macro) momenta of the group
+ * @param energyMeasure sum of weighting * mergeEnergyMeasure() of the group
+ * @param mass mass of a single particle
+ * @param[out] momentumA macro momentum of the first new particle
+ * @param[out] momentumB macro momentum of the second new particle
+ * @return cosine of the angle between the new momenta and the mean momentum
+ */
+HDINLINE float_X mergeMomenta(
+    const float_X weighting,
+    const float3_X& momentum,
+    const float_X energyMeasure,
+    const float_X mass,
+    float3_X& momentumA,
+    float3_X& momentumB
+)
+{
+    const float_X mom[3] = {momentum.x(), momentum.y(), momentum.z()};
+    float_X momA[3];
+    float_X momB[3];
+    const float_X cosAngle = PMacc::particles::resampling::mergeMomenta(
+        weighting, mom, energyMeasure, mass, float_X(SPEED_OF_LIGHT), momA, momB);
+    momentumA = float3_X(momA[0], momA[1], momA[2]);
+    momentumB = float3_X(momB[0], momB[1], momB[2]);
+    return cosAngle;
+}
+
+/** sums of a group of macro particles within a cell */
+struct MergeGroup
+{
+    floatD_X position;
+    float3_X momentum;
+    float3_X momentumB;
+    float_X weighting;
+    float_X energyMeasure;
+    uint32_t numParticles;
+    bool isMerged;
+};
+
+} //namespace detail
+
+template<typename T_ParamClass, typename T_SpeciesType>
+struct MergeImpl
+{
+    typedef T_ParamClass ParamClass;
+    typedef T_SpeciesType SpeciesType;
+    typedef typename SpeciesType::FrameType FrameType;
+
+    /* the particles of a cell are grouped by the octant of their momentum */
+    static constexpr int numGroups = 8;
+
+    enum
+    {
+        tileSize = PMacc::math::CT::volume<SuperCellSize>::type::value,
+        /* frames which are binned by cell at once, the slots of their
+         * particles are kept in shared memory */
+        maxBinFrames = 16
+    };
+
+    PMACC_CASSERT_MSG(
+        A_merge_group_must_contain_at_least_three_particles,
+        ParamClass::minParticlesPerGroup >= 3
+    );
+    /* particles with different charge states would be merged */
+    PMACC_CASSERT_MSG(
+        Merging_of_species_with_boundElectrons_is_not_supported,
+        !PMacc::traits::HasIdentifier<FrameType, boundElectrons>::type::value
+    );
+    PMACC_CASSERT_MSG(
+        Binned_particle_slots_must_fit_into_uint16,
+        maxBinFrames * tileSize <= 65536
+    );
+
+    HINLINE MergeImpl(uint32_t)
+    {
+    }
+
+    /** merge the particles of the cell linearThreadIdx
+     *
+     * The particles of the supercell are binned by cell once per pass (see
+     * binNextFrames()), each thread visits only the particles of its cell
+     * and only changes these particles.
+     */
+    template<typename T_ParBox>
+    DINLINE void operator()(T_ParBox& pb, const DataSpace<simDim>& superCellIdx, const int linearThreadIdx)
+    {
+        typedef typename T_ParBox::FramePtr FramePtr;
+
+        PMACC_SMEM( nextFrame, FramePtr );
+        PMACC_SMEM( binFrames, memory::Array< FramePtr, maxBinFrames > );
+        PMACC_SMEM( numBinFrames, int );
+        PMACC_SMEM( cellBegin, memory::Array< int, tileSize + 1 > );
+        PMACC_SMEM( cellNext, memory::Array< int, tileSize > );
+        PMACC_SMEM( cellSlots, memory::Array< uint16_t, maxBinFrames * tileSize > );
+        PMACC_SMEM( isMergeNeeded, int );
+
+        const float_X mass = frame::getMass<FrameType>();
+
+        detail::MergeGroup groups[numGroups];
+        for (int g = 0; g < numGroups; ++g)
+        {
+            groups[g].position = floatD_X::create(0.0);
+            groups[g].momentum = float3_X::create(0.0);
+            groups[g].weighting = float_X(0.0);
+            groups[g].energyMeasure = float_X(0.0);
+            groups[g].numParticles = 0;
+            groups[g].isMerged = false;
+        }
+
+        if (linearThreadIdx == 0)
+        {
+            nextFrame = pb.getFirstFrame(superCellIdx);
+            isMergeNeeded = 0;
+        }
+        __syncthreads();
+
+        uint32_t numCellParticles = 0;
+        while (binNextFrames(pb, nextFrame, binFrames, numBinFrames, cellBegin, cellNext, cellSlots, linearThreadIdx))
+        {
+            for (int i = cellBegin[linearThreadIdx]; i < cellBegin[linearThreadIdx + 1]; ++i)
+            {
+                auto particle = binFrames[cellSlots[i] / tileSize][cellSlots[i] % tileSize];
+
+                const float_X weighting = particle[weighting_];
+                const float3_X mom = particle[momentum_];
+                detail::MergeGroup& group = groups[getGroup(mom)];
+                group.position += weighting * particle[position_];
+                group.momentum += mom;
+                group.weighting += weighting;
+                group.energyMeasure += weighting * detail::mergeEnergyMeasure(mom / weighting, mass);
+                ++group.numParticles;
+                ++numCellParticles;
+            }
+            /* the bins are overwritten by the next frames */
+            __syncthreads();
+        }
+
+        bool isCellMerged = false;
+        if (numCellParticles > ParamClass::maxParticlesPerCell)
+        {
+            for (int g = 0; g < numGroups; ++g)
+            {
+                detail::MergeGroup& group = groups[g];
+                if (group.numParticles < ParamClass::minParticlesPerGroup)
+                    continue;
+
+                float3_X momentumA;
+                const float_X cosAngle = detail::mergeMomenta(
+                    group.weighting,
+                    group.momentum,
+                    group.energyMeasure,
+                    mass,
+                    momentumA,
+                    group.momentumB
+                );
+                if (cosAngle < ParamClass::minCosAngle)
+                    continue;
+
+                group.isMerged = true;
+                group.momentum = momentumA;
+                group.position = group.position / group.weighting;
+                /* count the particles of the group again */
+                group.numParticles = 0;
+                isCellMerged = true;
+            }
+        }
+        if (isCellMerged)
+            isMergeNeeded = 1;
+
+        if (linearThreadIdx == 0)
+            nextFrame = pb.getFirstFrame(superCellIdx);
+        __syncthreads();
+
+        if (isMergeNeeded == 0)
+            return;
+
+        /* the first two particles of a merged group are overwritten by the
+         * new particles, all other particles of the group are removed */
+        while (binNextFrames(pb, nextFrame, binFrames, numBinFrames, cellBegin, cellNext, cellSlots, linearThreadIdx))
+        {
+            for (int i = cellBegin[linearThreadIdx]; isCellMerged && i < cellBegin[linearThreadIdx + 1]; ++i)
+            {
+                auto particle = binFrames[cellSlots[i] / tileSize][cellSlots[i] % tileSize];
+
+                detail::MergeGroup& group = groups[getGroup(particle[momentum_])];
+                if (!group.isMerged)
+                    continue;
+
+                if (group.numParticles < 2)
+                {
+                    particle[weighting_] = float_X(0.5) * group.weighting;
+                    particle[momentum_] = group.numParticles == 0 ? group.momentum : group.momentumB;
+                    particle[position_] = group.position;
+                }
+                else
+                    particle[multiMask_] = 0;
+                ++group.numParticles;
+            }
+            __syncthreads();
+        }
+    }
+
+private:
+
+    HDINLINE static int getGroup(const float3_X& mom)
+    {
+        return int(mom.x() < float_X(0.0)) +
+            2 * int(mom.y() < float_X(0.0)) +
+            4 * int(mom.z() < float_X(0.0));
+    }
+
+    /** bin the particles of the next frames of a supercell by cell
+     *
+     * Counting sort of the particles of up to maxBinFrames frames (histogram
+     * of the cell indices, prefix sum, scatter), must be called by all
+     * threads of the block. Afterwards the particles of the cell
+     * linearThreadIdx are in `cellSlots[cellBegin[linearThreadIdx]]` to
+     * `cellSlots[cellBegin[linearThreadIdx + 1] - 1]` (slot: index of the frame
+     * in binFrames * tileSize + index in the frame), ordered as by a walk over
+     * all frames.
+     *
+     * @param nextFrame first frame to bin, afterwards the first frame of the next call
+     * @return false if there are no frames left, uniform for all threads
+     *
+     * all arguments except pb and linearThreadIdx must be in shared memory
+     */
+    template<
+        typename T_ParBox,
+        typename T_FramePtr,
+        typename T_Frames,
+        typename T_CellBegin,
+        typename T_CellNext,
+        typename T_CellSlots
+    >
+    DINLINE static bool binNextFrames(
+        T_ParBox& pb,
+        T_FramePtr& nextFrame,
+        T_Frames& binFrames,
+        int& numBinFrames,
+        T_CellBegin& cellBegin,
+        T_CellNext& cellNext,
+        T_CellSlots& cellSlots,
+        const int linearThreadIdx
+    )
+    {
+        if (linearThreadIdx == 0)
+        {
+            numBinFrames = 0;
+            while (nextFrame.isValid() && numBinFrames < maxBinFrames)
+            {
+                binFrames[numBinFrames++] = nextFrame;
+                nextFrame = pb.getNextFrame(nextFrame);
+            }
+            cellBegin[0] = 0;
+        }
+        cellBegin[linearThreadIdx + 1] = 0;
+        __syncthreads();
+
+        if (numBinFrames == 0)
+            return false;
+
+        for (int f = 0; f < numBinFrames; ++f)
+        {
+            auto particle = binFrames[f][linearThreadIdx];
+            if (particle[multiMask_] == 1)
+                atomicAdd(&(cellBegin[particle[localCellIdx_] + 1]), 1);
+        }
+        __syncthreads();
+
+        /* inclusive Hillis-Steele scan of the counts in cellBegin[1, tileSize] */
+        for (int stride = 1; stride < tileSize; stride *= 2)
+        {
+            int value = cellBegin[linearThreadIdx + 1];
+            if (linearThreadIdx >= stride)
+                value += cellBegin[linearThreadIdx + 1 - stride];
+            __syncthreads();
+            cellBegin[linearThreadIdx + 1] = value;
+            __syncthreads();
+        }
+
+        cellNext[linearThreadIdx] = cellBegin[linearThreadIdx];
+        __syncthreads();
+
+        for (int f = 0; f < numBinFrames; ++f)
+        {
+            auto particle = binFrames[f][linearThreadIdx];
+            if (particle[multiMask_] == 1)
+            {
+                const int dst = atomicAdd(&(cellNext[particle[localCellIdx_]]), 1);
+                cellSlots[dst] = static_cast<uint16_t>(f * tileSize + linearThreadIdx);
+            }
+        }
+        __syncthreads();
+
+        /* the atomics scatter in any order, restore the order of the frame walk */
+        const int begin = cellBegin[linearThreadIdx];
+        const int end = cellBegin[linearThreadIdx + 1];
+        for (int i = begin + 1; i < end; ++i)
+        {
+            const uint16_t slot = cellSlots[i];
+            int j = i;
+            for (; j > begin && cellSlots[j - 1] > slot; --j)
+                cellSlots[j] = cellSlots[j - 1];
+            cellSlots[j] = slot;
+        }
+        __syncthreads();
+
+        return true;
+    }
+};
+
+} //namespace manipulators
+} //namespace particles
+} //namespace picongpu
@@ -0,0 +1,191 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulation_defines.hpp"
+#include "traits/HasIdentifier.hpp"
+#include "particles/operations/Assign.hpp"
+#include "particles/operations/Deselect.hpp"
+#include "particles/operations/SetAttributeToDefault.hpp"
+#include "memory/shared/Allocate.hpp"
+
+namespace picongpu
+{
+namespace particles
+{
+namespace manipulators
+{
+namespace detail
+{
+
+/** give a new id to a particle created by splitting */
+template<bool T_hasParticleId>
+struct SetNewParticleId
+{
+    template<typename T_Particle>
+    DINLINE void operator()(T_Particle& particle)
+    {
+        SetAttributeToDefault<particleId>()(particle);
+    }
+};
+
+template<>
+struct SetNewParticleId<false>
+{
+    template<typename T_Particle>
+    DINLINE void operator()(T_Particle&)
+    {
+    }
+};
+
+} //namespace detail
+
+template<typename T_ParamClass, typename T_SpeciesType>
+struct SplitImpl
+{
+    typedef T_ParamClass ParamClass;
+    typedef T_SpeciesType SpeciesType;
+    typedef typename SpeciesType::FrameType FrameType;
+
+    HINLINE SplitImpl(uint32_t)
+    {
+    }
+
+    /** split the particles of a supercell
+     *
+     * The split particles are appended in new frames at the end of the
+     * supercell. If the heap is full the remaining particles stay unsplit.
+     */
+    template<typename T_ParBox>
+    DINLINE void operator()(T_ParBox& pb, const DataSpace<simDim>& superCellIdx, const int linearThreadIdx)
+    {
+        using namespace PMacc::particles::operations;
+
+        typedef typename T_ParBox::FramePtr FramePtr;
+        typedef typename PMacc::traits::HasIdentifier<FrameType, particleId>::type HasParticleId;
+
+        const int tileSize = PMacc::math::CT::volume<SuperCellSize>::type::value;
+
+        PMACC_SMEM( srcFrame, FramePtr );
+        PMACC_SMEM( lastSrcFrame, FramePtr );
+        PMACC_SMEM( dstFrame, FramePtr );
+        PMACC_SMEM( nextDstFrame, FramePtr );
+        PMACC_SMEM( numParticles, int );
+        PMACC_SMEM( numSplit, int );
+        /* used slots of dstFrame */
+        PMACC_SMEM( dstSize, int );
+
+        if (linearThreadIdx == 0)
+        {
+            srcFrame = pb.getFirstFrame(superCellIdx);
+            lastSrcFrame = pb.getLastFrame(superCellIdx);
+            dstFrame = FramePtr();
+            dstSize = tileSize;
+            numParticles = 0;
+        }
+        __syncthreads();
+
+        for (FramePtr frame = srcFrame; frame.isValid(); frame = pb.getNextFrame(frame))
+            if (frame[linearThreadIdx][multiMask_] == 1)
+                atomicAdd(&numParticles, 1);
+        __syncthreads();
+
+        if (numParticles == 0 || numParticles >= int(ParamClass::minParticlesPerSuperCell))
+            return;
+
+        /* only the frames which exist before the splitting are visited */
+        while (srcFrame.isValid())
+        {
+            if (linearThreadIdx == 0)
+                numSplit = 0;
+            __syncthreads();
+
+            auto particle = srcFrame[linearThreadIdx];
+            int splitIdx = -1;
+            if (particle[multiMask_] == 1 && particle[weighting_] >= float_X(2.0) * ParamClass::minWeighting)
+                splitIdx = atomicAdd(&numSplit, 1);
+            __syncthreads();
+
+            const int freeSlots = tileSize - dstSize;
+            if (linearThreadIdx == 0)
+            {
+                nextDstFrame = FramePtr();
+                if (numSplit > freeSlots)
+                {
+                    nextDstFrame = pb.getEmptyFrame();
+                    if (nextDstFrame.isValid())
+                        pb.setAsLastFrame(nextDstFrame, superCellIdx);
+                }
+            }
+            __syncthreads();
+
+            if (splitIdx >= 0 && (splitIdx < freeSlots || nextDstFrame.isValid()))
+            {
+                auto newParticle = splitIdx < freeSlots ?
+                    dstFrame[dstSize + splitIdx] :
+                    nextDstFrame[splitIdx - freeSlots];
+
+                newParticle[multiMask_] = 1;
+                auto newParticleClone = deselect<bmpl::vector2<multiMask, particleId> >(newParticle);
+                assign(newParticleClone, particle);
+                detail::SetNewParticleId<HasParticleId::value>()(newParticle);
+
+                const float_X weighting = float_X(0.5) * particle[weighting_];
+                const float3_X mom = float_X(0.5) * particle[momentum_];
+                floatD_X pos = particle[position_];
+                const float_X shift = ParamClass::displacement *
+                    (pos.x() < float_X(0.5) ? pos.x() : float_X(1.0) - pos.x());
+
+                particle[weighting_] = weighting;
+                particle[momentum_] = mom;
+                newParticle[weighting_] = weighting;
+                newParticle[momentum_] = mom;
+                pos.x() -= shift;
+                particle[position_] = pos;
+                pos.x() += float_X(2.0) * shift;
+                newParticle[position_] = pos;
+            }
+            __syncthreads();
+
+            if (linearThreadIdx == 0)
+            {
+                if (nextDstFrame.isValid())
+                {
+                    dstFrame = nextDstFrame;
+                    dstSize = numSplit - freeSlots;
+                }
+                else if (numSplit <= freeSlots)
+                    dstSize += numSplit;
+                else
+                    dstSize = tileSize;
+
+                if (srcFrame == lastSrcFrame)
+                    srcFrame = FramePtr();
+                else
+                    srcFrame = pb.getNextFrame(srcFrame);
+            }
+            __syncthreads();
+        }
+    }
+};
+
+} //namespace manipulators
+} //namespace particles
+} //namespace picongpu
@@ -1,4 +1,4 @@
-/* Copyright 2014-2017 Rene Widera, Axel Huebl
+/* Copyright 2014-2017 Rene Widera, Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -33,3 +33,5 @@
 #include "particles/manipulators/ProtonTimesWeighting.hpp"
 #include "particles/manipulators/CopyAttribute.hpp"
 #include "particles/manipulators/FreeRngImpl.hpp"
+#include "particles/manipulators/MergeImpl.hpp"
+#include "particles/manipulators/SplitImpl.hpp"
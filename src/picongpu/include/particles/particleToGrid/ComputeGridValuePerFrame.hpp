@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -28,7 +28,10 @@
 
 #include "algorithms/Gamma.hpp"
 
+#include <boost/mpl/at.hpp>
+#include <boost/mpl/size.hpp>
 #include <vector>
+#include <string>
 
 namespace picongpu
 {
@@ -121,5 +124,139 @@ ComputeGridValuePerFrame<T_ParticleShape, T_DerivedAttribute>::operator()
     }
 }
 
+namespace detail
+{
+    /** apply an operation to each attribute of a sequence of derived attributes
+     *
+     * @tparam T_DerivedAttributes boost::mpl sequence of derived attributes
+     * @tparam T_idx index of the first attribute handled by this instance
+     */
+    template<
+        class T_DerivedAttributes,
+        uint32_t T_idx = 0,
+        bool T_isValid = ( T_idx < bmpl::size<T_DerivedAttributes>::type::value )
+    >
+    struct ForEachDerivedAttribute
+    {
+        typedef typename bmpl::at_c<T_DerivedAttributes, T_idx>::type Attribute;
+        typedef ForEachDerivedAttribute<T_DerivedAttributes, T_idx + 1> Next;
+
+        /** write attribute i of the particle to values[i] */
+        template<class T_Particle, class T_Values>
+        DINLINE void evaluate(T_Particle& particle, T_Values& values) const
+        {
+            values[T_idx] = Attribute()( particle );
+            Next().evaluate( particle, values );
+        }
+
+        HINLINE float1_64 getUnit(const uint32_t attributeIdx) const
+        {
+            return attributeIdx == T_idx ? Attribute().getUnit() : Next().getUnit( attributeIdx );
+        }
+
+        HINLINE std::vector<float_64> getUnitDimension(const uint32_t attributeIdx) const
+        {
+            return attributeIdx == T_idx ?
+                Attribute().getUnitDimension() : Next().getUnitDimension( attributeIdx );
+        }
+
+        HINLINE std::string getName(const uint32_t attributeIdx) const
+        {
+            return attributeIdx == T_idx ? Attribute().getName() : Next().getName( attributeIdx );
+        }
+    };
+
+    template<class T_DerivedAttributes, uint32_t T_idx>
+    struct ForEachDerivedAttribute<T_DerivedAttributes, T_idx, false>
+    {
+        template<class T_Particle, class T_Values>
+        DINLINE void evaluate(T_Particle&, T_Values&) const
+        {
+        }
+
+        HINLINE float1_64 getUnit(const uint32_t) const
+        {
+            return float1_64(0.0);
+        }
+
+        HINLINE std::vector<float_64> getUnitDimension(const uint32_t) const
+        {
+            return std::vector<float_64>(7, 0.0);
+        }
+
+        HINLINE std::string getName(const uint32_t) const
+        {
+            return std::string();
+        }
+    };
+} // namespace detail
+
+template<class T_ParticleShape, class T_DerivedAttributes>
+HINLINE float1_64
+ComputeGridValuesPerFrame<T_ParticleShape, T_DerivedAttributes>::getUnit(const uint32_t attributeIdx) const
+{
+    return detail::ForEachDerivedAttribute<T_DerivedAttributes>().getUnit(attributeIdx);
+}
+
+template<class T_ParticleShape, class T_DerivedAttributes>
+HINLINE std::vector<float_64>
+ComputeGridValuesPerFrame<T_ParticleShape, T_DerivedAttributes>::getUnitDimension(const uint32_t attributeIdx) const
+{
+    return detail::ForEachDerivedAttribute<T_DerivedAttributes>().getUnitDimension(attributeIdx);
+}
+
+template<class T_ParticleShape, class T_DerivedAttributes>
+HINLINE std::string
+ComputeGridValuesPerFrame<T_ParticleShape, T_DerivedAttributes>::getName(const uint32_t attributeIdx) const
+{
+    return detail::ForEachDerivedAttribute<T_DerivedAttributes>().getName(attributeIdx);
+}
+
+template<class T_ParticleShape, class T_DerivedAttributes>
+template<class FrameType, class TVecSuperCell, class BoxTmp >
+DINLINE void
+ComputeGridValuesPerFrame<T_ParticleShape, T_DerivedAttributes>::operator()
+(FrameType& frame,
+ const int localIdx,
+ const TVecSuperCell superCell,
+ BoxTmp& tmpBox)
+{
+    auto particle = frame[localIdx];
+
+    /* particle attributes: in-cell position and all derived attributes */
+    const floatD_X pos = particle[position_];
+    ValueType particleAttr;
+    detail::ForEachDerivedAttribute<T_DerivedAttributes>().evaluate(particle, particleAttr);
+
+    const int particleCellIdx = particle[localCellIdx_];
+    const DataSpace<TVecSuperCell::dim> particleCell(
+        DataSpaceOperations<TVecSuperCell::dim>::map( superCell, particleCellIdx )
+    );
+    auto fieldTmpShiftToParticle = tmpBox.shift(particleCell);
+
+    /* loop around the particle's cell (according to shape) */
+    const DataSpace<simDim> lowMargin(LowerMargin().toRT());
+    const DataSpace<simDim> upMargin(UpperMargin().toRT());
+
+    const DataSpace<simDim> marginSpace(upMargin + lowMargin + 1);
+
+    const int numWriteCells = marginSpace.productOfComponents();
+
+    for (int i = 0; i < numWriteCells; ++i)
+    {
+        const DataSpace<simDim> currentCell = DataSpaceOperations<simDim>::map(marginSpace, i);
+        const DataSpace<simDim> offsetParticleCellToCurrentCell = currentCell - lowMargin;
+
+        /* the assignment function is evaluated once for all attributes */
+        float_X assign( 1.0 );
+        for (uint32_t d = 0; d < simDim; ++d)
+            assign *= AssignmentFunction()(float_X(offsetParticleCellToCurrentCell[d]) - pos[d]);
+
+        ValueType& cell = fieldTmpShiftToParticle(offsetParticleCellToCurrentCell);
+        for (uint32_t a = 0; a < numAttributes; ++a)
+            atomicAddWrapper(&(cell[a]), assign * particleAttr[a]);
+    }
+}
+
 } // namespace particleToGrid
 } // namespace picongpu
@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Heiko Burau,
- *                     Rene Widera, Richard Pausch
+ *                     Rene Widera, Richard Pausch, agent
  *
  * This file is part of PIConGPU.
  *
@@ -33,14 +33,26 @@
 #include "mappings/kernel/AreaMapping.hpp"
 #include "memory/shared/Allocate.hpp"
 #include "basicOperations.hpp"
+#include "nvidia/atomic.hpp"
+#include "nvidia/gpuEntryFunction.hpp"
 #include "dimensions/DataSpace.hpp"
 
 #include "common/txtFileHandling.hpp"
+#include "plugins/energyHistogram/EnergyHistogramFunctors.hpp"
+
+#if (ENABLE_HDF5 == 1)
+#include "traits/PICToSplash.hpp"
+#include <splash/splash.h>
+#endif
 
 #include <string>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 
 
 namespace picongpu
@@ -53,16 +65,26 @@ struct KernelBinEnergyParticles
 {
     /* sum up the energy of all particles
      * the kinetic energy of all active particles will be calculated
+     *
+     * @param gBins histogram in global memory, `numMoments` arrays with
+     *              `binDesc.getNumBins()` elements
+     * @param useSharedMem true: accumulate a privatized histogram per block
+     *                     in shared memory and merge it into gBins at the end
+     *                     (dynamic shared memory must hold all bins),
+     *                     false: accumulate directly into gBins
      */
     template<class ParBox, class BinBox, class Mapping>
     DINLINE void operator()(ParBox pb,
-                                             BinBox gBins, int numBins,
-                                             float_X minEnergy,
-                                             float_X maxEnergy,
+                                             BinBox gBins,
+                                             energyHistogram::BinDescription<float_X> binDesc,
+                                             int numMoments,
+                                             bool useSharedMem,
+                                             float_X energyToKeV,
                                              float_X maximumSlopeToDetectorX,
                                              float_X maximumSlopeToDetectorZ,
                                              Mapping mapper) const
     {
+        using namespace energyHistogram;
 
         typedef typename MappingDesc::SuperCellSize Block;
         typedef typename ParBox::FramePtr FramePtr;
@@ -73,13 +95,14 @@ struct KernelBinEnergyParticles
 
         const bool enableDetector = maximumSlopeToDetectorX != float_X(0.0) && maximumSlopeToDetectorZ != float_X(0.0);
 
-        /* shBins index can go from 0 to (numBins+2)-1
+        /* shBins index can go from 0 to (numBins+2)-1 for each angle bin and moment
          * 0 is for <minEnergy
          * (numBins+2)-1 is for >maxEnergy
          */
-        extern __shared__ float_X shBin[]; /* size must be numBins+2 because we have <min and >max */
+        extern __shared__ float_X shBin[]; /* size must be numMoments * binDesc.getNumBins() if used */
 
-        int realNumBins = numBins + 2;
+        const int numBins = binDesc.getNumBins();
+        const int numAllBins = numBins * numMoments;
 
 
 
@@ -96,9 +119,12 @@ struct KernelBinEnergyParticles
             particlesInSuperCell = pb.getSuperCell(superCellIdx).getSizeLastFrame();
         }
         /* set all bins to 0 */
-        for (int i = linearThreadIdx; i < realNumBins; i += threads)
+        if (useSharedMem)
         {
-            shBin[i] = float_X(0.);
+            for (int i = linearThreadIdx; i < numAllBins; i += threads)
+            {
+                shBin[i] = float_X(0.);
+            }
         }
 
         __syncthreads();
@@ -107,6 +133,13 @@ struct KernelBinEnergyParticles
 
         while (frame.isValid())
         {
+            /* all threads take part in the warp aggregated atomics, threads
+             * without a particle use the invalid bin -1
+             */
+            int binNumber = -1;
+            float_X normedWeighting = float_X(0.0);
+            float_X localEnergy = float_X(0.0);
+
             if (linearThreadIdx < particlesInSuperCell)
             {
                 auto particle = frame[linearThreadIdx];
@@ -132,21 +165,12 @@ struct KernelBinEnergyParticles
                     const float_X mass = attribute::getMass(weighting,particle);
 
                     // calculate kinetic energy of the macro particle
-                    float_X localEnergy = KinEnergy<>()(mom, mass);
+                    localEnergy = KinEnergy<>()(mom, mass);
 
                     localEnergy /= weighting;
+                    localEnergy *= energyToKeV;
 
-                    /* +1 move value from 1 to numBins+1 */
-                    int binNumber = math::floor((localEnergy - minEnergy) /
-                                          (maxEnergy - minEnergy) * (float_32) numBins) + 1;
-
-                    const int maxBin = numBins + 1;
-
-                    /* all entries larger than maxEnergy go into bin maxBin */
-                    binNumber = binNumber < maxBin ? binNumber : maxBin;
-
-                    /* all entries smaller than minEnergy go into bin zero */
-                    binNumber = binNumber > 0 ? binNumber : 0;
+                    binNumber = binDesc.getBin(localEnergy, mom);
 
                     /*!\todo: we can't use 64bit type on this place (NVIDIA BUG?)
                      * COMPILER ERROR: ptxas /tmp/tmpxft_00005da6_00000000-2_main.ptx, line 4246; error   : Global state space expected for instruction 'atom'
@@ -155,10 +179,25 @@ struct KernelBinEnergyParticles
                      */
                     /* overflow for big weighting reduces in shared mem */
                     /* atomicAdd(&(shBin[binNumber]), (uint32_t) weighting); */
-                    const float_X normedWeighting = float_X(weighting) / float_X(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE);
-                    atomicAddWrapper(&(shBin[binNumber]), normedWeighting);
+                    normedWeighting = float_X(weighting) / float_X(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE);
                 }
             }
+
+            /* threads of a warp hitting the same bin are combined */
+            for (int m = 0; m < numMoments; ++m)
+            {
+                float_X value = normedWeighting;
+                if (m == Moment::energy)
+                    value *= localEnergy;
+                else if (m == Moment::energySquared)
+                    value *= localEnergy * localEnergy;
+
+                if (useSharedMem)
+                    nvidia::atomicAddToBin(shBin + m * numBins, binNumber, value);
+                else
+                    nvidia::atomicAddToBin(&(gBins[m * numBins]), binNumber, float_64(value));
+            }
+
             __syncthreads();
             if (linearThreadIdx == 0)
             {
@@ -168,12 +207,15 @@ struct KernelBinEnergyParticles
             __syncthreads();
         }
 
-        __syncthreads();
-        for (int i = linearThreadIdx; i < realNumBins; i += threads)
+        if (useSharedMem)
         {
-            atomicAddWrapper(&(gBins[i]), float_64(shBin[i]));
+            for (int i = linearThreadIdx; i < numAllBins; i += threads)
+            {
+                /* empty bins need no global atomic */
+                if (shBin[i] != float_X(0.))
+                    nvidia::atomicAdd(&(gBins[i]), float_64(shBin[i]));
+            }
         }
-        __syncthreads();
     }
 };
 
@@ -199,6 +241,22 @@ private:
     /* variables for energy limits of the histogram in keV */
     float_X minEnergy_keV;
     float_X maxEnergy_keV;
+    bool logScale;
+
+    /* angle to the y-axis */
+    int numAngleBins;
+    float_X maxAngle_deg;
+
+    /* accumulate mean energy and energy spread per bin */
+    bool withMoments;
+    int numMoments;
+    /* number of bins of one moment (all energy and angle bins) */
+    int numAllBins;
+    /* privatize the histogram per block in shared memory */
+    bool useSharedMem;
+
+    bool writeHDF5;
+    std::string foldername;
 
     float_X distanceToDetector;
     float_X slitDetectorX;
@@ -221,6 +279,14 @@ public:
     gBins(nullptr),
     cellDescription(nullptr),
     notifyPeriod(0),
+    logScale(false),
+    numAngleBins(1),
+    withMoments(false),
+    numMoments(1),
+    numAllBins(0),
+    useSharedMem(true),
+    writeHDF5(false),
+    foldername(pluginPrefix),
     writeToFile(false),
     enableDetector(false)
     {
@@ -244,6 +310,13 @@ public:
             ((pluginPrefix + ".binCount").c_str(), po::value<int > (&numBins)->default_value(1024), "number of bins for the energy range")
             ((pluginPrefix + ".minEnergy").c_str(), po::value<float_X > (&minEnergy_keV)->default_value(0.0), "minEnergy[in keV]")
             ((pluginPrefix + ".maxEnergy").c_str(), po::value<float_X > (&maxEnergy_keV), "maxEnergy[in keV]")
+            ((pluginPrefix + ".logScale").c_str(), po::bool_switch(&logScale), "logarithmic energy bins (minEnergy must be > 0)")
+            ((pluginPrefix + ".angleBinCount").c_str(), po::value<int > (&numAngleBins)->default_value(1),
+             "number of bins for the angle between momentum and y-axis (> 1 creates a 2D energy x angle histogram)")
+            ((pluginPrefix + ".maxAngle").c_str(), po::value<float_X > (&maxAngle_deg)->default_value(180.0),
+             "maximum angle to the y-axis [in degree], particles with a larger angle are not counted")
+            ((pluginPrefix + ".moments").c_str(), po::bool_switch(&withMoments), "calculate the mean energy and energy spread of each bin")
+            ((pluginPrefix + ".hdf5").c_str(), po::bool_switch(&writeHDF5), "write the histogram to hdf5 files in the folder <species>_energyHistogram")
             ((pluginPrefix + ".distanceToDetector").c_str(), po::value<float_X > (&distanceToDetector)->default_value(0.0), "distance between gas and detector, assumptions: simulated area in y direction << distance to detector AND simulated area in X,Z << slit [in meters]  (if not set, all particles are counted)")
             ((pluginPrefix + ".slitDetectorX").c_str(), po::value<float_X > (&slitDetectorX)->default_value(0.0), "size of the detector slit in X [in meters] (if not set, all particles are counted)")
             ((pluginPrefix + ".slitDetectorZ").c_str(), po::value<float_X > (&slitDetectorZ)->default_value(0.0), "size of the detector slit in Z [in meters] (if not set, all particles are counted)");
@@ -279,9 +352,9 @@ private:
         {
             /* create header of the file */
             outFile << "#step <" << minEnergy_keV << " ";
-            float_X binEnergy = (maxEnergy_keV - minEnergy_keV) / (float_32) numBins;
-            for (int i = 1; i < realNumBins - 1; ++i)
-                outFile << minEnergy_keV + ((float_32) i * binEnergy) << " ";
+            const energyHistogram::BinDescription<float_X> binDesc(getBinDescription());
+            for (int i = 2; i < realNumBins; ++i)
+                outFile << binDesc.getLowerEnergyEdge(i) << " ";
 
             outFile << ">" << maxEnergy_keV << " count" << std::endl;
         }
@@ -303,22 +376,55 @@ private:
                 return;
             }
 
+            if( logScale && minEnergy_keV <= float_X(0.0) )
+                throw std::runtime_error(pluginPrefix + ": minEnergy must be > 0 for logScale");
+            if( numAngleBins <= 0 || maxAngle_deg <= float_X(0.0) || maxAngle_deg > float_X(180.0) )
+                throw std::runtime_error(pluginPrefix + ": angleBinCount must be > 0 and maxAngle in (0, 180]");
+#if (ENABLE_HDF5 != 1)
+            if( writeHDF5 )
+                throw std::runtime_error(pluginPrefix + ": hdf5 output requires PIConGPU with HDF5 support");
+#endif
+
             if (distanceToDetector != float_X(0.0) && slitDetectorX != float_X(0.0) && slitDetectorZ != float_X(0.0))
                 enableDetector = true;
 
             realNumBins = numBins + 2;
+            numAllBins = realNumBins * numAngleBins;
+            numMoments = withMoments ? 3 : 1;
+
+            /* shared memory of one block: the histogram is privatized if
+             * all bins fit next to the static shared memory of the kernel,
+             * else each particle is added to global memory
+             */
+            const size_t staticSharedMemBytes = nvidia::getEntryFunctionAttributes<
+                KernelBinEnergyParticles,
+                typename ParticlesType::ParticlesBoxType,
+                decltype( gBins->getDeviceBuffer().getDataBox() ),
+                energyHistogram::BinDescription<float_X>, int, bool, float_X, float_64, float_64,
+                AreaMapping<CORE + BORDER, MappingDesc> >().sharedSizeBytes;
+            const size_t maxSharedMemPerBlock = nvidia::getMaxSharedMemPerBlock();
+            const size_t maxSharedMemBytes = maxSharedMemPerBlock > staticSharedMemBytes ?
+                maxSharedMemPerBlock - staticSharedMemBytes : 0;
+            useSharedMem = numMoments * numAllBins * sizeof (float_X) <= maxSharedMemBytes;
+            if( !useSharedMem )
+                log<picLog::MEMORY >("%1%: %2% bins do not fit into shared memory, using global atomics")
+                    % pluginPrefix % (numMoments * numAllBins);
 
             /* create an array of float_64 on gpu und host */
-            gBins = new GridBuffer<float_64, DIM1 > (DataSpace<DIM1 > (realNumBins));
-            binReduced = new float_64[realNumBins];
-            for (int i = 0; i < realNumBins; ++i)
+            gBins = new GridBuffer<float_64, DIM1 > (DataSpace<DIM1 > (numMoments * numAllBins));
+            binReduced = new float_64[numMoments * numAllBins];
+            for (int i = 0; i < numMoments * numAllBins; ++i)
             {
                 binReduced[i] = 0.0;
             }
 
             writeToFile = reduce.hasResult(mpi::reduceMethods::Reduce());
             if( writeToFile )
+            {
                 openNewFile();
+                if( writeHDF5 )
+                    Environment<simDim>::get().Filesystem().createDirectoryWithPermissions(foldername);
+            }
 
             Environment<>::get().PluginConnector().setNotificationPeriod(this, notifyPeriod);
         }
@@ -364,6 +470,122 @@ private:
                            checkpointDirectory );
     }
 
+    energyHistogram::BinDescription<float_X> getBinDescription() const
+    {
+        return energyHistogram::BinDescription<float_X>(
+            numBins,
+            minEnergy_keV,
+            maxEnergy_keV,
+            logScale,
+            numAngleBins,
+            maxAngle_deg * float_X(M_PI / 180.0)
+        );
+    }
+
+#if (ENABLE_HDF5 == 1)
+    /** write the reduced histogram of the current step
+     *
+     * file: <species>_energyHistogram/<species>_energyHistogram_<step>.h5
+     * datasets (energy is the fastest axis, angle the slowest):
+     *  - count: number of real particles
+     *  - meanEnergy [keV], energySpread [keV]: weighted mean and standard
+     *    deviation of the energy (only with moments)
+     */
+    void writeToHDF5File(uint32_t currentStep)
+    {
+        splash::SerialDataCollector hdf5DataFile(1);
+        splash::DataCollector::FileCreationAttr fAttr;
+
+        splash::DataCollector::initFileCreationAttr(fAttr);
+
+        std::stringstream filename;
+        filename << foldername << "/" << pluginPrefix << "_" << currentStep;
+
+        hdf5DataFile.open(filename.str().c_str(), fAttr);
+
+        typename PICToSplash<float_64>::type SplashType64;
+        typename PICToSplash<float_X>::type SplashTypeX;
+        typename PICToSplash<bool>::type SplashTypeBool;
+
+        const uint32_t dimension = numAngleBins == 1 ? DIM1 : DIM2;
+        const splash::Dimensions bufferSize(realNumBins, numAngleBins, 1);
+
+        std::vector<float_64> count(numAllBins);
+        for (int i = 0; i < numAllBins; ++i)
+            count[i] = binReduced[energyHistogram::Moment::count * numAllBins + i] *
+                float_64(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE);
+
+        hdf5DataFile.write(currentStep,
+                           SplashType64,
+                           dimension,
+                           splash::Selection(bufferSize),
+                           "count",
+                           &(*count.begin()));
+
+        if (withMoments)
+        {
+            std::vector<float_64> meanEnergy(numAllBins, 0.0);
+            std::vector<float_64> energySpread(numAllBins, 0.0);
+            for (int i = 0; i < numAllBins; ++i)
+            {
+                const float_64 w = binReduced[energyHistogram::Moment::count * numAllBins + i];
+                if (w <= 0.0)
+                    continue;
+                const float_64 mean = binReduced[energyHistogram::Moment::energy * numAllBins + i] / w;
+                const float_64 meanSquared = binReduced[energyHistogram::Moment::energySquared * numAllBins + i] / w;
+                meanEnergy[i] = mean;
+                /* avoid negative values caused by rounding */
+                energySpread[i] = std::sqrt(std::max(meanSquared - mean * mean, 0.0));
+            }
+            hdf5DataFile.write(currentStep,
+                               SplashType64,
+                               dimension,
+                               splash::Selection(bufferSize),
+                               "meanEnergy",
+                               &(*meanEnergy.begin()));
+            hdf5DataFile.write(currentStep,
+                               SplashType64,
+                               dimension,
+                               splash::Selection(bufferSize),
+                               "energySpread",
+                               &(*energySpread.begin()));
+        }
+
+        hdf5DataFile.writeAttribute(currentStep,
+                                    SplashTypeX,
+                                    "count",
+                                    "minEnergy[keV]",
+                                    &minEnergy_keV);
+
+        hdf5DataFile.writeAttribute(currentStep,
+                                    SplashTypeX,
+                                    "count",
+                                    "maxEnergy[keV]",
+                                    &maxEnergy_keV);
+
+        hdf5DataFile.writeAttribute(currentStep,
+                                    SplashTypeBool,
+                                    "count",
+                                    "logScale",
+                                    &logScale);
+
+        hdf5DataFile.writeAttribute(currentStep,
+                                    SplashTypeX,
+                                    "count",
+                                    "maxAngle[deg]",
+                                    &maxAngle_deg);
+
+        const float_64 time = float_64(currentStep) * DELTA_T * UNIT_TIME;
+        hdf5DataFile.writeAttribute(currentStep,
+                                    SplashType64,
+                                    "count",
+                                    "time[s]",
+                                    &time);
+
+        hdf5DataFile.close();
+    }
+#endif
+
     template< uint32_t AREA>
     void calBinEnergyParticles(uint32_t currentStep)
     {
@@ -384,24 +606,24 @@ private:
             /* maximumSlopeToDetector = (radiusDetector * radiusDetector) / (distanceToDetector * distanceToDetector); */
         }
 
-        /* convert energy values from keV to PIConGPU units */
-        const float_X minEnergy = minEnergy_keV * UNITCONV_keV_to_Joule / UNIT_ENERGY;
-        const float_X maxEnergy = maxEnergy_keV * UNITCONV_keV_to_Joule / UNIT_ENERGY;
+        /* the histogram is binned in keV */
+        const float_X energyToKeV = float_X(UNIT_ENERGY * UNITCONV_Joule_to_keV);
 
         AreaMapping<AREA, MappingDesc> mapper(*cellDescription);
         PMACC_KERNEL(KernelBinEnergyParticles{})
-            (mapper.getGridDim(), block, (realNumBins) * sizeof (float_X))
+            (mapper.getGridDim(), block, useSharedMem ? numMoments * numAllBins * sizeof (float_X) : 0)
             (particles->getDeviceParticlesBox(),
-             gBins->getDeviceBuffer().getDataBox(), numBins, minEnergy,
-             maxEnergy, maximumSlopeToDetectorX, maximumSlopeToDetectorZ, mapper);
+             gBins->getDeviceBuffer().getDataBox(), getBinDescription(), numMoments,
+             useSharedMem, energyToKeV, maximumSlopeToDetectorX, maximumSlopeToDetectorZ, mapper);
 
         dc.releaseData( ParticlesType::FrameType::getName() );
         gBins->deviceToHost();
 
+        /* all moments are reduced at once */
         reduce(nvidia::functors::Add(),
                binReduced,
                gBins->getHostBuffer().getBasePointer(),
-               realNumBins, mpi::reduceMethods::Reduce());
+               numMoments * numAllBins, mpi::reduceMethods::Reduce());
 
 
         if (writeToFile)
@@ -415,15 +637,24 @@ private:
             outFile << currentStep << " "
                     << std::scientific; /*  for floating points, ignored for ints */
 
+            /* the text file contains the energy histogram, summed over all angles */
             for (int i = 0; i < realNumBins; ++i)
             {
-                count_particles += float_64( binReduced[i]);
-                outFile << std::scientific << (binReduced[i]) * float_64(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE) << " ";
+                float_64 binValue = 0.0;
+                for (int a = 0; a < numAngleBins; ++a)
+                    binValue += binReduced[a * realNumBins + i];
+                count_particles += binValue;
+                outFile << std::scientific << binValue * float_64(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE) << " ";
             }
             outFile << std::scientific << count_particles * float_64(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE)
                 << std::endl;
             /* endl: Flush any step to the file.
              * Thus, we will have data if the program should crash. */
+
+#if (ENABLE_HDF5 == 1)
+            if (writeHDF5)
+                writeToHDF5File(currentStep);
+#endif
         }
     }
 
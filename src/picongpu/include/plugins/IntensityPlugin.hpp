@@ -1,5 +1,5 @@
 /* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -36,10 +36,17 @@
 #include "memory/Array.hpp"
 #include "dataManagement/DataConnector.hpp"
 
+#if (ENABLE_HDF5 == 1)
+#include "traits/PICToSplash.hpp"
+#include <splash/splash.h>
+#endif
+
 #include <string>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <vector>
+#include <stdexcept>
 
 
 namespace picongpu
@@ -130,6 +137,30 @@ private:
 
     std::ofstream outFileMax;
     std::ofstream outFileIntegrated;
+
+    /* all ranks with the same y position in the gpu grid (same y range) */
+    MPI_Comm commPlane;
+    /* one rank of each y plane, rank 0 of this communicator writes the files */
+    MPI_Comm commColumn;
+    /* true if this rank is the root of commPlane (member of commColumn) */
+    bool isPlaneRoot;
+
+    /* reduced values of the local y plane (valid on the plane root) */
+    std::vector<float_32> planeMax;
+    std::vector<float_32> planeIntegrated;
+    /* values for the full global y range (valid on the writing rank) */
+    std::vector<float_32> maxAll;
+    std::vector<float_32> integratedAll;
+    /* y size and y offset of each plane, order of commColumn ranks */
+    std::vector<int> planeSizeOffset;
+    std::vector<int> recvCounts;
+    std::vector<int> recvDispls;
+
+    bool writeHDF5;
+#if (ENABLE_HDF5 == 1)
+    splash::SerialDataCollector *hdf5DataFile;
+#endif
+
     /*only rank 0 create a file*/
     bool writeToFile;
 public:
@@ -145,6 +176,13 @@ public:
     localIntegratedIntensity(nullptr),
     cellDescription(nullptr),
     notifyFrequency(0),
+    commPlane(MPI_COMM_NULL),
+    commColumn(MPI_COMM_NULL),
+    isPlaneRoot(false),
+    writeHDF5(false),
+#if (ENABLE_HDF5 == 1)
+    hdf5DataFile(nullptr),
+#endif
     writeToFile(false)
     {
         Environment<>::get().PluginConnector().registerPlugin(this);
@@ -165,7 +203,9 @@ public:
     {
         desc.add_options()
             ((pluginPrefix + ".period").c_str(),
-             po::value<uint32_t > (&notifyFrequency), "enable plugin [for each n-th step]");
+             po::value<uint32_t > (&notifyFrequency), "enable plugin [for each n-th step]")
+            ((pluginPrefix + ".hdf5").c_str(),
+             po::bool_switch(&writeHDF5), "write a hdf5 time series instead of text files");
     }
 
     std::string pluginGetName() const
@@ -184,16 +224,35 @@ private:
     {
         if (notifyFrequency > 0)
         {
-            writeToFile = Environment<simDim>::get().GridController().getGlobalRank() == 0;
+#if (ENABLE_HDF5 != 1)
+            if (writeHDF5)
+                throw std::runtime_error(pluginPrefix + ": hdf5 output requires PIConGPU with HDF5 support");
+#endif
             int yCells = cellDescription->getGridLayout().getDataSpaceWithoutGuarding().y();
 
             localMaxIntensity = new GridBuffer<float_32, DIM1 > (DataSpace<DIM1 > (yCells)); //create one int on gpu und host
             localIntegratedIntensity = new GridBuffer<float_32, DIM1 > (DataSpace<DIM1 > (yCells)); //create one int on gpu und host
 
+            createCommunicators();
+
+            planeMax.resize(yCells);
+            planeIntegrated.resize(yCells);
+
             if (writeToFile)
             {
-                createFile(pluginPrefix + "_max.dat", outFileMax);
-                createFile(pluginPrefix + "_integrated.dat", outFileIntegrated);
+                const int yGlobalSize = Environment<simDim>::get().SubGrid().getGlobalDomain().size.y();
+                maxAll.resize(yGlobalSize);
+                integratedAll.resize(yGlobalSize);
+
+#if (ENABLE_HDF5 == 1)
+                if (writeHDF5)
+                    createHDF5File();
+                else
+#endif
+                {
+                    createFile(pluginPrefix + "_max.dat", outFileMax);
+                    createFile(pluginPrefix + "_integrated.dat", outFileIntegrated);
+                }
             }
 
             Environment<>::get().PluginConnector().setNotificationPeriod(this, notifyFrequency);
@@ -206,9 +265,23 @@ private:
         {
             if (writeToFile)
             {
-                flushAndCloseFile(outFileIntegrated);
-                flushAndCloseFile(outFileMax);
+#if (ENABLE_HDF5 == 1)
+                if (writeHDF5)
+                {
+                    hdf5DataFile->close();
+                    __delete(hdf5DataFile);
+                }
+                else
+#endif
+                {
+                    flushAndCloseFile(outFileIntegrated);
+                    flushAndCloseFile(outFileMax);
+                }
             }
+            if (commColumn != MPI_COMM_NULL)
+                MPI_CHECK(MPI_Comm_free(&commColumn));
+            if (commPlane != MPI_COMM_NULL)
+                MPI_CHECK(MPI_Comm_free(&commPlane));
             __delete(localMaxIntensity);
             __delete(localIntegratedIntensity);
         }
@@ -216,7 +289,59 @@ private:
 
 private:
 
+    /* split MPI_COMM_WORLD into y planes and a column of plane roots
+     *
+     * A slide of the moving window moves whole y planes, therefore the
+     * members of a plane and the plane roots (position x=0, z=0 inside
+     * the plane) do not change during the simulation.
+     * Only the order of the planes in y changes, which is why the y offsets
+     * are gathered together with the data.
+     */
+    void createCommunicators()
+    {
+        GridController<simDim>& gc = Environment<simDim>::get().GridController();
+        const DataSpace<simDim> gpuPos(gc.getPosition());
+        const int globalRank = gc.getGlobalRank();
+
+        DataSpace<simDim> inPlanePos(gpuPos);
+        inPlanePos.y() = 0;
+        isPlaneRoot = (inPlanePos == DataSpace<simDim>::create(0));
+
+        /* plane root gets key 0 and becomes rank 0 of its plane */
+        MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD,
+                                 gpuPos.y(),
+                                 isPlaneRoot ? 0 : globalRank + 1,
+                                 &commPlane));
+
+        MPI_CHECK(MPI_Comm_split(MPI_COMM_WORLD,
+                                 isPlaneRoot ? 0 : MPI_UNDEFINED,
+                                 globalRank,
+                                 &commColumn));
+
+        writeToFile = false;
+        if (isPlaneRoot)
+        {
+            int columnRank = 0;
+            int columnSize = 0;
+            MPI_CHECK(MPI_Comm_rank(commColumn, &columnRank));
+            MPI_CHECK(MPI_Comm_size(commColumn, &columnSize));
+            writeToFile = (columnRank == 0);
+
+            if (writeToFile)
+            {
+                planeSizeOffset.resize(2 * columnSize);
+                recvCounts.resize(columnSize);
+                recvDispls.resize(columnSize);
+            }
+        }
+    }
+
     /* reduce data from all gpus to one array
+     *
+     * the data of each y plane is reduced to the plane root, afterwards
+     * the plane roots gather their (possibly different sized) y ranges
+     * to the writing rank
+     *
      * @param currentStep simulation step
      */
     void combineData(uint32_t currentStep)
@@ -227,74 +352,83 @@ private:
 
         const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
 
-        const int yGlobalSize = subGrid.getGlobalDomain().size.y();
         const int yLocalSize = localSize.y();
 
-        const int gpus = Environment<simDim>::get().GridController().getGpuNodes().productOfComponents();
-
+        MPI_CHECK(MPI_Reduce(localMaxIntensity->getHostBuffer().getBasePointer(),
+                             &(*planeMax.begin()), yLocalSize, MPI_FLOAT,
+                             MPI_MAX, 0, commPlane));
+        MPI_CHECK(MPI_Reduce(localIntegratedIntensity->getHostBuffer().getBasePointer(),
+                             &(*planeIntegrated.begin()), yLocalSize, MPI_FLOAT,
+                             MPI_SUM, 0, commPlane));
 
-        /**\todo: fixme I cant work with not regular domains (use mpi_gatherv)*/
-        DataSpace<simDim> globalRootCell(subGrid.getLocalDomain().offset);
-        int yOffset = globalRootCell.y();
-        int* yOffsetsAll = new int[gpus];
-        float_32* maxAll = new float_32[yGlobalSize];
-        float_32* maxAllTmp = new float_32[yLocalSize * gpus];
-        memset(maxAll, 0, sizeof (float_32) *yGlobalSize);
-        float_32* integretedAll = new float_32[yGlobalSize];
-        float_32* integretedAllTmp = new float_32[yLocalSize * gpus];
-        memset(integretedAll, 0, sizeof (float_32) *yGlobalSize);
+        if (!isPlaneRoot)
+            return;
 
-        MPI_CHECK(MPI_Gather(&yOffset, 1, MPI_INT, yOffsetsAll, 1,
-                             MPI_INT, 0, MPI_COMM_WORLD));
-
-        MPI_CHECK(MPI_Gather(localMaxIntensity->getHostBuffer().getBasePointer(), yLocalSize, MPI_FLOAT,
-                             maxAllTmp, yLocalSize, MPI_FLOAT,
-                             0, MPI_COMM_WORLD));
-        MPI_CHECK(MPI_Gather(localIntegratedIntensity->getHostBuffer().getBasePointer(), yLocalSize, MPI_FLOAT,
-                             integretedAllTmp, yLocalSize, MPI_FLOAT,
-                             0, MPI_COMM_WORLD));
+        /* y offset changes with each slide of the moving window */
+        int sizeOffset[2] = {yLocalSize, subGrid.getLocalDomain().offset.y()};
+        MPI_CHECK(MPI_Gather(sizeOffset, 2, MPI_INT,
+                             writeToFile ? &(*planeSizeOffset.begin()) : nullptr, 2, MPI_INT,
+                             0, commColumn));
 
         if (writeToFile)
         {
-            for (int i = 0; i < gpus; ++i)
+            for (size_t i = 0; i < recvCounts.size(); ++i)
             {
-                int gOffset = yOffsetsAll[i];
-                int tmpOff = yLocalSize*i;
-                for (int y = 0; y < yLocalSize; ++y)
-                {
-                    maxAll[gOffset + y] = std::max(maxAllTmp[tmpOff + y], maxAll[gOffset + y]);
-                    integretedAll[gOffset + y] += integretedAllTmp[tmpOff + y];
-                }
+                recvCounts[i] = planeSizeOffset[2 * i];
+                recvDispls[i] = planeSizeOffset[2 * i + 1];
             }
+        }
 
+        MPI_CHECK(MPI_Gatherv(&(*planeMax.begin()), yLocalSize, MPI_FLOAT,
+                              writeToFile ? &(*maxAll.begin()) : nullptr,
+                              writeToFile ? &(*recvCounts.begin()) : nullptr,
+                              writeToFile ? &(*recvDispls.begin()) : nullptr,
+                              MPI_FLOAT, 0, commColumn));
+        MPI_CHECK(MPI_Gatherv(&(*planeIntegrated.begin()), yLocalSize, MPI_FLOAT,
+                              writeToFile ? &(*integratedAll.begin()) : nullptr,
+                              writeToFile ? &(*recvCounts.begin()) : nullptr,
+                              writeToFile ? &(*recvDispls.begin()) : nullptr,
+                              MPI_FLOAT, 0, commColumn));
+
+        if (writeToFile)
+        {
             const uint32_t numSlides = MovingWindow::getInstance().getSlideCounter(currentStep);
             size_t physicelYCellOffset = numSlides * yLocalSize + window.globalDimensions.offset.y();
+
+            float_64 unit=UNIT_EFIELD*CELL_VOLUME*SI::EPS0_SI;
+            for(uint32_t i=0;i<simDim;++i)
+                unit*=UNIT_LENGTH;
+
+#if (ENABLE_HDF5 == 1)
+            if (writeHDF5)
+            {
+                writeHDF5Step(currentStep,
+                              &(*maxAll.begin()) + window.globalDimensions.offset.y(),
+                              &(*integratedAll.begin()) + window.globalDimensions.offset.y(),
+                              window.globalDimensions.size.y(),
+                              physicelYCellOffset,
+                              unit
+                              );
+                return;
+            }
+#endif
+
             writeFile(currentStep,
-                      maxAll + window.globalDimensions.offset.y(),
+                      &(*maxAll.begin()) + window.globalDimensions.offset.y(),
                       window.globalDimensions.size.y(),
                       physicelYCellOffset,
                       outFileMax,
                       UNIT_EFIELD
                       );
 
-            float_64 unit=UNIT_EFIELD*CELL_VOLUME*SI::EPS0_SI;
-            for(uint32_t i=0;i<simDim;++i)
-                unit*=UNIT_LENGTH;
-
             writeFile(currentStep,
-                      integretedAll + window.globalDimensions.offset.y(),
+                      &(*integratedAll.begin()) + window.globalDimensions.offset.y(),
                       window.globalDimensions.size.y(),
                       physicelYCellOffset,
                       outFileIntegrated,
                       unit
                       );
         }
-
-        __deleteArray(yOffsetsAll);
-        __deleteArray(maxAll);
-        __deleteArray(integretedAll);
-        __deleteArray(maxAllTmp);
-        __deleteArray(integretedAllTmp);
     }
 
     /* write data from array to a file
@@ -322,6 +456,85 @@ private:
         stream << std::endl;
     }
 
+#if (ENABLE_HDF5 == 1)
+    /* create the hdf5 time series file, each notified step is one iteration
+     *
+     * file: <prefix>_0_0_0.h5
+     */
+    void createHDF5File()
+    {
+        hdf5DataFile = new splash::SerialDataCollector(1);
+
+        splash::DataCollector::FileCreationAttr fAttr;
+        splash::DataCollector::initFileCreationAttr(fAttr);
+        fAttr.fileAccType = splash::DataCollector::FAT_CREATE;
+
+        hdf5DataFile->open(pluginPrefix.c_str(), fAttr);
+    }
+
+    /* write one step to the hdf5 time series
+     *
+     * datasets (SI units, same values as the text output):
+     *  - maxAmplitude [V/m]
+     *  - integratedAmplitude
+     *
+     * @param currentStep simulation step
+     * @param arrayMax shifted max intensity array
+     * @param arrayIntegrated shifted integrated intensity array
+     * @param count number of cells in y
+     * @param physicalYOffset offset in cells to the absolute simulation begin
+     * @param unitIntegrated unit of the integrated amplitude
+     */
+    void writeHDF5Step(uint32_t currentStep, float_32* arrayMax, float_32* arrayIntegrated,
+                       size_t count, size_t physicalYOffset, float_64 unitIntegrated)
+    {
+        typename PICToSplash<float_64>::type SplashType64;
+        typename PICToSplash<uint64_t>::type SplashTypeUInt64;
+
+        std::vector<float_64> data(count);
+        const splash::Dimensions bufferSize(count, 1, 1);
+
+        for (size_t i = 0; i < count; ++i)
+            data[i] = sqrt((float_64) (arrayMax[i])) * UNIT_EFIELD;
+        hdf5DataFile->write(currentStep,
+                            SplashType64,
+                            DIM1,
+                            splash::Selection(bufferSize),
+                            "maxAmplitude",
+                            &(*data.begin()));
+
+        for (size_t i = 0; i < count; ++i)
+            data[i] = sqrt((float_64) (arrayIntegrated[i])) * unitIntegrated;
+        hdf5DataFile->write(currentStep,
+                            SplashType64,
+                            DIM1,
+                            splash::Selection(bufferSize),
+                            "integratedAmplitude",
+                            &(*data.begin()));
+
+        const uint64_t yOffset = physicalYOffset;
+        hdf5DataFile->writeAttribute(currentStep,
+                                     SplashTypeUInt64,
+                                     "maxAmplitude",
+                                     "yOffset[cells]",
+                                     &yOffset);
+
+        const float_64 cellHeight = SI::CELL_HEIGHT_SI;
+        hdf5DataFile->writeAttribute(currentStep,
+                                     SplashType64,
+                                     "maxAmplitude",
+                                     "cellHeight[m]",
+                                     &cellHeight);
+
+        const float_64 time = float_64(currentStep) * DELTA_T * UNIT_TIME;
+        hdf5DataFile->writeAttribute(currentStep,
+                                     SplashType64,
+                                     "maxAmplitude",
+                                     "time[s]",
+                                     &time);
+    }
+#endif
+
     /* run calculation of intensity
      * sync all result data to host side
      *
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -53,6 +53,9 @@ namespace picongpu
         LiveViewPlugin() :
         pluginName("LiveViewPlugin: 2D (plane) insitu live visualisation of a species"),
         pluginPrefix(ParticlesType::FrameType::getName() + std::string("_liveView")),
+        compressLevel(6),
+        numBufferedFrames(4),
+        useDelta(false),
         cellDescription(nullptr)
         {
             Environment<>::get().PluginConnector().registerPlugin(this);
@@ -74,6 +77,13 @@ namespace picongpu
                     ((pluginPrefix + ".period").c_str(), po::value<std::vector<uint32_t> > (&notifyFrequencys)->multitoken(), "enable images/visualisation [for each n-th step]")
                     ((pluginPrefix + ".ip").c_str(), po::value<std::vector<std::string > > (&ips)->multitoken(), "ip of server")
                     ((pluginPrefix + ".port").c_str(), po::value<std::vector<std::string > > (&ports)->multitoken(), "port of server")
+                    ((pluginPrefix + ".serverPort").c_str(), po::value<std::vector<std::string > > (&serverPorts)->multitoken(),
+                     "act as server: listen on this port and stream to any number of clients without blocking the simulation "
+                     "(replaces port, ip is the address to bind [default: 0.0.0.0])")
+                    ((pluginPrefix + ".compression").c_str(), po::value<int> (&compressLevel)->default_value(6), "zlib compression level [0-9], 1 is the fastest")
+                    ((pluginPrefix + ".bufferFrames").c_str(), po::value<uint32_t> (&numBufferedFrames)->default_value(4),
+                     "server only: number of frames buffered for slow clients, older frames are dropped")
+                    ((pluginPrefix + ".delta").c_str(), po::bool_switch(&useDelta), "server only: send frames as difference to the previous frame")
                     ((pluginPrefix + ".axis").c_str(), po::value<std::vector<std::string > > (&axis)->multitoken(), "axis which are shown [valid values x,y,z] example: yz")
                     ((pluginPrefix + ".slicePoint").c_str(), po::value<std::vector<float_32> > (&slicePoints)->multitoken(), "value range: 0 <= x <= 1 , point of the slice");
         }
@@ -91,12 +101,17 @@ namespace picongpu
 
             if (0 != notifyFrequencys.size())
             {
+                const bool isServer = 0 != serverPorts.size();
+                if (isServer && 0 == ips.size())
+                    ips.push_back("0.0.0.0");
+
                 if (0 != slicePoints.size() &&
-                    0 != ports.size() &&
+                    (0 != ports.size() || isServer) &&
                     0 != ips.size() &&
                     0 != axis.size())
                 {
-                    for (int i = 0; i < (int) ports.size(); ++i)
+                    const std::vector<std::string>& usedPorts = isServer ? serverPorts : ports;
+                    for (int i = 0; i < (int) usedPorts.size(); ++i)
                     {
                         uint32_t frequ = getValue(notifyFrequencys, i);
                         if (frequ != 0)
@@ -104,7 +119,14 @@ namespace picongpu
 
                             if (getValue(axis, i).length() == 2u)
                             {
-                                LiveViewClient liveViewClient(getValue(ips, i), getValue(ports, i));
+                                LiveViewClient liveViewClient(
+                                    getValue(ips, i),
+                                    getValue(usedPorts, i),
+                                    isServer,
+                                    compressLevel,
+                                    numBufferedFrames,
+                                    useDelta
+                                );
                                 DataSpace<DIM2 > transpose(
                                                            charToAxisNumber(getValue(axis, i)[0]),
                                                            charToAxisNumber(getValue(axis, i)[1])
@@ -175,6 +197,10 @@ namespace picongpu
         std::vector<std::string> ips;
         std::vector<std::string> ports;
         std::vector<std::string> axis;
+        std::vector<std::string> serverPorts;
+        int compressLevel;
+        uint32_t numBufferedFrames;
+        bool useDelta;
         VisPointerList visIO;
 
         MappingDesc* cellDescription;
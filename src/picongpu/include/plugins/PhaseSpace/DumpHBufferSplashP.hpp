@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -37,6 +37,7 @@
 #include <fstream>
 #include <sstream>
 #include <utility>
+#include <vector>
 #include <mpi.h>
 #include <splash/splash.h>
 
@@ -70,8 +71,6 @@ namespace picongpu
                          MPI_Comm mpiComm ) const
         {
             using namespace splash;
-            typedef T_Type Type;
-            const int bufDim = T_bufDim;
 
             /** file name *****************************************************
              *    phaseSpace/PhaseSpace_xpy_timestep.h5                       */
@@ -82,23 +81,112 @@ namespace picongpu
                      << fCoords.at(axis_element.space)
                      << "p" << fCoords.at(axis_element.momentum);
 
-            /** get size of the fileWriter communicator ***********************/
             int size;
             MPI_CHECK(MPI_Comm_size( mpiComm, &size ));
+            ParallelDomainCollector pdc(
+                mpiComm, MPI_INFO_NULL, Dimensions(size, 1, 1), 10 );
+            open( pdc, filename.str(), axis_element.space );
 
-            /** create parallel domain collector ******************************/
+            writeDataSet( pdc, &(*hBuffer.origin()(0,0)), hBuffer.size().x(), hBuffer.size().y(),
+                          T_bufDim, axis_element, axis_p_range, pRange_unit, unit,
+                          currentStep, mpiComm );
+
+            /** close file ****************************************************/
+            pdc.finalize();
+            pdc.close();
+        }
+
+        /** Dump several PhaseSpaces with the same spatial axis into one file
+         *
+         * \param hBuffer phase spaces concatenated in spatial dimension,
+         *                each including guard cells in spatial dimension
+         * \param axis_elements plot of each phase space, all with the same spatial axis
+         * \param axis_p_ranges momentum range of each phase space
+         * \see operator() for the other parameters
+         */
+        template<typename T_Type, int T_bufDim>
+        void operator()( const PMacc::container::HostBuffer<T_Type, T_bufDim>& hBuffer,
+                         const std::vector<AxisDescription>& axis_elements,
+                         const std::vector<std::pair<float_X, float_X> >& axis_p_ranges,
+                         const float_64 pRange_unit,
+                         const float_64 unit,
+                         const std::string strSpecies,
+                         const uint32_t currentStep,
+                         MPI_Comm mpiComm ) const
+        {
+            using namespace splash;
+
+            /** file name *****************************************************
+             *    phaseSpace/PhaseSpace_x_timestep.h5                         */
+            std::string fCoords("xyz");
+            std::ostringstream filename;
+            filename << "phaseSpace/PhaseSpace_"
+                     << strSpecies << "_"
+                     << fCoords.at(axis_elements.front().space);
+
+            int size;
+            MPI_CHECK(MPI_Comm_size( mpiComm, &size ));
             ParallelDomainCollector pdc(
                 mpiComm, MPI_INFO_NULL, Dimensions(size, 1, 1), 10 );
+            open( pdc, filename.str(), axis_elements.front().space );
+
+            const size_t rBins = hBuffer.size().y() / axis_elements.size();
+            for( size_t i = 0; i < axis_elements.size(); ++i )
+                writeDataSet( pdc, &(*hBuffer.origin()(0, i * rBins)), hBuffer.size().x(), rBins,
+                              T_bufDim, axis_elements.at(i), axis_p_ranges.at(i), pRange_unit, unit,
+                              currentStep, mpiComm );
+
+            /** close file ****************************************************/
+            pdc.finalize();
+            pdc.close();
+        }
+
+    private:
+        /** create the file, the writing ranks are distributed along the spatial axis */
+        void open( splash::ParallelDomainCollector& pdc,
+                   const std::string& filename,
+                   const uint32_t space ) const
+        {
+            using namespace splash;
 
             PMacc::GridController<simDim>& gc =
                 PMacc::Environment<simDim>::get().GridController();
             DataCollector::FileCreationAttr fAttr;
-            Dimensions mpiPosition( gc.getPosition()[axis_element.space], 0, 0 );
+            Dimensions mpiPosition( gc.getPosition()[space], 0, 0 );
             fAttr.mpiPosition.set( mpiPosition );
 
             DataCollector::initFileCreationAttr(fAttr);
 
-            pdc.open( filename.str().c_str(), fAttr );
+            pdc.open( filename.c_str(), fAttr );
+        }
+
+        /** write one phase space and its meta attributes
+         *
+         * \param data first bin of the phase space (row-major, momentum bins are contiguous)
+         * \param pBins number of momentum bins
+         * \param rBins number of spatial bins including guard cells
+         */
+        template<typename T_Type>
+        void writeDataSet( splash::ParallelDomainCollector& pdc,
+                           const T_Type* data,
+                           const size_t pBins,
+                           const size_t rBins,
+                           const int bufDim,
+                           const AxisDescription axis_element,
+                           const std::pair<float_X, float_X> axis_p_range,
+                           const float_64 pRange_unit,
+                           const float_64 unit,
+                           const uint32_t currentStep,
+                           MPI_Comm mpiComm ) const
+        {
+            using namespace splash;
+            typedef T_Type Type;
+
+            std::string fCoords("xyz");
+
+            /** get size of the fileWriter communicator ***********************/
+            int size;
+            MPI_CHECK(MPI_Comm_size( mpiComm, &size ));
 
             /** calculate GUARD offset in the source hBuffer *****************/
             const uint32_t rGuardCells =
@@ -108,12 +196,12 @@ namespace picongpu
             const uint32_t numSlides = MovingWindow::getInstance().getSlideCounter(currentStep);
             const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
             const int rLocalOffset = subGrid.getLocalDomain().offset[axis_element.space];
-            const int rLocalSize = int(hBuffer.size().y() - 2*rGuardCells);
+            const int rLocalSize = int(rBins - 2*rGuardCells);
             const int rGlobalSize = subGrid.getGlobalDomain().size[axis_element.space];
             PMACC_VERIFY( rLocalSize == subGrid.getLocalDomain().size[axis_element.space] );
 
             /* globalDomain of the phase space */
-            splash::Dimensions globalPhaseSpace_size( hBuffer.size().x(),
+            splash::Dimensions globalPhaseSpace_size( pBins,
                                                       rGlobalSize,
                                                       1 );
 
@@ -131,7 +219,7 @@ namespace picongpu
 
             /* localDomain: offset of it in the globalDomain and size */
             splash::Dimensions localPhaseSpace_offset( 0, rLocalOffset, 0 );
-            splash::Dimensions localPhaseSpace_size( hBuffer.size().x(),
+            splash::Dimensions localPhaseSpace_size( pBins,
                                                      rLocalSize,
                                                      1 );
 
@@ -145,7 +233,7 @@ namespace picongpu
             int rank;
             MPI_CHECK(MPI_Comm_rank( mpiComm, &rank ));
             log<picLog::INPUT_OUTPUT > ("Dump buffer %1% to %2% at offset %3% with size %4% for total size %5% for rank %6% / %7%")
-                % ( *(hBuffer.origin()(0,rGuardCells)) ) % dataSetName.str() % localPhaseSpace_offset.toString()
+                % ( data[rGuardCells * pBins] ) % dataSetName.str() % localPhaseSpace_offset.toString()
                 % localPhaseSpace_size.toString() % globalPhaseSpace_size.toString()
                 % rank % size;
 
@@ -170,7 +258,7 @@ namespace picongpu
                              ),
                              /* dataClass, buffer */
                              DomainCollector::GridType,
-                             &(*hBuffer.origin()(0,rGuardCells)) );
+                             data + rGuardCells * pBins );
 
             /** meta attributes for the data set: unit, range, moving window **/
             typedef PICToSplash<float_X>::type  SplashFloatXType;
@@ -202,10 +290,6 @@ namespace picongpu
                                 "dt", &DELTA_T );
             pdc.writeAttribute( currentStep, ctFloat64, dataSetName.str().c_str(),
                                 "dt_unit", &UNIT_TIME );
-
-            /** close file ****************************************************/
-            pdc.finalize();
-            pdc.close();
         }
     };
 
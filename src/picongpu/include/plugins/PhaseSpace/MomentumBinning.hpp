@@ -0,0 +1,62 @@
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Richard Pausch,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+
+#include <utility>
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+    /** Binning of the momentum axis of a phase space
+     *
+     * \tparam T_Float floating point type of the momentum, float_X in the simulation
+     */
+    template<typename T_Float>
+    struct MomentumBinning
+    {
+        /** momentum bin, out-of-range momenta are put into the first/last bin
+         *
+         * \param mom momentum component of the particle
+         * \param axis_p_range range of the momentum coordinate \see PhaseSpace::axis_p_range
+         * \param num_pbins number of bins in momentum space \see PhaseSpace.hpp
+         */
+        HDINLINE static int
+        getMomentumBin( const T_Float mom, const std::pair<T_Float, T_Float>& axis_p_range,
+                        const int num_pbins )
+        {
+            const T_Float rel_bin = (mom - axis_p_range.first)
+                                  / (axis_p_range.second - axis_p_range.first);
+            int p_bin = int( rel_bin * T_Float(num_pbins) );
+
+            /* out-of-range bins back to min/max */
+            if( p_bin < 0 )
+                p_bin = 0;
+            if( p_bin >= num_pbins )
+                p_bin = num_pbins - 1;
+            return p_bin;
+        }
+    };
+
+} // namespace picongpu
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, agent
  *
  * This file is part of PIConGPU.
  *
@@ -30,6 +30,7 @@
 #include "math/Vector.hpp"
 
 #include "plugins/PhaseSpace/AxisDescription.hpp"
+#include "plugins/PhaseSpace/PlaneReduce.hpp"
 
 #include <string>
 #include <utility>
@@ -51,18 +52,6 @@ namespace picongpu
         typedef T_AssignmentFunction AssignmentFunction;
         typedef T_Species Species;
 
-    private:
-        std::string name;
-        std::string prefix;
-        uint32_t notifyPeriod;
-        MappingDesc *cellDescription;
-
-        /** plot to create: e.g. py, x from element_coordinate/momentum */
-        AxisDescription axis_element;
-        /** range [pMin : pMax] in m_e c */
-        std::pair<float_X, float_X> axis_p_range;
-        uint32_t r_bins;
-
         typedef float_32 float_PS;
         /** depending on the super cells edge size and the PS float type
          *  we use not more than 32KB shared memory
@@ -76,14 +65,22 @@ namespace picongpu
         static constexpr uint32_t maxShared = 32*1024; /* 32 KB */
         static constexpr uint32_t num_pbins = maxShared/(sizeof(float_PS)*SuperCellsLongestEdge::value);
 
+    private:
+        std::string name;
+        std::string prefix;
+        uint32_t notifyPeriod;
+        MappingDesc *cellDescription;
+
+        /** plot to create: e.g. py, x from element_coordinate/momentum */
+        AxisDescription axis_element;
+        /** range [pMin : pMax] in m_e c */
+        std::pair<float_X, float_X> axis_p_range;
+        uint32_t r_bins;
+
         container::DeviceBuffer<float_PS, 2>* dBuffer;
 
-        /** reduce functor to a single host per plane */
-        PMacc::algorithm::mpi::Reduce<simDim>* planeReduce;
-        bool isPlaneReduceRoot;
-        /** MPI communicator that contains the root ranks of the \p planeReduce
-         */
-        MPI_Comm commFileWriter;
+        /** reduce to a single host per plane and file writer communicator */
+        PlaneReduce plane;
 
     public:
         PhaseSpace( const std::string _name,
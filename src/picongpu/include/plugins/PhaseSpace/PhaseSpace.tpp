@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, agent
  *
  * This file is part of PIConGPU.
  *
@@ -53,8 +53,7 @@ namespace picongpu
                                                          const AxisDescription& _element ) :
     cellDescription(nullptr), name(_name), prefix(_prefix),
     dBuffer(nullptr), axis_p_range(_p_range), axis_element(_element),
-    notifyPeriod(_notifyPeriod), isPlaneReduceRoot(false),
-    commFileWriter(MPI_COMM_NULL), planeReduce(NULL)
+    notifyPeriod(_notifyPeriod)
     {
     }
 
@@ -71,91 +70,14 @@ namespace picongpu
 
         this->dBuffer = new container::DeviceBuffer<float_PS, 2>( this->num_pbins, r_bins );
 
-        /* reduce-add phase space from other GPUs in range [p0;p1]x[r;r+dr]
-         * to "lowest" node in range
-         * e.g.: phase space x-py: reduce-add all nodes with same x range in
-         *                         spatial y and z direction to node with
-         *                         lowest y and z position and same x range
-         */
-        PMacc::GridController<simDim>& gc = PMacc::Environment<simDim>::get().GridController();
-        PMacc::math::Size_t<simDim> gpuDim = gc.getGpuNodes();
-        PMacc::math::Int<simDim> gpuPos = gc.getPosition();
-
-        /* my plane means: the r_element I am calculating should be 1GPU in width */
-        PMacc::math::Size_t<simDim> sizeTransversalPlane(gpuDim);
-        sizeTransversalPlane[this->axis_element.space] = 1;
-
-        for( int planePos = 0; planePos <= (int)gpuDim[this->axis_element.space]; ++planePos )
-        {
-            /* my plane means: the offset for the transversal plane to my r_element
-             * should be zero
-             */
-            PMacc::math::Int<simDim> longOffset(PMacc::math::Int<simDim>::create(0));
-            longOffset[this->axis_element.space] = planePos;
-
-            zone::SphericZone<simDim> zoneTransversalPlane( sizeTransversalPlane, longOffset );
-
-            /* Am I the lowest GPU in my plane? */
-            bool isGroupRoot = false;
-            bool isInGroup   = ( gpuPos[this->axis_element.space] == planePos );
-            if( isInGroup )
-            {
-                PMacc::math::Int<simDim> inPlaneGPU(gpuPos);
-                inPlaneGPU[this->axis_element.space] = 0;
-                if( inPlaneGPU == PMacc::math::Int<simDim>::create(0) )
-                    isGroupRoot = true;
-            }
-
-            algorithm::mpi::Reduce<simDim>* createReduce =
-                new algorithm::mpi::Reduce<simDim>( zoneTransversalPlane,
-                                                    isGroupRoot );
-            if( isInGroup )
-            {
-                this->planeReduce = createReduce;
-                this->isPlaneReduceRoot = isGroupRoot;
-            }
-            else
-                __delete( createReduce );
-        }
-
-        /* Create communicator with ranks of each plane reduce root */
-        {
-            /* Array with root ranks of the planeReduce operations */
-            std::vector<int> planeReduceRootRanks( gc.getGlobalSize(), -1 );
-            /* Am I one of the planeReduce root ranks? my global rank : -1 */
-            int myRootRank = gc.getGlobalRank() * this->isPlaneReduceRoot
-                           - ( ! this->isPlaneReduceRoot );
-
-            MPI_Group world_group, new_group;
-            MPI_CHECK(MPI_Allgather( &myRootRank, 1, MPI_INT,
-                                     &(planeReduceRootRanks.front()),
-                                     1,
-                                     MPI_INT,
-                                     MPI_COMM_WORLD ));
-
-            /* remove all non-roots (-1 values) */
-            std::sort( planeReduceRootRanks.begin(), planeReduceRootRanks.end() );
-            std::vector<int> ranks( std::lower_bound( planeReduceRootRanks.begin(),
-                                                      planeReduceRootRanks.end(),
-                                                      0 ),
-                                    planeReduceRootRanks.end() );
-
-            MPI_CHECK(MPI_Comm_group( MPI_COMM_WORLD, &world_group ));
-            MPI_CHECK(MPI_Group_incl( world_group, ranks.size(), ranks.data(), &new_group ));
-            MPI_CHECK(MPI_Comm_create( MPI_COMM_WORLD, new_group, &commFileWriter ));
-            MPI_CHECK(MPI_Group_free( &new_group ));
-            MPI_CHECK(MPI_Group_free( &world_group ));
-        }
+        this->plane.init( this->axis_element.space );
     }
 
     template<class AssignmentFunction, class Species>
     void PhaseSpace<AssignmentFunction, Species>::pluginUnload()
     {
         __delete( this->dBuffer );
-        __delete( planeReduce );
-
-        if( commFileWriter != MPI_COMM_NULL )
-            MPI_CHECK(MPI_Comm_free( &commFileWriter ));
+        this->plane.free();
     }
 
     template<class AssignmentFunction, class Species >
@@ -222,14 +144,14 @@ namespace picongpu
         container::HostBuffer<float_PS, 2> hReducedBuffer( hBuffer.size() );
         hReducedBuffer.assign( float_PS(0.0) );
 
-        planeReduce->template operator()( /* parameters: dest, source */
+        plane.planeReduce->template operator()( /* parameters: dest, source */
                              hReducedBuffer,
                              hBuffer,
                              /* the functors return value will be written to dst */
                              _1 + _2 );
 
         /** all non-reduce-root processes are done now */
-        if( !this->isPlaneReduceRoot )
+        if( !this->plane.isPlaneReduceRoot )
             return;
 
         /** \todo communicate GUARD and add it to the two neighbors BORDER */
@@ -249,11 +171,11 @@ namespace picongpu
 
         DumpHBuffer dumpHBuffer;
 
-        if( this->commFileWriter != MPI_COMM_NULL )
+        if( this->plane.commFileWriter != MPI_COMM_NULL )
             dumpHBuffer( hReducedBuffer, this->axis_element,
                          this->axis_p_range, pRange_unit,
                          unit, Species::FrameType::getName(),
-                         currentStep, this->commFileWriter );
+                         currentStep, this->plane.commFileWriter );
     }
 
     template<class AssignmentFunction, class Species>
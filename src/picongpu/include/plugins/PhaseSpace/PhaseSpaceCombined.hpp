@@ -0,0 +1,106 @@
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulation_defines.hpp"
+#include "pluginSystem/INotify.hpp"
+#include "cuSTL/container/DeviceBuffer.hpp"
+#include "cuSTL/container/HostBuffer.hpp"
+
+#include "plugins/PhaseSpace/AxisDescription.hpp"
+#include "plugins/PhaseSpace/PhaseSpace.hpp"
+#include "plugins/PhaseSpace/PlaneReduce.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+
+namespace picongpu
+{
+    using namespace PMacc;
+
+    /** All phase spaces of a species with one particle pass
+     *
+     * Creates the same phase spaces as one PhaseSpace instance per
+     * (space, momentum) pair, but
+     *   - bins all phase spaces due in a step with one pass over the particles,
+ *     the phase spaces whose block snippets fit into shared memory are
+ *     reduced there first, the others are binned into global memory
+     *   - reduces all phase spaces with the same spatial axis with one MPI call
+     *   - writes all phase spaces with the same spatial axis into one file
+     *     phaseSpace/PhaseSpace_<species>_<space>_<step>.h5
+     *     (the data sets are named as in the separate files)
+     *
+     * The plugin is notified with the greatest common divisor of the periods.
+     */
+    template<class T_AssignmentFunction, class T_Species>
+    class PhaseSpaceCombined : public INotify
+    {
+    public:
+        typedef T_AssignmentFunction AssignmentFunction;
+        typedef T_Species Species;
+        typedef PhaseSpace<AssignmentFunction, Species> Single;
+
+        typedef typename Single::float_PS float_PS;
+        static constexpr uint32_t num_pbins = Single::num_pbins;
+        /** maximum number of phase spaces of a species */
+        static constexpr uint32_t maxPhaseSpaces = 16;
+        /** bins of the block snippets in shared memory, the same budget as a
+         *  single phase space \see PhaseSpace::maxShared */
+        static constexpr uint32_t numSharedBins = Single::maxShared / sizeof(float_PS);
+
+    private:
+        std::string prefix;
+        MappingDesc *cellDescription;
+
+        std::vector<uint32_t> notifyPeriod;
+        /** plot to create: e.g. py, x from element_coordinate/momentum */
+        std::vector<AxisDescription> axis_element;
+        /** range [pMin : pMax] in m_e c */
+        std::vector<std::pair<float_X, float_X> > axis_p_range;
+
+        std::vector<container::DeviceBuffer<float_PS, 2>* > dBuffers;
+
+        /** reduce and file writer communicator for each spatial axis */
+        PlaneReduce planes[simDim];
+        bool isSpaceUsed[simDim];
+
+        /** bin the phase spaces due in this step on the device */
+        void calcPhaseSpaces( const std::vector<uint32_t>& active );
+
+    public:
+        PhaseSpaceCombined( const std::string _prefix,
+                            const std::vector<uint32_t>& _notifyPeriod,
+                            const std::vector<std::pair<float_X, float_X> >& _p_range,
+                            const std::vector<AxisDescription>& _element );
+        virtual ~PhaseSpaceCombined(){}
+
+        void notify( uint32_t currentStep );
+        void setMappingDescription( MappingDesc* cellDescription );
+
+        void pluginLoad();
+        void pluginUnload();
+    };
+
+}
+
+#include "PhaseSpaceCombined.tpp"
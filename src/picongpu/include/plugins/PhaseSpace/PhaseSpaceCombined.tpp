@@ -0,0 +1,258 @@
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PhaseSpaceCombined.hpp"
+#include "PhaseSpaceFunctors.hpp"
+
+#include "DumpHBufferSplashP.hpp"
+
+#include "cuSTL/container/DeviceBuffer.hpp"
+#include "cuSTL/cursor/MultiIndexCursor.hpp"
+#include "cuSTL/algorithm/kernel/ForeachBlock.hpp"
+#include "cuSTL/algorithm/mpi/Reduce.hpp"
+#include "math/vector/Int.hpp"
+#include "math/vector/Size_t.hpp"
+#include "dataManagement/DataConnector.hpp"
+#include "pluginSystem/IPlugin.hpp"
+#include "algorithms/SharedBinLayout.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+
+namespace picongpu
+{
+    using namespace PMacc;
+
+    template<class AssignmentFunction, class Species>
+    PhaseSpaceCombined<AssignmentFunction, Species>::PhaseSpaceCombined(
+        const std::string _prefix,
+        const std::vector<uint32_t>& _notifyPeriod,
+        const std::vector<std::pair<float_X, float_X> >& _p_range,
+        const std::vector<AxisDescription>& _element ) :
+    prefix(_prefix), cellDescription(nullptr), notifyPeriod(_notifyPeriod),
+    axis_element(_element), axis_p_range(_p_range)
+    {
+        for( uint32_t d = 0; d < simDim; ++d )
+            isSpaceUsed[d] = false;
+    }
+
+    template<class AssignmentFunction, class Species>
+    void PhaseSpaceCombined<AssignmentFunction, Species>::pluginLoad()
+    {
+        if( this->axis_element.size() > maxPhaseSpaces )
+            throw PluginException( "[Plugin] [" + this->prefix + "] too many phase spaces for combined" );
+
+        /* a file holds one data set per (space, momentum) pair */
+        for( uint32_t i = 0; i < this->axis_element.size(); ++i )
+            for( uint32_t j = 0; j < i; ++j )
+                if( this->axis_element[i].space == this->axis_element[j].space &&
+                    this->axis_element[i].momentum == this->axis_element[j].momentum )
+                    throw PluginException( "[Plugin] [" + this->prefix + "] combined needs distinct space and momentum pairs" );
+
+        /* notify at the greatest common divisor of all periods */
+        uint32_t period = 0;
+        for( uint32_t i = 0; i < this->notifyPeriod.size(); ++i )
+        {
+            uint32_t a = period;
+            uint32_t b = this->notifyPeriod[i];
+            while( b != 0 )
+            {
+                const uint32_t t = a % b;
+                a = b;
+                b = t;
+            }
+            period = a;
+        }
+        Environment<>::get().PluginConnector().setNotificationPeriod(this, period);
+
+        for( uint32_t i = 0; i < this->axis_element.size(); ++i )
+        {
+            const uint32_t r_element = this->axis_element[i].space;
+
+            /* CORE + BORDER + GUARD elements for spatial bins */
+            const uint32_t r_bins = SuperCellSize().toRT()[r_element]
+                                  * this->cellDescription->getGridSuperCells()[r_element];
+
+            this->dBuffers.push_back( new container::DeviceBuffer<float_PS, 2>( num_pbins, r_bins ) );
+            this->isSpaceUsed[r_element] = true;
+        }
+
+        /* the same on all ranks: collective creation of the plane reduces */
+        for( uint32_t d = 0; d < simDim; ++d )
+            if( this->isSpaceUsed[d] )
+                this->planes[d].init( d );
+    }
+
+    template<class AssignmentFunction, class Species>
+    void PhaseSpaceCombined<AssignmentFunction, Species>::pluginUnload()
+    {
+        for( uint32_t i = 0; i < this->dBuffers.size(); ++i )
+            __delete( this->dBuffers[i] );
+        this->dBuffers.clear();
+
+        for( uint32_t d = 0; d < simDim; ++d )
+            if( this->isSpaceUsed[d] )
+                this->planes[d].free();
+    }
+
+    template<class AssignmentFunction, class Species>
+    void PhaseSpaceCombined<AssignmentFunction, Species>::calcPhaseSpaces(
+        const std::vector<uint32_t>& active )
+    {
+        const PMacc::math::Int<simDim> guardCells = SuperCellSize().toRT() * int(GUARD_SIZE);
+        const PMacc::math::Size_t<simDim> coreBorderSuperCells( this->cellDescription->getGridSuperCells() - 2*int(GUARD_SIZE) );
+        const PMacc::math::Size_t<simDim> coreBorderCells = coreBorderSuperCells *
+            precisionCast<size_t>( SuperCellSize().toRT() );
+
+        /* block snippets in shared memory for the phase spaces which fit */
+        std::vector<size_t> numSnippetBins;
+        for( uint32_t i = 0; i < active.size(); ++i )
+            numSnippetBins.push_back( num_pbins * SuperCellSize().toRT()[this->axis_element[active[i]].space] );
+        std::vector<int> sharedOffset;
+        algorithms::histogram::placeSharedBins( numSnippetBins, numSharedBins, sharedOffset );
+
+        typedef PhaseSpaceSet<float_PS, maxPhaseSpaces> Set;
+        Set phaseSpaces;
+        phaseSpaces.numPhaseSpaces = active.size();
+        for( uint32_t i = 0; i < active.size(); ++i )
+        {
+            phaseSpaces.sharedOffset[i] = sharedOffset[i];
+            container::DeviceBuffer<float_PS, 2>& dBuffer = *this->dBuffers[active[i]];
+            phaseSpaces.origin[i] = dBuffer.getDataPointer();
+            phaseSpaces.pitch[i] = dBuffer.getPitch()[0];
+            phaseSpaces.axis_element[i] = this->axis_element[active[i]];
+            phaseSpaces.axis_p_range[i] = this->axis_p_range[active[i]];
+        }
+
+        /* register particle species observer */
+        DataConnector &dc = Environment<>::get().DataConnector();
+        auto particles = dc.get< Species >( Species::FrameType::getName(), true );
+
+        /* select CORE + BORDER for all cells */
+        zone::SphericZone<simDim> zoneCoreBorder( coreBorderCells, guardCells );
+
+        algorithm::kernel::ForeachBlock<SuperCellSize> forEachSuperCell;
+
+        FunctorBlockSet<Species, SuperCellSize, Set, num_pbins, numSharedBins> functorBlock(
+            particles->getDeviceParticlesBox(), phaseSpaces );
+
+        forEachSuperCell( /* area to work on */
+                          zoneCoreBorder,
+                          /* data below - passed to functor operator() */
+                          cursor::make_MultiIndexCursor<simDim>(),
+                          functorBlock
+                        );
+
+        dc.releaseData( Species::FrameType::getName() );
+    }
+
+    template<class AssignmentFunction, class Species>
+    void PhaseSpaceCombined<AssignmentFunction, Species>::notify( uint32_t currentStep )
+    {
+        std::vector<uint32_t> active;
+        for( uint32_t i = 0; i < this->notifyPeriod.size(); ++i )
+            if( this->notifyPeriod[i] != 0 && currentStep % this->notifyPeriod[i] == 0 )
+                active.push_back( i );
+        if( active.empty() )
+            return;
+
+        /* reset device buffers */
+        for( uint32_t i = 0; i < active.size(); ++i )
+            this->dBuffers[active[i]]->assign( float_PS(0.0) );
+
+        /* calculate all local phase spaces with one pass over the particles */
+        calcPhaseSpaces( active );
+
+        /* write to file */
+        const float_64 UNIT_VOLUME = math::pow( UNIT_LENGTH, (int)simDim );
+        const float_64 unit = UNIT_CHARGE / UNIT_VOLUME;
+
+        /* (momentum) p range: unit is m_species * c
+         * \see PhaseSpace::notify */
+        float_64 pRange_unit = float_64( frame::getMass<typename Species::FrameType>() ) *
+                               float_64( SPEED_OF_LIGHT ) *
+                               UNIT_MASS * UNIT_SPEED;
+
+        for( uint32_t d = 0; d < simDim; ++d )
+        {
+            std::vector<uint32_t> inPlane;
+            for( uint32_t i = 0; i < active.size(); ++i )
+                if( this->axis_element[active[i]].space == d )
+                    inPlane.push_back( active[i] );
+            if( inPlane.empty() )
+                continue;
+
+            /* transfer to host, concatenated in spatial direction */
+            const PMacc::math::Size_t<2> size = this->dBuffers[inPlane.front()]->size();
+            container::HostBuffer<float_PS, 2> hBuffer(
+                PMacc::math::Size_t<2>( size.x(), size.y() * inPlane.size() ) );
+            std::vector<AxisDescription> elements;
+            std::vector<std::pair<float_X, float_X> > p_ranges;
+            for( uint32_t i = 0; i < inPlane.size(); ++i )
+            {
+                container::HostBuffer<float_PS, 2> hSingle( size );
+                hSingle = *this->dBuffers[inPlane[i]];
+                for( size_t r = 0; r < size.y(); ++r )
+                    std::copy( &(*hSingle.origin()( 0, r )),
+                               &(*hSingle.origin()( 0, r )) + size.x(),
+                               &(*hBuffer.origin()( 0, i * size.y() + r )) );
+
+                elements.push_back( this->axis_element[inPlane[i]] );
+                p_ranges.push_back( this->axis_p_range[inPlane[i]] );
+            }
+
+            /* reduce-add all phase spaces of this spatial axis with one call
+             * \see PhaseSpace::notify */
+            using namespace lambda;
+            container::HostBuffer<float_PS, 2> hReducedBuffer( hBuffer.size() );
+            hReducedBuffer.assign( float_PS(0.0) );
+
+            this->planes[d].planeReduce->template operator()( /* parameters: dest, source */
+                                 hReducedBuffer,
+                                 hBuffer,
+                                 /* the functors return value will be written to dst */
+                                 _1 + _2 );
+
+            /** all non-reduce-root processes are done with this axis */
+            if( !this->planes[d].isPlaneReduceRoot )
+                continue;
+
+            DumpHBuffer dumpHBuffer;
+
+            if( this->planes[d].commFileWriter != MPI_COMM_NULL )
+                dumpHBuffer( hReducedBuffer, elements,
+                             p_ranges, pRange_unit,
+                             unit, Species::FrameType::getName(),
+                             currentStep, this->planes[d].commFileWriter );
+        }
+    }
+
+    template<class AssignmentFunction, class Species>
+    void PhaseSpaceCombined<AssignmentFunction, Species>::setMappingDescription(
+        MappingDesc* cellDescription )
+    {
+        this->cellDescription = cellDescription;
+    }
+
+} /* namespace picongpu */
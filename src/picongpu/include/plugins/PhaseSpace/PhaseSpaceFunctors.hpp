@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Richard Pausch
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Richard Pausch,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -26,10 +27,15 @@
 #include "cuSTL/algorithm/kernel/ForeachBlock.hpp"
 #include "cuSTL/container/compile-time/SharedBuffer.hpp"
 #include "math/Vector.hpp"
+#include "memory/Array.hpp"
+#include "memory/shared/Allocate.hpp"
+#include "dimensions/DataSpaceOperations.hpp"
 #include "math/VectorOperations.hpp"
 #include "particles/access/Cell2Particle.hpp"
 
 #include "PhaseSpace.hpp"
+#include "AxisDescription.hpp"
+#include "MomentumBinning.hpp"
 
 namespace picongpu
 {
@@ -51,6 +57,38 @@ namespace picongpu
         }
     };
 
+    /** Binning of a particle in a phase space
+     *
+     * Used by all phase space paths, so a particle is always deposited with
+     * the same value into the same bin.
+     *
+     * \tparam num_pbins number of bins in momentum space \see PhaseSpace.hpp
+     */
+    template<uint32_t num_pbins>
+    struct PhaseSpaceBinning
+    {
+        /** momentum bin, out-of-range momenta are put into the first/last bin
+         *
+         * \param mom momentum component of the particle
+         * \param axis_p_range range of the momentum coordinate \see PhaseSpace::axis_p_range
+         */
+        HDINLINE static int
+        getMomentumBin( const float_X mom, const std::pair<float_X, float_X>& axis_p_range )
+        {
+            return MomentumBinning<float_X>::getMomentumBin( mom, axis_p_range, int(num_pbins) );
+        }
+
+        /** charge density deposited by a particle */
+        template<typename float_PS, typename T_Particle>
+        HDINLINE static float_PS
+        getValue( T_Particle& particle )
+        {
+            const float_X weighting = particle[weighting_];
+            const float_X charge    = attribute::getCharge( weighting,particle );
+            return precisionCast<float_PS>( charge / CELL_VOLUME );
+        }
+    };
+
     /** Functor called for each particle
      *
      * Every particle in a frame of particles will end up here.
@@ -93,20 +131,10 @@ namespace picongpu
                 PMacc::math::MapToPos<simDim>()( SuperCellSize(), linearCellIdx ) );
 
             const uint32_t r_bin    = cellIdx[r_dir];
-            const float_X weighting = particle[weighting_];
-            const float_X charge    = attribute::getCharge( weighting,particle );
             const float_PS particleChargeDensity =
-              precisionCast<float_PS>( charge / CELL_VOLUME );
-
-            const float_X rel_bin = (mom_i - axis_p_range.first)
-                                  / (axis_p_range.second - axis_p_range.first);
-            int p_bin = int( rel_bin * float_X(num_pbins) );
+              PhaseSpaceBinning<num_pbins>::template getValue<float_PS>( particle );
 
-            /* out-of-range bins back to min/max */
-            if( p_bin < 0 )
-                p_bin = 0;
-            if( p_bin >= num_pbins )
-                p_bin = num_pbins - 1;
+            const int p_bin = PhaseSpaceBinning<num_pbins>::getMomentumBin( mom_i, axis_p_range );
 
             /** \todo take particle shape into account */
             atomicAddWrapper( &(*curDBufferOriginInBlock( p_bin, r_bin )),
@@ -206,4 +234,172 @@ namespace picongpu
         }
     };
 
+    /** Phase spaces of a species which are binned with one particle pass
+     *
+     * \tparam float_PS type for each bin in the phase space
+     * \tparam T_maxPhaseSpaces maximum number of phase spaces
+     */
+    template<typename float_PS, uint32_t T_maxPhaseSpaces>
+    struct PhaseSpaceSet
+    {
+        typedef float_PS ValueType;
+        static constexpr uint32_t maxPhaseSpaces = T_maxPhaseSpaces;
+
+        uint32_t numPhaseSpaces;
+        /** first bin (momentum bin 0, spatial bin 0 including GUARD) */
+        float_PS* origin[T_maxPhaseSpaces];
+        /** bytes between two spatial bins */
+        size_t pitch[T_maxPhaseSpaces];
+        AxisDescription axis_element[T_maxPhaseSpaces];
+        std::pair<float_X, float_X> axis_p_range[T_maxPhaseSpaces];
+        /** first bin of the block snippet in shared memory, -1: binned into
+         *  global memory directly \see PMacc::algorithms::histogram::placeSharedBins */
+        int sharedOffset[T_maxPhaseSpaces];
+    };
+
+    /** Functor called for each particle, bins it into all phase spaces of a set
+     *
+     * As FunctorParticle, a phase space with a snippet in shared memory is
+     * binned there (momentum bin + num_pbins * spatial bin in the block).
+     * Phase spaces without a snippet are binned into global memory directly.
+     *
+     * \tparam num_pbins number of bins in momentum space \see PhaseSpace.hpp
+     * \tparam SuperCellSize how many cells form a super cell \see memory.param
+     */
+    template<uint32_t num_pbins, typename SuperCellSize>
+    struct FunctorParticleSet
+    {
+        typedef void result_type;
+
+        /** Functor implementation
+         *
+         * \param frame current frame for this block
+         * \param particleID id of the particle in the current frame
+         * \param phaseSpaces phase spaces to bin the particle into
+         * \param indexBlockOffset cell index of the first cell of the block (including GUARD)
+         * \param sharedBins snippets of the phase spaces in shared memory
+         */
+        template<typename FramePtr, typename T_PhaseSpaceSet, typename float_PS>
+        DINLINE void
+        operator()( FramePtr frame,
+                    uint16_t particleID,
+                    const T_PhaseSpaceSet& phaseSpaces,
+                    const PMacc::math::Int<simDim>& indexBlockOffset,
+                    float_PS* sharedBins )
+        {
+            auto particle = frame[particleID];
+            const float3_X mom = particle[momentum_];
+
+            /* cell id in this block */
+            const int linearCellIdx = particle[localCellIdx_];
+            const PMacc::math::UInt32<simDim> cellIdx(
+                PMacc::math::MapToPos<simDim>()( SuperCellSize(), linearCellIdx ) );
+
+            const float_PS particleChargeDensity =
+              PhaseSpaceBinning<num_pbins>::template getValue<float_PS>( particle );
+
+            for( uint32_t i = 0; i < phaseSpaces.numPhaseSpaces; ++i )
+            {
+                const uint32_t r_dir = phaseSpaces.axis_element[i].space;
+                const int p_bin = PhaseSpaceBinning<num_pbins>::getMomentumBin(
+                    mom[phaseSpaces.axis_element[i].momentum], phaseSpaces.axis_p_range[i] );
+
+                if( phaseSpaces.sharedOffset[i] >= 0 )
+                {
+                    atomicAddWrapper( sharedBins + phaseSpaces.sharedOffset[i] + cellIdx[r_dir] * num_pbins + p_bin,
+                                      particleChargeDensity );
+                    continue;
+                }
+
+                const uint32_t r_bin = indexBlockOffset[r_dir] + cellIdx[r_dir];
+                float_PS* row = reinterpret_cast<float_PS*>(
+                    reinterpret_cast<char*>( phaseSpaces.origin[i] ) + r_bin * phaseSpaces.pitch[i] );
+                atomicAddWrapper( row + p_bin, particleChargeDensity );
+            }
+        }
+    };
+
+    /** Functor to Run For Each SuperCell, bins all phase spaces of a set
+     *
+     * The snippets of the phase spaces with a shared offset are reduced in
+     * shared memory and added to global memory at the end of the block, as
+     * in FunctorBlock.
+     *
+     * \tparam Species the particle species to create the phase spaces for
+     * \tparam SuperCellSize how many cells form a super cell \see memory.param
+     * \tparam T_PhaseSpaceSet \see PhaseSpaceSet
+     * \tparam num_pbins number of bins in momentum space \see PhaseSpace.hpp
+     * \tparam T_numSharedBins number of bins in shared memory
+     */
+    template<typename Species, typename SuperCellSize, typename T_PhaseSpaceSet, uint32_t num_pbins, uint32_t T_numSharedBins>
+    struct FunctorBlockSet
+    {
+        typedef void result_type;
+
+        typedef typename Species::ParticlesBoxType TParticlesBox;
+        typedef typename T_PhaseSpaceSet::ValueType float_PS;
+
+        TParticlesBox particlesBox;
+        T_PhaseSpaceSet phaseSpaces;
+
+        HDINLINE
+        FunctorBlockSet( const TParticlesBox& pb,
+                         const T_PhaseSpaceSet& set ) :
+        particlesBox(pb), phaseSpaces(set)
+        {}
+
+        /** Called for the first cell of each block #-of-cells-in-block times
+         *
+         * \param indexBlockOffset cell index in global memory, describes where
+         *                         the current block starts
+         *                         \see cuSTL/algorithm/kernel/ForeachBlock.hpp
+         */
+        DINLINE void
+        operator()( const PMacc::math::Int<simDim>& indexBlockOffset )
+        {
+            const int threads = PMacc::math::CT::volume<SuperCellSize>::type::value;
+            const DataSpace<simDim> threadIndex( threadIdx );
+            const int linearThreadIdx = DataSpaceOperations<simDim>::template map<SuperCellSize>( threadIndex );
+
+            PMACC_SMEM( sharedBins, memory::Array< float_PS, T_numSharedBins > );
+
+            /* init shared mem */
+            for( int i = linearThreadIdx; i < int(T_numSharedBins); i += threads )
+                sharedBins[i] = float_PS(0.0);
+            __syncthreads();
+
+            FunctorParticleSet<num_pbins, SuperCellSize> functorParticle;
+            particleAccess::Cell2Particle<SuperCellSize> forEachParticleInCell;
+            forEachParticleInCell( /* mandatory params */
+                                   particlesBox, indexBlockOffset, functorParticle,
+                                   /* optional params */
+                                   phaseSpaces,
+                                   indexBlockOffset,
+                                   &(sharedBins[0])
+                                 );
+
+            __syncthreads();
+            /* add the shared snippets to the global phase spaces */
+            for( uint32_t ps = 0; ps < phaseSpaces.numPhaseSpaces; ++ps )
+            {
+                if( phaseSpaces.sharedOffset[ps] < 0 )
+                    continue;
+
+                const uint32_t r_dir = phaseSpaces.axis_element[ps].space;
+                const int numBins = int(num_pbins) * SuperCellSize().toRT()[r_dir];
+                for( int i = linearThreadIdx; i < numBins; i += threads )
+                {
+                    const float_PS value = sharedBins[phaseSpaces.sharedOffset[ps] + i];
+                    if( value == float_PS(0.0) )
+                        continue;
+
+                    const uint32_t r_bin = indexBlockOffset[r_dir] + i / num_pbins;
+                    float_PS* row = reinterpret_cast<float_PS*>(
+                        reinterpret_cast<char*>( phaseSpaces.origin[ps] ) + r_bin * phaseSpaces.pitch[ps] );
+                    atomicAddWrapper( row + i % num_pbins, value );
+                }
+            }
+        }
+    };
+
 } // namespace picongpu
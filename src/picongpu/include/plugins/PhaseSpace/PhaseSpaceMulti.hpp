@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl
+/* Copyright 2013-2017 Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -24,6 +24,7 @@
 
 #include "plugins/PhaseSpace/AxisDescription.hpp"
 #include "plugins/PhaseSpace/PhaseSpace.hpp"
+#include "plugins/PhaseSpace/PhaseSpaceCombined.hpp"
 
 #include <boost/program_options/options_description.hpp>
 
@@ -65,6 +66,10 @@ namespace picongpu
         std::vector<Child* > children;
         size_t numChildren;
 
+        /** bin all phase spaces with one particle pass \see PhaseSpaceCombined */
+        bool combined;
+        PhaseSpaceCombined<AssignmentFunction, Species>* combinedChild;
+
         void pluginLoad();
         void pluginUnload();
 
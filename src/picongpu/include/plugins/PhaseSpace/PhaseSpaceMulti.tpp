@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl
+/* Copyright 2013-2017 Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -33,7 +33,9 @@ namespace picongpu
         name("PhaseSpaceMulti: create phase space of a species"),
         prefix(Species::FrameType::getName() + std::string("_phaseSpace")),
         numChildren(0u),
-        cellDescription(nullptr)
+        cellDescription(nullptr),
+        combined(false),
+        combinedChild(nullptr)
     {
         /* register our plugin during creation */
         Environment<>::get().PluginConnector().registerPlugin(this);
@@ -52,7 +54,9 @@ namespace picongpu
             ((this->prefix + ".min").c_str(),
               po::value<std::vector<float_X> > (&this->momentum_range_min)->multitoken(), "min range momentum [m_species c]")
             ((this->prefix + ".max").c_str(),
-              po::value<std::vector<float_X> > (&this->momentum_range_max)->multitoken(), "max range momentum [m_species c]");
+              po::value<std::vector<float_X> > (&this->momentum_range_max)->multitoken(), "max range momentum [m_species c]")
+            ((this->prefix + ".combined").c_str(), po::bool_switch(&this->combined),
+              "bin all phase spaces with one pass over the particles, one file per spatial axis");
     }
 
     template<class AssignmentFunction, class Species>
@@ -64,6 +68,9 @@ namespace picongpu
             return;
 
         this->children.reserve( this->numChildren );
+        std::vector<uint32_t> combinedPeriod;
+        std::vector<std::pair<float_X, float_X> > combined_p_range;
+        std::vector<AxisDescription> combinedElements;
         for(uint32_t i = 0; i < this->numChildren; i++)
         {
             /* unit is m_species c - we use the typical weighting already since
@@ -110,6 +117,12 @@ namespace picongpu
                           << this->element_space.at(i)
                           << this->element_momentum.at(i)
                           << std::endl;
+            else if( this->combined )
+            {
+                combinedPeriod.push_back( this->notifyPeriod.at(i) );
+                combined_p_range.push_back( new_p_range );
+                combinedElements.push_back( new_elements );
+            }
             else
             {
                 PhaseSpace<AssignmentFunction, Species>* newPS =
@@ -125,6 +138,16 @@ namespace picongpu
             }
         }
 
+        if( this->combined && !combinedElements.empty() )
+        {
+            this->combinedChild = new PhaseSpaceCombined<AssignmentFunction, Species>( this->prefix,
+                                                                                       combinedPeriod,
+                                                                                       combined_p_range,
+                                                                                       combinedElements );
+            this->combinedChild->setMappingDescription( this->cellDescription );
+            this->combinedChild->pluginLoad();
+        }
+
         /** create dir */
         Environment<simDim>::get().Filesystem().createDirectoryWithPermissions("phaseSpace");
     }
@@ -132,11 +155,17 @@ namespace picongpu
     template<class AssignmentFunction, class Species>
     void PhaseSpaceMulti<AssignmentFunction, Species>::pluginUnload( )
     {
-        for(uint32_t i = 0; i < this->numChildren; i++)
+        for(uint32_t i = 0; i < this->children.size(); i++)
         {
             this->children.at(i)->pluginUnload();
             __delete( this->children.at(i) );
         }
+
+        if( this->combinedChild != nullptr )
+        {
+            this->combinedChild->pluginUnload();
+            __delete( this->combinedChild );
+        }
     }
 
     template<class AssignmentFunction, class Species>
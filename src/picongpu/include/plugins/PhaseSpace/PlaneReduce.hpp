@@ -0,0 +1,156 @@
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <mpi.h>
+
+#include "simulation_defines.hpp"
+#include "communication/manager_common.hpp"
+#include "cuSTL/algorithm/mpi/Reduce.hpp"
+#include "cuSTL/zone/SphericZone.hpp"
+#include "math/vector/Int.hpp"
+#include "math/vector/Size_t.hpp"
+#include "mappings/simulation/GridController.hpp"
+
+#include <vector>
+#include <algorithm>
+
+
+namespace picongpu
+{
+    using namespace PMacc;
+
+    /** reduce of phase spaces with the same spatial axis
+     *
+     * All GPUs with the same position along the spatial axis form a plane,
+     * the phase spaces are reduce-added to the "lowest" GPU of each plane.
+     * The plane roots form the communicator for the file output.
+     */
+    class PlaneReduce
+    {
+    public:
+        /** reduce functor to a single host per plane */
+        PMacc::algorithm::mpi::Reduce<simDim>* planeReduce;
+        bool isPlaneReduceRoot;
+        /** MPI communicator that contains the root ranks of the \p planeReduce
+         */
+        MPI_Comm commFileWriter;
+
+        PlaneReduce() :
+            planeReduce(nullptr), isPlaneReduceRoot(false), commFileWriter(MPI_COMM_NULL)
+        {
+        }
+
+        /** create the reduce and the communicator (collective over all ranks)
+         *
+         * \param space spatial axis \see AxisDescription::element_coordinate
+         */
+        void init( const uint32_t space )
+        {
+            /* reduce-add phase space from other GPUs in range [p0;p1]x[r;r+dr]
+             * to "lowest" node in range
+             * e.g.: phase space x-py: reduce-add all nodes with same x range in
+             *                         spatial y and z direction to node with
+             *                         lowest y and z position and same x range
+             */
+            PMacc::GridController<simDim>& gc = PMacc::Environment<simDim>::get().GridController();
+            PMacc::math::Size_t<simDim> gpuDim = gc.getGpuNodes();
+            PMacc::math::Int<simDim> gpuPos = gc.getPosition();
+
+            /* my plane means: the r_element I am calculating should be 1GPU in width */
+            PMacc::math::Size_t<simDim> sizeTransversalPlane(gpuDim);
+            sizeTransversalPlane[space] = 1;
+
+            for( int planePos = 0; planePos <= (int)gpuDim[space]; ++planePos )
+            {
+                /* my plane means: the offset for the transversal plane to my r_element
+                 * should be zero
+                 */
+                PMacc::math::Int<simDim> longOffset(PMacc::math::Int<simDim>::create(0));
+                longOffset[space] = planePos;
+
+                zone::SphericZone<simDim> zoneTransversalPlane( sizeTransversalPlane, longOffset );
+
+                /* Am I the lowest GPU in my plane? */
+                bool isGroupRoot = false;
+                bool isInGroup   = ( gpuPos[space] == planePos );
+                if( isInGroup )
+                {
+                    PMacc::math::Int<simDim> inPlaneGPU(gpuPos);
+                    inPlaneGPU[space] = 0;
+                    if( inPlaneGPU == PMacc::math::Int<simDim>::create(0) )
+                        isGroupRoot = true;
+                }
+
+                algorithm::mpi::Reduce<simDim>* createReduce =
+                    new algorithm::mpi::Reduce<simDim>( zoneTransversalPlane,
+                                                        isGroupRoot );
+                if( isInGroup )
+                {
+                    this->planeReduce = createReduce;
+                    this->isPlaneReduceRoot = isGroupRoot;
+                }
+                else
+                    __delete( createReduce );
+            }
+
+            /* Create communicator with ranks of each plane reduce root */
+            {
+                /* Array with root ranks of the planeReduce operations */
+                std::vector<int> planeReduceRootRanks( gc.getGlobalSize(), -1 );
+                /* Am I one of the planeReduce root ranks? my global rank : -1 */
+                int myRootRank = gc.getGlobalRank() * this->isPlaneReduceRoot
+                               - ( ! this->isPlaneReduceRoot );
+
+                /* the global rank is the rank in the communicator of the grid */
+                MPI_Comm gridComm = gc.getCommunicator().getMPIComm();
+                MPI_Group world_group, new_group;
+                MPI_CHECK(MPI_Allgather( &myRootRank, 1, MPI_INT,
+                                         &(planeReduceRootRanks.front()),
+                                         1,
+                                         MPI_INT,
+                                         gridComm ));
+
+                /* remove all non-roots (-1 values) */
+                std::sort( planeReduceRootRanks.begin(), planeReduceRootRanks.end() );
+                std::vector<int> ranks( std::lower_bound( planeReduceRootRanks.begin(),
+                                                          planeReduceRootRanks.end(),
+                                                          0 ),
+                                        planeReduceRootRanks.end() );
+
+                MPI_CHECK(MPI_Comm_group( gridComm, &world_group ));
+                MPI_CHECK(MPI_Group_incl( world_group, ranks.size(), ranks.data(), &new_group ));
+                MPI_CHECK(MPI_Comm_create( gridComm, new_group, &commFileWriter ));
+                MPI_CHECK(MPI_Group_free( &new_group ));
+                MPI_CHECK(MPI_Group_free( &world_group ));
+            }
+        }
+
+        void free()
+        {
+            __delete( planeReduce );
+
+            if( commFileWriter != MPI_COMM_NULL )
+                MPI_CHECK(MPI_Comm_free( &commFileWriter ));
+        }
+    };
+
+} /* namespace picongpu */
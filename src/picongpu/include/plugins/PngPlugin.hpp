@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Axel Huebl, Rene Widera, Benjamin Worpitz,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -29,6 +30,7 @@
 #include "simulation_classTypes.hpp"
 #include "plugins/ILightweightPlugin.hpp"
 #include "simulationControl/MovingWindow.hpp"
+#include "plugins/output/images/VisualisationBatch.hpp"
 
 #include <vector>
 #include <list>
@@ -49,11 +51,14 @@ namespace picongpu
 
         typedef VisClass VisType;
         typedef std::list<VisType*> VisPointerList;
+        typedef VisualisationBatch<typename VisType::SpeciesType, typename VisType::CreatorType> BatchType;
 
         PngPlugin() :
         pluginName("PngPlugin: create png's of a species and fields"),
         pluginPrefix(VisType::FrameType::getName() + "_" + VisClass::CreatorType::getName()),
-        cellDescription(nullptr)
+        cellDescription(nullptr),
+        batched(false),
+        batch(nullptr)
         {
             Environment<>::get().PluginConnector().registerPlugin(this);
         }
@@ -75,7 +80,8 @@ namespace picongpu
                     ((pluginPrefix + ".period").c_str(), po::value<std::vector<uint32_t> > (&notifyFrequencys)->multitoken(), "enable data output [for each n-th step]")
                     ((pluginPrefix + ".axis").c_str(), po::value<std::vector<std::string > > (&axis)->multitoken(), "axis which are shown [valid values x,y,z] example: yz")
                     ((pluginPrefix + ".slicePoint").c_str(), po::value<std::vector<float_32> > (&slicePoints)->multitoken(), "value range: 0 <= x <= 1 , point of the slice")
-                    ((pluginPrefix + ".folder").c_str(), po::value<std::vector<std::string> > (&folders)->multitoken(), "folder for output files");
+                    ((pluginPrefix + ".folder").c_str(), po::value<std::vector<std::string> > (&folders)->multitoken(), "folder for output files")
+                    ((pluginPrefix + ".batched").c_str(), po::bool_switch(&batched), "render all slices due in a step with one pass over fields and particles");
 #else
             desc.add_options()
                     ((pluginPrefix).c_str(), "plugin disabled [compiled without dependency PNGwriter]");
@@ -95,6 +101,9 @@ namespace picongpu
 
             if (0 != notifyFrequencys.size())
             {
+                if (batched)
+                    batch = new BatchType();
+
                 if (0 != slicePoints.size() &&
                     0 != axis.size())
                 {
@@ -133,7 +142,9 @@ namespace picongpu
                                  */
                                 const bool isAllowedMovingWindowSlice=!isSlidingWindowActive ||
                                                                       (transpose.x()==1 || transpose.y()==1);
-                                if( isAllowed2DSlice && isAllowedMovingWindowSlice )
+                                if( isAllowed2DSlice && isAllowedMovingWindowSlice && batched )
+                                    batch->addSlice(pngCreator, frequ, transpose, getValue(slicePoints, i));
+                                else if( isAllowed2DSlice && isAllowedMovingWindowSlice )
                                 {
                                     VisType* tmp = new VisType(pluginName, pngCreator, frequ, transpose, getValue(slicePoints, i));
                                     visIO.push_back(tmp);
@@ -159,6 +170,12 @@ namespace picongpu
                 {
                     throw std::runtime_error("[Png Plugin] One parameter is missing");
                 }
+
+                if (batched)
+                {
+                    batch->setMappingDescription(cellDescription);
+                    batch->init();
+                }
             }
         }
 
@@ -171,6 +188,7 @@ namespace picongpu
                 __delete(*iter);
             }
             visIO.clear();
+            __delete(batch);
         }
 
         void notify(uint32_t currentStep)
@@ -214,6 +232,10 @@ namespace picongpu
 
         MappingDesc* cellDescription;
 
+        /* render all slices with one BatchType instead of one VisType per slice */
+        bool batched;
+        BatchType* batch;
+
     };
 
 }//namespace
@@ -1,5 +1,5 @@
 /* Copyright 2014-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
- *                     Benjamin Worpitz, Alexander Grund
+ *                     Benjamin Worpitz, Alexander Grund, agent
  *
  * This file is part of PIConGPU.
  *
@@ -269,6 +269,87 @@ private:
 
     };
 
+    /** Calculate several FieldTmp slots with one fused solver and particle
+     * species and write them to adios.
+     *
+     * All attributes of the solver are deposited with one pass over the
+     * particles, each attribute is written as its own variable.
+     */
+    template< typename Solver, typename Species >
+    struct GetFields<FieldTmpOperations<Solver, Species> >
+    {
+        /* see GetFields<FieldTmpOperation<...> > */
+        PMACC_NO_NVCC_HDWARNING
+        HDINLINE void operator()(ThreadParams* tparam)
+        {
+            this->operator_impl(tparam);
+        }
+    private:
+        typedef typename FieldTmp::ValueType ValueType;
+        typedef typename GetComponentsType<ValueType>::type ComponentType;
+
+        /** Create a name for the adios identifier of an attribute.
+         */
+        static std::string getName(const uint32_t attributeIdx)
+        {
+            std::stringstream str;
+            str << Species::FrameType::getName();
+            str << "_";
+            str << Solver().getName(attributeIdx);
+            return str.str();
+        }
+
+        HINLINE void operator_impl(ThreadParams* params)
+        {
+            DataConnector &dc = Environment<>::get().DataConnector();
+
+            /*## update fields ##*/
+
+            /*load FieldTmp slots without copy data to host*/
+            PMACC_CASSERT_MSG(
+                _please_allocate_one_FieldTmp_per_attribute_in_memory_param,
+                fieldTmpNumSlots >= Solver::numAttributes
+            );
+            std::vector< std::shared_ptr< FieldTmp > > fieldTmps;
+            for( uint32_t i = 0; i < Solver::numAttributes; ++i )
+            {
+                fieldTmps.push_back( dc.get< FieldTmp >( FieldTmp::getUniqueId( i ), true ) );
+                fieldTmps.back()->getGridBuffer().getDeviceBuffer().setValue(ValueType::create(0.0));
+            }
+            /*load particle without copy particle data to host*/
+            auto speciesTmp = dc.get< Species >( Species::FrameType::getName(), true );
+
+            /*run algorithm*/
+            FieldTmp::template computeValues< CORE + BORDER, Solver >(*speciesTmp, params->currentStep, fieldTmps);
+
+            EventTask fieldTmpEvent = FieldTmp::asyncCommunication(fieldTmps, __getTransactionEvent());
+            __setTransactionEvent(fieldTmpEvent);
+            dc.releaseData(Species::FrameType::getName());
+            /*## finish update fields ##*/
+
+            const uint32_t components = GetNComponents<ValueType>::value;
+            PICToAdios<ComponentType> adiosType;
+
+            for( uint32_t i = 0; i < Solver::numAttributes; ++i )
+            {
+                /* copy data to host that we can write same to disk*/
+                fieldTmps[i]->getGridBuffer().deviceToHost();
+
+                params->gridLayout = fieldTmps[i]->getGridLayout();
+                /*write data to ADIOS file*/
+                ADIOSWriter::template writeField<ComponentType>(params,
+                           sizeof(ComponentType),
+                           adiosType.type,
+                           components,
+                           getName(i),
+                           fieldTmps[i]->getHostDataBox().getPointer());
+
+                dc.releaseData( FieldTmp::getUniqueId( i ) );
+            }
+        }
+
+    };
+
     static void defineFieldVar(ThreadParams* params,
         uint32_t nComponents, ADIOS_DATATYPES adiosType, const std::string name,
         std::vector<float_64> unit, std::vector<float_64> unitDimension,
@@ -521,6 +602,80 @@ private:
 
     };
 
+    /**
+     * Collect field sizes to set adios group size.
+     * Specialization for several FieldTmp slots.
+     */
+    template< typename Solver, typename Species >
+    struct CollectFieldsSizes<FieldTmpOperations<Solver, Species> >
+    {
+    public:
+
+        PMACC_NO_NVCC_HDWARNING
+        HDINLINE void operator()(ThreadParams* tparam)
+        {
+            this->operator_impl(tparam);
+        }
+
+   private:
+        typedef typename FieldTmp::ValueType ValueType;
+        typedef typename FieldTmp::UnitValueType UnitType;
+        typedef typename GetComponentsType<ValueType>::type ComponentType;
+
+        /** Create a name for the adios identifier of an attribute.
+         */
+        static std::string getName(const uint32_t attributeIdx)
+        {
+            std::stringstream str;
+            str << Solver().getName(attributeIdx);
+            str << "_";
+            str << Species::FrameType::getName();
+            return str.str();
+        }
+
+        /** Get the unit for an attribute from the solver*/
+        static std::vector<float_64> getUnit(const uint32_t attributeIdx)
+        {
+            UnitType unit = Solver().getUnit(attributeIdx);
+            const uint32_t components = GetNComponents<ValueType>::value;
+            return createUnit(unit, components);
+        }
+
+        HINLINE void operator_impl(ThreadParams* params)
+        {
+            const uint32_t components = GetNComponents<ValueType>::value;
+
+            // adios buffer size for all attributes (all components)
+            uint64_t localGroupSize =
+                    params->window.localDimensions.size.productOfComponents() *
+                    sizeof(ComponentType) *
+                    components *
+                    Solver::numAttributes;
+
+            params->adiosGroupSize += localGroupSize;
+
+            /*wrap in a one-component vector for writeField API*/
+            const fieldSolver::numericalCellType::traits::FieldPosition<FieldTmp>
+                fieldPos;
+
+            std::vector<std::vector<float_X> > inCellPosition;
+            std::vector<float_X> inCellPositonComponent;
+            for( uint32_t d = 0; d < simDim; ++d )
+                inCellPositonComponent.push_back( fieldPos()[0][d] );
+            inCellPosition.push_back( inCellPositonComponent );
+
+            /** \todo check if always correct at this point, depends on solver
+             *        implementation */
+            const float_X timeOffset = 0.0;
+
+            PICToAdios<ComponentType> adiosType;
+            for( uint32_t i = 0; i < Solver::numAttributes; ++i )
+                defineFieldVar(params, components, adiosType.type, getName(i), getUnit(i),
+                    Solver().getUnitDimension(i), inCellPosition, timeOffset);
+        }
+
+    };
+
 public:
 
     ADIOSWriter() :
@@ -743,8 +898,6 @@ private:
         /* Finalize adios library */
         ADIOS_CMD(adios_finalize(Environment<simDim>::get().GridController()
                 .getCommunicator().getRank()));
-
-        __deleteArray(mThreadParams.fieldBfr);
     }
 
     void beginAdios(const std::string adiosFilename)
@@ -755,8 +908,6 @@ private:
         mThreadParams.fullFilename = full_filename.str();
         mThreadParams.adiosFileHandle = ADIOS_INVALID_HANDLE;
 
-        mThreadParams.fieldBfr = new float_X[mThreadParams.window.localDimensions.size.productOfComponents()];
-
         std::stringstream adiosPathBase;
         adiosPathBase << ADIOS_PATH_ROOT << mThreadParams.currentStep << "/";
         mThreadParams.adiosBasePath = adiosPathBase.str();
@@ -915,47 +1066,29 @@ private:
         DataSpace<simDim> field_no_guard = params->window.localDimensions.size;
         DataSpace<simDim> field_guard = field_layout.getGuard() + params->localWindowToDomainOffset;
 
+        /* split the components of the cells without guard into contiguous buffers */
+        size_t fieldSize[3] = {1, 1, 1};
+        size_t fieldOffset[3] = {0, 0, 0};
+        size_t fieldNoGuardSize[3] = {1, 1, 1};
+        for (uint32_t d = 0; d < simDim; ++d)
+        {
+            fieldSize[d] = field_full[d];
+            fieldOffset[d] = field_guard[d];
+            fieldNoGuardSize[d] = field_no_guard[d];
+        }
+        params->fieldStaging.stage((float_X*)ptr, nComponents, fieldSize, fieldOffset, fieldNoGuardSize);
+
         /* write the actual field data */
         for (uint32_t d = 0; d < nComponents; d++)
         {
-            const size_t plane_full_size = field_full[1] * field_full[0] * nComponents;
-            const size_t plane_no_guard_size = field_no_guard[1] * field_no_guard[0];
-
-            /* copy strided data from source to temporary buffer
-             *
-             * \todo use d1Access as in `include/plugins/hdf5/writer/Field.hpp`
-             */
-            const int maxZ = simDim == DIM3 ? field_no_guard[2] : 1;
-            const int guardZ = simDim == DIM3 ? field_guard[2] : 0;
-            for (int z = 0; z < maxZ; ++z)
-            {
-                for (int y = 0; y < field_no_guard[1]; ++y)
-                {
-                    const size_t base_index_src =
-                                (z + guardZ) * plane_full_size +
-                                (y + field_guard[1]) * field_full[0] * nComponents;
-
-                    const size_t base_index_dst =
-                                z * plane_no_guard_size +
-                                y * field_no_guard[0];
-
-                    for (int x = 0; x < field_no_guard[0]; ++x)
-                    {
-                        size_t index_src = base_index_src + (x + field_guard[0]) * nComponents + d;
-                        size_t index_dst = base_index_dst + x;
-
-                        params->fieldBfr[index_dst] = ((float_X*)ptr)[index_src];
-                    }
-                }
-            }
-
             /* Write the actual field data. The id is on the front of the list. */
             if (params->adiosFieldVarIds.empty())
                 throw std::runtime_error("Cannot write field (var id list is empty)");
 
             int64_t adiosFieldVarId = *(params->adiosFieldVarIds.begin());
             params->adiosFieldVarIds.pop_front();
-            ADIOS_CMD(adios_write_byid(params->adiosFileHandle, adiosFieldVarId, params->fieldBfr));
+            ADIOS_CMD(adios_write_byid(params->adiosFileHandle, adiosFieldVarId,
+                                       params->fieldStaging.getComponent(d)));
         }
     }
 
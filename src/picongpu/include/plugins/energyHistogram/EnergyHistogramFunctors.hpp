@@ -0,0 +1,181 @@
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Richard Pausch,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "math/Vector.hpp"
+#include "algorithms/math.hpp"
+
+#include <cmath>
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+namespace energyHistogram
+{
+using namespace PMacc;
+namespace math = PMacc::algorithms::math;
+
+    /** moments which are accumulated per bin
+     *
+     * the histogram memory holds `numMoments` arrays with `numBins` elements
+     * one after another
+     */
+    struct Moment
+    {
+        enum
+        {
+            /* sum of the (normalized) weighting */
+            count = 0,
+            /* sum of weighting * energy */
+            energy = 1,
+            /* sum of weighting * energy^2 */
+            energySquared = 2
+        };
+    };
+
+    /** description of the bins of an energy or energy x angle histogram
+     *
+     * Energy axis: `numEnergyBins + 2` bins, bin zero collects all energies
+     * smaller than `minEnergy`, the last bin all energies larger than
+     * `maxEnergy`. The bins are linear or logarithmic spaced.
+     *
+     * Angle axis: angle between the momentum and the y-axis, `numAngleBins`
+     * bins linear spaced in `[0, maxAngle)`, particles with a larger angle
+     * are not counted.
+     *
+     * The index of a bin is `angleBin * (numEnergyBins + 2) + energyBin`.
+     *
+     * All methods can be used on the host and the device, thus a host
+     * reference of the histogram uses exactly the same binning.
+     *
+     * @tparam T_Float floating point type of the energies and momenta, float_X in the simulation
+     */
+    template<typename T_Float>
+    struct BinDescription
+    {
+        typedef T_Float float_T;
+        typedef PMacc::math::Vector<float_T, 3> float3_T;
+
+        int numEnergyBins;
+        int numAngleBins;
+        /* depending on `logScale` the linear or the log10 value of the energy in keV */
+        float_T minEnergy;
+        float_T maxEnergy;
+        bool logScale;
+        /* in radian */
+        float_T maxAngle;
+
+        BinDescription(
+            const int numEnergyBins,
+            const float_T minEnergy_keV,
+            const float_T maxEnergy_keV,
+            const bool logScale,
+            const int numAngleBins,
+            const float_T maxAngle
+        ) :
+            numEnergyBins(numEnergyBins),
+            numAngleBins(numAngleBins),
+            minEnergy(logScale ? math::log10(minEnergy_keV) : minEnergy_keV),
+            maxEnergy(logScale ? math::log10(maxEnergy_keV) : maxEnergy_keV),
+            logScale(logScale),
+            maxAngle(maxAngle)
+        {
+        }
+
+        /** number of energy bins including the two out-of-range bins */
+        HDINLINE int getNumRealEnergyBins() const
+        {
+            return numEnergyBins + 2;
+        }
+
+        /** number of bins of one moment */
+        HDINLINE int getNumBins() const
+        {
+            return getNumRealEnergyBins() * numAngleBins;
+        }
+
+        HDINLINE int getEnergyBin(const float_T energy_keV) const
+        {
+            /* zero and negative energies can not be represented in log scale */
+            if (logScale && energy_keV <= float_T(0.0))
+                return 0;
+
+            const float_T value = logScale ? math::log10(energy_keV) : energy_keV;
+
+            /* +1 move value from 1 to numBins+1 */
+            int binNumber = math::float2int_rd((value - minEnergy) /
+                (maxEnergy - minEnergy) * static_cast<float_T>(numEnergyBins)) + 1;
+
+            const int maxBin = numEnergyBins + 1;
+
+            /* all entries larger than maxEnergy go into bin maxBin */
+            binNumber = binNumber < maxBin ? binNumber : maxBin;
+
+            /* all entries smaller than minEnergy go into bin zero */
+            binNumber = binNumber > 0 ? binNumber : 0;
+            return binNumber;
+        }
+
+        /** @return angle bin or -1 if the angle is not in [0, maxAngle) */
+        HDINLINE int getAngleBin(const float3_T& mom) const
+        {
+            if (numAngleBins <= 1 && maxAngle >= float_T(M_PI))
+                return 0;
+
+            const float_T absMom = math::abs(mom);
+            if (absMom == float_T(0.0))
+                return 0;
+
+            float_T cosAngle = mom.y() / absMom;
+            cosAngle = cosAngle > float_T(1.0) ? float_T(1.0) : cosAngle;
+            cosAngle = cosAngle < float_T(-1.0) ? float_T(-1.0) : cosAngle;
+            const float_T angle = math::acos(cosAngle);
+            if (angle >= maxAngle)
+                return -1;
+
+            int angleBin = math::float2int_rd(angle / maxAngle * static_cast<float_T>(numAngleBins));
+            angleBin = angleBin < numAngleBins ? angleBin : numAngleBins - 1;
+            return angleBin;
+        }
+
+        /** @return bin index or -1 if the particle is out of the angle range */
+        HDINLINE int getBin(const float_T energy_keV, const float3_T& mom) const
+        {
+            const int angleBin = getAngleBin(mom);
+            if (angleBin < 0)
+                return -1;
+            return angleBin * getNumRealEnergyBins() + getEnergyBin(energy_keV);
+        }
+
+        /** lower edge of an energy bin in keV (bin in [1, numEnergyBins+1]) */
+        HINLINE double getLowerEnergyEdge(const int bin) const
+        {
+            const double value = double(minEnergy) +
+                double(maxEnergy - minEnergy) * double(bin - 1) / double(numEnergyBins);
+            return logScale ? std::pow(10.0, value) : value;
+        }
+    };
+
+} // namespace energyHistogram
+} // namespace picongpu
@@ -1,5 +1,5 @@
 /* Copyright 2014-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
- *                     Benjamin Worpitz
+ *                     Benjamin Worpitz, agent
  *
  * This file is part of PIConGPU.
  *
@@ -223,6 +223,113 @@ private:
 
 };
 
+/** Calculate several FieldTmp slots with one fused solver and particle
+ * species and write them to hdf5.
+ *
+ * All attributes of the solver are deposited with one pass over the
+ * particles, each attribute is written as its own record.
+ *
+ * @tparam Solver fused solver, e.g. particleToGrid::ComputeGridValuesPerFrame
+ * @tparam Species species/particles class
+ */
+template< typename Solver, typename Species >
+class WriteFields<FieldTmpOperations<Solver, Species> >
+{
+public:
+    /* see WriteFields<FieldTmpOperation<...> > */
+    PMACC_NO_NVCC_HDWARNING
+    HDINLINE void operator()(ThreadParams* tparam)
+    {
+        this->operator_impl(tparam);
+    }
+
+private:
+    typedef typename FieldTmp::ValueType ValueType;
+
+    /** Create a name for the hdf5 identifier of an attribute.
+     */
+    static std::string getName(const uint32_t attributeIdx)
+    {
+        std::stringstream str;
+        str << Species::FrameType::getName();
+        str << "_";
+        str << Solver().getName(attributeIdx);
+        return str.str();
+    }
+
+    /** Get the unit for an attribute from the solver*/
+    static std::vector<float_64> getUnit(const uint32_t attributeIdx)
+    {
+        typedef typename FieldTmp::UnitValueType UnitType;
+        UnitType unit = Solver().getUnit(attributeIdx);
+        const uint32_t components = GetNComponents<ValueType>::value;
+        return CreateUnit::createUnit(unit, components);
+    }
+
+    HINLINE void operator_impl(ThreadParams* params)
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+
+        /*## update fields ##*/
+
+        /*load FieldTmp slots without copy data to host*/
+        PMACC_CASSERT_MSG(
+            _please_allocate_one_FieldTmp_per_attribute_in_memory_param,
+            fieldTmpNumSlots >= Solver::numAttributes
+        );
+        std::vector< std::shared_ptr< FieldTmp > > fieldTmps;
+        for( uint32_t i = 0; i < Solver::numAttributes; ++i )
+        {
+            fieldTmps.push_back( dc.get< FieldTmp >( FieldTmp::getUniqueId( i ), true ) );
+            fieldTmps.back()->getGridBuffer().getDeviceBuffer().setValue(ValueType::create(0.0));
+        }
+        /*load particle without copy particle data to host*/
+        auto speciesTmp = dc.get< Species >( Species::FrameType::getName(), true );
+
+        /*run algorithm*/
+        FieldTmp::template computeValues< CORE + BORDER, Solver >(*speciesTmp, params->currentStep, fieldTmps);
+
+        EventTask fieldTmpEvent = FieldTmp::asyncCommunication(fieldTmps, __getTransactionEvent());
+        __setTransactionEvent(fieldTmpEvent);
+        dc.releaseData( Species::FrameType::getName() );
+        /*## finish update fields ##*/
+
+        /*wrap in a one-component vector for writeField API*/
+        const fieldSolver::numericalCellType::traits::FieldPosition<FieldTmp>
+            fieldPos;
+
+        std::vector<std::vector<float_X> > inCellPosition;
+        std::vector<float_X> inCellPositonComponent;
+        for( uint32_t d = 0; d < simDim; ++d )
+            inCellPositonComponent.push_back( fieldPos()[0][d] );
+        inCellPosition.push_back( inCellPositonComponent );
+
+        /** \todo check if always correct at this point, depends on solver
+         *        implementation */
+        const float_X timeOffset = 0.0;
+
+        for( uint32_t i = 0; i < Solver::numAttributes; ++i )
+        {
+            /* copy data to host that we can write same to disk*/
+            fieldTmps[i]->getGridBuffer().deviceToHost();
+
+            params->gridLayout = fieldTmps[i]->getGridLayout();
+            /*write data to HDF5 file*/
+            Field::writeField(params,
+                              getName(i),
+                              getUnit(i),
+                              Solver().getUnitDimension(i),
+                              inCellPosition,
+                              timeOffset,
+                              fieldTmps[i]->getHostDataBox(),
+                              ValueType());
+
+            dc.releaseData( FieldTmp::getUniqueId( i ) );
+        }
+    }
+
+};
+
 } //namspace hdf5
 
 } //namespace picongpu
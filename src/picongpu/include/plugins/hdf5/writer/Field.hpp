@@ -1,4 +1,5 @@
-/* Copyright 2014-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera
+/* Copyright 2014-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -25,9 +26,13 @@
 #include "traits/PICToSplash.hpp"
 #include "traits/GetComponentsType.hpp"
 #include "traits/GetNComponents.hpp"
+#include "memory/boxes/DataBoxDim1Access.hpp"
 #include "assert.hpp"
 
+#include <boost/type_traits/is_same.hpp>
+
 #include <string>
+#include <vector>
 
 namespace picongpu
 {
@@ -40,6 +45,78 @@ using namespace splash;
 
 struct Field
 {
+    /** contiguous buffers of the field components without guard
+     *
+     * float_X fields are split by the staging buffer of the writer, fields
+     * of other component types are copied element-wise into a temporary array
+     *
+     * @tparam T_isFloatX true if the component type is float_X
+     */
+    template<typename T_ComponentType, bool T_isFloatX = boost::is_same<T_ComponentType, float_X>::value>
+    struct ComponentBuffer
+    {
+        template<typename T_DataBoxType>
+        ComponentBuffer(ThreadParams* params, T_DataBoxType dataBox, const uint32_t nComponents,
+                        const DataSpace<simDim>& fieldFull, const DataSpace<simDim>& fieldGuard,
+                        const DataSpace<simDim>& fieldNoGuard)
+        {
+            size_t fieldSize[3] = {1, 1, 1};
+            size_t fieldOffset[3] = {0, 0, 0};
+            size_t fieldNoGuardSize[3] = {1, 1, 1};
+            for (uint32_t d = 0; d < simDim; ++d)
+            {
+                fieldSize[d] = fieldFull[d];
+                fieldOffset[d] = fieldGuard[d];
+                fieldNoGuardSize[d] = fieldNoGuard[d];
+            }
+            params->fieldStaging.stage(reinterpret_cast<const float_X*>(dataBox.getPointer()),
+                                       nComponents, fieldSize, fieldOffset, fieldNoGuardSize);
+            staging = &(params->fieldStaging);
+        }
+
+        template<typename T_DataBoxType>
+        const T_ComponentType* getComponent(T_DataBoxType, const uint32_t n)
+        {
+            return staging->getComponent(n);
+        }
+
+    private:
+        PMacc::memory::FieldStaging<float_X>* staging;
+    };
+
+    template<typename T_ComponentType>
+    struct ComponentBuffer<T_ComponentType, false>
+    {
+        template<typename T_DataBoxType>
+        ComponentBuffer(ThreadParams*, T_DataBoxType, const uint32_t,
+                        const DataSpace<simDim>&, const DataSpace<simDim>& fieldGuard,
+                        const DataSpace<simDim>& fieldNoGuard) :
+        guard(fieldGuard), noGuard(fieldNoGuard),
+        tmpArray(fieldNoGuard.productOfComponents())
+        {
+        }
+
+        /* copy data to temp array
+         * tmpArray has the size of the data without any offsets
+         */
+        template<typename T_DataBoxType>
+        const T_ComponentType* getComponent(T_DataBoxType dataBox, const uint32_t n)
+        {
+            typedef DataBoxDim1Access<T_DataBoxType > D1Box;
+            D1Box d1Access(dataBox.shift(guard), noGuard);
+
+            for (size_t i = 0; i < tmpArray.size(); ++i)
+            {
+                tmpArray[i] = d1Access[i][n];
+            }
+            return &(*tmpArray.begin());
+        }
+
+    private:
+        DataSpace<simDim> guard;
+        DataSpace<simDim> noGuard;
+        std::vector<T_ComponentType> tmpArray;
+    };
 
     /* \param inCellPosition std::vector<std::vector<float_X> > with the outer
      *                       vector for each component and the inner vector for
@@ -56,7 +133,6 @@ struct Field
                            const T_ValueType&
                            )
     {
-        typedef T_DataBoxType NativeDataBoxType;
         typedef T_ValueType ValueType;
         typedef typename GetComponentsType<ValueType>::type ComponentType;
         typedef typename PICToSplash<ComponentType>::type SplashType;
@@ -90,6 +166,7 @@ struct Field
 
         /*data to describe source buffer*/
         GridLayout<simDim> field_layout = params->gridLayout;
+        DataSpace<simDim> field_full = field_layout.getDataSpace();
         DataSpace<simDim> field_no_guard = params->window.localDimensions.size;
         DataSpace<simDim> field_guard = field_layout.getGuard() + params->localWindowToDomainOffset;
         /* globalSlideOffset due to gpu slides between origin at time step 0
@@ -115,22 +192,14 @@ struct Field
         splashGlobalOffsetFile[1] = std::max(0, localDomain.offset[1] -
                                              params->window.globalDimensions.offset[1]);
 
-        size_t tmpArraySize = field_no_guard.productOfComponents();
-        ComponentType* tmpArray = new ComponentType[tmpArraySize];
-
-        typedef DataBoxDim1Access<NativeDataBoxType > D1Box;
-        D1Box d1Access(dataBox.shift(field_guard), field_no_guard);
+        /* split the components of the cells without guard into contiguous buffers
+         * (the host buffer of a field is not pitched)
+         */
+        ComponentBuffer<ComponentType> componentBuffer(params, dataBox, nComponents,
+                                                       field_full, field_guard, field_no_guard);
 
         for (uint32_t n = 0; n < nComponents; n++)
         {
-            /* copy data to temp array
-             * tmpArray has the size of the data without any offsets
-             */
-            for (size_t i = 0; i < tmpArraySize; ++i)
-            {
-                tmpArray[i] = d1Access[i][n];
-            }
-
             std::stringstream datasetName;
             datasetName << recordName;
             if (nComponents > 1)
@@ -155,7 +224,7 @@ struct Field
                                                       splashGlobalDomainSize    /* size of the global domain */
                                                ),
                                                DomainCollector::GridType,
-                                               tmpArray);
+                                               componentBuffer.getComponent(dataBox, n));
 
             /* attributes */
             params->dataCollector->writeAttribute(params->currentStep,
@@ -168,7 +237,6 @@ struct Field
                                                   ctDouble, datasetName.str().c_str(),
                                                   "unitSI", &(unit.at(n)));
         }
-        __deleteArray(tmpArray);
 
 
         params->dataCollector->writeAttribute(params->currentStep,
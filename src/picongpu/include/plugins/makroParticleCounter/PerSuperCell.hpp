@@ -1,4 +1,4 @@
-/* Copyright 2014-2017 Rene Widera
+/* Copyright 2014-2017 Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -27,6 +27,7 @@
 
 #include "memory/buffers/GridBuffer.hpp"
 #include "memory/shared/Allocate.hpp"
+#include "nvidia/atomic.hpp"
 #include "dataManagement/DataConnector.hpp"
 
 #include <splash/splash.h>
@@ -35,6 +36,9 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+#include <utility>
 
 
 namespace picongpu
@@ -44,8 +48,14 @@ using namespace splash;
 
 struct CountMakroParticle
 {
+    /** count macro particles per supercell
+     *
+     * @param counterBox zero initialized counter, one element per block of
+     *                   supercells (no guarding supercells)
+     * @param blockSize number of supercells per element of counterBox
+     */
     template<class ParBox, class CounterBox, class Mapping>
-    DINLINE void operator()(ParBox parBox, CounterBox counterBox, Mapping mapper) const
+    DINLINE void operator()(ParBox parBox, CounterBox counterBox, DataSpace<simDim> blockSize, Mapping mapper) const
     {
 
         typedef MappingDesc::SuperCellSize SuperCellSize;
@@ -66,10 +76,6 @@ struct CountMakroParticle
         {
             counterValue = 0;
             frame = parBox.getLastFrame(block);
-            if (!frame.isValid())
-            {
-                counterBox(counterCell) = counterValue;
-            }
         }
         __syncthreads();
         if (!frame.isValid())
@@ -92,8 +98,142 @@ struct CountMakroParticle
             __syncthreads();
         }
 
+        /* several supercells can contribute to the same coarse cell */
         if (linearThreadIdx == 0)
-            counterBox(counterCell) = counterValue;
+            atomicAdd(&(counterBox(counterCell / blockSize)), counterValue);
+    }
+};
+
+/** update the running minimum, maximum and sum of each counter cell
+ *
+ * one thread per cell of the counter
+ */
+struct UpdateCountStatistics
+{
+    template<class CounterBox>
+    DINLINE void operator()(
+        CounterBox counterBox,
+        CounterBox minBox,
+        CounterBox maxBox,
+        CounterBox sumBox,
+        DataSpace<simDim> size,
+        uint32_t numCells,
+        bool isFirstSample
+    ) const
+    {
+        const uint32_t linearIdx = blockIdx.x * blockDim.x + threadIdx.x;
+        if (linearIdx >= numCells)
+            return;
+
+        const DataSpace<simDim> cell(DataSpaceOperations<simDim>::map(size, linearIdx));
+        const uint64_cu value = counterBox(cell);
+        if (isFirstSample)
+        {
+            minBox(cell) = value;
+            maxBox(cell) = value;
+            sumBox(cell) = value;
+        }
+        else
+        {
+            minBox(cell) = value < minBox(cell) ? value : minBox(cell);
+            maxBox(cell) = value > maxBox(cell) ? value : maxBox(cell);
+            sumBox(cell) += value;
+        }
+    }
+};
+
+/** compact all non-empty counter cells to a list of (index, count) pairs
+ *
+ * The order of the list is not deterministic.
+ * One thread per cell of the counter.
+ *
+ * @param numEntries zero initialized counter of the list entries
+ * @param globalOffset offset of the local counter in the global counter grid
+ * @param globalSize size of the global counter grid, the index is the linear
+ *                   index within the global grid (x is the fastest dimension)
+ */
+struct CompactCount
+{
+    template<class CounterBox, class ListBox>
+    DINLINE void operator()(
+        CounterBox counterBox,
+        ListBox indexBox,
+        ListBox countBox,
+        int* numEntries,
+        DataSpace<simDim> size,
+        uint32_t numCells,
+        DataSpace<simDim> globalOffset,
+        DataSpace<simDim> globalSize
+    ) const
+    {
+        const uint32_t linearIdx = blockIdx.x * blockDim.x + threadIdx.x;
+        if (linearIdx >= numCells)
+            return;
+
+        const DataSpace<simDim> cell(DataSpaceOperations<simDim>::map(size, linearIdx));
+        const uint64_cu value = counterBox(cell);
+        if (value == 0)
+            return;
+
+        const DataSpace<simDim> globalCell(globalOffset + cell);
+        uint64_cu globalIdx = 0;
+        for (int d = simDim - 1; d >= 0; --d)
+            globalIdx = globalIdx * globalSize[d] + globalCell[d];
+
+        const int entry = nvidia::atomicAllInc(numEntries);
+        indexBox(DataSpace<DIM1>(entry)) = globalIdx;
+        countBox(DataSpace<DIM1>(entry)) = value;
+    }
+};
+
+/** compact the statistics of all counter cells which were non-empty in at
+ *  least one sample to a list of (index, min, max, sum) entries
+ *
+ * The order of the list is not deterministic.
+ * One thread per cell of the counter.
+ *
+ * @param numEntries zero initialized counter of the list entries
+ * @param globalOffset offset of the local counter in the global counter grid
+ * @param globalSize size of the global counter grid, the index is the linear
+ *                   index within the global grid (x is the fastest dimension)
+ */
+struct CompactCountStatistics
+{
+    template<class CounterBox, class ListBox>
+    DINLINE void operator()(
+        CounterBox minBox,
+        CounterBox maxBox,
+        CounterBox sumBox,
+        ListBox indexBox,
+        ListBox minListBox,
+        ListBox maxListBox,
+        ListBox sumListBox,
+        int* numEntries,
+        DataSpace<simDim> size,
+        uint32_t numCells,
+        DataSpace<simDim> globalOffset,
+        DataSpace<simDim> globalSize
+    ) const
+    {
+        const uint32_t linearIdx = blockIdx.x * blockDim.x + threadIdx.x;
+        if (linearIdx >= numCells)
+            return;
+
+        const DataSpace<simDim> cell(DataSpaceOperations<simDim>::map(size, linearIdx));
+        /* the maximum is zero if the cell was empty in all samples */
+        if (maxBox(cell) == 0)
+            return;
+
+        const DataSpace<simDim> globalCell(globalOffset + cell);
+        uint64_cu globalIdx = 0;
+        for (int d = simDim - 1; d >= 0; --d)
+            globalIdx = globalIdx * globalSize[d] + globalCell[d];
+
+        const int entry = nvidia::atomicAllInc(numEntries);
+        indexBox(DataSpace<DIM1>(entry)) = globalIdx;
+        minListBox(DataSpace<DIM1>(entry)) = minBox(cell);
+        maxListBox(DataSpace<DIM1>(entry)) = maxBox(cell);
+        sumListBox(DataSpace<DIM1>(entry)) = sumBox(cell);
     }
 };
 /** Count makro particle of a species and write down the result to a global HDF5 file.
@@ -105,6 +245,14 @@ struct CountMakroParticle
  * - HDF5 Format: - default lib splash output for meshes
  *                - the attribute name in the HDF5 file is "makroParticleCount"
  *
+ * Optional compression (all reductions are performed on the device):
+ * - `.blockSize`: sum the count of blocks of supercells (coarse graining),
+ *   the local domain must be divisible by the block size
+ * - `.sparse`: write only non-empty (coarse) cells as list of
+ *   (global linear index, count), x is the fastest index
+ * - `.statistics`: running minimum, maximum and mean over all notified
+ *   steps of each (coarse) cell, together with `.sparse` only cells which
+ *   were non-empty in at least one step are written
  */
 template<class ParticlesType>
 class PerSuperCell : public ILightweightPlugin
@@ -113,7 +261,8 @@ private:
 
 
     typedef MappingDesc::SuperCellSize SuperCellSize;
-    typedef GridBuffer<size_t, simDim> GridBufferType;
+    typedef GridBuffer<uint64_cu, simDim> GridBufferType;
+    typedef GridBuffer<uint64_cu, DIM1> ListBufferType;
 
     MappingDesc *cellDescription;
     uint32_t notifyFrequency;
@@ -123,8 +272,34 @@ private:
     std::string foldername;
     mpi::MPIReduce reduce;
 
+    std::vector<uint32_t> blockSizeParam;
+    bool isSparse;
+    bool withStatistics;
+
+    /* supercells per element of localResult */
+    DataSpace<simDim> blockSize;
     GridBufferType* localResult;
 
+    /* sparse output */
+    ListBufferType* sparseIndex;
+    ListBufferType* sparseCount;
+    GridBuffer<int, DIM1>* sparseNumEntries;
+
+    /* running statistics */
+    GridBufferType* countMin;
+    GridBufferType* countMax;
+    GridBufferType* countSum;
+    uint64_t numSamples;
+
+    /* sparse output of the statistics, the index list is shared with the count */
+    ListBufferType* sparseMin;
+    ListBufferType* sparseMax;
+    ListBufferType* sparseSum;
+
+    /* size of the global list and offset of this rank, set by writeList() */
+    uint64_t listSize;
+    uint64_t listOffset;
+
     ParallelDomainCollector *dataCollector;
     // set attributes for datacollector files
     DataCollector::FileCreationAttr h5_attr;
@@ -137,7 +312,21 @@ public:
     foldername(pluginPrefix),
     cellDescription(nullptr),
     notifyFrequency(0),
+    isSparse(false),
+    withStatistics(false),
     localResult(nullptr),
+    sparseIndex(nullptr),
+    sparseCount(nullptr),
+    sparseNumEntries(nullptr),
+    countMin(nullptr),
+    countMax(nullptr),
+    countSum(nullptr),
+    numSamples(0),
+    sparseMin(nullptr),
+    sparseMax(nullptr),
+    sparseSum(nullptr),
+    listSize(0),
+    listOffset(0),
     dataCollector(nullptr)
     {
         Environment<>::get().PluginConnector().registerPlugin(this);
@@ -157,7 +346,14 @@ public:
     {
         desc.add_options()
             ((pluginPrefix + ".period").c_str(),
-             po::value<uint32_t > (&notifyFrequency), "enable plugin [for each n-th step]");
+             po::value<uint32_t > (&notifyFrequency), "enable plugin [for each n-th step]")
+            ((pluginPrefix + ".blockSize").c_str(),
+             po::value<std::vector<uint32_t> > (&blockSizeParam)->multitoken(),
+             "number of supercells per output cell for each direction, e.g. 2 2 4 [default: 1]")
+            ((pluginPrefix + ".sparse").c_str(), po::bool_switch(&isSparse),
+             "write only non-empty cells as (index, count) list, also used for the statistics")
+            ((pluginPrefix + ".statistics").c_str(), po::bool_switch(&withStatistics),
+             "write running min/max/mean of each cell over all notified steps");
     }
 
     std::string pluginGetName() const
@@ -180,7 +376,42 @@ private:
             const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
             /* local count of supercells without any guards*/
             DataSpace<simDim> localSuperCells(subGrid.getLocalDomain().size / SuperCellSize::toRT());
-            localResult = new GridBufferType(localSuperCells);
+
+            for (uint32_t d = 0; d < simDim; ++d)
+            {
+                blockSize[d] = 1;
+                if (!blockSizeParam.empty())
+                    blockSize[d] = blockSizeParam[std::min(size_t(d), blockSizeParam.size() - 1)];
+                if (blockSize[d] == 0 || localSuperCells[d] % blockSize[d] != 0)
+                    throw std::runtime_error(pluginPrefix +
+                        ": blockSize must be > 0 and divide the number of supercells of each local domain");
+            }
+
+            const DataSpace<simDim> localSize(localSuperCells / blockSize);
+            localResult = new GridBufferType(localSize);
+
+            if (isSparse)
+            {
+                const DataSpace<DIM1> maxEntries(localSize.productOfComponents());
+                sparseIndex = new ListBufferType(maxEntries);
+                sparseCount = new ListBufferType(maxEntries);
+                sparseNumEntries = new GridBuffer<int, DIM1>(DataSpace<DIM1>(1));
+            }
+
+            if (withStatistics)
+            {
+                countMin = new GridBufferType(localSize);
+                countMax = new GridBufferType(localSize);
+                countSum = new GridBufferType(localSize);
+
+                if (isSparse)
+                {
+                    const DataSpace<DIM1> maxEntries(localSize.productOfComponents());
+                    sparseMin = new ListBufferType(maxEntries);
+                    sparseMax = new ListBufferType(maxEntries);
+                    sparseSum = new ListBufferType(maxEntries);
+                }
+            }
 
             /* create folder for hdf5 files*/
             Environment<simDim>::get().Filesystem().createDirectoryWithPermissions(foldername);
@@ -190,6 +421,15 @@ private:
     void pluginUnload()
     {
         __delete(localResult);
+        __delete(sparseIndex);
+        __delete(sparseCount);
+        __delete(sparseNumEntries);
+        __delete(countMin);
+        __delete(countMax);
+        __delete(countSum);
+        __delete(sparseMin);
+        __delete(sparseMax);
+        __delete(sparseSum);
 
         if (dataCollector)
             dataCollector->finalize();
@@ -210,25 +450,38 @@ private:
         typedef MappingDesc::SuperCellSize SuperCellSize;
         AreaMapping<AREA, MappingDesc> mapper(*cellDescription);
 
+        /* counter is accumulated with atomics */
+        localResult->getDeviceBuffer().setValue(0);
+
         PMACC_KERNEL(CountMakroParticle{})
             (mapper.getGridDim(), SuperCellSize::toRT())
             (particles->getDeviceParticlesBox(),
-             localResult->getDeviceBuffer().getDataBox(), mapper);
+             localResult->getDeviceBuffer().getDataBox(), blockSize, mapper);
 
         dc.releaseData( ParticlesType::FrameType::getName() );
 
-        localResult->deviceToHost();
-
-
-
         /*############ dump data #############################################*/
         const SubGrid<simDim>& subGrid = Environment<simDim>::get().SubGrid();
 
-        DataSpace<simDim> localSize(subGrid.getLocalDomain().size / SuperCellSize::toRT());
-        DataSpace<simDim> globalOffset(subGrid.getLocalDomain().offset / SuperCellSize::toRT());
-        DataSpace<simDim> globalSize(subGrid.getGlobalDomain().size / SuperCellSize::toRT());
+        DataSpace<simDim> localSize(subGrid.getLocalDomain().size / SuperCellSize::toRT() / blockSize);
+        DataSpace<simDim> globalOffset(subGrid.getLocalDomain().offset / SuperCellSize::toRT() / blockSize);
+        DataSpace<simDim> globalSize(subGrid.getGlobalDomain().size / SuperCellSize::toRT() / blockSize);
 
+        const uint32_t numCells = localSize.productOfComponents();
+        const uint32_t numThreads = 256;
+        const uint32_t numBlocks = (numCells + numThreads - 1) / numThreads;
 
+        if (withStatistics)
+        {
+            PMACC_KERNEL(UpdateCountStatistics{})
+                (numBlocks, numThreads)
+                (localResult->getDeviceBuffer().getDataBox(),
+                 countMin->getDeviceBuffer().getDataBox(),
+                 countMax->getDeviceBuffer().getDataBox(),
+                 countSum->getDeviceBuffer().getDataBox(),
+                 localSize, numCells, numSamples == 0);
+            ++numSamples;
+        }
 
         Dimensions splashGlobalDomainOffset(0, 0, 0);
         Dimensions splashGlobalOffset(0, 0, 0);
@@ -244,15 +497,74 @@ private:
             localBufferSize[d] = localSize[d];
         }
 
-        size_t* ptr = localResult->getHostBuffer().getPointer();
+        if (isSparse)
+            writeSparse(currentStep, localSize, numCells, globalOffset, globalSize);
+        else
+        {
+            localResult->deviceToHost();
+            writeGrid(currentStep, splashGlobalSize, splashGlobalOffset, localBufferSize,
+                      splashGlobalDomainOffset, splashGlobalDomainSize,
+                      "makroParticlePerSupercell", ColTypeUInt64(),
+                      localResult->getHostBuffer().getPointer());
+        }
+
+        if (withStatistics && isSparse)
+            writeSparseStatistics(currentStep, localSize, numCells, globalOffset, globalSize);
+        else if (withStatistics)
+        {
+            countMin->deviceToHost();
+            countMax->deviceToHost();
+            countSum->deviceToHost();
+            __getTransactionEvent().waitForFinished();
+
+            writeGrid(currentStep, splashGlobalSize, splashGlobalOffset, localBufferSize,
+                      splashGlobalDomainOffset, splashGlobalDomainSize,
+                      "makroParticlePerSupercellMin", ColTypeUInt64(),
+                      countMin->getHostBuffer().getPointer());
+            writeGrid(currentStep, splashGlobalSize, splashGlobalOffset, localBufferSize,
+                      splashGlobalDomainOffset, splashGlobalDomainSize,
+                      "makroParticlePerSupercellMax", ColTypeUInt64(),
+                      countMax->getHostBuffer().getPointer());
+
+            /* host buffer is not pitched, the mean is calculated in a contiguous copy */
+            const uint64_cu* sumPtr = countSum->getHostBuffer().getPointer();
+            std::vector<float_64> mean(numCells);
+            for (uint32_t i = 0; i < numCells; ++i)
+                mean[i] = float_64(sumPtr[i]) / float_64(numSamples);
+
+            writeGrid(currentStep, splashGlobalSize, splashGlobalOffset, localBufferSize,
+                      splashGlobalDomainOffset, splashGlobalDomainSize,
+                      "makroParticlePerSupercellMean", ColTypeDouble(),
+                      &(*mean.begin()));
+
+            ColTypeUInt64 ctUInt64;
+            dataCollector->writeAttribute(currentStep, ctUInt64,
+                                          "makroParticlePerSupercellMean",
+                                          "numSamples", &numSamples);
+        }
+
+        closeH5File();
+    }
 
+    void writeGrid(
+        uint32_t currentStep,
+        const Dimensions& splashGlobalSize,
+        const Dimensions& splashGlobalOffset,
+        const Dimensions& localBufferSize,
+        const Dimensions& splashGlobalDomainOffset,
+        const Dimensions& splashGlobalDomainSize,
+        const std::string& name,
+        const CollectionType& type,
+        const void* ptr
+    )
+    {
         dataCollector->writeDomain(currentStep,                     /* id == time step */
                                    splashGlobalSize,                /* total size of dataset over all processes */
                                    splashGlobalOffset,              /* write offset for this process */
-                                   ColTypeUInt64(),                 /* data type */
+                                   type,                            /* data type */
                                    simDim,                          /* NDims of the field data (scalar, vector, ...) */
                                    splash::Selection(localBufferSize),
-                                   "makroParticlePerSupercell",     /* data set name */
+                                   name.c_str(),                    /* data set name */
                                    splash::Domain(
                                           splashGlobalDomainOffset, /* offset of the global domain */
                                           splashGlobalDomainSize    /* size of the global domain */
@@ -260,7 +572,229 @@ private:
                                    DomainCollector::GridType,
                                    ptr);
 
-        closeH5File();
+        ColTypeUInt64 ctUInt64;
+        uint64_t blockSizeAttr[3] = {1, 1, 1};
+        for (uint32_t d = 0; d < simDim; ++d)
+            blockSizeAttr[d] = blockSize[d];
+        dataCollector->writeAttribute(currentStep, ctUInt64, name.c_str(),
+                                      "superCellsPerCell", 1u, Dimensions(simDim, 0, 0),
+                                      blockSizeAttr);
+    }
+
+    /** write non-empty cells as list
+     *
+     * Only the used part of the device list is copied to the host.
+     * Datasets: `makroParticlePerSupercellSparse/index` and
+     * `makroParticlePerSupercellSparse/count`, the size of the dense
+     * grid is stored in the attribute `gridSize`.
+     */
+    void writeSparse(
+        uint32_t currentStep,
+        const DataSpace<simDim>& localSize,
+        const uint32_t numCells,
+        const DataSpace<simDim>& globalOffset,
+        const DataSpace<simDim>& globalSize
+    )
+    {
+        sparseNumEntries->getDeviceBuffer().setValue(0);
+
+        const uint32_t numThreads = 256;
+        const uint32_t numBlocks = (numCells + numThreads - 1) / numThreads;
+        PMACC_KERNEL(CompactCount{})
+            (numBlocks, numThreads)
+            (localResult->getDeviceBuffer().getDataBox(),
+             sparseIndex->getDeviceBuffer().getDataBox(),
+             sparseCount->getDeviceBuffer().getDataBox(),
+             sparseNumEntries->getDeviceBuffer().getPointer(),
+             localSize, numCells, globalOffset, globalSize);
+
+        ListBufferType* values[] = {sparseCount};
+        const uint64_t numEntries = copyListToHost(values, 1);
+
+        std::vector<uint64_t> order(getSortedOrder(numEntries));
+        std::vector<uint64_t> indices(numEntries);
+        std::vector<uint64_t> counts(numEntries);
+        const uint64_cu* indexPtr = sparseIndex->getHostBuffer().getPointer();
+        const uint64_cu* countPtr = sparseCount->getHostBuffer().getPointer();
+        for (uint64_t i = 0; i < numEntries; ++i)
+        {
+            indices[i] = indexPtr[order[i]];
+            counts[i] = countPtr[order[i]];
+        }
+
+        const std::string path("makroParticlePerSupercellSparse");
+        ColTypeUInt64 ctUInt64;
+        writeList(currentStep, path, globalSize, numEntries, indices);
+        writeListValues(currentStep, path + std::string("/count"), ctUInt64,
+                        numEntries, numEntries == 0 ? nullptr : &(*counts.begin()));
+    }
+
+    /** write the statistics of all cells which were non-empty in at least one
+     *  notified step as list
+     *
+     * Datasets: `makroParticlePerSupercellStatisticsSparse/index`, `/min`,
+     * `/max` and `/mean`, the attributes are the same as for writeSparse().
+     */
+    void writeSparseStatistics(
+        uint32_t currentStep,
+        const DataSpace<simDim>& localSize,
+        const uint32_t numCells,
+        const DataSpace<simDim>& globalOffset,
+        const DataSpace<simDim>& globalSize
+    )
+    {
+        sparseNumEntries->getDeviceBuffer().setValue(0);
+
+        const uint32_t numThreads = 256;
+        const uint32_t numBlocks = (numCells + numThreads - 1) / numThreads;
+        PMACC_KERNEL(CompactCountStatistics{})
+            (numBlocks, numThreads)
+            (countMin->getDeviceBuffer().getDataBox(),
+             countMax->getDeviceBuffer().getDataBox(),
+             countSum->getDeviceBuffer().getDataBox(),
+             sparseIndex->getDeviceBuffer().getDataBox(),
+             sparseMin->getDeviceBuffer().getDataBox(),
+             sparseMax->getDeviceBuffer().getDataBox(),
+             sparseSum->getDeviceBuffer().getDataBox(),
+             sparseNumEntries->getDeviceBuffer().getPointer(),
+             localSize, numCells, globalOffset, globalSize);
+
+        ListBufferType* values[] = {sparseMin, sparseMax, sparseSum};
+        const uint64_t numEntries = copyListToHost(values, 3);
+
+        std::vector<uint64_t> order(getSortedOrder(numEntries));
+        std::vector<uint64_t> indices(numEntries);
+        std::vector<uint64_t> mins(numEntries);
+        std::vector<uint64_t> maxs(numEntries);
+        std::vector<float_64> mean(numEntries);
+        const uint64_cu* indexPtr = sparseIndex->getHostBuffer().getPointer();
+        const uint64_cu* minPtr = sparseMin->getHostBuffer().getPointer();
+        const uint64_cu* maxPtr = sparseMax->getHostBuffer().getPointer();
+        const uint64_cu* sumPtr = sparseSum->getHostBuffer().getPointer();
+        for (uint64_t i = 0; i < numEntries; ++i)
+        {
+            indices[i] = indexPtr[order[i]];
+            mins[i] = minPtr[order[i]];
+            maxs[i] = maxPtr[order[i]];
+            mean[i] = float_64(sumPtr[order[i]]) / float_64(numSamples);
+        }
+
+        const std::string path("makroParticlePerSupercellStatisticsSparse");
+        ColTypeUInt64 ctUInt64;
+        writeList(currentStep, path, globalSize, numEntries, indices);
+        writeListValues(currentStep, path + std::string("/min"), ctUInt64,
+                        numEntries, numEntries == 0 ? nullptr : &(*mins.begin()));
+        writeListValues(currentStep, path + std::string("/max"), ctUInt64,
+                        numEntries, numEntries == 0 ? nullptr : &(*maxs.begin()));
+        writeListValues(currentStep, path + std::string("/mean"), ColTypeDouble(),
+                        numEntries, numEntries == 0 ? nullptr : &(*mean.begin()));
+        dataCollector->writeAttribute(currentStep, ctUInt64,
+                                      (path + std::string("/mean")).c_str(),
+                                      "numSamples", &numSamples);
+    }
+
+    /** copy the used part of the compacted device lists to the host
+     *
+     * @param values value lists filled together with sparseIndex
+     * @param numValues number of elements in values
+     * @return number of list entries
+     */
+    uint64_t copyListToHost(ListBufferType** values, uint32_t numValues)
+    {
+        sparseNumEntries->deviceToHost();
+        __getTransactionEvent().waitForFinished();
+        const uint64_t numEntries = sparseNumEntries->getHostBuffer().getDataBox()[0];
+
+        if (numEntries != 0)
+        {
+            sparseIndex->getDeviceBuffer().setCurrentSize(numEntries);
+            sparseIndex->deviceToHost();
+            for (uint32_t i = 0; i < numValues; ++i)
+            {
+                values[i]->getDeviceBuffer().setCurrentSize(numEntries);
+                values[i]->deviceToHost();
+            }
+            __getTransactionEvent().waitForFinished();
+        }
+        return numEntries;
+    }
+
+    /** order of the host list entries sorted by the global index
+     *
+     * the device order depends on the scheduling, sorting by index gives a
+     * reproducible output
+     */
+    std::vector<uint64_t> getSortedOrder(const uint64_t numEntries)
+    {
+        const uint64_cu* indexPtr = sparseIndex->getHostBuffer().getPointer();
+        std::vector<std::pair<uint64_t, uint64_t> > entries(numEntries);
+        for (uint64_t i = 0; i < numEntries; ++i)
+            entries[i] = std::make_pair(uint64_t(indexPtr[i]), i);
+        std::sort(entries.begin(), entries.end());
+
+        std::vector<uint64_t> order(numEntries);
+        for (uint64_t i = 0; i < numEntries; ++i)
+            order[i] = entries[i].second;
+        return order;
+    }
+
+    /** write the sorted index list to `<path>/index` and set the offset of
+     *  this rank in the global list for writeListValues()
+     */
+    void writeList(
+        uint32_t currentStep,
+        const std::string& path,
+        const DataSpace<simDim>& globalSize,
+        const uint64_t numEntries,
+        const std::vector<uint64_t>& indices
+    )
+    {
+        /* offset of this rank in the global list */
+        GridController<simDim>& gc = Environment<simDim>::get().GridController();
+        listOffset = 0;
+        listSize = 0;
+        MPI_CHECK(MPI_Exscan(&numEntries, &listOffset, 1, MPI_UINT64_T, MPI_SUM,
+                             gc.getCommunicator().getMPIComm()));
+        MPI_CHECK(MPI_Allreduce(&numEntries, &listSize, 1, MPI_UINT64_T, MPI_SUM,
+                                gc.getCommunicator().getMPIComm()));
+        /* result of MPI_Exscan is undefined on the first rank */
+        if (gc.getGlobalRank() == 0)
+            listOffset = 0;
+
+        ColTypeUInt64 ctUInt64;
+        const std::string name(path + std::string("/index"));
+        writeListValues(currentStep, name, ctUInt64, numEntries,
+                        numEntries == 0 ? nullptr : &(*indices.begin()));
+
+        uint64_t gridSizeAttr[3] = {1, 1, 1};
+        uint64_t blockSizeAttr[3] = {1, 1, 1};
+        for (uint32_t d = 0; d < simDim; ++d)
+        {
+            gridSizeAttr[d] = globalSize[d];
+            blockSizeAttr[d] = blockSize[d];
+        }
+        dataCollector->writeAttribute(currentStep, ctUInt64, name.c_str(),
+                                      "gridSize", 1u, Dimensions(simDim, 0, 0), gridSizeAttr);
+        dataCollector->writeAttribute(currentStep, ctUInt64, name.c_str(),
+                                      "superCellsPerCell", 1u, Dimensions(simDim, 0, 0), blockSizeAttr);
+    }
+
+    /** write one value per list entry, the offset is set by writeList() */
+    void writeListValues(
+        uint32_t currentStep,
+        const std::string& name,
+        const CollectionType& type,
+        const uint64_t numEntries,
+        const void* ptr
+    )
+    {
+        dataCollector->write(currentStep,
+                             Dimensions(listSize, 1, 1),
+                             Dimensions(listOffset, 0, 0),
+                             type, 1,
+                             Dimensions(numEntries, 1, 1),
+                             name.c_str(),
+                             ptr);
     }
 
     void closeH5File()
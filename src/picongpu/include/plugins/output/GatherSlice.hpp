@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Benjamin Worpitz
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Benjamin Worpitz,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -76,7 +77,9 @@ struct GatherSlice
         if (!isActive)
             mpiRank = -1;
 
-        MPI_CHECK(MPI_Allgather(&mpiRank, 1, MPI_INT, &gatherRanks[0], 1, MPI_INT, MPI_COMM_WORLD));
+        /* the global rank is the rank in the communicator of the grid */
+        MPI_Comm gridComm = Environment<simDim>::get().GridController().getCommunicator().getMPIComm();
+        MPI_CHECK(MPI_Allgather(&mpiRank, 1, MPI_INT, &gatherRanks[0], 1, MPI_INT, gridComm));
 
         for (int i = 0; i < countRanks; ++i)
         {
@@ -89,10 +92,10 @@ struct GatherSlice
 
         MPI_Group group = MPI_GROUP_NULL;
         MPI_Group newgroup = MPI_GROUP_NULL;
-        MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &group));
+        MPI_CHECK(MPI_Comm_group(gridComm, &group));
         MPI_CHECK(MPI_Group_incl(group, numRanks, &groupRanks[0], &newgroup));
 
-        MPI_CHECK(MPI_Comm_create(MPI_COMM_WORLD, newgroup, &comm));
+        MPI_CHECK(MPI_Comm_create(gridComm, newgroup, &comm));
 
         if (mpiRank != -1)
         {
@@ -197,7 +200,7 @@ struct GatherSlice
     }
 
     template<class DstBox, class SrcBox>
-    void insertData(DstBox& dst, const SrcBox& src, Size2D offsetToSimNull, Size2D srcSize)
+    static void insertData(DstBox& dst, const SrcBox& src, Size2D offsetToSimNull, Size2D srcSize)
     {
         for (int y = 0; y < srcSize.y(); ++y)
         {
@@ -0,0 +1,269 @@
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Benjamin Worpitz,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "memory/boxes/PitchedBox.hpp"
+#include "dimensions/DataSpace.hpp"
+#include "communication/manager_common.hpp"
+#include "pmacc_types.hpp"
+
+#include <mpi.h>
+
+#include <vector>
+#include <cstring>
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+using namespace PMacc;
+
+/** gather of several slices with one collective
+ *
+ * Each slice is gathered to its own master rank, as with one GatherSlice
+ * per slice, but the images of all slices of a step are exchanged with
+ * a single MPI_Alltoallv. Each image is sent together with its header
+ * (MessageHeader in the simulation).
+ */
+struct GatherSlices
+{
+
+    GatherSlices() :
+        gridComm(MPI_COMM_NULL),
+        mpiRank(-1),
+        numRanks(0),
+        numSlices(0)
+    {
+    }
+
+    ~GatherSlices()
+    {
+        reset();
+    }
+
+    /* Must be called from all mpi processes with the same number of slices.
+     *
+     * @param isActive for each slice: true if this rank contributes to the slice
+     * @param bytes for each slice: size of the local image in byte
+     * @param headerBytes size of the header of an image in byte
+     * @param comm communicator of all ranks (the grid in the simulation)
+     * @return for each slice: true if this rank gets the gathered slice
+     */
+    std::vector<bool> init(const std::vector<bool>& isActive, const std::vector<int>& bytes,
+                           const int headerBytes, MPI_Comm comm)
+    {
+        static int masterRankOffset = 0;
+
+        reset();
+
+        gridComm = comm;
+        numSlices = isActive.size();
+        MPI_CHECK(MPI_Comm_rank(gridComm, &mpiRank));
+        MPI_CHECK(MPI_Comm_size(gridComm, &numRanks));
+
+        std::vector<int> localBytes(numSlices, 0);
+        for (int s = 0; s < numSlices; ++s)
+            if (isActive[s])
+                localBytes[s] = headerBytes + bytes[s];
+
+        messageBytes.resize(numRanks * numSlices);
+        MPI_CHECK(MPI_Allgather(&localBytes[0], numSlices, MPI_INT,
+                                &messageBytes[0], numSlices, MPI_INT, gridComm));
+
+        std::vector<bool> isMaster(numSlices, false);
+        masterRank.resize(numSlices, -1);
+        filteredData.resize(numSlices, nullptr);
+        for (int s = 0; s < numSlices; ++s)
+        {
+            std::vector<int> sliceRanks;
+            for (int r = 0; r < numRanks; ++r)
+                if (getBytes(r, s) != 0)
+                    sliceRanks.push_back(r);
+
+            masterRankOffset++;
+            if (sliceRanks.empty())
+                continue;
+            /* avoid that only one rank is the master of all slices
+             * this reduces the load of the masters
+             */
+            masterRank[s] = sliceRanks[masterRankOffset % sliceRanks.size()];
+            isMaster[s] = (masterRank[s] == mpiRank);
+        }
+
+        return isMaster;
+    }
+
+    /* Gather the local images of the selected slices
+     *
+     * Must be called from all mpi processes with the same selected slices.
+     *
+     * @param selected indices of the slices to gather
+     * @param data for each slice: local image, used if this rank contributes to the slice
+     * @param headers for each slice: meta information of the local image,
+     *                T_Header::bytes must be the headerBytes passed to init()
+     * @return for each slice: gathered image, valid if this rank is the master of the slice
+     */
+    template<class Box, class T_Header>
+    std::vector<Box> operator()(const std::vector<uint32_t>& selected,
+                                const std::vector<Box>& data,
+                                const std::vector<T_Header*>& headers)
+    {
+        typedef typename Box::ValueType ValueType;
+
+        std::vector<int> sendCounts(numRanks, 0);
+        std::vector<int> sendDispls(numRanks, 0);
+        std::vector<int> recvCounts(numRanks, 0);
+        std::vector<int> recvDispls(numRanks, 0);
+
+        int sendBytes = 0;
+        int recvBytes = 0;
+        for (int r = 0; r < numRanks; ++r)
+        {
+            sendDispls[r] = sendBytes;
+            recvDispls[r] = recvBytes;
+            for (size_t i = 0; i < selected.size(); ++i)
+            {
+                const uint32_t s = selected[i];
+                if (masterRank[s] == r)
+                    sendCounts[r] += getBytes(mpiRank, s);
+                if (masterRank[s] == mpiRank)
+                    recvCounts[r] += getBytes(r, s);
+            }
+            sendBytes += sendCounts[r];
+            recvBytes += recvCounts[r];
+        }
+
+        /* messages to a rank are ordered by slice index */
+        std::vector<char> sendBuffer(sendBytes);
+        std::vector<char> recvBuffer(recvBytes);
+        for (int r = 0; r < numRanks; ++r)
+        {
+            char* message = sendBuffer.data() + sendDispls[r];
+            for (size_t i = 0; i < selected.size(); ++i)
+            {
+                const uint32_t s = selected[i];
+                const int bytes = getBytes(mpiRank, s);
+                if (masterRank[s] != r || bytes == 0)
+                    continue;
+                memcpy(message, headers[s], T_Header::bytes);
+                memcpy(message + T_Header::bytes, data[s].getPointer(), bytes - T_Header::bytes);
+                message += bytes;
+            }
+        }
+
+        MPI_CHECK(MPI_Alltoallv(
+                                sendBuffer.data(), &sendCounts[0], &sendDispls[0], MPI_CHAR,
+                                recvBuffer.data(), &recvCounts[0], &recvDispls[0], MPI_CHAR,
+                                gridComm));
+
+        std::vector<Box> result(numSlices);
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            const uint32_t s = selected[i];
+            if (masterRank[s] != mpiRank)
+                continue;
+            const T_Header& header = *headers[s];
+            if (filteredData[s] == nullptr)
+                filteredData[s] = new char[header.sim.size.productOfComponents() * sizeof (ValueType)];
+
+            /*create box with valid memory*/
+            result[s] = Box(PitchedBox<ValueType, DIM2 > (
+                                                          (ValueType*) filteredData[s],
+                                                          DataSpace<DIM2 > (),
+                                                          header.sim.size,
+                                                          header.sim.size.x() * sizeof (ValueType)
+                                                          ));
+        }
+
+        for (int r = 0; r < numRanks; ++r)
+        {
+            char* message = recvBuffer.data() + recvDispls[r];
+            for (size_t i = 0; i < selected.size(); ++i)
+            {
+                const uint32_t s = selected[i];
+                const int bytes = getBytes(r, s);
+                if (masterRank[s] != mpiRank || bytes == 0)
+                    continue;
+                T_Header* head = (T_Header*) message;
+                Box srcBox = Box(PitchedBox<ValueType, DIM2 > (
+                                                               (ValueType*) (message + T_Header::bytes),
+                                                               DataSpace<DIM2 > (),
+                                                               head->node.maxSize,
+                                                               head->node.maxSize.x() * sizeof (ValueType)
+                                                               ));
+
+                insertData(result[s], srcBox, head->node.offset, head->node.maxSize);
+                message += bytes;
+            }
+        }
+
+        return result;
+    }
+
+    /** copy a part of an image into the gathered image, as GatherSlice::insertData */
+    template<class DstBox, class SrcBox>
+    static void insertData(DstBox& dst, const SrcBox& src, DataSpace<DIM2> offsetToSimNull, DataSpace<DIM2> srcSize)
+    {
+        for (int y = 0; y < srcSize.y(); ++y)
+        {
+            for (int x = 0; x < srcSize.x(); ++x)
+            {
+                dst[y + offsetToSimNull.y()][x + offsetToSimNull.x()] = src[y][x];
+            }
+        }
+    }
+
+private:
+
+    /* size of the message of a rank for a slice in byte, zero if the rank
+     * does not contribute to the slice
+     */
+    int getBytes(int rank, int slice) const
+    {
+        return messageBytes[rank * numSlices + slice];
+    }
+
+    /*reset this object und set all values to initial state*/
+    void reset()
+    {
+        for (size_t s = 0; s < filteredData.size(); ++s)
+            __deleteArray(filteredData[s]);
+        filteredData.clear();
+        masterRank.clear();
+        messageBytes.clear();
+        numSlices = 0;
+    }
+
+    /* gathered images of the slices */
+    std::vector<char*> filteredData;
+    /* master rank of each slice, -1 if no rank contributes to the slice */
+    std::vector<int> masterRank;
+    /* message size of each rank (major) and slice (minor) */
+    std::vector<int> messageBytes;
+    /* communicator of init(), mpiRank is the rank in this communicator */
+    MPI_Comm gridComm;
+    int mpiRank;
+    int numRanks;
+    int numSlices;
+};
+
+}//namespace
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera
+/* Copyright 2013-2017 Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -28,7 +28,21 @@ class ZipConnector
 {
 public:
 
-    size_t compress(void* out, void* in, size_t sizeIn, int compressLevel)
+    /** upper bound of the compressed size of `sizeIn` bytes */
+    static size_t maxCompressedSize(size_t sizeIn)
+    {
+        return compressBound(sizeIn);
+    }
+
+    /** compress a memory region
+     *
+     * @param sizeOut size of `out` in byte, if zero `sizeIn` is assumed
+     *                (use maxCompressedSize() to allocate a buffer which can
+     *                hold non-compressible data)
+     * @param compressLevel zlib compression level [0,9], 1 is the fastest
+     * @return number of bytes written to `out`
+     */
+    size_t compress(void* out, void* in, size_t sizeIn, int compressLevel, size_t sizeOut = 0)
     {
         int ret;
 
@@ -44,7 +58,7 @@ public:
         strm.avail_in = sizeIn;
         strm.next_in = (Bytef*) in;
 
-        strm.avail_out = sizeIn;
+        strm.avail_out = sizeOut == 0 ? sizeIn : sizeOut;
         strm.next_out = (Bytef*) out;
 
         ret = deflate(&strm, Z_FINISH);
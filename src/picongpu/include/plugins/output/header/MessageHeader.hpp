@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -28,6 +28,7 @@
 #include "plugins/output/header/SimHeader.hpp"
 //#include "plugins/output/header/ColorHeader.hpp"
 #include "plugins/output/header/WindowHeader.hpp"
+#include "plugins/output/header/StreamHeader.hpp"
 
 #include "simulationControl/Window.hpp"
 
@@ -42,7 +43,8 @@ struct MessageHeader
 
     enum
     {
-        realBytes = sizeof (DataHeader) + sizeof (SimHeader) + sizeof (WindowHeader) + sizeof (NodeHeader),
+        realBytes = sizeof (DataHeader) + sizeof (SimHeader) + sizeof (WindowHeader) + sizeof (NodeHeader) +
+            sizeof (StreamHeader),
         bytes = realBytes < 120 ? 128 : 256
     };
 
@@ -152,6 +154,7 @@ struct MessageHeader
     SimHeader sim;
     WindowHeader window;
     NodeHeader node;
+    StreamHeader stream;
     //ColorHeader color; will be used later on to save channel ranges
 
     void writeToConsole(std::ostream& ocons) const
@@ -160,6 +163,7 @@ struct MessageHeader
         sim.writeToConsole(ocons);
         window.writeToConsole(ocons);
         node.writeToConsole(ocons);
+        stream.writeToConsole(ocons);
     }
 
 private:
@@ -0,0 +1,58 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include <iostream>
+#include <cstdlib>
+
+/** meta information of a frame sent by the live view stream server
+ *
+ * A client which does not know this header simply ignores it because it is
+ * located in the padding at the end of the MessageHeader.
+ */
+struct StreamHeader
+{
+    enum
+    {
+        /* payload is the XOR difference to the previous frame sent to this client */
+        DELTA = 1u
+    };
+
+    /* frame number, gaps in the sequence mark dropped frames */
+    uint32_t sequence;
+    uint32_t flags;
+
+    StreamHeader() : sequence(0), flags(0)
+    {
+    }
+
+    bool isDelta() const
+    {
+        return (flags & DELTA) != 0u;
+    }
+
+    void writeToConsole(std::ostream& ocons) const
+    {
+        ocons << "StreamHeader.sequence " << sequence << std::endl;
+        ocons << "StreamHeader.flags " << flags << std::endl;
+    }
+
+};
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, agent
  *
  * This file is part of PIConGPU.
  *
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "plugins/output/sockets/SocketConnector.hpp"
+#include "plugins/output/sockets/StreamServer.hpp"
 
 #include "pmacc_types.hpp"
 #include "simulation_defines.hpp"
@@ -29,6 +30,8 @@
 #include "memory/boxes/PitchedBox.hpp"
 #include "memory/boxes/DataBox.hpp"
 
+#include <vector>
+
 
 namespace picongpu
 {
@@ -50,13 +53,40 @@ namespace picongpu
     struct LiveViewClient
     {
 
-        LiveViewClient(std::string ip, std::string port) : socket(nullptr), m_ip(ip), m_port(port)
+        /** create a live view output
+         *
+         * @param ip address of the server or, if isServer is true, address to bind
+         * @param port port of the server or, if isServer is true, port to listen on
+         * @param isServer true: listen for clients and stream the frames in a
+         *                 background thread (see StreamServer),
+         *                 false: connect to a server and send each frame blocking
+         * @param compressLevel zlib compression level [0,9], 1 is the fastest
+         * @param numBufferedFrames number of frames kept for slow clients (server only)
+         * @param useDelta send the difference to the previous frame (server only)
+         */
+        LiveViewClient(
+            std::string ip,
+            std::string port,
+            bool isServer = false,
+            int compressLevel = 6,
+            uint32_t numBufferedFrames = 4u,
+            bool useDelta = false
+        ) :
+            socket(nullptr),
+            server(nullptr),
+            m_ip(ip),
+            m_port(port),
+            m_isServer(isServer),
+            m_compressLevel(compressLevel),
+            m_numBufferedFrames(numBufferedFrames),
+            m_useDelta(useDelta)
         {
         }
 
         virtual ~LiveViewClient()
         {
             __delete(socket);
+            __delete(server);
         }
 
         /** block until all shared resource are free
@@ -76,8 +106,15 @@ namespace picongpu
 
     private:
         SocketConnector *socket;
+        StreamServer<MessageHeader> *server;
         std::string m_ip;
         std::string m_port;
+        bool m_isServer;
+        int m_compressLevel;
+        uint32_t m_numBufferedFrames;
+        bool m_useDelta;
+        /* message buffer, reused for all frames */
+        std::vector<char> m_message;
     };
 
     template<>
@@ -88,11 +125,17 @@ namespace picongpu
         const MessageHeader header
     )
     {
-        if (!socket)
-            socket = new SocketConnector(m_ip, m_port);
+        if (m_isServer)
+        {
+            if (!server)
+                server = new StreamServer<MessageHeader>(m_ip, m_port, m_numBufferedFrames, m_compressLevel, m_useDelta);
+        }
+        else if (!socket)
+            socket = new SocketConnector(m_ip, m_port, m_compressLevel);
 
         size_t elems = MessageHeader::bytes + header.window.size.productOfComponents() * sizeof (uint8_t3);
-        char *array = new char[elems];
+        m_message.resize(elems);
+        char *array = &m_message[0];
 
         MessageHeader * fakeHeader = (MessageHeader*) array;
 
@@ -115,7 +158,9 @@ namespace picongpu
                 smallPic[y ][x].m_z = (uint8_t) (data[y ][x ].z() * 255.f);
             }
         }
-        socket->send(array, elems);
-        delete[] array;
+        if (m_isServer)
+            server->send(array, elems);
+        else
+            socket->send(array, elems);
     }
 }
@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Richard Pausch, Felix Schmitt
+/* Copyright 2013-2017 Axel Huebl, Heiko Burau, Rene Widera, Richard Pausch, Felix Schmitt,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -156,6 +157,92 @@ struct typicalFields < 5 >
     }
 };
 
+namespace vis_kernels
+{
+
+/** channels of a cell, fields normalized with the typical fields to [0,1]
+ *
+ * shared by all kernels painting fields, \see KernelPaintFields
+ */
+template<class EType, class BType, class JType>
+DINLINE float3_X fieldsToChannels(const EType field_e, const BType field_b, JType field_j)
+{
+    field_j = float3_X(
+                       field_j.x() * CELL_HEIGHT * CELL_DEPTH,
+                       field_j.y() * CELL_WIDTH * CELL_DEPTH,
+                       field_j.z() * CELL_WIDTH * CELL_HEIGHT
+                       );
+
+    // reset picture to black
+    //   color range for each RGB channel: [0.0, 1.0]
+    float3_X pic = float3_X(0., 0., 0.);
+
+    // typical values of the fields to normalize them to [0,1]
+    //
+    pic.x() = visPreview::preChannel1(field_b / typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().x(),
+                                      field_e / typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().y(),
+                                      field_j / typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().z());
+    pic.y() = visPreview::preChannel2(field_b / typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().x(),
+                                      field_e / typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().y(),
+                                      field_j / typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().z());
+    pic.z() = visPreview::preChannel3(field_b / typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().x(),
+                                      field_e / typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().y(),
+                                      field_j / typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().z());
+    //visPreview::preChannel1Col::addRGB(pic,
+    //                                   visPreview::preChannel1(field_b * typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().x(),
+    //                                                           field_e * typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().y(),
+    //                                                           field_j * typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().z()),
+    //                                   visPreview::preChannel1_opacity);
+    //visPreview::preChannel2Col::addRGB(pic,
+    //                                   visPreview::preChannel2(field_b * typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().x(),
+    //                                                           field_e * typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().y(),
+    //                                                           field_j * typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().z()),
+    //                                   visPreview::preChannel2_opacity);
+    //visPreview::preChannel3Col::addRGB(pic,
+    //                                   visPreview::preChannel3(field_b * typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().x(),
+    //                                                           field_e * typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().y(),
+    //                                                           field_j * typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().z()),
+    //                                   visPreview::preChannel3_opacity);
+
+    return pic;
+}
+
+/** add the particle density of a cell to its RGB value and cut it to [0, 1]
+ *
+ * shared by all kernels painting particles, \see KernelPaintParticles3D
+ *
+ * @param pixel RGB value of the cell
+ * @param counter sum of the weightings of the cell, normalized to
+ *                particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE
+ */
+DINLINE void addDensity(float3_X& pixel, const float_X counter)
+{
+    /** Note: normally, we would multiply by particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE again.
+     *  BUT: since we are interested in a simple value between 0 and 1,
+     *       we stay with this number (normalized to the order of macro
+     *       particles) and devide by the number of typical macro particles
+     *       per cell
+     */
+    float_X value = counter
+        / float_X(particles::TYPICAL_PARTICLES_PER_CELL); // * particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE;
+    if (value > 1.0) value = 1.0;
+
+    //pixel.x() = value;
+    visPreview::preParticleDensCol::addRGB(pixel,
+                                           value,
+                                           visPreview::preParticleDens_opacity);
+
+    // cut to [0, 1]
+    if (pixel.x() < float_X(0.0)) pixel.x() = float_X(0.0);
+    if (pixel.x() > float_X(1.0)) pixel.x() = float_X(1.0);
+    if (pixel.y() < float_X(0.0)) pixel.y() = float_X(0.0);
+    if (pixel.y() > float_X(1.0)) pixel.y() = float_X(1.0);
+    if (pixel.z() < float_X(0.0)) pixel.z() = float_X(0.0);
+    if (pixel.z() > float_X(1.0)) pixel.z() = float_X(1.0);
+}
+
+} // namespace vis_kernels
+
 struct KernelPaintFields
 {
     template<class EBox, class BBox, class JBox, class Mapping>
@@ -189,51 +276,8 @@ struct KernelPaintFields
         if (globalCell != slice)
             return;
 #endif
-        // set fields of this cell to vars
-        typename BBox::ValueType field_b = fieldB(cell);
-        typename EBox::ValueType field_e = fieldE(cell);
-        typename JBox::ValueType field_j = fieldJ(cell);
-
-        field_j = float3_X(
-                           field_j.x() * CELL_HEIGHT * CELL_DEPTH,
-                           field_j.y() * CELL_WIDTH * CELL_DEPTH,
-                           field_j.z() * CELL_WIDTH * CELL_HEIGHT
-                           );
-
-        // reset picture to black
-        //   color range for each RGB channel: [0.0, 1.0]
-        float3_X pic = float3_X(0., 0., 0.);
-
-        // typical values of the fields to normalize them to [0,1]
-        //
-        pic.x() = visPreview::preChannel1(field_b / typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().x(),
-                                          field_e / typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().y(),
-                                          field_j / typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().z());
-        pic.y() = visPreview::preChannel2(field_b / typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().x(),
-                                          field_e / typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().y(),
-                                          field_j / typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().z());
-        pic.z() = visPreview::preChannel3(field_b / typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().x(),
-                                          field_e / typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().y(),
-                                          field_j / typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().z());
-        //visPreview::preChannel1Col::addRGB(pic,
-        //                                   visPreview::preChannel1(field_b * typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().x(),
-        //                                                           field_e * typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().y(),
-        //                                                           field_j * typicalFields<EM_FIELD_SCALE_CHANNEL1>::get().z()),
-        //                                   visPreview::preChannel1_opacity);
-        //visPreview::preChannel2Col::addRGB(pic,
-        //                                   visPreview::preChannel2(field_b * typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().x(),
-        //                                                           field_e * typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().y(),
-        //                                                           field_j * typicalFields<EM_FIELD_SCALE_CHANNEL2>::get().z()),
-        //                                   visPreview::preChannel2_opacity);
-        //visPreview::preChannel3Col::addRGB(pic,
-        //                                   visPreview::preChannel3(field_b * typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().x(),
-        //                                                           field_e * typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().y(),
-        //                                                           field_j * typicalFields<EM_FIELD_SCALE_CHANNEL3>::get().z()),
-        //                                   visPreview::preChannel3_opacity);
-
-
         // draw to (perhaps smaller) image cell
-        image(imageCell) = pic;
+        image(imageCell) = vis_kernels::fieldsToChannels(fieldE(cell), fieldB(cell), fieldJ(cell));
     }
 };
 
@@ -342,28 +386,7 @@ struct KernelPaintParticles3D
 
         if (isImageThread)
         {
-            /** Note: normally, we would multiply by particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE again.
-             *  BUT: since we are interested in a simple value between 0 and 1,
-             *       we stay with this number (normalized to the order of macro
-             *       particles) and devide by the number of typical macro particles
-             *       per cell
-             */
-            float_X value = counter(localCell)
-                / float_X(particles::TYPICAL_PARTICLES_PER_CELL); // * particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE;
-            if (value > 1.0) value = 1.0;
-
-            //image(imageCell).x() = value;
-            visPreview::preParticleDensCol::addRGB(image(imageCell),
-                                                   value,
-                                                   visPreview::preParticleDens_opacity);
-
-            // cut to [0, 1]
-            if (image(imageCell).x() < float_X(0.0)) image(imageCell).x() = float_X(0.0);
-            if (image(imageCell).x() > float_X(1.0)) image(imageCell).x() = float_X(1.0);
-            if (image(imageCell).y() < float_X(0.0)) image(imageCell).y() = float_X(0.0);
-            if (image(imageCell).y() > float_X(1.0)) image(imageCell).y() = float_X(1.0);
-            if (image(imageCell).z() < float_X(0.0)) image(imageCell).z() = float_X(0.0);
-            if (image(imageCell).z() > float_X(1.0)) image(imageCell).z() = float_X(1.0);
+            vis_kernels::addDensity(image(imageCell), counter(localCell));
         }
     }
 };
@@ -422,6 +445,7 @@ private:
 
 
 public:
+    typedef ParticlesType SpeciesType;
     typedef typename ParticlesType::FrameType FrameType;
     typedef Output CreatorType;
 
@@ -0,0 +1,604 @@
+/* Copyright 2013-2017 Axel Huebl, Rene Widera, Benjamin Worpitz,
+ *                     agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "simulation_defines.hpp"
+#include "assert.hpp"
+
+#include "plugins/output/images/Visualisation.hpp"
+#include "plugins/output/GatherSlices.hpp"
+#include "pluginSystem/INotify.hpp"
+
+#include "nvidia/reduce/Reduce.hpp"
+#include "mpi/MPIReduce.hpp"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <cfloat>
+#include <cmath>
+
+
+namespace picongpu
+{
+using namespace PMacc;
+
+namespace vis_kernels
+{
+
+/** images and positions of the slices painted by one kernel call
+ *
+ * @tparam T_maxSlices maximum number of slices
+ */
+template<uint32_t T_maxSlices>
+struct SliceSet
+{
+    static constexpr uint32_t maxSlices = T_maxSlices;
+    typedef DataBox<PitchedBox<float3_X, DIM2> > ImageBox;
+
+    uint32_t numSlices;
+    ImageBox image[T_maxSlices];
+    DataSpace<DIM2> transpose[T_maxSlices];
+    /* global cell index of the slice along sliceDim (only used in 3D) */
+    int slice[T_maxSlices];
+    uint32_t globalOffset[T_maxSlices];
+    uint32_t sliceDim[T_maxSlices];
+    /* offset of the particle counter of the slice in shared memory */
+    uint32_t sharedOffset[T_maxSlices];
+};
+
+} // namespace vis_kernels
+
+/** paint the fields of all slices, \see KernelPaintFields
+ *
+ * The fields of a cell are loaded and normalized once for all slices
+ * the cell is part of.
+ */
+struct KernelPaintFieldsBatch
+{
+    template<class EBox, class BBox, class JBox, class T_SliceSet, class Mapping>
+    DINLINE void operator() (
+                                      EBox fieldE,
+                                      BBox fieldB,
+                                      JBox fieldJ,
+                                      T_SliceSet slices,
+                                      Mapping mapper) const
+    {
+        typedef typename MappingDesc::SuperCellSize Block;
+        const DataSpace<simDim> threadId(threadIdx);
+        const DataSpace<simDim> block = mapper.getSuperCellIndex(DataSpace<simDim > (blockIdx));
+        const DataSpace<simDim> cell(block * Block::toRT() + threadId);
+
+        const DataSpace<simDim> realCell(cell - MappingDesc::SuperCellSize::toRT() * mapper.getGuardingSuperCells()); //delete guard from cell idx
+
+        bool isLoaded = false;
+        float3_X pic;
+        for (uint32_t s = 0; s < slices.numSlices; ++s)
+        {
+#if( SIMDIM==DIM3 )
+            uint32_t globalCell = realCell[slices.sliceDim[s]] + slices.globalOffset[s];
+
+            if (globalCell != slices.slice[s])
+                continue;
+#endif
+            if (!isLoaded)
+            {
+                pic = vis_kernels::fieldsToChannels(fieldE(cell), fieldB(cell), fieldJ(cell));
+                isLoaded = true;
+            }
+            const DataSpace<DIM2> imageCell(
+                                            realCell[slices.transpose[s].x()],
+                                            realCell[slices.transpose[s].y()]);
+            slices.image[s](imageCell) = pic;
+        }
+    }
+};
+
+/** paint the particle density of all slices, \see KernelPaintParticles3D
+ *
+ * The frames of a super cell are visited once for all slices the super
+ * cell is part of.
+ * Dynamic shared memory: one counter per cell of the slices in a super cell,
+ * \see vis_kernels::SliceSet::sharedOffset
+ */
+struct KernelPaintParticlesBatch
+{
+    template<class ParBox, class T_SliceSet, class Mapping>
+    DINLINE void
+    operator()(ParBox pb,
+               T_SliceSet slices,
+               Mapping mapper) const
+    {
+        typedef typename ParBox::FramePtr FramePtr;
+        typedef typename MappingDesc::SuperCellSize Block;
+        typedef DataBox < PitchedBox< float_X, DIM2 > > SharedMem;
+        PMACC_SMEM( frame, FramePtr );
+        /* bit mask of the slices in this super cell */
+        PMACC_SMEM( validSlices, uint32_t );
+
+        const DataSpace<simDim> threadId(threadIdx);
+        const DataSpace<simDim> block = mapper.getSuperCellIndex(DataSpace<simDim > (blockIdx));
+        const DataSpace<simDim> blockOffset((block - 1) * Block::toRT());
+
+
+        int localId = threadIdx.z * Block::x::value * Block::y::value + threadIdx.y * Block::x::value + threadIdx.x;
+
+
+        if (localId == 0)
+            validSlices = 0;
+        __syncthreads();
+
+        //\todo: guard size should not be set to (fixed) 1 here
+        const DataSpace<simDim> realCell(blockOffset + threadId); //delete guard from cell idx
+
+        /* bit mask of the slices this thread paints a pixel of */
+        uint32_t imageSlices = 0;
+        for (uint32_t s = 0; s < slices.numSlices; ++s)
+        {
+#if( SIMDIM==DIM3 )
+            uint32_t globalCell = realCell[slices.sliceDim[s]] + slices.globalOffset[s];
+
+            if (globalCell == slices.slice[s])
+#endif
+                imageSlices |= 1u << s;
+        }
+        if (imageSlices != 0)
+            atomicOr(&validSlices, imageSlices);
+        __syncthreads();
+
+        if (validSlices == 0)
+            return;
+
+        extern __shared__ float_X shBlock[];
+        const DataSpace<simDim> blockSize(blockDim);
+
+        for (uint32_t s = 0; s < slices.numSlices; ++s)
+        {
+            if (imageSlices & (1u << s))
+            {
+                const DataSpace<DIM2> localCell(threadId[slices.transpose[s].x()], threadId[slices.transpose[s].y()]);
+                getCounter(shBlock, blockSize, slices, s)(localCell) = float_X(0.0);
+            }
+        }
+
+
+        if (localId == 0)
+        {
+            frame = pb.getFirstFrame(block);
+        }
+        __syncthreads();
+
+        while (frame.isValid()) //move over all Frames
+        {
+            auto particle = frame[localId];
+            if (particle[multiMask_] == 1)
+            {
+                int cellIdx = particle[localCellIdx_];
+                const DataSpace<simDim> particleCellId(DataSpaceOperations<simDim>::template map<Block > (cellIdx));
+                const float_X weighting = particle[weighting_] / particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE;
+                for (uint32_t s = 0; s < slices.numSlices; ++s)
+                {
+                    if (!(validSlices & (1u << s)))
+                        continue;
+#if( SIMDIM==DIM3 )
+                    const uint32_t sliceDim = slices.sliceDim[s];
+                    uint32_t globalParticleCell = particleCellId[sliceDim] + slices.globalOffset[s] + blockOffset[sliceDim];
+                    if (globalParticleCell != slices.slice[s])
+                        continue;
+#endif
+                    const DataSpace<DIM2> reducedCell(particleCellId[slices.transpose[s].x()], particleCellId[slices.transpose[s].y()]);
+                    SharedMem counter = getCounter(shBlock, blockSize, slices, s);
+                    atomicAddWrapper(&(counter(reducedCell)), weighting);
+                }
+            }
+            __syncthreads();
+
+            if (localId == 0)
+            {
+                frame = pb.getNextFrame(frame);
+            }
+            __syncthreads();
+        }
+
+
+        for (uint32_t s = 0; s < slices.numSlices; ++s)
+        {
+            if (imageSlices & (1u << s))
+            {
+                const DataSpace<DIM2> localCell(threadId[slices.transpose[s].x()], threadId[slices.transpose[s].y()]);
+                /*index in image*/
+                const DataSpace<DIM2> imageCell(realCell[slices.transpose[s].x()], realCell[slices.transpose[s].y()]);
+                vis_kernels::addDensity(slices.image[s](imageCell),
+                                        getCounter(shBlock, blockSize, slices, s)(localCell));
+            }
+        }
+    }
+
+private:
+
+    /* particle counter of a slice in shared memory, always DIM2 */
+    template<class T_SliceSet>
+    DINLINE DataBox < PitchedBox< float_X, DIM2 > >
+    getCounter(float_X* shBlock, const DataSpace<simDim>& blockSize, const T_SliceSet& slices, const uint32_t s) const
+    {
+        return DataBox < PitchedBox< float_X, DIM2 > >(
+            PitchedBox<float_X, DIM2 > (shBlock + slices.sharedOffset[s],
+                                        DataSpace<DIM2 > (),
+                                        blockSize[slices.transpose[s].x()] * sizeof (float_X)));
+    }
+};
+
+/**
+ * Visualizes several slices of a species with one pass over fields and
+ * particles and one collective to gather the images.
+ *
+ * Creates the same images as one Visualisation instance per slice.
+ * The object is notified with the greatest common divisor of the periods
+ * of the slices and renders all slices due in a step together.
+ */
+template<class ParticlesType, class Output>
+class VisualisationBatch : public INotify
+{
+private:
+    typedef MappingDesc::SuperCellSize SuperCellSize;
+
+public:
+    /** maximum number of slices, one bit per slice in the particle kernel */
+    static constexpr uint32_t maxSlices = 32;
+    typedef vis_kernels::SliceSet<maxSlices> SliceSetType;
+    typedef typename ParticlesType::FrameType FrameType;
+    typedef Output CreatorType;
+
+    VisualisationBatch() :
+    cellDescription(nullptr),
+    particleTag(ParticlesType::FrameType::getName()),
+    reduce(1024)
+    {
+    }
+
+    virtual ~VisualisationBatch()
+    {
+        for (size_t s = 0; s < slices.size(); ++s)
+        {
+            /* wait that shared buffers can destroyed */
+            slices[s]->output.join();
+            __delete(slices[s]->img);
+            MessageHeader::destroy(slices[s]->header);
+            __delete(slices[s]);
+        }
+        slices.clear();
+    }
+
+    /** add a slice, must be called before init() */
+    void addSlice(Output output, uint32_t notifyPeriod, DataSpace<DIM2> transpose, float_X slicePoint)
+    {
+        if (slices.size() == maxSlices)
+            throw std::runtime_error("[Png Plugin] too many slices for batched rendering");
+        slices.push_back(new Slice(output, notifyPeriod, transpose, slicePoint));
+    }
+
+    void notify(uint32_t currentStep)
+    {
+        PMACC_ASSERT(cellDescription != nullptr);
+        Window window(MovingWindow::getInstance().getWindow(currentStep));
+
+        std::vector<uint32_t> selected;
+        for (uint32_t s = 0; s < slices.size(); ++s)
+        {
+            if (currentStep % slices[s]->notifyPeriod != 0)
+                continue;
+            /*sliceOffset is only used in 3D*/
+            slices[s]->updateSliceOffset(window);
+            selected.push_back(s);
+        }
+
+        if (!selected.empty())
+            createImages(currentStep, window, selected);
+    }
+
+    void setMappingDescription(MappingDesc *cellDescription)
+    {
+        PMACC_ASSERT(cellDescription != nullptr);
+        this->cellDescription = cellDescription;
+    }
+
+    void init()
+    {
+        PMACC_ASSERT(cellDescription != nullptr);
+        if (slices.empty())
+            return;
+
+        Window window(MovingWindow::getInstance().getWindow(0));
+        const DataSpace<simDim> gpus = Environment<simDim>::get().GridController().getGpuNodes();
+
+        float_32 cellSizeArr[3] = {0, 0, 0};
+        for (uint32_t i = 0; i < simDim; ++i)
+            cellSizeArr[i] = cellSize[i];
+
+        std::vector<bool> isDrawing(slices.size());
+        std::vector<int> bytes(slices.size());
+        uint32_t period = 0;
+        for (size_t s = 0; s < slices.size(); ++s)
+        {
+            Slice& slice = *slices[s];
+            slice.updateSliceOffset(window);
+
+            slice.header = MessageHeader::create();
+            slice.header->update(*cellDescription, window, slice.transpose, 0, cellSizeArr, gpus);
+
+            slice.isDrawing = slice.doDrawing();
+            isDrawing[s] = slice.isDrawing;
+            bytes[s] = slice.header->node.maxSize.productOfComponents() * sizeof (float3_X);
+
+            /* create memory for the local picture if the gpu participate on the visualization */
+            if (slice.isDrawing)
+                slice.img = new GridBuffer<float3_X, DIM2 > (slice.header->node.maxSize);
+
+            /* greatest common divisor of the periods */
+            uint32_t a = period;
+            uint32_t b = slice.notifyPeriod;
+            while (b != 0)
+            {
+                const uint32_t t = a % b;
+                a = b;
+                b = t;
+            }
+            period = a;
+        }
+
+        /* the global rank is the rank in the communicator of the grid */
+        isMaster = gather.init(isDrawing, bytes, MessageHeader::bytes,
+                               Environment<simDim>::get().GridController().getCommunicator().getMPIComm());
+        /* all ranks take part in the reduce of the slices' maxima */
+        mpiReduce.participate(true);
+
+        Environment<>::get().PluginConnector().setNotificationPeriod(this, period);
+    }
+
+private:
+
+    struct Slice
+    {
+        Slice(Output output, uint32_t notifyPeriod, DataSpace<DIM2> transpose, float_X slicePoint) :
+        output(output),
+        notifyPeriod(notifyPeriod),
+        transpose(transpose),
+        slicePoint(slicePoint),
+        sliceOffset(0),
+        isDrawing(false),
+        header(nullptr),
+        img(nullptr)
+        {
+            sliceDim = 0;
+            if (transpose.x() == 0 || transpose.y() == 0)
+                sliceDim = 1;
+            if ((transpose.x() == 1 || transpose.y() == 1) && sliceDim == 1)
+                sliceDim = 2;
+        }
+
+        void updateSliceOffset(const Window& window)
+        {
+            sliceOffset = (int) ((float_32) (window.globalDimensions.size[sliceDim]) * slicePoint) + window.globalDimensions.offset[sliceDim];
+        }
+
+        bool doDrawing() const
+        {
+#if(SIMDIM==DIM3)
+            const DataSpace<simDim> globalRootCellPos(Environment<simDim>::get().SubGrid().getLocalDomain().offset);
+            return globalRootCellPos[sliceDim] + Environment<simDim>::get().SubGrid().getLocalDomain().size[sliceDim] > sliceOffset &&
+                globalRootCellPos[sliceDim] <= sliceOffset;
+#else
+            return true;
+#endif
+        }
+
+        Output output;
+        uint32_t notifyPeriod;
+        DataSpace<DIM2> transpose;
+        float_X slicePoint;
+        uint32_t sliceDim;
+        int sliceOffset;
+        bool isDrawing;
+        MessageHeader* header;
+        GridBuffer<float3_X, DIM2 >* img;
+    };
+
+    typedef DataBox<PitchedBox<float3_X, DIM2> > HostBox;
+
+    void createImages(uint32_t currentStep, Window window, const std::vector<uint32_t>& selected)
+    {
+        DataConnector &dc = Environment<>::get().DataConnector();
+        // Data does not need to be synchronized as visualization is
+        // done at the device.
+        auto fieldB = dc.get< FieldB >( FieldB::getName(), true );
+        auto fieldE = dc.get< FieldE >( FieldE::getName(), true );
+        auto fieldJ = dc.get< FieldJ >( FieldJ::getName(), true );
+        auto particles = dc.get< ParticlesType >( particleTag, true );
+
+        /* selected slices this gpu participates on */
+        std::vector<uint32_t> drawing;
+        SliceSetType sliceSet;
+        sliceSet.numSlices = 0;
+        uint32_t sharedElements = 0;
+        const DataSpace<simDim> blockSize(MappingDesc::SuperCellSize::toRT());
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            Slice& slice = *slices[selected[i]];
+            /* wait that shared buffers can accessed without conflicts */
+            slice.output.join();
+            if (!slice.isDrawing)
+                continue;
+
+            const uint32_t n = sliceSet.numSlices++;
+            drawing.push_back(selected[i]);
+            sliceSet.image[n] = slice.img->getDeviceBuffer().getDataBox();
+            sliceSet.transpose[n] = slice.transpose;
+            sliceSet.slice[n] = slice.sliceOffset;
+            sliceSet.globalOffset[n] = 0;
+#if(SIMDIM==DIM3)
+            sliceSet.globalOffset[n] = Environment<simDim>::get().SubGrid().getLocalDomain().offset[slice.sliceDim];
+#endif
+            sliceSet.sliceDim[n] = slice.sliceDim;
+            sliceSet.sharedOffset[n] = sharedElements;
+            sharedElements += blockSize[slice.transpose.x()] * blockSize[slice.transpose.y()];
+        }
+
+        PMACC_ASSERT(cellDescription != nullptr);
+        AreaMapping<CORE + BORDER, MappingDesc> mapper(*cellDescription);
+        //create image fields
+        if (sliceSet.numSlices != 0)
+        {
+            PMACC_KERNEL(KernelPaintFieldsBatch{})
+                (mapper.getGridDim(), SuperCellSize::toRT())
+                (fieldE->getDeviceDataBox(),
+                 fieldB->getDeviceDataBox(),
+                 fieldJ->getDeviceDataBox(),
+                 sliceSet,
+                 mapper
+                 );
+        }
+
+        // maximum of img.x()/y and z of each slice, one reduce for all slices
+        std::vector<float3_X> max(selected.size(), float3_X::create(1.0));
+#if (EM_FIELD_SCALE_CHANNEL1 == -1 || EM_FIELD_SCALE_CHANNEL2 == -1 || EM_FIELD_SCALE_CHANNEL3 == -1)
+        typedef DataBoxDim1Access<typename GridBuffer<float3_X, DIM2 >::DataBoxType> D1Box;
+        std::vector<float3_X> localMax(selected.size(), float3_X::create(-FLT_MAX));
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            Slice& slice = *slices[selected[i]];
+            if (!slice.isDrawing)
+                continue;
+            int elements = slice.img->getGridLayout().getDataSpace().productOfComponents();
+            D1Box d1access(slice.img->getDeviceBuffer().getDataBox(), slice.img->getGridLayout().getDataSpace());
+            localMax[i] = reduce(nvidia::functors::Max(),
+                                 d1access,
+                                 elements);
+        }
+        mpiReduce(nvidia::functors::Max(), &max[0], &localMax[0], selected.size());
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+#if (EM_FIELD_SCALE_CHANNEL1 != -1 )
+            max[i].x() = float_X(1.0);
+#endif
+#if (EM_FIELD_SCALE_CHANNEL2 != -1 )
+            max[i].y() = float_X(1.0);
+#endif
+#if (EM_FIELD_SCALE_CHANNEL3 != -1 )
+            max[i].z() = float_X(1.0);
+#endif
+        }
+#endif
+
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            Slice& slice = *slices[selected[i]];
+            if (!slice.isDrawing)
+                continue;
+            normalizeChannels(*slice.img, max[i]);
+        }
+
+        //create image particles
+        if (sliceSet.numSlices != 0)
+        {
+            PMACC_KERNEL(KernelPaintParticlesBatch{})
+                (mapper.getGridDim(), SuperCellSize::toRT(), sharedElements * sizeof (float_X))
+                (particles->getDeviceParticlesBox(),
+                 sliceSet,
+                 mapper
+                 );
+        }
+
+        // send the RGB images back to host
+        for (size_t i = 0; i < drawing.size(); ++i)
+            slices[drawing[i]]->img->deviceToHost();
+
+        std::vector<HostBox> hostBoxes(slices.size());
+        std::vector<MessageHeader*> headers(slices.size());
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            Slice& slice = *slices[selected[i]];
+            slice.header->update(*cellDescription, window, slice.transpose, currentStep);
+            headers[selected[i]] = slice.header;
+        }
+
+        __getTransactionEvent().waitForFinished(); //wait for copy pictures
+
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            Slice& slice = *slices[selected[i]];
+            if (!slice.isDrawing)
+                continue;
+
+            DataSpace<DIM2> size = slice.img->getGridLayout().getDataSpace();
+            auto hostBox = slice.img->getHostBuffer().getDataBox();
+
+            if (picongpu::white_box_per_GPU)
+            {
+                hostBox[0 ][0 ] = float3_X(1.0, 1.0, 1.0);
+                hostBox[size.y() - 1 ][0 ] = float3_X(1.0, 1.0, 1.0);
+                hostBox[0 ][size.x() - 1] = float3_X(1.0, 1.0, 1.0);
+                hostBox[size.y() - 1 ][size.x() - 1] = float3_X(1.0, 1.0, 1.0);
+            }
+            hostBoxes[selected[i]] = hostBox;
+        }
+
+        std::vector<HostBox> resultBoxes = gather(selected, hostBoxes, headers);
+        for (size_t i = 0; i < selected.size(); ++i)
+        {
+            Slice& slice = *slices[selected[i]];
+            if (isMaster[selected[i]])
+                slice.output(resultBoxes[selected[i]].shift(slice.header->window.offset), slice.header->window.size, *slice.header);
+        }
+    }
+
+    /* scale the channels of an image with the maximum and convert them to RGB */
+    void normalizeChannels(GridBuffer<float3_X, DIM2 >& img, const float3_X max)
+    {
+        int elements = img.getGridLayout().getDataSpace().productOfComponents();
+
+        //Add one dimension access to 2d DataBox
+        typedef DataBoxDim1Access<typename GridBuffer<float3_X, DIM2 >::DataBoxType> D1Box;
+        D1Box d1access(img.getDeviceBuffer().getDataBox(), img.getGridLayout().getDataSpace());
+
+#if (EM_FIELD_SCALE_CHANNEL1 == -1 || EM_FIELD_SCALE_CHANNEL2 == -1 || EM_FIELD_SCALE_CHANNEL3 == -1)
+        //We don't know the superCellSize at compile time
+        // (because of the runtime dimension selection in any plugin),
+        // thus we must use a one dimension kernel and no mapper
+        PMACC_KERNEL(vis_kernels::DivideAnyCell{})(ceil((float_64) elements / 256), 256)(d1access, elements, max);
+#endif
+
+        // convert channels to RGB
+        PMACC_KERNEL(vis_kernels::ChannelsToRGB{})(ceil((float_64) elements / 256), 256)(d1access, elements);
+    }
+
+    MappingDesc *cellDescription;
+    SimulationDataId particleTag;
+
+    std::vector<Slice*> slices;
+    std::vector<bool> isMaster;
+
+    GatherSlices gather;
+    ::PMacc::nvidia::reduce::Reduce reduce;
+    ::PMacc::mpi::MPIReduce mpiReduce;
+};
+
+}
@@ -1,4 +1,4 @@
-/* Copyright 2013-2017 Rene Widera, Axel Huebl
+/* Copyright 2013-2017 Rene Widera, Axel Huebl, agent
  *
  * This file is part of PIConGPU.
  *
@@ -33,6 +33,7 @@
 #include <unistd.h>
 
 #include <iostream>
+#include <vector>
 
 #include "plugins/output/compression/ZipConnector.hpp"
 #include <sstream>
@@ -55,7 +56,13 @@ private:
     }
 public:
 
-    SocketConnector(std::string ip, std::string port) : connectOK(true)
+    /** connect to a live view server
+     *
+     * @param compressLevel zlib compression level [0,9], 1 is the fastest
+     */
+    SocketConnector(std::string ip, std::string port, int compressLevel = 6) :
+        connectOK(true),
+        m_compressLevel(compressLevel)
     {
         SocketFD = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 
@@ -102,17 +109,21 @@ public:
     {
         if (connectOK)
         {
-            char* tmp = new char[size];
+            const size_t maxZipedSize = ZipConnector::maxCompressedSize(size - MessageHeader::bytes);
+            /* the buffer is reused for all messages */
+            buffer.resize(MessageHeader::bytes + maxZipedSize);
+            char* tmp = &buffer[0];
             memcpy(tmp, array, sizeof(MessageHeader));
 
             ZipConnector zip;
-            size_t zipedSize = zip.compress(tmp + MessageHeader::bytes, ((char*) array) + MessageHeader::bytes, size - MessageHeader::bytes, 6);
+            size_t zipedSize = zip.compress(tmp + MessageHeader::bytes, ((char*) array) + MessageHeader::bytes, size - MessageHeader::bytes, m_compressLevel, maxZipedSize);
             MessageHeader* header = (MessageHeader*) tmp;
             header->data.byte = (uint32_t) zipedSize;
+            header->stream.sequence = 0;
+            header->stream.flags = 0;
             int nbytes = write(SocketFD, tmp, zipedSize + MessageHeader::bytes);
             if (nbytes < 0)
                 perror("a socket write error occured");
-            __deleteArray(tmp);
         }
     }
 
@@ -130,6 +141,8 @@ private:
     int Res;
     int SocketFD;
     bool connectOK;
+    int m_compressLevel;
+    std::vector<char> buffer;
 
 };
 
@@ -0,0 +1,555 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "plugins/output/header/StreamHeader.hpp"
+#include "plugins/output/compression/ZipConnector.hpp"
+
+#include <boost/thread.hpp>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <stdexcept>
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+
+/** ring buffer of live view frames
+ *
+ * Frames are copied into preallocated slots. If all slots are occupied the
+ * oldest frame is overwritten (drop-oldest policy). Each frame gets an
+ * increasing sequence number so that a reader can detect dropped frames.
+ *
+ * The ring buffer is not thread safe.
+ */
+class FrameRingBuffer
+{
+public:
+
+    struct Frame
+    {
+        uint64_t sequence;
+        /* message header followed by the uncompressed image */
+        std::vector<char> message;
+    };
+
+    FrameRingBuffer(uint32_t capacity) :
+        slots(std::max(capacity, 1u)),
+        numPushed(0)
+    {
+    }
+
+    /** copy a message into the ring
+     *
+     * Memory of an overwritten slot is reused, therefore the ring does not
+     * allocate memory as long as the message size is not growing.
+     *
+     * @return sequence number of the new frame
+     */
+    uint64_t push(const char* message, size_t bytes)
+    {
+        Frame& slot = slots[numPushed % slots.size()];
+        slot.sequence = numPushed;
+        slot.message.assign(message, message + bytes);
+        return numPushed++;
+    }
+
+    bool empty() const
+    {
+        return numPushed == 0;
+    }
+
+    /** sequence number of the oldest frame which is still stored */
+    uint64_t oldest() const
+    {
+        return numPushed > slots.size() ? numPushed - slots.size() : 0;
+    }
+
+    /** sequence number of the latest frame (only valid if not empty) */
+    uint64_t newest() const
+    {
+        return numPushed - 1;
+    }
+
+    /** get a frame, sequence must be in [oldest(),newest()] */
+    const Frame& get(uint64_t sequence) const
+    {
+        return slots[sequence % slots.size()];
+    }
+
+private:
+
+    std::vector<Frame> slots;
+    uint64_t numPushed;
+};
+
+/** live view server which streams frames to any number of clients
+ *
+ * The simulation thread only copies a frame into a ring buffer, all network
+ * operations, the delta encoding and the compression are done by a
+ * background thread. Sockets are non-blocking: a slow client is never
+ * waited for, it skips frames which were overwritten in the ring buffer.
+ *
+ * Each message sent to a client is a header (`T_Header::bytes`) followed by
+ * `header.data.byte` zlib compressed bytes. If `header.stream.isDelta()` is
+ * true the decompressed payload must be XORed with the previous frame the
+ * client received (see StreamDecoder).
+ *
+ * @tparam T_Header message header with the members `data` (DataHeader) and
+ *                  `stream` (StreamHeader), e.g. MessageHeader
+ */
+template<class T_Header>
+class StreamServer
+{
+public:
+
+    /** create the server and start the background thread
+     *
+     * @param ip address to bind (e.g. "0.0.0.0" for all interfaces or "127.0.0.1")
+     * @param port port to listen on, 0 selects a free port (see getPort())
+     * @param numBufferedFrames number of frames kept for slow clients
+     * @param compressLevel zlib compression level [0,9]
+     * @param useDelta send frames as difference to the previous frame
+     */
+    StreamServer(
+        std::string ip,
+        std::string port,
+        uint32_t numBufferedFrames = 4u,
+        int compressLevel = 1,
+        bool useDelta = true
+    ) :
+        ring(numBufferedFrames),
+        numSubscribers(0),
+        m_compressLevel(compressLevel),
+        m_useDelta(useDelta),
+        m_stop(false),
+        m_port(0)
+    {
+        listenFD = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (-1 == listenFD)
+            throw std::runtime_error(std::string("[Live View] cannot create socket: ") + strerror(errno));
+
+        int reuse = 1;
+        setsockopt(listenFD, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof (addr));
+        addr.sin_family = AF_INET;
+        std::stringstream s_port(port);
+        uint16_t portAsInt = 0;
+        s_port >> portAsInt;
+        addr.sin_port = htons(portAsInt);
+        if (1 != inet_pton(AF_INET, ip.c_str(), &addr.sin_addr))
+        {
+            close(listenFD);
+            throw std::runtime_error(std::string("[Live View] invalid server address: ") + ip);
+        }
+
+        if (-1 == bind(listenFD, (struct sockaddr *) &addr, sizeof (addr)) ||
+            -1 == listen(listenFD, SOMAXCONN))
+        {
+            const std::string errorMsg(strerror(errno));
+            close(listenFD);
+            throw std::runtime_error(std::string("[Live View] cannot listen on ") + ip + ":" + port + ": " + errorMsg);
+        }
+        setNonBlocking(listenFD);
+
+        socklen_t addrLen = sizeof (addr);
+        if (0 == getsockname(listenFD, (struct sockaddr *) &addr, &addrLen))
+            m_port = ntohs(addr.sin_port);
+
+        /* self-pipe to wake up the worker if a frame arrives or on shutdown */
+        if (-1 == pipe(wakeFDs))
+        {
+            close(listenFD);
+            throw std::runtime_error(std::string("[Live View] cannot create pipe: ") + strerror(errno));
+        }
+        setNonBlocking(wakeFDs[0]);
+        setNonBlocking(wakeFDs[1]);
+
+        workerThread = boost::thread(&StreamServer::run, this);
+    }
+
+    virtual ~StreamServer()
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(ringMutex);
+            m_stop = true;
+        }
+        wakeUp();
+        workerThread.join();
+
+        for (SubscriberIterator it = subscribers.begin(); it != subscribers.end(); ++it)
+            close(it->socketFD);
+        close(listenFD);
+        close(wakeFDs[0]);
+        close(wakeFDs[1]);
+    }
+
+    /** publish a frame
+     *
+     * Never blocks on the network. The message is copied and can be reused
+     * after the call.
+     *
+     * @param message T_Header followed by the uncompressed image
+     * @param size size of the message in byte
+     */
+    void send(const void* message, size_t size)
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(ringMutex);
+            ring.push((const char*) message, size);
+        }
+        wakeUp();
+    }
+
+    /** port the server is listening on */
+    uint16_t getPort() const
+    {
+        return m_port;
+    }
+
+    /** number of currently connected clients */
+    size_t getNumSubscribers() const
+    {
+        boost::lock_guard<boost::mutex> lock(ringMutex);
+        return numSubscribers;
+    }
+
+private:
+
+    struct Subscriber
+    {
+        int socketFD;
+        /* sequence number of the next frame to send */
+        uint64_t nextSequence;
+        /* last frame sent (uncompressed), base of the delta encoding */
+        std::vector<char> reference;
+        bool hasReference;
+        /* encoded message which is currently sent */
+        std::vector<char> out;
+        size_t outOffset;
+
+        Subscriber(int fd, uint64_t firstSequence) :
+            socketFD(fd), nextSequence(firstSequence), hasReference(false), outOffset(0)
+        {
+        }
+
+        bool isSending() const
+        {
+            return outOffset < out.size();
+        }
+    };
+
+    typedef std::list<Subscriber> SubscriberList;
+    typedef typename SubscriberList::iterator SubscriberIterator;
+
+    static void setNonBlocking(int fd)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+
+    void wakeUp()
+    {
+        const char c = 0;
+        /* a full pipe already guarantees a wake up, the result can be ignored */
+        ssize_t result = write(wakeFDs[1], &c, 1);
+        (void) result;
+    }
+
+    void run()
+    {
+        std::vector<struct pollfd> fds;
+        /* thread local copy of a frame, memory is reused between frames */
+        std::vector<char> frame;
+        std::vector<char> delta;
+
+        while (true)
+        {
+            fds.clear();
+            struct pollfd pfd;
+            pfd.fd = wakeFDs[0];
+            pfd.events = POLLIN;
+            fds.push_back(pfd);
+            pfd.fd = listenFD;
+            fds.push_back(pfd);
+            for (SubscriberIterator it = subscribers.begin(); it != subscribers.end(); ++it)
+            {
+                pfd.fd = it->socketFD;
+                pfd.events = it->isSending() ? (POLLIN | POLLOUT) : POLLIN;
+                fds.push_back(pfd);
+            }
+
+            if (poll(&fds[0], fds.size(), -1) < 0 && errno != EINTR)
+            {
+                perror("[Live View] poll failed");
+                return;
+            }
+
+            /* drain wake up pipe */
+            char drain[64];
+            while (read(wakeFDs[0], drain, sizeof (drain)) > 0)
+            {
+            }
+
+            {
+                boost::lock_guard<boost::mutex> lock(ringMutex);
+                if (m_stop)
+                    return;
+            }
+
+            /* check subscribers (before new subscribers change the fd order) */
+            size_t fdIdx = 2;
+            for (SubscriberIterator it = subscribers.begin(); it != subscribers.end(); ++fdIdx)
+            {
+                bool isClosed = (fds[fdIdx].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+                if (!isClosed && (fds[fdIdx].revents & POLLIN))
+                {
+                    /* clients do not send data, a read of zero bytes means the client is gone */
+                    ssize_t numRead = recv(it->socketFD, drain, sizeof (drain), 0);
+                    isClosed = numRead == 0 || (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK);
+                }
+                if (isClosed)
+                    it = removeSubscriber(it);
+                else
+                    ++it;
+            }
+
+            if (fds[1].revents & POLLIN)
+                acceptSubscribers();
+
+            for (SubscriberIterator it = subscribers.begin(); it != subscribers.end();)
+            {
+                /* send frames until the socket would block or the client is up to date,
+                 * poll wakes up only for new frames or a writable socket with pending data */
+                bool isConnected = true;
+                while (isConnected)
+                {
+                    if (!it->isSending())
+                        encodeNextFrame(*it, frame, delta);
+                    if (!it->isSending())
+                        break;
+                    isConnected = sendPending(*it);
+                    if (it->isSending())
+                        break;
+                }
+
+                if (!isConnected)
+                    it = removeSubscriber(it);
+                else
+                    ++it;
+            }
+        }
+    }
+
+    void acceptSubscribers()
+    {
+        int fd;
+        while ((fd = accept(listenFD, nullptr, nullptr)) >= 0)
+        {
+            setNonBlocking(fd);
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof (noDelay));
+
+            boost::lock_guard<boost::mutex> lock(ringMutex);
+            /* a new client starts with the latest frame */
+            subscribers.push_back(Subscriber(fd, ring.empty() ? 0 : ring.newest()));
+            numSubscribers = subscribers.size();
+        }
+    }
+
+    SubscriberIterator removeSubscriber(SubscriberIterator it)
+    {
+        close(it->socketFD);
+        boost::lock_guard<boost::mutex> lock(ringMutex);
+        SubscriberIterator next = subscribers.erase(it);
+        numSubscribers = subscribers.size();
+        return next;
+    }
+
+    /** fetch the next frame for a subscriber and encode it
+     *
+     * If the client is too slow frames which are already overwritten in the
+     * ring buffer are skipped.
+     */
+    void encodeNextFrame(Subscriber& sub, std::vector<char>& frame, std::vector<char>& delta)
+    {
+        uint64_t sequence;
+        {
+            boost::lock_guard<boost::mutex> lock(ringMutex);
+            if (ring.empty() || ring.newest() < sub.nextSequence)
+                return;
+            sequence = std::max(sub.nextSequence, ring.oldest());
+            const FrameRingBuffer::Frame& f = ring.get(sequence);
+            frame.assign(f.message.begin(), f.message.end());
+        }
+        sub.nextSequence = sequence + 1;
+
+        if (frame.size() < T_Header::bytes)
+            return;
+
+        const size_t payloadBytes = frame.size() - T_Header::bytes;
+        char* payload = &frame[0] + T_Header::bytes;
+        char* input = payload;
+
+        const bool isDelta = m_useDelta && sub.hasReference && sub.reference.size() == payloadBytes;
+        if (isDelta)
+        {
+            delta.resize(payloadBytes);
+            for (size_t i = 0; i < payloadBytes; ++i)
+                delta[i] = payload[i] ^ sub.reference[i];
+            input = &delta[0];
+        }
+        if (m_useDelta)
+        {
+            sub.reference.assign(payload, payload + payloadBytes);
+            sub.hasReference = true;
+        }
+
+        const size_t maxBytes = ZipConnector::maxCompressedSize(payloadBytes);
+        sub.out.resize(T_Header::bytes + maxBytes);
+        memcpy(&sub.out[0], &frame[0], T_Header::bytes);
+
+        ZipConnector zip;
+        const size_t zippedBytes = payloadBytes == 0 ? 0 :
+            zip.compress(&sub.out[0] + T_Header::bytes, input, payloadBytes, m_compressLevel, maxBytes);
+
+        T_Header* header = (T_Header*) &sub.out[0];
+        header->data.byte = (uint32_t) zippedBytes;
+        header->stream.sequence = (uint32_t) sequence;
+        header->stream.flags = isDelta ? StreamHeader::DELTA : 0u;
+
+        sub.out.resize(T_Header::bytes + zippedBytes);
+        sub.outOffset = 0;
+    }
+
+    /** send as much of the pending message as possible without blocking
+     *
+     * @return false if the connection is broken
+     */
+    bool sendPending(Subscriber& sub)
+    {
+        while (sub.isSending())
+        {
+            ssize_t nbytes = ::send(sub.socketFD, &sub.out[0] + sub.outOffset, sub.out.size() - sub.outOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (nbytes < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    return true;
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            sub.outOffset += nbytes;
+        }
+        return true;
+    }
+
+    /* guard the ring buffer, the stop flag and the subscriber list modifications */
+    mutable boost::mutex ringMutex;
+    FrameRingBuffer ring;
+    SubscriberList subscribers;
+    size_t numSubscribers;
+
+    int listenFD;
+    int wakeFDs[2];
+    int m_compressLevel;
+    bool m_useDelta;
+    bool m_stop;
+    uint16_t m_port;
+
+    boost::thread workerThread;
+};
+
+/** client side of the StreamServer protocol
+ *
+ * Reconstructs the frames of one connection: decompresses the payload and
+ * undoes the delta encoding with the previous frame of the connection.
+ * Memory is reused between frames.
+ *
+ * @tparam T_Header message header of the server, see StreamServer
+ */
+template<class T_Header>
+class StreamDecoder
+{
+public:
+
+    StreamDecoder() : hasFrame(false)
+    {
+    }
+
+    /** decode a message
+     *
+     * @param header header of the message
+     * @param data `header.data.byte` compressed bytes following the header
+     * @param frameBytes size of the uncompressed image in byte
+     * @return the image, valid until the next call
+     */
+    const std::vector<char>& decode(const T_Header& header, const char* data, size_t frameBytes)
+    {
+        if (header.stream.isDelta() && !(hasFrame && frame.size() == frameBytes))
+            throw std::runtime_error("[Live View] delta frame without the previous frame");
+
+        /* frame still holds the previous image which is the base of the delta */
+        decoded.resize(frameBytes);
+        ZipConnector zip;
+        const size_t numBytes = frameBytes == 0 ? 0 :
+            zip.decompress(&decoded[0], (void*) data, header.data.byte, frameBytes);
+        if (numBytes != frameBytes)
+            throw std::runtime_error("[Live View] frame has not the expected size");
+
+        if (header.stream.isDelta())
+        {
+            for (size_t i = 0; i < frameBytes; ++i)
+                frame[i] ^= decoded[i];
+        }
+        else
+            frame.swap(decoded);
+        hasFrame = true;
+        return frame;
+    }
+
+private:
+
+    std::vector<char> frame;
+    std::vector<char> decoded;
+    bool hasFrame;
+};
+
+} //namespace picongpu
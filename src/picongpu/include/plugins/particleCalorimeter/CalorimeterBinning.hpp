@@ -0,0 +1,161 @@
+/* Copyright 2016-2017 Heiko Burau, agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "pmacc_types.hpp"
+#include "math/Vector.hpp"
+#include "algorithms/math.hpp"
+
+/* this file is used by host only tools, it must not depend on the simulation
+ * (simulation_defines.hpp) */
+
+namespace picongpu
+{
+namespace particleCalorimeter
+{
+
+/** bins of the particle calorimeter
+ *
+ * The calorimeter has numBinsYaw x numBinsPitch x numBinsEnergy bins. The
+ * direction of a particle is rotated into the calorimeter frame and binned
+ * by yaw and pitch, the energy bins are linear or logarithmic spaced with
+ * one bin for all energies below and one for all above the range.
+ *
+ * @tparam T_Float floating point type of the momenta and energies, float_X in the simulation
+ */
+template<typename T_Float>
+struct CalorimeterBinning
+{
+    typedef T_Float float_T;
+    typedef PMacc::math::Vector<float_T, 2> float2_T;
+    typedef PMacc::math::Vector<float_T, 3> float3_T;
+
+    const float_T maxYaw;
+    const float_T maxPitch;
+    const uint32_t numBinsYaw;
+    const uint32_t numBinsPitch;
+    const int32_t numBinsEnergy;
+    /* depending on `logScale` the energy range is initialized
+     * with the logarithmic or the linear value. */
+    const float_T minEnergy;
+    const float_T maxEnergy;
+    const bool logScale;
+
+    const float3_T calorimeterFrameVecX;
+    const float3_T calorimeterFrameVecY;
+    const float3_T calorimeterFrameVecZ;
+
+    CalorimeterBinning(const float_T maxYaw,
+                       const float_T maxPitch,
+                       const uint32_t numBinsYaw,
+                       const uint32_t numBinsPitch,
+                       const uint32_t numBinsEnergy,
+                       const float_T minEnergy,
+                       const float_T maxEnergy,
+                       const bool logScale,
+                       const float3_T calorimeterFrameVecX,
+                       const float3_T calorimeterFrameVecY,
+                       const float3_T calorimeterFrameVecZ) :
+        maxYaw(maxYaw),
+        maxPitch(maxPitch),
+        numBinsYaw(numBinsYaw),
+        numBinsPitch(numBinsPitch),
+        numBinsEnergy(numBinsEnergy),
+        minEnergy(minEnergy),
+        maxEnergy(maxEnergy),
+        logScale(logScale),
+        calorimeterFrameVecX(calorimeterFrameVecX),
+        calorimeterFrameVecY(calorimeterFrameVecY),
+        calorimeterFrameVecZ(calorimeterFrameVecZ)
+    {}
+
+    /** number of bins of the calorimeter */
+    HDINLINE int32_t getNumBins() const
+    {
+        return static_cast<int32_t>(numBinsYaw * numBinsPitch) * numBinsEnergy;
+    }
+
+    /** bin of a particle
+     *
+     * @param mom momentum of the particle
+     * @param energy kinetic energy of the particle
+     * @param mapYawPitch functor mapYawPitch(yaw, pitch, maxYaw, maxPitch) returning the
+     *        position in the normalized range of the calorimeter (float2_T), see
+     *        mapYawPitchToNormedRange in particleCalorimeter.param
+     * @return linear bin index yawBin + numBinsYaw * (pitchBin + numBinsPitch * energyBin),
+     *         -1 if the particle does not hit the calorimeter
+     */
+    template<typename T_MapYawPitch>
+    HDINLINE int32_t getBin(const float3_T& mom, const float_T energy, const T_MapYawPitch& mapYawPitch) const
+    {
+        using namespace PMacc::algorithms::math;
+
+        const float_T mom2 = dot(mom, mom);
+        float3_T dirVec = mom * rsqrt(mom2);
+
+        /* rotate dirVec into the calorimeter frame. This coordinate transformation
+         * is performed by a matrix vector multiplication. */
+        dirVec = float3_T(dot(this->calorimeterFrameVecX, dirVec),
+                          dot(this->calorimeterFrameVecY, dirVec),
+                          dot(this->calorimeterFrameVecZ, dirVec));
+
+        /* convert dirVec to yaw and pitch */
+        const float_T yaw = atan2(dirVec.x(), dirVec.y());
+        const float_T pitch = asin(dirVec.z());
+
+        if(!(abs(yaw) < this->maxYaw && abs(pitch) < this->maxPitch))
+            return -1;
+
+        const float2_T calorimeterPos = mapYawPitch(yaw, pitch, this->maxYaw, this->maxPitch);
+
+        // yaw
+        int32_t yawBin = calorimeterPos.x() * static_cast<float_T>(numBinsYaw);
+        // catch out-of-range values
+        yawBin = yawBin >= static_cast<int32_t>(numBinsYaw) ? static_cast<int32_t>(numBinsYaw) - 1 : yawBin;
+        yawBin = yawBin < 0 ? 0 : yawBin;
+
+        // pitch
+        int32_t pitchBin = calorimeterPos.y() * static_cast<float_T>(numBinsPitch);
+        // catch out-of-range values
+        pitchBin = pitchBin >= static_cast<int32_t>(numBinsPitch) ? static_cast<int32_t>(numBinsPitch) - 1 : pitchBin;
+        pitchBin = pitchBin < 0 ? 0 : pitchBin;
+
+        // energy
+        int32_t energyBin = 0;
+        if(this->numBinsEnergy > 1)
+        {
+            const int32_t numBinsOutOfRange = 2;
+            energyBin = float2int_rd(((logScale ? log10(energy) : energy) - minEnergy) /
+                (maxEnergy - minEnergy) * static_cast<float_T>(this->numBinsEnergy - numBinsOutOfRange)) + 1;
+
+            // all entries larger than maxEnergy go into last bin
+            energyBin = energyBin < this->numBinsEnergy ? energyBin : this->numBinsEnergy - 1;
+
+            // all entries smaller than minEnergy go into bin zero
+            energyBin = energyBin > 0 ? energyBin : 0;
+        }
+
+        return yawBin + static_cast<int32_t>(numBinsYaw) *
+            (pitchBin + static_cast<int32_t>(numBinsPitch) * energyBin);
+    }
+};
+
+} // namespace particleCalorimeter
+} // namespace picongpu
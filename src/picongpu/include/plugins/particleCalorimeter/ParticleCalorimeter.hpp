@@ -1,4 +1,4 @@
-/* Copyright 2016-2017 Heiko Burau
+/* Copyright 2016-2017 Heiko Burau, agent
  *
  * This file is part of PIConGPU.
  *
@@ -27,12 +27,13 @@
 
 #include "cuSTL/container/DeviceBuffer.hpp"
 #include "cuSTL/container/HostBuffer.hpp"
-#include "cuSTL/algorithm/kernel/Foreach.hpp"
-#include "cuSTL/cursor/MultiIndexCursor.hpp"
 #include "cuSTL/algorithm/mpi/Reduce.hpp"
 #include "cuSTL/algorithm/host/Foreach.hpp"
 #include "particles/policies/ExchangeParticles.hpp"
 #include "dataManagement/DataConnector.hpp"
+#include "mappings/kernel/AreaMapping.hpp"
+#include "mappings/kernel/ExchangeMapping.hpp"
+#include "nvidia/gpuEntryFunction.hpp"
 #include "math/Vector.hpp"
 #include "algorithms/math.hpp"
 
@@ -42,6 +43,7 @@
 
 #include <string>
 #include <iostream>
+#include <algorithm>
 #include <fstream>
 #include <stdlib.h>
 
@@ -101,6 +103,13 @@ private:
     /* host calorimeter buffer for summation of all mpi ranks */
     HBufCalorimeter* hBufTotalCalorimeter;
 
+    /* accumulation of a supercell in shared memory, see particleCalorimeter::Accumulation */
+    int accumulation;
+    /* slots of the hot bin table (Accumulation::hotBins) */
+    int numHotBins;
+    /* bytes of dynamic shared memory of KernelParticleCalorimeter */
+    size_t sharedMemBytes;
+
 public:
     typedef CalorimeterFunctor<typename DBufCalorimeter::Cursor> MyCalorimeterFunctor;
 private:
@@ -255,6 +264,47 @@ private:
         /* fill calorimeter for left particles with zero */
         this->dBufLeftParsCalorimeter->assign(float_X(0.0));
 
+        /* shared memory of one block: all bins are privatized if they fit
+         * next to the static shared memory of the kernel, else a table of
+         * the bins which are hit most within a supercell, else the particles
+         * are added to the global calorimeter
+         */
+        typedef typename ParticlesType::ParticlesBoxType ParticlesBoxType;
+        const size_t staticSharedMemBytes = std::max(
+            nvidia::getEntryFunctionAttributes<
+                KernelParticleCalorimeter, ParticlesBoxType, MyCalorimeterFunctor, int, int,
+                AreaMapping<CORE + BORDER, MappingDesc> >().sharedSizeBytes,
+            nvidia::getEntryFunctionAttributes<
+                KernelParticleCalorimeter, ParticlesBoxType, MyCalorimeterFunctor, int, int,
+                ExchangeMapping<GUARD, MappingDesc> >().sharedSizeBytes);
+        const size_t maxSharedMemPerBlock = nvidia::getMaxSharedMemPerBlock();
+        const size_t maxSharedMemBytes = maxSharedMemPerBlock > staticSharedMemBytes ?
+            maxSharedMemPerBlock - staticSharedMemBytes : 0;
+        const size_t numBins = size_t(this->numBinsYaw) * this->numBinsPitch * this->numBinsEnergy;
+        const int maxHotBins = 1024;
+        if(numBins * sizeof(float_X) <= maxSharedMemBytes)
+        {
+            this->accumulation = particleCalorimeter::Accumulation::dense;
+            this->numHotBins = 0;
+            this->sharedMemBytes = numBins * sizeof(float_X);
+        }
+        else if(maxHotBins * (sizeof(float_X) + sizeof(int)) <= maxSharedMemBytes)
+        {
+            this->accumulation = particleCalorimeter::Accumulation::hotBins;
+            this->numHotBins = maxHotBins;
+            this->sharedMemBytes = this->numHotBins * (sizeof(float_X) + sizeof(int));
+            log<picLog::MEMORY >("%1%: %2% bins do not fit into shared memory, using %3% hot bins per supercell")
+                % this->prefix % numBins % this->numHotBins;
+        }
+        else
+        {
+            this->accumulation = particleCalorimeter::Accumulation::global;
+            this->numHotBins = 0;
+            this->sharedMemBytes = 0;
+            log<picLog::MEMORY >("%1%: no shared memory left for the bins, using global memory")
+                % this->prefix;
+        }
+
         /* create mpi reduce algorithm */
         PMacc::GridController<simDim>& con = PMacc::Environment<simDim>::get().GridController();
         pm::Size_t<simDim> gpuDim = (pm::Size_t<simDim>)con.getGpuNodes();
@@ -414,7 +464,10 @@ public:
         dBufCalorimeter(nullptr),
         dBufLeftParsCalorimeter(nullptr),
         hBufCalorimeter(nullptr),
-        hBufTotalCalorimeter(nullptr)
+        hBufTotalCalorimeter(nullptr),
+        accumulation(particleCalorimeter::Accumulation::global),
+        numHotBins(0),
+        sharedMemBytes(0)
     {
         Environment<>::get().PluginConnector().registerPlugin(this);
     }
@@ -428,30 +481,16 @@ public:
         /* data is written to dBufCalorimeter */
         this->calorimeterFunctor->setCalorimeterCursor(this->dBufCalorimeter->origin());
 
-        /* create kernel functor instance */
         DataConnector &dc = Environment<>::get().DataConnector();
         auto particles = dc.get< ParticlesType >( ParticlesType::FrameType::getName(), true );
 
-        ParticleCalorimeterKernel<typename ParticlesType::ParticlesBoxType,
-                                  MyCalorimeterFunctor>
-                                  particleCalorimeterKernel(particles->getDeviceParticlesBox(),
-                                                            *this->calorimeterFunctor);
-
-        /* create zone */
-        typedef typename MappingDesc::SuperCellSize SuperCellSize;
-
-        const PMacc::math::Int<simDim> coreBorderGuardSuperCells = this->cellDescription->getGridSuperCells();
-        const uint32_t guardSuperCells = this->cellDescription->getGuardingSuperCells();
-        const PMacc::math::Int<simDim> coreBorderSuperCells = coreBorderGuardSuperCells - 2*guardSuperCells;
-
-        /* this zone represents the core+border area with guard offset in unit of cells */
-        const zone::SphericZone<simDim> zone(
-            static_cast<PMacc::math::Size_t<simDim> >(coreBorderSuperCells * SuperCellSize::toRT()),
-            guardSuperCells * SuperCellSize::toRT());
-
-        /* kernel call */
-        algorithm::kernel::Foreach<SuperCellSize> foreach;
-        foreach(zone, cursor::make_MultiIndexCursor<simDim>(), particleCalorimeterKernel);
+        /* one block per supercell in the core+border area */
+        AreaMapping<CORE + BORDER, MappingDesc> mapper(*this->cellDescription);
+        PMACC_KERNEL(KernelParticleCalorimeter{})
+                (mapper.getGridDim(), MappingDesc::SuperCellSize::toRT(), this->sharedMemBytes)
+                (particles->getDeviceParticlesBox(), (MyCalorimeterFunctor)*this->calorimeterFunctor,
+                 this->accumulation, this->numHotBins, mapper);
+        dc.releaseData( ParticlesType::FrameType::getName() );
 
         /* copy to host */
         *this->hBufCalorimeter = *this->dBufCalorimeter;
@@ -523,8 +562,9 @@ public:
         auto particles = dc.get< ParticlesType >( speciesName, true );
 
         PMACC_KERNEL(KernelParticleCalorimeter{})
-                (grid, mapper.getSuperCellSize())
-                (particles->getDeviceParticlesBox(), (MyCalorimeterFunctor)*this->calorimeterFunctor, mapper);
+                (grid, mapper.getSuperCellSize(), this->sharedMemBytes)
+                (particles->getDeviceParticlesBox(), (MyCalorimeterFunctor)*this->calorimeterFunctor,
+                 this->accumulation, this->numHotBins, mapper);
         dc.releaseData( speciesName );
     }
 };
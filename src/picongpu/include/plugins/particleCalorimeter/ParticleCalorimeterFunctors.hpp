@@ -1,4 +1,4 @@
-/* Copyright 2016-2017 Heiko Burau
+/* Copyright 2016-2017 Heiko Burau, agent
  *
  * This file is part of PIConGPU.
  *
@@ -20,6 +20,7 @@
 #pragma once
 
 #include "simulation_defines.hpp"
+#include "plugins/particleCalorimeter/CalorimeterBinning.hpp"
 #include "algorithms/KinEnergy.hpp"
 #include "math/Vector.hpp"
 #include "algorithms/math.hpp"
@@ -29,25 +30,48 @@ namespace picongpu
 {
 using namespace PMacc;
 
+namespace particleCalorimeter
+{
+
+/** where a block accumulates the calorimeter of its supercell
+ *
+ * The values of a block are added once per supercell to the global
+ * calorimeter, see KernelParticleCalorimeter.
+ */
+struct Accumulation
+{
+    enum
+    {
+        /* each particle is added to the global calorimeter */
+        global = 0,
+        /* all bins are privatized in shared memory */
+        dense = 1,
+        /* a table of the most used bins in shared memory, bins which find
+         * no slot are added to the global calorimeter */
+        hotBins = 2
+    };
+};
+
+/** yaw and pitch in the normalized range, see particleCalorimeter.param */
+struct MapYawPitchToNormedRange
+{
+    HDINLINE float2_X operator()(const float_X yaw,
+                                 const float_X pitch,
+                                 const float_X maxYaw,
+                                 const float_X maxPitch) const
+    {
+        return particleCalorimeter::mapYawPitchToNormedRange(yaw, pitch, maxYaw, maxPitch);
+    }
+};
+
+} // namespace particleCalorimeter
+
 template<typename CalorimeterCur>
-struct CalorimeterFunctor
+struct CalorimeterFunctor : public particleCalorimeter::CalorimeterBinning<float_X>
 {
-    CalorimeterCur calorimeterCur;
+    typedef particleCalorimeter::CalorimeterBinning<float_X> Binning;
 
-    const float_X maxYaw;
-    const float_X maxPitch;
-    const uint32_t numBinsYaw;
-    const uint32_t numBinsPitch;
-    const int32_t numBinsEnergy;
-    /* depending on `logScale` the energy range is initialized
-     * with the logarithmic or the linear value. */
-    const float_X minEnergy;
-    const float_X maxEnergy;
-    const bool logScale;
-
-    const float3_X calorimeterFrameVecX;
-    const float3_X calorimeterFrameVecY;
-    const float3_X calorimeterFrameVecZ;
+    CalorimeterCur calorimeterCur;
 
     CalorimeterFunctor(const float_X maxYaw,
                        const float_X maxPitch,
@@ -60,18 +84,18 @@ struct CalorimeterFunctor
                        const float3_X calorimeterFrameVecX,
                        const float3_X calorimeterFrameVecY,
                        const float3_X calorimeterFrameVecZ) :
-        calorimeterCur(nullptr, PMacc::math::Size_t<DIM2>()),
-        maxYaw(maxYaw),
-        maxPitch(maxPitch),
-        numBinsYaw(numBinsYaw),
-        numBinsPitch(numBinsPitch),
-        numBinsEnergy(numBinsEnergy),
-        minEnergy(minEnergy),
-        maxEnergy(maxEnergy),
-        logScale(logScale),
-        calorimeterFrameVecX(calorimeterFrameVecX),
-        calorimeterFrameVecY(calorimeterFrameVecY),
-        calorimeterFrameVecZ(calorimeterFrameVecZ)
+        Binning(maxYaw,
+                maxPitch,
+                numBinsYaw,
+                numBinsPitch,
+                numBinsEnergy,
+                minEnergy,
+                maxEnergy,
+                logScale,
+                calorimeterFrameVecX,
+                calorimeterFrameVecY,
+                calorimeterFrameVecZ),
+        calorimeterCur(nullptr, PMacc::math::Size_t<DIM2>())
     {}
 
     HINLINE void setCalorimeterCursor(const CalorimeterCur& calorimeterCur)
@@ -79,136 +103,42 @@ struct CalorimeterFunctor
         this->calorimeterCur = calorimeterCur;
     }
 
-    template<typename ParticlesFrame>
-    DINLINE void operator()(ParticlesFrame& particlesFrame, const uint32_t linearThreadIdx)
+    /** bin of a particle
+     *
+     * @param particle particle
+     * @param[out] value energy times normed weighting, the value which is added to the bin
+     * @return linear bin index, -1 if the particle does not hit the calorimeter
+     *         (see CalorimeterBinning::getBin())
+     */
+    template<typename T_Particle>
+    DINLINE int32_t getBin(T_Particle particle, float_X& value) const
     {
-        const float3_X mom = particlesFrame[linearThreadIdx][momentum_];
-        const float_X mom2 = math::dot(mom, mom);
-        float3_X dirVec = mom * math::rsqrt(mom2);
-
-        /* rotate dirVec into the calorimeter frame. This coordinate transformation
-         * is performed by a matrix vector multiplication. */
-        using namespace PMacc::algorithms::math;
-        dirVec = float3_X(dot(this->calorimeterFrameVecX, dirVec),
-                          dot(this->calorimeterFrameVecY, dirVec),
-                          dot(this->calorimeterFrameVecZ, dirVec));
-
-        /* convert dirVec to yaw and pitch */
-        const float_X yaw = atan2(dirVec.x(), dirVec.y());
-        const float_X pitch = asin(dirVec.z());
-
-        if(abs(yaw) < this->maxYaw && abs(pitch) < this->maxPitch)
-        {
-            const float2_X calorimeterPos = particleCalorimeter::mapYawPitchToNormedRange(
-                yaw, pitch, this->maxYaw, this->maxPitch);
-
-            // yaw
-            int32_t yawBin = calorimeterPos.x() * static_cast<float_X>(numBinsYaw);
-            // catch out-of-range values
-            yawBin = yawBin >= numBinsYaw ? numBinsYaw - 1 : yawBin;
-            yawBin = yawBin < 0 ? 0 : yawBin;
-
-            // pitch
-            int32_t pitchBin = calorimeterPos.y() * static_cast<float_X>(numBinsPitch);
-            // catch out-of-range values
-            pitchBin = pitchBin >= numBinsPitch ? numBinsPitch - 1 : pitchBin;
-            pitchBin = pitchBin < 0 ? 0 : pitchBin;
-
-            // energy
-            const float_X weighting = particlesFrame[linearThreadIdx][weighting_];
-            const float_X normedWeighting = weighting /
-                                            static_cast<float_X>(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE);
-            const auto particle = particlesFrame[linearThreadIdx];
-            const float_X mass = attribute::getMass(weighting, particle);
-            const float_X energy = KinEnergy<>()(mom, mass) / weighting;
-
-            int32_t energyBin = 0;
-            if(this->numBinsEnergy > 1)
-            {
-                const int32_t numBinsOutOfRange = 2;
-                energyBin = math::float2int_rd(((logScale ? log10(energy) : energy) - minEnergy) /
-                    (maxEnergy - minEnergy) * static_cast<float_X>(this->numBinsEnergy - numBinsOutOfRange)) + 1;
-
-                // all entries larger than maxEnergy go into last bin
-                energyBin = energyBin < this->numBinsEnergy ? energyBin : this->numBinsEnergy - 1;
-
-                // all entries smaller than minEnergy go into bin zero
-                energyBin = energyBin > 0 ? energyBin : 0;
-            }
-
-            atomicAddWrapper(&(*this->calorimeterCur(yawBin, pitchBin, energyBin)),
-                             energy * normedWeighting);
-        }
+        const float3_X mom = particle[momentum_];
+        const float_X weighting = particle[weighting_];
+        const float_X normedWeighting = weighting /
+                                        static_cast<float_X>(particles::TYPICAL_NUM_PARTICLES_PER_MACROPARTICLE);
+        const float_X mass = attribute::getMass(weighting, particle);
+        const float_X energy = KinEnergy<>()(mom, mass) / weighting;
+
+        value = energy * normedWeighting;
+        return Binning::getBin(mom, energy, particleCalorimeter::MapYawPitchToNormedRange());
     }
-};
-
 
-template<typename T_ParticlesBox, typename T_CalorimeterFunctor>
-struct ParticleCalorimeterKernel
-{
-    typedef T_ParticlesBox ParticlesBox;
-    typedef T_CalorimeterFunctor CalorimeterFunctor;
+    /** add a value to a bin of the global calorimeter
+     *
+     * @param binIdx linear bin index (see getBin()), ignored if negative
+     * @param value value to add
+     */
+    DINLINE void addToGlobal(const int32_t binIdx, const float_X value)
+    {
+        if(binIdx < 0)
+            return;
 
-    ParticlesBox particlesBox;
-    CalorimeterFunctor calorimeterFunctor;
+        const int32_t yawBin = binIdx % static_cast<int32_t>(numBinsYaw);
+        const int32_t pitchBin = binIdx / static_cast<int32_t>(numBinsYaw) % static_cast<int32_t>(numBinsPitch);
+        const int32_t energyBin = binIdx / static_cast<int32_t>(numBinsYaw * numBinsPitch);
 
-    ParticleCalorimeterKernel(ParticlesBox particlesBox,
-                           CalorimeterFunctor calorimeterFunctor) :
-        particlesBox(particlesBox),
-        calorimeterFunctor(calorimeterFunctor)
-    {}
-
-    DINLINE void operator()(const PMacc::math::Int<simDim>& cellIndex)
-    {
-        /* definitions for domain variables, like indices of blocks and threads */
-        typedef typename MappingDesc::SuperCellSize SuperCellSize;
-
-        /* multi-dimensional offset vector from local domain origin on GPU in units of super cells */
-        const PMacc::math::Int<simDim> block = cellIndex / SuperCellSize::toRT();
-
-        /* multi-dim offset from the origin of the local domain on GPU
-         * to the origin of the block of the in unit of cells
-         */
-        const PMacc::math::Int<simDim> blockCell = block * SuperCellSize::toRT();
-
-        /* multi-dim vector from origin of the block to a cell in units of cells */
-        const PMacc::math::Int<simDim> threadIndex = cellIndex % SuperCellSize::toRT();
-
-        /* conversion from a multi-dim cell coordinate to a linear coordinate of the cell in its super cell */
-        const int linearThreadIdx = PMacc::math::linearize(
-            PMacc::math::CT::shrinkTo<SuperCellSize, simDim-1>::type::toRT(),
-            threadIndex);
-
-        typedef typename ParticlesBox::FramePtr ParticlesFramePtr;
-        PMACC_SMEM( particlesFrame, ParticlesFramePtr );
-
-        /* find last frame in super cell
-         */
-        if (linearThreadIdx == 0)
-        {
-            particlesFrame = this->particlesBox.getLastFrame(block);
-        }
-
-        __syncthreads();
-
-        while(particlesFrame.isValid())
-        {
-            /* casting uint8_t multiMask to boolean */
-            const bool isParticle = particlesFrame[linearThreadIdx][multiMask_];
-
-            if(isParticle)
-            {
-                calorimeterFunctor(particlesFrame, linearThreadIdx);
-            }
-
-            __syncthreads();
-
-            if (linearThreadIdx == 0)
-            {
-                particlesFrame = this->particlesBox.getPreviousFrame(particlesFrame);
-            }
-            __syncthreads();
-        }
+        atomicAddWrapper(&(*this->calorimeterCur(yawBin, pitchBin, energyBin)), value);
     }
 };
 
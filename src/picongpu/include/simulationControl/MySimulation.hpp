@@ -1,6 +1,6 @@
 /* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
  *                     Richard Pausch, Alexander Debus, Marco Garten,
- *                     Benjamin Worpitz, Alexander Grund
+ *                     Benjamin Worpitz, Alexander Grund, agent
  *
  * This file is part of PIConGPU.
  *
@@ -70,7 +70,10 @@
 
 #include "algorithms/ForEach.hpp"
 #include "particles/ParticlesFunctors.hpp"
+#include "particles/HeapCompaction.hpp"
 #include "particles/InitFunctors.hpp"
+#include "particles/densityProfiles/FromHDF5Cache.hpp"
+#include "simulationControl/SlideInitSchedule.hpp"
 #include "particles/memory/buffers/MallocMCBuffer.hpp"
 #include "particles/traits/FilterByFlag.hpp"
 #include "particles/traits/FilterByIdentifier.hpp"
@@ -79,6 +82,7 @@
 
 #include <boost/mpl/int.hpp>
 #include <memory>
+#include <algorithm>
 
 
 namespace picongpu
@@ -108,7 +112,18 @@ public:
     currentBGField(nullptr),
     cellDescription(nullptr),
     initialiserController(nullptr),
-    slidingWindow(false)
+    slidingWindow(false),
+    aggregateMessages(false),
+    sharedMemoryTransport(false),
+    dimensionOrderedGuards(false),
+    topologyAwarePlacement(false),
+    particleSortPeriod(0),
+    heapCompaction(nullptr),
+    heapCompactionPeriod(0),
+    heapCompactionThreshold(25),
+    resamplingPeriod(0),
+    amortizedSlide(false),
+    slideInitLead(2)
     {
     }
 
@@ -132,7 +147,46 @@ public:
             ("periodic", po::value<std::vector<uint32_t> > (&periodic)->multitoken(),
              "specifying whether the grid is periodic (1) or not (0) in each dimension, default: no periodic dimensions")
 
-            ("moving,m", po::value<bool>(&slidingWindow)->zero_tokens(), "enable sliding/moving window");
+            ("moving,m", po::value<bool>(&slidingWindow)->zero_tokens(), "enable sliding/moving window")
+
+            ("mpiAggregation", po::value<bool>(&aggregateMessages)->zero_tokens(),
+             "pack all exchange buffers to the same neighbor which are sent together into one MPI message")
+
+            ("mpiSharedMemory", po::value<bool>(&sharedMemoryTransport)->zero_tokens(),
+             "exchange guards with neighbors on the same node via shared memory instead of MPI messages")
+
+            ("dimensionOrderedGuards", po::value<bool>(&dimensionOrderedGuards)->zero_tokens(),
+             "exchange the guards of E and B dimension by dimension with the 6 face neighbors "
+             "instead of with all 26 neighbors")
+
+            ("topologyAwarePlacement", po::value<bool>(&topologyAwarePlacement)->zero_tokens(),
+             "place the devices of one host into a compact block of the device grid "
+             "(default: devices follow the MPI rank order)")
+
+            ("particleSortPeriod", po::value<uint32_t>(&particleSortPeriod),
+             "sort the particles of each supercell by cell index every n-th step "
+             "after the push (default: 0, no sorting)")
+
+            ("heapCompactionPeriod", po::value<uint32_t>(&heapCompactionPeriod),
+             "log the usage of the particle heap and compact it every n-th step "
+             "(default: 0, disabled)")
+
+            ("heapCompactionThreshold", po::value<uint32_t>(&heapCompactionThreshold),
+             "frames in heap pages which are filled less than this percentage are moved "
+             "to denser pages, 0 logs the heap usage only (default: 25)")
+
+            ("resamplingPeriod", po::value<uint32_t>(&resamplingPeriod),
+             "run the ResamplingPipeline (resampling.param) every n-th step "
+             "before the push (default: 0, disabled)")
+
+            ("amortizedSlide", po::value<bool>(&amortizedSlide)->zero_tokens(),
+             "initialize the particles of a GPU which slides in with the moving window "
+             "row by row ahead of the window instead of all at once "
+             "(exact for cold and uniformly drifting plasma, see src/tools/slideInitBench)")
+
+            ("amortizedSlideLead", po::value<uint32_t>(&slideInitLead),
+             "number of supercell rows which are initialized ahead of the moving "
+             "window with --amortizedSlide (default: 2)");
     }
 
     std::string pluginGetName() const
@@ -180,7 +234,25 @@ public:
             isPeriodic[i] = periodic[i];
         }
 
-        Environment<simDim>::get().initDevices(gpus, isPeriodic);
+        Environment<simDim>::get().initDevices(gpus, isPeriodic, topologyAwarePlacement);
+
+        if (Environment<simDim>::get().GridController().getGlobalRank() == 0)
+            log<picLog::DOMAINS > ("neighbor exchanges within a host: %1%%%") %
+                (100.0 * Environment<simDim>::get().GridController().getCommunicator().getOnHostNeighborFraction());
+
+        if (aggregateMessages)
+            Environment<>::get().MessageAggregator().enable(
+                Environment<simDim>::get().EnvironmentController().getCommunicator());
+
+        /* must be set before the fields add their exchanges */
+        Environment<simDim>::get().GridController().setDimensionOrderedGuardExchange(dimensionOrderedGuards);
+
+        if (sharedMemoryTransport)
+        {
+            Environment<simDim>::get().GridController().getCommunicator().enableSharedMemoryTransport();
+            log<picLog::DOMAINS > ("shared memory transport with %1% ranks on this node") %
+                Environment<simDim>::get().GridController().getCommunicator().getNumSharedMemoryRanks();
+        }
 
         DataSpace<simDim> myGPUpos(Environment<simDim>::get().GridController().getPosition());
 
@@ -213,6 +285,7 @@ public:
 
         GridLayout<SIMDIM> layout(gridSizeLocal, MappingDesc::SuperCellSize::toRT());
         cellDescription = new MappingDesc(layout.getDataSpace(), GUARD_SIZE, GUARD_SIZE);
+        slideInit = SlideInitSchedule( slideInitLead, SuperCellSize::y::value, getNumSuperCellRows() );
 
         checkGridConfiguration(global_grid_size, cellDescription->getGridLayout());
 
@@ -245,12 +318,21 @@ public:
     {
         DataConnector &dc = Environment<>::get().DataConnector();
 
+        if (aggregateMessages)
+        {
+            MessageAggregator& aggregator = Environment<>::get().MessageAggregator();
+            log<picLog::SIMULATION_STATE > ("aggregated MPI messages: %1% (containing %2% exchange buffers, %3% bytes)") %
+                aggregator.getNumMessages() % aggregator.getNumBuffers() % aggregator.getNumBytes();
+        }
+
         SimulationHelper<simDim>::pluginUnload();
 
         __delete(myFieldSolver);
 
         __delete(myCurrentInterpolation);
 
+        __delete(heapCompaction);
+
         /** unshare all registered ISimulationData sets
          *
          * @todo can be removed as soon as our Environment learns to shutdown in
@@ -274,6 +356,9 @@ public:
         namespace nvmem = PMacc::nvidia::memory;
 
         DataConnector &dc = Environment<>::get().DataConnector();
+        StartupTimer& startupTimer = StartupTimer::getInstance();
+
+        startupTimer.beginPhase("memory allocation");
 
         // create simulation data such as fields and particles
         auto fieldB = new FieldB( *cellDescription );
@@ -342,8 +427,10 @@ public:
          * for particles are created */
         deviceHeap.reset(new DeviceHeap(0));
 
+        startupTimer.beginPhase("species creation");
         ForEach< VectorAllSpecies, particles::CreateSpecies<bmpl::_1> > createSpeciesMemory;
         createSpeciesMemory( deviceHeap, cellDescription );
+        startupTimer.beginPhase("memory allocation");
 
         size_t freeGpuMem(0);
         Environment<>::get().MemoryInfo().getMemoryInfo(&freeGpuMem);
@@ -373,8 +460,10 @@ public:
         MallocMCBuffer<DeviceHeap>* mallocMCBuffer = new MallocMCBuffer<DeviceHeap>(deviceHeap);
         dc.share( std::shared_ptr< ISimulationData >( mallocMCBuffer ) );
 
+        startupTimer.beginPhase("species creation");
         ForEach< VectorAllSpecies, particles::CallCreateParticleBuffer<bmpl::_1> > createParticleBuffer;
         createParticleBuffer( deviceHeap );
+        startupTimer.beginPhase("memory allocation");
 
         Environment<>::get().MemoryInfo().getMemoryInfo(&freeGpuMem);
         log<picLog::MEMORY > ("free mem after all mem is allocated %1% MiB") % (freeGpuMem / 1024 / 1024);
@@ -394,8 +483,14 @@ public:
         this->myCurrentInterpolation = new fieldSolver::CurrentInterpolation;
 
 
+        startupTimer.beginPhase("species creation");
         ForEach< VectorAllSpecies, particles::CallInit<bmpl::_1> > particleInit;
         particleInit( );
+        ForEach< VectorAllSpecies, particles::CallSetSortPeriod<bmpl::_1> > setSortPeriod;
+        setSortPeriod( particleSortPeriod );
+        if( heapCompactionPeriod != 0 )
+            heapCompaction = new particles::HeapCompaction( deviceHeap, heapCompactionThreshold );
+        startupTimer.endPhase();
 
 
         /* add CUDA streams to the StreamController for concurrent execution */
@@ -443,6 +538,15 @@ public:
                 initialiserController->restart((uint32_t)this->restartStep, this->restartDirectory);
                 step = this->restartStep;
 
+                /* the checkpoint of a GPU which slid in contains the rows
+                 * initialized until the checkpoint step */
+                MovingWindow& movingWindow = MovingWindow::getInstance();
+                if( amortizedSlide && movingWindow.isSlidingWindowActive() &&
+                    movingWindow.isBottomGPU() && movingWindow.getSlideCounter( step ) != 0 )
+                {
+                    slideInit.restart( getWindowOffset( step ) );
+                }
+
                 /** restore background fields in GUARD
                  *
                  * loads the outer GUARDS of the global domain for absorbing/open boundary condtions
@@ -453,14 +557,17 @@ public:
                 cellwiseOperation::CellwiseOperation< GUARD > guardBGField( *cellDescription );
                 namespace nvfct = pmacc::nvidia::functors;
                 guardBGField( fieldE, nvfct::Add(), FieldBackgroundE( fieldE->getUnit() ),
-                              step, FieldBackgroundE::InfluenceParticlePusher );
+                              step, FieldBackgroundE::InfluenceParticlePusher &&
+                              !FieldBackgroundE::EvaluateInPusher );
                 guardBGField( fieldB, nvfct::Add(), FieldBackgroundB( fieldB->getUnit() ),
-                              step, FieldBackgroundB::InfluenceParticlePusher );
+                              step, FieldBackgroundB::InfluenceParticlePusher &&
+                              !FieldBackgroundB::EvaluateInPusher );
 
             }
             else
             {
                 initialiserController->init();
+                densityProfiles::FromHDF5Cache::getInstance().invalidate();
                 ForEach< particles::InitPipeline, particles::CallFunctor<bmpl::_1> > initSpecies;
                 initSpecies( step );
             }
@@ -472,10 +579,14 @@ public:
 
         // generate valid GUARDS (overwrite)
 
-        EventTask eRfieldE = fieldE->asyncCommunication(__getTransactionEvent());
-        __setTransactionEvent(eRfieldE);
-        EventTask eRfieldB = fieldB->asyncCommunication(__getTransactionEvent());
-        __setTransactionEvent(eRfieldB);
+        EventTask eRfieldE;
+        EventTask eRfieldB;
+        {
+            MessageAggregator::Scope aggregate(Environment<>::get().MessageAggregator(), FIELD_E);
+            eRfieldE = fieldE->asyncCommunication(__getTransactionEvent());
+            eRfieldB = fieldB->asyncCommunication(__getTransactionEvent());
+        }
+        __setTransactionEvent(eRfieldE + eRfieldB);
 
         dc.releaseData( FieldE::getName() );
         dc.releaseData( FieldB::getName() );
@@ -492,6 +603,16 @@ public:
     {
         namespace nvfct = PMacc::nvidia::functors;
 
+        /* all particles are in CORE and BORDER between two steps */
+        if( heapCompactionPeriod != 0 && currentStep % heapCompactionPeriod == 0 )
+            (*heapCompaction)( currentStep );
+
+        if( resamplingPeriod != 0 && currentStep % resamplingPeriod == 0 )
+        {
+            ForEach< particles::ResamplingPipeline, particles::CallFunctor< bmpl::_1 > > resampleSpecies;
+            resampleSpecies( currentStep );
+        }
+
         typedef typename PMacc::particles::traits::FilterByIdentifier
         <
             VectorAllSpecies,
@@ -560,9 +681,11 @@ public:
         auto fieldE = dc.get< FieldE >( FieldE::getName(), true );
         auto fieldB = dc.get< FieldB >( FieldB::getName(), true );
         (*pushBGField)(fieldE, nvfct::Sub(), FieldBackgroundE(fieldE->getUnit()),
-                       currentStep, FieldBackgroundE::InfluenceParticlePusher);
+                       currentStep, FieldBackgroundE::InfluenceParticlePusher &&
+                       !FieldBackgroundE::EvaluateInPusher);
         (*pushBGField)(fieldB, nvfct::Sub(), FieldBackgroundB(fieldB->getUnit()),
-                       currentStep, FieldBackgroundB::InfluenceParticlePusher);
+                       currentStep, FieldBackgroundB::InfluenceParticlePusher &&
+                       !FieldBackgroundB::EvaluateInPusher);
         dc.releaseData( FieldE::getName() );
         dc.releaseData( FieldB::getName() );
 
@@ -630,8 +753,13 @@ public:
     {
         if (MovingWindow::getInstance().slideInCurrentStep(currentStep))
         {
+            /* the GPU which slid in last leaves the bottom of the domain,
+             * all rows must be initialized before */
+            slideInit.finish( InitSpeciesRows( *this, currentStep ) );
             slide(currentStep);
         }
+        else
+            slideInit.advance( getWindowOffset( currentStep ), InitSpeciesRows( *this, currentStep ) );
 
         /* do not double-add background field on restarts
          * (contained in checkpoint data)
@@ -658,9 +786,11 @@ public:
             auto fieldB = dc.get< FieldB >( FieldB::getName(), true );
 
             (*pushBGField)( fieldE, nvfct::Add(), FieldBackgroundE(fieldE->getUnit()),
-                            currentStep, FieldBackgroundE::InfluenceParticlePusher );
+                            currentStep, FieldBackgroundE::InfluenceParticlePusher &&
+                            !FieldBackgroundE::EvaluateInPusher );
             (*pushBGField)( fieldB, nvfct::Add(), FieldBackgroundB(fieldB->getUnit()),
-                            currentStep, FieldBackgroundB::InfluenceParticlePusher );
+                            currentStep, FieldBackgroundB::InfluenceParticlePusher &&
+                            !FieldBackgroundB::EvaluateInPusher );
 
             dc.releaseData( FieldE::getName() );
             dc.releaseData( FieldB::getName() );
@@ -692,11 +822,75 @@ public:
             log<picLog::SIMULATION_STATE > ("slide in step %1%") % currentStep;
             resetAll(currentStep);
             initialiserController->slide(currentStep);
-            ForEach< particles::InitPipeline, particles::CallFunctor< bmpl::_1 > > initSpecies;
-            initSpecies( currentStep );
+            densityProfiles::FromHDF5Cache::getInstance().invalidate();
+            if( amortizedSlide )
+                slideInit.start( getWindowOffset( currentStep ), InitSpeciesRows( *this, currentStep ) );
+            else
+            {
+                ForEach< particles::InitPipeline, particles::CallFunctor< bmpl::_1 > > initSpecies;
+                initSpecies( currentStep );
+            }
         }
     }
 
+    /** number of supercell rows (y direction) in CORE+BORDER */
+    uint32_t getNumSuperCellRows() const
+    {
+        return cellDescription->getGridSuperCells().y() - 2 * cellDescription->getGuardingSuperCells();
+    }
+
+    /** offset of the moving window in the top GPU [in cells] */
+    uint32_t getWindowOffset(uint32_t currentStep) const
+    {
+        return MovingWindow::getInstance().getWindow(currentStep).globalDimensions.offset.y();
+    }
+
+    /** initialize the species in the supercell rows [beginRow, endRow)
+     *
+     * the InitPipeline is restricted to the new rows, particles which moved
+     * into these rows in the meantime (drifting or warm plasma) are deleted
+     * before, else they would be created twice
+     *
+     * only the ranks which slid in call this method, the InitPipeline
+     * must not use collective operations (FromHDF5 reads per rank)
+     */
+    void initSpeciesRows(uint32_t currentStep, uint32_t beginRow, uint32_t endRow)
+    {
+        DataSpace<simDim> offset = DataSpace<simDim>::create(0);
+        DataSpace<simDim> size = cellDescription->getGridSuperCells() -
+            2 * cellDescription->getGuardingSuperCells();
+        offset.y() = beginRow;
+        size.y() = endRow - beginRow;
+
+        log<picLog::SIMULATION_STATE > ("initialize supercell rows [%1%,%2%) in step %3%") %
+            beginRow % endRow % currentStep;
+
+        ForEach< VectorAllSpecies, particles::CallSetActiveSuperCells< bmpl::_1 > > setActiveSuperCells;
+        setActiveSuperCells( offset, size );
+        ForEach< VectorAllSpecies, particles::CallDeleteActiveParticles< bmpl::_1 > > deleteActiveParticles;
+        deleteActiveParticles( );
+        ForEach< particles::InitPipeline, particles::CallFunctor< bmpl::_1 > > initSpecies;
+        initSpecies( currentStep );
+        setActiveSuperCells( );
+    }
+
+    /** functor for SlideInitSchedule */
+    struct InitSpeciesRows
+    {
+        MySimulation& simulation;
+        uint32_t currentStep;
+
+        InitSpeciesRows(MySimulation& simulation, uint32_t currentStep) :
+            simulation(simulation), currentStep(currentStep)
+        {
+        }
+
+        void operator()(uint32_t beginRow, uint32_t endRow) const
+        {
+            simulation.initSpeciesRows( currentStep, beginRow, endRow );
+        }
+    };
+
     virtual void setInitController(IInitPlugin *initController)
     {
 
@@ -768,6 +962,27 @@ protected:
     std::vector<std::string> gridDistribution;
 
     bool slidingWindow;
+
+    bool aggregateMessages;
+
+    bool sharedMemoryTransport;
+
+    bool dimensionOrderedGuards;
+
+    bool topologyAwarePlacement;
+    uint32_t particleSortPeriod;
+
+    particles::HeapCompaction* heapCompaction;
+    uint32_t heapCompactionPeriod;
+    uint32_t heapCompactionThreshold;
+
+    uint32_t resamplingPeriod;
+
+    bool amortizedSlide;
+    /* rows initialized ahead of the moving window with amortizedSlide */
+    uint32_t slideInitLead;
+    /* rows of this GPU which are initialized since it slid in */
+    SlideInitSchedule slideInit;
 };
 } /* namespace picongpu */
 
@@ -1,4 +1,5 @@
-/* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera
+/* Copyright 2013-2017 Axel Huebl, Felix Schmitt, Heiko Burau, Rene Widera,
+ *                     agent
  *
  * This file is part of PIConGPU.
  *
@@ -43,6 +44,8 @@ enum CommunicationTag
     FIELD_E = 2u,
     FIELD_J = 3u,
     FIELD_JRECV = 4u,
+    /* key of the aggregation phase of the communication of all species */
+    SPECIES_ALL = 5u,
     SPECIES_FIRSTTAG = 42u
 };
 
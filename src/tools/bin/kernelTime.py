@@ -0,0 +1,116 @@
+#!/usr/bin/env python
+#
+# Copyright 2017 agent
+#
+# This file is part of PIConGPU.
+#
+# PIConGPU is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# PIConGPU is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with PIConGPU.
+# If not, see <http://www.gnu.org/licenses/>.
+#
+
+import argparse
+import csv
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+__doc__ = '''
+Time CUDA kernels of a PIConGPU run with nvprof.
+
+The command is run with `nvprof --csv --print-gpu-summary` (or an existing
+log of such a run is read) and the number of calls, the total and the mean
+time of all kernels whose name matches the regular expression are printed.
+
+Example: compare the particle creation kernel of two builds
+
+    kernelTime.py -k CreateParticlesKernel -- mpiexec -n 1 ./picongpu ...
+'''
+
+# nvprof time units in milliseconds
+UNITS = {"s": 1.0e3, "ms": 1.0, "us": 1.0e-3, "ns": 1.0e-6}
+
+
+def read_summary(log_file):
+    """Read the kernel rows of an nvprof GPU summary in CSV format.
+
+    returns a list of (name, calls, total time [ms])
+    """
+    with open(log_file) as f:
+        rows = [row for row in csv.reader(f) if row and not row[0].startswith("==")]
+
+    header = None
+    for i, row in enumerate(rows):
+        if "Time(%)" in row and "Name" in row:
+            header = i
+            break
+    if header is None:
+        raise RuntimeError("no GPU summary found in " + log_file)
+
+    columns = rows[header]
+    time_col = columns.index("Time")
+    calls_col = columns.index("Calls")
+    name_col = columns.index("Name")
+    # the row after the header holds the units of the columns
+    unit = UNITS[rows[header + 1][time_col]]
+
+    kernels = []
+    for row in rows[header + 2:]:
+        if len(row) != len(columns):
+            continue
+        # the CUDA 9 summary lists API calls after the kernels
+        if "Type" in columns and row[columns.index("Type")] != "GPU activities":
+            continue
+        kernels.append((row[name_col], int(row[calls_col]), float(row[time_col]) * unit))
+    return kernels
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-k", "--kernel", default=".",
+                        help="regular expression of the kernel names (default: all kernels)")
+    parser.add_argument("--log",
+                        help="read an existing log of `nvprof --csv --print-gpu-summary` "
+                        "instead of running a command")
+    parser.add_argument("command", nargs=argparse.REMAINDER,
+                        help="command to profile (after --)")
+    args = parser.parse_args()
+
+    command = [c for c in args.command if c != "--"]
+    if args.log is None and not command:
+        parser.error("either --log or a command is required")
+
+    log_file = args.log
+    if log_file is None:
+        fd, log_file = tempfile.mkstemp(suffix=".csv")
+        os.close(fd)
+        ret = subprocess.call(["nvprof", "--csv", "--print-gpu-summary",
+                               "--log-file", log_file] + command)
+        if ret != 0:
+            sys.exit(ret)
+
+    pattern = re.compile(args.kernel)
+    matches = [k for k in read_summary(log_file) if pattern.search(k[0])]
+    if args.log is None:
+        os.remove(log_file)
+    if not matches:
+        sys.exit("no kernel matches '" + args.kernel + "'")
+
+    print("{:>10} {:>14} {:>12}  {}".format("calls", "total [ms]", "mean [us]", "kernel"))
+    for name, calls, total in matches:
+        print("{:>10} {:>14.3f} {:>12.3f}  {}".format(calls, total, total / calls * 1.0e3, name))
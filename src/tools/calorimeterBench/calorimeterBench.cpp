@@ -0,0 +1,241 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "algorithms/PrivatizedHistogram.hpp"
+#include "plugins/particleCalorimeter/CalorimeterBinning.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    uint32_t numBinsYaw;
+    uint32_t numBinsPitch;
+    uint32_t numBinsEnergy;
+    uint32_t numHotBins;
+    size_t sharedMemBytes;
+    double openingYaw_deg;
+    double openingPitch_deg;
+    double divergence_deg;
+    size_t numParticles;
+    uint32_t particlesPerSuperCell;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.numBinsYaw = 64;
+        options.numBinsPitch = 64;
+        options.numBinsEnergy = 1;
+        options.numHotBins = 1024;
+        options.sharedMemBytes = 48 * 1024;
+        options.openingYaw_deg = 360.0;
+        options.openingPitch_deg = 180.0;
+        options.divergence_deg = 2.0;
+        options.numParticles = 1 << 22;
+        options.particlesPerSuperCell = 256;
+        options.repetitions = 5;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Accumulates a synthetic forward peaked beam into the bins of the particle calorimeter" << std::endl
+            << "and counts the global updates of the direct and the privatized (per supercell) accumulation." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("numBinsYaw", po::value<uint32_t > (&options.numBinsYaw)->default_value(options.numBinsYaw), "number of bins for angle yaw")
+                ("numBinsPitch", po::value<uint32_t > (&options.numBinsPitch)->default_value(options.numBinsPitch), "number of bins for angle pitch")
+                ("numBinsEnergy", po::value<uint32_t > (&options.numBinsEnergy)->default_value(options.numBinsEnergy), "number of bins for the energy")
+                ("numHotBins", po::value<uint32_t > (&options.numHotBins)->default_value(options.numHotBins), "slots of the hot bin table")
+                ("sharedMem", po::value<size_t > (&options.sharedMemBytes)->default_value(options.sharedMemBytes),
+                 "shared memory of a block left for the bins in bytes (device limit minus static shared memory of the kernel)")
+                ("openingYaw", po::value<double > (&options.openingYaw_deg)->default_value(options.openingYaw_deg), "opening angle yaw in degrees")
+                ("openingPitch", po::value<double > (&options.openingPitch_deg)->default_value(options.openingPitch_deg), "opening angle pitch in degrees")
+                ("divergence,d", po::value<double > (&options.divergence_deg)->default_value(options.divergence_deg), "rms angular spread of the beam in degrees")
+                ("particles,n", po::value<size_t > (&options.numParticles)->default_value(options.numParticles), "number of particles")
+                ("superCell,s", po::value<uint32_t > (&options.particlesPerSuperCell)->default_value(options.particlesPerSuperCell), "particles per supercell")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.numBinsYaw < 1 || options.numBinsPitch < 1 || options.numBinsEnergy < 1 ||
+            options.numHotBins < 1 || options.particlesPerSuperCell < 1 || options.repetitions < 1 ||
+            options.openingYaw_deg <= 0.0 || options.openingYaw_deg > 360.0 ||
+            options.openingPitch_deg <= 0.0 || options.openingPitch_deg > 180.0)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* bins of the plugin ParticleCalorimeter */
+typedef picongpu::particleCalorimeter::CalorimeterBinning<float> Binning;
+
+/** default mapping of particleCalorimeter.param (linear in yaw and pitch) */
+struct MapYawPitchToNormedRange
+{
+    Binning::float2_T operator()(const float yaw, const float pitch, const float maxYaw, const float maxPitch) const
+    {
+        return Binning::float2_T(0.5f + 0.5f * yaw / maxYaw, 0.5f + 0.5f * pitch / maxPitch);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    const size_t numBins = size_t(options.numBinsYaw) * options.numBinsPitch * options.numBinsEnergy;
+    const size_t numSuperCells = (options.numParticles + options.particlesPerSuperCell - 1) / options.particlesPerSuperCell;
+
+    /* beam in +y direction with a Gaussian angular spread and log-normal energies */
+    std::mt19937 rng(42);
+    std::normal_distribution<double> angleDist(0.0, options.divergence_deg * M_PI / 180.0);
+    std::lognormal_distribution<double> energyDist(std::log(100.0), 0.5);
+    std::vector<int> binIdx(options.numParticles);
+    std::vector<double> values(options.numParticles);
+    /* calorimeter in +y direction, logarithmic energy bins from 1 to 1e4 (ParticleCalorimeter::pluginLoad) */
+    const Binning binning(float(0.5 * options.openingYaw_deg * M_PI / 180.0),
+                          float(0.5 * options.openingPitch_deg * M_PI / 180.0),
+                          options.numBinsYaw, options.numBinsPitch, options.numBinsEnergy,
+                          0.0f, 4.0f, true,
+                          Binning::float3_T(1.0f, 0.0f, 0.0f),
+                          Binning::float3_T(0.0f, 1.0f, 0.0f),
+                          Binning::float3_T(0.0f, 0.0f, 1.0f));
+    for (size_t i = 0; i < options.numParticles; ++i)
+    {
+        const double energy = energyDist(rng);
+        const Binning::float3_T mom(float(std::tan(angleDist(rng))), 1.0f, float(std::tan(angleDist(rng))));
+        binIdx[i] = binning.getBin(mom, float(energy), MapYawPitchToNormedRange());
+        /* integer values, the sums of all versions are exact */
+        values[i] = std::floor(energy);
+    }
+
+    std::vector<double> reference(numBins, 0.0);
+    for (size_t i = 0; i < options.numParticles; ++i)
+        if (binIdx[i] >= 0)
+            reference[binIdx[i]] += values[i];
+
+    /* direct: one global update per particle */
+    const uint32_t numModes = 3;
+    const char* names[numModes] = {"direct", "dense", "hot bins"};
+    const uint32_t numHotBins[numModes] = {1, 0, options.numHotBins};
+    double times[numModes];
+    uint64_t globalUpdates[numModes];
+    bool isEqual[numModes];
+
+    /* as in the plugin, the bins are privatized only if they fit into the shared memory */
+    const bool isUsable[numModes] = {
+        true,
+        numBins * sizeof(float) <= options.sharedMemBytes,
+        options.numHotBins * (sizeof(float) + sizeof(int)) <= options.sharedMemBytes
+    };
+
+    for (uint32_t m = 0; m < numModes; ++m)
+    {
+        times[m] = 0.0;
+        globalUpdates[m] = 0;
+        isEqual[m] = true;
+        if (!isUsable[m])
+            continue;
+
+        for (int r = 0; r < options.repetitions; ++r)
+        {
+            /* a table of one slot and no probe is the direct accumulation */
+            PMacc::algorithms::histogram::PrivatizedHistogram<double> histogram(
+                numBins, numHotBins[m], m == 0 ? 0 : 8);
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t s = 0; s < numSuperCells; ++s)
+            {
+                const size_t end = std::min(options.numParticles, (s + 1) * options.particlesPerSuperCell);
+                histogram.beginBlock();
+                for (size_t i = s * options.particlesPerSuperCell; i < end; ++i)
+                    histogram.add(binIdx[i], values[i]);
+                histogram.endBlock();
+            }
+            auto end = std::chrono::steady_clock::now();
+            const double ns = std::chrono::duration<double, std::nano>(end - start).count() / options.numParticles;
+            if (r == 0 || ns < times[m])
+                times[m] = ns;
+
+            globalUpdates[m] = histogram.getNumGlobalUpdates();
+            isEqual[m] = histogram.getBins() == reference;
+        }
+    }
+
+    std::cout << options.numParticles << " particles, " << numSuperCells << " supercells, "
+        << options.numBinsYaw << "x" << options.numBinsPitch << "x" << options.numBinsEnergy << " bins, "
+        << "divergence " << options.divergence_deg << " deg" << std::endl;
+    std::cout << "shared memory: " << options.sharedMemBytes / 1024 << " KiB, dense bins: " << numBins * sizeof(float) / 1024 << " KiB, "
+        << "hot bin table: " << options.numHotBins * (sizeof(float) + sizeof(int)) / 1024 << " KiB" << std::endl;
+    std::cout << std::setw(12) << std::left << "" << std::right
+        << std::setw(16) << "global updates"
+        << std::setw(16) << "per particle"
+        << std::setw(16) << "host [ns/par]"
+        << std::setw(10) << "equal" << std::endl;
+    for (uint32_t m = 0; m < numModes; ++m)
+    {
+        if (!isUsable[m])
+        {
+            std::cout << std::setw(12) << std::left << names[m] << std::right
+                << std::setw(16) << "-" << "  (exceeds shared memory)" << std::endl;
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(12) << std::left << names[m] << std::right
+            << std::setw(16) << globalUpdates[m]
+            << std::setw(16) << double(globalUpdates[m]) / options.numParticles
+            << std::setw(16) << times[m]
+            << std::setw(10) << (isEqual[m] ? "yes" : "no") << std::endl;
+    }
+
+    return isEqual[0] && isEqual[1] && isEqual[2] ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "algorithms/PrivatizedHistogram.hpp"
+#include "plugins/energyHistogram/EnergyHistogramFunctors.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    std::vector<int> binCounts;
+    int numAngleBins;
+    double maxAngle_deg;
+    double minEnergy_keV;
+    double maxEnergy_keV;
+    bool logScale;
+    bool withMoments;
+    size_t sharedMemBytes;
+    size_t numParticles;
+    uint32_t particlesPerSuperCell;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.numAngleBins = 1;
+        options.maxAngle_deg = 180.0;
+        options.minEnergy_keV = 1.0;
+        options.maxEnergy_keV = 1.0e4;
+        options.logScale = false;
+        options.withMoments = false;
+        options.sharedMemBytes = 48 * 1024;
+        options.numParticles = 1 << 22;
+        options.particlesPerSuperCell = 256;
+        options.repetitions = 5;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Bins synthetic particles into the energy histogram (BinEnergyParticles) for several bin counts" << std::endl
+            << "and compares the direct and the privatized (per supercell) accumulation with a host reference." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("binCount,b", po::value<std::vector<int> > (&options.binCounts)->multitoken(),
+                 "energy bins (.binCount), one measurement per value (default: 64 256 1024 4096 16384)")
+                ("angleBinCount", po::value<int > (&options.numAngleBins)->default_value(options.numAngleBins), "number of angle bins")
+                ("maxAngle", po::value<double > (&options.maxAngle_deg)->default_value(options.maxAngle_deg), "maximum angle to the y-axis in degrees")
+                ("minEnergy", po::value<double > (&options.minEnergy_keV)->default_value(options.minEnergy_keV), "minimal energy in keV")
+                ("maxEnergy", po::value<double > (&options.maxEnergy_keV)->default_value(options.maxEnergy_keV), "maximal energy in keV")
+                ("logScale", po::bool_switch(&options.logScale), "log10 spaced energy bins")
+                ("moments", po::bool_switch(&options.withMoments), "accumulate the energy moments")
+                ("sharedMem", po::value<size_t > (&options.sharedMemBytes)->default_value(options.sharedMemBytes),
+                 "shared memory of a block left for the bins in bytes (device limit minus static shared memory of the kernel)")
+                ("particles,n", po::value<size_t > (&options.numParticles)->default_value(options.numParticles), "number of particles")
+                ("superCell,s", po::value<uint32_t > (&options.particlesPerSuperCell)->default_value(options.particlesPerSuperCell), "particles per supercell")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.binCounts.empty())
+        {
+            const int binCounts[] = {64, 256, 1024, 4096, 16384};
+            options.binCounts.assign(binCounts, binCounts + 5);
+        }
+
+        bool isValid = options.numAngleBins > 0 && options.maxAngle_deg > 0.0 && options.maxAngle_deg <= 180.0 &&
+            options.maxEnergy_keV > options.minEnergy_keV && (!options.logScale || options.minEnergy_keV > 0.0) &&
+            options.particlesPerSuperCell > 0 && options.repetitions > 0;
+        for (size_t i = 0; i < options.binCounts.size(); ++i)
+            isValid = isValid && options.binCounts[i] > 0;
+        if (!isValid)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* binning of the plugin BinEnergyParticles */
+typedef picongpu::energyHistogram::BinDescription<float> BinDescription;
+
+/** synthetic particle, all values are integers thus all sums are exact */
+struct Particle
+{
+    float energy_keV;
+    BinDescription::float3_T mom;
+    double weighting;
+};
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    const int numMoments = options.withMoments ? 3 : 1;
+    const size_t numSuperCells = (options.numParticles + options.particlesPerSuperCell - 1) / options.particlesPerSuperCell;
+
+    /* log-normal energies around 100 keV, a beam in +y direction with a broad halo */
+    std::mt19937 rng(42);
+    std::lognormal_distribution<double> energyDist(std::log(100.0), 1.0);
+    std::normal_distribution<double> momDist(0.0, 0.5);
+    std::uniform_int_distribution<int> weightingDist(1, 4);
+    std::vector<Particle> particles(options.numParticles);
+    for (size_t i = 0; i < options.numParticles; ++i)
+    {
+        Particle& p = particles[i];
+        p.energy_keV = float(std::floor(energyDist(rng)));
+        p.mom[0] = float(momDist(rng));
+        p.mom[1] = 1.0f;
+        p.mom[2] = float(momDist(rng));
+        p.weighting = weightingDist(rng);
+    }
+
+    std::cout << options.numParticles << " particles, " << numSuperCells << " supercells, "
+        << options.numAngleBins << " angle bins, " << numMoments << " moments, "
+        << "shared memory " << options.sharedMemBytes / 1024 << " KiB" << std::endl;
+    std::cout << std::setw(10) << "binCount" << std::setw(14) << "shared [KiB]" << std::setw(10) << "plugin"
+        << std::setw(18) << "direct [upd/par]" << std::setw(18) << "private [upd/par]"
+        << std::setw(16) << "direct [ns/par]" << std::setw(17) << "private [ns/par]"
+        << std::setw(8) << "equal" << std::endl;
+
+    bool isCorrect = true;
+    for (size_t b = 0; b < options.binCounts.size(); ++b)
+    {
+        /* as BinEnergyParticles::getBinDescription */
+        const BinDescription binDesc(options.binCounts[b], float(options.minEnergy_keV), float(options.maxEnergy_keV),
+                                     options.logScale, options.numAngleBins, float(options.maxAngle_deg * M_PI / 180.0));
+
+        const int numBins = binDesc.getNumBins();
+        const size_t numAllBins = size_t(numMoments) * numBins;
+        const size_t sharedBytes = numAllBins * sizeof(float);
+        /* same decision as BinEnergyParticles::pluginLoad */
+        const bool useSharedMem = sharedBytes <= options.sharedMemBytes;
+
+        std::vector<int> binIdx(options.numParticles);
+        for (size_t i = 0; i < options.numParticles; ++i)
+            binIdx[i] = binDesc.getBin(particles[i].energy_keV, particles[i].mom);
+
+        /* host reference */
+        std::vector<double> reference(numAllBins, 0.0);
+        for (size_t i = 0; i < options.numParticles; ++i)
+        {
+            if (binIdx[i] < 0)
+                continue;
+            const double energy = particles[i].energy_keV;
+            double value = particles[i].weighting;
+            for (int m = 0; m < numMoments; ++m, value *= energy)
+                reference[m * numBins + binIdx[i]] += value;
+        }
+
+        /* 0: each particle is added to global memory, 1: privatized per supercell */
+        double times[2];
+        uint64_t globalUpdates[2];
+        bool isEqual[2];
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            times[mode] = 0.0;
+            globalUpdates[mode] = 0;
+            isEqual[mode] = true;
+            for (int r = 0; r < options.repetitions; ++r)
+            {
+                /* a table of one slot and no probe is the direct accumulation */
+                PMacc::algorithms::histogram::PrivatizedHistogram<double> histogram(
+                    numAllBins, mode == 0 ? 1 : 0, 0);
+
+                auto start = std::chrono::steady_clock::now();
+                for (size_t s = 0; s < numSuperCells; ++s)
+                {
+                    const size_t end = std::min(options.numParticles, (s + 1) * options.particlesPerSuperCell);
+                    histogram.beginBlock();
+                    for (size_t i = s * options.particlesPerSuperCell; i < end; ++i)
+                    {
+                        if (binIdx[i] < 0)
+                            continue;
+                        const double energy = particles[i].energy_keV;
+                        double value = particles[i].weighting;
+                        for (int m = 0; m < numMoments; ++m, value *= energy)
+                            histogram.add(m * numBins + binIdx[i], value);
+                    }
+                    histogram.endBlock();
+                }
+                auto end = std::chrono::steady_clock::now();
+                const double ns = std::chrono::duration<double, std::nano>(end - start).count() / options.numParticles;
+                if (r == 0 || ns < times[mode])
+                    times[mode] = ns;
+
+                globalUpdates[mode] = histogram.getNumGlobalUpdates();
+                isEqual[mode] = histogram.getBins() == reference;
+            }
+            isCorrect = isCorrect && isEqual[mode];
+        }
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << options.binCounts[b]
+            << std::setw(14) << double(sharedBytes) / 1024.0
+            << std::setw(10) << (useSharedMem ? "shared" : "global")
+            << std::setw(18) << double(globalUpdates[0]) / options.numParticles
+            << std::setw(18) << double(globalUpdates[1]) / options.numParticles
+            << std::setw(16) << times[0]
+            << std::setw(17) << times[1]
+            << std::setw(8) << (isEqual[0] && isEqual[1] ? "yes" : "no") << std::endl;
+    }
+
+    return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory/FieldStaging.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    size_t cells[3];
+    size_t guard[3];
+    uint32_t components;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        std::vector<size_t> cells;
+        std::vector<size_t> guard;
+        options.components = 3;
+        options.repetitions = 5;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Measures the host copy of the field components without guard into contiguous" << std::endl
+            << "buffers, as done by the ADIOS and HDF5 writers before each field is written." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("cells,c", po::value<std::vector<size_t> > (&cells)->multitoken(), "cells without guard in each dimension, default: 128 256 128")
+                ("guard,g", po::value<std::vector<size_t> > (&guard)->multitoken(), "guard cells on each side, default: 8 8 4")
+                ("components,n", po::value<uint32_t > (&options.components)->default_value(options.components), "components per cell")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        const size_t defaultCells[3] = {128, 256, 128};
+        const size_t defaultGuard[3] = {8, 8, 4};
+        for (int d = 0; d < 3; ++d)
+        {
+            options.cells[d] = d < (int) cells.size() ? cells[d] : defaultCells[d];
+            options.guard[d] = d < (int) guard.size() ? guard[d] : defaultGuard[d];
+        }
+
+        if (options.components < 1 || options.repetitions < 1 ||
+            options.cells[0] * options.cells[1] * options.cells[2] == 0)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* copy of the former ADIOSWriter::writeField loop: one pass over the field per component */
+void scalarCopy(const float* src, const uint32_t nComponents,
+                const size_t (&fieldSize)[3], const size_t (&offset)[3], const size_t (&size)[3],
+                std::vector<float>& dst, std::vector<float>& result)
+{
+    const size_t numCells = size[0] * size[1] * size[2];
+    for (uint32_t d = 0; d < nComponents; d++)
+    {
+        const size_t plane_full_size = fieldSize[1] * fieldSize[0] * nComponents;
+        const size_t plane_no_guard_size = size[1] * size[0];
+
+        for (size_t z = 0; z < size[2]; ++z)
+        {
+            for (size_t y = 0; y < size[1]; ++y)
+            {
+                const size_t base_index_src =
+                            (z + offset[2]) * plane_full_size +
+                            (y + offset[1]) * fieldSize[0] * nComponents;
+
+                const size_t base_index_dst =
+                            z * plane_no_guard_size +
+                            y * size[0];
+
+                for (size_t x = 0; x < size[0]; ++x)
+                {
+                    size_t index_src = base_index_src + (x + offset[0]) * nComponents + d;
+                    size_t index_dst = base_index_dst + x;
+
+                    dst[index_dst] = src[index_src];
+                }
+            }
+        }
+        /* the writer hands the buffer to the IO library here */
+        std::copy(dst.begin(), dst.begin() + numCells, result.begin() + d * numCells);
+    }
+}
+
+/* fastest of the repetitions in ns per cell */
+template<typename T_Functor>
+double measure(T_Functor functor, const Options& options, size_t numCells)
+{
+    double best = 0.0;
+    for (int r = 0; r < options.repetitions; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        functor();
+        auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / numCells;
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    size_t fieldSize[3];
+    for (int d = 0; d < 3; ++d)
+        fieldSize[d] = options.cells[d] + 2 * options.guard[d];
+    const size_t numCells = options.cells[0] * options.cells[1] * options.cells[2];
+    const uint32_t nComponents = options.components;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> fieldDist(-1.f, 1.f);
+    std::vector<float> field(fieldSize[0] * fieldSize[1] * fieldSize[2] * nComponents);
+    for (size_t i = 0; i < field.size(); ++i)
+        field[i] = fieldDist(rng);
+
+    /* the scalar loop stages one component at a time, the result is collected
+     * to compare both versions, the additional copy is measured separately */
+    std::vector<float> componentBuffer(numCells);
+    std::vector<float> scalarResult(numCells * nComponents);
+    const double scalarTime = measure([&]() {
+        scalarCopy(field.data(), nComponents, fieldSize, options.guard, options.cells,
+                   componentBuffer, scalarResult);
+    }, options, numCells);
+    const double collectTime = measure([&]() {
+        for (uint32_t d = 0; d < nComponents; ++d)
+            std::copy(componentBuffer.begin(), componentBuffer.end(), scalarResult.begin() + d * numCells);
+    }, options, numCells);
+
+    PMacc::memory::FieldStaging<float> staging;
+    const double firstStagingTime = measure([&]() {
+        PMacc::memory::FieldStaging<float> newStaging;
+        newStaging.stage(field.data(), nComponents, fieldSize, options.guard, options.cells);
+    }, options, numCells);
+    const double stagingTime = measure([&]() {
+        staging.stage(field.data(), nComponents, fieldSize, options.guard, options.cells);
+    }, options, numCells);
+
+    /* both versions copy the same values */
+    scalarCopy(field.data(), nComponents, fieldSize, options.guard, options.cells,
+               componentBuffer, scalarResult);
+    size_t numDifferent = 0;
+    for (uint32_t d = 0; d < nComponents; ++d)
+        for (size_t i = 0; i < numCells; ++i)
+            if (staging.getComponent(d)[i] != scalarResult[d * numCells + i])
+                ++numDifferent;
+
+    std::cout << options.cells[0] << "x" << options.cells[1] << "x" << options.cells[2] << " cells, "
+        << nComponents << " components, guard " << options.guard[0] << " " << options.guard[1] << " "
+        << options.guard[2] << std::endl;
+    std::cout << "different values: " << numDifferent << std::endl;
+    std::cout << std::setw(22) << std::left << "[ns/cell]" << std::right << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+        << std::setw(22) << std::left << "scalar loop" << std::right
+        << std::setw(10) << scalarTime - collectTime << std::endl
+        << std::setw(22) << std::left << "staging (allocation)" << std::right
+        << std::setw(10) << firstStagingTime << std::endl
+        << std::setw(22) << std::left << "staging (reused)" << std::right
+        << std::setw(10) << stagingTime << std::endl
+        << std::setw(22) << std::left << "speedup" << std::right
+        << std::setw(10) << (scalarTime - collectTime) / stagingTime << std::endl;
+
+    return numDifferent == 0 ? 0 : 1;
+}
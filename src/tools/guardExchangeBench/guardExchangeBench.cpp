@@ -0,0 +1,375 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory/buffers/ExchangeRegion.hpp"
+#include "memory/dataTypes/Mask.hpp"
+#include "dimensions/GridLayout.hpp"
+#include "dimensions/DataSpace.hpp"
+
+#include <mpi.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    std::vector<int> localCells;
+    std::vector<int> guardSizes;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options, const bool isRoot)
+{
+    try
+    {
+        options.repetitions = 20;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Fills the guards of a field with 3 float components on a periodic 3D domain decomposition," << std::endl
+            << "once with one exchange per neighbor (26 messages, GridBuffer default) and once dimension" << std::endl
+            << "ordered with the faces only (6 messages, GridBuffer::setDimensionOrderedExchange). The" << std::endl
+            << "exchange regions are computed by PMacc::ExchangeRegion as in ExchangeIntern, the host copy stands in for" << std::endl
+            << "the device to host copy. Checks all guard cells including edges and corners." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("domain,d", po::value<std::vector<int> > (&options.localCells)->multitoken(), "cells per rank (default: 64 64 64)")
+                ("guard,g", po::value<std::vector<int> > (&options.guardSizes)->multitoken(), "guard sizes in cells (default: 1 2 4 8)")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of exchange rounds")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            if (isRoot)
+                std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.localCells.empty())
+            options.localCells.assign(3, 64);
+        if (options.guardSizes.empty())
+        {
+            const int guardSizes[] = {1, 2, 4, 8};
+            options.guardSizes.assign(guardSizes, guardSizes + 4);
+        }
+
+        bool isValid = options.localCells.size() == 3 && options.repetitions > 0;
+        for (size_t i = 0; i < options.guardSizes.size() && isValid; ++i)
+            for (int d = 0; d < 3 && isValid; ++d)
+                isValid = options.guardSizes[i] > 0 && options.localCells[d] >= options.guardSizes[i];
+        if (!isValid)
+        {
+            if (isRoot)
+            {
+                std::cerr << "Error: invalid options (the guard must not be larger than the domain)." << std::endl;
+                std::cerr << std::endl << desc << std::endl;
+            }
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        if (isRoot)
+            std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/** number of exchange directions in 3D (including the direction 0) */
+const int numExchanges = 27;
+
+struct Value
+{
+    float c[3];
+};
+
+/** local field with guards, cell (0,0,0) is the first cell of the lower guard */
+struct Field
+{
+    int localCells[3];
+    int guard;
+    int size[3];
+    int globalOffset[3];
+    int globalCells[3];
+    std::vector<Value> data;
+
+    size_t getIdx(const int (&cell)[3]) const
+    {
+        return (size_t(cell[2]) * size[1] + cell[1]) * size[0] + cell[0];
+    }
+
+    /** deterministic value of a global cell (periodic) in round */
+    Value getValue(const int (&cell)[3], const int round) const
+    {
+        int g[3];
+        for (int d = 0; d < 3; ++d)
+            g[d] = ((globalOffset[d] + cell[d] - guard) % globalCells[d] + globalCells[d]) % globalCells[d];
+        Value v;
+        for (int c = 0; c < 3; ++c)
+            v.c[c] = float(((g[2] * globalCells[1] + g[1]) * globalCells[0] + g[0]) % 65536) + 0.25f * c + float(round % 7);
+        return v;
+    }
+};
+
+/** part of the local field which is sent or received by an exchange, as in ExchangeIntern */
+typedef PMacc::ExchangeRegion<DIM3> Region;
+
+/** region of an exchange as ExchangeIntern
+ *
+ * @param area BORDER (send, isGuard = false) or GUARD (receive, isGuard = true)
+ * @param extendOverLowerDims the region covers the full buffer in all
+ *        dimensions below the first dimension of the exchange
+ */
+Region getExchangeRegion(const Field& field, const int direction, const bool isGuard, const bool extendOverLowerDims)
+{
+    const PMacc::GridLayout<DIM3> layout(
+        PMacc::DataSpace<DIM3>(field.localCells[0], field.localCells[1], field.localCells[2]),
+        PMacc::DataSpace<DIM3>::create(field.guard));
+    return Region(layout, PMacc::DataSpace<DIM3>::create(field.guard), direction,
+                  isGuard ? PMacc::GUARD : PMacc::BORDER, extendOverLowerDims);
+}
+
+size_t getNumCells(const Region& region)
+{
+    return size_t(region.size.productOfComponents());
+}
+
+void copyRegion(const Field& field, const Region& region, Value* dst)
+{
+    int cell[3];
+    for (cell[2] = region.offset[2]; cell[2] < region.offset[2] + region.size[2]; ++cell[2])
+        for (cell[1] = region.offset[1]; cell[1] < region.offset[1] + region.size[1]; ++cell[1])
+        {
+            cell[0] = region.offset[0];
+            const Value* src = &field.data[field.getIdx(cell)];
+            std::copy(src, src + region.size[0], dst);
+            dst += region.size[0];
+        }
+}
+
+void insertRegion(Field& field, const Region& region, const Value* src)
+{
+    int cell[3];
+    for (cell[2] = region.offset[2]; cell[2] < region.offset[2] + region.size[2]; ++cell[2])
+        for (cell[1] = region.offset[1]; cell[1] < region.offset[1] + region.size[1]; ++cell[1])
+        {
+            cell[0] = region.offset[0];
+            std::copy(src, src + region.size[0], &field.data[field.getIdx(cell)]);
+            src += region.size[0];
+        }
+}
+
+/** statistic of one exchange round */
+struct RoundStat
+{
+    int numMessages;
+    size_t numBytes;
+};
+
+/** exchange all given directions at once
+ *
+ * the border of direction dir is sent to the neighbor in dir, the guard of
+ * direction dir is received from the neighbor in dir
+ */
+void exchange(Field& field, MPI_Comm cartComm, const int (&neighbor)[numExchanges],
+              const std::vector<int>& directions, const bool extendOverLowerDims,
+              std::vector<std::vector<Value> >& sendBuffers, std::vector<std::vector<Value> >& recvBuffers,
+              RoundStat& stat)
+{
+    std::vector<MPI_Request> requests(2 * directions.size());
+    for (size_t i = 0; i < directions.size(); ++i)
+    {
+        const int dir = directions[i];
+        const Region guard = getExchangeRegion(field, dir, true, extendOverLowerDims);
+        recvBuffers[dir].resize(getNumCells(guard));
+        /* the neighbor in dir sends into the mirrored direction */
+        MPI_Irecv(recvBuffers[dir].data(), recvBuffers[dir].size() * sizeof(Value), MPI_CHAR, neighbor[dir],
+                  PMacc::Mask::getMirroredExchangeType(dir), cartComm, &requests[i]);
+    }
+    for (size_t i = 0; i < directions.size(); ++i)
+    {
+        const int dir = directions[i];
+        const Region border = getExchangeRegion(field, dir, false, extendOverLowerDims);
+        sendBuffers[dir].resize(getNumCells(border));
+        copyRegion(field, border, sendBuffers[dir].data());
+        MPI_Isend(sendBuffers[dir].data(), sendBuffers[dir].size() * sizeof(Value), MPI_CHAR, neighbor[dir],
+                  dir, cartComm, &requests[directions.size() + i]);
+        ++stat.numMessages;
+        stat.numBytes += sendBuffers[dir].size() * sizeof(Value);
+    }
+    MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+    for (size_t i = 0; i < directions.size(); ++i)
+    {
+        const int dir = directions[i];
+        insertRegion(field, getExchangeRegion(field, dir, true, extendOverLowerDims), recvBuffers[dir].data());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int worldRank;
+    int numRanks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+    const bool isRoot = worldRank == 0;
+
+    Options options;
+    if (!parseCmdLine(argc, argv, options, isRoot))
+    {
+        MPI_Finalize();
+        return 1;
+    }
+
+    int dims[3] = {0, 0, 0};
+    MPI_Dims_create(numRanks, 3, dims);
+    const int periods[3] = {1, 1, 1};
+    MPI_Comm cartComm;
+    MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 0, &cartComm);
+    int rank;
+    MPI_Comm_rank(cartComm, &rank);
+    int coords[3];
+    MPI_Cart_coords(cartComm, rank, 3, coords);
+
+    int neighbor[numExchanges];
+    std::vector<int> allDirections;
+    for (int dir = 0; dir < numExchanges; ++dir)
+    {
+        const PMacc::DataSpace<DIM3> rel = PMacc::Mask::getRelativeDirections<DIM3>(dir);
+        int neighborCoords[3] = {coords[0] + rel[0], coords[1] + rel[1], coords[2] + rel[2]};
+        MPI_Cart_rank(cartComm, neighborCoords, &neighbor[dir]);
+        if (dir != 0)
+            allDirections.push_back(dir);
+    }
+    /* faces of x, y and z: LEFT/RIGHT, TOP/BOTTOM, FRONT/BACK */
+    std::vector<int> faceDirections[3];
+    for (int d = 0, base = 1; d < 3; ++d, base *= 3)
+    {
+        faceDirections[d].push_back(base);
+        faceDirections[d].push_back(2 * base);
+    }
+
+    if (isRoot)
+        std::cout << numRanks << " ranks (" << dims[0] << "x" << dims[1] << "x" << dims[2] << ", periodic), "
+            << options.localCells[0] << "x" << options.localCells[1] << "x" << options.localCells[2]
+            << " cells per rank, 12 byte per cell" << std::endl
+            << "messages and bytes are sent per rank and round, the time is the mean over the rounds (maximum over the ranks)" << std::endl
+            << std::setw(6) << "guard" << std::setw(18) << "path" << std::setw(10) << "messages"
+            << std::setw(12) << "KiB" << std::setw(14) << "round [us]" << std::setw(8) << "equal" << std::endl;
+
+    bool isCorrect = true;
+    const char* pathNames[] = {"26 neighbors", "dimension ordered"};
+    std::vector<std::vector<Value> > sendBuffers(numExchanges);
+    std::vector<std::vector<Value> > recvBuffers(numExchanges);
+
+    for (size_t g = 0; g < options.guardSizes.size(); ++g)
+    {
+        Field field;
+        field.guard = options.guardSizes[g];
+        for (int d = 0; d < 3; ++d)
+        {
+            field.localCells[d] = options.localCells[d];
+            field.size[d] = field.localCells[d] + 2 * field.guard;
+            field.globalCells[d] = field.localCells[d] * dims[d];
+            field.globalOffset[d] = field.localCells[d] * coords[d];
+        }
+        field.data.resize(size_t(field.size[0]) * field.size[1] * field.size[2]);
+
+        for (int path = 0; path < 2; ++path)
+        {
+            RoundStat stat = {0, 0};
+            double roundTime = 0.0;
+            bool isEqual = true;
+            /* the first round is not measured (warm up of the connections) */
+            for (int round = 0; round <= options.repetitions; ++round)
+            {
+                /* new values in the local cells, invalid guards */
+                int cell[3];
+                for (cell[2] = 0; cell[2] < field.size[2]; ++cell[2])
+                    for (cell[1] = 0; cell[1] < field.size[1]; ++cell[1])
+                        for (cell[0] = 0; cell[0] < field.size[0]; ++cell[0])
+                        {
+                            bool isGuard = false;
+                            for (int d = 0; d < 3; ++d)
+                                isGuard = isGuard || cell[d] < field.guard || cell[d] >= field.guard + field.localCells[d];
+                            Value v = {{-1.0f, -1.0f, -1.0f}};
+                            field.data[field.getIdx(cell)] = isGuard ? v : field.getValue(cell, round);
+                        }
+
+                stat.numMessages = 0;
+                stat.numBytes = 0;
+                MPI_Barrier(cartComm);
+                const double start = MPI_Wtime();
+                if (path == 0)
+                    exchange(field, cartComm, neighbor, allDirections, false, sendBuffers, recvBuffers, stat);
+                else
+                    for (int d = 0; d < 3; ++d)
+                        exchange(field, cartComm, neighbor, faceDirections[d], true, sendBuffers, recvBuffers, stat);
+                const double end = MPI_Wtime();
+                if (round != 0)
+                    roundTime += end - start;
+
+                for (cell[2] = 0; cell[2] < field.size[2] && isEqual; ++cell[2])
+                    for (cell[1] = 0; cell[1] < field.size[1] && isEqual; ++cell[1])
+                        for (cell[0] = 0; cell[0] < field.size[0] && isEqual; ++cell[0])
+                        {
+                            const Value& v = field.data[field.getIdx(cell)];
+                            const Value ref = field.getValue(cell, round);
+                            isEqual = v.c[0] == ref.c[0] && v.c[1] == ref.c[1] && v.c[2] == ref.c[2];
+                        }
+            }
+
+            const double time = roundTime / options.repetitions;
+            double maxTime = 0.0;
+            MPI_Reduce(&time, &maxTime, 1, MPI_DOUBLE, MPI_MAX, 0, cartComm);
+            int isLocalEqual = isEqual ? 1 : 0;
+            int isGlobalEqual = 0;
+            MPI_Allreduce(&isLocalEqual, &isGlobalEqual, 1, MPI_INT, MPI_MIN, cartComm);
+            isCorrect = isCorrect && isGlobalEqual == 1;
+
+            if (isRoot)
+                std::cout << std::fixed << std::setprecision(1)
+                    << std::setw(6) << field.guard
+                    << std::setw(18) << pathNames[path]
+                    << std::setw(10) << stat.numMessages
+                    << std::setw(12) << double(stat.numBytes) / 1024.0
+                    << std::setw(14) << maxTime * 1.0e6
+                    << std::setw(8) << (isGlobalEqual == 1 ? "yes" : "no") << std::endl;
+        }
+    }
+
+    MPI_Comm_free(&cartComm);
+    MPI_Finalize();
+    return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,305 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eventSystem/events/kernelEvents.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <typeinfo>
+#include <cstdlib>
+#include <new>
+#include <boost/program_options.hpp>
+
+/* This tool compiles the real PMACC_KERNEL (Kernel, KernelStarter and
+ * KernelMetaData of libPMacc) against the host only stand-ins of the CUDA
+ * runtime (share/cuda_stub) and of the kernel launch and the event system
+ * (stub/).
+ */
+
+namespace po = boost::program_options;
+
+/* count all allocations of the program
+ *
+ * operator delete is not inlined, otherwise gcc warns about free() of memory
+ * from operator new
+ */
+void* operator new(size_t size)
+{
+    ++PMacc::numAllocations();
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+__attribute__((noinline)) void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+typedef struct
+{
+    uint64_t numLaunches;
+    bool syncKernel;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.numLaunches = 1000000;
+        options.syncKernel = false;
+        options.repetitions = 5;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Measures the host side of PMACC_KERNEL(kernel)(grid, block)(args): the kernel" << std::endl
+            << "object, the kernel starter, the task of the event system and the cuda event." << std::endl
+            << "The kernel launch, the CUDA runtime and the event system are host only stand-ins" << std::endl
+            << "which allocate like libPMacc (new TaskKernel, task map of the Manager, EventPool)." << std::endl
+            << "The former path (strings for file and kernel name) is compared with KernelMetaData." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("launches,n", po::value<uint64_t > (&options.numLaunches)->default_value(options.numLaunches), "number of launches")
+                ("sync,s", po::value<bool > (&options.syncKernel)->zero_tokens(), "build the error messages as with PMACC_SYNC_KERNEL=1 (former path)")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.numLaunches < 1 || options.repetitions < 1)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* kernel functor with a typical long template name, never executed */
+template<typename T_Type, int T_dim>
+struct KernelFillGapsOfSuperCellsInArea
+{
+    template<typename T_Mapper>
+    DINLINE void operator()(T_Type* data, T_Type const value, T_Mapper const mapper) const
+    {
+        data[mapper.x()] = value;
+    }
+};
+
+typedef KernelFillGapsOfSuperCellsInArea<double, 3> KernelFunctor;
+
+/* volatile sink, the compiler must not remove the string operations */
+static volatile size_t sink = 0;
+
+namespace former
+{
+    /* copy of the former PMacc::exec::Kernel */
+    template<typename T_KernelFunctor>
+    struct Kernel
+    {
+        T_KernelFunctor const m_kernelFunctor;
+        std::string const m_file;
+        size_t const m_line;
+
+        Kernel(T_KernelFunctor const & kernelFunctor, std::string const & file = std::string(), size_t const line = 0) :
+            m_kernelFunctor(kernelFunctor), m_file(file), m_line(line)
+        {
+        }
+    };
+
+    /* the former KernelStarter, the event system is the same as for PMACC_KERNEL */
+    template<typename T_Kernel>
+    struct KernelStarter
+    {
+        T_Kernel const m_kernel;
+        PMacc::DataSpace<DIM3> const m_gridExtent;
+        PMacc::DataSpace<DIM3> const m_blockExtent;
+        size_t const m_sharedMemByte;
+        bool const m_syncKernel;
+
+        template<typename ... T_Args>
+        void operator()(T_Args const & ... args) const
+        {
+            std::string const kernelName = typeid(m_kernel.m_kernelFunctor).name();
+            std::string const kernelInfo = kernelName +
+                std::string(" [") + m_kernel.m_file + std::string(":") +
+                std::to_string(m_kernel.m_line) + std::string(" ]");
+
+            if (m_syncKernel)
+                sink = sink + (std::string("Crash before kernel call ") + kernelInfo).size();
+
+            /* createTaskKernel took the name by value and TaskKernel copied it */
+            std::string const taskName = typeid(kernelName).name();
+            std::string const taskKernelName(taskName);
+            PMacc::TaskKernel* taskKernel = PMacc::Environment<>::get().Factory().createTaskKernel(
+                typeid(kernelName).name()
+            );
+
+            PMacc::nvidia::launchGpuEntryFunction(
+                m_gridExtent,
+                m_blockExtent,
+                m_sharedMemByte,
+                taskKernel->getCudaStream(),
+                m_kernel.m_kernelFunctor,
+                args ...
+            );
+            taskKernel->activateChecks();
+            sink = sink + kernelInfo.size() + taskKernelName.size();
+        }
+    };
+
+    template<typename T_KernelFunctor>
+    Kernel<T_KernelFunctor> kernel(T_KernelFunctor const & kernelFunctor, std::string const & file, size_t const line)
+    {
+        return Kernel<T_KernelFunctor>(kernelFunctor, file, line);
+    }
+
+    template<typename T_Kernel>
+    KernelStarter<T_Kernel> start(T_Kernel const & k, PMacc::DataSpace<DIM3> const & grid,
+                                  PMacc::DataSpace<DIM3> const & block, size_t sharedMemByte, bool syncKernel)
+    {
+        return KernelStarter<T_Kernel>{k, grid, block, sharedMemByte, syncKernel};
+    }
+} // namespace former
+
+/* fastest of the repetitions in ns per launch, allocations of the last repetition
+ *
+ * the Manager deletes the finished task after each launch
+ */
+template<typename T_Functor>
+void measure(T_Functor functor, const Options& options, double& ns, uint64_t& allocations,
+             PMacc::EventSystemAllocations& eventSystemAllocations)
+{
+    for (int r = 0; r < options.repetitions; ++r)
+    {
+        PMacc::EventSystemAllocations::get() = PMacc::EventSystemAllocations{0, 0, 0};
+        const uint64_t oldAllocations = PMacc::numAllocations();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < options.numLaunches; ++i)
+        {
+            functor(i);
+            PMacc::Environment<>::get().Manager().execute();
+        }
+        auto end = std::chrono::steady_clock::now();
+        const double time = std::chrono::duration<double, std::nano>(end - start).count() / options.numLaunches;
+        if (r == 0 || time < ns)
+            ns = time;
+        allocations = PMacc::numAllocations() - oldAllocations;
+        eventSystemAllocations = PMacc::EventSystemAllocations::get();
+    }
+}
+
+void printRow(const std::string& name, const uint64_t allocations, const Options& options)
+{
+    std::cout << "  " << std::setw(40) << std::left << name << std::right
+        << std::setw(10) << double(allocations) / options.numLaunches << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    KernelFunctor functor;
+    std::vector<double> data(256);
+    const PMacc::DataSpace<DIM3> blockExtent(256, 1, 1);
+
+    /* as PMACC_KERNEL(functor)(grid, block)(args) with __FILE__ and __LINE__ */
+    double formerTime = 0.0;
+    uint64_t formerAllocations = 0;
+    PMacc::EventSystemAllocations formerEventSystem = {0, 0, 0};
+    measure([&](uint64_t i) {
+        former::start(former::kernel(functor, __FILE__, static_cast<size_t>(__LINE__)),
+                      PMacc::DataSpace<DIM3>(i % 64 + 1, 1, 1), blockExtent, 0, options.syncKernel)
+            (data.data(), 1.0, PMacc::DataSpace<DIM3>(1, 1, 1));
+    }, options, formerTime, formerAllocations, formerEventSystem);
+
+    double currentTime = 0.0;
+    uint64_t currentAllocations = 0;
+    PMacc::EventSystemAllocations currentEventSystem = {0, 0, 0};
+    const uint64_t oldLaunches = PMacc::nvidia::Launches::get().count;
+    measure([&](uint64_t i) {
+        PMACC_KERNEL(functor)(PMacc::DataSpace<DIM3>(i % 64 + 1, 1, 1), blockExtent)
+            (data.data(), 1.0, PMacc::DataSpace<DIM3>(1, 1, 1));
+    }, options, currentTime, currentAllocations, currentEventSystem);
+    const uint64_t numLaunches = PMacc::nvidia::Launches::get().count - oldLaunches;
+
+    const uint64_t eventSystemAllocations =
+        currentEventSystem.taskKernel + currentEventSystem.manager + currentEventSystem.eventPool;
+    const uint64_t starterAllocations = currentAllocations - eventSystemAllocations;
+
+    /* the description of an error is the same */
+    const std::string formerInfo = std::string(typeid(KernelFunctor).name()) + " [" + __FILE__ + ":1 ]";
+    const std::string currentInfo = PMacc::exec::kernel(functor, __FILE__, 1)(blockExtent, blockExtent).getKernelInfo();
+    const bool isEqual = formerInfo == currentInfo;
+
+    /* all tasks are finished and deleted, all events are back in the pool */
+    const bool isFinished = numLaunches == uint64_t(options.repetitions) * options.numLaunches &&
+        PMacc::Environment<>::get().Manager().getNumTasks() == 0 &&
+        PMacc::Environment<>::get().EventPool().getNumFreeEvents() == PMacc::Environment<>::numEvents;
+
+    std::cout << options.numLaunches << " launches, kernel functor " << typeid(KernelFunctor).name() << std::endl;
+    std::cout << "equal error description: " << (isEqual ? "yes" : "no") << std::endl;
+    std::cout << "all tasks finished: " << (isFinished ? "yes" : "no") << std::endl;
+    std::cout << std::setw(22) << std::left << "" << std::right
+        << std::setw(14) << "[ns/launch]" << std::setw(18) << "[allocs/launch]" << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+        << std::setw(22) << std::left << (options.syncKernel ? "former (sync kernel)" : "former") << std::right
+        << std::setw(14) << formerTime << std::setw(18) << double(formerAllocations) / options.numLaunches << std::endl
+        << std::setw(22) << std::left << "PMACC_KERNEL" << std::right
+        << std::setw(14) << currentTime << std::setw(18) << double(currentAllocations) / options.numLaunches << std::endl;
+
+    std::cout << "allocations per launch of PMACC_KERNEL:" << std::endl;
+    printRow("Kernel, KernelStarter, KernelMetaData", starterAllocations, options);
+    printRow("new TaskKernel (Factory)", currentEventSystem.taskKernel, options);
+    printRow("task map (Manager)", currentEventSystem.manager, options);
+    printRow("free event list (EventPool)", currentEventSystem.eventPool, options);
+
+    /* the launch itself must not allocate, the remaining allocations belong to the event system */
+    return (isEqual && isFinished && starterAllocations == 0) ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* host only stand-in of the libPMacc Environment for kernelLaunchBench */
+
+#include "pmacc_types.hpp"
+#include "eventSystem/EventSystem.hpp"
+
+namespace PMacc
+{
+
+template< uint32_t T_dim = DIM1 >
+class Environment
+{
+public:
+
+    static Environment& get()
+    {
+        static Environment instance;
+        return instance;
+    }
+
+    PMacc::Factory& Factory()
+    {
+        return factory;
+    }
+
+    PMacc::Manager& Manager()
+    {
+        return manager;
+    }
+
+    PMacc::EventPool& EventPool()
+    {
+        return eventPool;
+    }
+
+    /** number of cuda events in the pool */
+    static constexpr uint32_t numEvents = 16;
+
+    /** id of the task which the transaction event of the current transaction refers to */
+    id_t transactionEvent;
+
+private:
+
+    Environment() : transactionEvent(0), eventPool(numEvents)
+    {
+    }
+
+    PMacc::Factory factory;
+    PMacc::Manager manager;
+    PMacc::EventPool eventPool;
+};
+
+inline void TaskKernel::activateChecks()
+{
+    canBeChecked = true;
+    cudaEvent = Environment<>::get().EventPool().pop();
+
+    Environment<>::get().Manager().addTask(this);
+    Environment<>::get().transactionEvent = this->getId();
+}
+
+inline void Manager::execute()
+{
+    for (auto iter = tasks.begin(); iter != tasks.end();)
+    {
+        TaskKernel* taskPtr = iter->second;
+        if (taskPtr->isFinished())
+        {
+            Environment<>::get().EventPool().push(taskPtr->cudaEvent);
+            iter = tasks.erase(iter);
+            delete taskPtr;
+        }
+        else
+            ++iter;
+    }
+}
+
+} //namespace PMacc
@@ -0,0 +1,187 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* host only stand-in of the libPMacc event system for kernelLaunchBench
+ *
+ * The objects a kernel launch creates are allocated the same way as in the
+ * event system of libPMacc:
+ *   - Factory::createTaskKernel() creates the task with `new`
+ *   - TaskKernel::activateChecks() pops a cuda event from the EventPool
+ *     (std::list) and inserts the task into the std::map of the Manager
+ *   - Manager::execute() erases and deletes finished tasks, the cuda event
+ *     of a task is pushed back into the EventPool
+ * No cuda event or stream exists, a task is finished after its activation.
+ */
+
+#include "pmacc_types.hpp"
+
+#include <list>
+#include <map>
+#include <stdexcept>
+
+namespace PMacc
+{
+
+/** number of calls of operator new, incremented by the program */
+inline uint64_t& numAllocations()
+{
+    static uint64_t counter = 0;
+    return counter;
+}
+
+/** allocations of the event system per stage of a launch */
+struct EventSystemAllocations
+{
+    /** `new TaskKernel` in Factory::createTaskKernel() */
+    uint64_t taskKernel;
+    /** task map of the Manager */
+    uint64_t manager;
+    /** list of free events in the EventPool */
+    uint64_t eventPool;
+
+    static EventSystemAllocations& get()
+    {
+        static EventSystemAllocations allocations = {0, 0, 0};
+        return allocations;
+    }
+};
+
+/** handle of a cuda event */
+struct CudaEventHandle
+{
+    uint32_t eventIdx;
+};
+
+class EventPool
+{
+public:
+
+    EventPool(const uint32_t numEvents)
+    {
+        for (uint32_t i = 0; i < numEvents; ++i)
+            freeEvents.push_back(CudaEventHandle{i});
+    }
+
+    CudaEventHandle pop()
+    {
+        if (freeEvents.empty())
+            throw std::runtime_error("EventPool: no free event");
+        CudaEventHandle result = freeEvents.front();
+        freeEvents.pop_front();
+        return result;
+    }
+
+    void push(const CudaEventHandle& ev)
+    {
+        const uint64_t oldAllocations = numAllocations();
+        freeEvents.push_back(ev);
+        EventSystemAllocations::get().eventPool += numAllocations() - oldAllocations;
+    }
+
+    size_t getNumFreeEvents() const
+    {
+        return freeEvents.size();
+    }
+
+private:
+    std::list<CudaEventHandle> freeEvents;
+};
+
+class TaskKernel
+{
+public:
+
+    TaskKernel(const char* kernelName) :
+    kernelName(kernelName),
+    myId(getNextId()),
+    canBeChecked(false)
+    {
+    }
+
+    cudaStream_t getCudaStream()
+    {
+        return nullptr;
+    }
+
+    void activateChecks();
+
+    id_t getId() const
+    {
+        return myId;
+    }
+
+    bool isFinished() const
+    {
+        return canBeChecked;
+    }
+
+    CudaEventHandle cudaEvent;
+
+private:
+
+    static id_t getNextId()
+    {
+        static id_t nextId = 0;
+        return ++nextId;
+    }
+
+    const char* kernelName;
+    id_t myId;
+    bool canBeChecked;
+};
+
+class Manager
+{
+public:
+
+    void addTask(TaskKernel* task)
+    {
+        const uint64_t oldAllocations = numAllocations();
+        tasks[task->getId()] = task;
+        EventSystemAllocations::get().manager += numAllocations() - oldAllocations;
+    }
+
+    /** erase and delete all finished tasks */
+    void execute();
+
+    size_t getNumTasks() const
+    {
+        return tasks.size();
+    }
+
+private:
+    std::map<id_t, TaskKernel*> tasks;
+};
+
+class Factory
+{
+public:
+
+    TaskKernel* createTaskKernel(const char* kernelname)
+    {
+        const uint64_t oldAllocations = numAllocations();
+        TaskKernel* task = new TaskKernel(kernelname);
+        EventSystemAllocations::get().taskKernel += numAllocations() - oldAllocations;
+        return task;
+    }
+};
+
+} //namespace PMacc
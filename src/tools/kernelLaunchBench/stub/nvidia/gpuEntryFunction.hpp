@@ -0,0 +1,65 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* host only stand-in of nvidia/gpuEntryFunction.hpp for kernelLaunchBench */
+
+#include "pmacc_types.hpp"
+
+namespace PMacc
+{
+namespace nvidia
+{
+    /** launches of the stand-in device */
+    struct Launches
+    {
+        /** number of launches */
+        uint64_t count;
+        /** sum of the number of threads of all launches */
+        uint64_t threads;
+
+        static Launches& get()
+        {
+            static Launches launches = {0, 0};
+            return launches;
+        }
+    };
+
+    /** record the launch instead of starting the kernel on a device */
+    template<
+        typename T_VectorGrid,
+        typename T_VectorBlock,
+        typename T_KernelFunctor,
+        typename ... T_Args
+    >
+    HINLINE void launchGpuEntryFunction(
+        T_VectorGrid const & gridExtent,
+        T_VectorBlock const & blockExtent,
+        size_t const,
+        cudaStream_t const,
+        T_KernelFunctor const &,
+        T_Args const & ...
+    )
+    {
+        Launches::get().count++;
+        Launches::get().threads += gridExtent.productOfComponents() * blockExtent.productOfComponents();
+    }
+} //namespace nvidia
+} //namespace PMacc
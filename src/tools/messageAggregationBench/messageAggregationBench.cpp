@@ -0,0 +1,579 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "communication/CommunicatorMPI.hpp"
+#include "communication/MessageAggregator.hpp"
+#include "eventSystem/tasks/ITask.hpp"
+#include "eventSystem/events/EventDataReceive.hpp"
+#include "memory/dataTypes/Mask.hpp"
+#include "dimensions/DataSpace.hpp"
+
+#include <mpi.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    std::vector<int> localCells;
+    std::vector<int> guardSizes;
+    int numFields;
+    int numSpecies;
+    int particlesPerCell;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options, const bool isRoot)
+{
+    try
+    {
+        options.numFields = 3;
+        options.numSpecies = 2;
+        options.particlesPerCell = 8;
+        options.repetitions = 20;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Exchanges the guards of several fields and the border particles of several species with all" << std::endl
+            << "26 neighbors of a periodic 3D domain decomposition (PMacc::CommunicatorMPI), once with one MPI" << std::endl
+            << "message per exchange buffer (as TaskSendMPI) and once with PMacc::MessageAggregator. The phases" << std::endl
+            << "are the ones of a simulation step: one phase per field (the field solver updates depend on each" << std::endl
+            << "other) and one phase for all species (the particle sends join it with reserveSend)." << std::endl
+            << "Counts the messages, measures the latency of an exchange round and checks the received data." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("domain,d", po::value<std::vector<int> > (&options.localCells)->multitoken(), "cells per rank (default: 64 64 64)")
+                ("guard,g", po::value<std::vector<int> > (&options.guardSizes)->multitoken(), "guard sizes in cells (default: 1 2 4)")
+                ("fields,f", po::value<int > (&options.numFields)->default_value(options.numFields), "number of fields with 3 float components")
+                ("species,s", po::value<int > (&options.numSpecies)->default_value(options.numSpecies), "number of species (frames and border index)")
+                ("particlesPerCell,n", po::value<int > (&options.particlesPerCell)->default_value(options.particlesPerCell), "particles per cell")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of exchange rounds")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            if (isRoot)
+                std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.localCells.empty())
+            options.localCells.assign(3, 64);
+        if (options.guardSizes.empty())
+        {
+            const int guardSizes[] = {1, 2, 4};
+            options.guardSizes.assign(guardSizes, guardSizes + 3);
+        }
+
+        bool isValid = options.localCells.size() == 3 && options.numFields >= 0 && options.numSpecies >= 0 &&
+            options.numFields + options.numSpecies > 0 && options.numFields + 2 * options.numSpecies < 256 &&
+            options.particlesPerCell >= 0 && options.repetitions > 0;
+        for (size_t i = 0; i < options.guardSizes.size() && isValid; ++i)
+            isValid = options.guardSizes[i] > 0;
+        for (size_t d = 0; d < options.localCells.size() && isValid; ++d)
+            isValid = options.localCells[d] > 0;
+        if (!isValid)
+        {
+            if (isRoot)
+            {
+                std::cerr << "Error: invalid options." << std::endl;
+                std::cerr << std::endl << desc << std::endl;
+            }
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        if (isRoot)
+            std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/** number of exchange directions in 3D (without the direction 0) */
+const int numExchanges = 27;
+
+/** exchange tag as in the Exchange/TaskSendMPI: (communicationTag << 5) | direction */
+uint32_t getExchangeTag(int communicationTag, int direction)
+{
+    return (uint32_t(communicationTag) << 5) | uint32_t(direction);
+}
+
+/** one exchange buffer */
+struct Entry
+{
+    uint32_t tag;
+    char* data;
+    size_t bytes;
+};
+
+/** bytes of one particle frame: 256 particles with position, momentum, weighting, cell index and multiMask */
+const size_t frameBytes = 256 * (12 + 12 + 4 + 2 + 1);
+/** bytes of one element of the border frame index */
+const size_t frameIndexBytes = 16;
+
+/** deterministic content of a byte of a send buffer */
+char getByte(int srcRank, int direction, uint32_t tag, int round, size_t i)
+{
+    uint32_t h = uint32_t(srcRank) * 2654435761u ^ uint32_t(direction) * 40503u ^ tag * 97u ^ uint32_t(round) * 7919u;
+    h ^= uint32_t(i) * 2246822519u;
+    h ^= h >> 13;
+    return char(h & 0xff);
+}
+
+/** deterministic number of frames which leave a rank in a direction */
+size_t getNumFrames(int srcRank, int direction, int species, int round, size_t maxFrames)
+{
+    uint32_t h = uint32_t(srcRank + 1) * 2246822519u ^ uint32_t(direction) * 3266489917u ^
+        uint32_t(species) * 668265263u ^ uint32_t(round) * 374761393u;
+    h ^= h >> 15;
+    return maxFrames == 0 ? 0 : h % (maxFrames + 1);
+}
+
+/** exchange phase of a simulation step
+ *
+ * entries [begin, end) of each direction, the key is the phase key of the
+ * MessageAggregator
+ */
+struct Phase
+{
+    uint32_t key;
+    size_t begin;
+    size_t end;
+    /* the sends are reserved and started after the phase as by TaskSendParticlesExchange */
+    bool isParticles;
+};
+
+/** one phase per field and one phase for all species */
+std::vector<Phase> getPhases(const Options& options)
+{
+    std::vector<Phase> phases;
+    for (int f = 0; f < options.numFields; ++f)
+    {
+        Phase phase = {uint32_t(1 + f), size_t(f), size_t(f + 1), false};
+        phases.push_back(phase);
+    }
+    if (options.numSpecies != 0)
+    {
+        Phase phase = {uint32_t(1 + options.numFields), size_t(options.numFields),
+            size_t(options.numFields + 2 * options.numSpecies), true};
+        phases.push_back(phase);
+    }
+    return phases;
+}
+
+/** all exchange buffers of one rank for one guard size */
+struct Exchange
+{
+    /* send and receive buffers per direction, entries in the same order on all ranks
+     *
+     * recv[dir] holds the data which is sent into direction dir, it is
+     * received from the neighbor in the mirrored direction
+     */
+    std::vector<std::vector<Entry> > send;
+    std::vector<std::vector<Entry> > recv;
+    /* maximum size of each receive entry */
+    std::vector<std::vector<size_t> > recvMax;
+    std::vector<std::vector<char> > memory;
+    int neighbor[numExchanges];
+
+    char* allocate(size_t bytes)
+    {
+        memory.push_back(std::vector<char>(std::max(bytes, size_t(1))));
+        return memory.back().data();
+    }
+};
+
+void initExchange(Exchange& ex, MPI_Comm cartComm, const Options& options, const int guard)
+{
+    int rank;
+    MPI_Comm_rank(cartComm, &rank);
+    int coords[3];
+    MPI_Cart_coords(cartComm, rank, 3, coords);
+
+    ex.send.assign(numExchanges, std::vector<Entry>());
+    ex.recv.assign(numExchanges, std::vector<Entry>());
+    ex.recvMax.assign(numExchanges, std::vector<size_t>());
+    ex.memory.clear();
+    ex.memory.reserve(numExchanges * 2 * (options.numFields + 2 * options.numSpecies));
+
+    for (int dir = 1; dir < numExchanges; ++dir)
+    {
+        const PMacc::DataSpace<DIM3> rel = PMacc::Mask::getRelativeDirections<DIM3>(dir);
+        int neighborCoords[3];
+        size_t guardCells = 1;
+        size_t layerCells = 1;
+        for (int d = 0; d < 3; ++d)
+        {
+            neighborCoords[d] = coords[d] + rel[d];
+            guardCells *= rel[d] == 0 ? options.localCells[d] : guard;
+            layerCells *= rel[d] == 0 ? options.localCells[d] : 1;
+        }
+        MPI_Cart_rank(cartComm, neighborCoords, &ex.neighbor[dir]);
+
+        /* particles which leave through a face within one step, about 1/8 of one cell layer */
+        const size_t maxFrames = (layerCells * options.particlesPerCell / 8 + 255) / 256;
+
+        for (int f = 0; f < options.numFields; ++f)
+        {
+            const size_t bytes = guardCells * 3 * sizeof(float);
+            Entry entry = {getExchangeTag(1 + f, dir), ex.allocate(bytes), bytes};
+            ex.send[dir].push_back(entry);
+            ex.recv[dir].push_back(entry);
+            ex.recv[dir].back().data = ex.allocate(bytes);
+            ex.recvMax[dir].push_back(bytes);
+        }
+        for (int s = 0; s < options.numSpecies; ++s)
+        {
+            const size_t bufferBytes[2] = {maxFrames * frameBytes, maxFrames * frameIndexBytes};
+            for (int b = 0; b < 2; ++b)
+            {
+                Entry entry = {getExchangeTag(1 + options.numFields + 2 * s + b, dir),
+                    ex.allocate(bufferBytes[b]), bufferBytes[b]};
+                ex.send[dir].push_back(entry);
+                ex.recv[dir].push_back(entry);
+                ex.recv[dir].back().data = ex.allocate(bufferBytes[b]);
+                ex.recvMax[dir].push_back(bufferBytes[b]);
+            }
+        }
+    }
+}
+
+/** fill the send buffers of a round (as the device to host copy) */
+void fillSendBuffers(Exchange& ex, const Options& options, const int rank, const int round)
+{
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t e = 0; e < ex.send[dir].size(); ++e)
+        {
+            Entry& entry = ex.send[dir][e];
+            if (e >= size_t(options.numFields))
+            {
+                /* frames and index of a species have the same number of frames */
+                const int species = (e - options.numFields) / 2;
+                const size_t elementBytes = (e - options.numFields) % 2 == 0 ? frameBytes : frameIndexBytes;
+                const size_t maxFrames = ex.recvMax[dir][e] / elementBytes;
+                entry.bytes = getNumFrames(rank, dir, species, round, maxFrames) * elementBytes;
+            }
+            for (size_t i = 0; i < entry.bytes; ++i)
+                entry.data[i] = getByte(rank, dir, entry.tag, round, i);
+        }
+}
+
+/** check the received buffers of a round */
+bool checkReceiveBuffers(const Exchange& ex, const Options& options, const int round)
+{
+    bool isEqual = true;
+    for (int dir = 1; dir < numExchanges; ++dir)
+    {
+        const int srcRank = ex.neighbor[PMacc::Mask::getMirroredExchangeType(dir)];
+        for (size_t e = 0; e < ex.recv[dir].size(); ++e)
+        {
+            const Entry& entry = ex.recv[dir][e];
+            size_t expectedBytes = entry.bytes;
+            if (e >= size_t(options.numFields))
+            {
+                const int species = (e - options.numFields) / 2;
+                const size_t elementBytes = (e - options.numFields) % 2 == 0 ? frameBytes : frameIndexBytes;
+                expectedBytes = getNumFrames(srcRank, dir, species, round, ex.recvMax[dir][e] / elementBytes) * elementBytes;
+            }
+            isEqual = isEqual && entry.bytes == expectedBytes;
+            for (size_t i = 0; i < entry.bytes && isEqual; ++i)
+                isEqual = entry.data[i] == getByte(srcRank, dir, entry.tag, round, i);
+        }
+    }
+    return isEqual;
+}
+
+/** statistic of one exchange round */
+struct RoundStat
+{
+    uint64_t numMessages;
+    uint64_t numBytes;
+};
+
+/** one message per buffer, as TaskSendMPI/TaskReceiveMPI polled with MPI_Test */
+void exchangeSeparate(Exchange& ex, PMacc::ICommunicator& comm, const Phase& phase, RoundStat& stat)
+{
+    std::vector<MPI_Request*> requests;
+    std::vector<Entry*> recvEntries;
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t e = phase.begin; e < phase.end; ++e)
+        {
+            Entry& entry = ex.recv[dir][e];
+            requests.push_back(comm.startReceive(PMacc::Mask::getMirroredExchangeType(dir), entry.data,
+                                                 ex.recvMax[dir][e], entry.tag));
+            recvEntries.push_back(&entry);
+        }
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t e = phase.begin; e < phase.end; ++e)
+        {
+            Entry& entry = ex.send[dir][e];
+            requests.push_back(comm.startSend(dir, entry.data, entry.bytes, entry.tag));
+            recvEntries.push_back(nullptr);
+            ++stat.numMessages;
+            stat.numBytes += entry.bytes;
+        }
+
+    /* poll all requests as the event system does */
+    size_t numOpen = requests.size();
+    while (numOpen != 0)
+    {
+        for (size_t r = 0; r < requests.size(); ++r)
+        {
+            if (requests[r] == nullptr)
+                continue;
+            int flag = 0;
+            MPI_Status status;
+            MPI_Test(requests[r], &flag, &status);
+            if (!flag)
+                continue;
+            --numOpen;
+            delete requests[r];
+            requests[r] = nullptr;
+            if (recvEntries[r] != nullptr)
+            {
+                int recvBytes = 0;
+                MPI_Get_count(&status, MPI_CHAR, &recvBytes);
+                recvEntries[r]->bytes = recvBytes;
+            }
+        }
+    }
+}
+
+/** task which is notified by the MessageAggregator (as TaskSend/TaskReceive) */
+class ExchangeTask : public PMacc::ITask
+{
+public:
+
+    ExchangeTask() : entry(nullptr), isFinished(false)
+    {
+    }
+
+    void init()
+    {
+    }
+
+    void event(PMacc::id_t, PMacc::EventType type, PMacc::IEventData* data)
+    {
+        if (type == PMacc::RECVFINISHED)
+            entry->bytes = static_cast<PMacc::EventDataReceive*> (data)->getReceivedCount();
+        isFinished = true;
+    }
+
+    std::string toString()
+    {
+        return "ExchangeTask";
+    }
+
+    /* receive buffer, nullptr for a send */
+    Entry* entry;
+    bool isFinished;
+
+protected:
+
+    bool executeIntern()
+    {
+        return isFinished;
+    }
+};
+
+/** one message per neighbor and phase with the MessageAggregator of libPMacc
+ *
+ * the calls are the ones of the tasks in a simulation: TaskReceive::init
+ * and TaskSend::init (field phases) or TaskSendParticlesExchange::init
+ * (reserveSend) and the later ParticlesBuffer::asyncSendParticles (particle
+ * phase), followed by TaskSend::executeIntern after the device to host copy
+ */
+void exchangeAggregated(Exchange& ex, PMacc::MessageAggregator& aggregator, const Phase& phase, RoundStat& stat)
+{
+    typedef PMacc::MessageAggregator::Scope Scope;
+    const size_t numEntries = phase.end - phase.begin;
+    const size_t numSpecies = numEntries / 2;
+    const uint64_t numMessages = aggregator.getNumMessages();
+    const uint64_t numBytes = aggregator.getNumBytes();
+
+    std::vector<ExchangeTask> recvTasks(numExchanges * numEntries);
+    std::vector<ExchangeTask> sendTasks(numExchanges * numEntries);
+    std::vector<void*> sendHandles(numExchanges * numEntries, nullptr);
+    std::vector<void*> reservations(numExchanges * numSpecies, nullptr);
+
+    {
+        Scope aggregate(aggregator, phase.key);
+        for (int dir = 1; dir < numExchanges; ++dir)
+            for (size_t e = 0; e < numEntries; ++e)
+            {
+                Entry& entry = ex.recv[dir][phase.begin + e];
+                ExchangeTask& task = recvTasks[dir * numEntries + e];
+                task.entry = &entry;
+                aggregator.addReceive(PMacc::Mask::getMirroredExchangeType(dir), entry.data,
+                                      ex.recvMax[dir][phase.begin + e], entry.tag, &task);
+            }
+        for (int dir = 1; dir < numExchanges; ++dir)
+        {
+            if (phase.isParticles)
+                for (size_t s = 0; s < numSpecies; ++s)
+                    reservations[dir * numSpecies + s] = aggregator.reserveSend(dir);
+            else
+                for (size_t e = 0; e < numEntries; ++e)
+                    sendHandles[dir * numEntries + e] = aggregator.announceSend(dir);
+        }
+    }
+
+    if (phase.isParticles)
+        for (int dir = 1; dir < numExchanges; ++dir)
+            for (size_t s = 0; s < numSpecies; ++s)
+            {
+                /* frames and index of a species, ParticlesBuffer opens an own nested scope */
+                Scope resume(aggregator, reservations[dir * numSpecies + s]);
+                Scope aggregate(aggregator, phase.key);
+                sendHandles[dir * numEntries + 2 * s] = aggregator.announceSend(dir);
+                sendHandles[dir * numEntries + 2 * s + 1] = aggregator.announceSend(dir);
+            }
+
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t e = 0; e < numEntries; ++e)
+        {
+            const Entry& entry = ex.send[dir][phase.begin + e];
+            aggregator.addSend(sendHandles[dir * numEntries + e], entry.data, entry.bytes, entry.tag,
+                               &sendTasks[dir * numEntries + e]);
+        }
+
+    bool isFinished = false;
+    while (!isFinished)
+    {
+        aggregator.progress();
+        isFinished = true;
+        for (size_t t = numEntries; t < recvTasks.size(); ++t)
+            isFinished = isFinished && recvTasks[t].isFinished && sendTasks[t].isFinished;
+    }
+
+    stat.numMessages += aggregator.getNumMessages() - numMessages;
+    stat.numBytes += aggregator.getNumBytes() - numBytes;
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int worldRank;
+    int numRanks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+    const bool isRoot = worldRank == 0;
+
+    Options options;
+    if (!parseCmdLine(argc, argv, options, isRoot))
+    {
+        MPI_Finalize();
+        return 1;
+    }
+
+    bool isCorrect = true;
+    {
+        int dims[3] = {0, 0, 0};
+        MPI_Dims_create(numRanks, 3, dims);
+        PMacc::CommunicatorMPI<DIM3> comm;
+        comm.init(PMacc::DataSpace<DIM3>(dims[0], dims[1], dims[2]), PMacc::DataSpace<DIM3>(1, 1, 1));
+        MPI_Comm cartComm = comm.getMPIComm();
+        const int rank = comm.getRank();
+
+        PMacc::MessageAggregator& aggregator = PMacc::MessageAggregator::getInstance();
+        aggregator.enable(comm);
+
+        const std::vector<Phase> phases = getPhases(options);
+
+        if (isRoot)
+            std::cout << numRanks << " ranks (" << dims[0] << "x" << dims[1] << "x" << dims[2] << ", periodic), "
+                << options.localCells[0] << "x" << options.localCells[1] << "x" << options.localCells[2] << " cells per rank, "
+                << options.numFields << " fields, " << options.numSpecies << " species, " << phases.size() << " phases" << std::endl
+                << "messages and bytes are sent per rank and round, times are the mean over the rounds (maximum over the ranks)" << std::endl
+                << std::setw(6) << "guard" << std::setw(12) << "path" << std::setw(10) << "messages"
+                << std::setw(12) << "KiB" << std::setw(14) << "round [us]" << std::setw(8) << "equal" << std::endl;
+
+        const char* pathNames[] = {"separate", "aggregated"};
+
+        for (size_t g = 0; g < options.guardSizes.size(); ++g)
+        {
+            Exchange ex;
+            initExchange(ex, cartComm, options, options.guardSizes[g]);
+
+            for (int path = 0; path < 2; ++path)
+            {
+                RoundStat stat = {0, 0};
+                double roundTime = 0.0;
+                bool isEqual = true;
+                /* the first round is not measured (warm up of the connections) */
+                for (int round = 0; round <= options.repetitions; ++round)
+                {
+                    fillSendBuffers(ex, options, rank, round);
+                    MPI_Barrier(cartComm);
+                    stat.numMessages = 0;
+                    stat.numBytes = 0;
+                    const double start = MPI_Wtime();
+                    /* the phases of a step are exchanged one after the other */
+                    for (size_t p = 0; p < phases.size(); ++p)
+                    {
+                        if (path == 0)
+                            exchangeSeparate(ex, comm, phases[p], stat);
+                        else
+                            exchangeAggregated(ex, aggregator, phases[p], stat);
+                    }
+                    const double end = MPI_Wtime();
+                    if (round != 0)
+                        roundTime += end - start;
+                    isEqual = checkReceiveBuffers(ex, options, round) && isEqual;
+                }
+
+                double time = roundTime / options.repetitions;
+                double maxTime;
+                MPI_Reduce(&time, &maxTime, 1, MPI_DOUBLE, MPI_MAX, 0, cartComm);
+                int isLocalEqual = isEqual ? 1 : 0;
+                int isGlobalEqual = 0;
+                MPI_Allreduce(&isLocalEqual, &isGlobalEqual, 1, MPI_INT, MPI_MIN, cartComm);
+                isCorrect = isCorrect && isGlobalEqual == 1;
+
+                if (isRoot)
+                    std::cout << std::fixed << std::setprecision(1)
+                        << std::setw(6) << options.guardSizes[g]
+                        << std::setw(12) << pathNames[path]
+                        << std::setw(10) << stat.numMessages
+                        << std::setw(12) << double(stat.numBytes) / 1024.0
+                        << std::setw(14) << maxTime * 1.0e6
+                        << std::setw(8) << (isGlobalEqual == 1 ? "yes" : "no") << std::endl;
+            }
+        }
+    }
+
+    MPI_Finalize();
+    return isCorrect ? 0 : 1;
+}
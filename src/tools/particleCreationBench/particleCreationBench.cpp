@@ -0,0 +1,299 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "particles/creation/PrefixSumCreation.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+namespace creation = PMacc::particles::creation;
+
+/* frame size as in the default PIConGPU memory.param (8x8x4 supercells) */
+const uint32_t frameSize = 256;
+/* as in CreateParticlesKernel */
+const uint32_t maxNewFrames = 8;
+
+typedef struct
+{
+    uint32_t numSuperCells;
+    uint32_t numSourceFrames;
+    double emitFraction;
+    uint32_t maxEmission;
+    double exponent;
+    uint32_t heapFrames;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.numSuperCells = 4096;
+        options.numSourceFrames = 2;
+        options.emitFraction = 0.05;
+        options.maxEmission = 64;
+        options.exponent = 1.5;
+        options.heapFrames = 1;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Creates particles from source particles with skewed emission counts and compares" << std::endl
+            << "the block synchronizations of the round based and the prefix sum based creation." << std::endl
+            << "A source particle emits with probability emitFraction, the number of new particles" << std::endl
+            << "n in [1, maxEmission] is distributed as n^-exponent." << std::endl
+            << "The prefix sum creation is repeated with a heap which provides only heapFrames frames" << std::endl
+            << "per supercell to check that the creation stops without using a failed allocation." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("superCells,s", po::value<uint32_t > (&options.numSuperCells)->default_value(options.numSuperCells), "number of supercells")
+                ("frames,f", po::value<uint32_t > (&options.numSourceFrames)->default_value(options.numSourceFrames), "full source frames per supercell")
+                ("emitFraction,e", po::value<double > (&options.emitFraction)->default_value(options.emitFraction), "fraction of emitting source particles")
+                ("maxEmission,m", po::value<uint32_t > (&options.maxEmission)->default_value(options.maxEmission), "maximum number of new particles per source particle")
+                ("exponent,a", po::value<double > (&options.exponent)->default_value(options.exponent), "exponent of the power law of the emission counts")
+                ("heapFrames,H", po::value<uint32_t > (&options.heapFrames)->default_value(options.heapFrames), "frames per supercell of the out of frames check")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.numSuperCells < 1 || options.numSourceFrames < 1 || options.maxEmission < 1 ||
+            options.emitFraction < 0.0 || options.emitFraction > 1.0)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* number of block barriers of one source frame in the former kernel */
+uint64_t roundsBarriers(const uint32_t numRounds)
+{
+    /* numNewParticles, exit round (2), end of loop, next source frame; 7 per round which creates */
+    return 5 + 7 * uint64_t(numRounds - 1);
+}
+
+/* number of block barriers of one source frame in CreateParticlesKernel */
+uint64_t prefixSumBarriers(const uint32_t numPasses, const bool hasNewParticles)
+{
+    /* __syncthreads_or, next source frame */
+    uint64_t barriers = 2;
+    if (hasNewParticles)
+    {
+        uint32_t scanSteps = 0;
+        for (uint32_t stride = 1; stride < frameSize; stride *= 2)
+            ++scanSteps;
+        /* store, two per scan step, sums; allocate, create, next pass */
+        barriers += 2 + 2 * scanSteps + 3 * numPasses;
+    }
+    return barriers;
+}
+
+/* the slots of a supercell are dense and each thread created the expected number of particles */
+bool isValid(const std::vector<creation::TargetSlot>& targets,
+             const std::vector<uint32_t>& numNewParticles,
+             const uint32_t firstTarget,
+             const bool isDense)
+{
+    const uint32_t numTargets = targets.size() - firstTarget;
+    std::vector<uint32_t> perThread(numNewParticles.size(), 0);
+    std::vector<bool> isUsed(numTargets + 2 * frameSize, false);
+    uint32_t firstSlot = targets[firstTarget].frame * frameSize + targets[firstTarget].slot;
+    for (uint32_t i = firstTarget; i < targets.size(); ++i)
+    {
+        const uint32_t slot = targets[i].frame * frameSize + targets[i].slot;
+        firstSlot = std::min(firstSlot, slot);
+        ++perThread[targets[i].source];
+    }
+    for (uint32_t i = firstTarget; i < targets.size(); ++i)
+    {
+        const uint32_t slot = targets[i].frame * frameSize + targets[i].slot - firstSlot;
+        if (slot >= isUsed.size() || isUsed[slot])
+            return false;
+        isUsed[slot] = true;
+    }
+    if (isDense)
+        for (uint32_t i = 0; i < numTargets; ++i)
+            if (!isUsed[i])
+                return false;
+    return perThread == numNewParticles;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    /* power law of the emission counts */
+    std::vector<double> weights(options.maxEmission);
+    for (uint32_t n = 1; n <= options.maxEmission; ++n)
+        weights[n - 1] = std::pow(double(n), -options.exponent);
+    std::mt19937 rng(42);
+    std::bernoulli_distribution emitDist(options.emitFraction);
+    std::discrete_distribution<uint32_t> countDist(weights.begin(), weights.end());
+
+    uint64_t numCreated = 0;
+    uint64_t numRounds = 0;
+    uint64_t numPasses = 0;
+    uint64_t barriers[2] = {0, 0};
+    /* block steps: rounds of the former kernel, most particles of a thread for the prefix sum */
+    uint64_t steps[2] = {0, 0};
+    uint64_t serialAllocations[2] = {0, 0};
+    uint32_t numFrames[2] = {0, 0};
+    bool isCorrect = true;
+
+    uint32_t numOutOfFrames = 0;
+
+    std::vector<std::vector<uint32_t> > sourceFrames(options.numSourceFrames, std::vector<uint32_t>(frameSize));
+    std::vector<creation::TargetSlot> rounds;
+    std::vector<creation::TargetSlot> prefixSum;
+    for (uint32_t s = 0; s < options.numSuperCells; ++s)
+    {
+        creation::TargetFrames roundsFrames = {0, frameSize};
+        creation::TargetFrames prefixSumFrames = {0, frameSize};
+        rounds.clear();
+        prefixSum.clear();
+
+        for (uint32_t f = 0; f < options.numSourceFrames; ++f)
+        {
+            std::vector<uint32_t>& numNewParticles = sourceFrames[f];
+            uint32_t maxPerThread = 0;
+            for (uint32_t t = 0; t < frameSize; ++t)
+            {
+                numNewParticles[t] = emitDist(rng) ? countDist(rng) + 1 : 0;
+                maxPerThread = std::max(maxPerThread, numNewParticles[t]);
+                numCreated += numNewParticles[t];
+            }
+
+            const uint32_t firstRounds = rounds.size();
+            const uint32_t oldRoundsFrames = roundsFrames.numFrames;
+            const uint32_t r = creation::createByRounds(numNewParticles, frameSize, roundsFrames, rounds);
+            numRounds += r;
+            barriers[0] += roundsBarriers(r);
+            steps[0] += r;
+            serialAllocations[0] += roundsFrames.numFrames - oldRoundsFrames;
+
+            const uint32_t firstPrefixSum = prefixSum.size();
+            const uint32_t p = creation::createByPrefixSum(numNewParticles, frameSize, maxNewFrames,
+                                                           prefixSumFrames, prefixSum);
+            numPasses += p;
+            barriers[1] += prefixSumBarriers(p, maxPerThread != 0);
+            steps[1] += maxPerThread;
+
+            if (maxPerThread != 0)
+                isCorrect = isCorrect &&
+                    isValid(rounds, numNewParticles, firstRounds, false) &&
+                    isValid(prefixSum, numNewParticles, firstPrefixSum, true);
+        }
+        numFrames[0] += roundsFrames.numFrames;
+        numFrames[1] += prefixSumFrames.numFrames;
+        isCorrect = isCorrect &&
+            prefixSumFrames.numFrames == (prefixSum.size() + frameSize - 1) / frameSize;
+
+        /* the same source frames with a heap of heapFrames frames */
+        creation::TargetFrames limitedFrames = {0, frameSize};
+        std::vector<creation::TargetSlot> limited;
+        for (uint32_t f = 0; f < options.numSourceFrames; ++f)
+        {
+            const std::vector<uint32_t>& numNewParticles = sourceFrames[f];
+            const uint32_t firstLimited = limited.size();
+            creation::createByPrefixSum(numNewParticles, frameSize, maxNewFrames, limitedFrames, limited,
+                                        options.heapFrames);
+
+            uint32_t numCreate = 0;
+            for (uint32_t t = 0; t < frameSize; ++t)
+                numCreate += numNewParticles[t];
+            const uint32_t numLimited = limited.size() - firstLimited;
+            if (numLimited == numCreate)
+            {
+                if (numCreate != 0)
+                    isCorrect = isCorrect && isValid(limited, numNewParticles, firstLimited, true);
+                continue;
+            }
+
+            /* out of frames: all frames are full, the particles in thread order up to the last slot are created */
+            ++numOutOfFrames;
+            std::vector<uint32_t> expected(frameSize, 0);
+            uint32_t offset = 0;
+            for (uint32_t t = 0; t < frameSize; ++t)
+            {
+                expected[t] = std::min(numNewParticles[t], numLimited - std::min(numLimited, offset));
+                offset += numNewParticles[t];
+            }
+            isCorrect = isCorrect &&
+                limitedFrames.numFrames == options.heapFrames && limitedFrames.fillLevel == frameSize &&
+                (numLimited == 0 || isValid(limited, expected, firstLimited, true));
+            /* CreateParticlesKernel stops the supercell */
+            break;
+        }
+        isCorrect = isCorrect && limitedFrames.numFrames <= options.heapFrames;
+    }
+
+    const uint64_t numSourceFrames = uint64_t(options.numSuperCells) * options.numSourceFrames;
+    std::cout << numSourceFrames << " source frames (" << frameSize << " particles), "
+        << numCreated << " new particles, emit fraction " << options.emitFraction
+        << ", counts 1.." << options.maxEmission << " ~ n^-" << options.exponent << std::endl;
+    std::cout << "correct: " << (isCorrect ? "yes" : "no") << std::endl;
+    std::cout << std::setw(30) << std::left << "per source frame" << std::right
+        << std::setw(12) << "rounds" << std::setw(14) << "prefix sum" << std::endl;
+    std::cout << std::fixed << std::setprecision(2)
+        << std::setw(30) << std::left << "block barriers" << std::right
+        << std::setw(12) << double(barriers[0]) / numSourceFrames
+        << std::setw(14) << double(barriers[1]) / numSourceFrames << std::endl
+        << std::setw(30) << std::left << "block steps (round / create)" << std::right
+        << std::setw(12) << double(steps[0]) / numSourceFrames
+        << std::setw(14) << double(steps[1]) / numSourceFrames << std::endl
+        << std::setw(30) << std::left << "passes" << std::right
+        << std::setw(12) << "-"
+        << std::setw(14) << double(numPasses) / numSourceFrames << std::endl
+        << std::setw(30) << std::left << "serial frame allocations" << std::right
+        << std::setw(12) << double(serialAllocations[0]) / numSourceFrames
+        << std::setw(14) << double(serialAllocations[1]) / numSourceFrames << std::endl
+        << std::setw(30) << std::left << "target frames (total)" << std::right
+        << std::setw(12) << numFrames[0]
+        << std::setw(14) << numFrames[1] << std::endl
+        << "out of frames with " << options.heapFrames << " frames per supercell: "
+        << numOutOfFrames << " of " << options.numSuperCells << " supercells" << std::endl;
+
+    return isCorrect ? 0 : 1;
+}
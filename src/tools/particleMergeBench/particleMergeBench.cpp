@@ -0,0 +1,367 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "particles/resampling/MergeMomenta.hpp"
+#include "particles/sorting/CountingSort.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+namespace resampling = PMacc::particles::resampling;
+
+typedef struct
+{
+    int cellsPerSuperCell;
+    std::vector<int> particlesPerCell;
+    size_t numSuperCells;
+    int maxBinFrames;
+    int numGroupTests;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.cellsPerSuperCell = 256;
+        options.numSuperCells = 1024;
+        options.maxBinFrames = 16;
+        options.numGroupTests = 10000;
+        options.repetitions = 3;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Checks the conservation of weighting, momentum and energy by the particle merging (MergeImpl)" << std::endl
+            << "and compares binning the particles of a supercell by cell (counting sort of up to" << std::endl
+            << "maxBinFrames frames) with a walk of each cell over all particles of the supercell." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("cells,c", po::value<int > (&options.cellsPerSuperCell)->default_value(options.cellsPerSuperCell),
+                 "cells per supercell (= particles per frame)")
+                ("particlesPerCell,p", po::value<std::vector<int> > (&options.particlesPerCell)->multitoken(),
+                 "mean particles per cell, one measurement per value (default: 2 8 32 128)")
+                ("superCells,s", po::value<size_t > (&options.numSuperCells)->default_value(options.numSuperCells), "number of supercells")
+                ("maxBinFrames", po::value<int > (&options.maxBinFrames)->default_value(options.maxBinFrames),
+                 "frames binned at once (MergeImpl::maxBinFrames)")
+                ("groups,g", po::value<int > (&options.numGroupTests)->default_value(options.numGroupTests),
+                 "random groups per conservation test")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.particlesPerCell.empty())
+        {
+            const int particlesPerCell[] = {2, 8, 32, 128};
+            options.particlesPerCell.assign(particlesPerCell, particlesPerCell + 4);
+        }
+
+        bool isValid = options.cellsPerSuperCell > 0 && options.numSuperCells > 0 && options.maxBinFrames > 0 &&
+            options.maxBinFrames * options.cellsPerSuperCell <= 65536 &&
+            options.numGroupTests > 0 && options.repetitions > 0;
+        for (size_t i = 0; i < options.particlesPerCell.size(); ++i)
+            isValid = isValid && options.particlesPerCell[i] > 0;
+        if (!isValid)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/** merge random groups of one momentum octant and check the conservation laws
+ *
+ * @param mass mass of a single particle (c = 1), zero for photons
+ * @param tolerance allowed relative error of the momentum and the energy
+ * @return number of groups violating a conservation law
+ */
+template<typename T_Float>
+int checkConservation(const T_Float mass, const T_Float tolerance, const int numGroups, std::mt19937& rng)
+{
+    const T_Float c = T_Float(1.0);
+    std::uniform_int_distribution<int> sizeDist(3, 64);
+    std::uniform_real_distribution<double> weightingDist(0.5, 4.0);
+    std::lognormal_distribution<double> momDist(std::log(0.5), 1.5);
+    std::uniform_int_distribution<int> octantDist(0, 7);
+
+    int numErrors = 0;
+    for (int n = 0; n < numGroups; ++n)
+    {
+        const int octant = octantDist(rng);
+        const int groupSize = sizeDist(rng);
+
+        T_Float weighting = T_Float(0.0);
+        T_Float momentum[3] = {T_Float(0.0), T_Float(0.0), T_Float(0.0)};
+        T_Float energyMeasure = T_Float(0.0);
+        for (int i = 0; i < groupSize; ++i)
+        {
+            const T_Float w = T_Float(weightingDist(rng));
+            T_Float single[3];
+            for (int d = 0; d < 3; ++d)
+                single[d] = T_Float(momDist(rng)) * ((octant >> d) & 1 ? T_Float(-1.0) : T_Float(1.0));
+            for (int d = 0; d < 3; ++d)
+                momentum[d] += w * single[d];
+            weighting += w;
+            energyMeasure += w * resampling::mergeEnergyMeasure(single, mass, c);
+        }
+
+        T_Float momentumA[3];
+        T_Float momentumB[3];
+        const T_Float cosAngle = resampling::mergeMomenta(weighting, momentum, energyMeasure, mass, c, momentumA, momentumB);
+
+        /* both new particles get half of the weighting, thus each carries a
+         * single momentum of momentum / (weighting / 2) */
+        const T_Float halfWeighting = T_Float(0.5) * weighting;
+        T_Float singleA[3];
+        T_Float singleB[3];
+        T_Float momentumError = T_Float(0.0);
+        T_Float momentumNorm = T_Float(0.0);
+        for (int d = 0; d < 3; ++d)
+        {
+            singleA[d] = momentumA[d] / halfWeighting;
+            singleB[d] = momentumB[d] / halfWeighting;
+            momentumError = std::max(momentumError, std::abs(momentumA[d] + momentumB[d] - momentum[d]));
+            momentumNorm = std::max(momentumNorm, std::abs(momentum[d]));
+        }
+        const T_Float mergedEnergy = halfWeighting * resampling::mergeEnergyMeasure(singleA, mass, c) +
+            halfWeighting * resampling::mergeEnergyMeasure(singleB, mass, c);
+
+        const bool isConserved = halfWeighting + halfWeighting == weighting &&
+            momentumError <= tolerance * momentumNorm &&
+            std::abs(mergedEnergy - energyMeasure) <= tolerance * energyMeasure &&
+            cosAngle >= T_Float(0.0) && cosAngle <= T_Float(1.0) + tolerance;
+        if (!isConserved)
+        {
+            if (numErrors == 0)
+                std::cerr << "Error: group of " << groupSize << " particles (mass " << mass << "): momentum error "
+                    << momentumError << " of " << momentumNorm << ", energy " << mergedEnergy << " instead of "
+                    << energyMeasure << ", cos angle " << cosAngle << std::endl;
+            ++numErrors;
+        }
+    }
+    return numErrors;
+}
+
+/** sums of the particles of a cell which MergeImpl collects in its first pass */
+struct CellSums
+{
+    double momentum[3];
+    double weighting;
+    double energyMeasure;
+    uint32_t numParticles;
+
+    CellSums() : weighting(0.0), energyMeasure(0.0), numParticles(0)
+    {
+        momentum[0] = momentum[1] = momentum[2] = 0.0;
+    }
+
+    void add(const double w, const double (&mom)[3])
+    {
+        double single[3];
+        for (int d = 0; d < 3; ++d)
+        {
+            momentum[d] += mom[d];
+            single[d] = mom[d] / w;
+        }
+        weighting += w;
+        energyMeasure += w * resampling::mergeEnergyMeasure(single, 1.0, 1.0);
+        ++numParticles;
+    }
+
+    bool operator==(const CellSums& other) const
+    {
+        return momentum[0] == other.momentum[0] && momentum[1] == other.momentum[1] &&
+            momentum[2] == other.momentum[2] && weighting == other.weighting &&
+            energyMeasure == other.energyMeasure && numParticles == other.numParticles;
+    }
+};
+
+/** particles of a supercell, frame after frame, cellIdx is negative for a gap */
+struct SuperCell
+{
+    std::vector<int> cellIdx;
+    std::vector<double> weighting;
+    std::vector<double> momentum;
+};
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    std::mt19937 rng(42);
+    bool isCorrect = true;
+
+    std::cout << "conservation of weighting, momentum and energy, " << options.numGroupTests << " random groups each" << std::endl;
+    const struct
+    {
+        const char* name;
+        double mass;
+    } species[] = {{"massive", 1.0}, {"massless", 0.0}};
+    for (int s = 0; s < 2; ++s)
+    {
+        const int errorsFloat = checkConservation<float>(float(species[s].mass), 1.0e-4f, options.numGroupTests, rng);
+        const int errorsDouble = checkConservation<double>(species[s].mass, 1.0e-10, options.numGroupTests, rng);
+        std::cout << std::setw(10) << species[s].name
+            << "  float: " << (errorsFloat == 0 ? "conserved" : "violated") << " (" << errorsFloat << " groups)"
+            << "  double: " << (errorsDouble == 0 ? "conserved" : "violated") << " (" << errorsDouble << " groups)" << std::endl;
+        isCorrect = isCorrect && errorsFloat == 0 && errorsDouble == 0;
+    }
+
+    const int numCells = options.cellsPerSuperCell;
+    std::cout << std::endl << options.numSuperCells << " supercells, " << numCells << " cells, "
+        << options.maxBinFrames << " frames binned at once" << std::endl;
+    std::cout << std::setw(10) << "par/cell" << std::setw(10) << "frames"
+        << std::setw(16) << "walk [ns/par]" << std::setw(16) << "binned [ns/par]"
+        << std::setw(16) << "walk [vis/par]" << std::setw(8) << "equal" << std::endl;
+
+    for (size_t p = 0; p < options.particlesPerCell.size(); ++p)
+    {
+        /* random cells, about 10% gaps, the last frame is partly filled */
+        const size_t numParticles = size_t(options.particlesPerCell[p]) * numCells;
+        const size_t numFrames = (numParticles * 10 / 9 + numCells - 1) / numCells;
+        const size_t numSlots = numFrames * numCells;
+        std::uniform_int_distribution<int> cellDist(0, numCells - 1);
+        std::uniform_real_distribution<double> gapDist(0.0, 1.0);
+        std::uniform_real_distribution<double> weightingDist(0.5, 4.0);
+        std::normal_distribution<double> momDist(0.0, 1.0);
+
+        std::vector<SuperCell> superCells(options.numSuperCells);
+        size_t numAllParticles = 0;
+        for (size_t s = 0; s < options.numSuperCells; ++s)
+        {
+            SuperCell& sc = superCells[s];
+            sc.cellIdx.resize(numSlots);
+            sc.weighting.resize(numSlots);
+            sc.momentum.resize(3 * numSlots);
+            for (size_t slot = 0; slot < numSlots; ++slot)
+            {
+                const bool isGap = slot >= numParticles * 10 / 9 || gapDist(rng) < 0.1;
+                sc.cellIdx[slot] = isGap ? -1 : cellDist(rng);
+                sc.weighting[slot] = weightingDist(rng);
+                for (int d = 0; d < 3; ++d)
+                    sc.momentum[3 * slot + d] = sc.weighting[slot] * momDist(rng);
+                numAllParticles += isGap ? 0 : 1;
+            }
+        }
+
+        std::vector<CellSums> walkSums(options.numSuperCells * numCells);
+        std::vector<CellSums> binnedSums(options.numSuperCells * numCells);
+        double times[2] = {0.0, 0.0};
+        for (int r = 0; r < options.repetitions; ++r)
+        {
+            /* old MergeImpl: each cell walks over all slots of the supercell */
+            std::fill(walkSums.begin(), walkSums.end(), CellSums());
+            auto start = std::chrono::steady_clock::now();
+            for (size_t s = 0; s < options.numSuperCells; ++s)
+            {
+                const SuperCell& sc = superCells[s];
+                for (int cell = 0; cell < numCells; ++cell)
+                {
+                    CellSums& sums = walkSums[s * numCells + cell];
+                    for (size_t slot = 0; slot < numSlots; ++slot)
+                    {
+                        if (sc.cellIdx[slot] != cell)
+                            continue;
+                        const double mom[3] = {sc.momentum[3 * slot], sc.momentum[3 * slot + 1], sc.momentum[3 * slot + 2]};
+                        sums.add(sc.weighting[slot], mom);
+                    }
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+            const double walkNs = std::chrono::duration<double, std::nano>(end - start).count() / numAllParticles;
+
+            /* MergeImpl: counting sort of up to maxBinFrames frames, each cell
+             * visits only its particles */
+            std::fill(binnedSums.begin(), binnedSums.end(), CellSums());
+            std::vector<int> chunkCellIdx;
+            std::vector<uint32_t> srcSlot;
+            std::vector<uint32_t> cellBegin;
+            start = std::chrono::steady_clock::now();
+            for (size_t s = 0; s < options.numSuperCells; ++s)
+            {
+                const SuperCell& sc = superCells[s];
+                const size_t chunkSlots = size_t(options.maxBinFrames) * numCells;
+                for (size_t first = 0; first < numSlots; first += chunkSlots)
+                {
+                    const size_t last = std::min(numSlots, first + chunkSlots);
+                    chunkCellIdx.assign(sc.cellIdx.begin() + first, sc.cellIdx.begin() + last);
+                    PMacc::particles::sorting::countingSort(chunkCellIdx, numCells, srcSlot, cellBegin);
+                    for (int cell = 0; cell < numCells; ++cell)
+                    {
+                        CellSums& sums = binnedSums[s * numCells + cell];
+                        for (uint32_t i = cellBegin[cell]; i < cellBegin[cell + 1]; ++i)
+                        {
+                            const size_t slot = first + srcSlot[i];
+                            const double mom[3] = {sc.momentum[3 * slot], sc.momentum[3 * slot + 1], sc.momentum[3 * slot + 2]};
+                            sums.add(sc.weighting[slot], mom);
+                        }
+                    }
+                }
+            }
+            end = std::chrono::steady_clock::now();
+            const double binnedNs = std::chrono::duration<double, std::nano>(end - start).count() / numAllParticles;
+
+            times[0] = r == 0 ? walkNs : std::min(times[0], walkNs);
+            times[1] = r == 0 ? binnedNs : std::min(times[1], binnedNs);
+        }
+
+        /* the binning keeps the order of the frame walk, thus the sums are bitwise equal */
+        const bool isEqual = walkSums == binnedSums;
+        isCorrect = isCorrect && isEqual;
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(10) << options.particlesPerCell[p]
+            << std::setw(10) << numFrames
+            << std::setw(16) << times[0]
+            << std::setw(16) << times[1]
+            << std::setw(16) << double(numSlots) * numCells * options.numSuperCells / numAllParticles
+            << std::setw(8) << (isEqual ? "yes" : "no") << std::endl;
+    }
+
+    return isCorrect ? 0 : 1;
+}
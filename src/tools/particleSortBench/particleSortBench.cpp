@@ -0,0 +1,341 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "particles/sorting/CountingSort.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+namespace sorting = PMacc::particles::sorting;
+
+/* supercell size as in the default PIConGPU memory.param */
+const int superCellSize[3] = {8, 8, 4};
+const int numCells = superCellSize[0] * superCellSize[1] * superCellSize[2];
+
+typedef struct
+{
+    int superCells[3];
+    int particlesPerCell;
+    double gapFraction;
+    int repetitions;
+} Options;
+
+/* particles of one supercell in the slots of its frames (structure of arrays) */
+struct SuperCell
+{
+    std::vector<int> cellIdx;
+    std::vector<float> pos[3];
+    std::vector<float> weighting;
+};
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        std::vector<int> superCells;
+        options.particlesPerCell = 8;
+        options.gapFraction = 0.1;
+        options.repetitions = 5;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Measures the host gather and deposit throughput with particles in frame order" << std::endl
+            << "and after sorting them by cell index (as done by KernelSortParticles)." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("superCells,s", po::value<std::vector<int> > (&superCells)->multitoken(), "number of supercells in each dimension, default: 8 8 8")
+                ("ppc,p", po::value<int > (&options.particlesPerCell)->default_value(options.particlesPerCell), "particles per cell")
+                ("gaps,g", po::value<double > (&options.gapFraction)->default_value(options.gapFraction), "fraction of empty slots in the frames")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        for (int d = 0; d < 3; ++d)
+            options.superCells[d] = d < (int) superCells.size() ? superCells[d] : 8;
+
+        if (options.particlesPerCell < 1 || options.gapFraction < 0.0 || options.gapFraction >= 1.0 ||
+            options.repetitions < 1)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* particles in random slots with gaps, as after some steps of shifting */
+std::vector<SuperCell> createParticles(const Options& options, std::mt19937& rng)
+{
+    const int numSuperCells = options.superCells[0] * options.superCells[1] * options.superCells[2];
+    const int numParticles = numCells * options.particlesPerCell;
+    const int numSlots = int(numParticles / (1.0 - options.gapFraction) + numCells - 1) / numCells * numCells;
+
+    std::uniform_int_distribution<int> cellDist(0, numCells - 1);
+    std::uniform_real_distribution<float> posDist(0.f, 1.f);
+
+    std::vector<SuperCell> superCells(numSuperCells);
+    for (int s = 0; s < numSuperCells; ++s)
+    {
+        SuperCell& sc = superCells[s];
+        sc.cellIdx.assign(numSlots, -1);
+        for (int i = 0; i < numParticles; ++i)
+            sc.cellIdx[i] = cellDist(rng);
+        std::shuffle(sc.cellIdx.begin(), sc.cellIdx.end(), rng);
+
+        for (int d = 0; d < 3; ++d)
+        {
+            sc.pos[d].resize(numSlots);
+            for (int i = 0; i < numSlots; ++i)
+                sc.pos[d][i] = posDist(rng);
+        }
+        sc.weighting.assign(numSlots, 1.f);
+    }
+    return superCells;
+}
+
+/* counting sort of all supercells, removes the gaps */
+void sortParticles(const std::vector<SuperCell>& src, std::vector<SuperCell>& dst)
+{
+    std::vector<uint32_t> srcSlot;
+    std::vector<uint32_t> cellBegin;
+    dst.resize(src.size());
+    for (size_t s = 0; s < src.size(); ++s)
+    {
+        sorting::countingSort(src[s].cellIdx, numCells, srcSlot, cellBegin);
+        sorting::gather(src[s].cellIdx, srcSlot, dst[s].cellIdx);
+        for (int d = 0; d < 3; ++d)
+            sorting::gather(src[s].pos[d], srcSlot, dst[s].pos[d]);
+        sorting::gather(src[s].weighting, srcSlot, dst[s].weighting);
+    }
+}
+
+/* all particles of a supercell are kept, the gaps are removed and the cells are ascending */
+bool isSortedByCell(const std::vector<SuperCell>& unsorted, const std::vector<SuperCell>& sorted)
+{
+    if (unsorted.size() != sorted.size())
+        return false;
+    for (size_t s = 0; s < unsorted.size(); ++s)
+    {
+        const std::vector<int>& cellIdx = sorted[s].cellIdx;
+        const size_t numParticles = std::count_if(unsorted[s].cellIdx.begin(), unsorted[s].cellIdx.end(),
+                                                  [](int idx) { return idx >= 0; });
+        if (cellIdx.size() != numParticles)
+            return false;
+        for (size_t i = 0; i < cellIdx.size(); ++i)
+            if (cellIdx[i] < 0 || (i > 0 && cellIdx[i] < cellIdx[i - 1]))
+                return false;
+    }
+    return true;
+}
+
+/* global cell index (with one guard cell on the upper side) */
+struct Grid
+{
+    int size[3];
+
+    Grid(const Options& options)
+    {
+        for (int d = 0; d < 3; ++d)
+            size[d] = options.superCells[d] * superCellSize[d] + 1;
+    }
+
+    size_t getNumCells() const
+    {
+        return size_t(size[0]) * size[1] * size[2];
+    }
+
+    size_t index(int superCell, int cell, int (&cellPos)[3], const Options& options) const
+    {
+        int superCellPos[3] = {superCell % options.superCells[0],
+            superCell / options.superCells[0] % options.superCells[1],
+            superCell / (options.superCells[0] * options.superCells[1])};
+        int inCell[3] = {cell % superCellSize[0],
+            cell / superCellSize[0] % superCellSize[1],
+            cell / (superCellSize[0] * superCellSize[1])};
+        for (int d = 0; d < 3; ++d)
+            cellPos[d] = superCellPos[d] * superCellSize[d] + inCell[d];
+        return (size_t(cellPos[2]) * size[1] + cellPos[1]) * size[0] + cellPos[0];
+    }
+};
+
+/* trilinear interpolation of a 3 component field (cloud in cell) */
+double gatherField(const std::vector<SuperCell>& superCells, const std::vector<float>& field,
+                   const Grid& grid, const Options& options)
+{
+    const size_t strideY = grid.size[0];
+    const size_t strideZ = size_t(grid.size[0]) * grid.size[1];
+    double sum = 0.0;
+    for (size_t s = 0; s < superCells.size(); ++s)
+    {
+        const SuperCell& sc = superCells[s];
+        for (size_t i = 0; i < sc.cellIdx.size(); ++i)
+        {
+            if (sc.cellIdx[i] < 0)
+                continue;
+            int cellPos[3];
+            const size_t idx = grid.index(s, sc.cellIdx[i], cellPos, options);
+            const float x = sc.pos[0][i];
+            const float y = sc.pos[1][i];
+            const float z = sc.pos[2][i];
+            for (int c = 0; c < 3; ++c)
+            {
+                const float* f = &field[c * grid.getNumCells() + idx];
+                const float value =
+                    (1.f - z) * ((1.f - y) * ((1.f - x) * f[0] + x * f[1]) +
+                                 y * ((1.f - x) * f[strideY] + x * f[strideY + 1])) +
+                    z * ((1.f - y) * ((1.f - x) * f[strideZ] + x * f[strideZ + 1]) +
+                         y * ((1.f - x) * f[strideZ + strideY] + x * f[strideZ + strideY + 1]));
+                sum += value;
+            }
+        }
+    }
+    return sum;
+}
+
+/* cloud in cell deposition of the weighting */
+void depositDensity(const std::vector<SuperCell>& superCells, std::vector<float>& density,
+                    const Grid& grid, const Options& options)
+{
+    const size_t strideY = grid.size[0];
+    const size_t strideZ = size_t(grid.size[0]) * grid.size[1];
+    for (size_t s = 0; s < superCells.size(); ++s)
+    {
+        const SuperCell& sc = superCells[s];
+        for (size_t i = 0; i < sc.cellIdx.size(); ++i)
+        {
+            if (sc.cellIdx[i] < 0)
+                continue;
+            int cellPos[3];
+            float* d = &density[grid.index(s, sc.cellIdx[i], cellPos, options)];
+            const float x = sc.pos[0][i];
+            const float y = sc.pos[1][i];
+            const float z = sc.pos[2][i];
+            const float w = sc.weighting[i];
+            d[0] += w * (1.f - x) * (1.f - y) * (1.f - z);
+            d[1] += w * x * (1.f - y) * (1.f - z);
+            d[strideY] += w * (1.f - x) * y * (1.f - z);
+            d[strideY + 1] += w * x * y * (1.f - z);
+            d[strideZ] += w * (1.f - x) * (1.f - y) * z;
+            d[strideZ + 1] += w * x * (1.f - y) * z;
+            d[strideZ + strideY] += w * (1.f - x) * y * z;
+            d[strideZ + strideY + 1] += w * x * y * z;
+        }
+    }
+}
+
+/* fastest of the repetitions in ns per particle */
+template<typename T_Functor>
+double measure(T_Functor functor, const Options& options, size_t numParticles)
+{
+    double best = 0.0;
+    for (int r = 0; r < options.repetitions; ++r)
+    {
+        auto start = std::chrono::steady_clock::now();
+        functor();
+        auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / numParticles;
+        if (r == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+void printResult(const std::string& name, double frameOrder, double sorted)
+{
+    std::cout << std::setw(10) << std::left << name << std::right << std::fixed << std::setprecision(2)
+        << std::setw(10) << frameOrder << std::setw(10) << sorted
+        << std::setw(10) << frameOrder / sorted << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    std::mt19937 rng(42);
+    std::vector<SuperCell> unsorted = createParticles(options, rng);
+    std::vector<SuperCell> sorted;
+
+    const Grid grid(options);
+    const size_t numParticles = unsorted.size() * size_t(numCells) * options.particlesPerCell;
+
+    std::vector<float> field(3 * grid.getNumCells());
+    std::uniform_real_distribution<float> fieldDist(-1.f, 1.f);
+    for (size_t i = 0; i < field.size(); ++i)
+        field[i] = fieldDist(rng);
+    std::vector<float> density(grid.getNumCells());
+
+    const double sortTime = measure([&]() { sortParticles(unsorted, sorted); }, options, numParticles);
+
+    double checkUnsorted = 0.0;
+    double checkSorted = 0.0;
+    const double gatherUnsorted = measure([&]() { checkUnsorted = gatherField(unsorted, field, grid, options); },
+                                          options, numParticles);
+    const double gatherSorted = measure([&]() { checkSorted = gatherField(sorted, field, grid, options); },
+                                        options, numParticles);
+    const double depositUnsorted = measure([&]() { depositDensity(unsorted, density, grid, options); },
+                                           options, numParticles);
+    const double depositSorted = measure([&]() { depositDensity(sorted, density, grid, options); },
+                                         options, numParticles);
+
+    std::cout << numParticles << " particles, " << unsorted.size() << " supercells of "
+        << superCellSize[0] << "x" << superCellSize[1] << "x" << superCellSize[2] << " cells, "
+        << options.gapFraction * 100.0 << "% gaps" << std::endl;
+    const bool isSorted = isSortedByCell(unsorted, sorted);
+    const double relativeDifference = std::abs(checkSorted - checkUnsorted) / std::abs(checkUnsorted);
+    std::cout << "sorted by cell: " << (isSorted ? "yes" : "no") << std::endl;
+    std::cout << "relative difference of the gathered sums: "
+        << std::scientific << relativeDifference << std::endl;
+    std::cout << std::setw(10) << std::left << "[ns/par]" << std::right
+        << std::setw(10) << "frames" << std::setw(10) << "sorted" << std::setw(10) << "speedup" << std::endl;
+    printResult("gather", gatherUnsorted, gatherSorted);
+    printResult("deposit", depositUnsorted, depositSorted);
+    std::cout << std::setw(10) << std::left << "sort" << std::right << std::fixed << std::setprecision(2)
+        << std::setw(10) << sortTime << std::endl;
+
+    /* the sum is accumulated in double, only the order of the particles differs */
+    return (isSorted && relativeDifference < 1.0e-9) ? 0 : 1;
+}
@@ -0,0 +1,326 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "algorithms/SharedBinLayout.hpp"
+#include "plugins/PhaseSpace/MomentumBinning.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    std::vector<int> superCellSize;
+    std::vector<int> gridSuperCells;
+    int particlesPerCell;
+    std::vector<std::string> phaseSpaces;
+    float momentumRange;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.particlesPerCell = 16;
+        options.momentumRange = 2.0f;
+        options.repetitions = 3;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Bins synthetic particles into several phase spaces (PhaseSpace plugin) separately, one pass per" << std::endl
+            << "phase space, and combined with one pass (PhaseSpaceCombined), compares both with a host reference" << std::endl
+            << "and counts the global memory atomics of each path." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("superCell,s", po::value<std::vector<int> > (&options.superCellSize)->multitoken(), "cells per supercell (default: 8 8 4)")
+                ("grid,g", po::value<std::vector<int> > (&options.gridSuperCells)->multitoken(), "supercells of the local domain (default: 16 16 16)")
+                ("particlesPerCell,n", po::value<int > (&options.particlesPerCell)->default_value(options.particlesPerCell), "particles per cell")
+                ("phaseSpace,p", po::value<std::vector<std::string> > (&options.phaseSpaces)->multitoken(),
+                 "phase spaces as <space><momentum>, e.g. ypy (default: all nine)")
+                ("momentumRange", po::value<float > (&options.momentumRange)->default_value(options.momentumRange),
+                 "momentum axis [-range, range], the momenta are normal distributed with a standard deviation of 1")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.superCellSize.empty())
+        {
+            const int superCellSize[] = {8, 8, 4};
+            options.superCellSize.assign(superCellSize, superCellSize + 3);
+        }
+        if (options.gridSuperCells.empty())
+            options.gridSuperCells.assign(3, 16);
+        if (options.phaseSpaces.empty())
+        {
+            const std::string axes("xyz");
+            for (int r = 0; r < 3; ++r)
+                for (int p = 0; p < 3; ++p)
+                    options.phaseSpaces.push_back(std::string(1, axes[r]) + "p" + axes[p]);
+        }
+
+        bool isValid = options.superCellSize.size() == 3 && options.gridSuperCells.size() == 3 &&
+            options.particlesPerCell > 0 && options.momentumRange > 0.0f && options.repetitions > 0;
+        for (int d = 0; d < 3 && isValid; ++d)
+            isValid = options.superCellSize[d] > 0 && options.gridSuperCells[d] > 0;
+        for (size_t i = 0; i < options.phaseSpaces.size(); ++i)
+        {
+            const std::string& ps = options.phaseSpaces[i];
+            isValid = isValid && ps.size() == 3 && ps[1] == 'p' &&
+                ps[0] >= 'x' && ps[0] <= 'z' && ps[2] >= 'x' && ps[2] <= 'z';
+        }
+        if (!isValid)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* momentum binning of the PhaseSpace plugin */
+typedef picongpu::MomentumBinning<float> MomentumBinning;
+
+/** synthetic particle, the charge density is an integer thus all sums are exact */
+struct Particle
+{
+    int cellIdx[3];
+    float mom[3];
+    double chargeDensity;
+};
+
+struct PhaseSpace
+{
+    int space;
+    int momentum;
+    /* [spatial bin][momentum bin] */
+    std::vector<double> bins;
+};
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    /* same sizes as PhaseSpace: 32 KiB of float per block snippet of the longest edge */
+    const size_t maxShared = 32 * 1024;
+    const int longestEdge = *std::max_element(options.superCellSize.begin(), options.superCellSize.end());
+    const int numPBins = int(maxShared / (sizeof(float) * longestEdge));
+    const size_t numSharedBins = maxShared / sizeof(float);
+    const int cellsPerSuperCell = options.superCellSize[0] * options.superCellSize[1] * options.superCellSize[2];
+    const int numSuperCells = options.gridSuperCells[0] * options.gridSuperCells[1] * options.gridSuperCells[2];
+
+    /* particles ordered by supercell, as the device walks them */
+    std::mt19937 rng(42);
+    std::normal_distribution<float> momDist(0.0f, 1.0f);
+    std::uniform_int_distribution<int> chargeDist(1, 4);
+    std::vector<size_t> superCellBegin(numSuperCells + 1, 0);
+    std::vector<Particle> particles;
+    for (int s = 0; s < numSuperCells; ++s)
+    {
+        const int superCellIdx[3] = {
+            s % options.gridSuperCells[0],
+            (s / options.gridSuperCells[0]) % options.gridSuperCells[1],
+            s / (options.gridSuperCells[0] * options.gridSuperCells[1])};
+        superCellBegin[s] = particles.size();
+        for (int c = 0; c < cellsPerSuperCell; ++c)
+            for (int n = 0; n < options.particlesPerCell; ++n)
+            {
+                Particle p;
+                const int localCellIdx[3] = {
+                    c % options.superCellSize[0],
+                    (c / options.superCellSize[0]) % options.superCellSize[1],
+                    c / (options.superCellSize[0] * options.superCellSize[1])};
+                for (int d = 0; d < 3; ++d)
+                {
+                    p.cellIdx[d] = superCellIdx[d] * options.superCellSize[d] + localCellIdx[d];
+                    p.mom[d] = momDist(rng);
+                }
+                p.chargeDensity = chargeDist(rng);
+                particles.push_back(p);
+            }
+    }
+    superCellBegin[numSuperCells] = particles.size();
+
+    const std::pair<float, float> axis_p_range(-options.momentumRange, options.momentumRange);
+    const size_t numPhaseSpaces = options.phaseSpaces.size();
+    std::vector<PhaseSpace> reference(numPhaseSpaces);
+    std::vector<size_t> numSnippetBins(numPhaseSpaces);
+    for (size_t i = 0; i < numPhaseSpaces; ++i)
+    {
+        reference[i].space = options.phaseSpaces[i][0] - 'x';
+        reference[i].momentum = options.phaseSpaces[i][2] - 'x';
+        const int r_dir = reference[i].space;
+        reference[i].bins.assign(size_t(options.gridSuperCells[r_dir]) * options.superCellSize[r_dir] * numPBins, 0.0);
+        numSnippetBins[i] = size_t(numPBins) * options.superCellSize[r_dir];
+    }
+
+    /* host reference */
+    for (size_t i = 0; i < numPhaseSpaces; ++i)
+    {
+        PhaseSpace& ps = reference[i];
+        for (size_t n = 0; n < particles.size(); ++n)
+        {
+            const Particle& p = particles[n];
+            const int p_bin = MomentumBinning::getMomentumBin(p.mom[ps.momentum], axis_p_range, numPBins);
+            ps.bins[size_t(p.cellIdx[ps.space]) * numPBins + p_bin] += p.chargeDensity;
+        }
+    }
+
+    std::vector<int> sharedOffset;
+    const size_t numUsedSharedBins = PMacc::algorithms::histogram::placeSharedBins(numSnippetBins, numSharedBins, sharedOffset);
+    std::vector<int> noSharedOffset(numPhaseSpaces, -1);
+    size_t numPrivatized = 0;
+    for (size_t i = 0; i < numPhaseSpaces; ++i)
+        numPrivatized += sharedOffset[i] >= 0 ? 1 : 0;
+
+    std::cout << particles.size() << " particles, " << numSuperCells << " supercells, " << numPBins << " momentum bins, "
+        << numPhaseSpaces << " phase spaces, " << numPrivatized << " of them in shared memory in the combined pass ("
+        << numUsedSharedBins * sizeof(float) / 1024 << " of " << maxShared / 1024 << " KiB)" << std::endl;
+    std::cout << std::setw(28) << "path" << std::setw(16) << "particle passes" << std::setw(18) << "global [upd/par]"
+        << std::setw(14) << "host [ns/par]" << std::setw(8) << "equal" << std::endl;
+
+    bool isCorrect = true;
+    /* 0: PhaseSpace per phase space (FunctorBlock), 1: combined, all
+     * phase spaces in global memory, 2: combined with shared snippets (FunctorBlockSet) */
+    const char* pathNames[] = {"separate (shared)", "combined (global)", "combined (shared + global)"};
+    for (int path = 0; path < 3; ++path)
+    {
+        double time = 0.0;
+        uint64_t globalUpdates = 0;
+        bool isEqual = true;
+        for (int r = 0; r < options.repetitions; ++r)
+        {
+            std::vector<PhaseSpace> result(reference);
+            for (size_t i = 0; i < numPhaseSpaces; ++i)
+                result[i].bins.assign(result[i].bins.size(), 0.0);
+            std::vector<double> sharedBins(numSharedBins);
+            globalUpdates = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            /* the separate path runs one pass per phase space */
+            const size_t numPasses = path == 0 ? numPhaseSpaces : 1;
+            for (size_t pass = 0; pass < numPasses; ++pass)
+            {
+                /* phase spaces of this pass and their shared offsets */
+                std::vector<size_t> passPhaseSpaces;
+                std::vector<int> passOffset(numPhaseSpaces, -1);
+                for (size_t i = 0; i < numPhaseSpaces; ++i)
+                {
+                    if (path == 0 && i != pass)
+                        continue;
+                    passPhaseSpaces.push_back(i);
+                    passOffset[i] = path == 0 ? 0 : (path == 1 ? noSharedOffset[i] : sharedOffset[i]);
+                }
+
+                for (int s = 0; s < numSuperCells; ++s)
+                {
+                    std::fill(sharedBins.begin(), sharedBins.end(), 0.0);
+                    const Particle& first = particles[superCellBegin[s]];
+                    for (size_t n = superCellBegin[s]; n < superCellBegin[s + 1]; ++n)
+                    {
+                        const Particle& p = particles[n];
+                        for (size_t k = 0; k < passPhaseSpaces.size(); ++k)
+                        {
+                            const size_t i = passPhaseSpaces[k];
+                            PhaseSpace& ps = result[i];
+                            const int p_bin = MomentumBinning::getMomentumBin(p.mom[ps.momentum], axis_p_range, numPBins);
+                            if (passOffset[i] >= 0)
+                            {
+                                const int localCell = p.cellIdx[ps.space] % options.superCellSize[ps.space];
+                                sharedBins[passOffset[i] + localCell * numPBins + p_bin] += p.chargeDensity;
+                            }
+                            else
+                            {
+                                ps.bins[size_t(p.cellIdx[ps.space]) * numPBins + p_bin] += p.chargeDensity;
+                                ++globalUpdates;
+                            }
+                        }
+                    }
+
+                    /* add the snippets to global memory, FunctorBlock adds all
+                     * bins, FunctorBlockSet skips empty bins */
+                    for (size_t k = 0; k < passPhaseSpaces.size(); ++k)
+                    {
+                        const size_t i = passPhaseSpaces[k];
+                        if (passOffset[i] < 0)
+                            continue;
+                        PhaseSpace& ps = result[i];
+                        const size_t blockOffset = size_t(first.cellIdx[ps.space] / options.superCellSize[ps.space]) *
+                            options.superCellSize[ps.space] * numPBins;
+                        for (size_t b = 0; b < numSnippetBins[i]; ++b)
+                        {
+                            const double value = sharedBins[passOffset[i] + b];
+                            if (path != 0 && value == 0.0)
+                                continue;
+                            ps.bins[blockOffset + b] += value;
+                            ++globalUpdates;
+                        }
+                    }
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+            const double ns = std::chrono::duration<double, std::nano>(end - start).count() / particles.size();
+            time = r == 0 ? ns : std::min(time, ns);
+
+            isEqual = true;
+            for (size_t i = 0; i < numPhaseSpaces; ++i)
+                isEqual = isEqual && result[i].bins == reference[i].bins;
+        }
+        isCorrect = isCorrect && isEqual;
+
+        std::cout << std::fixed << std::setprecision(3)
+            << std::setw(28) << pathNames[path]
+            << std::setw(16) << (path == 0 ? numPhaseSpaces : 1)
+            << std::setw(18) << double(globalUpdates) / particles.size()
+            << std::setw(14) << time
+            << std::setw(8) << (isEqual ? "yes" : "no") << std::endl;
+    }
+
+    return isCorrect ? 0 : 1;
+}
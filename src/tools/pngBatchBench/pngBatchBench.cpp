@@ -0,0 +1,703 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "plugins/output/GatherSlices.hpp"
+#include "plugins/output/header/NodeHeader.hpp"
+#include "memory/boxes/DataBox.hpp"
+#include "memory/boxes/PitchedBox.hpp"
+#include "dimensions/DataSpace.hpp"
+
+#include <mpi.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    std::vector<int> globalCells;
+    std::vector<int> superCellSize;
+    std::vector<std::string> axis;
+    std::vector<float> slicePoints;
+    int particlesPerCell;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options, const bool isRoot)
+{
+    try
+    {
+        options.particlesPerCell = 8;
+        options.repetitions = 3;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Renders several slices of synthetic fields and particles on all MPI ranks, once with one pass" << std::endl
+            << "and one collective per slice (as Visualisation and GatherSlice) and once with one pass for all" << std::endl
+            << "slices and the GatherSlices of PIConGPU (as VisualisationBatch), and compares the gathered" << std::endl
+            << "images of both paths with a host reference of the global domain." << std::endl
+            << "The painting is a host model of the kernels: the per pixel functions depend on the parameters" << std::endl
+            << "of a simulation (vis_kernels::fieldsToChannels, addDensity) and are replaced by simple functions." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("grid,g", po::value<std::vector<int> > (&options.globalCells)->multitoken(), "global cells (default: 64 64 64)")
+                ("superCell,s", po::value<std::vector<int> > (&options.superCellSize)->multitoken(), "cells per supercell (default: 8 8 4)")
+                ("axis,a", po::value<std::vector<std::string> > (&options.axis)->multitoken(),
+                 "axes of the slices (default: yx yz xz yx)")
+                ("slicePoint,p", po::value<std::vector<float> > (&options.slicePoints)->multitoken(),
+                 "point of each slice, 0 <= x < 1 (default: 0.5 0.5 0.25 0.1)")
+                ("particlesPerCell,n", po::value<int > (&options.particlesPerCell)->default_value(options.particlesPerCell), "particles per cell")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of measurements (the fastest is shown)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            if (isRoot)
+                std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.globalCells.empty())
+            options.globalCells.assign(3, 64);
+        if (options.superCellSize.empty())
+        {
+            const int superCellSize[] = {8, 8, 4};
+            options.superCellSize.assign(superCellSize, superCellSize + 3);
+        }
+        if (options.axis.empty())
+        {
+            const char* axis[] = {"yx", "yz", "xz", "yx"};
+            options.axis.assign(axis, axis + 4);
+        }
+        if (options.slicePoints.empty())
+        {
+            const float slicePoints[] = {0.5f, 0.5f, 0.25f, 0.1f};
+            options.slicePoints.assign(slicePoints, slicePoints + 4);
+        }
+
+        bool isValid = options.globalCells.size() == 3 && options.superCellSize.size() == 3 &&
+            options.axis.size() == options.slicePoints.size() && options.axis.size() <= 32 &&
+            options.particlesPerCell > 0 && options.repetitions > 0;
+        for (int d = 0; d < 3 && isValid; ++d)
+            isValid = options.superCellSize[d] > 0 && options.globalCells[d] > 0;
+        for (size_t s = 0; s < options.axis.size() && isValid; ++s)
+            isValid = options.axis[s].size() == 2 && options.axis[s][0] != options.axis[s][1] &&
+                options.axis[s][0] >= 'x' && options.axis[s][0] <= 'z' &&
+                options.axis[s][1] >= 'x' && options.axis[s][1] <= 'z' &&
+                options.slicePoints[s] >= 0.0f && options.slicePoints[s] < 1.0f;
+        if (!isValid)
+        {
+            if (isRoot)
+            {
+                std::cerr << "Error: invalid options." << std::endl;
+                std::cerr << std::endl << desc << std::endl;
+            }
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        if (isRoot)
+            std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+struct Pixel
+{
+    float c[3];
+
+    bool operator==(const Pixel& other) const
+    {
+        return c[0] == other.c[0] && c[1] == other.c[1] && c[2] == other.c[2];
+    }
+};
+
+/* members of MessageHeader which are used by GatherSlice and GatherSlices
+ *
+ * SimHeader needs the types of a simulation, only its size is used
+ */
+struct HeaderData
+{
+    struct
+    {
+        PMacc::DataSpace<DIM2> size;
+    } sim;
+    NodeHeader node;
+};
+
+struct Header : public HeaderData
+{
+    enum
+    {
+        bytes = sizeof (HeaderData)
+    };
+};
+
+typedef PMacc::DataBox<PMacc::PitchedBox<Pixel, DIM2> > PixelBox;
+
+/** box of a 2D image in host memory */
+PixelBox getBox(Pixel* data, const PMacc::DataSpace<DIM2>& size)
+{
+    return PixelBox(PMacc::PitchedBox<Pixel, DIM2>(data, PMacc::DataSpace<DIM2>(), size, size.x() * sizeof (Pixel)));
+}
+
+struct Particle
+{
+    int localCellIdx;
+    float weighting;
+};
+
+/** synthetic simulation, all values depend only on the global cell and supercell */
+struct Domain
+{
+    int globalCells[3];
+    int superCellSize[3];
+    int localCells[3];
+    int localOffset[3];
+    int particlesPerCell;
+
+    int getCellsPerSuperCell() const
+    {
+        return superCellSize[0] * superCellSize[1] * superCellSize[2];
+    }
+
+    /** stand-in for vis_kernels::fieldsToChannels of the fields of a global cell */
+    Pixel getFieldChannels(const int (&cell)[3]) const
+    {
+        uint32_t h = uint32_t(cell[0]) * 73856093u ^ uint32_t(cell[1]) * 19349663u ^ uint32_t(cell[2]) * 83492791u;
+        Pixel p;
+        for (int c = 0; c < 3; ++c)
+        {
+            h = h * 1664525u + 1013904223u;
+            p.c[c] = float(h >> 8) / float(1u << 24) * float(c + 1);
+        }
+        return p;
+    }
+
+    /** particles of a global supercell, frame after frame, localCellIdx -1 is a gap */
+    std::vector<Particle> getParticles(const int (&superCell)[3]) const
+    {
+        const int cellsPerSuperCell = getCellsPerSuperCell();
+        const int numSuperCells[3] = {
+            globalCells[0] / superCellSize[0], globalCells[1] / superCellSize[1], globalCells[2] / superCellSize[2]};
+        std::mt19937 rng(1 + superCell[0] + numSuperCells[0] * (superCell[1] + numSuperCells[1] * superCell[2]));
+        std::uniform_int_distribution<int> cellDist(0, cellsPerSuperCell - 1);
+        std::uniform_int_distribution<int> gapDist(0, 9);
+        std::uniform_real_distribution<float> weightingDist(0.5f, 2.0f);
+
+        const int numParticles = particlesPerCell * cellsPerSuperCell;
+        const int numFrames = (numParticles + numParticles / 8 + cellsPerSuperCell - 1) / cellsPerSuperCell;
+        std::vector<Particle> particles(numFrames * cellsPerSuperCell);
+        for (size_t i = 0; i < particles.size(); ++i)
+        {
+            particles[i].localCellIdx = (int(i) < numParticles + numParticles / 8 && gapDist(rng) != 0) ? cellDist(rng) : -1;
+            particles[i].weighting = weightingDist(rng);
+        }
+        return particles;
+    }
+
+    void getCellInSuperCell(const int localCellIdx, int (&cell)[3]) const
+    {
+        cell[0] = localCellIdx % superCellSize[0];
+        cell[1] = (localCellIdx / superCellSize[0]) % superCellSize[1];
+        cell[2] = localCellIdx / (superCellSize[0] * superCellSize[1]);
+    }
+};
+
+/** stand-in for vis_kernels::addDensity */
+void addDensity(Pixel& pixel, const float counter, const int particlesPerCell)
+{
+    float value = counter / float(particlesPerCell);
+    if (value > 1.0f)
+        value = 1.0f;
+    pixel.c[0] = std::min(pixel.c[0] + value, 1.0f);
+}
+
+/* stand-in for vis_kernels::DivideAnyCell */
+void divide(Pixel& pixel, const Pixel& max)
+{
+    for (int c = 0; c < 3; ++c)
+        pixel.c[c] /= (max.c[c] + FLT_MIN);
+}
+
+struct Slice
+{
+    /* image axes (transpose) and the axis normal to the slice */
+    int tx;
+    int ty;
+    int sliceDim;
+    /* global cell of the slice along sliceDim */
+    int sliceOffset;
+    bool isDrawing;
+    std::vector<Pixel> img;
+    Header header;
+};
+
+/** paint the local images of the given slices
+ *
+ * @param isBatched false: one pass over the cells and the particles per slice
+ *                  (KernelPaintFields, KernelPaintParticles3D), true: one pass for
+ *                  all slices (KernelPaintFieldsBatch, KernelPaintParticlesBatch)
+ * @return number of MPI collectives for the maxima
+ */
+int paint(const Domain& dom, std::vector<Slice>& slices, const bool isBatched)
+{
+    const size_t numSlices = slices.size();
+    for (size_t s = 0; s < numSlices; ++s)
+        if (slices[s].isDrawing)
+            std::fill(slices[s].img.begin(), slices[s].img.end(), Pixel());
+
+    const int numPasses = isBatched ? 1 : int(numSlices);
+    std::vector<size_t> passSlices;
+
+    /* fields */
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        int cell[3];
+        for (cell[2] = dom.localOffset[2]; cell[2] < dom.localOffset[2] + dom.localCells[2]; ++cell[2])
+            for (cell[1] = dom.localOffset[1]; cell[1] < dom.localOffset[1] + dom.localCells[1]; ++cell[1])
+                for (cell[0] = dom.localOffset[0]; cell[0] < dom.localOffset[0] + dom.localCells[0]; ++cell[0])
+                {
+                    bool isLoaded = false;
+                    Pixel pic;
+                    for (size_t s = isBatched ? 0 : pass; s < (isBatched ? numSlices : pass + 1); ++s)
+                    {
+                        Slice& slice = slices[s];
+                        if (!slice.isDrawing || cell[slice.sliceDim] != slice.sliceOffset)
+                            continue;
+                        if (!isLoaded)
+                        {
+                            pic = dom.getFieldChannels(cell);
+                            isLoaded = true;
+                        }
+                        slice.img[(cell[slice.ty] - dom.localOffset[slice.ty]) * dom.localCells[slice.tx] +
+                            cell[slice.tx] - dom.localOffset[slice.tx]] = pic;
+                    }
+                }
+    }
+
+    /* maxima of the channels, one reduce per slice or one for all slices */
+    std::vector<Pixel> localMax(numSlices);
+    for (size_t s = 0; s < numSlices; ++s)
+    {
+        std::fill(localMax[s].c, localMax[s].c + 3, -FLT_MAX);
+        for (size_t i = 0; slices[s].isDrawing && i < slices[s].img.size(); ++i)
+            for (int c = 0; c < 3; ++c)
+                localMax[s].c[c] = std::max(localMax[s].c[c], slices[s].img[i].c[c]);
+    }
+    std::vector<Pixel> max(numSlices);
+    int numCollectives = 0;
+    if (isBatched)
+    {
+        MPI_Allreduce(&localMax[0], &max[0], 3 * numSlices, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+        ++numCollectives;
+    }
+    else
+        for (size_t s = 0; s < numSlices; ++s)
+        {
+            MPI_Allreduce(&localMax[s], &max[s], 3, MPI_FLOAT, MPI_MAX, MPI_COMM_WORLD);
+            ++numCollectives;
+        }
+    for (size_t s = 0; s < numSlices; ++s)
+        for (size_t i = 0; slices[s].isDrawing && i < slices[s].img.size(); ++i)
+            divide(slices[s].img[i], max[s]);
+
+    /* particles */
+    const int cellsPerSuperCell = dom.getCellsPerSuperCell();
+    std::vector<float> counter(numSlices * cellsPerSuperCell);
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        int sc[3];
+        for (sc[2] = dom.localOffset[2] / dom.superCellSize[2]; sc[2] < (dom.localOffset[2] + dom.localCells[2]) / dom.superCellSize[2]; ++sc[2])
+            for (sc[1] = dom.localOffset[1] / dom.superCellSize[1]; sc[1] < (dom.localOffset[1] + dom.localCells[1]) / dom.superCellSize[1]; ++sc[1])
+                for (sc[0] = dom.localOffset[0] / dom.superCellSize[0]; sc[0] < (dom.localOffset[0] + dom.localCells[0]) / dom.superCellSize[0]; ++sc[0])
+                {
+                    /* slices in this supercell */
+                    passSlices.clear();
+                    for (size_t s = isBatched ? 0 : pass; s < (isBatched ? numSlices : pass + 1); ++s)
+                    {
+                        const Slice& slice = slices[s];
+                        const int first = sc[slice.sliceDim] * dom.superCellSize[slice.sliceDim];
+                        if (slice.isDrawing && slice.sliceOffset >= first && slice.sliceOffset < first + dom.superCellSize[slice.sliceDim])
+                            passSlices.push_back(s);
+                    }
+                    if (passSlices.empty())
+                        continue;
+
+                    std::fill(counter.begin(), counter.end(), 0.0f);
+                    const std::vector<Particle> particles = dom.getParticles(sc);
+                    for (size_t p = 0; p < particles.size(); ++p)
+                    {
+                        if (particles[p].localCellIdx < 0)
+                            continue;
+                        int cell[3];
+                        dom.getCellInSuperCell(particles[p].localCellIdx, cell);
+                        for (size_t k = 0; k < passSlices.size(); ++k)
+                        {
+                            const Slice& slice = slices[passSlices[k]];
+                            if (sc[slice.sliceDim] * dom.superCellSize[slice.sliceDim] + cell[slice.sliceDim] != slice.sliceOffset)
+                                continue;
+                            counter[passSlices[k] * cellsPerSuperCell + cell[slice.ty] * dom.superCellSize[slice.tx] + cell[slice.tx]] +=
+                                particles[p].weighting;
+                        }
+                    }
+
+                    for (size_t k = 0; k < passSlices.size(); ++k)
+                    {
+                        Slice& slice = slices[passSlices[k]];
+                        for (int cy = 0; cy < dom.superCellSize[slice.ty]; ++cy)
+                            for (int cx = 0; cx < dom.superCellSize[slice.tx]; ++cx)
+                            {
+                                const int x = sc[slice.tx] * dom.superCellSize[slice.tx] + cx - dom.localOffset[slice.tx];
+                                const int y = sc[slice.ty] * dom.superCellSize[slice.ty] + cy - dom.localOffset[slice.ty];
+                                addDensity(slice.img[y * dom.localCells[slice.tx] + x],
+                                           counter[passSlices[k] * cellsPerSuperCell + cy * dom.superCellSize[slice.tx] + cx],
+                                           dom.particlesPerCell);
+                            }
+                    }
+                }
+    }
+    return numCollectives;
+}
+
+/** gather each slice with its own communicator and MPI_Gatherv, as one GatherSlice per slice
+ *
+ * @param[out] result gathered image of each slice, empty if this rank is not the master
+ * @return number of MPI collectives
+ */
+int gatherSeparate(const std::vector<Slice>& slices, std::vector<std::vector<Pixel> >& result)
+{
+    int worldRank;
+    int worldSize;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+    static int masterRankOffset = 0;
+    int numCollectives = 0;
+
+    result.assign(slices.size(), std::vector<Pixel>());
+    for (size_t s = 0; s < slices.size(); ++s)
+    {
+        const Slice& slice = slices[s];
+        int mpiRank = slice.isDrawing ? worldRank : -1;
+        std::vector<int> gatherRanks(worldSize);
+        MPI_Allgather(&mpiRank, 1, MPI_INT, &gatherRanks[0], 1, MPI_INT, MPI_COMM_WORLD);
+        std::vector<int> groupRanks;
+        for (int r = 0; r < worldSize; ++r)
+            if (gatherRanks[r] != -1)
+                groupRanks.push_back(gatherRanks[r]);
+
+        MPI_Group group;
+        MPI_Group newgroup;
+        MPI_Comm comm;
+        MPI_Comm_group(MPI_COMM_WORLD, &group);
+        MPI_Group_incl(group, groupRanks.size(), &groupRanks[0], &newgroup);
+        MPI_Comm_create(MPI_COMM_WORLD, newgroup, &comm);
+        MPI_Group_free(&group);
+        MPI_Group_free(&newgroup);
+        numCollectives += 2;
+
+        masterRankOffset++;
+        const int masterRank = masterRankOffset % int(groupRanks.size());
+        if (comm == MPI_COMM_NULL)
+            continue;
+        MPI_Comm_rank(comm, &mpiRank);
+        const int numRanks = groupRanks.size();
+
+        std::vector<Header> headers(numRanks);
+        MPI_Gather(const_cast<Header*>(&slice.header), sizeof(Header), MPI_CHAR,
+                   &headers[0], sizeof(Header), MPI_CHAR, masterRank, comm);
+        std::vector<int> counts(numRanks);
+        std::vector<int> displs(numRanks);
+        int offset = 0;
+        for (int i = 0; i < numRanks; ++i)
+        {
+            counts[i] = headers[i].node.maxSize.productOfComponents() * sizeof(Pixel);
+            displs[i] = offset;
+            offset += counts[i];
+        }
+        std::vector<char> fullData(mpiRank == masterRank ? offset : 0);
+        MPI_Gatherv(const_cast<Pixel*>(slice.img.data()), slice.img.size() * sizeof(Pixel), MPI_CHAR,
+                    fullData.data(), &counts[0], &displs[0], MPI_CHAR, masterRank, comm);
+
+        if (mpiRank == masterRank)
+        {
+            result[s].resize(slice.header.sim.size.productOfComponents());
+            PixelBox dst = getBox(result[s].data(), slice.header.sim.size);
+            for (int i = 0; i < numRanks; ++i)
+                picongpu::GatherSlices::insertData(dst, getBox((Pixel*) (fullData.data() + displs[i]), headers[i].node.maxSize),
+                                                   headers[i].node.offset, headers[i].node.maxSize);
+        }
+        MPI_Comm_free(&comm);
+    }
+    return numCollectives;
+}
+
+/** gather all slices with one MPI_Alltoallv with the GatherSlices of PIConGPU
+ *
+ * @param[out] result gathered image of each slice, empty if this rank is not the master
+ * @return number of MPI collectives
+ */
+int gatherBatched(const std::vector<Slice>& slices, std::vector<std::vector<Pixel> >& result)
+{
+    const size_t numSlices = slices.size();
+    std::vector<bool> isActive(numSlices);
+    std::vector<int> bytes(numSlices);
+    std::vector<uint32_t> selected(numSlices);
+    std::vector<PixelBox> boxes(numSlices);
+    std::vector<Header*> headers(numSlices);
+    for (size_t s = 0; s < numSlices; ++s)
+    {
+        const Slice& slice = slices[s];
+        isActive[s] = slice.isDrawing;
+        bytes[s] = slice.img.size() * sizeof(Pixel);
+        selected[s] = s;
+        if (slice.isDrawing)
+            boxes[s] = getBox(const_cast<Pixel*> (slice.img.data()), slice.header.node.maxSize);
+        headers[s] = const_cast<Header*> (&slice.header);
+    }
+
+    picongpu::GatherSlices gather;
+    const std::vector<bool> isMaster = gather.init(isActive, bytes, Header::bytes, MPI_COMM_WORLD);
+    std::vector<PixelBox> resultBoxes = gather(selected, boxes, headers);
+
+    result.assign(numSlices, std::vector<Pixel>());
+    for (size_t s = 0; s < numSlices; ++s)
+    {
+        if (!isMaster[s])
+            continue;
+        const PMacc::DataSpace<DIM2> size = slices[s].header.sim.size;
+        result[s].resize(size.productOfComponents());
+        for (int y = 0; y < size.y(); ++y)
+            for (int x = 0; x < size.x(); ++x)
+                result[s][y * size.x() + x] = resultBoxes[s][y][x];
+    }
+    return 2;
+}
+
+/** image of a slice painted directly on the global domain */
+std::vector<Pixel> paintReference(const Domain& dom, const Slice& localSlice)
+{
+    Domain global(dom);
+    for (int d = 0; d < 3; ++d)
+    {
+        global.localCells[d] = dom.globalCells[d];
+        global.localOffset[d] = 0;
+    }
+    std::vector<Slice> slices(1, localSlice);
+    slices[0].isDrawing = true;
+    slices[0].img.assign(dom.globalCells[localSlice.tx] * dom.globalCells[localSlice.ty], Pixel());
+
+    /* the maximum of the global image is the reduced maximum of the local images */
+    std::vector<Pixel>& img = slices[0].img;
+    int cell[3];
+    cell[localSlice.sliceDim] = localSlice.sliceOffset;
+    Pixel max;
+    std::fill(max.c, max.c + 3, -FLT_MAX);
+    for (cell[localSlice.ty] = 0; cell[localSlice.ty] < dom.globalCells[localSlice.ty]; ++cell[localSlice.ty])
+        for (cell[localSlice.tx] = 0; cell[localSlice.tx] < dom.globalCells[localSlice.tx]; ++cell[localSlice.tx])
+        {
+            Pixel& p = img[cell[localSlice.ty] * dom.globalCells[localSlice.tx] + cell[localSlice.tx]];
+            p = dom.getFieldChannels(cell);
+            for (int c = 0; c < 3; ++c)
+                max.c[c] = std::max(max.c[c], p.c[c]);
+        }
+    for (size_t i = 0; i < img.size(); ++i)
+        divide(img[i], max);
+
+    const int cellsPerSuperCell = dom.getCellsPerSuperCell();
+    const Slice& slice = slices[0];
+    std::vector<float> counter(cellsPerSuperCell);
+    int sc[3];
+    sc[slice.sliceDim] = slice.sliceOffset / dom.superCellSize[slice.sliceDim];
+    for (sc[slice.ty] = 0; sc[slice.ty] < dom.globalCells[slice.ty] / dom.superCellSize[slice.ty]; ++sc[slice.ty])
+        for (sc[slice.tx] = 0; sc[slice.tx] < dom.globalCells[slice.tx] / dom.superCellSize[slice.tx]; ++sc[slice.tx])
+        {
+            std::fill(counter.begin(), counter.end(), 0.0f);
+            const std::vector<Particle> particles = dom.getParticles(sc);
+            for (size_t p = 0; p < particles.size(); ++p)
+            {
+                if (particles[p].localCellIdx < 0)
+                    continue;
+                int c[3];
+                dom.getCellInSuperCell(particles[p].localCellIdx, c);
+                if (sc[slice.sliceDim] * dom.superCellSize[slice.sliceDim] + c[slice.sliceDim] == slice.sliceOffset)
+                    counter[c[slice.ty] * dom.superCellSize[slice.tx] + c[slice.tx]] += particles[p].weighting;
+            }
+            for (int cy = 0; cy < dom.superCellSize[slice.ty]; ++cy)
+                for (int cx = 0; cx < dom.superCellSize[slice.tx]; ++cx)
+                    addDensity(img[(sc[slice.ty] * dom.superCellSize[slice.ty] + cy) * dom.globalCells[slice.tx] +
+                                   sc[slice.tx] * dom.superCellSize[slice.tx] + cx],
+                               counter[cy * dom.superCellSize[slice.tx] + cx], dom.particlesPerCell);
+        }
+    return img;
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int mpiRank;
+    int numRanks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &mpiRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+    const bool isRoot = mpiRank == 0;
+
+    Options options;
+    if (!parseCmdLine(argc, argv, options, isRoot))
+    {
+        MPI_Finalize();
+        return 1;
+    }
+
+    /* domain decomposition as the GridController, no periodic boundaries */
+    int dims[3] = {0, 0, 0};
+    MPI_Dims_create(numRanks, 3, dims);
+    int coords[3] = {mpiRank % dims[0], (mpiRank / dims[0]) % dims[1], mpiRank / (dims[0] * dims[1])};
+
+    Domain dom;
+    dom.particlesPerCell = options.particlesPerCell;
+    bool isValidDomain = true;
+    for (int d = 0; d < 3; ++d)
+    {
+        dom.globalCells[d] = options.globalCells[d];
+        dom.superCellSize[d] = options.superCellSize[d];
+        dom.localCells[d] = options.globalCells[d] / dims[d];
+        dom.localOffset[d] = coords[d] * dom.localCells[d];
+        isValidDomain = isValidDomain && dom.localCells[d] * dims[d] == dom.globalCells[d] &&
+            dom.localCells[d] % dom.superCellSize[d] == 0;
+    }
+    if (!isValidDomain)
+    {
+        if (isRoot)
+            std::cerr << "Error: the local domains (" << dims[0] << "x" << dims[1] << "x" << dims[2]
+                << " ranks) must be a multiple of the supercell" << std::endl;
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::vector<Slice> slices(options.axis.size());
+    for (size_t s = 0; s < slices.size(); ++s)
+    {
+        Slice& slice = slices[s];
+        slice.tx = options.axis[s][0] - 'x';
+        slice.ty = options.axis[s][1] - 'x';
+        slice.sliceDim = 3 - slice.tx - slice.ty;
+        slice.sliceOffset = int(float(dom.globalCells[slice.sliceDim]) * options.slicePoints[s]);
+        slice.isDrawing = dom.localOffset[slice.sliceDim] <= slice.sliceOffset &&
+            slice.sliceOffset < dom.localOffset[slice.sliceDim] + dom.localCells[slice.sliceDim];
+        slice.header.sim.size = PMacc::DataSpace<DIM2>(dom.globalCells[slice.tx], dom.globalCells[slice.ty]);
+        slice.header.node.offset = PMacc::DataSpace<DIM2>(dom.localOffset[slice.tx], dom.localOffset[slice.ty]);
+        slice.header.node.maxSize = PMacc::DataSpace<DIM2>(dom.localCells[slice.tx], dom.localCells[slice.ty]);
+        if (slice.isDrawing)
+            slice.img.resize(dom.localCells[slice.tx] * dom.localCells[slice.ty]);
+    }
+
+    if (isRoot)
+        std::cout << numRanks << " ranks (" << dims[0] << "x" << dims[1] << "x" << dims[2] << "), "
+            << dom.globalCells[0] << "x" << dom.globalCells[1] << "x" << dom.globalCells[2] << " cells, "
+            << slices.size() << " slices" << std::endl
+            << std::setw(10) << "path" << std::setw(14) << "paint [ms]" << std::setw(14) << "gather [ms]"
+            << std::setw(14) << "collectives" << std::setw(8) << "equal" << std::endl;
+
+    /* reference images of the slices, computed on demand by the masters */
+    std::vector<std::vector<Pixel> > reference(slices.size());
+
+    bool isCorrect = true;
+    const char* pathNames[] = {"separate", "batched"};
+    for (int path = 0; path < 2; ++path)
+    {
+        double paintTime = 0.0;
+        double gatherTime = 0.0;
+        int numCollectives = 0;
+        bool isEqual = true;
+        for (int r = 0; r < options.repetitions; ++r)
+        {
+            MPI_Barrier(MPI_COMM_WORLD);
+            double start = MPI_Wtime();
+            numCollectives = paint(dom, slices, path == 1);
+            MPI_Barrier(MPI_COMM_WORLD);
+            const double paintEnd = MPI_Wtime();
+
+            std::vector<std::vector<Pixel> > result;
+            numCollectives += path == 0 ? gatherSeparate(slices, result) : gatherBatched(slices, result);
+            MPI_Barrier(MPI_COMM_WORLD);
+            const double gatherEnd = MPI_Wtime();
+
+            paintTime = r == 0 ? paintEnd - start : std::min(paintTime, paintEnd - start);
+            gatherTime = r == 0 ? gatherEnd - paintEnd : std::min(gatherTime, gatherEnd - paintEnd);
+
+            for (size_t s = 0; s < slices.size(); ++s)
+            {
+                if (result[s].empty())
+                    continue;
+                if (reference[s].empty())
+                    reference[s] = paintReference(dom, slices[s]);
+                if (!(result[s] == reference[s]))
+                {
+                    std::cerr << "Error: rank " << mpiRank << " " << pathNames[path] << " slice " << s
+                        << " differs from the reference" << std::endl;
+                    isEqual = false;
+                }
+            }
+        }
+
+        int isLocalEqual = isEqual ? 1 : 0;
+        int isGlobalEqual = 0;
+        MPI_Allreduce(&isLocalEqual, &isGlobalEqual, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+        isCorrect = isCorrect && isGlobalEqual == 1;
+
+        if (isRoot)
+            std::cout << std::fixed << std::setprecision(3)
+                << std::setw(10) << pathNames[path]
+                << std::setw(14) << paintTime * 1.0e3
+                << std::setw(14) << gatherTime * 1.0e3
+                << std::setw(14) << numCollectives
+                << std::setw(8) << (isGlobalEqual == 1 ? "yes" : "no") << std::endl;
+    }
+
+    /* each slice must have been compared on at least one master */
+    std::vector<int> numChecked(slices.size(), 0);
+    std::vector<int> localChecked(slices.size(), 0);
+    for (size_t s = 0; s < slices.size(); ++s)
+        localChecked[s] = reference[s].empty() ? 0 : 1;
+    MPI_Allreduce(&localChecked[0], &numChecked[0], slices.size(), MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    for (size_t s = 0; s < slices.size(); ++s)
+        isCorrect = isCorrect && numChecked[s] >= 1;
+
+    MPI_Finalize();
+    return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "communication/RankPlacement.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    int dims[3];
+    int periodic[3];
+    int numDims;
+    int numNodes;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        std::vector<int> devices, periodic;
+        options.numNodes = 1;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " -d dx dy [dz] -n nodes [options]" << std::endl
+            << "Evaluates the placement of the devices of a PIConGPU run (without MPI)." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("devices,d", po::value<std::vector<int> > (&devices)->multitoken(), "number of devices in each dimension (as for PIConGPU)")
+                ("nodes,n", po::value<int > (&options.numNodes)->default_value(options.numNodes), "number of nodes (hosts)")
+                ("periodic", po::value<std::vector<int> > (&periodic)->multitoken(),
+                "periodic (1) or not (0) in each dimension, default: no periodic dimensions")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (devices.size() < 2 || devices.size() > 3)
+        {
+            std::cerr << "Error: Please specify 2D or 3D devices." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+
+        options.numDims = devices.size();
+        for (int d = 0; d < 3; ++d)
+        {
+            options.dims[d] = d < options.numDims ? devices[d] : 1;
+            options.periodic[d] = d < (int) periodic.size() ? periodic[d] : 0;
+        }
+
+        const int numRanks = options.dims[0] * options.dims[1] * options.dims[2];
+        if (options.numNodes < 1 || numRanks % options.numNodes != 0)
+        {
+            std::cerr << "Error: The number of devices (" << numRanks << ") must be a multiple of the number of nodes." << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/** check the global rank of the topology aware placement
+ *
+ * Simulates CommunicatorMPI::init: the ranks are split with the cartesian
+ * rank as key (MPI_Comm_split orders by key, then by the old rank) and
+ * MPI_Cart_create does not reorder. The global rank (GridController::getGlobalRank)
+ * must be the rank in this communicator, which is the cartesian rank.
+ *
+ * A collective indexed by the global rank (e.g. the particle offsets of the
+ * ADIOS restart, MPI_Allgather over the grid communicator) must give each rank
+ * the offset of its grid position in the file.
+ *
+ * @param[out] numWorldMismatches ranks which would get a wrong offset with the rank in MPI_COMM_WORLD
+ * @return true if the mapping is correct
+ */
+bool checkRankMapping(const PMacc::RankPlacement& placement, int numNodes, int ranksPerNode,
+                      int& numWorldMismatches)
+{
+    const int numRanks = numNodes * ranksPerNode;
+    numWorldMismatches = 0;
+
+    /* world rank (block launcher) -> split key */
+    std::vector<int> key(numRanks);
+    std::vector<int> numKeyUsed(numRanks, 0);
+    for (int node = 0; node < numNodes; ++node)
+        for (int local = 0; local < ranksPerNode; ++local)
+        {
+            const int worldRank = node * ranksPerNode + local;
+            key[worldRank] = placement.getCartRank(node, local);
+            if (key[worldRank] < 0 || key[worldRank] >= numRanks)
+                return false;
+            ++numKeyUsed[key[worldRank]];
+        }
+    for (int cartRank = 0; cartRank < numRanks; ++cartRank)
+        if (numKeyUsed[cartRank] != 1)
+            return false;
+
+    /* MPI_Comm_split: rank in the new communicator is the position in (key, world rank) order */
+    std::vector<int> globalRank(numRanks, 0);
+    for (int worldRank = 0; worldRank < numRanks; ++worldRank)
+        for (int other = 0; other < numRanks; ++other)
+            if (key[other] < key[worldRank] || (key[other] == key[worldRank] && other < worldRank))
+                ++globalRank[worldRank];
+
+    /* the particles of a grid position, the restart file holds them in cartesian order */
+    std::vector<int> numParticles(numRanks);
+    std::vector<int> fileOffset(numRanks, 0);
+    for (int cartRank = 0; cartRank < numRanks; ++cartRank)
+    {
+        numParticles[cartRank] = 1 + (cartRank * 7) % 5;
+        if (cartRank > 0)
+            fileOffset[cartRank] = fileOffset[cartRank - 1] + numParticles[cartRank - 1];
+    }
+
+    /* MPI_Allgather over the grid communicator: element i is from the rank with global rank i */
+    std::vector<int> gathered(numRanks);
+    for (int worldRank = 0; worldRank < numRanks; ++worldRank)
+        gathered[globalRank[worldRank]] = numParticles[key[worldRank]];
+
+    bool isCorrect = true;
+    for (int worldRank = 0; worldRank < numRanks; ++worldRank)
+    {
+        const int cartRank = key[worldRank];
+        int offset = 0;
+        int worldOffset = 0;
+        for (int i = 0; i < numRanks; ++i)
+        {
+            if (i < globalRank[worldRank])
+                offset += gathered[i];
+            if (i < worldRank)
+                worldOffset += gathered[i];
+        }
+        if (globalRank[worldRank] != cartRank || offset != fileOffset[cartRank])
+            isCorrect = false;
+        if (worldOffset != fileOffset[cartRank])
+            ++numWorldMismatches;
+    }
+    return isCorrect;
+}
+
+void printFraction(const std::string& name, double fraction)
+{
+    std::cout << std::setw(32) << std::left << name << std::right
+        << std::fixed << std::setprecision(1) << std::setw(6) << 100.0 * fraction
+        << "% of the neighbor exchanges within a node" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    const int numRanks = options.dims[0] * options.dims[1] * options.dims[2];
+    const int ranksPerNode = numRanks / options.numNodes;
+
+    std::cout << numRanks << " devices on " << options.numNodes << " nodes, "
+        << ranksPerNode << " per node" << std::endl;
+
+    /* MPI_Cart_create without reorder: the cartesian rank is the launcher rank */
+    std::vector<int> nodes(numRanks);
+    for (int rank = 0; rank < numRanks; ++rank)
+        nodes[rank] = rank / ranksPerNode;
+    printFraction("rank order (block launcher)",
+                  PMacc::RankPlacement::getOnNodeFraction(options.dims, options.periodic, options.numDims, nodes));
+
+    for (int rank = 0; rank < numRanks; ++rank)
+        nodes[rank] = rank % options.numNodes;
+    printFraction("rank order (cyclic launcher)",
+                  PMacc::RankPlacement::getOnNodeFraction(options.dims, options.periodic, options.numDims, nodes));
+
+    PMacc::RankPlacement placement(options.dims, options.periodic, options.numDims, ranksPerNode);
+    if (!placement.isValid())
+    {
+        std::cout << "topology aware placement is not possible: " << ranksPerNode
+            << " devices per node are no block of the device grid" << std::endl;
+        return 0;
+    }
+
+    std::stringstream name;
+    name << "topology aware (block " << placement.getBlock(0) << "x" << placement.getBlock(1);
+    if (options.numDims == 3)
+        name << "x" << placement.getBlock(2);
+    name << ")";
+    printFraction(name.str(), placement.getOnNodeFraction());
+
+    int numWorldMismatches = 0;
+    const bool isCorrect = checkRankMapping(placement, options.numNodes, ranksPerNode, numWorldMismatches);
+    std::cout << "global rank is the cartesian rank: " << (isCorrect ? "yes" : "no")
+        << " (" << numWorldMismatches << " of " << numRanks
+        << " ranks would read wrong restart offsets with the MPI_COMM_WORLD rank)" << std::endl;
+
+    return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#
+# Copyright 2017 agent
+#
+# This file is part of PIConGPU.
+#
+# PIConGPU is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# PIConGPU is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with PIConGPU.
+# If not, see <http://www.gnu.org/licenses/>.
+#
+
+################################################################################
+# Common setup of the host only tools (benchmarks and tests) in src/tools
+#
+# These tools use the host only headers of libPMacc and must not depend on
+# CUDA. Usage in the CMakeLists.txt of a tool:
+#
+#   cmake_minimum_required(VERSION 3.1.0)
+#   project(<name>)
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../share/cmake/HostTool.cmake)
+#   pmacc_host_tool(<name> [BENCHMARK] [OPENMP] [MPI] [CUDA_STUB] [TEST]
+#                   [TEST_ARGS <arguments>...] [TEST_NP <ranks>])
+#
+# BENCHMARK  build type Release if no build type is set
+# OPENMP     compile with OpenMP if it is available
+# MPI        link MPI
+# CUDA_STUB  use the host stand-in of the CUDA runtime (share/cuda_stub) for
+#            libPMacc headers which include pmacc_types.hpp, the MPI headers
+#            are added because math::Vector includes the MPI types
+# TEST       add the tool to ctest, the tool returns a non zero exit code
+#            if a check fails
+# TEST_ARGS  arguments of the tool in the test
+# TEST_NP    number of MPI ranks of the test (MPI tools only), additional
+#            flags are taken from MPIEXEC_PREFLAGS
+#            (e.g. "--oversubscribe" for Open MPI on small machines)
+################################################################################
+
+include(CMakeParseArguments)
+
+# libPMacc (host only headers)
+set(PMACC_HOST_TOOL_INCLUDE_DIR ${CMAKE_CURRENT_LIST_DIR}/../../../libPMacc/include)
+# host stand-in of the CUDA runtime
+set(PMACC_HOST_TOOL_CUDA_STUB_DIR ${CMAKE_CURRENT_LIST_DIR}/../cuda_stub)
+
+macro(pmacc_host_tool TOOL_NAME)
+    cmake_parse_arguments(HOST_TOOL "BENCHMARK;OPENMP;MPI;CUDA_STUB;TEST" "TEST_NP" "TEST_ARGS" ${ARGN})
+
+    # set helper pathes to find libraries and packages
+    # Add specific hints
+    list(APPEND CMAKE_PREFIX_PATH "$ENV{BOOST_ROOT}")
+    # Add from environment after specific env vars
+    list(APPEND CMAKE_PREFIX_PATH "$ENV{CMAKE_PREFIX_PATH}")
+
+    # install prefix
+    if(CMAKE_INSTALL_PREFIX_INITIALIZED_TO_DEFAULT)
+        set(CMAKE_INSTALL_PREFIX "${PROJECT_BINARY_DIR}" CACHE PATH "install prefix" FORCE)
+    endif(CMAKE_INSTALL_PREFIX_INITIALIZED_TO_DEFAULT)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wall")
+
+    if(HOST_TOOL_BENCHMARK AND NOT CMAKE_BUILD_TYPE)
+        set(CMAKE_BUILD_TYPE Release CACHE STRING "build type" FORCE)
+    endif()
+
+    # enforce C++11
+    set(CMAKE_CXX_STANDARD_REQUIRED ON)
+    set(CMAKE_CXX_EXTENSIONS OFF)
+    set(CMAKE_CXX_STANDARD 11)
+
+    find_package(Boost 1.57.0 REQUIRED COMPONENTS program_options)
+    if(TARGET Boost::program_options)
+        set(HOST_TOOL_LIBS Boost::boost Boost::program_options)
+    else()
+        include_directories(SYSTEM ${Boost_INCLUDE_DIRS})
+        set(HOST_TOOL_LIBS ${Boost_LIBRARIES})
+    endif()
+
+    if(HOST_TOOL_OPENMP)
+        find_package(OpenMP)
+        if(OPENMP_FOUND)
+            set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${OpenMP_CXX_FLAGS}")
+        endif()
+    endif()
+
+    if(HOST_TOOL_MPI OR HOST_TOOL_CUDA_STUB)
+        find_package(MPI REQUIRED)
+        include_directories(SYSTEM ${MPI_CXX_INCLUDE_PATH})
+        set(HOST_TOOL_LIBS ${HOST_TOOL_LIBS} ${MPI_CXX_LIBRARIES})
+    endif()
+
+    if(HOST_TOOL_CUDA_STUB)
+        include_directories(BEFORE ${PMACC_HOST_TOOL_CUDA_STUB_DIR})
+    endif()
+
+    include_directories(${PMACC_HOST_TOOL_INCLUDE_DIR})
+
+    file(GLOB HOST_TOOL_SRCFILES "${CMAKE_CURRENT_SOURCE_DIR}/*.cpp")
+    add_executable(${TOOL_NAME} ${HOST_TOOL_SRCFILES})
+    target_link_libraries(${TOOL_NAME} ${HOST_TOOL_LIBS})
+
+    install(TARGETS ${TOOL_NAME} RUNTIME DESTINATION .)
+
+    if(HOST_TOOL_TEST)
+        enable_testing()
+        if(HOST_TOOL_MPI)
+            if(NOT HOST_TOOL_TEST_NP)
+                set(HOST_TOOL_TEST_NP 2)
+            endif()
+            if(MPIEXEC_EXECUTABLE)
+                set(HOST_TOOL_MPIEXEC ${MPIEXEC_EXECUTABLE})
+            else()
+                set(HOST_TOOL_MPIEXEC ${MPIEXEC})
+            endif()
+            add_test(NAME ${TOOL_NAME}
+                     COMMAND ${HOST_TOOL_MPIEXEC} ${MPIEXEC_NUMPROC_FLAG} ${HOST_TOOL_TEST_NP}
+                             ${MPIEXEC_PREFLAGS} $<TARGET_FILE:${TOOL_NAME}> ${MPIEXEC_POSTFLAGS}
+                             ${HOST_TOOL_TEST_ARGS})
+        else()
+            add_test(NAME ${TOOL_NAME} COMMAND ${TOOL_NAME} ${HOST_TOOL_TEST_ARGS})
+        endif()
+    endif()
+endmacro()
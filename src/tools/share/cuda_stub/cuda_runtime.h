@@ -0,0 +1,62 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+/* host only stand-in of the CUDA runtime for the host only tools
+ *
+ * provides only what the libPMacc headers used by the tools (types,
+ * PMACC_KERNEL) need on the host, nothing is executed on a device
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#define __host__
+#define __device__
+#define __forceinline__ inline
+#define __location__(x)
+#define __align__(n) __attribute__((aligned(n)))
+
+struct CUstream_st;
+typedef CUstream_st* cudaStream_t;
+
+enum cudaError_t
+{
+    cudaSuccess = 0
+};
+
+inline const char* cudaGetErrorString(cudaError_t)
+{
+    return "no error";
+}
+
+struct uint3
+{
+    unsigned int x, y, z;
+};
+
+struct dim3
+{
+    unsigned int x, y, z;
+
+    dim3(unsigned int vx = 1, unsigned int vy = 1, unsigned int vz = 1) : x(vx), y(vy), z(vz)
+    {
+    }
+};
@@ -0,0 +1,388 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "communication/CommunicatorMPI.hpp"
+#include "memory/dataTypes/Mask.hpp"
+#include "dimensions/DataSpace.hpp"
+
+#include <mpi.h>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    std::vector<int> localCells;
+    std::vector<int> guardSizes;
+    int numFields;
+    int repetitions;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options, const bool isRoot)
+{
+    try
+    {
+        options.numFields = 3;
+        options.repetitions = 20;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Exchanges the guards of several fields with all 26 neighbors of a periodic 3D domain" << std::endl
+            << "decomposition (PMacc::CommunicatorMPI) with the persistent requests of GridBuffer::addExchange," << std::endl
+            << "once via MPI and once with the shared memory transport (enableSharedMemoryTransport, as" << std::endl
+            << "--mpiSharedMemory). The requests are started and polled as TaskSendMPI/TaskReceiveMPI do." << std::endl
+            << "Checks the received guards of both paths and compares them with each other. Run it on one node" << std::endl
+            << "(e.g. mpirun -np 8) to use the shared memory windows for all neighbors." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("domain,d", po::value<std::vector<int> > (&options.localCells)->multitoken(), "cells per rank (default: 64 64 64)")
+                ("guard,g", po::value<std::vector<int> > (&options.guardSizes)->multitoken(), "guard sizes in cells (default: 1 2 4)")
+                ("fields,f", po::value<int > (&options.numFields)->default_value(options.numFields), "number of fields with 3 float components")
+                ("repetitions,r", po::value<int > (&options.repetitions)->default_value(options.repetitions), "number of exchange rounds")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            if (isRoot)
+                std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.localCells.empty())
+            options.localCells.assign(3, 64);
+        if (options.guardSizes.empty())
+        {
+            const int guardSizes[] = {1, 2, 4};
+            options.guardSizes.assign(guardSizes, guardSizes + 3);
+        }
+
+        bool isValid = options.localCells.size() == 3 && options.numFields > 0 && options.numFields < 256 &&
+            options.repetitions > 0;
+        for (size_t i = 0; i < options.guardSizes.size() && isValid; ++i)
+            isValid = options.guardSizes[i] > 0;
+        for (size_t d = 0; d < options.localCells.size() && isValid; ++d)
+            isValid = options.localCells[d] > 0;
+        if (!isValid)
+        {
+            if (isRoot)
+            {
+                std::cerr << "Error: invalid options." << std::endl;
+                std::cerr << std::endl << desc << std::endl;
+            }
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        if (isRoot)
+            std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/** number of exchange directions in 3D (without the direction 0) */
+const int numExchanges = 27;
+
+/** exchange tag as in the Exchange/TaskSendMPI: (communicationTag << 5) | direction */
+uint32_t getExchangeTag(int communicationTag, int direction)
+{
+    return (uint32_t(communicationTag) << 5) | uint32_t(direction);
+}
+
+/** deterministic content of a byte of a send buffer */
+char getByte(int srcRank, int direction, uint32_t tag, int round, size_t i)
+{
+    uint32_t h = uint32_t(srcRank) * 2654435761u ^ uint32_t(direction) * 40503u ^ tag * 97u ^ uint32_t(round) * 7919u;
+    h ^= uint32_t(i) * 2246822519u;
+    h ^= h >> 13;
+    return char(h & 0xff);
+}
+
+/** guard buffers of one rank, one send and one receive buffer per direction and field
+ *
+ * recv[dir] holds the data which is sent into direction dir, it is
+ * received from the neighbor in the mirrored direction
+ */
+struct Exchange
+{
+    std::vector<std::vector<std::vector<char> > > send;
+    std::vector<std::vector<std::vector<char> > > recv;
+    /* persistent request ids of the communicator */
+    std::vector<std::vector<uint32_t> > sendIds;
+    std::vector<std::vector<uint32_t> > recvIds;
+    int neighbor[numExchanges];
+};
+
+/** allocate the buffers and register them as GridBuffer::addExchange does
+ *
+ * collective over all ranks, the shared memory mailboxes are created in the
+ * same order on all ranks of a node
+ */
+void initExchange(Exchange& ex, PMacc::CommunicatorMPI<DIM3>& comm, const Options& options, const int guard)
+{
+    MPI_Comm cartComm = comm.getMPIComm();
+    int rank;
+    MPI_Comm_rank(cartComm, &rank);
+    int coords[3];
+    MPI_Cart_coords(cartComm, rank, 3, coords);
+
+    ex.send.assign(numExchanges, std::vector<std::vector<char> >());
+    ex.recv.assign(numExchanges, std::vector<std::vector<char> >());
+    ex.sendIds.assign(numExchanges, std::vector<uint32_t>());
+    ex.recvIds.assign(numExchanges, std::vector<uint32_t>());
+
+    for (int dir = 1; dir < numExchanges; ++dir)
+    {
+        const PMacc::DataSpace<DIM3> rel = PMacc::Mask::getRelativeDirections<DIM3>(dir);
+        int neighborCoords[3];
+        size_t guardCells = 1;
+        for (int d = 0; d < 3; ++d)
+        {
+            neighborCoords[d] = coords[d] + rel[d];
+            guardCells *= rel[d] == 0 ? options.localCells[d] : guard;
+        }
+        MPI_Cart_rank(cartComm, neighborCoords, &ex.neighbor[dir]);
+
+        const size_t bytes = guardCells * 3 * sizeof(float);
+        ex.send[dir].assign(options.numFields, std::vector<char>(bytes));
+        ex.recv[dir].assign(options.numFields, std::vector<char>(bytes));
+    }
+
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (int f = 0; f < options.numFields; ++f)
+        {
+            const uint32_t tag = getExchangeTag(1 + f, dir);
+            std::vector<char>& recvBuffer = ex.recv[dir][f];
+            ex.recvIds[dir].push_back(comm.createPersistentReceive(PMacc::Mask::getMirroredExchangeType(dir),
+                                                                   recvBuffer.data(), recvBuffer.size(), tag));
+            const std::vector<char>& sendBuffer = ex.send[dir][f];
+            ex.sendIds[dir].push_back(comm.createPersistentSend(dir, sendBuffer.data(), sendBuffer.size(), tag));
+        }
+}
+
+void freeExchange(Exchange& ex, PMacc::CommunicatorMPI<DIM3>& comm)
+{
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t f = 0; f < ex.sendIds[dir].size(); ++f)
+        {
+            comm.freePersistent(ex.recvIds[dir][f]);
+            comm.freePersistent(ex.sendIds[dir][f]);
+        }
+}
+
+/** fill the send buffers of a round (as the device to host copy) */
+void fillSendBuffers(Exchange& ex, const int rank, const int round)
+{
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t f = 0; f < ex.send[dir].size(); ++f)
+        {
+            std::vector<char>& buffer = ex.send[dir][f];
+            const uint32_t tag = getExchangeTag(1 + f, dir);
+            for (size_t i = 0; i < buffer.size(); ++i)
+                buffer[i] = getByte(rank, dir, tag, round, i);
+        }
+}
+
+/** check the received buffers of a round */
+bool checkReceiveBuffers(const Exchange& ex, const int round)
+{
+    bool isEqual = true;
+    for (int dir = 1; dir < numExchanges; ++dir)
+    {
+        const int srcRank = ex.neighbor[PMacc::Mask::getMirroredExchangeType(dir)];
+        for (size_t f = 0; f < ex.recv[dir].size(); ++f)
+        {
+            const std::vector<char>& buffer = ex.recv[dir][f];
+            const uint32_t tag = getExchangeTag(1 + f, dir);
+            for (size_t i = 0; i < buffer.size() && isEqual; ++i)
+                isEqual = buffer[i] == getByte(srcRank, dir, tag, round, i);
+        }
+    }
+    return isEqual;
+}
+
+/** one request as started by TaskSendMPI/TaskReceiveMPI::init */
+struct Request
+{
+    MPI_Request* request;
+    bool isPersistent;
+};
+
+Request startRequest(PMacc::CommunicatorMPI<DIM3>& comm, bool isSend, uint32_t id, uint32_t ex,
+                     std::vector<char>& buffer, uint32_t tag)
+{
+    Request r;
+    r.request = comm.startPersistent(id, buffer.size());
+    r.isPersistent = r.request != nullptr;
+    if (!r.isPersistent)
+        r.request = isSend ? comm.startSend(ex, buffer.data(), buffer.size(), tag) :
+        comm.startReceive(ex, buffer.data(), buffer.size(), tag);
+    return r;
+}
+
+/** exchange all guards, the requests are polled as by TaskSendMPI/TaskReceiveMPI::executeIntern */
+void exchange(Exchange& ex, PMacc::CommunicatorMPI<DIM3>& comm)
+{
+    std::vector<Request> requests;
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t f = 0; f < ex.recv[dir].size(); ++f)
+            requests.push_back(startRequest(comm, false, ex.recvIds[dir][f], PMacc::Mask::getMirroredExchangeType(dir),
+                                            ex.recv[dir][f], getExchangeTag(1 + f, dir)));
+    for (int dir = 1; dir < numExchanges; ++dir)
+        for (size_t f = 0; f < ex.send[dir].size(); ++f)
+            requests.push_back(startRequest(comm, true, ex.sendIds[dir][f], dir,
+                                            ex.send[dir][f], getExchangeTag(1 + f, dir)));
+
+    size_t numOpen = requests.size();
+    while (numOpen != 0)
+    {
+        for (size_t r = 0; r < requests.size(); ++r)
+        {
+            if (requests[r].request == nullptr)
+                continue;
+            comm.progress();
+            int flag = 0;
+            MPI_Status status;
+            MPI_Test(requests[r].request, &flag, &status);
+            if (!flag)
+                continue;
+            --numOpen;
+            if (!requests[r].isPersistent)
+                delete requests[r].request;
+            requests[r].request = nullptr;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    int worldRank;
+    int numRanks;
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+    const bool isRoot = worldRank == 0;
+
+    Options options;
+    if (!parseCmdLine(argc, argv, options, isRoot))
+    {
+        MPI_Finalize();
+        return 1;
+    }
+
+    int dims[3] = {0, 0, 0};
+    MPI_Dims_create(numRanks, 3, dims);
+
+    if (isRoot)
+        std::cout << numRanks << " ranks (" << dims[0] << "x" << dims[1] << "x" << dims[2] << ", periodic), "
+            << options.localCells[0] << "x" << options.localCells[1] << "x" << options.localCells[2] << " cells per rank, "
+            << options.numFields << " fields" << std::endl
+            << "times are the mean over the rounds (maximum over the ranks), equal: received guards are correct,"
+            << " same: identical to the MPI path" << std::endl
+            << std::setw(6) << "guard" << std::setw(10) << "path" << std::setw(12) << "node ranks"
+            << std::setw(12) << "KiB" << std::setw(14) << "round [us]" << std::setw(8) << "equal"
+            << std::setw(8) << "same" << std::endl;
+
+    const char* pathNames[] = {"mpi", "shared"};
+    bool isCorrect = true;
+
+    for (size_t g = 0; g < options.guardSizes.size(); ++g)
+    {
+        /* received guards of the last round of the MPI path */
+        std::vector<std::vector<std::vector<char> > > mpiGuards;
+
+        for (int path = 0; path < 2; ++path)
+        {
+            PMacc::CommunicatorMPI<DIM3> comm;
+            comm.init(PMacc::DataSpace<DIM3>(dims[0], dims[1], dims[2]), PMacc::DataSpace<DIM3>(1, 1, 1));
+            /* must be enabled before the exchanges are added */
+            if (path == 1)
+                comm.enableSharedMemoryTransport();
+            MPI_Comm cartComm = comm.getMPIComm();
+            const int rank = comm.getRank();
+
+            Exchange ex;
+            initExchange(ex, comm, options, options.guardSizes[g]);
+
+            size_t numBytes = 0;
+            for (int dir = 1; dir < numExchanges; ++dir)
+                for (size_t f = 0; f < ex.send[dir].size(); ++f)
+                    numBytes += ex.send[dir][f].size();
+
+            double roundTime = 0.0;
+            bool isEqual = true;
+            /* the first round is not measured (warm up of the connections) */
+            for (int round = 0; round <= options.repetitions; ++round)
+            {
+                fillSendBuffers(ex, rank, round);
+                MPI_Barrier(cartComm);
+                const double start = MPI_Wtime();
+                exchange(ex, comm);
+                const double end = MPI_Wtime();
+                if (round != 0)
+                    roundTime += end - start;
+                isEqual = checkReceiveBuffers(ex, round) && isEqual;
+            }
+
+            /* both paths use the same cartesian rank order, the guards must be identical */
+            bool isSame = true;
+            if (path == 0)
+                mpiGuards = ex.recv;
+            else
+                isSame = mpiGuards == ex.recv;
+
+            double time = roundTime / options.repetitions;
+            double maxTime;
+            MPI_Reduce(&time, &maxTime, 1, MPI_DOUBLE, MPI_MAX, 0, cartComm);
+            int isLocalValid[2] = {isEqual ? 1 : 0, isSame ? 1 : 0};
+            int isGlobalValid[2] = {0, 0};
+            MPI_Allreduce(isLocalValid, isGlobalValid, 2, MPI_INT, MPI_MIN, cartComm);
+            isCorrect = isCorrect && isGlobalValid[0] == 1 && isGlobalValid[1] == 1;
+
+            if (isRoot)
+                std::cout << std::fixed << std::setprecision(1)
+                    << std::setw(6) << options.guardSizes[g]
+                    << std::setw(10) << pathNames[path]
+                    << std::setw(12) << comm.getNumSharedMemoryRanks()
+                    << std::setw(12) << double(numBytes) / 1024.0
+                    << std::setw(14) << maxTime * 1.0e6
+                    << std::setw(8) << (isGlobalValid[0] == 1 ? "yes" : "no")
+                    << std::setw(8) << (isGlobalValid[1] == 1 ? "yes" : "no") << std::endl;
+
+            freeExchange(ex, comm);
+        }
+    }
+
+    MPI_Finalize();
+    return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,407 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simulationControl/SlideInitSchedule.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    int numGpus;
+    int numRows;
+    int rowCells;
+    int lead;
+    int numSlides;
+    int movePeriod;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.numGpus = 3;
+        options.numRows = 8;
+        options.rowCells = 8;
+        options.lead = 2;
+        options.numSlides = 3;
+        options.movePeriod = 2;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Compares the amortized species initialization after a slide of the moving window" << std::endl
+            << "(--amortizedSlide, row by row of supercells) with the initialization of the whole slab" << std::endl
+            << "on a deterministic one dimensional model of the GPUs in y direction." << std::endl
+            << "The window moves one cell per step, the particles one cell per movePeriod steps." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("gpus,g", po::value<int > (&options.numGpus)->default_value(options.numGpus), "number of GPUs in y direction")
+                ("rows", po::value<int > (&options.numRows)->default_value(options.numRows), "supercell rows per GPU")
+                ("rowCells", po::value<int > (&options.rowCells)->default_value(options.rowCells), "cells per supercell row")
+                ("lead,l", po::value<int > (&options.lead)->default_value(options.lead), "rows initialized ahead of the window (--amortizedSlideLead)")
+                ("slides,s", po::value<int > (&options.numSlides)->default_value(options.numSlides), "number of slides")
+                ("movePeriod,p", po::value<int > (&options.movePeriod)->default_value(options.movePeriod), "steps per cell of a moving particle (>= 1, the speed of light is 1)")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.numGpus < 2 || options.numRows < 1 || options.rowCells < 1 || options.lead < 0 ||
+            options.numSlides < 1 || options.movePeriod < 1)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+struct Particle
+{
+    int64_t cell;
+    int velocity;
+};
+
+/** plasma of a test case: particles per cell and their velocities (-1, 0, +1) */
+struct Plasma
+{
+    std::string name;
+    /* particles per cell depend on the global cell */
+    bool isProfile;
+    /* velocities of the particles of a cell, one particle per entry */
+    std::vector<int> velocities;
+
+    int getNumParticles(int64_t cell) const
+    {
+        const int numVelocities = velocities.size();
+        return isProfile ? 1 + (cell * 5 / 3) % 3 : numVelocities;
+    }
+
+    int getVelocity(int i) const
+    {
+        return velocities[i % velocities.size()];
+    }
+
+    /** particles with a velocity which the initialization creates in a cell */
+    int getNumParticles(int64_t cell, int velocity) const
+    {
+        const int numParticles = getNumParticles(cell);
+        int result = 0;
+        for (int i = 0; i < numParticles; ++i)
+            if (getVelocity(i) == velocity)
+                ++result;
+        return result;
+    }
+};
+
+/** one dimensional model of the GPUs in y direction and of MySimulation::movingWindowCheck */
+class Simulation
+{
+public:
+
+    enum Mode
+    {
+        SLAB,
+        AMORTIZED,
+        /* amortized without deleting particles in the new rows (old behaviour) */
+        AMORTIZED_KEEP
+    };
+
+    Simulation(const Options& options, const Plasma& plasma, Mode mode) :
+        options(options), plasma(plasma), mode(mode),
+        gpuCells(options.numRows * options.rowCells),
+        slideInit(options.lead, options.rowCells, options.numRows),
+        firstCell(0), numSlides(0),
+        maxInitCells(0), numInitCells(0)
+    {
+        initCells(firstCell, firstCell + options.numGpus * gpuCells);
+    }
+
+    /** one time step: moving window check and particle push */
+    void step(int currentStep)
+    {
+        numInitCells = 0;
+        /* as MySimulation::movingWindowCheck */
+        if (currentStep / gpuCells > numSlides)
+        {
+            slideInit.finish(InitSpeciesRows(*this));
+            slide();
+        }
+        else
+            slideInit.advance(getWindowOffset(currentStep), InitSpeciesRows(*this));
+        maxInitCells = std::max(maxInitCells, numInitCells);
+
+        if (currentStep % options.movePeriod == 0)
+        {
+            const int64_t endCell = firstCell + options.numGpus * gpuCells;
+            std::vector<Particle> moved;
+            moved.reserve(particles.size());
+            for (size_t i = 0; i < particles.size(); ++i)
+            {
+                Particle p = particles[i];
+                p.cell += p.velocity;
+                /* absorbing boundaries of the simulation box */
+                if (p.cell >= firstCell && p.cell < endCell)
+                    moved.push_back(p);
+            }
+            particles.swap(moved);
+        }
+    }
+
+    /** first global cell of the moving window */
+    int64_t getWindowBegin(int currentStep) const
+    {
+        return firstCell + getWindowOffset(currentStep);
+    }
+
+    /** particles per cell and velocity inside the moving window
+     *
+     * @return 3 entries (velocity -1, 0, +1) per cell
+     */
+    std::vector<int> getWindowCounts(int currentStep) const
+    {
+        const int64_t windowBegin = getWindowBegin(currentStep);
+        const int64_t windowCells = (options.numGpus - 1) * gpuCells;
+        std::vector<int> counts(3 * windowCells, 0);
+        for (size_t i = 0; i < particles.size(); ++i)
+        {
+            const int64_t c = particles[i].cell - windowBegin;
+            if (c >= 0 && c < windowCells)
+                ++counts[3 * c + particles[i].velocity + 1];
+        }
+        return counts;
+    }
+
+    /** maximum number of cells initialized in one step after the first step */
+    int64_t getMaxInitCells() const
+    {
+        return maxInitCells;
+    }
+
+private:
+
+    /** cells of the window offset inside the top GPU */
+    int getWindowOffset(int currentStep) const
+    {
+        return currentStep - numSlides * gpuCells;
+    }
+
+    /** functor for PMacc::SlideInitSchedule */
+    struct InitSpeciesRows
+    {
+        Simulation& simulation;
+
+        InitSpeciesRows(Simulation& simulation) : simulation(simulation)
+        {
+        }
+
+        void operator()(uint32_t beginRow, uint32_t endRow) const
+        {
+            simulation.initSpeciesRows(beginRow, endRow);
+        }
+    };
+
+    void slide()
+    {
+        ++numSlides;
+        firstCell += gpuCells;
+        const int64_t bottomGpu = firstCell + (options.numGpus - 1) * gpuCells;
+
+        /* the communicator rotation: the new bottom GPU starts empty */
+        std::vector<Particle> kept;
+        for (size_t i = 0; i < particles.size(); ++i)
+            if (particles[i].cell >= firstCell && particles[i].cell < bottomGpu)
+                kept.push_back(particles[i]);
+        particles.swap(kept);
+
+        if (mode == SLAB)
+            initCells(bottomGpu, bottomGpu + gpuCells);
+        else
+            slideInit.start(getWindowOffset(numSlides * gpuCells), InitSpeciesRows(*this));
+    }
+
+    /* MySimulation::initSpeciesRows: delete the particles of the rows, InitPipeline */
+    void initSpeciesRows(uint32_t beginRow, uint32_t endRow)
+    {
+        const int64_t bottomGpu = firstCell + (options.numGpus - 1) * gpuCells;
+        const int64_t beginCell = bottomGpu + beginRow * options.rowCells;
+        const int64_t endCell = bottomGpu + endRow * options.rowCells;
+
+        if (mode == AMORTIZED)
+        {
+            std::vector<Particle> kept;
+            for (size_t i = 0; i < particles.size(); ++i)
+                if (particles[i].cell < beginCell || particles[i].cell >= endCell)
+                    kept.push_back(particles[i]);
+            particles.swap(kept);
+        }
+        initCells(beginCell, endCell);
+    }
+
+    /* InitPipeline for the cells [beginCell, endCell) */
+    void initCells(int64_t beginCell, int64_t endCell)
+    {
+        for (int64_t cell = beginCell; cell < endCell; ++cell)
+        {
+            const int numParticles = plasma.getNumParticles(cell);
+            for (int i = 0; i < numParticles; ++i)
+            {
+                Particle p = {cell, plasma.getVelocity(i)};
+                particles.push_back(p);
+            }
+        }
+        numInitCells += endCell - beginCell;
+    }
+
+    const Options options;
+    const Plasma plasma;
+    const Mode mode;
+    const int gpuCells;
+
+    /* shipped row schedule of MySimulation */
+    PMacc::SlideInitSchedule slideInit;
+    std::vector<Particle> particles;
+    int64_t firstCell;
+    int numSlides;
+
+    int64_t maxInitCells;
+    int64_t numInitCells;
+};
+
+/** result of a comparison with the slab initialization */
+struct Comparison
+{
+    /* window cells with a different number of particles (summed over all steps) */
+    int64_t numDifferent;
+    /* window cells with more particles of a velocity than the initialization
+     * creates (particles created on top of moved in particles)
+     */
+    int64_t numMore;
+    int64_t maxInitCells;
+};
+
+Comparison compare(const Options& options, const Plasma& plasma, Simulation::Mode mode, int64_t& slabInitCells)
+{
+    Simulation slab(options, plasma, Simulation::SLAB);
+    Simulation amortized(options, plasma, mode);
+
+    Comparison result = {0, 0, 0};
+    const int numSteps = (options.numSlides + 1) * options.numRows * options.rowCells;
+    for (int currentStep = 0; currentStep < numSteps; ++currentStep)
+    {
+        slab.step(currentStep);
+        amortized.step(currentStep);
+
+        const std::vector<int> slabCounts = slab.getWindowCounts(currentStep);
+        const std::vector<int> counts = amortized.getWindowCounts(currentStep);
+        const int64_t windowBegin = amortized.getWindowBegin(currentStep);
+        for (size_t c = 0; c < counts.size(); c += 3)
+        {
+            if (slabCounts[c] != counts[c] || slabCounts[c + 1] != counts[c + 1] || slabCounts[c + 2] != counts[c + 2])
+                ++result.numDifferent;
+            for (int v = -1; v <= 1; ++v)
+                if (counts[c + v + 1] > plasma.getNumParticles(windowBegin + c / 3, v))
+                {
+                    ++result.numMore;
+                    break;
+                }
+        }
+    }
+    result.maxInitCells = amortized.getMaxInitCells();
+    slabInitCells = slab.getMaxInitCells();
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    std::vector<Plasma> plasmas;
+    {
+        Plasma cold = {"cold, density profile", true, {0}};
+        Plasma drift = {"drifting (+y)", false, {1}};
+        Plasma warm = {"warm (+y and -y)", false, {1, -1}};
+        plasmas.push_back(cold);
+        plasmas.push_back(drift);
+        plasmas.push_back(warm);
+    }
+
+    std::cout << options.numGpus << " GPUs of " << options.numRows << " rows with " << options.rowCells
+        << " cells, lead " << options.lead << " rows, particle speed 1/" << options.movePeriod << std::endl;
+    std::cout << "window cells which differ from the slab initialization (summed over all steps)" << std::endl;
+
+    bool isCorrect = true;
+    for (size_t i = 0; i < plasmas.size(); ++i)
+    {
+        int64_t slabInitCells = 0;
+        const Comparison keep = compare(options, plasmas[i], Simulation::AMORTIZED_KEEP, slabInitCells);
+        const Comparison amortized = compare(options, plasmas[i], Simulation::AMORTIZED, slabInitCells);
+
+        std::cout << std::left << std::setw(24) << plasmas[i].name
+            << " keep moved in particles: " << std::setw(8) << keep.numDifferent
+            << " (" << keep.numMore << " with more particles)"
+            << "  delete moved in particles: " << std::setw(8) << amortized.numDifferent
+            << " (" << amortized.numMore << " with more particles)" << std::endl;
+
+        /* no particle is created on top of a moved in particle, a cold
+         * plasma and a uniform drift equal the slab initialization
+         * (a warm plasma differs: particles ahead of the window move
+         * backwards into it only with the slab initialization)
+         */
+        if (amortized.numMore != 0)
+            isCorrect = false;
+        if (!plasmas[i].isProfile && plasmas[i].velocities.size() > 1)
+            continue;
+        if (amortized.numDifferent != 0)
+            isCorrect = false;
+
+        if (i == 0)
+            std::cout << "cells initialized per step: slab " << slabInitCells
+                << ", amortized " << amortized.maxInitCells << std::endl;
+    }
+
+    std::cout << (isCorrect ? "passed" : "FAILED") << std::endl;
+    return isCorrect ? 0 : 1;
+}
@@ -0,0 +1,373 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <cstdint>
+
+#include "plugins/output/header/DataHeader.hpp"
+#include "plugins/output/header/StreamHeader.hpp"
+#include "plugins/output/sockets/StreamServer.hpp"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    int numFrames;
+    int frameBytes;
+    int numBufferedFrames;
+    int compressLevel;
+    bool noDelta;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.numFrames = 128;
+        options.frameBytes = 256 * 1024;
+        options.numBufferedFrames = 4;
+        options.compressLevel = 1;
+        options.noDelta = false;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Streams frames with the StreamServer of the live view plugin to two loopback clients." << std::endl
+            << "The fast client reads every frame (the frames are published in its pace), the slow client" << std::endl
+            << "reads only after all frames are published and must skip frames overwritten in the ring" << std::endl
+            << "buffer (drop-oldest). Both clients reconstruct the frames with the StreamDecoder (delta" << std::endl
+            << "decoding) and compare them with the published frames. The frames are random, each byte" << std::endl
+            << "changes with a probability of 1/2 between two frames." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("frames,n", po::value<int > (&options.numFrames)->default_value(options.numFrames), "number of published frames")
+                ("bytes,b", po::value<int > (&options.frameBytes)->default_value(options.frameBytes), "size of a frame [byte]")
+                ("buffered", po::value<int > (&options.numBufferedFrames)->default_value(options.numBufferedFrames),
+                 "frames kept in the ring buffer for slow clients")
+                ("compression,c", po::value<int > (&options.compressLevel)->default_value(options.compressLevel), "zlib compression level [0,9]")
+                ("noDelta", po::value<bool > (&options.noDelta)->zero_tokens(), "send full frames instead of differences")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        const bool isValid = options.numFrames > options.numBufferedFrames && options.frameBytes > 0 &&
+            options.numBufferedFrames > 0 && options.compressLevel >= 0 && options.compressLevel <= 9;
+        if (!isValid)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* message header with the parts the StreamServer uses (as MessageHeader) */
+struct Header
+{
+    enum
+    {
+        bytes = 64
+    };
+
+    DataHeader data;
+    StreamHeader stream;
+};
+
+typedef picongpu::StreamServer<Header> Server;
+typedef picongpu::StreamDecoder<Header> Decoder;
+
+/** drop-oldest policy of the ring buffer */
+bool checkRingBuffer()
+{
+    const uint32_t capacity = 4;
+    const uint64_t numPushed = 10;
+    picongpu::FrameRingBuffer ring(capacity);
+    bool isCorrect = ring.empty();
+    for (uint64_t i = 0; i < numPushed; ++i)
+    {
+        const char message[2] = {char(i), char(2 * i)};
+        isCorrect = isCorrect && ring.push(message, sizeof (message)) == i;
+    }
+    isCorrect = isCorrect && !ring.empty() && ring.oldest() == numPushed - capacity && ring.newest() == numPushed - 1;
+    for (uint64_t s = ring.oldest(); s <= ring.newest() && isCorrect; ++s)
+    {
+        const picongpu::FrameRingBuffer::Frame& frame = ring.get(s);
+        isCorrect = frame.sequence == s && frame.message.size() == 2 &&
+            frame.message[0] == char(s) && frame.message[1] == char(2 * s);
+    }
+    return isCorrect;
+}
+
+int connectClient(uint16_t port, int receiveBufferBytes)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0)
+        return -1;
+    /* a small receive buffer lets the server run into the drop-oldest policy early */
+    if (receiveBufferBytes > 0)
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBufferBytes, sizeof (receiveBufferBytes));
+    /* never hang in the test */
+    struct timeval timeout;
+    timeout.tv_sec = 30;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof (addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, (struct sockaddr *) &addr, sizeof (addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool receiveAll(int fd, char* data, size_t bytes)
+{
+    while (bytes > 0)
+    {
+        ssize_t numRead = recv(fd, data, bytes, 0);
+        if (numRead <= 0)
+            return false;
+        data += numRead;
+        bytes -= numRead;
+    }
+    return true;
+}
+
+struct Client
+{
+    int fd;
+    /* the client starts to read after this flag is set */
+    std::atomic<bool> isReading;
+    /* sequence of the last reconstructed frame + 1 */
+    std::atomic<uint64_t> numReceived;
+    /* set after the last frame or on an error */
+    std::atomic<bool> isDone;
+
+    std::vector<uint32_t> sequences;
+    size_t numDelta;
+    size_t wireBytes;
+    std::string error;
+
+    Client() : fd(-1), isReading(false), numReceived(0), isDone(false), numDelta(0), wireBytes(0)
+    {
+    }
+
+    void run(const std::vector<std::vector<char> >& frames)
+    {
+        receive(frames);
+        isDone = true;
+    }
+
+    /** receive and check frames until the last frame arrives */
+    void receive(const std::vector<std::vector<char> >& frames)
+    {
+        while (!isReading)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        Decoder decoder;
+        std::vector<char> headerBuffer(Header::bytes);
+        std::vector<char> data;
+        while (numReceived < frames.size())
+        {
+            if (!receiveAll(fd, &headerBuffer[0], Header::bytes))
+            {
+                error = "connection closed or timed out";
+                return;
+            }
+            const Header& header = *(const Header*) &headerBuffer[0];
+            data.resize(std::max(header.data.byte, 1u));
+            if (!receiveAll(fd, &data[0], header.data.byte))
+            {
+                error = "connection closed or timed out";
+                return;
+            }
+            wireBytes += Header::bytes + header.data.byte;
+
+            const uint32_t sequence = header.stream.sequence;
+            if (sequence >= frames.size() || (!sequences.empty() && sequence <= sequences.back()))
+            {
+                std::stringstream msg;
+                msg << "unexpected sequence " << sequence;
+                error = msg.str();
+                return;
+            }
+            if (header.stream.isDelta())
+                ++numDelta;
+
+            try
+            {
+                const std::vector<char>& frame = decoder.decode(header, &data[0], frames[sequence].size());
+                if (frame != frames[sequence])
+                {
+                    std::stringstream msg;
+                    msg << "frame " << sequence << " is not reconstructed";
+                    error = msg.str();
+                    return;
+                }
+            }
+            catch (const std::runtime_error& e)
+            {
+                error = e.what();
+                return;
+            }
+            sequences.push_back(sequence);
+            numReceived = uint64_t(sequence) + 1;
+        }
+    }
+
+    size_t numDropped() const
+    {
+        return sequences.empty() ? 0 : sequences.back() + 1 - sequences.front() - sequences.size();
+    }
+};
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    bool isCorrect = checkRingBuffer();
+    if (!isCorrect)
+        std::cerr << "Error: FrameRingBuffer does not drop the oldest frames" << std::endl;
+
+    /* frames: each byte of a frame is replaced by a random value with probability 1/2 */
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::vector<char> > frames(options.numFrames, std::vector<char>(options.frameBytes));
+    for (int i = 0; i < options.numFrames; ++i)
+        for (int b = 0; b < options.frameBytes; ++b)
+            frames[i][b] = (i == 0 || (rng() & 1u)) ? char(byte(rng)) : frames[i - 1][b];
+
+    Server server("127.0.0.1", "0", options.numBufferedFrames, options.compressLevel, !options.noDelta);
+
+    Client fast;
+    Client slow;
+    fast.fd = connectClient(server.getPort(), 0);
+    slow.fd = connectClient(server.getPort(), 4096);
+    if (fast.fd < 0 || slow.fd < 0)
+    {
+        std::cerr << "Error: cannot connect to the server on port " << server.getPort() << std::endl;
+        return 1;
+    }
+    while (server.getNumSubscribers() < 2)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::thread fastThread(&Client::run, &fast, std::cref(frames));
+    std::thread slowThread(&Client::run, &slow, std::cref(frames));
+    fast.isReading = true;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<char> message(Header::bytes + options.frameBytes);
+    for (int i = 0; i < options.numFrames; ++i)
+    {
+        Header header;
+        header.data.byte = options.frameBytes;
+        memcpy(&message[0], &header, sizeof (header));
+        memcpy(&message[Header::bytes], &frames[i][0], options.frameBytes);
+        server.send(&message[0], message.size());
+
+        /* publish in the pace of the fast client */
+        while (fast.numReceived < uint64_t(i) + 1 && !fast.isDone)
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    const double timePublish = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    slow.isReading = true;
+
+    fastThread.join();
+    slowThread.join();
+    close(fast.fd);
+    close(slow.fd);
+
+    const size_t rawBytes = size_t(options.numFrames) * (Header::bytes + options.frameBytes);
+    std::cout << options.numFrames << " frames of " << options.frameBytes << " byte, ring buffer of "
+        << options.numBufferedFrames << " frames, published in " << std::fixed << std::setprecision(1)
+        << timePublish << " ms" << std::endl;
+    std::cout << std::setw(8) << "client" << std::setw(10) << "received" << std::setw(9) << "dropped"
+        << std::setw(8) << "delta" << std::setw(12) << "wire/raw" << std::endl;
+    const char* names[2] = {"fast", "slow"};
+    Client* clients[2] = {&fast, &slow};
+    for (int c = 0; c < 2; ++c)
+        std::cout << std::setw(8) << names[c] << std::setw(10) << clients[c]->sequences.size()
+            << std::setw(9) << clients[c]->numDropped() << std::setw(8) << clients[c]->numDelta
+            << std::setw(12) << std::setprecision(3) << double(clients[c]->wireBytes) / double(rawBytes) << std::endl;
+
+    for (int c = 0; c < 2; ++c)
+        if (!clients[c]->error.empty())
+        {
+            std::cerr << "Error: " << names[c] << " client: " << clients[c]->error << std::endl;
+            isCorrect = false;
+        }
+    if (fast.sequences.size() != size_t(options.numFrames) || fast.numDropped() != 0)
+    {
+        std::cerr << "Error: the fast client did not receive every frame" << std::endl;
+        isCorrect = false;
+    }
+    if (slow.numDropped() == 0 || slow.sequences.empty() || slow.sequences.back() + 1 != uint32_t(options.numFrames))
+    {
+        std::cerr << "Error: the slow client did not skip frames or missed the latest frame" << std::endl;
+        isCorrect = false;
+    }
+    if (!options.noDelta && (fast.numDelta == 0 || slow.numDelta == 0))
+    {
+        std::cerr << "Error: no delta frames were sent" << std::endl;
+        isCorrect = false;
+    }
+    return isCorrect ? 0 : 1;
+}
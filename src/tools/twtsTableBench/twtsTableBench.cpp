@@ -0,0 +1,337 @@
+/* Copyright 2017 agent
+ *
+ * This file is part of PIConGPU.
+ *
+ * PIConGPU is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PIConGPU is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with PIConGPU.
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fields/background/templates/TWTS/FieldTerms.hpp"
+#include "fields/background/templates/TWTS/TimeCoefficients.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <boost/program_options.hpp>
+
+namespace po = boost::program_options;
+
+typedef struct
+{
+    double wavelength_SI;
+    double pulselength_SI;
+    double w_x_SI;
+    double w_y_SI;
+    double phi_deg;
+    double beta_0;
+    double cellWidth_SI;
+    double deltaT_SI;
+    std::vector<int> planeCells;
+    int halfSimSizeX;
+    int recenterInterval;
+    double maxError64;
+    double maxError32;
+} Options;
+
+bool parseCmdLine(int argc, char **argv, Options &options)
+{
+    try
+    {
+        options.wavelength_SI = 0.8e-6;
+        options.pulselength_SI = 10.0e-15;
+        options.w_x_SI = 5.0e-6;
+        options.w_y_SI = 0.01;
+        options.phi_deg = 20.0;
+        options.beta_0 = 1.0;
+        options.cellWidth_SI = 0.1772e-6;
+        options.deltaT_SI = 0.8e-16;
+        options.halfSimSizeX = 64;
+        options.recenterInterval = 64;
+        options.maxError64 = 1.0e-8;
+        options.maxError32 = 1.0e-4;
+
+        std::stringstream desc_stream;
+        desc_stream << "Usage " << argv[0] << " [options]" << std::endl
+            << "Compares the TWTS field tables (EvaluationType TABLE and TABLE_FLOAT32, TWTS/SpatialTable.tpp)" << std::endl
+            << "of the tabulated field functions Ex, By, Bz_Ex and Bz_Ey with the direct calculation in" << std::endl
+            << "float_64 and float_32 (accuracy and host time per evaluation). The errors are relative to" << std::endl
+            << "the largest sampled value of each field function." << std::endl;
+
+        po::options_description desc(desc_stream.str());
+        desc.add_options()
+                ("help,h", "print help message")
+                ("wavelength", po::value<double > (&options.wavelength_SI)->default_value(options.wavelength_SI), "central wavelength [m]")
+                ("pulselength", po::value<double > (&options.pulselength_SI)->default_value(options.pulselength_SI), "pulse length (sigma of the intensity) [s]")
+                ("wx", po::value<double > (&options.w_x_SI)->default_value(options.w_x_SI), "beam waist in x [m]")
+                ("wy", po::value<double > (&options.w_y_SI)->default_value(options.w_y_SI), "beam waist in y [m]")
+                ("phi", po::value<double > (&options.phi_deg)->default_value(options.phi_deg), "interaction angle [deg], positive")
+                ("beta0", po::value<double > (&options.beta_0)->default_value(options.beta_0), "propagation speed of the overlap [c]")
+                ("cellWidth", po::value<double > (&options.cellWidth_SI)->default_value(options.cellWidth_SI), "cell width, height and depth [m]")
+                ("deltaT", po::value<double > (&options.deltaT_SI)->default_value(options.deltaT_SI), "time step [s]")
+                ("cells,c", po::value<std::vector<int> > (&options.planeCells)->multitoken(), "sampled cells of the (y,z)-plane (default: 64 64)")
+                ("halfSimSizeX", po::value<int > (&options.halfSimSizeX)->default_value(options.halfSimSizeX), "half of the global domain in x [cells]")
+                ("recenterInterval", po::value<int > (&options.recenterInterval)->default_value(options.recenterInterval),
+                 "steps after which the float_32 tables are moved (SpatialTable::recenterInterval)")
+                ("maxError64", po::value<double > (&options.maxError64)->default_value(options.maxError64), "allowed error of the float_64 table")
+                ("maxError32", po::value<double > (&options.maxError32)->default_value(options.maxError32), "allowed error of the float_32 table")
+                ;
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        // print help message and return
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        if (options.planeCells.empty())
+            options.planeCells.assign(2, 64);
+
+        const bool isValid = options.planeCells.size() == 2 && options.planeCells[0] > 0 && options.planeCells[1] > 0 &&
+            options.phi_deg > 0.0 && options.phi_deg < 90.0 && options.wavelength_SI > 0.0 &&
+            options.pulselength_SI > 0.0 && options.cellWidth_SI > 0.0 && options.deltaT_SI > 0.0 &&
+            options.halfSimSizeX > 0 && options.recenterInterval > 0;
+        if (!isValid)
+        {
+            std::cerr << "Error: invalid options." << std::endl;
+            std::cerr << std::endl << desc << std::endl;
+            return false;
+        }
+    } catch (const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+using namespace picongpu::templates::twts;
+
+typedef detail::float3_64 float3_64;
+typedef PMacc::math::Complex<double> complex_64;
+typedef PMacc::math::Complex<float> complex_32;
+
+const double PI = detail::PI;
+const double SPEED_OF_LIGHT_SI = 2.99792458e8;
+
+/** tabulated TWTS field functions (EField and BField table slots) */
+enum FieldFunction
+{
+    EX = 0,
+    BY = 1,
+    BZ_EX = 2,
+    BZ_EY = 3,
+    numFieldFunctions = 4
+};
+
+const char* getFunctionName(const FieldFunction function)
+{
+    const char* names[numFieldFunctions] = {"Ex", "By", "Bz_Ex", "Bz_Ey"};
+    return names[function];
+}
+
+/** prefactor and exponent of a field function, time [s] */
+template<typename T_Float>
+void calcTerms(const FieldFunction function, const detail::FieldParameters& par,
+               const float3_64& pos, const double time,
+               PMacc::math::Complex<T_Float>& prefactor, PMacc::math::Complex<T_Float>& exponent)
+{
+    switch (function)
+    {
+    case EX:
+        detail::calcTWTSExTerms<T_Float>(par, pos, time, prefactor, exponent);
+        break;
+    case BY:
+        detail::calcTWTSByTerms<T_Float>(par, pos, time, prefactor, exponent);
+        break;
+    case BZ_EX:
+        detail::calcTWTSBz_ExTerms<T_Float>(par, pos, time, prefactor, exponent);
+        break;
+    default:
+        detail::calcTWTSBz_EyTerms<T_Float>(par, pos, time, prefactor, exponent);
+        break;
+    }
+}
+
+/** field function in float_64, functor for detail::fitTimeCoefficients */
+struct Terms
+{
+    FieldFunction function;
+    const detail::FieldParameters& par;
+
+    void operator()(const float3_64& pos, const double time, complex_64& prefactor, complex_64& exponent) const
+    {
+        calcTerms<double>(function, par, pos, time, prefactor, exponent);
+    }
+};
+
+/** direct calculation of Re[prefactor * exp(exponent)], time [DELTA_T_SI] */
+template<typename T_Float>
+double calculate(const FieldFunction function, const detail::FieldParameters& par,
+                 const float3_64& pos, const double time)
+{
+    PMacc::math::Complex<T_Float> prefactor;
+    PMacc::math::Complex<T_Float> exponent;
+    calcTerms<T_Float>(function, par, pos, time * par.deltaT_SI, prefactor, exponent);
+    return (detail::math::exp(exponent) * prefactor).get_real();
+}
+
+struct Sample
+{
+    float3_64 pos;
+    double time;
+    detail::TimeCoefficients<double> coefficients64;
+    detail::TimeCoefficients<float> coefficients32;
+};
+
+struct Result
+{
+    double peak;
+    double maxErrorDirect;
+    double maxError64;
+    double maxError32;
+    double timeDirect;
+    double timeTable64;
+    double timeTable32;
+};
+
+/** compare the tables of a field function with the direct calculation */
+Result benchFunction(const FieldFunction function, const detail::FieldParameters& par, const Options& options,
+                     size_t& numSamples)
+{
+    const double xUnit = SPEED_OF_LIGHT_SI * options.deltaT_SI;
+    const double fitX_SI = options.halfSimSizeX * options.cellWidth_SI;
+    const Terms terms = {function, par};
+
+    /* the table is calculated at the reference time 0 as by SpatialTable::build,
+     * the float_32 table is moved to the time of the first sample */
+    const double time64 = 0.0;
+    const double time32 = 0.0;
+
+    /* cells of the (y,z)-plane centered around the laser origin, three
+     * x-coordinates and three times within recenterInterval steps */
+    std::vector<Sample> samples;
+    for (int iz = 0; iz < options.planeCells[1]; ++iz)
+        for (int iy = 0; iy < options.planeCells[0]; ++iy)
+        {
+            const float3_64 pos0(
+                0.0,
+                (iy - options.planeCells[0] / 2) * options.cellWidth_SI,
+                (iz - options.planeCells[1] / 2) * options.cellWidth_SI);
+            const detail::TimeCoefficients<double> c = detail::fitTimeCoefficients(terms, par, pos0, time64, fitX_SI);
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                {
+                    Sample s;
+                    s.pos = pos0;
+                    s.pos.x() = double(i) * 0.5 * fitX_SI;
+                    s.time = time64 + double(j * options.recenterInterval / 2);
+                    s.coefficients64 = c;
+                    s.coefficients32 = detail::toFloat32(c, time32 - time64);
+                    samples.push_back(s);
+                }
+        }
+    numSamples = samples.size();
+
+    std::vector<double> reference(numSamples);
+    std::vector<double> direct(numSamples);
+    std::vector<double> table64(numSamples);
+    std::vector<double> table32(numSamples);
+    for (size_t i = 0; i < numSamples; ++i)
+        reference[i] = calculate<double>(function, par, samples[i].pos, samples[i].time);
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numSamples; ++i)
+        direct[i] = calculate<float>(function, par, samples[i].pos, samples[i].time);
+    result.timeDirect = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numSamples; ++i)
+        table64[i] = samples[i].coefficients64(samples[i].time - time64, samples[i].pos.x() / xUnit);
+    result.timeTable64 = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numSamples; ++i)
+        table32[i] = samples[i].coefficients32(float(samples[i].time - time32), float(samples[i].pos.x() / xUnit));
+    result.timeTable32 = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    result.peak = 0.0;
+    result.maxErrorDirect = 0.0;
+    result.maxError64 = 0.0;
+    result.maxError32 = 0.0;
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        result.peak = std::max(result.peak, std::abs(reference[i]));
+        result.maxErrorDirect = std::max(result.maxErrorDirect, std::abs(direct[i] - reference[i]));
+        result.maxError64 = std::max(result.maxError64, std::abs(table64[i] - reference[i]));
+        result.maxError32 = std::max(result.maxError32, std::abs(table32[i] - reference[i]));
+    }
+    if (result.peak > 0.0)
+    {
+        result.maxErrorDirect /= result.peak;
+        result.maxError64 /= result.peak;
+        result.maxError32 /= result.peak;
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseCmdLine(argc, argv, options))
+        return 1;
+
+    const detail::FieldParameters par(
+        options.wavelength_SI, options.pulselength_SI, options.w_x_SI, options.w_y_SI,
+        options.phi_deg * PI / 180.0, 1.0, options.beta_0, options.deltaT_SI, SPEED_OF_LIGHT_SI);
+
+    bool isCorrect = true;
+    std::cout << std::setw(8) << "function" << std::setw(18) << "evaluation" << std::setw(14) << "max. error"
+        << std::setw(12) << "[ns/eval]" << std::endl;
+    for (int f = 0; f < numFieldFunctions; ++f)
+    {
+        const FieldFunction function = FieldFunction(f);
+        size_t numSamples = 0;
+        const Result r = benchFunction(function, par, options, numSamples);
+
+        std::cout << std::scientific << std::setprecision(3)
+            << std::setw(8) << getFunctionName(function) << std::setw(18) << "direct float_32" << std::setw(14) << r.maxErrorDirect
+            << std::fixed << std::setw(12) << r.timeDirect / numSamples << std::endl;
+        std::cout << std::scientific
+            << std::setw(8) << "" << std::setw(18) << "table float_64" << std::setw(14) << r.maxError64
+            << std::fixed << std::setw(12) << r.timeTable64 / numSamples << std::endl;
+        std::cout << std::scientific
+            << std::setw(8) << "" << std::setw(18) << "table float_32" << std::setw(14) << r.maxError32
+            << std::fixed << std::setw(12) << r.timeTable32 / numSamples << std::endl;
+
+        if (!(r.peak > 0.0 && r.maxError64 <= options.maxError64 && r.maxError32 <= options.maxError32))
+        {
+            std::cerr << "Error: the table error of " << getFunctionName(function)
+                << " exceeds the allowed error (float_64 " << options.maxError64
+                << ", float_32 " << options.maxError32 << ")" << std::endl;
+            isCorrect = false;
+        }
+    }
+    return isCorrect ? 0 : 1;
+}